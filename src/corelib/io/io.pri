@@ -106,6 +106,16 @@ qtConfig(processenvironment) {
         SOURCES += io/qprocess_unix.cpp
 }
 
+qtConfig(process) {
+    SOURCES += \
+        io/qprocesspool.cpp
+    HEADERS += \
+        io/qprocesspool.h \
+        io/qprocesspool_p.h
+}
+
+qtConfig(zstd): QMAKE_USE_PRIVATE += zstd
+
 win32 {
         SOURCES += io/qfsfileengine_win.cpp
         SOURCES += io/qlockfile_win.cpp
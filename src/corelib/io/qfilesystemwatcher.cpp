@@ -45,7 +45,9 @@
 #include <qdatetime.h>
 #include <qdebug.h>
 #include <qdir.h>
+#include <qdiriterator.h>
 #include <qfileinfo.h>
+#include <qmetaobject.h>
 #include <qset.h>
 #include <qtimer.h>
 
@@ -88,7 +90,7 @@ QFileSystemWatcherEngine *QFileSystemWatcherPrivate::createNativeEngine(QObject
 }
 
 QFileSystemWatcherPrivate::QFileSystemWatcherPrivate()
-    : native(0), poller(0)
+    : native(0), poller(0), batchTimer(0), debounceInterval(0)
 {
 }
 
@@ -146,6 +148,12 @@ void QFileSystemWatcherPrivate::_q_fileChanged(const QString &path, bool removed
     if (removed)
         files.removeAll(path);
     emit q->fileChanged(path, QFileSystemWatcher::QPrivateSignal());
+
+    static const QMetaMethod filesChangedSignal = QMetaMethod::fromSignal(&QFileSystemWatcher::filesChanged);
+    if (q->isSignalConnected(filesChangedSignal)) {
+        pendingFiles.insert(path);
+        scheduleBatch();
+    }
 }
 
 void QFileSystemWatcherPrivate::_q_directoryChanged(const QString &path, bool removed)
@@ -155,9 +163,113 @@ void QFileSystemWatcherPrivate::_q_directoryChanged(const QString &path, bool re
         // perhaps the path was removed after a change was detected, but before we delivered the signal
         return;
     }
-    if (removed)
+    if (removed) {
         directories.removeAll(path);
+        recursiveRoots.removeAll(path);
+    }
     emit q->directoryChanged(path, QFileSystemWatcher::QPrivateSignal());
+
+    static const QMetaMethod directoriesChangedSignal = QMetaMethod::fromSignal(&QFileSystemWatcher::directoriesChanged);
+    if (q->isSignalConnected(directoriesChangedSignal)) {
+        pendingDirectories.insert(path);
+        scheduleBatch();
+    }
+    if (!removed && isInRecursiveTree(path)) {
+        // a subdirectory might have been created or moved in
+        pendingRescans.insert(path);
+        scheduleBatch();
+    }
+}
+
+bool QFileSystemWatcherPrivate::isInRecursiveTree(const QString &path) const
+{
+    for (const QString &root : recursiveRoots) {
+        if (path.startsWith(root)
+                && (path.size() == root.size() || root.endsWith(QLatin1Char('/'))
+                    || path.at(root.size()) == QLatin1Char('/'))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QStringList QFileSystemWatcherPrivate::subdirectories(const QString &path) const
+{
+    // Symbolic links are not followed, they could lead out of the tree or
+    // into a cycle.
+    QStringList result;
+    QDirIterator it(path, QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::NoSymLinks,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext())
+        result.append(it.next());
+    return result;
+}
+
+void QFileSystemWatcherPrivate::scheduleBatch()
+{
+    Q_Q(QFileSystemWatcher);
+    if (!batchTimer) {
+        batchTimer = new QTimer(q);
+        batchTimer->setSingleShot(true);
+        QObject::connect(batchTimer, &QTimer::timeout, q, [this]() { flushBatch(); });
+    }
+    // Not restarted by further changes, so that a steady stream of changes
+    // is still delivered every debounceInterval milliseconds.
+    if (!batchTimer->isActive())
+        batchTimer->start(debounceInterval);
+}
+
+void QFileSystemWatcherPrivate::flushBatch()
+{
+    Q_Q(QFileSystemWatcher);
+
+    if (!pendingRescans.isEmpty()) {
+        const QSet<QString> rescans = pendingRescans;
+        pendingRescans.clear();
+        QSet<QString> watched = directories.toSet();
+        for (const QString &directory : rescans) {
+            if (!watched.contains(directory))
+                continue;
+            // Only the changed directory itself is listed; its children that
+            // are not watched yet are new and may come with a whole tree of
+            // their own.
+            QStringList children;
+            QDirIterator it(directory, QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::NoSymLinks);
+            while (it.hasNext()) {
+                const QString child = it.next();
+                if (!watched.contains(child))
+                    children.append(child);
+            }
+            if (children.isEmpty())
+                continue;
+            const QSet<QString> notAdded = q->addPaths(children).toSet();
+            QStringList newTrees;
+            for (const QString &child : qAsConst(children)) {
+                if (notAdded.contains(child))
+                    continue;
+                watched.insert(child);
+                newTrees += subdirectories(child);
+            }
+            if (!newTrees.isEmpty()) {
+                const QSet<QString> treesNotAdded = q->addPaths(newTrees).toSet();
+                for (const QString &path : qAsConst(newTrees)) {
+                    if (!treesNotAdded.contains(path))
+                        watched.insert(path);
+                }
+            }
+        }
+    }
+
+    if (!pendingFiles.isEmpty()) {
+        const QStringList paths = pendingFiles.toList();
+        pendingFiles.clear();
+        emit q->filesChanged(paths, QFileSystemWatcher::QPrivateSignal());
+    }
+    if (!pendingDirectories.isEmpty()) {
+        const QStringList paths = pendingDirectories.toList();
+        pendingDirectories.clear();
+        emit q->directoriesChanged(paths, QFileSystemWatcher::QPrivateSignal());
+    }
 }
 
 #if defined(Q_OS_WIN) && !defined(Q_OS_WINRT)
@@ -249,6 +361,15 @@ void  QFileSystemWatcherPrivate::_q_winDriveRemoved(const QString &path)
     \endlist
     \endlist
 
+    To watch a whole directory tree, use addPathRecursively(). Directories
+    created inside the tree later on are then watched as well.
+
+    Changes can be delivered in batches through the filesChanged() and
+    directoriesChanged() signals. Connecting to these signals is
+    recommended when watching many paths: a path that changes several
+    times within the debounceInterval() is only reported once, and
+    receivers are invoked once per batch instead of once per change.
+
     \sa QFile, QDir
 */
 
@@ -386,6 +507,59 @@ QStringList QFileSystemWatcher::addPaths(const QStringList &paths)
     return p;
 }
 
+/*!
+    \since 5.10
+
+    Adds \a directory and all of its subdirectories to the file system
+    watcher. Subdirectories created in the tree later on are added
+    automatically, once their creation has been reported for their parent
+    directory. Symbolic links to directories are not followed.
+
+    Only directories are watched; changes to files inside them are
+    reported through directoryChanged() and directoriesChanged() for the
+    directory containing the file, as usual.
+
+    Returns \c true if \a directory and all of its subdirectories are
+    being watched.
+
+    Removing \a directory with removePath() or removePaths() stops watching
+    the whole tree.
+
+    \note Every directory in the tree counts against the system dependent
+    limit on the number of paths that can be monitored. On Linux this is
+    the \c{fs.inotify.max_user_watches} setting.
+
+    \sa addPaths(), removePath()
+*/
+bool QFileSystemWatcher::addPathRecursively(const QString &directory)
+{
+    Q_D(QFileSystemWatcher);
+    if (directory.isEmpty()) {
+        qWarning("QFileSystemWatcher::addPathRecursively: path is empty");
+        return true;
+    }
+
+    const QString root = QDir::cleanPath(directory);
+    if (!QFileInfo(root).isDir())
+        return false;
+
+    QStringList paths(root);
+    paths += d->subdirectories(root);
+    const QStringList notAdded = addPaths(paths);
+    bool ok = true;
+    for (const QString &path : notAdded) {
+        if (!d->directories.contains(path)) {
+            ok = false;
+            break;
+        }
+    }
+    if (!d->directories.contains(root))
+        return false;
+    if (!d->recursiveRoots.contains(root))
+        d->recursiveRoots.append(root);
+    return ok;
+}
+
 /*!
     Removes the specified \a path from the file system watcher.
 
@@ -436,6 +610,25 @@ QStringList QFileSystemWatcher::removePaths(const QStringList &paths)
         return QStringList();
     }
 
+    // Removing the root of a recursive watch removes the whole tree
+    QStringList subtrees;
+    for (const QString &path : qAsConst(p)) {
+        const QString root = QDir::cleanPath(path);
+        if (d->recursiveRoots.removeAll(root) == 0)
+            continue;
+        const QString prefix = root.endsWith(QLatin1Char('/')) ? root : root + QLatin1Char('/');
+        for (const QString &directory : qAsConst(d->directories)) {
+            if (directory.startsWith(prefix))
+                subtrees.append(directory);
+        }
+    }
+    if (!subtrees.isEmpty()) {
+        if (d->native)
+            subtrees = d->native->removePaths(subtrees, &d->files, &d->directories);
+        if (d->poller && !subtrees.isEmpty())
+            d->poller->removePaths(subtrees, &d->files, &d->directories);
+    }
+
     if (d->native)
         p = d->native->removePaths(p, &d->files, &d->directories);
     if (d->poller)
@@ -466,6 +659,67 @@ QStringList QFileSystemWatcher::removePaths(const QStringList &paths)
     \sa fileChanged()
 */
 
+/*!
+    \fn void QFileSystemWatcher::filesChanged(const QStringList &paths)
+    \since 5.10
+
+    This signal is emitted with the \a paths of all watched files that
+    were modified, renamed or removed since the last time it was emitted.
+    Every path is reported once per batch, in no particular order.
+
+    The signal is emitted at most once per debounceInterval(), after the
+    corresponding fileChanged() signals.
+
+    \sa directoriesChanged(), setDebounceInterval()
+*/
+
+/*!
+    \fn void QFileSystemWatcher::directoriesChanged(const QStringList &paths)
+    \since 5.10
+
+    This signal is emitted with the \a paths of all watched directories
+    that were modified or removed since the last time it was emitted.
+    Every path is reported once per batch, in no particular order.
+
+    The signal is emitted at most once per debounceInterval(), after the
+    corresponding directoryChanged() signals.
+
+    \sa filesChanged(), setDebounceInterval()
+*/
+
+/*!
+    \since 5.10
+
+    Sets the interval during which changes are collected before
+    filesChanged() and directoriesChanged() are emitted to \a msecs
+    milliseconds. The interval starts with the first change of a batch
+    and is not extended by further changes.
+
+    The default is 0, which delivers all changes reported by the system
+    in one go as soon as control returns to the event loop.
+
+    \sa debounceInterval()
+*/
+void QFileSystemWatcher::setDebounceInterval(int msecs)
+{
+    Q_D(QFileSystemWatcher);
+    d->debounceInterval = qMax(0, msecs);
+}
+
+/*!
+    \since 5.10
+
+    Returns the interval in milliseconds during which changes are
+    collected before filesChanged() and directoriesChanged() are emitted.
+
+    \sa setDebounceInterval()
+*/
+int QFileSystemWatcher::debounceInterval() const
+{
+    Q_D(const QFileSystemWatcher);
+    return d->debounceInterval;
+}
+
 /*!
     \fn QStringList QFileSystemWatcher::directories() const
 
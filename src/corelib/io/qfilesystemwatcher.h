@@ -61,15 +61,21 @@ public:
 
     bool addPath(const QString &file);
     QStringList addPaths(const QStringList &files);
+    bool addPathRecursively(const QString &directory);
     bool removePath(const QString &file);
     QStringList removePaths(const QStringList &files);
 
     QStringList files() const;
     QStringList directories() const;
 
+    void setDebounceInterval(int msecs);
+    int debounceInterval() const;
+
 Q_SIGNALS:
     void fileChanged(const QString &path, QPrivateSignal);
     void directoryChanged(const QString &path, QPrivateSignal);
+    void filesChanged(const QStringList &paths, QPrivateSignal);
+    void directoriesChanged(const QStringList &paths, QPrivateSignal);
 
 private:
     Q_PRIVATE_SLOT(d_func(), void _q_fileChanged(const QString &path, bool removed))
@@ -48,6 +48,7 @@
 #include <qdebug.h>
 #include <qfile.h>
 #include <qfileinfo.h>
+#include <qset.h>
 #include <qsocketnotifier.h>
 #include <qvarlengtharray.h>
 
@@ -271,18 +272,26 @@ QStringList QInotifyFileSystemWatcherEngine::addPaths(const QStringList &paths,
                                                       QStringList *directories)
 {
     QStringList p = paths;
+    // Paths can be listed without being in pathToID, for instance while a
+    // deleted path is being reported. Hashing the lists once per call keeps
+    // adding large trees linear.
+    QSet<QString> watchedFiles;
+    QSet<QString> watchedDirectories;
+    bool watchedHashed = false;
     QMutableListIterator<QString> it(p);
     while (it.hasNext()) {
         QString path = it.next();
+        if (pathToID.contains(path))
+            continue;
+        if (!watchedHashed) {
+            watchedFiles = files->toSet();
+            watchedDirectories = directories->toSet();
+            watchedHashed = true;
+        }
         QFileInfo fi(path);
         bool isDir = fi.isDir();
-        if (isDir) {
-            if (directories->contains(path))
-                continue;
-        } else {
-            if (files->contains(path))
-                continue;
-        }
+        if (isDir ? watchedDirectories.contains(path) : watchedFiles.contains(path))
+            continue;
 
         int wd = inotify_add_watch(inotifyFd,
                                    QFile::encodeName(path),
@@ -59,9 +59,12 @@
 
 #include <QtCore/qstringlist.h>
 #include <QtCore/qhash.h>
+#include <QtCore/qset.h>
 
 QT_BEGIN_NAMESPACE
 
+class QTimer;
+
 class QFileSystemWatcherEngine : public QObject
 {
     Q_OBJECT
@@ -104,6 +107,18 @@ public:
     QFileSystemWatcherEngine *native, *poller;
     QStringList files, directories;
 
+    // directories added with addPathRecursively()
+    QStringList recursiveRoots;
+    bool isInRecursiveTree(const QString &path) const;
+    QStringList subdirectories(const QString &path) const;
+
+    // changes collected for filesChanged() and directoriesChanged()
+    QSet<QString> pendingFiles, pendingDirectories, pendingRescans;
+    QTimer *batchTimer;
+    int debounceInterval;
+    void scheduleBatch();
+    void flushBatch();
+
     // private slots
     void _q_fileChanged(const QString &path, bool removed);
     void _q_directoryChanged(const QString &path, bool removed);
@@ -0,0 +1,612 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qprocesspool.h"
+#include "qprocesspool_p.h"
+
+#include <qdeadlinetimer.h>
+#include <qdebug.h>
+#include <qendian.h>
+#include <qpointer.h>
+#include <qthread.h>
+#include <qvector.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QProcessPool
+    \inmodule QtCore
+    \since 5.10
+
+    \brief The QProcessPool class manages a set of reusable worker processes.
+
+    \ingroup io
+    \ingroup misc
+    \reentrant
+
+    Starting a QProcess is comparatively expensive: every instance creates
+    several pipes, forks, and installs socket notifiers for each of its
+    channels. Applications that run thousands of short tasks through the
+    same helper program can instead keep a small number of long-lived
+    worker processes around and send them requests over their standard
+    input. QProcessPool implements this pattern.
+
+    Set the worker program with setProgram() and setArguments(), then call
+    submit() with the request payload. The pool starts workers on demand,
+    up to maxWorkerCount(), and queues requests when all workers are busy.
+    When a worker answers, the replyReady() signal is emitted with the
+    identifier returned by submit(). The idle() signal is emitted once all
+    submitted requests have been answered or have failed.
+
+    \section1 Worker Protocol
+
+    Requests and replies are exchanged as frames on the worker's standard
+    input and standard output. A frame consists of the payload size as a
+    32-bit unsigned big-endian integer, followed by the payload bytes.
+    A worker must read request frames one at a time and write exactly one
+    reply frame for each request, in the order the requests were received.
+    When its standard input is closed, the worker should exit.
+
+    The standard error channel of the workers is forwarded to the standard
+    error of the calling process, so no pipe is set up for it.
+
+    By default each worker handles one request at a time. Workers that
+    process their input in a streaming fashion can be sent several requests
+    ahead of their replies by raising pipelineDepth(); this hides the
+    round-trip latency of the pipes for very small requests.
+
+    If a worker crashes or exits while requests are still outstanding, the
+    requestFailed() signal is emitted for each of them, and a new worker is
+    started for the requests that are still queued.
+
+    \sa QProcess, QThreadPool
+*/
+
+/*!
+    \fn void QProcessPool::replyReady(qint64 requestId, const QByteArray &reply)
+
+    This signal is emitted when a worker has answered the request with the
+    identifier \a requestId. The reply payload is passed in \a reply.
+*/
+
+/*!
+    \fn void QProcessPool::requestFailed(qint64 requestId, QProcess::ProcessError error)
+
+    This signal is emitted when the request with the identifier \a requestId
+    could not be completed. \a error is QProcess::FailedToStart if the worker
+    program could not be started, QProcess::Crashed if the worker crashed,
+    QProcess::Timedout if the pool was shut down before the reply arrived, and
+    QProcess::UnknownError if the worker exited without replying.
+*/
+
+/*!
+    \fn void QProcessPool::idle()
+
+    This signal is emitted when the last outstanding request has been
+    answered or has failed, and no requests are queued.
+*/
+
+QProcessPoolPrivate::QProcessPoolPrivate()
+    : maxWorkerCount(qMax(1, QThread::idealThreadCount())),
+      pipelineDepth(1),
+      activeRequestCount(0),
+      nextRequestId(0)
+{
+}
+
+QByteArray QProcessPoolPrivate::frame(const QByteArray &payload)
+{
+    QByteArray result;
+    result.resize(sizeof(quint32) + payload.size());
+    qToBigEndian<quint32>(payload.size(), result.data());
+    memcpy(result.data() + sizeof(quint32), payload.constData(), payload.size());
+    return result;
+}
+
+QProcessPoolPrivate::Worker *QProcessPoolPrivate::startWorker()
+{
+    Q_Q(QProcessPool);
+    QProcess *process = new QProcess(q);
+    process->setProgram(program);
+    process->setArguments(arguments);
+    process->setWorkingDirectory(workingDirectory);
+    process->setProcessEnvironment(environment);
+    process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    process->start();
+
+    // Errors reported synchronously by start() are handled right here;
+    // those detected later (e.g. a missing executable) go through
+    // workerFinished().
+    if (process->state() == QProcess::NotRunning) {
+        delete process;
+        return Q_NULLPTR;
+    }
+
+    Worker *worker = new Worker;
+    worker->process = process;
+    workers.append(worker);
+
+    QObject::connect(process, &QProcess::readyReadStandardOutput, q, [this, worker]() {
+        readReplies(worker);
+    });
+    QObject::connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+                     q, [this, worker](int, QProcess::ExitStatus status) {
+        workerFinished(worker, status == QProcess::CrashExit ? QProcess::Crashed
+                                                             : QProcess::UnknownError);
+    });
+    QObject::connect(process, &QProcess::errorOccurred, q, [this, worker](QProcess::ProcessError error) {
+        // finished() is not emitted for processes that never started
+        if (error == QProcess::FailedToStart)
+            workerFinished(worker, error);
+    });
+    return worker;
+}
+
+/*
+    Returns the least loaded worker that can accept another request, or
+    nullptr if all workers have reached the pipeline depth.
+*/
+QProcessPoolPrivate::Worker *QProcessPoolPrivate::findWorker() const
+{
+    Worker *best = Q_NULLPTR;
+    for (Worker *worker : workers) {
+        const int load = worker->inFlight.size();
+        if (load >= pipelineDepth)
+            continue;
+        if (!best || load < best->inFlight.size()) {
+            best = worker;
+            if (load == 0)
+                break;
+        }
+    }
+    return best;
+}
+
+void QProcessPoolPrivate::dispatch()
+{
+    while (!pending.isEmpty()) {
+        Worker *worker = findWorker();
+        // Prefer a fresh worker over pipelining into a busy one.
+        if (!worker || (!worker->inFlight.isEmpty() && workers.size() < maxWorkerCount)) {
+            if (workers.size() < maxWorkerCount) {
+                if (Worker *started = startWorker()) {
+                    worker = started;
+                } else if (workers.isEmpty()) {
+                    failPendingRequests(QProcess::FailedToStart);
+                    return;
+                }
+            }
+        }
+        if (!worker)
+            return;
+        sendRequest(worker, pending.dequeue());
+    }
+}
+
+void QProcessPoolPrivate::sendRequest(Worker *worker, const Request &request)
+{
+    worker->inFlight.enqueue(request.id);
+    ++activeRequestCount;
+    worker->process->write(frame(request.payload));
+}
+
+void QProcessPoolPrivate::readReplies(Worker *worker)
+{
+    Q_Q(QProcessPool);
+    worker->buffer += worker->process->readAllStandardOutput();
+
+    // Parse every complete frame before emitting anything, so that slots
+    // connected to replyReady() may safely submit or shut down the pool.
+    QVector<QPair<qint64, QByteArray> > replies;
+    const int headerSize = int(sizeof(quint32));
+    int pos = 0;
+    while (worker->buffer.size() - pos >= headerSize) {
+        const quint32 size = qFromBigEndian<quint32>(worker->buffer.constData() + pos);
+        if (quint32(worker->buffer.size() - pos - headerSize) < size)
+            break;
+        const QByteArray payload = worker->buffer.mid(pos + headerSize, int(size));
+        pos += headerSize + int(size);
+        if (worker->inFlight.isEmpty()) {
+            qWarning("QProcessPool: worker %lld sent a reply without a request",
+                     worker->process->processId());
+            continue;
+        }
+        replies.append(qMakePair(worker->inFlight.dequeue(), payload));
+    }
+    if (pos)
+        worker->buffer.remove(0, pos);
+    if (replies.isEmpty())
+        return;
+
+    activeRequestCount -= replies.size();
+    dispatch();
+    for (const auto &reply : qAsConst(replies))
+        emit q->replyReady(reply.first, reply.second);
+    checkIdle();
+}
+
+void QProcessPoolPrivate::workerFinished(Worker *worker, QProcess::ProcessError error)
+{
+    Q_Q(QProcessPool);
+    if (!workers.contains(worker))
+        return;
+
+    if (error != QProcess::FailedToStart)
+        readReplies(worker);
+    if (!workers.removeOne(worker))
+        return; // shut down while delivering the last replies
+
+    const QQueue<qint64> failed = worker->inFlight;
+    activeRequestCount -= failed.size();
+    worker->process->disconnect(q);
+    worker->process->deleteLater();
+    delete worker;
+
+    if (error == QProcess::FailedToStart) {
+        // Further attempts would fail the same way.
+        failPendingRequests(error);
+    } else {
+        dispatch();
+    }
+    for (qint64 id : failed)
+        emit q->requestFailed(id, error);
+    checkIdle();
+}
+
+void QProcessPoolPrivate::failPendingRequests(QProcess::ProcessError error)
+{
+    Q_Q(QProcessPool);
+    QQueue<Request> failed;
+    failed.swap(pending);
+    for (const Request &request : qAsConst(failed))
+        emit q->requestFailed(request.id, error);
+}
+
+/*
+    Stops all workers and returns the identifiers of the requests that were
+    still outstanding. Does not emit any signals.
+*/
+QVector<qint64> QProcessPoolPrivate::stopWorkers(int msecs)
+{
+    Q_Q(QProcessPool);
+    const QList<Worker *> stopped = workers;
+    workers.clear();
+    QVector<qint64> failed;
+    for (const Request &request : qAsConst(pending))
+        failed.append(request.id);
+    pending.clear();
+
+    for (Worker *worker : stopped) {
+        worker->process->disconnect(q);
+        worker->process->closeWriteChannel();
+        for (qint64 id : qAsConst(worker->inFlight))
+            failed.append(id);
+    }
+
+    QDeadlineTimer deadline(msecs);
+    for (Worker *worker : stopped) {
+        if (!worker->process->waitForFinished(int(deadline.remainingTime()))) {
+            worker->process->kill();
+            worker->process->waitForFinished();
+        }
+        // We may be called from a slot connected to replyReady() while the
+        // process is still emitting readyReadStandardOutput().
+        worker->process->deleteLater();
+        delete worker;
+    }
+    activeRequestCount = 0;
+    return failed;
+}
+
+void QProcessPoolPrivate::checkIdle()
+{
+    Q_Q(QProcessPool);
+    if (activeRequestCount == 0 && pending.isEmpty())
+        emit q->idle();
+}
+
+/*!
+    Constructs a process pool with the given \a parent.
+*/
+QProcessPool::QProcessPool(QObject *parent)
+    : QObject(*new QProcessPoolPrivate, parent)
+{
+}
+
+/*!
+    Destroys the pool. The standard input of every worker is closed and the
+    workers are given up to 30 seconds to exit before they are killed.
+    Outstanding requests are discarded without emitting requestFailed().
+*/
+QProcessPool::~QProcessPool()
+{
+    Q_D(QProcessPool);
+    d->stopWorkers(30000);
+}
+
+/*!
+    Returns the program that the workers run.
+
+    \sa setProgram()
+*/
+QString QProcessPool::program() const
+{
+    Q_D(const QProcessPool);
+    return d->program;
+}
+
+/*!
+    Sets the \a program run by workers that are started from now on.
+
+    \sa program(), QProcess::setProgram()
+*/
+void QProcessPool::setProgram(const QString &program)
+{
+    Q_D(QProcessPool);
+    d->program = program;
+}
+
+/*!
+    Returns the arguments passed to the workers.
+
+    \sa setArguments()
+*/
+QStringList QProcessPool::arguments() const
+{
+    Q_D(const QProcessPool);
+    return d->arguments;
+}
+
+/*!
+    Sets the \a arguments passed to workers that are started from now on.
+
+    \sa arguments(), QProcess::setArguments()
+*/
+void QProcessPool::setArguments(const QStringList &arguments)
+{
+    Q_D(QProcessPool);
+    d->arguments = arguments;
+}
+
+/*!
+    Returns the working directory of the workers.
+
+    \sa setWorkingDirectory()
+*/
+QString QProcessPool::workingDirectory() const
+{
+    Q_D(const QProcessPool);
+    return d->workingDirectory;
+}
+
+/*!
+    Sets the working directory of workers started from now on to \a dir.
+
+    \sa workingDirectory(), QProcess::setWorkingDirectory()
+*/
+void QProcessPool::setWorkingDirectory(const QString &dir)
+{
+    Q_D(QProcessPool);
+    d->workingDirectory = dir;
+}
+
+/*!
+    Returns the environment of the workers.
+
+    \sa setProcessEnvironment()
+*/
+QProcessEnvironment QProcessPool::processEnvironment() const
+{
+    Q_D(const QProcessPool);
+    return d->environment;
+}
+
+/*!
+    Sets the \a environment of workers started from now on.
+
+    \sa processEnvironment(), QProcess::setProcessEnvironment()
+*/
+void QProcessPool::setProcessEnvironment(const QProcessEnvironment &environment)
+{
+    Q_D(QProcessPool);
+    d->environment = environment;
+}
+
+/*!
+    \property QProcessPool::maxWorkerCount
+    \brief the maximum number of worker processes the pool runs concurrently
+
+    The default is QThread::idealThreadCount(). Lowering the value does not
+    stop running workers; the pool simply stops sending them new requests
+    once they exit.
+*/
+int QProcessPool::maxWorkerCount() const
+{
+    Q_D(const QProcessPool);
+    return d->maxWorkerCount;
+}
+
+void QProcessPool::setMaxWorkerCount(int maxWorkerCount)
+{
+    Q_D(QProcessPool);
+    d->maxWorkerCount = qMax(1, maxWorkerCount);
+    d->dispatch();
+}
+
+/*!
+    \property QProcessPool::pipelineDepth
+    \brief the maximum number of requests sent to a worker before it replies
+
+    The default is 1. Requests are only pipelined when all maxWorkerCount()
+    workers are busy.
+*/
+int QProcessPool::pipelineDepth() const
+{
+    Q_D(const QProcessPool);
+    return d->pipelineDepth;
+}
+
+void QProcessPool::setPipelineDepth(int depth)
+{
+    Q_D(QProcessPool);
+    d->pipelineDepth = qMax(1, depth);
+    d->dispatch();
+}
+
+/*!
+    Returns the number of worker processes currently managed by the pool.
+*/
+int QProcessPool::workerCount() const
+{
+    Q_D(const QProcessPool);
+    return d->workers.size();
+}
+
+/*!
+    Returns the number of requests that have been sent to a worker and not
+    yet answered.
+*/
+int QProcessPool::activeRequestCount() const
+{
+    Q_D(const QProcessPool);
+    return d->activeRequestCount;
+}
+
+/*!
+    Returns the number of requests waiting for a worker.
+*/
+int QProcessPool::pendingRequestCount() const
+{
+    Q_D(const QProcessPool);
+    return d->pending.size();
+}
+
+/*!
+    Starts worker processes until \a count workers are running, so that
+    later requests do not pay for the process startup. If \a count is
+    negative, maxWorkerCount() workers are started.
+*/
+void QProcessPool::prestart(int count)
+{
+    Q_D(QProcessPool);
+    if (d->program.isEmpty()) {
+        qWarning("QProcessPool::prestart: No program set");
+        return;
+    }
+    if (count < 0 || count > d->maxWorkerCount)
+        count = d->maxWorkerCount;
+    while (d->workers.size() < count) {
+        if (!d->startWorker())
+            break;
+    }
+}
+
+/*!
+    Queues \a request for the next available worker and returns an
+    identifier for it, which is passed to replyReady() or requestFailed()
+    later. Returns -1 if no program has been set.
+*/
+qint64 QProcessPool::submit(const QByteArray &request)
+{
+    Q_D(QProcessPool);
+    if (d->program.isEmpty()) {
+        qWarning("QProcessPool::submit: No program set");
+        return -1;
+    }
+    const QProcessPoolPrivate::Request r = { d->nextRequestId++, request };
+    d->pending.enqueue(r);
+    d->dispatch();
+    return r.id;
+}
+
+/*!
+    Blocks until all submitted requests have been answered or have failed,
+    or until \a msecs milliseconds have passed. If \a msecs is -1, this
+    function will not time out. Returns \c true if the pool is idle.
+
+    The replyReady() and requestFailed() signals are emitted from within
+    this function.
+
+    \sa idle()
+*/
+bool QProcessPool::waitForDone(int msecs)
+{
+    Q_D(QProcessPool);
+    QDeadlineTimer deadline(msecs);
+    while (d->activeRequestCount || !d->pending.isEmpty()) {
+        QPointer<QProcess> process;
+        for (QProcessPoolPrivate::Worker *worker : qAsConst(d->workers)) {
+            if (!worker->inFlight.isEmpty()) {
+                process = worker->process;
+                break;
+            }
+        }
+        if (!process)
+            return false;
+        // A worker that died has been removed from the pool by now, and
+        // slots may have shut the pool down while the reply was delivered.
+        if (!process->waitForReadyRead(int(deadline.remainingTime()))
+                && process && process->state() != QProcess::NotRunning) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+    Closes the standard input of all workers and waits up to \a msecs
+    milliseconds for them to exit, killing those that do not. Requests that
+    have not been answered yet fail with QProcess::Timedout.
+
+    Call waitForDone() first to let outstanding requests complete.
+*/
+void QProcessPool::shutdown(int msecs)
+{
+    Q_D(QProcessPool);
+    const QVector<qint64> failed = d->stopWorkers(msecs);
+    for (qint64 id : failed)
+        emit requestFailed(id, QProcess::Timedout);
+    if (!failed.isEmpty())
+        emit idle();
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qprocesspool.cpp"
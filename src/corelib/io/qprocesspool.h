@@ -0,0 +1,106 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QPROCESSPOOL_H
+#define QPROCESSPOOL_H
+
+#include <QtCore/qobject.h>
+#include <QtCore/qprocess.h>
+
+QT_REQUIRE_CONFIG(processenvironment);
+
+QT_BEGIN_NAMESPACE
+
+#if QT_CONFIG(process)
+
+class QProcessPoolPrivate;
+
+class Q_CORE_EXPORT QProcessPool : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int maxWorkerCount READ maxWorkerCount WRITE setMaxWorkerCount)
+    Q_PROPERTY(int pipelineDepth READ pipelineDepth WRITE setPipelineDepth)
+public:
+    explicit QProcessPool(QObject *parent = Q_NULLPTR);
+    ~QProcessPool();
+
+    QString program() const;
+    void setProgram(const QString &program);
+
+    QStringList arguments() const;
+    void setArguments(const QStringList &arguments);
+
+    QString workingDirectory() const;
+    void setWorkingDirectory(const QString &dir);
+
+    QProcessEnvironment processEnvironment() const;
+    void setProcessEnvironment(const QProcessEnvironment &environment);
+
+    int maxWorkerCount() const;
+    void setMaxWorkerCount(int maxWorkerCount);
+
+    int pipelineDepth() const;
+    void setPipelineDepth(int depth);
+
+    int workerCount() const;
+    int activeRequestCount() const;
+    int pendingRequestCount() const;
+
+    void prestart(int count = -1);
+    qint64 submit(const QByteArray &request);
+
+    bool waitForDone(int msecs = 30000);
+    void shutdown(int msecs = 30000);
+
+Q_SIGNALS:
+    void replyReady(qint64 requestId, const QByteArray &reply);
+    void requestFailed(qint64 requestId, QProcess::ProcessError error);
+    void idle();
+
+private:
+    Q_DECLARE_PRIVATE(QProcessPool)
+    Q_DISABLE_COPY(QProcessPool)
+};
+
+#endif // QT_CONFIG(process)
+
+QT_END_NAMESPACE
+
+#endif // QPROCESSPOOL_H
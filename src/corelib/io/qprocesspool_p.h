@@ -0,0 +1,112 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QPROCESSPOOL_P_H
+#define QPROCESSPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "QtCore/qprocesspool.h"
+#include "QtCore/qbytearray.h"
+#include "QtCore/qlist.h"
+#include "QtCore/qqueue.h"
+#include "QtCore/qvector.h"
+#include "private/qobject_p.h"
+
+QT_REQUIRE_CONFIG(process);
+
+QT_BEGIN_NAMESPACE
+
+class QProcessPoolPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QProcessPool)
+public:
+    struct Request
+    {
+        qint64 id;
+        QByteArray payload;
+    };
+
+    struct Worker
+    {
+        QProcess *process;
+        QByteArray buffer;          // unparsed reply bytes
+        QQueue<qint64> inFlight;    // request ids, in submission order
+    };
+
+    QProcessPoolPrivate();
+
+    Worker *startWorker();
+    Worker *findWorker() const;
+    void dispatch();
+    void sendRequest(Worker *worker, const Request &request);
+    void readReplies(Worker *worker);
+    void workerFinished(Worker *worker, QProcess::ProcessError error);
+    void failPendingRequests(QProcess::ProcessError error);
+    QVector<qint64> stopWorkers(int msecs);
+    void checkIdle();
+
+    static QByteArray frame(const QByteArray &payload);
+
+    QString program;
+    QStringList arguments;
+    QString workingDirectory;
+    QProcessEnvironment environment;
+    int maxWorkerCount;
+    int pipelineDepth;
+    int activeRequestCount;
+    qint64 nextRequestId;
+
+    QList<Worker *> workers;
+    QQueue<Request> pending;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPROCESSPOOL_P_H
@@ -53,12 +53,17 @@
 #include <qshareddata.h>
 #include <qplatformdefs.h>
 #include "private/qabstractfileengine_p.h"
+#include "private/qbytearray_p.h"
 #include "private/qsystemerror_p.h"
 
 #ifdef Q_OS_UNIX
 # include "private/qcore_unix_p.h"
 #endif
 
+#if QT_CONFIG(zstd)
+#  include <zstd.h>
+#endif
+
 //#define DEBUG_RESOURCE_MATCH
 
 QT_BEGIN_NAMESPACE
@@ -99,8 +104,10 @@ class QResourceRoot
 {
     enum Flags
     {
+        // must match rcc.cpp
         Compressed = 0x01,
-        Directory = 0x02
+        Directory = 0x02,
+        CompressedZstd = 0x04
     };
     const uchar *tree, *names, *payloads;
     int version;
@@ -116,7 +123,15 @@ public:
     virtual ~QResourceRoot() { }
     int findNode(const QString &path, const QLocale &locale=QLocale()) const;
     inline bool isContainer(int node) const { return flags(node) & Directory; }
-    inline bool isCompressed(int node) const { return flags(node) & Compressed; }
+    inline QResource::Compression compressionAlgorithm(int node) const
+    {
+        const short f = flags(node);
+        if (f & Compressed)
+            return QResource::ZlibCompression;
+        if (f & CompressedZstd)
+            return QResource::ZstdCompression;
+        return QResource::NoCompression;
+    }
     const uchar *data(int node, qint64 *size) const;
     QDateTime lastModified(int node) const;
     QStringList children(int node) const;
@@ -195,9 +210,9 @@ static inline QStringList *resourceSearchPaths()
     which will be found in the list of paths returned by QDir::searchPaths().
 
     A QResource that is representing a file will have data backing it, this
-    data can possibly be compressed, in which case qUncompress() must be
-    used to access the real data; this happens implicitly when accessed
-    through a QFile. A QResource that is representing a directory will have
+    data can possibly be compressed, in which case the data has to be
+    decompressed according to compressionAlgorithm() to access the real
+    data; this happens implicitly when accessed through a QFile. A QResource that is representing a directory will have
     only children and no data.
 
     \section1 Dynamic Resource Loading
@@ -243,7 +258,7 @@ public:
     QString fileName, absoluteFilePath;
     QList<QResourceRoot*> related;
     uint container : 1;
-    mutable uint compressed : 1;
+    mutable uint compressionAlgo : 2;
     mutable qint64 size;
     mutable const uchar *data;
     mutable QStringList children;
@@ -257,7 +272,7 @@ void
 QResourcePrivate::clear()
 {
     absoluteFilePath.clear();
-    compressed = 0;
+    compressionAlgo = QResource::NoCompression;
     data = 0;
     size = 0;
     children.clear();
@@ -286,11 +301,11 @@ QResourcePrivate::load(const QString &file)
                 container = res->isContainer(node);
                 if(!container) {
                     data = res->data(node, &size);
-                    compressed = res->isCompressed(node);
+                    compressionAlgo = res->compressionAlgorithm(node);
                 } else {
                     data = 0;
                     size = 0;
-                    compressed = 0;
+                    compressionAlgo = QResource::NoCompression;
                 }
                 lastModified = res->lastModified(node);
             } else if(res->isContainer(node) != container) {
@@ -302,7 +317,7 @@ QResourcePrivate::load(const QString &file)
             container = true;
             data = 0;
             size = 0;
-            compressed = 0;
+            compressionAlgo = QResource::NoCompression;
             lastModified = QDateTime();
             res->ref.ref();
             related.append(res);
@@ -490,18 +505,49 @@ bool QResource::isValid() const
 */
 
 
+/*!
+    \enum QResource::Compression
+    \since 5.10
+
+    This enum describes how the data backing a resource is stored.
+
+    \value NoCompression       The data is stored uncompressed.
+    \value ZlibCompression     The data is compressed with zlib and can be
+                               decompressed with qUncompress().
+    \value ZstdCompression     The data is compressed with Zstandard. It can
+                               only be read through QFile if Qt was built with
+                               Zstandard support.
+
+    \sa compressionAlgorithm()
+*/
+
 /*!
     Returns \c true if the resource represents a file and the data backing it
     is in a compressed format, false otherwise.
 
-    \sa data(), isFile()
+    \sa data(), compressionAlgorithm(), isFile()
 */
 
 bool QResource::isCompressed() const
+{
+    return compressionAlgorithm() != NoCompression;
+}
+
+/*!
+    \since 5.10
+
+    Returns the compression algorithm used for the data backing the
+    resource, or NoCompression if the data is stored uncompressed or the
+    resource is a directory.
+
+    \sa data(), isCompressed()
+*/
+
+QResource::Compression QResource::compressionAlgorithm() const
 {
     Q_D(const QResource);
     d->ensureInitialized();
-    return d->compressed;
+    return Compression(d->compressionAlgo);
 }
 
 /*!
@@ -519,11 +565,12 @@ qint64 QResource::size() const
 
 /*!
     Returns direct access to a read only segment of data that this resource
-    represents. If the resource is compressed the data returns is
-    compressed and qUncompress() must be used to access the data. If the
-    resource is a directory 0 is returned.
+    represents. If the resource is compressed the data returned is
+    compressed and has to be decompressed according to
+    compressionAlgorithm() to access it, for zlib compressed resources
+    with qUncompress(). If the resource is a directory 0 is returned.
 
-    \sa size(), isCompressed(), isFile()
+    \sa size(), compressionAlgorithm(), isFile()
 */
 
 const uchar *QResource::data() const
@@ -860,7 +907,7 @@ Q_CORE_EXPORT bool qRegisterResourceData(int version, const unsigned char *tree,
                                          const unsigned char *name, const unsigned char *data)
 {
     QMutexLocker lock(resourceMutex());
-    if ((version == 0x01 || version == 0x2) && resourceList()) {
+    if (version >= 0x01 && version <= 0x03 && resourceList()) {
         bool found = false;
         QResourceRoot res(version, tree, name, data);
         for(int i = 0; i < resourceList()->size(); ++i) {
@@ -886,7 +933,7 @@ Q_CORE_EXPORT bool qUnregisterResourceData(int version, const unsigned char *tre
         return false;
 
     QMutexLocker lock(resourceMutex());
-    if ((version == 0x01 || version == 0x02) && resourceList()) {
+    if (version >= 0x01 && version <= 0x03 && resourceList()) {
         QResourceRoot res(version, tree, name, data);
         for(int i = 0; i < resourceList()->size(); ) {
             if(*resourceList()->at(i) == res) {
@@ -949,7 +996,7 @@ public:
         if (size >= 0 && (tree_offset >= size || data_offset >= size || name_offset >= size))
             return false;
 
-        if (version == 0x01 || version == 0x02) {
+        if (version >= 0x01 && version <= 0x03) {
             buffer = b;
             setSource(version, b+tree_offset, b+name_offset, b+data_offset);
             return true;
@@ -1526,12 +1573,43 @@ bool QResourceFileEnginePrivate::unmap(uchar *ptr)
 
 void QResourceFileEnginePrivate::uncompress() const
 {
-    if (resource.isCompressed() && uncompressed.isEmpty() && resource.size()) {
+    if (!resource.isCompressed() || !uncompressed.isEmpty() || !resource.size())
+        return;
+
+    switch (resource.compressionAlgorithm()) {
+    case QResource::NoCompression:
+        break;
+    case QResource::ZlibCompression:
 #ifndef QT_NO_COMPRESS
         uncompressed = qUncompress(resource.data(), resource.size());
 #else
         Q_ASSERT(!"QResourceFileEngine::open: Qt built without support for compression");
 #endif
+        break;
+    case QResource::ZstdCompression:
+#if QT_CONFIG(zstd)
+    {
+        const unsigned long long size = ZSTD_getFrameContentSize(resource.data(), resource.size());
+        if (size == ZSTD_CONTENTSIZE_UNKNOWN || size == ZSTD_CONTENTSIZE_ERROR
+                || size > unsigned(MaxByteArraySize)) {
+            qWarning("QResourceFileEngine::open: Invalid Zstandard frame in %s",
+                     qPrintable(resource.fileName()));
+            break;
+        }
+        QByteArray result(int(size), Qt::Uninitialized);
+        const size_t decompressed = ZSTD_decompress(result.data(), result.size(),
+                                                    resource.data(), resource.size());
+        if (ZSTD_isError(decompressed) || decompressed != size) {
+            qWarning("QResourceFileEngine::open: Failed to decompress %s",
+                     qPrintable(resource.fileName()));
+            break;
+        }
+        uncompressed = result;
+    }
+#else
+        qWarning("QResourceFileEngine::open: Qt built without support for Zstandard compression");
+#endif
+        break;
     }
 }
 
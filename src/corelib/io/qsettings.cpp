@@ -1440,6 +1440,7 @@ void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
 
     if (mustReadFile) {
         confFile->unparsedIniSections.clear();
+        confFile->unparsedIniData.clear();
         confFile->originalKeys.clear();
 
         QFile file(confFile->name);
@@ -1461,8 +1462,11 @@ void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
             } else
 #endif
             if (format <= QSettings::IniFormat) {
-                QByteArray data = file.readAll();
-                ok = readIniFile(data, &confFile->unparsedIniSections);
+                // The unparsed sections refer to this buffer without copying it.
+                confFile->unparsedIniData = file.readAll();
+                ok = readIniFile(confFile->unparsedIniData, &confFile->unparsedIniSections);
+                if (confFile->unparsedIniSections.isEmpty())
+                    confFile->unparsedIniData.clear();
             } else if (readFunc) {
                 QSettings::SettingsMap tempNewKeys;
                 ok = readFunc(file, tempNewKeys);
@@ -1491,7 +1495,15 @@ void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
     */
     if (!readOnly) {
         bool ok = false;
-        ensureAllSectionsParsed(confFile);
+        /*
+            Sections that were not modified are written back verbatim,
+            so only the ones containing added or removed keys need to be
+            parsed.
+        */
+        if (format <= QSettings::IniFormat)
+            ensureModifiedSectionsParsed(confFile);
+        else
+            ensureAllSectionsParsed(confFile);
         ParsedSettingsMap mergedKeys = confFile->mergedKeyMap();
 
 #if !defined(QT_BOOTSTRAPPED) && QT_CONFIG(temporaryfile)
@@ -1510,7 +1522,7 @@ void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
         } else
 #endif
         if (format <= QSettings::IniFormat) {
-            ok = writeIniFile(sf, mergedKeys);
+            ok = writeIniFile(sf, mergedKeys, confFile->unparsedIniSections);
         } else if (writeFunc) {
             QSettings::SettingsMap tempOriginalKeys;
 
@@ -1528,7 +1540,7 @@ void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
 #endif
 
         if (ok) {
-            confFile->unparsedIniSections.clear();
+            // unparsedIniSections are still valid, they were written unchanged
             confFile->originalKeys = mergedKeys;
             confFile->addedKeys.clear();
             confFile->removedKeys.clear();
@@ -1644,6 +1656,10 @@ break_out_of_outer_loop:
     possible, so if the user doesn't check the status he will get the
     most out of the file anyway.
 */
+/*
+    The section data stored in \a unparsedIniSections refers to \a data
+    without copying it, so \a data must outlive the map entries.
+*/
 bool QConfFileSettingsPrivate::readIniFile(const QByteArray &data,
                                            UnparsedSettingsMap *unparsedIniSections)
 {
@@ -1652,9 +1668,14 @@ bool QConfFileSettingsPrivate::readIniFile(const QByteArray &data,
         QByteArray &sectionData = (*unparsedIniSections)[QSettingsKey(currentSection, \
                                                                       IniCaseSensitivity, \
                                                                       sectionPosition)]; \
-        if (!sectionData.isEmpty()) \
+        const char *sectionStart = data.constData() + currentSectionStart; \
+        const int sectionSize = lineStart - currentSectionStart; \
+        if (sectionData.isEmpty()) { \
+            sectionData = QByteArray::fromRawData(sectionStart, sectionSize); \
+        } else { \
             sectionData.append('\n'); \
-        sectionData += data.mid(currentSectionStart, lineStart - currentSectionStart); \
+            sectionData.append(sectionStart, sectionSize); \
+        } \
         sectionPosition = ++position; \
     }
 
@@ -1804,11 +1825,39 @@ struct QSettingsIniSection
 
 typedef QMap<QString, QSettingsIniSection> IniMap;
 
+static QByteArray iniSectionHeader(const QString &section)
+{
+    QByteArray realSection;
+
+    QSettingsPrivate::iniEscapedKey(section, realSection);
+
+    if (realSection.isEmpty()) {
+        realSection = "[General]";
+    } else if (qstricmp(realSection.constData(), "general") == 0) {
+        realSection = "[%General]";
+    } else {
+        realSection.prepend('[');
+        realSection.append(']');
+    }
+    return realSection;
+}
+
+static bool unparsedSectionLessThan(UnparsedSettingsMap::const_iterator i1,
+                                    UnparsedSettingsMap::const_iterator i2)
+{
+    return i1.key().originalKeyPosition() < i2.key().originalKeyPosition();
+}
+
 /*
     This would be more straightforward if we didn't try to remember the original
     key order in the .ini file, but we do.
+
+    Sections in \a unparsedSections are copied to \a device as they are,
+    interleaved with the sections built from \a map according to their
+    original position.
 */
-bool QConfFileSettingsPrivate::writeIniFile(QIODevice &device, const ParsedSettingsMap &map)
+bool QConfFileSettingsPrivate::writeIniFile(QIODevice &device, const ParsedSettingsMap &map,
+                                            const UnparsedSettingsMap &unparsedSections)
 {
     IniMap iniMap;
     IniMap::const_iterator i;
@@ -1844,37 +1893,69 @@ bool QConfFileSettingsPrivate::writeIniFile(QIODevice &device, const ParsedSetti
         sections.append(QSettingsIniKey(i.key(), i.value().position));
     std::sort(sections.begin(), sections.end());
 
+    QVector<UnparsedSettingsMap::const_iterator> unparsed;
+    unparsed.reserve(unparsedSections.size());
+    for (auto u = unparsedSections.constBegin(); u != unparsedSections.constEnd(); ++u)
+        unparsed.append(u);
+    std::sort(unparsed.begin(), unparsed.end(), unparsedSectionLessThan);
+
     bool writeError = false;
-    for (int j = 0; !writeError && j < sectionCount; ++j) {
+    bool firstSection = true;
+    int j = 0;
+    int k = 0;
+    while (!writeError && (j < sectionCount || k < unparsed.size())) {
+        if (k < unparsed.size()
+                && (j == sectionCount
+                    || unparsed.at(k).key().originalKeyPosition() < sections.at(j).position)) {
+            const UnparsedSettingsMap::const_iterator u = unparsed.at(k++);
+            int dataPos = 0;
+            int lineStart;
+            int lineLen;
+            int equalsPos;
+            if (!readIniLine(u.value(), dataPos, lineStart, lineLen, equalsPos))
+                continue; // only comments, nothing to preserve
+
+            QString name = u.key().originalCaseKey();
+            name.chop(1); // trailing '/'
+            QByteArray realSection = iniSectionHeader(name);
+            if (!firstSection)
+                realSection.prepend(eol);
+            realSection += eol;
+            firstSection = false;
+
+            // strip trailing blank lines, so they do not pile up across syncs
+            const QByteArray &data = u.value();
+            int size = data.size();
+            while (size > 0 && (charTraits[uint(uchar(data.at(size - 1)))] & Space))
+                --size;
+            realSection.append(data.constData(), size);
+            if (size)
+                realSection += eol;
+            if (device.write(realSection) == -1)
+                writeError = true;
+            continue;
+        }
+
         i = iniMap.constFind(sections.at(j));
         Q_ASSERT(i != iniMap.constEnd());
 
-        QByteArray realSection;
-
-        iniEscapedKey(i.key(), realSection);
+        QByteArray realSection = iniSectionHeader(i.key());
 
-        if (realSection.isEmpty()) {
-            realSection = "[General]";
-        } else if (qstricmp(realSection.constData(), "general") == 0) {
-            realSection = "[%General]";
-        } else {
-            realSection.prepend('[');
-            realSection.append(']');
-        }
-
-        if (j != 0)
+        if (!firstSection)
             realSection.prepend(eol);
         realSection += eol;
+        firstSection = false;
+        ++j;
 
         device.write(realSection);
 
         const IniKeyMap &ents = i.value().keyMap;
-        for (IniKeyMap::const_iterator j = ents.constBegin(); j != ents.constEnd(); ++j) {
+        for (IniKeyMap::const_iterator e = ents.constBegin(); e != ents.constEnd(); ++e) {
             QByteArray block;
-            iniEscapedKey(j.key(), block);
+            iniEscapedKey(e.key(), block);
             block += '=';
 
-            const QVariant &value = j.value();
+            const QVariant &value = e.value();
 
             /*
                 The size() != 1 trick is necessary because
@@ -1907,6 +1988,17 @@ void QConfFileSettingsPrivate::ensureAllSectionsParsed(QConfFile *confFile) cons
             setStatus(QSettings::FormatError);
     }
     confFile->unparsedIniSections.clear();
+    confFile->unparsedIniData.clear();
+}
+
+void QConfFileSettingsPrivate::ensureModifiedSectionsParsed(QConfFile *confFile) const
+{
+    ParsedSettingsMap::const_iterator i = confFile->addedKeys.constBegin();
+    for (; i != confFile->addedKeys.constEnd() && !confFile->unparsedIniSections.isEmpty(); ++i)
+        ensureSectionParsed(confFile, i.key());
+    i = confFile->removedKeys.constBegin();
+    for (; i != confFile->removedKeys.constEnd() && !confFile->unparsedIniSections.isEmpty(); ++i)
+        ensureSectionParsed(confFile, i.key());
 }
 
 void QConfFileSettingsPrivate::ensureSectionParsed(QConfFile *confFile,
@@ -1934,6 +2026,8 @@ void QConfFileSettingsPrivate::ensureSectionParsed(QConfFile *confFile,
     if (!QConfFileSettingsPrivate::readIniSection(i.key(), i.value(), &confFile->originalKeys, iniCodec))
         setStatus(QSettings::FormatError);
     confFile->unparsedIniSections.erase(i);
+    if (confFile->unparsedIniSections.isEmpty())
+        confFile->unparsedIniData.clear();
 }
 
 /*!
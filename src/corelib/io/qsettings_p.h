@@ -160,6 +160,7 @@ public:
     QString name;
     QDateTime timeStamp;
     qint64 size;
+    QByteArray unparsedIniData; // backs the raw data of unparsedIniSections
     UnparsedSettingsMap unparsedIniSections;
     ParsedSettingsMap originalKeys;
     ParsedSettingsMap addedKeys;
@@ -280,12 +281,14 @@ private:
     void initFormat();
     void initAccess();
     void syncConfFile(QConfFile *confFile);
-    bool writeIniFile(QIODevice &device, const ParsedSettingsMap &map);
+    bool writeIniFile(QIODevice &device, const ParsedSettingsMap &map,
+                      const UnparsedSettingsMap &unparsedSections = UnparsedSettingsMap());
 #ifdef Q_OS_MAC
     bool readPlistFile(const QByteArray &data, ParsedSettingsMap *map) const;
     bool writePlistFile(QIODevice &file, const ParsedSettingsMap &map) const;
 #endif
     void ensureAllSectionsParsed(QConfFile *confFile) const;
+    void ensureModifiedSectionsParsed(QConfFile *confFile) const;
     void ensureSectionParsed(QConfFile *confFile, const QSettingsKey &key) const;
 
     QVector<QConfFile *> confFiles;
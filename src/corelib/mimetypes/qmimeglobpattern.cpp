@@ -98,54 +98,69 @@ void QMimeGlobMatchResult::addMatch(const QString &mimeType, int weight, const Q
     \sa QMimeType, QMimeDatabase, QMimeMagicRuleMatcher, QMimeMagicRule
 */
 
-bool QMimeGlobPattern::matchFileName(const QString &inputFilename) const
+QMimeGlobPattern::PatternType QMimeGlobPattern::detectPatternType(const QString &pattern)
+{
+    const int patternLength = pattern.length();
+    if (!patternLength)
+        return OtherPattern;
+
+    const int starCount = pattern.count(QLatin1Char('*'));
+    const bool hasSquareBracket = pattern.indexOf(QLatin1Char('[')) != -1;
+    const bool hasQuestionMark = pattern.indexOf(QLatin1Char('?')) != -1;
+    if (hasSquareBracket || hasQuestionMark)
+        return OtherPattern;
+
+    switch (starCount) {
+    case 0:
+        return LiteralPattern;
+    case 1:
+        // Patterns like "*~", "*.extension"
+        if (pattern.at(0) == QLatin1Char('*'))
+            return SuffixPattern;
+        // Patterns like "README*" (well this is currently the only one like that...)
+        if (pattern.at(patternLength - 1) == QLatin1Char('*'))
+            return PrefixPattern;
+        break;
+    default:
+        break;
+    }
+    return OtherPattern;
+}
+
+/*!
+    Returns \c true if \a filename matches the pattern. \a lowerFilename must
+    be \a filename converted to lower case; it is passed separately so that
+    callers matching one file name against many patterns only convert it once.
+*/
+bool QMimeGlobPattern::matchFileName(const QString &filename, const QString &lowerFilename) const
 {
     // "Applications MUST match globs case-insensitively, except when the case-sensitive
     // attribute is set to true."
     // The constructor takes care of putting case-insensitive patterns in lowercase.
-    const QString filename = m_caseSensitivity == Qt::CaseInsensitive ? inputFilename.toLower() : inputFilename;
+    const QString &name = m_caseSensitivity == Qt::CaseInsensitive ? lowerFilename : filename;
 
-    const int pattern_len = m_pattern.length();
-    if (!pattern_len)
+    const int patternLength = m_pattern.length();
+    if (!patternLength)
         return false;
-    const int len = filename.length();
 
-    const int starCount = m_pattern.count(QLatin1Char('*'));
-
-    // Patterns like "*~", "*.extension"
-    if (m_pattern[0] == QLatin1Char('*') && m_pattern.indexOf(QLatin1Char('[')) == -1 && starCount == 1)
-    {
-        if (len + 1 < pattern_len) return false;
-
-        const QChar *c1 = m_pattern.unicode() + pattern_len - 1;
-        const QChar *c2 = filename.unicode() + len - 1;
-        int cnt = 1;
-        while (cnt < pattern_len && *c1-- == *c2--)
-            ++cnt;
-        return cnt == pattern_len;
-    }
-
-    // Patterns like "README*" (well this is currently the only one like that...)
-    if (starCount == 1 && m_pattern.at(pattern_len - 1) == QLatin1Char('*')) {
-        if (len + 1 < pattern_len) return false;
-        if (m_pattern.at(0) == QLatin1Char('*'))
-            return filename.indexOf(m_pattern.midRef(1, pattern_len - 2)) != -1;
-
-        const QChar *c1 = m_pattern.unicode();
-        const QChar *c2 = filename.unicode();
-        int cnt = 1;
-        while (cnt < pattern_len && *c1++ == *c2++)
-           ++cnt;
-        return cnt == pattern_len;
+    switch (m_patternType) {
+    case SuffixPattern:
+        if (name.length() + 1 < patternLength)
+            return false;
+        return name.endsWith(m_pattern.midRef(1));
+    case PrefixPattern:
+        if (name.length() + 1 < patternLength)
+            return false;
+        return name.startsWith(m_pattern.leftRef(patternLength - 1));
+    case LiteralPattern:
+        return m_pattern == name;
+    case OtherPattern:
+        break;
     }
 
-    // Names without any wildcards like "README"
-    if (m_pattern.indexOf(QLatin1Char('[')) == -1 && starCount == 0 && m_pattern.indexOf(QLatin1Char('?')))
-        return (m_pattern == filename);
-
     // Other (quite rare) patterns, like "*.anim[1-9j]": use slow but correct method
     QRegExp rx(m_pattern, Qt::CaseSensitive, QRegExp::WildcardUnix);
-    return rx.exactMatch(filename);
+    return rx.exactMatch(name);
 }
 
 static bool isFastPattern(const QString &pattern)
@@ -194,14 +209,14 @@ void QMimeAllGlobPatterns::removeMimeType(const QString &mimeType)
 }
 
 void QMimeGlobPatternList::match(QMimeGlobMatchResult &result,
-                                 const QString &fileName) const
+                                 const QString &fileName, const QString &lowerFileName) const
 {
 
     QMimeGlobPatternList::const_iterator it = this->constBegin();
     const QMimeGlobPatternList::const_iterator endIt = this->constEnd();
     for (; it != endIt; ++it) {
         const QMimeGlobPattern &glob = *it;
-        if (glob.matchFileName(fileName))
+        if (glob.matchFileName(fileName, lowerFileName))
             result.addMatch(glob.mimeType(), glob.weight(), glob.pattern());
     }
 }
@@ -210,26 +225,29 @@ QMimeGlobMatchResult QMimeAllGlobPatterns::matchingGlobs(const QString &fileName
 {
     // First try the high weight matches (>50), if any.
     QMimeGlobMatchResult result;
-    m_highWeightGlobs.match(result, fileName);
+    const QString lowerFileName = fileName.toLower();
+    m_highWeightGlobs.match(result, fileName, lowerFileName);
 
     // Now use the "fast patterns" dict, for simple *.foo patterns with weight 50
     // (which is most of them, so this optimization is definitely worth it)
-    const int lastDot = fileName.lastIndexOf(QLatin1Char('.'));
+    const int lastDot = lowerFileName.lastIndexOf(QLatin1Char('.'));
     if (lastDot != -1) { // if no '.', skip the extension lookup
-        const int ext_len = fileName.length() - lastDot - 1;
-        const QString simpleExtension = fileName.right(ext_len).toLower();
-        // (toLower because fast patterns are always case-insensitive and saved as lowercase)
-
-        const QStringList matchingMimeTypes = m_fastPatterns.value(simpleExtension);
-        const QString simplePattern = QLatin1String("*.") + simpleExtension;
-        for (const QString &mime : matchingMimeTypes)
-            result.addMatch(mime, 50, simplePattern);
+        const int ext_len = lowerFileName.length() - lastDot - 1;
+        // (lower case because fast patterns are always case-insensitive and saved as lowercase)
+        const QString simpleExtension = lowerFileName.right(ext_len);
+
+        const PatternsMap::const_iterator it = m_fastPatterns.constFind(simpleExtension);
+        if (it != m_fastPatterns.constEnd()) {
+            const QString simplePattern = QLatin1String("*.") + simpleExtension;
+            for (const QString &mime : it.value())
+                result.addMatch(mime, 50, simplePattern);
+        }
         // Can't return yet; *.tar.bz2 has to win over *.bz2, so we need the low-weight mimetypes anyway,
         // at least those with weight 50.
     }
 
     // Finally, try the low weight matches (<=50)
-    m_lowWeightGlobs.match(result, fileName);
+    m_lowWeightGlobs.match(result, fileName, lowerFileName);
 
     return result;
 }
@@ -84,7 +84,8 @@ public:
 
     explicit QMimeGlobPattern(const QString &thePattern, const QString &theMimeType, unsigned theWeight = DefaultWeight, Qt::CaseSensitivity s = Qt::CaseInsensitive) :
         m_pattern(s == Qt::CaseInsensitive ? thePattern.toLower() : thePattern),
-        m_mimeType(theMimeType), m_weight(theWeight), m_caseSensitivity(s)
+        m_mimeType(theMimeType), m_weight(theWeight), m_caseSensitivity(s),
+        m_patternType(detectPatternType(m_pattern))
     {
     }
 
@@ -94,9 +95,12 @@ public:
         qSwap(m_mimeType,        other.m_mimeType);
         qSwap(m_weight,          other.m_weight);
         qSwap(m_caseSensitivity, other.m_caseSensitivity);
+        qSwap(m_patternType,     other.m_patternType);
     }
 
-    bool matchFileName(const QString &filename) const;
+    bool matchFileName(const QString &filename) const
+    { return matchFileName(filename, isCaseSensitive() ? filename : filename.toLower()); }
+    bool matchFileName(const QString &filename, const QString &lowerFilename) const;
 
     inline const QString &pattern() const { return m_pattern; }
     inline unsigned weight() const { return m_weight; }
@@ -104,10 +108,19 @@ public:
     inline bool isCaseSensitive() const { return m_caseSensitivity == Qt::CaseSensitive; }
 
 private:
+    enum PatternType {
+        SuffixPattern,      // "*.txt", "*~"
+        PrefixPattern,      // "README*"
+        LiteralPattern,     // "Makefile"
+        OtherPattern        // "*.anim[1-9j]", matched with QRegExp
+    };
+    static PatternType detectPatternType(const QString &pattern);
+
     QString m_pattern;
     QString m_mimeType;
     int m_weight;
     Qt::CaseSensitivity m_caseSensitivity;
+    PatternType m_patternType;
 };
 Q_DECLARE_SHARED(QMimeGlobPattern)
 
@@ -135,7 +148,9 @@ public:
         erase(std::remove_if(begin(), end(), isMimeTypeEqual), end());
     }
 
-    void match(QMimeGlobMatchResult &result, const QString &fileName) const;
+    void match(QMimeGlobMatchResult &result, const QString &fileName) const
+    { match(result, fileName, fileName.toLower()); }
+    void match(QMimeGlobMatchResult &result, const QString &fileName, const QString &lowerFileName) const;
 };
 
 /*!
@@ -135,8 +135,10 @@ bool QMimeMagicRule::matchSubstring(const char *dataPtr, int dataSize, int range
                     break;
                 }
             }
-            if (valid)
+            if (valid) {
                 found = true;
+                break;
+            }
         }
         if (!found)
             return false;
@@ -148,7 +150,9 @@ bool QMimeMagicRule::matchSubstring(const char *dataPtr, int dataSize, int range
 bool QMimeMagicRule::matchString(const QByteArray &data) const
 {
     const int rangeLength = m_endPos - m_startPos + 1;
-    return QMimeMagicRule::matchSubstring(data.constData(), data.size(), m_startPos, rangeLength, m_pattern.size(), m_pattern.constData(), m_mask.constData());
+    // Rules without a mask take the plain memcmp() path in matchSubstring()
+    const char *mask = m_mask.isEmpty() ? nullptr : m_mask.constData();
+    return QMimeMagicRule::matchSubstring(data.constData(), data.size(), m_startPos, rangeLength, m_pattern.size(), m_pattern.constData(), mask);
 }
 
 template <typename T>
@@ -285,10 +289,8 @@ QMimeMagicRule::QMimeMagicRule(const QString &type,
                 return;
             }
             m_mask = tempMask;
-        } else {
-            m_mask.fill(char(-1), m_pattern.size());
+            m_mask.squeeze();
         }
-        m_mask.squeeze();
         m_matchFunction = &QMimeMagicRule::matchString;
         break;
     case Byte:
@@ -336,7 +338,7 @@ QMimeMagicRule::QMimeMagicRule(const QString &type,
 QByteArray QMimeMagicRule::mask() const
 {
     QByteArray result = m_mask;
-    if (m_type == String) {
+    if (m_type == String && !result.isEmpty()) {
         // restore '0x'
         result = "0x" + result.toHex();
     }
@@ -54,6 +54,8 @@
 #include <QDateTime>
 #include <QtEndian>
 
+#include <algorithm>
+
 static void initResources()
 {
     Q_INIT_RESOURCE(mimetypes);
@@ -126,10 +128,15 @@ struct QMimeBinaryProvider::CacheFile
     uchar *data;
     QDateTime m_mtime;
     bool m_valid;
+
+    // The literal and complex glob lists, compiled on first use
+    QMimeGlobPatternList m_literalGlobs;
+    QMimeGlobPatternList m_complexGlobs;
+    bool m_globListsLoaded;
 };
 
 QMimeBinaryProvider::CacheFile::CacheFile(const QString &fileName)
-    : file(fileName), m_valid(false)
+    : file(fileName), m_valid(false), m_globListsLoaded(false)
 {
     load();
 }
@@ -160,6 +167,9 @@ bool QMimeBinaryProvider::CacheFile::reload()
         file.close();
     }
     data = 0;
+    m_literalGlobs.clear();
+    m_complexGlobs.clear();
+    m_globListsLoaded = false;
     return load();
 }
 
@@ -296,10 +306,15 @@ QMimeGlobMatchResult QMimeBinaryProvider::findByFileName(const QString &fileName
     const QString lowerFileName = fileName.toLower();
     // TODO this parses in the order (local, global). Check that it handles "NOGLOBS" correctly.
     for (CacheFile *cacheFile : qAsConst(m_cacheFiles)) {
+        if (!cacheFile->m_globListsLoaded) {
+            loadGlobList(cacheFile->m_literalGlobs, cacheFile, cacheFile->getUint32(PosLiteralListOffset));
+            loadGlobList(cacheFile->m_complexGlobs, cacheFile, cacheFile->getUint32(PosGlobListOffset));
+            cacheFile->m_globListsLoaded = true;
+        }
         // Check literals (e.g. "Makefile")
-        matchGlobList(result, cacheFile, cacheFile->getUint32(PosLiteralListOffset), fileName);
+        cacheFile->m_literalGlobs.match(result, fileName, lowerFileName);
         // Check complex globs (e.g. "callgrind.out[0-9]*")
-        matchGlobList(result, cacheFile, cacheFile->getUint32(PosGlobListOffset), fileName);
+        cacheFile->m_complexGlobs.match(result, fileName, lowerFileName);
         // Check the very common *.txt cases with the suffix tree
         const int reverseSuffixTreeOffset = cacheFile->getUint32(PosReverseSuffixTreeOffset);
         const int numRoots = cacheFile->getUint32(reverseSuffixTreeOffset);
@@ -311,10 +326,11 @@ QMimeGlobMatchResult QMimeBinaryProvider::findByFileName(const QString &fileName
     return result;
 }
 
-void QMimeBinaryProvider::matchGlobList(QMimeGlobMatchResult &result, CacheFile *cacheFile, int off, const QString &fileName)
+void QMimeBinaryProvider::loadGlobList(QMimeGlobPatternList &globs, CacheFile *cacheFile, int off)
 {
     const int numGlobs = cacheFile->getUint32(off);
     //qDebug() << "Loading" << numGlobs << "globs from" << cacheFile->file.fileName() << "at offset" << cacheFile->globListOffset;
+    globs.reserve(numGlobs);
     for (int i = 0; i < numGlobs; ++i) {
         const int globOffset = cacheFile->getUint32(off + 4 + 12 * i);
         const int mimeTypeOffset = cacheFile->getUint32(off + 4 + 12 * i + 4);
@@ -326,11 +342,7 @@ void QMimeBinaryProvider::matchGlobList(QMimeGlobMatchResult &result, CacheFile
 
         const char *mimeType = cacheFile->getCharStar(mimeTypeOffset);
         //qDebug() << pattern << mimeType << weight << caseSensitive;
-        QMimeGlobPattern glob(pattern, QString() /*unused*/, weight, qtCaseSensitive);
-
-        // TODO: this could be done faster for literals where a simple == would do.
-        if (glob.matchFileName(fileName))
-            result.addMatch(QLatin1String(mimeType), weight, pattern);
+        globs.append(QMimeGlobPattern(pattern, QLatin1String(mimeType), weight, qtCaseSensitive));
     }
 }
 
@@ -742,13 +754,16 @@ QMimeType QMimeXMLProvider::findByMagic(const QByteArray &data, int *accuracyPtr
 
     QString candidate;
 
+    // The matchers are sorted by decreasing priority, so the first one that
+    // matches wins and none of the ones after it can beat the current accuracy.
     for (const QMimeMagicRuleMatcher &matcher : qAsConst(m_magicMatchers)) {
+        const int priority = matcher.priority();
+        if (priority <= *accuracyPtr)
+            break;
         if (matcher.matches(data)) {
-            const int priority = matcher.priority();
-            if (priority > *accuracyPtr) {
-                *accuracyPtr = priority;
-                candidate = matcher.mimetype();
-            }
+            *accuracyPtr = priority;
+            candidate = matcher.mimetype();
+            break;
         }
     }
     return mimeTypeForName(candidate);
@@ -793,6 +808,12 @@ void QMimeXMLProvider::ensureLoaded()
 
         for (const QString &file : qAsConst(allFiles))
             load(file);
+
+        // Stable, so that matchers of equal priority keep the order of the XML files
+        std::stable_sort(m_magicMatchers.begin(), m_magicMatchers.end(),
+                         [](const QMimeMagicRuleMatcher &lhs, const QMimeMagicRuleMatcher &rhs) {
+                             return lhs.priority() > rhs.priority();
+                         });
     }
 }
 
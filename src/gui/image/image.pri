@@ -7,6 +7,8 @@ HEADERS += \
         image/qbitmap.h \
         image/qimage.h \
         image/qimage_p.h \
+        image/qimagecache.h \
+        image/qimagecache_p.h \
         image/qimageiohandler.h \
         image/qimagereader.h \
         image/qimagewriter.h \
@@ -31,6 +33,7 @@ SOURCES += \
         image/qbitmap.cpp \
         image/qimage.cpp \
         image/qimage_conversions.cpp \
+        image/qimagecache.cpp \
         image/qimageiohandler.cpp \
         image/qimagereader.cpp \
         image/qimagewriter.cpp \
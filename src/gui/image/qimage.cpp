@@ -66,6 +66,12 @@
 #include <private/qimage_p.h>
 #include <private/qfont_p.h>
 
+#ifndef QT_NO_THREAD
+#include <qsemaphore.h>
+#include <qsharedpointer.h>
+#include <qthreadpool.h>
+#endif
+
 QT_BEGIN_NAMESPACE
 
 static inline bool isLocked(QImageData *data)
@@ -89,6 +95,132 @@ static QImage rotated90(const QImage &src);
 static QImage rotated180(const QImage &src);
 static QImage rotated270(const QImage &src);
 
+// Images with fewer pixels are always processed on the calling thread,
+// QT_IMAGE_PARALLEL_THRESHOLD overrides the default and 0 disables threading
+static int qt_imageParallelThreshold()
+{
+    static const int threshold = qEnvironmentVariableIsSet("QT_IMAGE_PARALLEL_THRESHOLD")
+            ? qEnvironmentVariableIntValue("QT_IMAGE_PARALLEL_THRESHOLD")
+            : 512 * 512;
+    return threshold;
+}
+
+static inline int qt_imageSegmentStart(int height, int segmentCount, int segment)
+{
+    return int(qint64(height) * segment / segmentCount);
+}
+
+#ifndef QT_NO_THREAD
+namespace {
+struct QImageTaskJob
+{
+    QImageTaskJob(int taskCount, const std::function<void(int)> &function)
+        : function(function), taskCount(taskCount), nextTask(0)
+    {}
+
+    // Processes the next unclaimed task, returns false when none is left
+    bool processNextTask()
+    {
+        const int task = nextTask.fetchAndAddRelaxed(1);
+        if (task >= taskCount)
+            return false;
+        function(task);
+        finishedTasks.release();
+        return true;
+    }
+
+    std::function<void(int)> function;
+    const int taskCount;
+    QAtomicInt nextTask;
+    QSemaphore finishedTasks;
+};
+
+// Helps the calling thread with a job. The job is shared, since a runnable
+// may only get to run after the calling thread has finished all tasks.
+class QImageTaskRunnable : public QRunnable
+{
+public:
+    explicit QImageTaskRunnable(const QSharedPointer<QImageTaskJob> &job)
+        : job(job)
+    {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        while (job->processNextTask()) { }
+    }
+
+private:
+    QSharedPointer<QImageTaskJob> job;
+};
+} // unnamed namespace
+#endif // QT_NO_THREAD
+
+/*
+    Calls \a function(task) for every task from 0 to \a taskCount - 1 and
+    returns when all of them are done. Tasks are handed out in order to the
+    calling thread and to as many threads of \a threadPool as it has room
+    for, so the pool is never blocked waiting for itself. Passing a null
+    \a threadPool runs all tasks on the calling thread.
+*/
+void qt_imageProcessTasks(int taskCount, QThreadPool *threadPool,
+                          const std::function<void(int)> &function)
+{
+#ifndef QT_NO_THREAD
+    const int helperCount = threadPool ? qMin(taskCount, threadPool->maxThreadCount()) - 1 : 0;
+    if (helperCount > 0) {
+        QSharedPointer<QImageTaskJob> job(new QImageTaskJob(taskCount, function));
+        for (int i = 0; i < helperCount; ++i) {
+            // Never queue, a busy pool might be waiting for us
+            QImageTaskRunnable *runnable = new QImageTaskRunnable(job);
+            if (!threadPool->tryStart(runnable)) {
+                delete runnable;
+                break;
+            }
+        }
+        while (job->processNextTask()) { }
+        job->finishedTasks.acquire(taskCount);
+        return;
+    }
+#else
+    Q_UNUSED(threadPool)
+#endif
+
+    for (int task = 0; task < taskCount; ++task)
+        function(task);
+}
+
+/*
+    Calls \a function(yStart, yEnd) for consecutive segments of the \a height
+    scanlines of an image with \a pixelCount pixels, and returns when all of
+    them are done. The segments only depend on the size of the image, and
+    images larger than the threshold have theirs processed concurrently on
+    the global thread pool, using at most QThreadPool::maxThreadCount()
+    threads including the calling one. The result is therefore the same for
+    any number of threads, as long as every scanline is processed
+    independently of the others.
+*/
+void qt_imageProcessSegments(int height, qint64 pixelCount, const std::function<void(int, int)> &function)
+{
+    const int threshold = qt_imageParallelThreshold();
+    if (threshold <= 0 || pixelCount < threshold || height < 2) {
+        function(0, height);
+        return;
+    }
+
+    // Segments of around 64k pixels keep the threads busy until the end
+    const int segmentCount = int(qBound<qint64>(2, pixelCount / (64 * 1024), height));
+
+#ifndef QT_NO_THREAD
+    QThreadPool *threadPool = QThreadPool::globalInstance();
+#else
+    QThreadPool *threadPool = Q_NULLPTR;
+#endif
+    qt_imageProcessTasks(segmentCount, threadPool, [&](int segment) {
+        function(qt_imageSegmentStart(height, segmentCount, segment),
+                 qt_imageSegmentStart(height, segmentCount, segment + 1));
+    });
+}
+
 static int next_qimage_serial_number()
 {
     static QBasicAtomicInt serial = Q_BASIC_ATOMIC_INITIALIZER(0);
@@ -2991,12 +3123,14 @@ template<class T> inline void do_mirror_data(QImageData *dst, QImageData *src,
         // are swapping the bytes instead of merely copying.
         const int srcXEnd = (dstX0 && !dstY0) ? w / 2 : w;
         const int srcYEnd = dstY0 ? h / 2 : h;
-        for (int srcY = 0, dstY = dstY0; srcY < srcYEnd; ++srcY, dstY += dstYIncr) {
-            T *srcPtr = (T *) (src->data + srcY * src->bytes_per_line);
-            T *dstPtr = (T *) (dst->data + dstY * dst->bytes_per_line);
-            for (int srcX = 0, dstX = dstX0; srcX < srcXEnd; ++srcX, dstX += dstXIncr)
-                std::swap(srcPtr[srcX], dstPtr[dstX]);
-        }
+        qt_imageProcessSegments(srcYEnd, qint64(srcXEnd) * srcYEnd, [=](int yStart, int yEnd) {
+            for (int srcY = yStart, dstY = dstY0 + yStart * dstYIncr; srcY < yEnd; ++srcY, dstY += dstYIncr) {
+                T *srcPtr = (T *) (src->data + srcY * src->bytes_per_line);
+                T *dstPtr = (T *) (dst->data + dstY * dst->bytes_per_line);
+                for (int srcX = 0, dstX = dstX0; srcX < srcXEnd; ++srcX, dstX += dstXIncr)
+                    std::swap(srcPtr[srcX], dstPtr[dstX]);
+            }
+        });
         // If mirroring both ways, the middle line needs to be mirrored horizontally only.
         if (dstX0 && dstY0 && (h & 1)) {
             int srcY = h / 2;
@@ -3006,12 +3140,14 @@ template<class T> inline void do_mirror_data(QImageData *dst, QImageData *src,
                 std::swap(srcPtr[srcX], srcPtr[dstX]);
         }
     } else {
-        for (int srcY = 0, dstY = dstY0; srcY < h; ++srcY, dstY += dstYIncr) {
-            T *srcPtr = (T *) (src->data + srcY * src->bytes_per_line);
-            T *dstPtr = (T *) (dst->data + dstY * dst->bytes_per_line);
-            for (int srcX = 0, dstX = dstX0; srcX < w; ++srcX, dstX += dstXIncr)
-                dstPtr[dstX] = srcPtr[srcX];
-        }
+        qt_imageProcessSegments(h, qint64(w) * h, [=](int yStart, int yEnd) {
+            for (int srcY = yStart, dstY = dstY0 + yStart * dstYIncr; srcY < yEnd; ++srcY, dstY += dstYIncr) {
+                T *srcPtr = (T *) (src->data + srcY * src->bytes_per_line);
+                T *dstPtr = (T *) (dst->data + dstY * dst->bytes_per_line);
+                for (int srcX = 0, dstX = dstX0; srcX < w; ++srcX, dstX += dstXIncr)
+                    dstPtr[dstX] = srcPtr[srcX];
+            }
+        });
     }
 }
 
@@ -3019,30 +3155,32 @@ inline void do_flip(QImageData *dst, QImageData *src, int w, int h, int depth)
 {
     const int data_bytes_per_line = w * (depth / 8);
     if (dst == src) {
-        uint *srcPtr = reinterpret_cast<uint *>(src->data);
-        uint *dstPtr = reinterpret_cast<uint *>(dst->data + (h - 1) * dst->bytes_per_line);
-        h = h / 2;
         const int uint_per_line = (data_bytes_per_line + 3) >> 2; // bytes per line must be a multiple of 4
-        for (int y = 0; y < h; ++y) {
-            // This is auto-vectorized, no need for SSE2 or NEON versions:
-            for (int x = 0; x < uint_per_line; x++) {
-                const uint d = dstPtr[x];
-                const uint s = srcPtr[x];
-                dstPtr[x] = s;
-                srcPtr[x] = d;
+        qt_imageProcessSegments(h / 2, qint64(w) * (h / 2), [=](int yStart, int yEnd) {
+            uint *srcPtr = reinterpret_cast<uint *>(src->data + yStart * src->bytes_per_line);
+            uint *dstPtr = reinterpret_cast<uint *>(dst->data + (h - 1 - yStart) * dst->bytes_per_line);
+            for (int y = yStart; y < yEnd; ++y) {
+                // This is auto-vectorized, no need for SSE2 or NEON versions:
+                for (int x = 0; x < uint_per_line; x++) {
+                    const uint d = dstPtr[x];
+                    const uint s = srcPtr[x];
+                    dstPtr[x] = s;
+                    srcPtr[x] = d;
+                }
+                srcPtr += src->bytes_per_line >> 2;
+                dstPtr -= dst->bytes_per_line >> 2;
             }
-            srcPtr += src->bytes_per_line >> 2;
-            dstPtr -= dst->bytes_per_line >> 2;
-        }
-
+        });
     } else {
-        const uchar *srcPtr = src->data;
-        uchar *dstPtr = dst->data + (h - 1) * dst->bytes_per_line;
-        for (int y = 0; y < h; ++y) {
-            memcpy(dstPtr, srcPtr, data_bytes_per_line);
-            srcPtr += src->bytes_per_line;
-            dstPtr -= dst->bytes_per_line;
-        }
+        qt_imageProcessSegments(h, qint64(w) * h, [=](int yStart, int yEnd) {
+            const uchar *srcPtr = src->data + yStart * src->bytes_per_line;
+            uchar *dstPtr = dst->data + (h - 1 - yStart) * dst->bytes_per_line;
+            for (int y = yStart; y < yEnd; ++y) {
+                memcpy(dstPtr, srcPtr, data_bytes_per_line);
+                srcPtr += src->bytes_per_line;
+                dstPtr -= dst->bytes_per_line;
+            }
+        });
     }
 }
 
@@ -3101,34 +3239,36 @@ inline void do_mirror(QImageData *dst, QImageData *src, bool horizontal, bool ve
         Q_ASSERT(dst->format == QImage::Format_Mono || dst->format == QImage::Format_MonoLSB);
         const int shift = 8 - (dst->width % 8);
         const uchar *bitflip = qt_get_bitflip_array();
-        for (int y = 0; y < h; ++y) {
-            uchar *begin = dst->data + y * dst->bytes_per_line;
-            uchar *end = begin + dst->bytes_per_line;
-            for (uchar *p = begin; p < end; ++p) {
-                *p = bitflip[*p];
-                // When the data is non-byte aligned, an extra bit shift (of the number of
-                // unused bits at the end) is needed for the entire scanline.
-                if (shift != 8 && p != begin) {
-                    if (dst->format == QImage::Format_Mono) {
-                        for (int i = 0; i < shift; ++i) {
-                            p[-1] <<= 1;
-                            p[-1] |= (*p & (128 >> i)) >> (7 - i);
-                        }
-                    } else {
-                        for (int i = 0; i < shift; ++i) {
-                            p[-1] >>= 1;
-                            p[-1] |= (*p & (1 << i)) << (7 - i);
+        qt_imageProcessSegments(h, qint64(dst->width) * h, [=](int yStart, int yEnd) {
+            for (int y = yStart; y < yEnd; ++y) {
+                uchar *begin = dst->data + y * dst->bytes_per_line;
+                uchar *end = begin + dst->bytes_per_line;
+                for (uchar *p = begin; p < end; ++p) {
+                    *p = bitflip[*p];
+                    // When the data is non-byte aligned, an extra bit shift (of the number of
+                    // unused bits at the end) is needed for the entire scanline.
+                    if (shift != 8 && p != begin) {
+                        if (dst->format == QImage::Format_Mono) {
+                            for (int i = 0; i < shift; ++i) {
+                                p[-1] <<= 1;
+                                p[-1] |= (*p & (128 >> i)) >> (7 - i);
+                            }
+                        } else {
+                            for (int i = 0; i < shift; ++i) {
+                                p[-1] >>= 1;
+                                p[-1] |= (*p & (1 << i)) << (7 - i);
+                            }
                         }
                     }
                 }
+                if (shift != 8) {
+                    if (dst->format == QImage::Format_Mono)
+                        end[-1] <<= shift;
+                    else
+                        end[-1] >>= shift;
+                }
             }
-            if (shift != 8) {
-                if (dst->format == QImage::Format_Mono)
-                    end[-1] <<= shift;
-                else
-                    end[-1] >>= shift;
-            }
-        }
+        });
     }
 }
 
@@ -4676,13 +4816,23 @@ QImage QImage::transformed(const QTransform &matrix, Qt::TransformationMode mode
         Q_ASSERT(sImage.devicePixelRatio() == 1);
         Q_ASSERT(sImage.devicePixelRatio() == dImage.devicePixelRatio());
 
-        QPainter p(&dImage);
-        if (mode == Qt::SmoothTransformation) {
-            p.setRenderHint(QPainter::Antialiasing);
-            p.setRenderHint(QPainter::SmoothPixmapTransform);
-        }
-        p.setTransform(mat);
-        p.drawImage(QPoint(0, 0), sImage);
+        // Large images are painted in horizontal bands, each by its own painter
+        // on its own image sharing the data, and clipped to the band. Edge
+        // pixels where two bands meet may be rasterized slightly differently
+        // than in one go, but the bands only depend on the size of the image.
+        uchar *dBits = dImage.bits();
+        const int dbpl = dImage.bytesPerLine();
+        qt_imageProcessSegments(hd, qint64(wd) * hd, [&](int yStart, int yEnd) {
+            QImage band(dBits, wd, hd, dbpl, target_format);
+            QPainter p(&band);
+            p.setClipRect(0, yStart, wd, yEnd - yStart);
+            if (mode == Qt::SmoothTransformation) {
+                p.setRenderHint(QPainter::Antialiasing);
+                p.setRenderHint(QPainter::SmoothPixmapTransform);
+            }
+            p.setTransform(mat);
+            p.drawImage(QPoint(0, 0), sImage);
+        });
     } else {
         bool invertible;
         mat = mat.inverted(&invertible);                // invert matrix
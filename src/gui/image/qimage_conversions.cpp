@@ -144,13 +144,8 @@ void convert_generic(QImageData *dest, const QImageData *src, Qt::ImageConversio
     // Cannot be used with indexed formats.
     Q_ASSERT(dest->format > QImage::Format_Indexed8);
     Q_ASSERT(src->format > QImage::Format_Indexed8);
-    const int buffer_size = 2048;
-    uint buf[buffer_size];
-    uint *buffer = buf;
     const QPixelLayout *srcLayout = &qPixelLayouts[src->format];
     const QPixelLayout *destLayout = &qPixelLayouts[dest->format];
-    const uchar *srcData = src->data;
-    uchar *destData = dest->data;
 
     const FetchPixelsFunc fetch = qFetchPixels[srcLayout->bpp];
     const StorePixelsFunc store = qStorePixels[destLayout->bpp];
@@ -171,31 +166,38 @@ void convert_generic(QImageData *dest, const QImageData *src, Qt::ImageConversio
                 convertFromARGB32PM = convertRGB32FromARGB32PM;
         }
     }
-    QDitherInfo dither;
-    QDitherInfo *ditherPtr = 0;
-    if ((flags & Qt::PreferDither) && (flags & Qt::Dither_Mask) != Qt::ThresholdDither)
-        ditherPtr = &dither;
-
-    for (int y = 0; y < src->height; ++y) {
-        dither.y = y;
-        int x = 0;
-        while (x < src->width) {
-            dither.x = x;
-            int l = src->width - x;
-            if (destLayout->bpp == QPixelLayout::BPP32)
-                buffer = reinterpret_cast<uint *>(destData) + x;
-            else
-                l = qMin(l, buffer_size);
-            const uint *ptr = fetch(buffer, srcData, x, l);
-            ptr = convertToARGB32PM(buffer, ptr, l, 0, ditherPtr);
-            ptr = convertFromARGB32PM(buffer, ptr, l, 0, ditherPtr);
-            if (ptr != reinterpret_cast<uint *>(destData))
-                store(destData, ptr, x, l);
-            x += l;
+    const bool dither = (flags & Qt::PreferDither) && (flags & Qt::Dither_Mask) != Qt::ThresholdDither;
+
+    // The ordered dither only depends on the position, so segments are independent
+    qt_imageProcessSegments(src->height, qint64(src->width) * src->height, [&](int yStart, int yEnd) {
+        const int buffer_size = 2048;
+        uint buf[buffer_size];
+        uint *buffer = buf;
+        const uchar *srcData = src->data + yStart * qptrdiff(src->bytes_per_line);
+        uchar *destData = dest->data + yStart * qptrdiff(dest->bytes_per_line);
+        QDitherInfo ditherInfo;
+        QDitherInfo *ditherPtr = dither ? &ditherInfo : 0;
+        for (int y = yStart; y < yEnd; ++y) {
+            ditherInfo.y = y;
+            int x = 0;
+            while (x < src->width) {
+                ditherInfo.x = x;
+                int l = src->width - x;
+                if (destLayout->bpp == QPixelLayout::BPP32)
+                    buffer = reinterpret_cast<uint *>(destData) + x;
+                else
+                    l = qMin(l, buffer_size);
+                const uint *ptr = fetch(buffer, srcData, x, l);
+                ptr = convertToARGB32PM(buffer, ptr, l, 0, ditherPtr);
+                ptr = convertFromARGB32PM(buffer, ptr, l, 0, ditherPtr);
+                if (ptr != reinterpret_cast<uint *>(destData))
+                    store(destData, ptr, x, l);
+                x += l;
+            }
+            srcData += src->bytes_per_line;
+            destData += dest->bytes_per_line;
         }
-        srcData += src->bytes_per_line;
-        destData += dest->bytes_per_line;
-    }
+    });
 }
 
 bool convert_generic_inplace(QImageData *data, QImage::Format dst_format, Qt::ImageConversionFlags flags)
@@ -206,11 +208,8 @@ bool convert_generic_inplace(QImageData *data, QImage::Format dst_format, Qt::Im
     if (data->depth != qt_depthForFormat(dst_format))
         return false;
 
-    const int buffer_size = 2048;
-    uint buffer[buffer_size];
     const QPixelLayout *srcLayout = &qPixelLayouts[data->format];
     const QPixelLayout *destLayout = &qPixelLayouts[dst_format];
-    uchar *srcData = data->data;
 
     const FetchPixelsFunc fetch = qFetchPixels[srcLayout->bpp];
     const StorePixelsFunc store = qStorePixels[destLayout->bpp];
@@ -231,27 +230,31 @@ bool convert_generic_inplace(QImageData *data, QImage::Format dst_format, Qt::Im
                 convertFromARGB32PM = convertRGB32FromARGB32PM;
         }
     }
-    QDitherInfo dither;
-    QDitherInfo *ditherPtr = 0;
-    if ((flags & Qt::PreferDither) && (flags & Qt::Dither_Mask) != Qt::ThresholdDither)
-        ditherPtr = &dither;
-
-    for (int y = 0; y < data->height; ++y) {
-        dither.y = y;
-        int x = 0;
-        while (x < data->width) {
-            dither.x = x;
-            int l = qMin(data->width - x, buffer_size);
-            const uint *ptr = fetch(buffer, srcData, x, l);
-            ptr = convertToARGB32PM(buffer, ptr, l, 0, ditherPtr);
-            ptr = convertFromARGB32PM(buffer, ptr, l, 0, ditherPtr);
-            // The conversions might be passthrough and not use the buffer, in that case we are already done.
-            if (srcData != (const uchar*)ptr)
-                store(srcData, ptr, x, l);
-            x += l;
+    const bool dither = (flags & Qt::PreferDither) && (flags & Qt::Dither_Mask) != Qt::ThresholdDither;
+
+    qt_imageProcessSegments(data->height, qint64(data->width) * data->height, [&](int yStart, int yEnd) {
+        const int buffer_size = 2048;
+        uint buffer[buffer_size];
+        uchar *srcData = data->data + yStart * qptrdiff(data->bytes_per_line);
+        QDitherInfo ditherInfo;
+        QDitherInfo *ditherPtr = dither ? &ditherInfo : 0;
+        for (int y = yStart; y < yEnd; ++y) {
+            ditherInfo.y = y;
+            int x = 0;
+            while (x < data->width) {
+                ditherInfo.x = x;
+                int l = qMin(data->width - x, buffer_size);
+                const uint *ptr = fetch(buffer, srcData, x, l);
+                ptr = convertToARGB32PM(buffer, ptr, l, 0, ditherPtr);
+                ptr = convertFromARGB32PM(buffer, ptr, l, 0, ditherPtr);
+                // The conversions might be passthrough and not use the buffer, in that case we are already done.
+                if (srcData != (const uchar*)ptr)
+                    store(srcData, ptr, x, l);
+                x += l;
+            }
+            srcData += data->bytes_per_line;
         }
-        srcData += data->bytes_per_line;
-    }
+    });
     data->format = dst_format;
     return true;
 }
@@ -292,21 +295,14 @@ static void convert_ARGB_to_ARGB_PM(QImageData *dest, const QImageData *src, Qt:
     Q_ASSERT(src->width == dest->width);
     Q_ASSERT(src->height == dest->height);
 
-    const int src_pad = (src->bytes_per_line >> 2) - src->width;
-    const int dest_pad = (dest->bytes_per_line >> 2) - dest->width;
-    const QRgb *src_data = (QRgb *) src->data;
-    QRgb *dest_data = (QRgb *) dest->data;
-
-    for (int i = 0; i < src->height; ++i) {
-        const QRgb *end = src_data + src->width;
-        while (src_data < end) {
-            *dest_data = qPremultiply(*src_data);
-            ++src_data;
-            ++dest_data;
+    qt_imageProcessSegments(src->height, qint64(src->width) * src->height, [=](int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; ++y) {
+            const QRgb *src_data = reinterpret_cast<const QRgb *>(src->data + y * qptrdiff(src->bytes_per_line));
+            QRgb *dest_data = reinterpret_cast<QRgb *>(dest->data + y * qptrdiff(dest->bytes_per_line));
+            for (int x = 0; x < src->width; ++x)
+                dest_data[x] = qPremultiply(src_data[x]);
         }
-        src_data += src_pad;
-        dest_data += dest_pad;
-    }
+    });
 }
 
 Q_GUI_EXPORT void QT_FASTCALL qt_convert_rgb888_to_rgb32(quint32 *dest_data, const uchar *src_data, int len)
@@ -399,16 +395,17 @@ static void convert_RGB888_to_RGB(QImageData *dest, const QImageData *src, Qt::I
     Q_ASSERT(src->width == dest->width);
     Q_ASSERT(src->height == dest->height);
 
-    const uchar *src_data = (uchar *) src->data;
-    quint32 *dest_data = (quint32 *) dest->data;
-
     Rgb888ToRgbConverter line_converter= rgbx ? qt_convert_rgb888_to_rgbx8888 : qt_convert_rgb888_to_rgb32;
 
-    for (int i = 0; i < src->height; ++i) {
-        line_converter(dest_data, src_data, src->width);
-        src_data += src->bytes_per_line;
-        dest_data = (quint32 *)((uchar*)dest_data + dest->bytes_per_line);
-    }
+    qt_imageProcessSegments(src->height, qint64(src->width) * src->height, [=](int yStart, int yEnd) {
+        const uchar *src_data = src->data + yStart * qptrdiff(src->bytes_per_line);
+        quint32 *dest_data = (quint32 *)(dest->data + yStart * qptrdiff(dest->bytes_per_line));
+        for (int i = yStart; i < yEnd; ++i) {
+            line_converter(dest_data, src_data, src->width);
+            src_data += src->bytes_per_line;
+            dest_data = (quint32 *)((uchar*)dest_data + dest->bytes_per_line);
+        }
+    });
 }
 
 #ifdef __SSE2__
@@ -56,9 +56,12 @@
 #include <QMap>
 #include <QVector>
 
+#include <functional>
+
 QT_BEGIN_NAMESPACE
 
 class QImageWriter;
+class QThreadPool;
 
 struct Q_GUI_EXPORT QImageData {        // internal image data
     QImageData();
@@ -212,6 +215,11 @@ inline QImage::Format qt_alphaVersionForPainting(QImage::Format format)
     return toFormat;
 }
 
+void qt_imageProcessSegments(int height, qint64 pixelCount,
+                             const std::function<void(int, int)> &function);
+void qt_imageProcessTasks(int taskCount, QThreadPool *threadPool,
+                          const std::function<void(int)> &function);
+
 Q_GUI_EXPORT QMap<QString, QString> qt_getImageText(const QImage &image, const QString &description);
 Q_GUI_EXPORT QMap<QString, QString> qt_getImageTextFromDescription(const QString &description);
 
@@ -0,0 +1,716 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtGui module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qimagecache.h"
+#include "qimagecache_p.h"
+
+#include <qcache.h>
+#include <qcoreapplication.h>
+#include <qcryptographichash.h>
+#include <qmutex.h>
+#include <qsharedmemory.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QImageCache
+    \inmodule QtGui
+    \since 5.10
+
+    \brief The QImageCache class provides a thread-safe, application-wide
+    cache for images, optionally shared with other processes.
+
+    QImageCache is the counterpart of QPixmapCache for images: it caches
+    images that are expensive to generate, using no more memory than
+    cacheLimit(), and can be used from any thread. Use insert() to insert
+    images, find() to find them, and clear() to empty the cache.
+
+    The cache associates an image with a user-provided string as a key.
+    If two images are inserted with equal keys, the last one replaces the
+    first. The cache becomes full when the total size of all images in the
+    cache exceeds cacheLimit(), at which point the least recently used
+    images are evicted. The initial cache limit is 10240 KB (10 MB).
+
+    \section1 Sharing Images Between Processes
+
+    When a shared cache key is set with setSharedCacheKey(), every image
+    inserted into the cache is also published in a shared memory segment
+    named after the shared cache key, which all processes using that key
+    attach to. When an image is not found in the cache, find() looks for it
+    among the images published by any of these processes, so that
+    processes of a multi-process application render each asset only once.
+    The segment holds up to sharedCacheLimit() of images; when it is full,
+    the least recently published images are overwritten. It exists as long
+    as a process using the shared cache key is attached to it.
+
+    Images published under a key are expected not to change: replacing an
+    image that other processes still have access to does not update their
+    copy.
+
+    statistics() reports how effective the cache is.
+
+    \sa QPixmapCache, QSharedMemory, QCache
+*/
+
+/*!
+    \class QImageCache::Statistics
+    \inmodule QtGui
+    \since 5.10
+
+    \brief The Statistics struct holds the counters of QImageCache.
+
+    \sa QImageCache::statistics(), QImageCache::resetStatistics()
+*/
+
+/*!
+    \variable QImageCache::Statistics::hits
+    \brief the number of lookups satisfied by the cache of this process.
+*/
+
+/*!
+    \variable QImageCache::Statistics::sharedHits
+    \brief the number of lookups satisfied by an image published by this
+    or another process.
+*/
+
+/*!
+    \variable QImageCache::Statistics::misses
+    \brief the number of lookups that did not find an image.
+*/
+
+/*!
+    \variable QImageCache::Statistics::insertions
+    \brief the number of images inserted with insert().
+*/
+
+/*!
+    \variable QImageCache::Statistics::evictions
+    \brief the number of images evicted to stay within the cache limit.
+*/
+
+/*!
+    \variable QImageCache::Statistics::totalCost
+    \brief the size in bytes of the images currently in the cache.
+*/
+
+/*!
+    \variable QImageCache::Statistics::sharedCost
+    \brief the size in bytes of the images this process has published that
+    are still in the shared memory segment.
+*/
+
+namespace {
+
+#ifndef QT_NO_SHAREDMEMORY
+class QImageCacheArena
+{
+public:
+    QImageCacheArena()
+        : size(0), pid(QCoreApplication::applicationPid())
+    { }
+
+    void setKey(const QString &key);
+    void setSize(int bytes);
+
+    QImage find(const QString &key);
+    void publish(const QString &key, const QImage &image);
+    void remove(const QString &key);
+    void removePublished();
+    int publishedCost();
+
+private:
+    bool lock(bool create);
+    void removePublishedLocked();
+    QImageCacheArenaHeader *header()
+    { return static_cast<QImageCacheArenaHeader *>(segment.data()); }
+    QImageCacheIndexEntry *index()
+    {
+        char *data = static_cast<char *>(segment.data());
+        return reinterpret_cast<QImageCacheIndexEntry *>(data + sizeof(QImageCacheArenaHeader));
+    }
+    char *dataArea();
+    QImageCacheIndexEntry *entry(quint64 keyHash);
+    QImageCacheIndexEntry *allocate(qint64 size);
+
+    QMutex mutex;
+    QSharedMemory segment;
+    int size; // of the segment when this process creates it
+    qint64 pid;
+};
+#endif
+
+struct QImageCacheData
+{
+    QImageCacheData()
+        : cacheLimit(10240), // 10 MB
+          sharedCacheLimit(51200) // 50 MB
+    {
+        cache.setMaxCost(1024 * cacheLimit);
+#ifndef QT_NO_SHAREDMEMORY
+        arena.setSize(1024 * sharedCacheLimit);
+#endif
+    }
+
+    bool insertLocal(const QString &key, const QImage &image);
+
+    QMutex mutex;
+    QCache<QString, QImage> cache;
+    int cacheLimit;
+#ifndef QT_NO_SHAREDMEMORY
+    QImageCacheArena arena;
+#endif
+    QString sharedCacheKey;
+    int sharedCacheLimit;
+    QImageCache::Statistics statistics;
+};
+
+} // unnamed namespace
+
+Q_GLOBAL_STATIC(QImageCacheData, imageCache)
+
+bool QImageCacheData::insertLocal(const QString &key, const QImage &image)
+{
+    const int countBefore = cache.count() - (cache.contains(key) ? 1 : 0);
+    const bool inserted = cache.insert(key, new QImage(image), image.byteCount());
+    statistics.evictions += countBefore + (inserted ? 1 : 0) - cache.count();
+    return inserted;
+}
+
+#ifndef QT_NO_SHAREDMEMORY
+static inline qint64 arenaAlign(qint64 size)
+{
+    return (size + 7) & ~qint64(7);
+}
+
+static const int arenaDataOffset = sizeof(QImageCacheArenaHeader)
+                                 + QImageCacheIndexSize * sizeof(QImageCacheIndexEntry);
+
+// qHash() is seeded differently in every process, the key hash must not be
+static quint64 arenaKeyHash(const QString &key)
+{
+    const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1);
+    quint64 keyHash;
+    memcpy(&keyHash, hash.constData(), sizeof(keyHash));
+    return keyHash;
+}
+
+char *QImageCacheArena::dataArea()
+{
+    return static_cast<char *>(segment.data()) + arenaDataOffset;
+}
+
+static qint64 arenaImageSize(const QString &key, const QImage &image)
+{
+    return arenaAlign(sizeof(QImageCacheImageHeader))
+         + arenaAlign(key.size() * sizeof(QChar))
+         + arenaAlign(image.colorCount() * sizeof(QRgb))
+         + arenaAlign(image.byteCount());
+}
+
+void QImageCacheArena::setKey(const QString &key)
+{
+    QMutexLocker locker(&mutex);
+    if (key == segment.key())
+        return;
+    if (segment.isAttached())
+        removePublishedLocked();
+    // Detaches, the segment goes away with the last process using it
+    segment.setKey(key);
+}
+
+void QImageCacheArena::setSize(int bytes)
+{
+    QMutexLocker locker(&mutex);
+    size = bytes;
+}
+
+// Attaches to the segment, or creates it if no process has and create is
+// true, and locks it. Sets the arena up if it is not valid.
+bool QImageCacheArena::lock(bool create)
+{
+    if (segment.key().isEmpty())
+        return false;
+    if (!segment.isAttached()) {
+        if (!create)
+            return false;
+        if (!segment.create(arenaDataOffset + qMax(size, 0))
+            && (segment.error() != QSharedMemory::AlreadyExists || !segment.attach())) {
+            return false;
+        }
+    }
+    if (segment.size() < arenaDataOffset || !segment.lock())
+        return false;
+
+    QImageCacheArenaHeader *h = header();
+    const int dataSize = segment.size() - arenaDataOffset;
+    if (h->magic != QImageCacheArenaMagic || h->indexSize != QImageCacheIndexSize
+        || h->dataOffset != arenaDataOffset || h->dataSize != dataSize
+        || h->writeOffset < 0 || h->writeOffset > dataSize || h->writeOffset % 8) {
+        memset(segment.data(), 0, arenaDataOffset);
+        h->magic = QImageCacheArenaMagic;
+        h->indexSize = QImageCacheIndexSize;
+        h->dataOffset = arenaDataOffset;
+        h->dataSize = dataSize;
+    }
+    return true;
+}
+
+QImageCacheIndexEntry *QImageCacheArena::entry(quint64 keyHash)
+{
+    QImageCacheIndexEntry *found = 0;
+    QImageCacheIndexEntry *entries = index();
+    for (int i = 0; i < QImageCacheIndexSize; ++i) {
+        QImageCacheIndexEntry *e = entries + i;
+        if (e->sequence && e->keyHash == keyHash && (!found || e->sequence > found->sequence))
+            found = e;
+    }
+    return found;
+}
+
+// Takes size bytes at the write offset of the ring, dropping the images
+// they overlap, and returns the index entry describing them. When the index
+// is full, the entry of the oldest image is reused.
+QImageCacheIndexEntry *QImageCacheArena::allocate(qint64 size)
+{
+    QImageCacheArenaHeader *h = header();
+    const qint64 dataSize = segment.size() - arenaDataOffset;
+    if (size > dataSize)
+        return 0;
+    qint64 offset = h->writeOffset;
+    if (offset < 0 || offset > dataSize - size)
+        offset = 0;
+
+    QImageCacheIndexEntry *unused = 0;
+    QImageCacheIndexEntry *oldest = 0;
+    QImageCacheIndexEntry *entries = index();
+    for (int i = 0; i < QImageCacheIndexSize; ++i) {
+        QImageCacheIndexEntry *e = entries + i;
+        if (e->sequence && e->offset < offset + size && offset < qint64(e->offset) + e->size)
+            e->sequence = 0;
+        if (!e->sequence) {
+            if (!unused)
+                unused = e;
+        } else if (!oldest || e->sequence < oldest->sequence) {
+            oldest = e;
+        }
+    }
+
+    QImageCacheIndexEntry *e = unused ? unused : oldest;
+    e->sequence = ++h->sequence;
+    e->offset = int(offset);
+    e->size = int(size);
+    h->writeOffset = int(offset + size);
+    return e;
+}
+
+QImage QImageCacheArena::find(const QString &key)
+{
+    QMutexLocker locker(&mutex);
+    if (!lock(true))
+        return QImage();
+
+    QImage image;
+    const QImageCacheIndexEntry *e = entry(arenaKeyHash(key));
+    // Another process may have written anything here, copy what is checked
+    const qint64 dataSize = segment.size() - arenaDataOffset;
+    const qint64 offset = e ? e->offset : -1;
+    const qint64 size = e ? e->size : 0;
+    if (offset >= 0 && size >= qint64(sizeof(QImageCacheImageHeader)) && offset <= dataSize - size) {
+        const char *data = dataArea() + offset;
+        const char *end = data + size;
+        QImageCacheImageHeader imageHeader;
+        memcpy(&imageHeader, data, sizeof(imageHeader));
+        if (imageHeader.magic == QImageCacheImageMagic
+            && imageHeader.keySize == key.size()
+            && imageHeader.format > QImage::Format_Invalid && imageHeader.format < QImage::NImageFormats
+            && imageHeader.colorCount >= 0 && imageHeader.colorCount <= 256
+            && imageHeader.width > 0 && imageHeader.height > 0 && imageHeader.bytesPerLine > 0
+            && imageHeader.devicePixelRatio > 0) {
+            const char *keyData = data + arenaAlign(sizeof(QImageCacheImageHeader));
+            const char *colorData = keyData + arenaAlign(imageHeader.keySize * sizeof(QChar));
+            const char *bits = colorData + arenaAlign(imageHeader.colorCount * sizeof(QRgb));
+            if (bits <= end
+                && qint64(imageHeader.bytesPerLine) * imageHeader.height <= end - bits
+                && memcmp(keyData, key.constData(), key.size() * sizeof(QChar)) == 0) {
+                image = QImage(imageHeader.width, imageHeader.height, QImage::Format(imageHeader.format));
+                if (!image.isNull() && image.bytesPerLine() == imageHeader.bytesPerLine) {
+                    memcpy(image.bits(), bits, image.byteCount());
+                    QVector<QRgb> colorTable(imageHeader.colorCount);
+                    memcpy(colorTable.data(), colorData, imageHeader.colorCount * sizeof(QRgb));
+                    image.setColorTable(colorTable);
+                    image.setDotsPerMeterX(imageHeader.dotsPerMeterX);
+                    image.setDotsPerMeterY(imageHeader.dotsPerMeterY);
+                    image.setDevicePixelRatio(imageHeader.devicePixelRatio);
+                } else {
+                    image = QImage();
+                }
+            }
+        }
+    }
+    segment.unlock();
+    return image;
+}
+
+void QImageCacheArena::publish(const QString &key, const QImage &image)
+{
+    QMutexLocker locker(&mutex);
+    if (!lock(true))
+        return;
+
+    const quint64 keyHash = arenaKeyHash(key);
+    // Replace the image published under the key, if any
+    if (QImageCacheIndexEntry *e = entry(keyHash))
+        e->sequence = 0;
+
+    if (QImageCacheIndexEntry *e = allocate(arenaImageSize(key, image))) {
+        e->keyHash = keyHash;
+        e->owner = pid;
+
+        char *data = dataArea() + e->offset;
+        QImageCacheImageHeader *imageHeader = reinterpret_cast<QImageCacheImageHeader *>(data);
+        imageHeader->magic = QImageCacheImageMagic;
+        imageHeader->keySize = key.size();
+        imageHeader->width = image.width();
+        imageHeader->height = image.height();
+        imageHeader->format = image.format();
+        imageHeader->bytesPerLine = image.bytesPerLine();
+        imageHeader->colorCount = image.colorCount();
+        imageHeader->dotsPerMeterX = image.dotsPerMeterX();
+        imageHeader->dotsPerMeterY = image.dotsPerMeterY();
+        imageHeader->reserved = 0;
+        imageHeader->devicePixelRatio = image.devicePixelRatio();
+        data += arenaAlign(sizeof(QImageCacheImageHeader));
+
+        memcpy(data, key.constData(), key.size() * sizeof(QChar));
+        data += arenaAlign(key.size() * sizeof(QChar));
+        const QVector<QRgb> colorTable = image.colorTable();
+        memcpy(data, colorTable.constData(), colorTable.size() * sizeof(QRgb));
+        data += arenaAlign(colorTable.size() * sizeof(QRgb));
+        memcpy(data, image.constBits(), image.byteCount());
+    }
+    segment.unlock();
+}
+
+void QImageCacheArena::remove(const QString &key)
+{
+    QMutexLocker locker(&mutex);
+    if (!lock(false))
+        return;
+    if (QImageCacheIndexEntry *e = entry(arenaKeyHash(key)))
+        e->sequence = 0;
+    segment.unlock();
+}
+
+void QImageCacheArena::removePublished()
+{
+    QMutexLocker locker(&mutex);
+    removePublishedLocked();
+}
+
+void QImageCacheArena::removePublishedLocked()
+{
+    if (!lock(false))
+        return;
+    QImageCacheIndexEntry *entries = index();
+    for (int i = 0; i < QImageCacheIndexSize; ++i) {
+        if (entries[i].owner == pid)
+            entries[i].sequence = 0;
+    }
+    segment.unlock();
+}
+
+int QImageCacheArena::publishedCost()
+{
+    QMutexLocker locker(&mutex);
+    if (!lock(false))
+        return 0;
+    int cost = 0;
+    const QImageCacheIndexEntry *entries = index();
+    for (int i = 0; i < QImageCacheIndexSize; ++i) {
+        if (entries[i].sequence && entries[i].owner == pid)
+            cost += entries[i].size;
+    }
+    segment.unlock();
+    return cost;
+}
+#endif // QT_NO_SHAREDMEMORY
+
+/*!
+    Returns the cache limit (in kilobytes).
+
+    The default cache limit is 10240 KB.
+
+    \sa setCacheLimit()
+*/
+int QImageCache::cacheLimit()
+{
+    QImageCacheData *d = imageCache();
+    QMutexLocker locker(&d->mutex);
+    return d->cacheLimit;
+}
+
+/*!
+    Sets the cache limit to \a n kilobytes, evicting the least recently
+    used images if the cache holds more.
+
+    The default setting is 10240 KB.
+
+    \sa cacheLimit()
+*/
+void QImageCache::setCacheLimit(int n)
+{
+    QImageCacheData *d = imageCache();
+    QMutexLocker locker(&d->mutex);
+    const int countBefore = d->cache.count();
+    d->cacheLimit = n;
+    d->cache.setMaxCost(1024 * n);
+    d->statistics.evictions += countBefore - d->cache.count();
+}
+
+/*!
+    Looks for a cached image associated with the given \a key in the
+    cache, and then in the images published by other processes if a shared
+    cache key is set. If the image is found, the function sets \a image to
+    that image and returns \c true; otherwise it leaves \a image alone and
+    returns \c false.
+
+    \sa insert()
+*/
+bool QImageCache::find(const QString &key, QImage *image)
+{
+    QImageCacheData *d = imageCache();
+    QString sharedCacheKey;
+    {
+        QMutexLocker locker(&d->mutex);
+        if (const QImage *cached = d->cache.object(key)) {
+            ++d->statistics.hits;
+            if (image)
+                *image = *cached;
+            return true;
+        }
+        sharedCacheKey = d->sharedCacheKey;
+    }
+
+#ifndef QT_NO_SHAREDMEMORY
+    if (!sharedCacheKey.isEmpty()) {
+        // Read without holding the mutex, other threads need not wait for us
+        const QImage published = d->arena.find(key);
+        if (!published.isNull()) {
+            QMutexLocker locker(&d->mutex);
+            ++d->statistics.sharedHits;
+            d->insertLocal(key, published);
+            if (image)
+                *image = published;
+            return true;
+        }
+    }
+#endif
+
+    QMutexLocker locker(&d->mutex);
+    ++d->statistics.misses;
+    return false;
+}
+
+/*!
+    Inserts a copy of the image \a image associated with the \a key into
+    the cache, and publishes it to other processes if a shared cache key
+    is set.
+
+    When the image is inserted, the least recently used images may be
+    evicted to stay within the cache limit. The function returns \c true
+    if the image was inserted; it returns \c false if the image is null or
+    larger than the cache limit.
+
+    \sa find(), remove()
+*/
+bool QImageCache::insert(const QString &key, const QImage &image)
+{
+    if (image.isNull())
+        return false;
+
+    QImageCacheData *d = imageCache();
+    QString sharedCacheKey;
+    bool inserted;
+    {
+        QMutexLocker locker(&d->mutex);
+        ++d->statistics.insertions;
+        inserted = d->insertLocal(key, image);
+        sharedCacheKey = d->sharedCacheKey;
+    }
+
+#ifndef QT_NO_SHAREDMEMORY
+    if (!sharedCacheKey.isEmpty())
+        d->arena.publish(key, image);
+#endif
+
+    return inserted;
+}
+
+/*!
+    Removes the image associated with \a key from the cache, and stops
+    publishing it to other processes.
+*/
+void QImageCache::remove(const QString &key)
+{
+    QImageCacheData *d = imageCache();
+    QMutexLocker locker(&d->mutex);
+    d->cache.remove(key);
+#ifndef QT_NO_SHAREDMEMORY
+    d->arena.remove(key);
+#endif
+}
+
+/*!
+    Removes all images from the cache, and stops publishing the images this
+    process has published to other processes.
+*/
+void QImageCache::clear()
+{
+    if (!imageCache.exists())
+        return;
+    QImageCacheData *d = imageCache();
+    QMutexLocker locker(&d->mutex);
+    d->cache.clear();
+#ifndef QT_NO_SHAREDMEMORY
+    d->arena.removePublished();
+#endif
+}
+
+/*!
+    Returns the key identifying the images shared between processes, or an
+    empty string if images are not shared. The default is an empty string.
+
+    \sa setSharedCacheKey()
+*/
+QString QImageCache::sharedCacheKey()
+{
+    QImageCacheData *d = imageCache();
+    QMutexLocker locker(&d->mutex);
+    return d->sharedCacheKey;
+}
+
+/*!
+    Sets the key identifying the images shared between processes to \a
+    key. Processes using the same key find the images the others insert.
+    Setting an empty key stops sharing images.
+
+    Changing the key stops publishing the images inserted so far.
+
+    \note Sharing images requires shared memory support; on platforms
+    without it, the key is ignored.
+
+    \sa sharedCacheKey(), QSharedMemory
+*/
+void QImageCache::setSharedCacheKey(const QString &key)
+{
+    QImageCacheData *d = imageCache();
+    QMutexLocker locker(&d->mutex);
+    if (d->sharedCacheKey == key)
+        return;
+    d->sharedCacheKey = key;
+#ifndef QT_NO_SHAREDMEMORY
+    d->arena.setKey(key);
+#endif
+}
+
+/*!
+    Returns the size (in kilobytes) of the shared memory this process
+    creates to publish images.
+
+    The default limit is 51200 KB.
+
+    \sa setSharedCacheLimit()
+*/
+int QImageCache::sharedCacheLimit()
+{
+    QImageCacheData *d = imageCache();
+    QMutexLocker locker(&d->mutex);
+    return d->sharedCacheLimit;
+}
+
+/*!
+    Sets the size of the shared memory this process creates to publish
+    images to \a n kilobytes. When it is full, the least recently published
+    images are overwritten.
+
+    The shared memory is created by the first process that uses the shared
+    cache key, processes attaching to it later use its existing size. A new
+    limit therefore applies the next time the shared memory is created.
+
+    \sa sharedCacheLimit()
+*/
+void QImageCache::setSharedCacheLimit(int n)
+{
+    QImageCacheData *d = imageCache();
+    QMutexLocker locker(&d->mutex);
+    d->sharedCacheLimit = n;
+#ifndef QT_NO_SHAREDMEMORY
+    d->arena.setSize(1024 * n);
+#endif
+}
+
+/*!
+    Returns the hit, miss and eviction counters of the cache, along with
+    its current size.
+
+    \sa resetStatistics()
+*/
+QImageCache::Statistics QImageCache::statistics()
+{
+    QImageCacheData *d = imageCache();
+    QMutexLocker locker(&d->mutex);
+    Statistics statistics = d->statistics;
+    statistics.totalCost = d->cache.totalCost();
+#ifndef QT_NO_SHAREDMEMORY
+    statistics.sharedCost = d->arena.publishedCost();
+#endif
+    return statistics;
+}
+
+/*!
+    Resets the counters returned by statistics() to zero.
+*/
+void QImageCache::resetStatistics()
+{
+    QImageCacheData *d = imageCache();
+    QMutexLocker locker(&d->mutex);
+    d->statistics = Statistics();
+}
+
+QT_END_NAMESPACE
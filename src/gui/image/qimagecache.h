@@ -0,0 +1,86 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtGui module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QIMAGECACHE_H
+#define QIMAGECACHE_H
+
+#include <QtGui/qtguiglobal.h>
+#include <QtGui/qimage.h>
+
+QT_BEGIN_NAMESPACE
+
+
+class Q_GUI_EXPORT QImageCache
+{
+public:
+    struct Statistics
+    {
+        Statistics()
+            : hits(0), sharedHits(0), misses(0), insertions(0), evictions(0),
+              totalCost(0), sharedCost(0)
+        { }
+
+        qint64 hits;
+        qint64 sharedHits;
+        qint64 misses;
+        qint64 insertions;
+        qint64 evictions;
+        int totalCost;
+        int sharedCost;
+    };
+
+    static int cacheLimit();
+    static void setCacheLimit(int);
+    static bool find(const QString &key, QImage *image);
+    static bool insert(const QString &key, const QImage &image);
+    static void remove(const QString &key);
+    static void clear();
+
+    static QString sharedCacheKey();
+    static void setSharedCacheKey(const QString &key);
+    static int sharedCacheLimit();
+    static void setSharedCacheLimit(int);
+
+    static Statistics statistics();
+    static void resetStatistics();
+};
+
+QT_END_NAMESPACE
+
+#endif // QIMAGECACHE_H
@@ -0,0 +1,113 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtGui module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QIMAGECACHE_P_H
+#define QIMAGECACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. This header
+// file may change from version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include "qimagecache.h"
+
+QT_BEGIN_NAMESPACE
+
+#ifndef QT_NO_SHAREDMEMORY
+
+// The images published to other processes live in one shared memory segment
+// per shared cache key: an arena header, a fixed size index, and a data area
+// that is allocated as a ring, overwriting the oldest images when it is full.
+// Everything in it may have been written by another process and is checked
+// before use.
+
+enum {
+    QImageCacheArenaMagic = 0x51494332, // "QIC2"
+    QImageCacheImageMagic = 0x51494331, // "QIC1"
+    QImageCacheIndexSize = 1024
+};
+
+struct QImageCacheArenaHeader
+{
+    quint32 magic;
+    qint32 indexSize;
+    qint32 dataOffset;
+    qint32 dataSize;
+    qint32 writeOffset;
+    qint32 reserved;
+    quint64 sequence;
+};
+
+struct QImageCacheIndexEntry
+{
+    quint64 keyHash;
+    quint64 sequence; // 0 for an unused entry, otherwise the order of publishing
+    qint64 owner;     // pid of the publishing process
+    qint32 offset;    // of the image in the data area
+    qint32 size;
+};
+
+// Followed by the key, the color table and the image data, each aligned to
+// 8 bytes.
+struct QImageCacheImageHeader
+{
+    quint32 magic;
+    qint32 keySize;
+    qint32 width;
+    qint32 height;
+    qint32 format;
+    qint32 bytesPerLine;
+    qint32 colorCount;
+    qint32 dotsPerMeterX;
+    qint32 dotsPerMeterY;
+    qint32 reserved;
+    double devicePixelRatio;
+};
+
+#endif // QT_NO_SHAREDMEMORY
+
+QT_END_NAMESPACE
+
+#endif // QIMAGECACHE_P_H
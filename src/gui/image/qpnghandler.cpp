@@ -42,17 +42,24 @@
 
 #ifndef QT_NO_IMAGEFORMAT_PNG
 #include <qcoreapplication.h>
+#include <qendian.h>
 #include <qiodevice.h>
 #include <qimage.h>
 #include <qlist.h>
 #include <qtextcodec.h>
+#include <qvarlengtharray.h>
 #include <qvariant.h>
 #include <qvector.h>
 
 #include <private/qimage_p.h> // for qt_getImageText
 
+#ifndef QT_NO_THREAD
+#include <qthreadpool.h>
+#endif
+
 #include <png.h>
 #include <pngconf.h>
+#include <zlib.h>
 
 #if PNG_LIBPNG_VER >= 10400 && PNG_LIBPNG_VER <= 10502 \
         && defined(PNG_PEDANTIC_WARNINGS_SUPPORTED)
@@ -726,6 +733,366 @@ void QPNGImageWriter::setGamma(float g)
     gamma = g;
 }
 
+/*
+    The IDAT writer produces the compressed image data of a PNG without going
+    through libpng, so that the work can be spread over a thread pool: the
+    filtered rows are cut into segments that are deflated independently, each
+    primed with the last 32 KB of data preceding it, and concatenated into a
+    single zlib stream (the same technique pigz uses for gzip streams). Rows
+    are taken in batches, so only a few segments need to be kept in memory.
+*/
+enum {
+    PngSegmentSize = 256 * 1024,
+    PngWindowSize = 32 * 1024
+};
+
+static bool qt_png_write_chunk(QIODevice *device, const char *type, const char *data, int length)
+{
+    uchar header[8];
+    qToBigEndian<quint32>(length, header);
+    memcpy(header + 4, type, 4);
+
+    uLong crc = crc32(0L, header + 4, 4);
+    if (length)
+        crc = crc32(crc, reinterpret_cast<const Bytef *>(data), length);
+    uchar trailer[4];
+    qToBigEndian<quint32>(crc, trailer);
+
+    return device->write(reinterpret_cast<const char *>(header), 8) == 8
+        && (length == 0 || device->write(data, length) == length)
+        && device->write(reinterpret_cast<const char *>(trailer), 4) == 4;
+}
+
+static inline uchar qt_png_paeth(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = qAbs(p - a);
+    const int pb = qAbs(p - b);
+    const int pc = qAbs(p - c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    if (pb <= pc)
+        return b;
+    return c;
+}
+
+// Writes the filter type byte followed by the filtered row to out
+static void qt_png_filter_row(int filter, const uchar *row, const uchar *prev, uchar *out,
+                              int rowBytes, int bpp)
+{
+    *out++ = filter;
+    switch (filter) {
+    case PNG_FILTER_VALUE_NONE:
+        memcpy(out, row, rowBytes);
+        break;
+    case PNG_FILTER_VALUE_SUB:
+        for (int i = 0; i < bpp; ++i)
+            out[i] = row[i];
+        for (int i = bpp; i < rowBytes; ++i)
+            out[i] = row[i] - row[i - bpp];
+        break;
+    case PNG_FILTER_VALUE_UP:
+        for (int i = 0; i < rowBytes; ++i)
+            out[i] = row[i] - prev[i];
+        break;
+    case PNG_FILTER_VALUE_AVG:
+        for (int i = 0; i < bpp; ++i)
+            out[i] = row[i] - (prev[i] >> 1);
+        for (int i = bpp; i < rowBytes; ++i)
+            out[i] = row[i] - ((row[i - bpp] + prev[i]) >> 1);
+        break;
+    case PNG_FILTER_VALUE_PAETH:
+        for (int i = 0; i < bpp; ++i)
+            out[i] = row[i] - prev[i];
+        for (int i = bpp; i < rowBytes; ++i)
+            out[i] = row[i] - qt_png_paeth(row[i - bpp], prev[i], prev[i - bpp]);
+        break;
+    }
+}
+
+// The heuristic libpng uses: the sum of the filtered bytes taken as signed values
+static quint64 qt_png_filter_cost(const uchar *filtered, int rowBytes)
+{
+    quint64 sum = 0;
+    for (int i = 0; i < rowBytes; ++i)
+        sum += filtered[i] < 128 ? filtered[i] : 256 - filtered[i];
+    return sum;
+}
+
+static void qt_png_filter_row_adaptive(const uchar *row, const uchar *prev, uchar *out,
+                                       uchar *scratch, int rowBytes, int bpp)
+{
+    qt_png_filter_row(PNG_FILTER_VALUE_NONE, row, prev, out, rowBytes, bpp);
+    quint64 bestCost = qt_png_filter_cost(out + 1, rowBytes);
+    for (int filter = PNG_FILTER_VALUE_SUB; filter <= PNG_FILTER_VALUE_PAETH; ++filter) {
+        qt_png_filter_row(filter, row, prev, scratch, rowBytes, bpp);
+        const quint64 cost = qt_png_filter_cost(scratch + 1, rowBytes);
+        if (cost < bestCost) {
+            bestCost = cost;
+            memcpy(out, scratch, rowBytes + 1);
+        }
+    }
+}
+
+// Raw deflates data[begin, end), using the up to 32 KB before begin as dictionary
+static bool qt_png_deflate_segment(const uchar *data, int begin, int end, int level, int strategy,
+                                   bool finish, QByteArray *output)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, strategy) != Z_OK)
+        return false;
+
+    const int dictionaryStart = qMax(0, begin - int(PngWindowSize));
+    if (dictionaryStart < begin)
+        deflateSetDictionary(&stream, data + dictionaryStart, begin - dictionaryStart);
+
+    output->resize(int(deflateBound(&stream, end - begin)) + 16);
+    stream.next_in = const_cast<Bytef *>(data + begin);
+    stream.avail_in = end - begin;
+    stream.next_out = reinterpret_cast<Bytef *>(output->data());
+    stream.avail_out = output->size();
+
+    bool ok = false;
+    forever {
+        const int ret = deflate(&stream, finish ? Z_FINISH : Z_SYNC_FLUSH);
+        if (ret == Z_STREAM_ERROR)
+            break;
+        if (finish ? ret == Z_STREAM_END : (stream.avail_in == 0 && stream.avail_out != 0)) {
+            ok = true;
+            break;
+        }
+        const int used = output->size() - int(stream.avail_out);
+        output->resize(output->size() * 2);
+        stream.next_out = reinterpret_cast<Bytef *>(output->data()) + used;
+        stream.avail_out = output->size() - used;
+    }
+    output->resize(output->size() - int(stream.avail_out));
+    deflateEnd(&stream);
+    return ok;
+}
+
+class QPngIdatWriter
+{
+public:
+    QPngIdatWriter(QIODevice *device, int width, int height, QImage::Format format,
+                   int compressionLevel, QPngStreamWriter::FilterMode filterMode,
+                   QThreadPool *threadPool);
+
+    int batchRowCount() const { return rowsPerSegment * segmentsPerBatch; }
+    bool writeRows(const QImage &rows);
+
+private:
+    bool compressBatch();
+
+    QIODevice *device;
+    QImage::Format format;
+    int width;
+    int height;
+    int bpp;
+    int rowBytes;
+    int level;
+    QPngStreamWriter::FilterMode filterMode;
+    QThreadPool *threadPool;
+    int rowsPerSegment;
+    int segmentsPerBatch;
+
+    QByteArray rawRows;     // previous row followed by the rows of the batch
+    QByteArray dictionary;  // the last 32 KB of filtered data
+    int batchRows;
+    int rowsDone;
+    uLong adler;
+};
+
+QPngIdatWriter::QPngIdatWriter(QIODevice *device, int width, int height, QImage::Format format,
+                               int compressionLevel, QPngStreamWriter::FilterMode filterMode,
+                               QThreadPool *threadPool)
+    : device(device), format(format), width(width), height(height),
+      level(compressionLevel), filterMode(filterMode), threadPool(threadPool),
+      batchRows(0), rowsDone(0), adler(adler32(0L, Z_NULL, 0))
+{
+    switch (format) {
+    case QImage::Format_ARGB32:
+        bpp = 4;
+        break;
+    case QImage::Format_RGB32:
+    case QImage::Format_RGB888:
+        bpp = 3;
+        break;
+    default:
+        bpp = 1;
+        break;
+    }
+    rowBytes = width * bpp;
+    rowsPerSegment = qMax(1, int(PngSegmentSize) / (rowBytes + 1));
+#ifndef QT_NO_THREAD
+    segmentsPerBatch = threadPool ? 2 * qMax(1, threadPool->maxThreadCount()) : 1;
+#else
+    segmentsPerBatch = 1;
+#endif
+    rawRows.fill(0, (batchRowCount() + 1) * rowBytes);
+}
+
+bool QPngIdatWriter::writeRows(const QImage &rows)
+{
+    Q_ASSERT(rows.format() == format && rows.width() == width);
+    for (int y = 0; y < rows.height(); ++y) {
+        if (rowsDone + batchRows >= height)
+            return false;
+
+        const uchar *src = rows.constScanLine(y);
+        uchar *dst = reinterpret_cast<uchar *>(rawRows.data()) + (batchRows + 1) * rowBytes;
+        if (format == QImage::Format_RGB32 || format == QImage::Format_ARGB32) {
+            const QRgb *pixels = reinterpret_cast<const QRgb *>(src);
+            for (int x = 0; x < width; ++x) {
+                *dst++ = qRed(pixels[x]);
+                *dst++ = qGreen(pixels[x]);
+                *dst++ = qBlue(pixels[x]);
+                if (bpp == 4)
+                    *dst++ = qAlpha(pixels[x]);
+            }
+        } else {
+            memcpy(dst, src, rowBytes);
+        }
+
+        ++batchRows;
+        if ((batchRows == batchRowCount() || rowsDone + batchRows == height) && !compressBatch())
+            return false;
+    }
+    return true;
+}
+
+bool QPngIdatWriter::compressBatch()
+{
+    const bool last = rowsDone + batchRows == height;
+    const int filteredRowBytes = rowBytes + 1;
+    const int segmentCount = (batchRows + rowsPerSegment - 1) / rowsPerSegment;
+    const int dictionarySize = dictionary.size();
+
+    QByteArray filtered(dictionarySize + batchRows * filteredRowBytes, Qt::Uninitialized);
+    memcpy(filtered.data(), dictionary.constData(), dictionarySize);
+    const uchar *raw = reinterpret_cast<const uchar *>(rawRows.constData()) + rowBytes;
+    uchar *data = reinterpret_cast<uchar *>(filtered.data());
+
+    qt_imageProcessTasks(segmentCount, threadPool, [&](int segment) {
+        QVarLengthArray<uchar, 4096> scratch(filteredRowBytes);
+        const int end = qMin(batchRows, (segment + 1) * rowsPerSegment);
+        for (int y = segment * rowsPerSegment; y < end; ++y) {
+            const uchar *row = raw + y * rowBytes;
+            uchar *out = data + dictionarySize + y * filteredRowBytes;
+            if (filterMode == QPngStreamWriter::FilterAdaptive)
+                qt_png_filter_row_adaptive(row, row - rowBytes, out, scratch.data(), rowBytes, bpp);
+            else
+                qt_png_filter_row(filterMode, row, row - rowBytes, out, rowBytes, bpp);
+        }
+    });
+
+    const int strategy = filterMode == QPngStreamWriter::FilterNone ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+    QVector<QByteArray> compressed(segmentCount);
+    QVector<uLong> checksums(segmentCount);
+    QVector<char> succeeded(segmentCount);
+    QByteArray *compressedData = compressed.data();
+    uLong *checksumData = checksums.data();
+    char *succeededData = succeeded.data();
+
+    qt_imageProcessTasks(segmentCount, threadPool, [&](int segment) {
+        const int begin = dictionarySize + segment * rowsPerSegment * filteredRowBytes;
+        const int end = qMin(filtered.size(), begin + rowsPerSegment * filteredRowBytes);
+        const bool finish = last && segment == segmentCount - 1;
+        succeededData[segment] = qt_png_deflate_segment(data, begin, end, level, strategy,
+                                                        finish, &compressedData[segment]);
+        checksumData[segment] = adler32(adler32(0L, Z_NULL, 0), data + begin, end - begin);
+    });
+
+    for (int segment = 0; segment < segmentCount; ++segment) {
+        if (!succeeded.at(segment))
+            return false;
+
+        const int begin = dictionarySize + segment * rowsPerSegment * filteredRowBytes;
+        const int end = qMin(filtered.size(), begin + rowsPerSegment * filteredRowBytes);
+        QByteArray &chunk = compressed[segment];
+        if (rowsDone == 0 && segment == 0) {
+            // zlib header, with the level flags deflate() itself would write
+            const int levelFlags = level == 0 || level == 1 ? 0
+                                 : level >= 2 && level < 6 ? 1
+                                 : level == 6 || level == Z_DEFAULT_COMPRESSION ? 2 : 3;
+            quint16 header = (0x78 << 8) | (levelFlags << 6);
+            header += 31 - header % 31;
+            uchar bytes[2];
+            qToBigEndian<quint16>(header, bytes);
+            chunk.prepend(reinterpret_cast<const char *>(bytes), 2);
+            adler = checksums.at(segment);
+        } else {
+            adler = adler32_combine(adler, checksums.at(segment), end - begin);
+        }
+        if (last && segment == segmentCount - 1) {
+            uchar bytes[4];
+            qToBigEndian<quint32>(adler, bytes);
+            chunk.append(reinterpret_cast<const char *>(bytes), 4);
+        }
+        if (!qt_png_write_chunk(device, "IDAT", chunk.constData(), chunk.size()))
+            return false;
+    }
+
+    dictionary = filtered.right(PngWindowSize);
+    memcpy(rawRows.data(), raw + (batchRows - 1) * rowBytes, rowBytes);
+    rowsDone += batchRows;
+    batchRows = 0;
+    return true;
+}
+
+// Whether compressing the image data on the global thread pool is worth it
+static bool qt_png_use_idat_writer(const QImage &image)
+{
+#ifndef QT_NO_THREAD
+    if (image.depth() == 1 || QThreadPool::globalInstance()->maxThreadCount() < 2)
+        return false;
+    return qint64(image.width()) * image.height() * 4 >= 4 * PngSegmentSize;
+#else
+    Q_UNUSED(image)
+    return false;
+#endif
+}
+
+static bool write_png_image_data(QIODevice *device, const QImage &image, int compressionLevel,
+                                 int colorType)
+{
+    QImage::Format format = image.format();
+    switch (format) {
+    case QImage::Format_Indexed8:
+    case QImage::Format_Grayscale8:
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_RGB888:
+        break;
+    default:
+        format = image.hasAlphaChannel() ? QImage::Format_ARGB32 : QImage::Format_RGB32;
+        break;
+    }
+
+    // Same filtering as libpng: none for palette images, adaptive for the others
+    const QPngStreamWriter::FilterMode filterMode = colorType == PNG_COLOR_TYPE_PALETTE
+            ? QPngStreamWriter::FilterNone : QPngStreamWriter::FilterAdaptive;
+#ifndef QT_NO_THREAD
+    QThreadPool *threadPool = QThreadPool::globalInstance();
+#else
+    QThreadPool *threadPool = 0;
+#endif
+    QPngIdatWriter writer(device, image.width(), image.height(), format,
+                          compressionLevel, filterMode, threadPool);
+
+    const int step = writer.batchRowCount();
+    for (int y = 0; y < image.height(); y += step) {
+        const int rowCount = qMin(step, image.height() - y);
+        const QImage rows = format == image.format()
+                ? QImage(image.constScanLine(y), image.width(), rowCount, image.bytesPerLine(), format)
+                : image.copy(0, y, image.width(), rowCount).convertToFormat(format);
+        if (!writer.writeRows(rows))
+            return false;
+    }
+    return true;
+}
+
 static void set_text(const QImage &image, png_structp png_ptr, png_infop info_ptr,
                      const QString &description)
 {
@@ -930,6 +1297,16 @@ bool QPNGImageWriter::writeImage(const QImage& image, volatile int quality_in, c
         png_write_chunk(png_ptr, const_cast<png_bytep>((const png_byte *)"gIFg"), data, 4);
     }
 
+    if (qt_png_use_idat_writer(image)) {
+        // The image data and the end chunk bypass libpng
+        const bool ok = write_png_image_data(dev, image, quality, color_type)
+                && qt_png_write_chunk(dev, "IEND", 0, 0);
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        if (ok)
+            frames_written++;
+        return ok;
+    }
+
     int height = image.height();
     int width = image.width();
     switch (image.format()) {
@@ -1079,6 +1456,304 @@ QByteArray QPngHandler::name() const
     return "png";
 }
 
+class QPngStreamWriterPrivate
+{
+public:
+    QPngStreamWriterPrivate(QIODevice *device)
+        : device(device),
+          compressionLevel(-1),
+          filterMode(QPngStreamWriter::FilterAdaptive),
+#ifndef QT_NO_THREAD
+          threadPool(QThreadPool::globalInstance()),
+#else
+          threadPool(0),
+#endif
+          format(QImage::Format_Invalid),
+          rowsWritten(0)
+    { }
+
+    bool writeHeader(const QVector<QRgb> &colorTable);
+
+    QIODevice *device;
+    int compressionLevel;
+    QPngStreamWriter::FilterMode filterMode;
+    QThreadPool *threadPool;
+
+    QSize size;
+    QImage::Format format;
+    int rowsWritten;
+    QScopedPointer<QPngIdatWriter> idatWriter;
+};
+
+bool QPngStreamWriterPrivate::writeHeader(const QVector<QRgb> &colorTable)
+{
+    int colorType;
+    switch (format) {
+    case QImage::Format_Indexed8:
+        colorType = PNG_COLOR_TYPE_PALETTE;
+        break;
+    case QImage::Format_Grayscale8:
+        colorType = PNG_COLOR_TYPE_GRAY;
+        break;
+    case QImage::Format_ARGB32:
+        colorType = PNG_COLOR_TYPE_RGB_ALPHA;
+        break;
+    default:
+        colorType = PNG_COLOR_TYPE_RGB;
+        break;
+    }
+
+    if (device->write("\x89\x50\x4E\x47\x0D\x0A\x1A\x0A", 8) != 8)
+        return false;
+
+    uchar header[13];
+    qToBigEndian<quint32>(size.width(), header);
+    qToBigEndian<quint32>(size.height(), header + 4);
+    header[8] = 8;          // bit depth
+    header[9] = colorType;
+    header[10] = 0;         // deflate compression
+    header[11] = 0;         // adaptive filtering
+    header[12] = 0;         // no interlacing
+    if (!qt_png_write_chunk(device, "IHDR", reinterpret_cast<const char *>(header), 13))
+        return false;
+
+    if (colorType == PNG_COLOR_TYPE_PALETTE) {
+        const int colorCount = qMin(256, colorTable.size());
+        QByteArray palette;
+        QByteArray transparency;
+        int transparencySize = 0;
+        for (int i = 0; i < colorCount; ++i) {
+            const QRgb color = colorTable.at(i);
+            palette.append(char(qRed(color)));
+            palette.append(char(qGreen(color)));
+            palette.append(char(qBlue(color)));
+            transparency.append(char(qAlpha(color)));
+            if (qAlpha(color) < 255)
+                transparencySize = i + 1;
+        }
+        if (!qt_png_write_chunk(device, "PLTE", palette.constData(), palette.size()))
+            return false;
+        if (transparencySize
+            && !qt_png_write_chunk(device, "tRNS", transparency.constData(), transparencySize)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+    \class QPngStreamWriter
+    \internal
+    \since 5.10
+
+    \brief The QPngStreamWriter class writes PNG files row by row.
+
+    QPngStreamWriter lets images be encoded as they are produced, without
+    the whole image ever being held in memory. Call begin() with the size
+    and format of the image, pass the rows from top to bottom to
+    writeRows(), in as many calls as convenient, and finish with end().
+
+    The rows are filtered and compressed in batches of independent
+    segments, which are spread over threadPool(). Only a few segments are
+    held in memory at any time.
+*/
+
+/*!
+    \enum QPngStreamWriter::FilterMode
+
+    This enum describes how the rows are filtered before compression.
+
+    \value FilterNone The rows are not filtered. This usually works best
+    for palette images.
+    \value FilterSub Each byte is stored as the difference to the
+    corresponding byte of the pixel to its left.
+    \value FilterUp Each byte is stored as the difference to the byte
+    above it.
+    \value FilterAverage Each byte is stored as the difference to the
+    average of the bytes to its left and above it.
+    \value FilterPaeth Each byte is stored as the difference to the Paeth
+    predictor of the bytes to its left, above it and to its upper left.
+    \value FilterAdaptive Each row uses whichever of the other filters
+    gives the smallest sum of absolute differences, like libpng does. This
+    is the default.
+*/
+
+/*!
+    Constructs a PNG stream writer that writes to \a device.
+*/
+QPngStreamWriter::QPngStreamWriter(QIODevice *device)
+    : d(new QPngStreamWriterPrivate(device))
+{
+}
+
+/*!
+    Destroys the writer. An image that has not been completed with end()
+    is left truncated.
+*/
+QPngStreamWriter::~QPngStreamWriter()
+{
+}
+
+/*!
+    Returns the device the writer writes to.
+*/
+QIODevice *QPngStreamWriter::device() const
+{
+    return d->device;
+}
+
+/*!
+    Sets the zlib compression level to \a level, from 0 (no compression)
+    to 9 (best compression). The default, -1, uses zlib's default level.
+*/
+void QPngStreamWriter::setCompressionLevel(int level)
+{
+    d->compressionLevel = qBound(-1, level, 9);
+}
+
+/*!
+    Returns the zlib compression level.
+*/
+int QPngStreamWriter::compressionLevel() const
+{
+    return d->compressionLevel;
+}
+
+/*!
+    Sets the filter applied to the rows to \a mode.
+*/
+void QPngStreamWriter::setFilterMode(FilterMode mode)
+{
+    d->filterMode = mode;
+}
+
+/*!
+    Returns the filter applied to the rows.
+*/
+QPngStreamWriter::FilterMode QPngStreamWriter::filterMode() const
+{
+    return d->filterMode;
+}
+
+/*!
+    Sets the thread pool that compresses the rows to \a pool. Passing a
+    null pool compresses all rows on the calling thread.
+
+    By default, QThreadPool::globalInstance() is used.
+*/
+void QPngStreamWriter::setThreadPool(QThreadPool *pool)
+{
+    d->threadPool = pool;
+}
+
+/*!
+    Returns the thread pool that compresses the rows.
+*/
+QThreadPool *QPngStreamWriter::threadPool() const
+{
+    return d->threadPool;
+}
+
+/*!
+    Writes the PNG header for an image of the given \a size and \a format
+    and prepares for the rows to be written. Returns \c true on success.
+
+    Palette formats are written with the colors of \a colorTable. Images
+    with an alpha channel are written with 8 bit RGBA pixels, other color
+    images with 8 bit RGB pixels.
+*/
+bool QPngStreamWriter::begin(const QSize &size, QImage::Format format,
+                             const QVector<QRgb> &colorTable)
+{
+    if (d->idatWriter) {
+        qWarning("QPngStreamWriter::begin: An image is already being written");
+        return false;
+    }
+    if (!d->device || !d->device->isWritable()) {
+        qWarning("QPngStreamWriter::begin: Device not writable");
+        return false;
+    }
+    if (size.isEmpty() || format == QImage::Format_Invalid)
+        return false;
+
+    switch (format) {
+    case QImage::Format_Mono:
+    case QImage::Format_MonoLSB:
+    case QImage::Format_Indexed8:
+        if (colorTable.isEmpty()) {
+            qWarning("QPngStreamWriter::begin: Palette formats need a color table");
+            return false;
+        }
+        d->format = QImage::Format_Indexed8;
+        break;
+    case QImage::Format_Grayscale8:
+    case QImage::Format_RGB888:
+        d->format = format;
+        break;
+    default:
+        d->format = QImage::toPixelFormat(format).alphaUsage() == QPixelFormat::UsesAlpha
+                ? QImage::Format_ARGB32 : QImage::Format_RGB32;
+        break;
+    }
+    d->size = size;
+    d->rowsWritten = 0;
+
+    if (!d->writeHeader(colorTable))
+        return false;
+
+    d->idatWriter.reset(new QPngIdatWriter(d->device, size.width(), size.height(), d->format,
+                                           d->compressionLevel, d->filterMode, d->threadPool));
+    return true;
+}
+
+/*!
+    Writes the scanlines of \a rows as the next rows of the image. \a rows
+    must be as wide as the image; it is converted to the format the image
+    is written with if necessary. Returns \c true on success.
+*/
+bool QPngStreamWriter::writeRows(const QImage &rows)
+{
+    if (!d->idatWriter) {
+        qWarning("QPngStreamWriter::writeRows: begin() has not been called");
+        return false;
+    }
+    if (rows.width() != d->size.width() || rows.height() > d->size.height() - d->rowsWritten) {
+        qWarning("QPngStreamWriter::writeRows: The rows do not fit the image");
+        return false;
+    }
+
+    const QImage converted = rows.format() == d->format ? rows : rows.convertToFormat(d->format);
+    if (!d->idatWriter->writeRows(converted))
+        return false;
+    d->rowsWritten += rows.height();
+    return true;
+}
+
+/*!
+    Completes the image. All rows must have been written. Returns \c true
+    on success.
+*/
+bool QPngStreamWriter::end()
+{
+    if (!d->idatWriter)
+        return false;
+    d->idatWriter.reset();
+    if (d->rowsWritten != d->size.height()) {
+        qWarning("QPngStreamWriter::end: Only %d of %d rows were written",
+                 d->rowsWritten, d->size.height());
+        return false;
+    }
+    return qt_png_write_chunk(d->device, "IEND", 0, 0);
+}
+
+/*!
+    Returns the number of rows written since begin().
+*/
+int QPngStreamWriter::rowsWritten() const
+{
+    return d->rowsWritten;
+}
+
 QT_END_NAMESPACE
 
 #endif // QT_NO_IMAGEFORMAT_PNG
@@ -53,6 +53,8 @@
 
 #include <QtGui/private/qtguiglobal_p.h>
 #include "QtGui/qimageiohandler.h"
+#include "QtGui/qimage.h"
+#include <QtCore/qscopedpointer.h>
 
 #ifndef QT_NO_IMAGEFORMAT_PNG
 
@@ -81,6 +83,47 @@ private:
     QPngHandlerPrivate *d;
 };
 
+class QThreadPool;
+class QPngStreamWriterPrivate;
+
+class Q_GUI_EXPORT QPngStreamWriter
+{
+public:
+    enum FilterMode {
+        FilterNone,
+        FilterSub,
+        FilterUp,
+        FilterAverage,
+        FilterPaeth,
+        FilterAdaptive
+    };
+
+    explicit QPngStreamWriter(QIODevice *device);
+    ~QPngStreamWriter();
+
+    QIODevice *device() const;
+
+    void setCompressionLevel(int level);
+    int compressionLevel() const;
+
+    void setFilterMode(FilterMode mode);
+    FilterMode filterMode() const;
+
+    void setThreadPool(QThreadPool *pool);
+    QThreadPool *threadPool() const;
+
+    bool begin(const QSize &size, QImage::Format format,
+               const QVector<QRgb> &colorTable = QVector<QRgb>());
+    bool writeRows(const QImage &rows);
+    bool end();
+
+    int rowsWritten() const;
+
+private:
+    Q_DISABLE_COPY(QPngStreamWriter)
+    QScopedPointer<QPngStreamWriterPrivate> d;
+};
+
 QT_END_NAMESPACE
 
 #endif // QT_NO_IMAGEFORMAT_PNG
@@ -9,6 +9,7 @@ HEADERS += \
         painting/qcolor.h \
         painting/qcolor_p.h \
         painting/qcolorprofile_p.h \
+        painting/qcolortransform_p.h \
         painting/qcosmeticstroker_p.h \
         painting/qdatabuffer_p.h \
         painting/qdrawhelper_p.h \
@@ -24,6 +25,8 @@ HEADERS += \
         painting/qpagedpaintdevice_p.h \
         painting/qpagelayout.h \
         painting/qpagesize.h \
+        painting/qpaintbuffer.h \
+        painting/qpaintbuffer_p.h \
         painting/qpaintdevice.h \
         painting/qpaintengine.h \
         painting/qpaintengine_p.h \
@@ -50,6 +53,8 @@ HEADERS += \
         painting/qrgba64_p.h \
         painting/qstroker_p.h \
         painting/qtextureglyphcache_p.h \
+        painting/qtiledpaintdevice.h \
+        painting/qtiledpaintdevice_p.h \
         painting/qtransform.h \
         painting/qtriangulatingstroker_p.h \
         painting/qtriangulator_p.h \
@@ -65,6 +70,7 @@ SOURCES += \
         painting/qbrush.cpp \
         painting/qcolor.cpp \
         painting/qcolorprofile.cpp \
+        painting/qcolortransform.cpp \
         painting/qcompositionfunctions.cpp \
         painting/qcosmeticstroker.cpp \
         painting/qdrawhelper.cpp \
@@ -77,6 +83,7 @@ SOURCES += \
         painting/qpagedpaintdevice.cpp \
         painting/qpagelayout.cpp \
         painting/qpagesize.cpp \
+        painting/qpaintbuffer.cpp \
         painting/qpaintdevice.cpp \
         painting/qpaintengine.cpp \
         painting/qpaintengineex.cpp \
@@ -93,6 +100,7 @@ SOURCES += \
         painting/qregion.cpp \
         painting/qstroker.cpp \
         painting/qtextureglyphcache.cpp \
+        painting/qtiledpaintdevice.cpp \
         painting/qtransform.cpp \
         painting/qtriangulatingstroker.cpp \
         painting/qtriangulator.cpp \
@@ -120,6 +128,7 @@ SSSE3_SOURCES += painting/qdrawhelper_ssse3.cpp
 SSE4_1_SOURCES += painting/qdrawhelper_sse4.cpp \
                   painting/qimagescale_sse4.cpp
 AVX2_SOURCES += painting/qdrawhelper_avx2.cpp
+AVX512CORE_SOURCES += painting/qdrawhelper_avx512.cpp
 
 NEON_SOURCES += painting/qdrawhelper_neon.cpp painting/qimagescale_neon.cpp
 NEON_HEADERS += painting/qdrawhelper_neon_p.h
@@ -38,6 +38,7 @@
 ****************************************************************************/
 
 #include "qcolorprofile_p.h"
+#include "qcolortransform_p.h"
 #include <qmath.h>
 
 QT_BEGIN_NAMESPACE
@@ -84,4 +85,17 @@ QColorProfile *QColorProfile::fromSRgb()
     return cp;
 }
 
+QColorProfile *QColorProfile::fromTransferFunction(const QColorTransferFunction &transferFunction)
+{
+    QColorProfile *cp = new QColorProfile;
+
+    for (int i = 0; i <= (255 * 16); ++i) {
+        const float v = i / float(255 * 16);
+        cp->m_toLinear[i] = ushort(qRound(qBound(0.0f, transferFunction.apply(v), 1.0f) * (255 * 256)));
+        cp->m_fromLinear[i] = ushort(qRound(qBound(0.0f, transferFunction.applyInverse(v), 1.0f) * (255 * 256)));
+    }
+
+    return cp;
+}
+
 QT_END_NAMESPACE
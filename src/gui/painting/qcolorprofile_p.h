@@ -57,11 +57,14 @@
 
 QT_BEGIN_NAMESPACE
 
+class QColorTransferFunction;
+
 class Q_GUI_EXPORT QColorProfile
 {
 public:
     static QColorProfile *fromGamma(qreal gamma);
     static QColorProfile *fromSRgb();
+    static QColorProfile *fromTransferFunction(const QColorTransferFunction &transferFunction);
 
     // The following methods all convert opaque or unpremultiplied colors:
 
@@ -140,9 +143,38 @@ public:
         return QRgba64::fromRgba64(r, g, b, rgb64.alpha());
     }
 
+    // Interpolates between the table entries, for 16 bit precision:
+
+    QRgba64 toLinearPrecise(QRgba64 rgb64) const
+    {
+        return QRgba64::fromRgba64(lookupPrecise(m_toLinear, rgb64.red()),
+                                   lookupPrecise(m_toLinear, rgb64.green()),
+                                   lookupPrecise(m_toLinear, rgb64.blue()),
+                                   rgb64.alpha());
+    }
+
+    QRgba64 fromLinearPrecise(QRgba64 rgb64) const
+    {
+        return QRgba64::fromRgba64(lookupPrecise(m_fromLinear, rgb64.red()),
+                                   lookupPrecise(m_fromLinear, rgb64.green()),
+                                   lookupPrecise(m_fromLinear, rgb64.blue()),
+                                   rgb64.alpha());
+    }
+
 private:
     QColorProfile() { }
 
+    static ushort lookupPrecise(const ushort *table, ushort v)
+    {
+        v = v - (v >> 8);
+        const int index = v >> 4;
+        const int fraction = v & 15;
+        int r = table[index];
+        if (fraction)
+            r += ((table[index + 1] - r) * fraction + 8) >> 4;
+        return r + (r >> 8);
+    }
+
     // We translate to 0-65280 (255*256) instead to 0-65535 to make simple
     // shifting an accurate conversion.
     // We translate from 0-4080 (255*16) for the same speed up, and to keep
@@ -0,0 +1,582 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtGui module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qcolortransform_p.h"
+#include "qcolorprofile_p.h"
+
+#include <qhash.h>
+#include <qmath.h>
+#include <qmutex.h>
+#include <qvarlengtharray.h>
+#include <private/qdrawhelper_p.h>
+#include <private/qimage_p.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <cmath>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    The conversion pipeline for integer pixels works on top of QColorProfile:
+    the transfer function of the source takes the pixels to 16 bit linear
+    light through a lookup table, a 3x3 matrix maps the linear values from
+    the source primaries to the destination primaries, and the lookup table
+    of the destination transfer function encodes them again. The lookup
+    tables are shared between all transforms with the same transfer
+    function. Float pixels go through the transfer functions directly, so
+    that values outside [0, 1] survive.
+*/
+
+float QColorTransferFunction::apply(float x) const
+{
+    const float sign = x < 0 ? -1.0f : 1.0f;
+    x = qAbs(x);
+    if (x < m_d)
+        return sign * (m_c * x + m_f);
+    return sign * (std::pow(qMax(m_a * x + m_b, 0.0f), m_g) + m_e);
+}
+
+float QColorTransferFunction::applyInverse(float y) const
+{
+    const float sign = y < 0 ? -1.0f : 1.0f;
+    y = qAbs(y);
+    if (y < m_c * m_d + m_f)
+        return qFuzzyIsNull(m_c) ? 0.0f : sign * (y - m_f) / m_c;
+    return sign * (std::pow(qMax(y - m_e, 0.0f), 1.0f / m_g) - m_b) / m_a;
+}
+
+bool QColorMatrix::isIdentity() const
+{
+    const QColorMatrix id = identity();
+    const float epsilon = 1.0f / (1 << 16);
+    return qAbs(r.x - id.r.x) < epsilon && qAbs(r.y - id.r.y) < epsilon && qAbs(r.z - id.r.z) < epsilon
+        && qAbs(g.x - id.g.x) < epsilon && qAbs(g.y - id.g.y) < epsilon && qAbs(g.z - id.g.z) < epsilon
+        && qAbs(b.x - id.b.x) < epsilon && qAbs(b.y - id.b.y) < epsilon && qAbs(b.z - id.b.z) < epsilon;
+}
+
+QColorMatrix QColorMatrix::inverted() const
+{
+    const float det = r.x * (g.y * b.z - b.y * g.z)
+                    - g.x * (r.y * b.z - b.y * r.z)
+                    + b.x * (r.y * g.z - g.y * r.z);
+    if (qFuzzyIsNull(det))
+        return QColorMatrix();
+    const float invDet = 1.0f / det;
+
+    QColorMatrix inv;
+    inv.r.x = (g.y * b.z - b.y * g.z) * invDet;
+    inv.r.y = (b.y * r.z - r.y * b.z) * invDet;
+    inv.r.z = (r.y * g.z - g.y * r.z) * invDet;
+    inv.g.x = (b.x * g.z - g.x * b.z) * invDet;
+    inv.g.y = (r.x * b.z - b.x * r.z) * invDet;
+    inv.g.z = (g.x * r.z - r.x * g.z) * invDet;
+    inv.b.x = (g.x * b.y - b.x * g.y) * invDet;
+    inv.b.y = (b.x * r.y - r.x * b.y) * invDet;
+    inv.b.z = (r.x * g.y - g.x * r.y) * invDet;
+    return inv;
+}
+
+QColorMatrix QColorMatrix::fromPrimaries(QPointF red, QPointF green, QPointF blue, QPointF whitePoint)
+{
+    // Scale the primaries so that they add up to the white point
+    const QColorMatrix primaries(QColorVector::fromXY(red),
+                                 QColorVector::fromXY(green),
+                                 QColorVector::fromXY(blue));
+    const QColorVector scale = primaries.inverted().map(QColorVector::fromXY(whitePoint));
+    QColorMatrix m = primaries;
+    m.r.x *= scale.x; m.r.y *= scale.x; m.r.z *= scale.x;
+    m.g.x *= scale.y; m.g.y *= scale.y; m.g.z *= scale.y;
+    m.b.x *= scale.z; m.b.y *= scale.z; m.b.z *= scale.z;
+    return m;
+}
+
+QColorMatrix QColorMatrix::chromaticAdaptation(QPointF fromWhitePoint, QPointF toWhitePoint)
+{
+    const QColorMatrix bradford(QColorVector(0.8951f, -0.7502f, 0.0389f),
+                                QColorVector(0.2664f, 1.7135f, -0.0685f),
+                                QColorVector(-0.1614f, 0.0367f, 1.0296f));
+    const QColorVector from = bradford.map(QColorVector::fromXY(fromWhitePoint));
+    const QColorVector to = bradford.map(QColorVector::fromXY(toWhitePoint));
+    const QColorMatrix scale(QColorVector(to.x / from.x, 0, 0),
+                             QColorVector(0, to.y / from.y, 0),
+                             QColorVector(0, 0, to.z / from.z));
+    return bradford.inverted() * scale * bradford;
+}
+
+static const QPointF whitePointD50(0.3457, 0.3585);
+static const QPointF whitePointD65(0.3127, 0.3290);
+
+QColorSpaceDefinition::QColorSpaceDefinition()
+    : toXyz(QColorMatrix::identity())
+{
+}
+
+QColorSpaceDefinition::QColorSpaceDefinition(const QColorMatrix &toXyz,
+                                             const QColorTransferFunction &transferFunction)
+    : toXyz(toXyz), transferFunction(transferFunction)
+{
+}
+
+QColorSpaceDefinition QColorSpaceDefinition::fromPrimaries(QPointF red, QPointF green, QPointF blue,
+                                                           QPointF whitePoint,
+                                                           const QColorTransferFunction &transferFunction)
+{
+    const QColorMatrix toXyz = QColorMatrix::fromPrimaries(red, green, blue, whitePoint);
+    return QColorSpaceDefinition(QColorMatrix::chromaticAdaptation(whitePoint, whitePointD50) * toXyz,
+                                 transferFunction);
+}
+
+QColorSpaceDefinition QColorSpaceDefinition::fromNamedColorSpace(NamedColorSpace colorSpace)
+{
+    switch (colorSpace) {
+    case SRgb:
+    case SRgbLinear:
+        return fromPrimaries(QPointF(0.64, 0.33), QPointF(0.30, 0.60), QPointF(0.15, 0.06),
+                             whitePointD65,
+                             colorSpace == SRgb ? QColorTransferFunction::fromSRgb()
+                                                : QColorTransferFunction());
+    case AdobeRgb:
+        return fromPrimaries(QPointF(0.64, 0.33), QPointF(0.21, 0.71), QPointF(0.15, 0.06),
+                             whitePointD65, QColorTransferFunction::fromGamma(563.0f / 256.0f));
+    case DisplayP3:
+        return fromPrimaries(QPointF(0.680, 0.320), QPointF(0.265, 0.690), QPointF(0.150, 0.060),
+                             whitePointD65, QColorTransferFunction::fromSRgb());
+    case ProPhotoRgb:
+        return fromPrimaries(QPointF(0.7347, 0.2653), QPointF(0.1596, 0.8404), QPointF(0.0366, 0.0001),
+                             whitePointD50, QColorTransferFunction::fromProPhotoRgb());
+    case Bt2020:
+        return fromPrimaries(QPointF(0.708, 0.292), QPointF(0.170, 0.797), QPointF(0.131, 0.046),
+                             whitePointD65, QColorTransferFunction::fromBt2020());
+    }
+    Q_UNREACHABLE();
+    return QColorSpaceDefinition();
+}
+
+namespace {
+struct QColorProfileCache
+{
+    QMutex mutex;
+    QHash<QByteArray, QSharedPointer<const QColorProfile> > profiles;
+};
+}
+
+Q_GLOBAL_STATIC(QColorProfileCache, colorProfileCache)
+
+/*
+    Returns the lookup tables of \a transferFunction, creating them the
+    first time they are needed.
+*/
+QSharedPointer<const QColorProfile> qt_colorProfile(const QColorTransferFunction &transferFunction)
+{
+    const float parameters[] = { transferFunction.m_a, transferFunction.m_b, transferFunction.m_c,
+                                 transferFunction.m_d, transferFunction.m_e, transferFunction.m_f,
+                                 transferFunction.m_g };
+    const QByteArray key(reinterpret_cast<const char *>(parameters), sizeof(parameters));
+
+    QColorProfileCache *cache = colorProfileCache();
+    QMutexLocker locker(&cache->mutex);
+    QSharedPointer<const QColorProfile> &profile = cache->profiles[key];
+    if (!profile)
+        profile.reset(QColorProfile::fromTransferFunction(transferFunction));
+    return profile;
+}
+
+QColorTransform::QColorTransform()
+    : m_matrix(QColorMatrix::identity())
+{
+}
+
+QColorTransform::QColorTransform(const QColorSpaceDefinition &source,
+                                 const QColorSpaceDefinition &destination)
+    : m_sourceTransferFunction(source.transferFunction),
+      m_destinationTransferFunction(destination.transferFunction),
+      m_matrix(destination.toXyz.inverted() * source.toXyz),
+      m_source(qt_colorProfile(source.transferFunction)),
+      m_destination(qt_colorProfile(destination.transferFunction))
+{
+}
+
+bool QColorTransform::isIdentity() const
+{
+    return m_matrix.isIdentity() && m_sourceTransferFunction == m_destinationTransferFunction;
+}
+
+// Maps the linear 16 bit colors of buffer through the matrix, in place
+static void applyMatrix(QRgba64 *buffer, int count, const QColorMatrix &m)
+{
+#if defined(__SSE2__)
+    const __m128 cr = _mm_set_ps(0.0f, m.r.z, m.r.y, m.r.x);
+    const __m128 cg = _mm_set_ps(0.0f, m.g.z, m.g.y, m.g.x);
+    const __m128 cb = _mm_set_ps(0.0f, m.b.z, m.b.y, m.b.x);
+    const __m128 ca = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+    const __m128 maxValue = _mm_set1_ps(65535.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16(short(0x8000));
+    for (int i = 0; i < count; ++i) {
+        __m128i pixel = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(buffer + i));
+        pixel = _mm_unpacklo_epi16(pixel, _mm_setzero_si128());
+        const __m128 v = _mm_cvtepi32_ps(pixel);
+        __m128 result = _mm_mul_ps(cr, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+        result = _mm_add_ps(result, _mm_mul_ps(cg, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+        result = _mm_add_ps(result, _mm_mul_ps(cb, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+        result = _mm_add_ps(result, _mm_mul_ps(ca, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+        result = _mm_min_ps(_mm_max_ps(result, zero), maxValue);
+        // There is no unsigned 32 to 16 bit pack in SSE2, bias into the signed range
+        pixel = _mm_sub_epi32(_mm_cvtps_epi32(result), bias32);
+        pixel = _mm_xor_si128(_mm_packs_epi32(pixel, pixel), bias16);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(buffer + i), pixel);
+    }
+#else
+    for (int i = 0; i < count; ++i) {
+        const QColorVector c = m.map(QColorVector(buffer[i].red(), buffer[i].green(), buffer[i].blue()));
+        buffer[i] = qRgba64(qRound(qBound(0.0f, c.x, 65535.0f)),
+                            qRound(qBound(0.0f, c.y, 65535.0f)),
+                            qRound(qBound(0.0f, c.z, 65535.0f)),
+                            buffer[i].alpha());
+    }
+#endif
+}
+
+enum { ColorTransformBufferSize = 256 };
+
+/*
+    Converts \a count colors from \a src to \a dst, which may be the same
+    buffer. If \a premultiplied is true, the colors are premultiplied.
+*/
+void QColorTransform::apply(QRgb *dst, const QRgb *src, int count, bool premultiplied) const
+{
+    if (isIdentity()) {
+        if (dst != src)
+            memmove(dst, src, count * sizeof(QRgb));
+        return;
+    }
+
+    QRgba64 buffer[ColorTransformBufferSize];
+    for (int i = 0; i < count; i += ColorTransformBufferSize) {
+        const int length = qMin(int(ColorTransformBufferSize), count - i);
+        for (int j = 0; j < length; ++j) {
+            const QRgb color = premultiplied ? qUnpremultiply(src[i + j]) : src[i + j];
+            buffer[j] = m_source->toLinear64(color);
+        }
+        applyMatrix(buffer, length, m_matrix);
+        for (int j = 0; j < length; ++j) {
+            const QRgb color = m_destination->fromLinearPrecise(buffer[j]).toArgb32();
+            dst[i + j] = premultiplied ? qPremultiply(color) : color;
+        }
+    }
+}
+
+/*
+    Converts \a count 16 bit colors from \a src to \a dst.
+*/
+void QColorTransform::apply(QRgba64 *dst, const QRgba64 *src, int count, bool premultiplied) const
+{
+    if (isIdentity()) {
+        if (dst != src)
+            memmove(dst, src, count * sizeof(QRgba64));
+        return;
+    }
+
+    QRgba64 buffer[ColorTransformBufferSize];
+    for (int i = 0; i < count; i += ColorTransformBufferSize) {
+        const int length = qMin(int(ColorTransformBufferSize), count - i);
+        for (int j = 0; j < length; ++j) {
+            const QRgba64 color = premultiplied ? src[i + j].unpremultiplied() : src[i + j];
+            buffer[j] = m_source->toLinearPrecise(color);
+        }
+        applyMatrix(buffer, length, m_matrix);
+        for (int j = 0; j < length; ++j) {
+            const QRgba64 color = m_destination->fromLinearPrecise(buffer[j]);
+            dst[i + j] = premultiplied ? color.premultiplied() : color;
+        }
+    }
+}
+
+/*
+    Converts \a count unpremultiplied RGBA float colors from \a src to \a dst.
+*/
+void QColorTransform::apply(float *dst, const float *src, int count) const
+{
+    for (int i = 0; i < count; ++i, src += 4, dst += 4) {
+        const QColorVector linear(m_sourceTransferFunction.apply(src[0]),
+                                  m_sourceTransferFunction.apply(src[1]),
+                                  m_sourceTransferFunction.apply(src[2]));
+        const QColorVector mapped = m_matrix.map(linear);
+        const float alpha = src[3];
+        dst[0] = m_destinationTransferFunction.applyInverse(mapped.x);
+        dst[1] = m_destinationTransferFunction.applyInverse(mapped.y);
+        dst[2] = m_destinationTransferFunction.applyInverse(mapped.z);
+        dst[3] = alpha;
+    }
+}
+
+template<QtPixelOrder PixelOrder>
+static void applyRgb30(const QColorTransform *transform, QImage *image)
+{
+    const int width = image->width();
+    uchar *bits = image->bits();
+    const int bpl = image->bytesPerLine();
+    qt_imageProcessSegments(image->height(), qint64(width) * image->height(), [=](int yStart, int yEnd) {
+        QRgba64 buffer[ColorTransformBufferSize];
+        for (int y = yStart; y < yEnd; ++y) {
+            uint *line = reinterpret_cast<uint *>(bits + y * bpl);
+            for (int x = 0; x < width; x += ColorTransformBufferSize) {
+                const int length = qMin(int(ColorTransformBufferSize), width - x);
+                for (int i = 0; i < length; ++i)
+                    buffer[i] = qConvertA2rgb30ToRgb64<PixelOrder>(line[x + i]);
+                transform->apply(buffer, buffer, length, true);
+                for (int i = 0; i < length; ++i)
+                    line[x + i] = qConvertRgb64ToRgb30<PixelOrder>(buffer[i]);
+            }
+        }
+    });
+}
+
+/*
+    Returns a copy of \a image converted by the transform. Palette images
+    have their color table converted, 10 bit formats are converted with 16
+    bit precision, and all other formats go through 32 bit ARGB.
+*/
+QImage QColorTransform::apply(const QImage &image) const
+{
+    if (image.isNull() || isIdentity())
+        return image;
+
+    switch (image.format()) {
+    case QImage::Format_Mono:
+    case QImage::Format_MonoLSB:
+    case QImage::Format_Indexed8: {
+        QImage result = image;
+        QVector<QRgb> colorTable = image.colorTable();
+        apply(colorTable.data(), colorTable.constData(), colorTable.size());
+        result.setColorTable(colorTable);
+        return result;
+    }
+    case QImage::Format_BGR30:
+    case QImage::Format_A2BGR30_Premultiplied: {
+        QImage result = image.copy();
+        applyRgb30<PixelOrderBGR>(this, &result);
+        return result;
+    }
+    case QImage::Format_RGB30:
+    case QImage::Format_A2RGB30_Premultiplied: {
+        QImage result = image.copy();
+        applyRgb30<PixelOrderRGB>(this, &result);
+        return result;
+    }
+    default:
+        break;
+    }
+
+    QImage::Format format = image.format();
+    if (format != QImage::Format_RGB32 && format != QImage::Format_ARGB32
+        && format != QImage::Format_ARGB32_Premultiplied) {
+        format = image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+    }
+    QImage result = image.convertToFormat(format);
+    if (result.constBits() == image.constBits())
+        result.detach();
+
+    const bool premultiplied = format == QImage::Format_ARGB32_Premultiplied;
+    const int width = result.width();
+    uchar *bits = result.bits();
+    const int bpl = result.bytesPerLine();
+    qt_imageProcessSegments(result.height(), qint64(width) * result.height(), [=](int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; ++y) {
+            QRgb *line = reinterpret_cast<QRgb *>(bits + y * bpl);
+            apply(line, line, width, premultiplied);
+        }
+    });
+
+    if (format != image.format())
+        return result.convertToFormat(image.format());
+    return result;
+}
+
+namespace {
+// The source pixels contributing to one destination pixel
+struct QLinearLightContribution
+{
+    int first;
+    int count;
+    int weightIndex;
+};
+
+struct QLinearLightFilter
+{
+    QVector<QLinearLightContribution> contributions;
+    QVector<float> weights;
+};
+}
+
+// Area averaging when shrinking, linear interpolation when enlarging
+static QLinearLightFilter linearLightFilter(int sourceSize, int destinationSize)
+{
+    QLinearLightFilter filter;
+    filter.contributions.resize(destinationSize);
+    const double scale = double(sourceSize) / destinationSize;
+    for (int i = 0; i < destinationSize; ++i) {
+        QLinearLightContribution &c = filter.contributions[i];
+        c.weightIndex = filter.weights.size();
+        if (scale >= 1.0) {
+            const double start = i * scale;
+            const double end = qMin((i + 1) * scale, double(sourceSize));
+            c.first = int(start);
+            const int last = qMin(int(std::ceil(end)), sourceSize);
+            c.count = last - c.first;
+            for (int s = c.first; s < last; ++s) {
+                const double coverage = qMin(end, s + 1.0) - qMax(start, double(s));
+                filter.weights.append(float(coverage / scale));
+            }
+        } else {
+            const double center = (i + 0.5) * scale - 0.5;
+            const int left = int(std::floor(center));
+            const float fraction = float(center - left);
+            c.first = qBound(0, left, sourceSize - 1);
+            if (left < 0 || left + 1 >= sourceSize) {
+                c.count = 1;
+                filter.weights.append(1.0f);
+            } else {
+                c.count = 2;
+                filter.weights.append(1.0f - fraction);
+                filter.weights.append(fraction);
+            }
+        }
+    }
+    return filter;
+}
+
+/*
+    Returns \a image scaled to \a size with the pixels averaged in linear
+    light rather than in the encoded values given by \a transferFunction,
+    so that scaling does not darken or shift the colors of fine detail.
+*/
+QImage qt_scaleImageLinearLight(const QImage &image, const QSize &size,
+                                const QColorTransferFunction &transferFunction)
+{
+    if (image.isNull() || size.isEmpty())
+        return QImage();
+
+    const bool hasAlpha = image.hasAlphaChannel();
+    const QImage source = image.convertToFormat(hasAlpha ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+    const QSharedPointer<const QColorProfile> profile = qt_colorProfile(transferFunction);
+    const int sourceWidth = source.width();
+    const int sourceHeight = source.height();
+    const int width = size.width();
+    const int height = size.height();
+    const QLinearLightFilter horizontal = linearLightFilter(sourceWidth, width);
+    const QLinearLightFilter vertical = linearLightFilter(sourceHeight, height);
+
+    // Horizontal pass into premultiplied linear float RGBA
+    QVector<float> intermediate(sourceHeight * width * 4);
+    float *intermediateData = intermediate.data();
+    qt_imageProcessSegments(sourceHeight, qint64(sourceWidth) * sourceHeight, [&](int yStart, int yEnd) {
+        QVarLengthArray<float, 4096> linear(sourceWidth * 4);
+        for (int y = yStart; y < yEnd; ++y) {
+            const QRgb *line = reinterpret_cast<const QRgb *>(source.constScanLine(y));
+            for (int x = 0; x < sourceWidth; ++x) {
+                const QRgba64 c = profile->toLinear64(line[x]);
+                const float alpha = c.alpha() / 65535.0f;
+                linear[x * 4] = c.red() * alpha;
+                linear[x * 4 + 1] = c.green() * alpha;
+                linear[x * 4 + 2] = c.blue() * alpha;
+                linear[x * 4 + 3] = alpha;
+            }
+            float *out = intermediateData + qint64(y) * width * 4;
+            for (int x = 0; x < width; ++x) {
+                const QLinearLightContribution &c = horizontal.contributions.at(x);
+                const float *w = horizontal.weights.constData() + c.weightIndex;
+                float r = 0, g = 0, b = 0, a = 0;
+                for (int i = 0; i < c.count; ++i) {
+                    const float *p = linear.constData() + (c.first + i) * 4;
+                    r += p[0] * w[i];
+                    g += p[1] * w[i];
+                    b += p[2] * w[i];
+                    a += p[3] * w[i];
+                }
+                out[x * 4] = r;
+                out[x * 4 + 1] = g;
+                out[x * 4 + 2] = b;
+                out[x * 4 + 3] = a;
+            }
+        }
+    });
+
+    // Vertical pass, back to the encoded values
+    QImage result(size, hasAlpha ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+    if (result.isNull())
+        return QImage();
+    result.setDevicePixelRatio(image.devicePixelRatio());
+    uchar *bits = result.bits();
+    const int bpl = result.bytesPerLine();
+    qt_imageProcessSegments(height, qint64(width) * height, [&](int yStart, int yEnd) {
+        for (int y = yStart; y < yEnd; ++y) {
+            const QLinearLightContribution &c = vertical.contributions.at(y);
+            const float *w = vertical.weights.constData() + c.weightIndex;
+            QRgb *out = reinterpret_cast<QRgb *>(bits + y * bpl);
+            for (int x = 0; x < width; ++x) {
+                float r = 0, g = 0, b = 0, a = 0;
+                for (int i = 0; i < c.count; ++i) {
+                    const float *p = intermediateData + (qint64(c.first + i) * width + x) * 4;
+                    r += p[0] * w[i];
+                    g += p[1] * w[i];
+                    b += p[2] * w[i];
+                    a += p[3] * w[i];
+                }
+                if (a <= 0.0f) {
+                    out[x] = hasAlpha ? 0 : qRgb(0, 0, 0);
+                    continue;
+                }
+                a = qMin(a, 1.0f);
+                const QRgba64 linear = qRgba64(qRound(qBound(0.0f, r / a, 65535.0f)),
+                                               qRound(qBound(0.0f, g / a, 65535.0f)),
+                                               qRound(qBound(0.0f, b / a, 65535.0f)),
+                                               qRound(a * 65535.0f));
+                out[x] = qPremultiply(profile->fromLinearPrecise(linear).toArgb32());
+            }
+        }
+    });
+    return result;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,238 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtGui module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QCOLORTRANSFORM_P_H
+#define QCOLORTRANSFORM_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include <QtGui/qimage.h>
+#include <QtGui/qrgb.h>
+#include <QtGui/qrgba64.h>
+#include <QtCore/qpoint.h>
+#include <QtCore/qsharedpointer.h>
+
+QT_BEGIN_NAMESPACE
+
+class QColorProfile;
+
+// A parametric transfer function, as in ICC parametric curves:
+//   f(x) = c * x + f             for x < d
+//   f(x) = (a * x + b)^g + e     for x >= d
+// It maps encoded values to linear light.
+class Q_GUI_EXPORT QColorTransferFunction
+{
+public:
+    QColorTransferFunction()
+        : m_a(1), m_b(0), m_c(0), m_d(0), m_e(0), m_f(0), m_g(1)
+    { }
+    QColorTransferFunction(float a, float b, float c, float d, float e, float f, float g)
+        : m_a(a), m_b(b), m_c(c), m_d(d), m_e(e), m_f(f), m_g(g)
+    { }
+
+    bool isLinear() const
+    {
+        return qFuzzyCompare(m_a, 1.0f) && qFuzzyIsNull(m_b) && qFuzzyIsNull(m_d)
+            && qFuzzyIsNull(m_e) && qFuzzyCompare(m_g, 1.0f);
+    }
+
+    // Values outside [0, 1] are mirrored around zero, like in extended sRGB
+    float apply(float x) const;
+    float applyInverse(float y) const;
+
+    static QColorTransferFunction fromGamma(float gamma)
+    {
+        return QColorTransferFunction(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, gamma);
+    }
+    static QColorTransferFunction fromSRgb()
+    {
+        return QColorTransferFunction(1.0f / 1.055f, 0.055f / 1.055f, 1.0f / 12.92f, 0.04045f,
+                                      0.0f, 0.0f, 2.4f);
+    }
+    static QColorTransferFunction fromProPhotoRgb()
+    {
+        return QColorTransferFunction(1.0f, 0.0f, 1.0f / 16.0f, 16.0f / 512.0f, 0.0f, 0.0f, 1.8f);
+    }
+    static QColorTransferFunction fromBt2020()
+    {
+        return QColorTransferFunction(1.0f / 1.0993f, 0.0993f / 1.0993f, 1.0f / 4.5f, 0.081243f,
+                                      0.0f, 0.0f, 1.0f / 0.45f);
+    }
+
+    friend inline bool operator==(const QColorTransferFunction &f1, const QColorTransferFunction &f2)
+    {
+        return f1.m_a == f2.m_a && f1.m_b == f2.m_b && f1.m_c == f2.m_c && f1.m_d == f2.m_d
+            && f1.m_e == f2.m_e && f1.m_f == f2.m_f && f1.m_g == f2.m_g;
+    }
+    friend inline bool operator!=(const QColorTransferFunction &f1, const QColorTransferFunction &f2)
+    { return !(f1 == f2); }
+
+    float m_a;
+    float m_b;
+    float m_c;
+    float m_d;
+    float m_e;
+    float m_f;
+    float m_g;
+};
+
+class QColorVector
+{
+public:
+    QColorVector() : x(0), y(0), z(0) { }
+    QColorVector(float x, float y, float z) : x(x), y(y), z(z) { }
+
+    // From CIE xy chromaticity coordinates, with Y = 1
+    static QColorVector fromXY(QPointF xy)
+    {
+        return QColorVector(xy.x() / xy.y(), 1.0f, (1.0f - xy.x() - xy.y()) / xy.y());
+    }
+
+    float x;
+    float y;
+    float z;
+};
+
+// A 3x3 matrix given by its columns
+class Q_GUI_EXPORT QColorMatrix
+{
+public:
+    QColorMatrix() { }
+    QColorMatrix(const QColorVector &r, const QColorVector &g, const QColorVector &b)
+        : r(r), g(g), b(b)
+    { }
+
+    static QColorMatrix identity()
+    {
+        return QColorMatrix(QColorVector(1, 0, 0), QColorVector(0, 1, 0), QColorVector(0, 0, 1));
+    }
+
+    bool isIdentity() const;
+    QColorMatrix inverted() const;
+
+    QColorVector map(const QColorVector &c) const
+    {
+        return QColorVector(c.x * r.x + c.y * g.x + c.z * b.x,
+                            c.x * r.y + c.y * g.y + c.z * b.y,
+                            c.x * r.z + c.y * g.z + c.z * b.z);
+    }
+
+    friend inline QColorMatrix operator*(const QColorMatrix &m1, const QColorMatrix &m2)
+    {
+        return QColorMatrix(m1.map(m2.r), m1.map(m2.g), m1.map(m2.b));
+    }
+
+    // The matrix from linear RGB with the given primaries to CIE XYZ
+    static QColorMatrix fromPrimaries(QPointF red, QPointF green, QPointF blue, QPointF whitePoint);
+    // The Bradford transform adapting colors from one white point to another
+    static QColorMatrix chromaticAdaptation(QPointF fromWhitePoint, QPointF toWhitePoint);
+
+    QColorVector r;
+    QColorVector g;
+    QColorVector b;
+};
+
+// An RGB color space: a matrix to the D50 profile connection space of
+// ICC profiles, and the transfer function of the channels
+class Q_GUI_EXPORT QColorSpaceDefinition
+{
+public:
+    enum NamedColorSpace {
+        SRgb,
+        SRgbLinear,
+        AdobeRgb,
+        DisplayP3,
+        ProPhotoRgb,
+        Bt2020
+    };
+
+    QColorSpaceDefinition();
+    QColorSpaceDefinition(const QColorMatrix &toXyz, const QColorTransferFunction &transferFunction);
+
+    static QColorSpaceDefinition fromNamedColorSpace(NamedColorSpace colorSpace);
+    static QColorSpaceDefinition fromPrimaries(QPointF red, QPointF green, QPointF blue,
+                                               QPointF whitePoint,
+                                               const QColorTransferFunction &transferFunction);
+
+    QColorMatrix toXyz;
+    QColorTransferFunction transferFunction;
+};
+
+class Q_GUI_EXPORT QColorTransform
+{
+public:
+    QColorTransform();
+    QColorTransform(const QColorSpaceDefinition &source, const QColorSpaceDefinition &destination);
+
+    bool isIdentity() const;
+    QColorMatrix matrix() const { return m_matrix; }
+
+    void apply(QRgb *dst, const QRgb *src, int count, bool premultiplied = false) const;
+    void apply(QRgba64 *dst, const QRgba64 *src, int count, bool premultiplied = false) const;
+    // Unpremultiplied RGBA float quadruplets, values outside [0, 1] are kept
+    void apply(float *dst, const float *src, int count) const;
+
+    QImage apply(const QImage &image) const;
+
+private:
+    QColorTransferFunction m_sourceTransferFunction;
+    QColorTransferFunction m_destinationTransferFunction;
+    QColorMatrix m_matrix;
+    QSharedPointer<const QColorProfile> m_source;
+    QSharedPointer<const QColorProfile> m_destination;
+};
+
+Q_GUI_EXPORT QSharedPointer<const QColorProfile> qt_colorProfile(const QColorTransferFunction &transferFunction);
+
+Q_GUI_EXPORT QImage qt_scaleImageLinearLight(const QImage &image, const QSize &size,
+                                             const QColorTransferFunction &transferFunction = QColorTransferFunction::fromSRgb());
+
+QT_END_NAMESPACE
+
+#endif // QCOLORTRANSFORM_P_H
@@ -147,9 +147,19 @@ inline void drawPixel(QCosmeticStroker *stroker, int x, int y, int coverage)
     if (x < cl.x() || x > cl.right() || y < cl.y() || y > cl.bottom())
         return;
 
+    coverage = coverage*stroker->opacity >> 8;
+
     if (stroker->current_span > 0) {
-        const int lastx = stroker->spans[stroker->current_span-1].x + stroker->spans[stroker->current_span-1].len ;
-        const int lasty = stroker->spans[stroker->current_span-1].y;
+        QT_FT_Span &last = stroker->spans[stroker->current_span-1];
+        const int lastx = last.x + last.len;
+        const int lasty = last.y;
+
+        // merge with the previous span when the pixel continues it
+        if (stroker->mergeSpans && y == lasty && x == lastx && last.coverage == coverage
+            && last.len < 0xffff) {
+            ++last.len;
+            return;
+        }
 
         if (stroker->current_span == QCosmeticStroker::NSPANS || y < lasty || (y == lasty && x < lastx)) {
             stroker->blend(stroker->current_span, stroker->spans, &stroker->state->penData);
@@ -160,7 +170,7 @@ inline void drawPixel(QCosmeticStroker *stroker, int x, int y, int coverage)
     stroker->spans[stroker->current_span].x = ushort(x);
     stroker->spans[stroker->current_span].len = 1;
     stroker->spans[stroker->current_span].y = y;
-    stroker->spans[stroker->current_span].coverage = coverage*stroker->opacity >> 8;
+    stroker->spans[stroker->current_span].coverage = coverage;
     ++stroker->current_span;
 }
 
@@ -238,6 +248,10 @@ void QCosmeticStroker::setup()
         blend = state->penData.unclipped_blend;
     }
 
+    // Only merge pixels into longer spans where that blends exactly the same:
+    // blend_color_rgb16() uses a coarser alpha for all but single pixels.
+    mergeSpans = state->penData.rasterBuffer->format != QImage::Format_RGB16;
+
     int strokeSelection = 0;
     if (blend == state->penData.unclipped_blend
         && state->penData.type == QSpanData::Solid
@@ -363,10 +377,11 @@ bool QCosmeticStroker::clipLine(qreal &x1, qreal &y1, qreal &x2, qreal &y2)
 }
 
 
-void QCosmeticStroker::drawLine(const QPointF &p1, const QPointF &p2)
+void QCosmeticStroker::addLine(const QPointF &p1, const QPointF &p2)
 {
     if (p1 == p2) {
-        drawPoints(&p1, 1);
+        QPointF p = p1 * state->matrix;
+        drawPixel(this, qRound(p.x()), qRound(p.y()), 255);
         return;
     }
 
@@ -374,12 +389,39 @@ void QCosmeticStroker::drawLine(const QPointF &p1, const QPointF &p2)
     QPointF end = p2 * state->matrix;
 
     patternOffset = state->lastPen.dashOffset()*64;
+    // independent lines must not join with the previous one
     lastPixel.x = INT_MIN;
+    lastPixel.y = INT_MIN;
+    lastDir = LeftToRight;
+    lastAxisAligned = false;
 
     stroke(this, start.x(), start.y(), end.x(), end.y(), drawCaps ? CapBegin|CapEnd : 0);
+}
 
-    blend(current_span, spans, &state->penData);
-    current_span = 0;
+void QCosmeticStroker::drawLine(const QPointF &p1, const QPointF &p2)
+{
+    addLine(p1, p2);
+    flush();
+}
+
+/*
+    Draws \a lineCount independent lines. Unlike calling drawLine() for each
+    of them, the spans of consecutive lines are collected in the same buffer
+    and only blended when it is full or the next span is not below the
+    previous one.
+*/
+void QCosmeticStroker::drawLines(const QLine *lines, int lineCount)
+{
+    for (int i = 0; i < lineCount; ++i)
+        addLine(lines[i].p1(), lines[i].p2());
+    flush();
+}
+
+void QCosmeticStroker::drawLines(const QLineF *lines, int lineCount)
+{
+    for (int i = 0; i < lineCount; ++i)
+        addLine(lines[i].p1(), lines[i].p2());
+    flush();
 }
 
 void QCosmeticStroker::drawPoints(const QPoint *points, int num)
@@ -113,10 +113,19 @@ public:
     void setLegacyRoundingEnabled(bool legacyRoundingEnabled) { legacyRounding = legacyRoundingEnabled; }
 
     void drawLine(const QPointF &p1, const QPointF &p2);
+    void drawLines(const QLine *lines, int lineCount);
+    void drawLines(const QLineF *lines, int lineCount);
     void drawPath(const QVectorPath &path);
     void drawPoints(const QPoint *points, int num);
     void drawPoints(const QPointF *points, int num);
 
+    // addLine() leaves the spans in the buffer until flush() is called
+    void addLine(const QPointF &p1, const QPointF &p2);
+    inline void flush()
+    {
+        blend(current_span, spans, &state->penData);
+        current_span = 0;
+    }
 
     QRasterPaintEngineState *state;
     QRect deviceRect;
@@ -140,6 +149,7 @@ public:
     QT_FT_Span spans[NSPANS];
     int current_span;
     ProcessSpans blend;
+    bool mergeSpans;
 
     int opacity;
 
@@ -3945,6 +3945,8 @@ void handleSpans(int count, const QSpan *spans, const QSpanData *data, T &handle
     uint const_alpha = 256;
     if (data->type == QSpanData::Texture)
         const_alpha = data->texture.const_alpha;
+    else if (data->type >= QSpanData::LinearGradient && data->type <= QSpanData::ConicalGradient)
+        const_alpha = data->gradient.const_alpha;
 
     int coverage = 0;
     while (count) {
@@ -5450,7 +5452,7 @@ static void qt_gradient_argb32(int count, const QSpan *spans, void *userData)
             quint32 color =
                 qt_gradient_pixel_fixed(&data->gradient, yinc * y + off);
 
-            funcSolid(dst, spans->len, color, spans->coverage);
+            funcSolid(dst, spans->len, color, (spans->coverage * data->gradient.const_alpha) >> 8);
             ++spans;
         }
 
@@ -5495,7 +5497,8 @@ static void qt_gradient_quint16(int count, const QSpan *spans, void *userData)
         while (count--) {
             int y = spans->y;
 
-            data->solid.color = QRgba64::fromArgb32(qt_gradient_pixel_fixed(&gradient, yinc * y + off));
+            data->solid.color = multiplyAlpha256(QRgba64::fromArgb32(qt_gradient_pixel_fixed(&gradient, yinc * y + off)),
+                                                 gradient.const_alpha);
             blend_color_rgb16(1, spans, userData);
             ++spans;
         }
@@ -6460,6 +6463,26 @@ static void qInitDrawhelperFunctions()
         qt_functionForModeSolid_C[QPainter::CompositionMode_SourceOver] = comp_func_solid_SourceOver_avx2;
         qt_functionForMode_C[QPainter::CompositionMode_Source] = comp_func_Source_avx2;
 
+        extern void QT_FASTCALL comp_func_Plus_avx2(uint *destPixels, const uint *srcPixels, int length, uint const_alpha);
+        extern void QT_FASTCALL comp_func_solid_Plus_avx2(uint *destPixels, int length, uint color, uint const_alpha);
+        extern void QT_FASTCALL comp_func_Multiply_avx2(uint *destPixels, const uint *srcPixels, int length, uint const_alpha);
+        extern void QT_FASTCALL comp_func_solid_Multiply_avx2(uint *destPixels, int length, uint color, uint const_alpha);
+        qt_functionForMode_C[QPainter::CompositionMode_Plus] = comp_func_Plus_avx2;
+        qt_functionForModeSolid_C[QPainter::CompositionMode_Plus] = comp_func_solid_Plus_avx2;
+        qt_functionForMode_C[QPainter::CompositionMode_Multiply] = comp_func_Multiply_avx2;
+        qt_functionForModeSolid_C[QPainter::CompositionMode_Multiply] = comp_func_solid_Multiply_avx2;
+
+        extern void QT_FASTCALL comp_func_SourceOver_rgb64_avx2(QRgba64 *destPixels, const QRgba64 *srcPixels, int length, uint const_alpha);
+        extern void QT_FASTCALL comp_func_solid_SourceOver_rgb64_avx2(QRgba64 *destPixels, int length, QRgba64 color, uint const_alpha);
+        extern void QT_FASTCALL comp_func_Source_rgb64_avx2(QRgba64 *destPixels, const QRgba64 *srcPixels, int length, uint const_alpha);
+        extern void QT_FASTCALL comp_func_Plus_rgb64_avx2(QRgba64 *destPixels, const QRgba64 *srcPixels, int length, uint const_alpha);
+        extern void QT_FASTCALL comp_func_solid_Plus_rgb64_avx2(QRgba64 *destPixels, int length, QRgba64 color, uint const_alpha);
+        qt_functionForMode64_C[QPainter::CompositionMode_SourceOver] = comp_func_SourceOver_rgb64_avx2;
+        qt_functionForModeSolid64_C[QPainter::CompositionMode_SourceOver] = comp_func_solid_SourceOver_rgb64_avx2;
+        qt_functionForMode64_C[QPainter::CompositionMode_Source] = comp_func_Source_rgb64_avx2;
+        qt_functionForMode64_C[QPainter::CompositionMode_Plus] = comp_func_Plus_rgb64_avx2;
+        qt_functionForModeSolid64_C[QPainter::CompositionMode_Plus] = comp_func_solid_Plus_rgb64_avx2;
+
         extern void QT_FASTCALL fetchTransformedBilinearARGB32PM_simple_upscale_helper_avx2(uint *b, uint *end, const QTextureData &image,
                                                                                             int &fx, int &fy, int fdx, int /*fdy*/);
         extern void QT_FASTCALL fetchTransformedBilinearARGB32PM_downscale_helper_avx2(uint *b, uint *end, const QTextureData &image,
@@ -6473,6 +6496,26 @@ static void qInitDrawhelperFunctions()
     }
 #endif
 
+#if defined(QT_COMPILER_SUPPORTS_AVX512F) && defined(QT_COMPILER_SUPPORTS_AVX512BW)
+    if (qCpuHasFeature(AVX512F) && qCpuHasFeature(AVX512CD) && qCpuHasFeature(AVX512BW)
+            && qCpuHasFeature(AVX512DQ) && qCpuHasFeature(AVX512VL)) {
+        extern void QT_FASTCALL comp_func_SourceOver_avx512(uint *destPixels, const uint *srcPixels, int length, uint const_alpha);
+        extern void QT_FASTCALL comp_func_solid_SourceOver_avx512(uint *destPixels, int length, uint color, uint const_alpha);
+        extern void QT_FASTCALL comp_func_Source_avx512(uint *destPixels, const uint *srcPixels, int length, uint const_alpha);
+        extern void QT_FASTCALL comp_func_Plus_avx512(uint *destPixels, const uint *srcPixels, int length, uint const_alpha);
+        extern void QT_FASTCALL comp_func_solid_Plus_avx512(uint *destPixels, int length, uint color, uint const_alpha);
+        extern void QT_FASTCALL comp_func_Multiply_avx512(uint *destPixels, const uint *srcPixels, int length, uint const_alpha);
+        extern void QT_FASTCALL comp_func_solid_Multiply_avx512(uint *destPixels, int length, uint color, uint const_alpha);
+        qt_functionForMode_C[QPainter::CompositionMode_SourceOver] = comp_func_SourceOver_avx512;
+        qt_functionForModeSolid_C[QPainter::CompositionMode_SourceOver] = comp_func_solid_SourceOver_avx512;
+        qt_functionForMode_C[QPainter::CompositionMode_Source] = comp_func_Source_avx512;
+        qt_functionForMode_C[QPainter::CompositionMode_Plus] = comp_func_Plus_avx512;
+        qt_functionForModeSolid_C[QPainter::CompositionMode_Plus] = comp_func_solid_Plus_avx512;
+        qt_functionForMode_C[QPainter::CompositionMode_Multiply] = comp_func_Multiply_avx512;
+        qt_functionForModeSolid_C[QPainter::CompositionMode_Multiply] = comp_func_solid_Multiply_avx512;
+    }
+#endif
+
 #endif // SSE2
 
 #if defined(__ARM_NEON__)
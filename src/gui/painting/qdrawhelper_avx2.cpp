@@ -39,6 +39,7 @@
 
 #include "qdrawhelper_p.h"
 #include "qdrawingprimitive_sse2_p.h"
+#include "qrgba64_p.h"
 
 #if defined(QT_COMPILER_SUPPORTS_AVX2)
 
@@ -275,7 +276,7 @@ void qt_blend_rgb32_on_rgb32_avx2(uchar *destPixels, int dbpl,
     }
 }
 
-void QT_FASTCALL comp_func_SourceOver_avx2(uint *destPixels, const uint *srcPixels, int length, uint const_alpha)
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_SourceOver_avx2(uint *destPixels, const uint *srcPixels, int length, uint const_alpha)
 {
     Q_ASSERT(const_alpha < 256);
 
@@ -288,7 +289,7 @@ void QT_FASTCALL comp_func_SourceOver_avx2(uint *destPixels, const uint *srcPixe
         BLEND_SOURCE_OVER_ARGB32_WITH_CONST_ALPHA_AVX2(dst, src, length, const_alpha);
 }
 
-void QT_FASTCALL comp_func_Source_avx2(uint *dst, const uint *src, int length, uint const_alpha)
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_Source_avx2(uint *dst, const uint *src, int length, uint const_alpha)
 {
     if (const_alpha == 255) {
         ::memcpy(dst, src, length * sizeof(uint));
@@ -319,7 +320,7 @@ void QT_FASTCALL comp_func_Source_avx2(uint *dst, const uint *src, int length, u
     }
 }
 
-void QT_FASTCALL comp_func_solid_SourceOver_avx2(uint *destPixels, int length, uint color, uint const_alpha)
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_solid_SourceOver_avx2(uint *destPixels, int length, uint color, uint const_alpha)
 {
     if ((const_alpha & qAlpha(color)) == 255) {
         qt_memfill32(destPixels, color, length);
@@ -350,6 +351,352 @@ void QT_FASTCALL comp_func_solid_SourceOver_avx2(uint *destPixels, int length, u
     }
 }
 
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_Plus_avx2(uint *dst, const uint *src, int length, uint const_alpha)
+{
+    int x = 0;
+
+    if (const_alpha == 255) {
+        // 1) Prologue: align destination on 32 bytes
+        ALIGNMENT_PROLOGUE_32BYTES(dst, x, length)
+            dst[x] = comp_func_Plus_one_pixel(dst[x], src[x]);
+
+        // 2) composition with AVX2
+        for (; x < length - 7; x += 8) {
+            const __m256i srcVector = _mm256_lddqu_si256((const __m256i *)&src[x]);
+            const __m256i dstVector = _mm256_load_si256((const __m256i *)&dst[x]);
+
+            const __m256i result = _mm256_adds_epu8(srcVector, dstVector);
+            _mm256_store_si256((__m256i *)&dst[x], result);
+        }
+
+        // 3) Epilogue:
+        SIMD_EPILOGUE(x, length, 7)
+            dst[x] = comp_func_Plus_one_pixel(dst[x], src[x]);
+    } else {
+        const int one_minus_const_alpha = 255 - const_alpha;
+
+        // 1) Prologue: align destination on 32 bytes
+        ALIGNMENT_PROLOGUE_32BYTES(dst, x, length)
+            dst[x] = comp_func_Plus_one_pixel_const_alpha(dst[x], src[x], const_alpha, one_minus_const_alpha);
+
+        const __m256i half = _mm256_set1_epi16(0x80);
+        const __m256i colorMask = _mm256_set1_epi32(0x00ff00ff);
+        const __m256i constAlphaVector = _mm256_set1_epi16(const_alpha);
+        const __m256i oneMinusConstAlpha = _mm256_set1_epi16(one_minus_const_alpha);
+        // 2) composition with AVX2
+        for (; x < length - 7; x += 8) {
+            const __m256i srcVector = _mm256_lddqu_si256((const __m256i *)&src[x]);
+            __m256i dstVector = _mm256_load_si256((const __m256i *)&dst[x]);
+
+            const __m256i result = _mm256_adds_epu8(srcVector, dstVector);
+            INTERPOLATE_PIXEL_255_AVX2(result, dstVector, constAlphaVector, oneMinusConstAlpha, colorMask, half);
+            _mm256_store_si256((__m256i *)&dst[x], dstVector);
+        }
+
+        // 3) Epilogue:
+        SIMD_EPILOGUE(x, length, 7)
+            dst[x] = comp_func_Plus_one_pixel_const_alpha(dst[x], src[x], const_alpha, one_minus_const_alpha);
+    }
+}
+
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_solid_Plus_avx2(uint *dst, int length, uint color, uint const_alpha)
+{
+    int x = 0;
+
+    const __m256i colorVector = _mm256_set1_epi32(color);
+    if (const_alpha == 255) {
+        ALIGNMENT_PROLOGUE_32BYTES(dst, x, length)
+            dst[x] = comp_func_Plus_one_pixel(dst[x], color);
+
+        for (; x < length - 7; x += 8) {
+            const __m256i dstVector = _mm256_load_si256((const __m256i *)&dst[x]);
+            _mm256_store_si256((__m256i *)&dst[x], _mm256_adds_epu8(colorVector, dstVector));
+        }
+
+        SIMD_EPILOGUE(x, length, 7)
+            dst[x] = comp_func_Plus_one_pixel(dst[x], color);
+    } else {
+        const int one_minus_const_alpha = 255 - const_alpha;
+
+        ALIGNMENT_PROLOGUE_32BYTES(dst, x, length)
+            dst[x] = comp_func_Plus_one_pixel_const_alpha(dst[x], color, const_alpha, one_minus_const_alpha);
+
+        const __m256i half = _mm256_set1_epi16(0x80);
+        const __m256i colorMask = _mm256_set1_epi32(0x00ff00ff);
+        const __m256i constAlphaVector = _mm256_set1_epi16(const_alpha);
+        const __m256i oneMinusConstAlpha = _mm256_set1_epi16(one_minus_const_alpha);
+        for (; x < length - 7; x += 8) {
+            __m256i dstVector = _mm256_load_si256((const __m256i *)&dst[x]);
+            const __m256i result = _mm256_adds_epu8(colorVector, dstVector);
+            INTERPOLATE_PIXEL_255_AVX2(result, dstVector, constAlphaVector, oneMinusConstAlpha, colorMask, half);
+            _mm256_store_si256((__m256i *)&dst[x], dstVector);
+        }
+
+        SIMD_EPILOGUE(x, length, 7)
+            dst[x] = comp_func_Plus_one_pixel_const_alpha(dst[x], color, const_alpha, one_minus_const_alpha);
+    }
+}
+
+// Multiply on pixels unpacked to 16 bits per channel, see multiply_op and mix_alpha in
+// qcompositionfunctions.cpp. The intermediate sum fits in 16 bits for premultiplied input.
+inline static __m256i MULTIPLY_16_AVX2(const __m256i &src, const __m256i &dst, const __m256i &one, const __m256i &half)
+{
+    const __m256i srcAlpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m256i dstAlpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(dst, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m256i oneMinusSrcAlpha = _mm256_sub_epi16(one, srcAlpha);
+    const __m256i oneMinusDstAlpha = _mm256_sub_epi16(one, dstAlpha);
+
+    __m256i color = _mm256_mullo_epi16(src, dst);
+    color = _mm256_add_epi16(color, _mm256_mullo_epi16(src, oneMinusDstAlpha));
+    color = _mm256_add_epi16(color, _mm256_mullo_epi16(dst, oneMinusSrcAlpha));
+    color = _mm256_add_epi16(color, _mm256_srli_epi16(color, 8));
+    color = _mm256_srli_epi16(_mm256_add_epi16(color, half), 8);
+
+    __m256i alpha = _mm256_mullo_epi16(oneMinusSrcAlpha, oneMinusDstAlpha);
+    alpha = _mm256_sub_epi16(one, _mm256_srli_epi16(alpha, 8));
+
+    return _mm256_blend_epi16(color, alpha, 0x88);
+}
+
+inline static __m256i MULTIPLY_AVX2(const __m256i &srcVector, const __m256i &dstVector, const __m256i &one, const __m256i &half)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i lo = MULTIPLY_16_AVX2(_mm256_unpacklo_epi8(srcVector, zero), _mm256_unpacklo_epi8(dstVector, zero), one, half);
+    const __m256i hi = MULTIPLY_16_AVX2(_mm256_unpackhi_epi8(srcVector, zero), _mm256_unpackhi_epi8(dstVector, zero), one, half);
+    return _mm256_packus_epi16(lo, hi);
+}
+
+static inline uint comp_func_Multiply_one_pixel(uint d, uint s)
+{
+    const int da = qAlpha(d);
+    const int sa = qAlpha(s);
+#define OP(a, b) qt_div_255(a * b + a * (255 - da) + b * (255 - sa))
+    const int r = OP(qRed(s), qRed(d));
+    const int g = OP(qGreen(s), qGreen(d));
+    const int b = OP(qBlue(s), qBlue(d));
+#undef OP
+    const int a = 255 - ((255 - sa) * (255 - da) >> 8);
+    return qRgba(r, g, b, a);
+}
+
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_Multiply_avx2(uint *dst, const uint *src, int length, uint const_alpha)
+{
+    const int one_minus_const_alpha = 255 - const_alpha;
+    int x = 0;
+
+    ALIGNMENT_PROLOGUE_32BYTES(dst, x, length)
+        dst[x] = INTERPOLATE_PIXEL_255(comp_func_Multiply_one_pixel(dst[x], src[x]), const_alpha, dst[x], one_minus_const_alpha);
+
+    const __m256i one = _mm256_set1_epi16(0xff);
+    const __m256i half = _mm256_set1_epi16(0x80);
+    const __m256i colorMask = _mm256_set1_epi32(0x00ff00ff);
+    const __m256i constAlphaVector = _mm256_set1_epi16(const_alpha);
+    const __m256i oneMinusConstAlpha = _mm256_set1_epi16(one_minus_const_alpha);
+    for (; x < length - 7; x += 8) {
+        const __m256i srcVector = _mm256_lddqu_si256((const __m256i *)&src[x]);
+        __m256i dstVector = _mm256_load_si256((const __m256i *)&dst[x]);
+        const __m256i result = MULTIPLY_AVX2(srcVector, dstVector, one, half);
+        if (const_alpha == 255)
+            dstVector = result;
+        else
+            INTERPOLATE_PIXEL_255_AVX2(result, dstVector, constAlphaVector, oneMinusConstAlpha, colorMask, half);
+        _mm256_store_si256((__m256i *)&dst[x], dstVector);
+    }
+
+    SIMD_EPILOGUE(x, length, 7)
+        dst[x] = INTERPOLATE_PIXEL_255(comp_func_Multiply_one_pixel(dst[x], src[x]), const_alpha, dst[x], one_minus_const_alpha);
+}
+
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_solid_Multiply_avx2(uint *dst, int length, uint color, uint const_alpha)
+{
+    const int one_minus_const_alpha = 255 - const_alpha;
+    int x = 0;
+
+    ALIGNMENT_PROLOGUE_32BYTES(dst, x, length)
+        dst[x] = INTERPOLATE_PIXEL_255(comp_func_Multiply_one_pixel(dst[x], color), const_alpha, dst[x], one_minus_const_alpha);
+
+    const __m256i one = _mm256_set1_epi16(0xff);
+    const __m256i half = _mm256_set1_epi16(0x80);
+    const __m256i colorMask = _mm256_set1_epi32(0x00ff00ff);
+    const __m256i colorVector = _mm256_set1_epi32(color);
+    const __m256i constAlphaVector = _mm256_set1_epi16(const_alpha);
+    const __m256i oneMinusConstAlpha = _mm256_set1_epi16(one_minus_const_alpha);
+    for (; x < length - 7; x += 8) {
+        __m256i dstVector = _mm256_load_si256((const __m256i *)&dst[x]);
+        const __m256i result = MULTIPLY_AVX2(colorVector, dstVector, one, half);
+        if (const_alpha == 255)
+            dstVector = result;
+        else
+            INTERPOLATE_PIXEL_255_AVX2(result, dstVector, constAlphaVector, oneMinusConstAlpha, colorMask, half);
+        _mm256_store_si256((__m256i *)&dst[x], dstVector);
+    }
+
+    SIMD_EPILOGUE(x, length, 7)
+        dst[x] = INTERPOLATE_PIXEL_255(comp_func_Multiply_one_pixel(dst[x], color), const_alpha, dst[x], one_minus_const_alpha);
+}
+
+// The 64-bit functions below process four QRgba64 pixels per vector and handle the
+// remaining pixels of a span with masked loads and stores.
+
+// See multiplyAlpha65535 in qrgba64_p.h for details.
+inline static __m256i MULTIPLY_ALPHA_RGBA64_AVX2(const __m256i &rgba64, const __m256i &alpha)
+{
+    const __m256i half = _mm256_set1_epi32(0x8000);
+    const __m256i productLo = _mm256_mullo_epi16(rgba64, alpha);
+    const __m256i productHi = _mm256_mulhi_epu16(rgba64, alpha);
+    __m256i lo = _mm256_unpacklo_epi16(productLo, productHi);
+    __m256i hi = _mm256_unpackhi_epi16(productLo, productHi);
+    lo = _mm256_add_epi32(lo, _mm256_srli_epi32(lo, 16));
+    hi = _mm256_add_epi32(hi, _mm256_srli_epi32(hi, 16));
+    lo = _mm256_srai_epi32(_mm256_add_epi32(lo, half), 16);
+    hi = _mm256_srai_epi32(_mm256_add_epi32(hi, half), 16);
+    return _mm256_packs_epi32(lo, hi);
+}
+
+inline static __m256i ALPHA_RGBA64_AVX2(const __m256i &rgba64)
+{
+    return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(rgba64, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+inline static __m256i TAIL_MASK_RGBA64_AVX2(int remaining)
+{
+    return _mm256_cmpgt_epi64(_mm256_set1_epi64x(remaining), _mm256_setr_epi64x(0, 1, 2, 3));
+}
+
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_SourceOver_rgb64_avx2(QRgba64 *dst, const QRgba64 *src, int length, uint const_alpha)
+{
+    Q_ASSERT(const_alpha < 256);
+    const __m256i alphaMask = _mm256_set1_epi64x(qint64(Q_UINT64_C(0xffff000000000000)));
+    const __m256i one = _mm256_set1_epi16(-1);
+    const __m256i constAlphaVector = _mm256_set1_epi16(const_alpha * 257);
+
+    int x = 0;
+    for (; x < length; x += 4) {
+        const bool tail = length - x < 4;
+        const __m256i tailMask = tail ? TAIL_MASK_RGBA64_AVX2(length - x) : one;
+        __m256i srcVector = tail ? _mm256_maskload_epi64((const long long *)&src[x], tailMask)
+                                 : _mm256_loadu_si256((const __m256i *)&src[x]);
+        if (const_alpha == 255) {
+            if (_mm256_testz_si256(srcVector, alphaMask))
+                continue;
+            if (!tail && _mm256_testc_si256(srcVector, alphaMask)) {
+                _mm256_storeu_si256((__m256i *)&dst[x], srcVector);
+                continue;
+            }
+        } else {
+            srcVector = MULTIPLY_ALPHA_RGBA64_AVX2(srcVector, constAlphaVector);
+        }
+        __m256i dstVector = tail ? _mm256_maskload_epi64((const long long *)&dst[x], tailMask)
+                                 : _mm256_loadu_si256((const __m256i *)&dst[x]);
+        const __m256i oneMinusAlpha = _mm256_sub_epi32(one, ALPHA_RGBA64_AVX2(srcVector));
+        dstVector = _mm256_add_epi32(srcVector, MULTIPLY_ALPHA_RGBA64_AVX2(dstVector, oneMinusAlpha));
+        if (tail)
+            _mm256_maskstore_epi64((long long *)&dst[x], tailMask, dstVector);
+        else
+            _mm256_storeu_si256((__m256i *)&dst[x], dstVector);
+    }
+}
+
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_solid_SourceOver_rgb64_avx2(QRgba64 *dst, int length, QRgba64 color, uint const_alpha)
+{
+    if (const_alpha == 255 && color.isOpaque()) {
+        qt_memfill64((quint64 *)dst, color, length);
+        return;
+    }
+
+    __m128i c = _mm_loadl_epi64((const __m128i *)&color);
+    if (const_alpha != 255)
+        c = multiplyAlpha255(c, const_alpha);
+    const __m256i colorVector = _mm256_broadcastq_epi64(c);
+    const __m256i oneMinusAlpha = _mm256_sub_epi32(_mm256_set1_epi16(-1), ALPHA_RGBA64_AVX2(colorVector));
+
+    int x = 0;
+    for (; x < length - 3; x += 4) {
+        const __m256i dstVector = _mm256_loadu_si256((const __m256i *)&dst[x]);
+        _mm256_storeu_si256((__m256i *)&dst[x], _mm256_add_epi32(colorVector, MULTIPLY_ALPHA_RGBA64_AVX2(dstVector, oneMinusAlpha)));
+    }
+    if (x < length) {
+        const __m256i tailMask = TAIL_MASK_RGBA64_AVX2(length - x);
+        const __m256i dstVector = _mm256_maskload_epi64((const long long *)&dst[x], tailMask);
+        _mm256_maskstore_epi64((long long *)&dst[x], tailMask, _mm256_add_epi32(colorVector, MULTIPLY_ALPHA_RGBA64_AVX2(dstVector, oneMinusAlpha)));
+    }
+}
+
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_Source_rgb64_avx2(QRgba64 *dst, const QRgba64 *src, int length, uint const_alpha)
+{
+    if (const_alpha == 255) {
+        ::memcpy(dst, src, length * sizeof(quint64));
+        return;
+    }
+
+    const __m256i constAlphaVector = _mm256_set1_epi16(const_alpha * 257);
+    const __m256i oneMinusConstAlpha = _mm256_set1_epi16((255 - const_alpha) * 257);
+
+    int x = 0;
+    for (; x < length - 3; x += 4) {
+        const __m256i srcVector = _mm256_loadu_si256((const __m256i *)&src[x]);
+        const __m256i dstVector = _mm256_loadu_si256((const __m256i *)&dst[x]);
+        const __m256i result = _mm256_add_epi32(MULTIPLY_ALPHA_RGBA64_AVX2(srcVector, constAlphaVector),
+                                                MULTIPLY_ALPHA_RGBA64_AVX2(dstVector, oneMinusConstAlpha));
+        _mm256_storeu_si256((__m256i *)&dst[x], result);
+    }
+    if (x < length) {
+        const __m256i tailMask = TAIL_MASK_RGBA64_AVX2(length - x);
+        const __m256i srcVector = _mm256_maskload_epi64((const long long *)&src[x], tailMask);
+        const __m256i dstVector = _mm256_maskload_epi64((const long long *)&dst[x], tailMask);
+        const __m256i result = _mm256_add_epi32(MULTIPLY_ALPHA_RGBA64_AVX2(srcVector, constAlphaVector),
+                                                MULTIPLY_ALPHA_RGBA64_AVX2(dstVector, oneMinusConstAlpha));
+        _mm256_maskstore_epi64((long long *)&dst[x], tailMask, result);
+    }
+}
+
+inline static __m256i PLUS_RGBA64_AVX2(const __m256i &srcVector, const __m256i &dstVector,
+                                       const __m256i &constAlphaVector, const __m256i &oneMinusConstAlpha, uint const_alpha)
+{
+    const __m256i result = _mm256_adds_epu16(srcVector, dstVector);
+    if (const_alpha == 255)
+        return result;
+    return _mm256_add_epi32(MULTIPLY_ALPHA_RGBA64_AVX2(result, constAlphaVector),
+                            MULTIPLY_ALPHA_RGBA64_AVX2(dstVector, oneMinusConstAlpha));
+}
+
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_Plus_rgb64_avx2(QRgba64 *dst, const QRgba64 *src, int length, uint const_alpha)
+{
+    const __m256i constAlphaVector = _mm256_set1_epi16(const_alpha * 257);
+    const __m256i oneMinusConstAlpha = _mm256_set1_epi16((255 - const_alpha) * 257);
+
+    int x = 0;
+    for (; x < length - 3; x += 4) {
+        const __m256i srcVector = _mm256_loadu_si256((const __m256i *)&src[x]);
+        const __m256i dstVector = _mm256_loadu_si256((const __m256i *)&dst[x]);
+        _mm256_storeu_si256((__m256i *)&dst[x], PLUS_RGBA64_AVX2(srcVector, dstVector, constAlphaVector, oneMinusConstAlpha, const_alpha));
+    }
+    if (x < length) {
+        const __m256i tailMask = TAIL_MASK_RGBA64_AVX2(length - x);
+        const __m256i srcVector = _mm256_maskload_epi64((const long long *)&src[x], tailMask);
+        const __m256i dstVector = _mm256_maskload_epi64((const long long *)&dst[x], tailMask);
+        _mm256_maskstore_epi64((long long *)&dst[x], tailMask, PLUS_RGBA64_AVX2(srcVector, dstVector, constAlphaVector, oneMinusConstAlpha, const_alpha));
+    }
+}
+
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_solid_Plus_rgb64_avx2(QRgba64 *dst, int length, QRgba64 color, uint const_alpha)
+{
+    const __m256i colorVector = _mm256_set1_epi64x(qint64(quint64(color)));
+    const __m256i constAlphaVector = _mm256_set1_epi16(const_alpha * 257);
+    const __m256i oneMinusConstAlpha = _mm256_set1_epi16((255 - const_alpha) * 257);
+
+    int x = 0;
+    for (; x < length - 3; x += 4) {
+        const __m256i dstVector = _mm256_loadu_si256((const __m256i *)&dst[x]);
+        _mm256_storeu_si256((__m256i *)&dst[x], PLUS_RGBA64_AVX2(colorVector, dstVector, constAlphaVector, oneMinusConstAlpha, const_alpha));
+    }
+    if (x < length) {
+        const __m256i tailMask = TAIL_MASK_RGBA64_AVX2(length - x);
+        const __m256i dstVector = _mm256_maskload_epi64((const long long *)&dst[x], tailMask);
+        _mm256_maskstore_epi64((long long *)&dst[x], tailMask, PLUS_RGBA64_AVX2(colorVector, dstVector, constAlphaVector, oneMinusConstAlpha, const_alpha));
+    }
+}
+
 #define interpolate_4_pixels_16_avx2(tlr1, tlr2, blr1, blr2, distx, disty, colorMask, v_256, b)  \
 { \
     /* Correct for later unpack */ \
@@ -0,0 +1,299 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtGui module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qdrawhelper_p.h"
+
+#if defined(QT_COMPILER_SUPPORTS_AVX512F) && defined(QT_COMPILER_SUPPORTS_AVX512BW)
+
+QT_BEGIN_NAMESPACE
+
+// The functions in this file are the AVX-512 counterparts of the ARGB32 premultiplied
+// composition functions in qdrawhelper_avx2.cpp. They produce the same results as the
+// generic implementations in qcompositionfunctions.cpp, sixteen pixels at a time, and
+// use masked loads and stores for the pixels left over at the end of a span.
+
+// The unmasked forms of some AVX-512F intrinsics pass an undefined vector as the merge
+// source, which GCC reports as -Wmaybe-uninitialized once they are inlined. Use the
+// zero-masking forms with every lane selected instead; they compute the same result.
+static const __mmask16 allLanes = 0xffff;
+
+// See BYTE_MUL_SSE2 for details.
+inline static __m512i BYTE_MUL_AVX512(const __m512i &pixelVector, const __m512i &alphaChannel, const __m512i &colorMask, const __m512i &half)
+{
+    __m512i pixelVectorAG = _mm512_srli_epi16(pixelVector, 8);
+    __m512i pixelVectorRB = _mm512_and_si512(pixelVector, colorMask);
+
+    pixelVectorAG = _mm512_mullo_epi16(pixelVectorAG, alphaChannel);
+    pixelVectorRB = _mm512_mullo_epi16(pixelVectorRB, alphaChannel);
+
+    pixelVectorRB = _mm512_add_epi16(pixelVectorRB, _mm512_srli_epi16(pixelVectorRB, 8));
+    pixelVectorAG = _mm512_add_epi16(pixelVectorAG, _mm512_srli_epi16(pixelVectorAG, 8));
+    pixelVectorRB = _mm512_add_epi16(pixelVectorRB, half);
+    pixelVectorAG = _mm512_add_epi16(pixelVectorAG, half);
+
+    pixelVectorRB = _mm512_srli_epi16(pixelVectorRB, 8);
+    pixelVectorAG = _mm512_maskz_andnot_epi32(allLanes, colorMask, pixelVectorAG);
+
+    return _mm512_or_si512(pixelVectorAG, pixelVectorRB);
+}
+
+// See INTERPOLATE_PIXEL_255_SSE2 for details.
+inline static __m512i INTERPOLATE_PIXEL_255_AVX512(const __m512i &srcVector, const __m512i &dstVector, const __m512i &alphaChannel, const __m512i &oneMinusAlphaChannel, const __m512i &colorMask, const __m512i &half)
+{
+    const __m512i srcVectorAG = _mm512_srli_epi16(srcVector, 8);
+    const __m512i dstVectorAG = _mm512_srli_epi16(dstVector, 8);
+    const __m512i srcVectorRB = _mm512_and_si512(srcVector, colorMask);
+    const __m512i dstVectorRB = _mm512_and_si512(dstVector, colorMask);
+    __m512i finalAG = _mm512_add_epi16(_mm512_mullo_epi16(srcVectorAG, alphaChannel),
+                                       _mm512_mullo_epi16(dstVectorAG, oneMinusAlphaChannel));
+    __m512i finalRB = _mm512_add_epi16(_mm512_mullo_epi16(srcVectorRB, alphaChannel),
+                                       _mm512_mullo_epi16(dstVectorRB, oneMinusAlphaChannel));
+    finalAG = _mm512_add_epi16(finalAG, _mm512_srli_epi16(finalAG, 8));
+    finalRB = _mm512_add_epi16(finalRB, _mm512_srli_epi16(finalRB, 8));
+    finalAG = _mm512_add_epi16(finalAG, half);
+    finalRB = _mm512_add_epi16(finalRB, half);
+    finalAG = _mm512_maskz_andnot_epi32(allLanes, colorMask, finalAG);
+    finalRB = _mm512_srli_epi16(finalRB, 8);
+
+    return _mm512_or_si512(finalAG, finalRB);
+}
+
+// Returns the alpha of each pixel in both 16-bit halves of its 32-bit lane.
+inline static __m512i ALPHA_AVX512(const __m512i &pixelVector)
+{
+    const __m512i alpha = _mm512_maskz_srli_epi32(allLanes, pixelVector, 24);
+    return _mm512_or_si512(alpha, _mm512_maskz_slli_epi32(allLanes, alpha, 16));
+}
+
+// See MULTIPLY_16_AVX2 for details.
+inline static __m512i MULTIPLY_16_AVX512(const __m512i &src, const __m512i &dst, const __m512i &one, const __m512i &half)
+{
+    const __m512i srcAlpha = _mm512_shufflehi_epi16(_mm512_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m512i dstAlpha = _mm512_shufflehi_epi16(_mm512_shufflelo_epi16(dst, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m512i oneMinusSrcAlpha = _mm512_sub_epi16(one, srcAlpha);
+    const __m512i oneMinusDstAlpha = _mm512_sub_epi16(one, dstAlpha);
+
+    __m512i color = _mm512_mullo_epi16(src, dst);
+    color = _mm512_add_epi16(color, _mm512_mullo_epi16(src, oneMinusDstAlpha));
+    color = _mm512_add_epi16(color, _mm512_mullo_epi16(dst, oneMinusSrcAlpha));
+    color = _mm512_add_epi16(color, _mm512_srli_epi16(color, 8));
+    color = _mm512_srli_epi16(_mm512_add_epi16(color, half), 8);
+
+    __m512i alpha = _mm512_mullo_epi16(oneMinusSrcAlpha, oneMinusDstAlpha);
+    alpha = _mm512_sub_epi16(one, _mm512_srli_epi16(alpha, 8));
+
+    return _mm512_mask_blend_epi16(__mmask32(0x88888888), color, alpha);
+}
+
+inline static __mmask16 TAIL_MASK_AVX512(int remaining)
+{
+    return __mmask16((1u << remaining) - 1);
+}
+
+struct QBlendConstantsAVX512
+{
+    QBlendConstantsAVX512(uint const_alpha)
+        : one(_mm512_set1_epi16(0xff))
+        , half(_mm512_set1_epi16(0x80))
+        , colorMask(_mm512_set1_epi32(0x00ff00ff))
+        , constAlpha(_mm512_set1_epi16(const_alpha))
+        , oneMinusConstAlpha(_mm512_set1_epi16(255 - const_alpha))
+        , fullCoverage(const_alpha == 255)
+    {
+    }
+
+    inline __m512i applyCoverage(const __m512i &result, const __m512i &dstVector) const
+    {
+        if (fullCoverage)
+            return result;
+        return INTERPOLATE_PIXEL_255_AVX512(result, dstVector, constAlpha, oneMinusConstAlpha, colorMask, half);
+    }
+
+    const __m512i one;
+    const __m512i half;
+    const __m512i colorMask;
+    const __m512i constAlpha;
+    const __m512i oneMinusConstAlpha;
+    const bool fullCoverage;
+};
+
+struct QSourceOpAVX512 : QBlendConstantsAVX512
+{
+    QSourceOpAVX512(uint const_alpha) : QBlendConstantsAVX512(const_alpha) {}
+    inline __m512i operator()(const __m512i &srcVector, const __m512i &dstVector) const
+    {
+        return applyCoverage(srcVector, dstVector);
+    }
+};
+
+struct QSourceOverOpAVX512 : QBlendConstantsAVX512
+{
+    QSourceOverOpAVX512(uint const_alpha) : QBlendConstantsAVX512(const_alpha) {}
+    inline __m512i operator()(__m512i srcVector, const __m512i &dstVector) const
+    {
+        if (!fullCoverage)
+            srcVector = BYTE_MUL_AVX512(srcVector, constAlpha, colorMask, half);
+        const __m512i oneMinusAlpha = _mm512_sub_epi16(one, ALPHA_AVX512(srcVector));
+        return _mm512_add_epi8(srcVector, BYTE_MUL_AVX512(dstVector, oneMinusAlpha, colorMask, half));
+    }
+};
+
+struct QPlusOpAVX512 : QBlendConstantsAVX512
+{
+    QPlusOpAVX512(uint const_alpha) : QBlendConstantsAVX512(const_alpha) {}
+    inline __m512i operator()(const __m512i &srcVector, const __m512i &dstVector) const
+    {
+        return applyCoverage(_mm512_adds_epu8(srcVector, dstVector), dstVector);
+    }
+};
+
+struct QMultiplyOpAVX512 : QBlendConstantsAVX512
+{
+    QMultiplyOpAVX512(uint const_alpha) : QBlendConstantsAVX512(const_alpha) {}
+    inline __m512i operator()(const __m512i &srcVector, const __m512i &dstVector) const
+    {
+        const __m512i zero = _mm512_setzero_si512();
+        const __m512i lo = MULTIPLY_16_AVX512(_mm512_unpacklo_epi8(srcVector, zero), _mm512_unpacklo_epi8(dstVector, zero), one, half);
+        const __m512i hi = MULTIPLY_16_AVX512(_mm512_unpackhi_epi8(srcVector, zero), _mm512_unpackhi_epi8(dstVector, zero), one, half);
+        return applyCoverage(_mm512_packus_epi16(lo, hi), dstVector);
+    }
+};
+
+template <typename BlendOp>
+static inline void blend_span_avx512(uint *dst, const uint *src, int length, const BlendOp &op)
+{
+    int x = 0;
+    for (; x < length - 15; x += 16) {
+        const __m512i srcVector = _mm512_loadu_si512(&src[x]);
+        const __m512i dstVector = _mm512_loadu_si512(&dst[x]);
+        _mm512_storeu_si512(&dst[x], op(srcVector, dstVector));
+    }
+    if (x < length) {
+        const __mmask16 tailMask = TAIL_MASK_AVX512(length - x);
+        const __m512i srcVector = _mm512_maskz_loadu_epi32(tailMask, &src[x]);
+        const __m512i dstVector = _mm512_maskz_loadu_epi32(tailMask, &dst[x]);
+        _mm512_mask_storeu_epi32(&dst[x], tailMask, op(srcVector, dstVector));
+    }
+}
+
+template <typename BlendOp>
+static inline void blend_solid_span_avx512(uint *dst, int length, uint color, const BlendOp &op)
+{
+    const __m512i colorVector = _mm512_set1_epi32(color);
+    int x = 0;
+    for (; x < length - 15; x += 16) {
+        const __m512i dstVector = _mm512_loadu_si512(&dst[x]);
+        _mm512_storeu_si512(&dst[x], op(colorVector, dstVector));
+    }
+    if (x < length) {
+        const __mmask16 tailMask = TAIL_MASK_AVX512(length - x);
+        const __m512i dstVector = _mm512_maskz_loadu_epi32(tailMask, &dst[x]);
+        _mm512_mask_storeu_epi32(&dst[x], tailMask, op(colorVector, dstVector));
+    }
+}
+
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_SourceOver_avx512(uint *dst, const uint *src, int length, uint const_alpha)
+{
+    Q_ASSERT(const_alpha < 256);
+
+    const QSourceOverOpAVX512 op(const_alpha);
+    if (const_alpha != 255) {
+        blend_span_avx512(dst, src, length, op);
+        return;
+    }
+
+    // Skip fully transparent and copy fully opaque runs of sixteen pixels.
+    const __m512i alphaMask = _mm512_set1_epi32(0xff000000);
+    int x = 0;
+    for (; x < length; x += 16) {
+        const __mmask16 mask = length - x < 16 ? TAIL_MASK_AVX512(length - x) : __mmask16(0xffff);
+        const __m512i srcVector = _mm512_maskz_loadu_epi32(mask, &src[x]);
+        const __mmask16 opaque = _mm512_cmpeq_epi32_mask(_mm512_and_si512(srcVector, alphaMask), alphaMask);
+        if ((opaque & mask) == mask) {
+            _mm512_mask_storeu_epi32(&dst[x], mask, srcVector);
+        } else if (_mm512_test_epi32_mask(srcVector, srcVector) != 0) {
+            const __m512i dstVector = _mm512_maskz_loadu_epi32(mask, &dst[x]);
+            _mm512_mask_storeu_epi32(&dst[x], mask, op(srcVector, dstVector));
+        }
+    }
+}
+
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_solid_SourceOver_avx512(uint *dst, int length, uint color, uint const_alpha)
+{
+    if ((const_alpha & qAlpha(color)) == 255) {
+        qt_memfill32(dst, color, length);
+        return;
+    }
+    // Fold the constant alpha into the color once, as the generic implementation does.
+    if (const_alpha != 255)
+        color = BYTE_MUL(color, const_alpha);
+    blend_solid_span_avx512(dst, length, color, QSourceOverOpAVX512(255));
+}
+
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_Source_avx512(uint *dst, const uint *src, int length, uint const_alpha)
+{
+    if (const_alpha == 255)
+        ::memcpy(dst, src, length * sizeof(uint));
+    else
+        blend_span_avx512(dst, src, length, QSourceOpAVX512(const_alpha));
+}
+
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_Plus_avx512(uint *dst, const uint *src, int length, uint const_alpha)
+{
+    blend_span_avx512(dst, src, length, QPlusOpAVX512(const_alpha));
+}
+
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_solid_Plus_avx512(uint *dst, int length, uint color, uint const_alpha)
+{
+    blend_solid_span_avx512(dst, length, color, QPlusOpAVX512(const_alpha));
+}
+
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_Multiply_avx512(uint *dst, const uint *src, int length, uint const_alpha)
+{
+    blend_span_avx512(dst, src, length, QMultiplyOpAVX512(const_alpha));
+}
+
+Q_AUTOTEST_EXPORT void QT_FASTCALL comp_func_solid_Multiply_avx512(uint *dst, int length, uint color, uint const_alpha)
+{
+    blend_solid_span_avx512(dst, length, color, QMultiplyOpAVX512(const_alpha));
+}
+
+QT_END_NAMESPACE
+
+#endif
@@ -278,6 +278,10 @@ struct QGradientData
     const QRgba64 *colorTable64; //[GRADIENT_STOPTABLE_SIZE];
     const QRgb *colorTable32; //[GRADIENT_STOPTABLE_SIZE];
 
+    // Opacity that was not baked into the color tables and has to be
+    // applied when blending, 256 if the tables already account for it.
+    int const_alpha;
+
     uint alphaColor : 1;
 };
 
@@ -345,6 +349,7 @@ struct QSpanData
 
     void init(QRasterBuffer *rb, const QRasterPaintEngine *pe);
     void setup(const QBrush &brush, int alpha, QPainter::CompositionMode compositionMode);
+    void setupGradientTables(const QGradient &g, int alpha, QPainter::CompositionMode compositionMode);
     void setupMatrix(const QTransform &matrix, int bilinear);
     void initTexture(const QImage *image, int alpha, QTextureData::Type = QTextureData::Plain, const QRect &sourceRect = QRect());
     void adjustSpanMethods();
@@ -38,6 +38,7 @@
 ****************************************************************************/
 #include <private/qimagescale_p.h>
 #include <private/qdrawhelper_p.h>
+#include <private/qimage_p.h>
 
 #include "qimage.h"
 #include "qcolor.h"
@@ -745,12 +746,20 @@ QImage qSmoothScaleImage(const QImage &src, int dw, int dh)
         return QImage();
     }
 
-    if (src.hasAlphaChannel())
-        qt_qimageScaleAARGBA(scaleinfo, (unsigned int *)buffer.scanLine(0),
-                             dw, dh, dw, src.bytesPerLine() / 4);
-    else
-        qt_qimageScaleAARGB(scaleinfo, (unsigned int *)buffer.scanLine(0),
-                            dw, dh, dw, src.bytesPerLine() / 4);
+    // Every destination scanline only depends on its own entries of the
+    // scale info, so segments are scaled with a view offset to their first line
+    const bool hasAlpha = src.hasAlphaChannel();
+    const int sow = src.bytesPerLine() / 4;
+    unsigned int *dest = reinterpret_cast<unsigned int *>(buffer.bits());
+    qt_imageProcessSegments(dh, qint64(dw) * dh, [=](int yStart, int yEnd) {
+        QImageScaleInfo segmentInfo = *scaleinfo;
+        segmentInfo.ypoints += yStart;
+        segmentInfo.yapoints += yStart;
+        if (hasAlpha)
+            qt_qimageScaleAARGBA(&segmentInfo, dest + qptrdiff(yStart) * dw, dw, yEnd - yStart, dw, sow);
+        else
+            qt_qimageScaleAARGB(&segmentInfo, dest + qptrdiff(yStart) * dw, dw, yEnd - yStart, dw, sow);
+    });
 
     qimageFreeScaleInfo(scaleinfo);
     return buffer;
@@ -0,0 +1,1209 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtGui module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qpaintbuffer.h"
+#include "qpaintbuffer_p.h"
+
+#include <qfontmetrics.h>
+#include <qmath.h>
+#include <qnumeric.h>
+#include <qregion.h>
+#include <qthread.h>
+
+#include <private/qfont_p.h>
+#include <private/qfontengine_p.h>
+#include <private/qpaintengineex_p.h>
+#include <private/qtextengine_p.h>
+
+#include <algorithm>
+
+#include <float.h>
+
+QT_BEGIN_NAMESPACE
+
+extern void qt_format_text(const QFont &fnt, const QRectF &_r,
+                           int tf, const QTextOption *opt, const QString& str, QRectF *brect,
+                           int tabstops, int *, int tabarraylen,
+                           QPainter *painter);
+
+/*!
+    \class QPaintBuffer
+    \inmodule QtGui
+    \since 5.10
+
+    \brief The QPaintBuffer class is a paint device that records QPainter
+    commands and replays them quickly.
+
+    \ingroup painting
+    \ingroup shared
+
+    Like QPicture, a QPaintBuffer records the commands of a QPainter
+    working on it, and play() replays them onto another painter. Unlike
+    QPicture, the buffer is never serialized. The commands are kept in
+    typed arrays together with the area they can touch, and consecutive
+    state changes are merged into a single state, so replaying a buffer
+    does not decode anything and only applies the state that actually
+    changes between two commands.
+
+    This makes QPaintBuffer well suited for caching content that is
+    expensive to compute but changes rarely, like the static layers of a
+    diagram. Passing the exposed area to play() skips the commands that
+    cannot touch it:
+
+    \snippet code/src_gui_painting_qpaintbuffer.cpp 0
+
+    The buffer is drawn in the current coordinate system of the painter,
+    on top of its clip and opacity. The pen, brush, background, render
+    hints and composition mode are the ones used while recording.
+
+    Text is recorded as shaped glyphs, which are only valid on the thread
+    that recorded the buffer. When the buffer is played on another thread,
+    the text is laid out again.
+
+    QPaintBuffer is implicitly shared. Painting on a buffer always starts
+    from an empty buffer.
+
+    \sa QPicture, QPainter::drawPicture()
+*/
+
+QPaintBufferBounds QPaintBufferBounds::empty()
+{
+    const QPaintBufferBounds bounds = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+    return bounds;
+}
+
+QPaintBufferBounds QPaintBufferBounds::unbounded()
+{
+    const QPaintBufferBounds bounds = { -FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX };
+    return bounds;
+}
+
+QPaintBufferBounds QPaintBufferBounds::fromRect(const QRectF &rect)
+{
+    const QRectF r = rect.normalized();
+    const QPaintBufferBounds bounds = {
+        float(qBound<qreal>(-FLT_MAX, r.left(), FLT_MAX)),
+        float(qBound<qreal>(-FLT_MAX, r.top(), FLT_MAX)),
+        float(qBound<qreal>(-FLT_MAX, r.right(), FLT_MAX)),
+        float(qBound<qreal>(-FLT_MAX, r.bottom(), FLT_MAX))
+    };
+    return bounds;
+}
+
+QPaintBufferState::QPaintBufferState()
+    : backgroundMode(Qt::TransparentMode),
+      clipEnabled(false),
+      clipBounds(QPaintBufferBounds::unbounded()),
+      compositionMode(QPainter::CompositionMode_SourceOver),
+      opacity(1)
+{
+    for (int i = 0; i < GroupCount; ++i)
+        serials[i] = 0;
+}
+
+QPaintBufferText::QPaintBufferText()
+    : fontEngine(0), glyphOffset(0), glyphCount(0), justificationWidth(0)
+{
+}
+
+QPaintBufferText::QPaintBufferText(const QPaintBufferText &other)
+    : fontEngine(0),
+      glyphOffset(other.glyphOffset),
+      glyphCount(other.glyphCount),
+      position(other.position),
+      text(other.text),
+      font(other.font),
+      justificationWidth(other.justificationWidth)
+{
+    setFontEngine(other.fontEngine);
+}
+
+QPaintBufferText::~QPaintBufferText()
+{
+    setFontEngine(0);
+}
+
+QPaintBufferText &QPaintBufferText::operator=(const QPaintBufferText &other)
+{
+    setFontEngine(other.fontEngine);
+    glyphOffset = other.glyphOffset;
+    glyphCount = other.glyphCount;
+    position = other.position;
+    text = other.text;
+    font = other.font;
+    justificationWidth = other.justificationWidth;
+    return *this;
+}
+
+void QPaintBufferText::setFontEngine(QFontEngine *engine)
+{
+    if (engine)
+        engine->ref.ref();
+    if (fontEngine && !fontEngine->ref.deref())
+        delete fontEngine;
+    fontEngine = engine;
+}
+
+QPaintBufferPrivate::QPaintBufferPrivate()
+    : bounds(QPaintBufferBounds::empty()),
+      deviceMargin(2), // antialiasing and rounding
+      thread(0)
+{
+}
+
+// The paint engine belongs to a single buffer and is not copied
+QPaintBufferPrivate::QPaintBufferPrivate(const QPaintBufferPrivate &other)
+    : QSharedData(other),
+      commands(other.commands),
+      blockBounds(other.blockBounds),
+      states(other.states),
+      rects(other.rects),
+      rectFs(other.rectFs),
+      lines(other.lines),
+      lineFs(other.lineFs),
+      points(other.points),
+      pointFs(other.pointFs),
+      paths(other.paths),
+      pixmaps(other.pixmaps),
+      images(other.images),
+      texts(other.texts),
+      glyphs(other.glyphs),
+      glyphPositions(other.glyphPositions),
+      bounds(other.bounds),
+      deviceMargin(other.deviceMargin),
+      thread(other.thread)
+{
+}
+
+QPaintBufferPrivate::~QPaintBufferPrivate()
+{
+}
+
+void QPaintBufferPrivate::clear()
+{
+    commands.clear();
+    blockBounds.clear();
+    states.clear();
+    rects.clear();
+    rectFs.clear();
+    lines.clear();
+    lineFs.clear();
+    points.clear();
+    pointFs.clear();
+    paths.clear();
+    pixmaps.clear();
+    images.clear();
+    texts.clear();
+    glyphs.clear();
+    glyphPositions.clear();
+    bounds = QPaintBufferBounds::empty();
+    deviceMargin = 2;
+    thread = 0;
+}
+
+void QPaintBufferPrivate::addCommand(const QPaintBufferCommand &command)
+{
+    if (commands.size() % BlockSize == 0)
+        blockBounds.append(command.bounds);
+    else
+        blockBounds.last().unite(command.bounds);
+    bounds.unite(command.bounds);
+    commands.append(command);
+}
+
+/*!
+    Constructs an empty paint buffer.
+*/
+QPaintBuffer::QPaintBuffer()
+    : d_ptr(new QPaintBufferPrivate)
+{
+}
+
+/*!
+    Constructs a copy of \a other.
+
+    This operation takes constant time, because QPaintBuffer is implicitly
+    shared.
+*/
+QPaintBuffer::QPaintBuffer(const QPaintBuffer &other)
+    : QPaintDevice(),
+      d_ptr(other.d_ptr)
+{
+}
+
+/*!
+    Destroys the paint buffer.
+*/
+QPaintBuffer::~QPaintBuffer()
+{
+    if (paintingActive())
+        qWarning("QPaintBuffer: Destroying buffer while painting is active");
+}
+
+/*!
+    Assigns \a other to this paint buffer and returns a reference to this
+    buffer.
+*/
+QPaintBuffer &QPaintBuffer::operator=(const QPaintBuffer &other)
+{
+    d_ptr = other.d_ptr;
+    return *this;
+}
+
+/*!
+    \fn QPaintBuffer &QPaintBuffer::operator=(QPaintBuffer &&other)
+
+    Move-assigns \a other to this QPaintBuffer instance.
+*/
+
+/*!
+    \fn void QPaintBuffer::swap(QPaintBuffer &other)
+
+    Swaps paint buffer \a other with this paint buffer. This operation is
+    very fast and never fails.
+*/
+
+/*!
+    Returns \c true if nothing has been recorded in the buffer; otherwise
+    returns \c false.
+*/
+bool QPaintBuffer::isEmpty() const
+{
+    return d_ptr->commands.isEmpty();
+}
+
+/*!
+    Returns the area the recorded commands can paint on when the buffer is
+    played on an untransformed painter. The rectangle includes the pens
+    and a small margin for antialiasing, so it may be larger than the area
+    that is actually painted on.
+*/
+QRectF QPaintBuffer::boundingRect() const
+{
+    const QPaintBufferBounds &bounds = d_ptr->bounds;
+    if (bounds.isEmpty())
+        return QRectF();
+    const qreal margin = d_ptr->deviceMargin;
+    return QRectF(QPointF(bounds.left, bounds.top), QPointF(bounds.right, bounds.bottom))
+            .adjusted(-margin, -margin, margin, margin);
+}
+
+/*!
+    Removes all commands from the buffer.
+*/
+void QPaintBuffer::clear()
+{
+    if (d_ptr->ref.load() != 1)
+        d_ptr = new QPaintBufferPrivate;
+    else
+        d_ptr->clear();
+}
+
+/*!
+    Replays the recorded commands on \a painter.
+
+    The state of \a painter is restored when the function returns.
+*/
+void QPaintBuffer::play(QPainter *painter) const
+{
+    d_ptr->play(painter, 0, 0);
+}
+
+/*!
+    \overload
+
+    Replays the recorded commands that can touch the \a exposed rectangle
+    on \a painter. The rectangle is given in the logical coordinates of
+    \a painter.
+
+    Commands are skipped as a whole, so \a painter may still paint outside
+    of \a exposed. Set a clip on \a painter if that must not happen.
+*/
+void QPaintBuffer::play(QPainter *painter, const QRectF &exposed) const
+{
+    d_ptr->play(painter, &exposed, 1);
+}
+
+/*!
+    \overload
+
+    Replays the recorded commands that can touch the \a exposed region on
+    \a painter, for instance the region of a QPaintEvent. The region is
+    given in the logical coordinates of \a painter.
+*/
+void QPaintBuffer::play(QPainter *painter, const QRegion &exposed) const
+{
+    if (exposed.isEmpty())
+        return;
+    QVarLengthArray<QRectF, 16> rects;
+    for (const QRect &rect : exposed)
+        rects.append(QRectF(rect));
+    d_ptr->play(painter, rects.constData(), rects.size());
+}
+
+/*!
+    \reimp
+*/
+int QPaintBuffer::devType() const
+{
+    return QInternal::PaintBuffer;
+}
+
+/*!
+    \reimp
+*/
+QPaintEngine *QPaintBuffer::paintEngine() const
+{
+    // A painter writes to the buffer, so it must own its data
+    QPaintBuffer *that = const_cast<QPaintBuffer *>(this);
+    that->d_ptr.detach();
+    if (!d_ptr->engine)
+        that->d_ptr->engine.reset(new QPaintBufferEngine);
+    return d_ptr->engine.data();
+}
+
+/*!
+    \reimp
+*/
+int QPaintBuffer::metric(PaintDeviceMetric metric) const
+{
+    const QRect rect = boundingRect().toAlignedRect();
+    switch (metric) {
+    case PdmWidth:
+        return rect.width();
+    case PdmHeight:
+        return rect.height();
+    case PdmWidthMM:
+        return int(25.4 / qt_defaultDpiX() * rect.width());
+    case PdmHeightMM:
+        return int(25.4 / qt_defaultDpiY() * rect.height());
+    case PdmDpiX:
+    case PdmPhysicalDpiX:
+        return qt_defaultDpiX();
+    case PdmDpiY:
+    case PdmPhysicalDpiY:
+        return qt_defaultDpiY();
+    case PdmNumColors:
+        return 16777216;
+    case PdmDepth:
+        return 24;
+    case PdmDevicePixelRatio:
+        return 1;
+    case PdmDevicePixelRatioScaled:
+        return 1 * QPaintDevice::devicePixelRatioFScale();
+    default:
+        qWarning("QPaintBuffer::metric: Invalid metric command");
+        return 0;
+    }
+}
+
+/*
+    The painter state play() started with. The buffer is painted in its
+    coordinate system, with its opacity and inside its clip.
+*/
+class QPainterReplayer
+{
+public:
+    explicit QPainterReplayer(QPainter *painter)
+        : painter(painter),
+          transform(painter->transform()),
+          opacity(painter->opacity()),
+          clipped(false)
+    {
+    }
+
+    void applyClip(const QPaintBufferState &state);
+    void applyState(const QPaintBufferState &state, const QPaintBufferState *current);
+    void drawText(const QPaintBufferPrivate *d, const QPaintBufferText &text);
+
+    QPainter *painter;
+    QTransform transform;
+    qreal opacity;
+    bool clipped;
+};
+
+void QPainterReplayer::applyClip(const QPaintBufferState &state)
+{
+    // QPainter only keeps the operations since the last replaced clip,
+    // all of them intersect with the clip of the painter
+    for (const QPainterClipInfo &info : state.clipInfo) {
+        if (info.operation == Qt::NoClip)
+            continue;
+        painter->setTransform(info.matrix * transform);
+        switch (info.clipType) {
+        case QPainterClipInfo::RegionClip:
+            painter->setClipRegion(info.region, Qt::IntersectClip);
+            break;
+        case QPainterClipInfo::PathClip:
+            painter->setClipPath(info.path, Qt::IntersectClip);
+            break;
+        case QPainterClipInfo::RectClip:
+            painter->setClipRect(info.rect, Qt::IntersectClip);
+            break;
+        case QPainterClipInfo::RectFClip:
+            painter->setClipRect(info.rectf, Qt::IntersectClip);
+            break;
+        }
+    }
+    clipped = true;
+}
+
+void QPainterReplayer::applyState(const QPaintBufferState &state, const QPaintBufferState *current)
+{
+    if (current && current->serials[QPaintBufferState::ClipGroup] != state.serials[QPaintBufferState::ClipGroup]
+        && (clipped || state.clipEnabled)) {
+        // Going back to the clip of the painter is exact through its saved
+        // state, unlike converting that clip to a path and setting it again
+        if (clipped) {
+            painter->restore();
+            painter->save();
+            clipped = false;
+            current = 0;
+        }
+        if (state.clipEnabled)
+            applyClip(state);
+    } else if (!current && state.clipEnabled) {
+        applyClip(state);
+    }
+
+    const auto changed = [&state, current](QPaintBufferState::Group group) {
+        return !current || current->serials[group] != state.serials[group];
+    };
+
+    if (changed(QPaintBufferState::PenGroup))
+        painter->setPen(state.pen);
+    if (changed(QPaintBufferState::BrushGroup)) {
+        painter->setBrush(state.brush);
+        painter->setBrushOrigin(state.brushOrigin);
+    }
+    if (changed(QPaintBufferState::BackgroundGroup)) {
+        painter->setBackground(state.background);
+        painter->setBackgroundMode(state.backgroundMode);
+    }
+    if (changed(QPaintBufferState::ClipGroup) || changed(QPaintBufferState::TransformGroup))
+        painter->setTransform(state.matrix * transform);
+    if (changed(QPaintBufferState::HintsGroup)) {
+        painter->setRenderHints(~state.renderHints, false);
+        painter->setRenderHints(state.renderHints, true);
+    }
+    if (changed(QPaintBufferState::CompositionModeGroup))
+        painter->setCompositionMode(state.compositionMode);
+    if (changed(QPaintBufferState::OpacityGroup))
+        painter->setOpacity(opacity * state.opacity);
+}
+
+#ifndef QT_NO_RAWFONT
+// Same as QPainter::drawGlyphRun(), without going through QRawFont
+static void qt_drawBufferGlyphs(QPainter *painter, const QPaintBufferPrivate *d,
+                                const QPaintBufferText &text)
+{
+    QPainterPrivate *pd = QPainterPrivate::get(painter);
+    const bool pretransform = pd->extended
+        ? pd->extended->requiresPretransformedGlyphPositions(text.fontEngine, pd->state->matrix)
+        : pd->engine->type() != QPaintEngine::CoreGraphics && !pd->state->matrix.isAffine();
+
+    const QFixedPoint *recorded = d->glyphPositions.constData() + text.glyphOffset;
+    QVarLengthArray<QFixedPoint, 128> positions(text.glyphCount);
+    for (int i = 0; i < text.glyphCount; ++i) {
+        positions[i] = pretransform
+            ? QFixedPoint::fromPointF(pd->state->transform().map(recorded[i].toPointF()))
+            : recorded[i];
+    }
+
+    pd->drawGlyphs(d->glyphs.constData() + text.glyphOffset, positions.data(), text.glyphCount,
+                   text.fontEngine, false, false, false);
+}
+#endif
+
+void QPainterReplayer::drawText(const QPaintBufferPrivate *d, const QPaintBufferText &text)
+{
+#ifndef QT_NO_RAWFONT
+    if (text.fontEngine && d->thread == QThread::currentThread()) {
+        qt_drawBufferGlyphs(painter, d, text);
+        return;
+    }
+#endif
+
+    // Detaching copies the font without its engine data, so the engine is
+    // looked up in this thread's font cache and the recorded font is not
+    // written to while replaying.
+    QFont font = text.font;
+    font.detach();
+
+    int flags = Qt::TextSingleLine | Qt::TextDontClip | Qt::TextForceLeftToRight;
+    QSizeF size(1, 1);
+    if (text.justificationWidth > 0) {
+        size.setWidth(text.justificationWidth);
+        flags |= Qt::TextJustificationForced;
+        flags |= Qt::AlignJustify;
+    }
+
+    QFontMetricsF fm(font);
+    QPointF pt(text.position.x(), text.position.y() - fm.ascent());
+    qt_format_text(font, QRectF(pt, size), flags, /*opt*/0,
+                   text.text, /*brect=*/0, /*tabstops=*/0, /*...*/0, /*tabarraylen=*/0, painter);
+}
+
+template <typename Point>
+static void qt_replayPolygon(QPainter *painter, const Point *points, int pointCount, int mode)
+{
+    switch (mode) {
+    case QPaintEngine::PolylineMode:
+        painter->drawPolyline(points, pointCount);
+        break;
+    case QPaintEngine::ConvexMode:
+        painter->drawConvexPolygon(points, pointCount);
+        break;
+    case QPaintEngine::WindingMode:
+        painter->drawPolygon(points, pointCount, Qt::WindingFill);
+        break;
+    default:
+        painter->drawPolygon(points, pointCount, Qt::OddEvenFill);
+        break;
+    }
+}
+
+static void qt_replayPixmap(QPainter *painter, const QPaintBufferPrivate *d, const QPaintBufferCommand &command)
+{
+    const QPixmap &pixmap = d->pixmaps.at(command.extra);
+    // QPainter already filled the opaque background of bitmaps
+    const Qt::BGMode mode = painter->backgroundMode();
+    if (mode == Qt::OpaqueMode && pixmap.isQBitmap())
+        painter->setBackgroundMode(Qt::TransparentMode);
+    if (command.type == QPaintBufferCommand::DrawTiledPixmap)
+        painter->drawTiledPixmap(d->rectFs.at(command.offset), pixmap, d->pointFs.at(command.count));
+    else
+        painter->drawPixmap(d->rectFs.at(command.offset), pixmap, d->rectFs.at(command.offset + 1));
+    if (mode == Qt::OpaqueMode && pixmap.isQBitmap())
+        painter->setBackgroundMode(mode);
+}
+
+static void qt_replayCommand(QPainterReplayer *replayer, const QPaintBufferPrivate *d,
+                             const QPaintBufferCommand &command)
+{
+    QPainter *painter = replayer->painter;
+    switch (command.type) {
+    case QPaintBufferCommand::DrawRects:
+        painter->drawRects(d->rects.constData() + command.offset, command.count);
+        break;
+    case QPaintBufferCommand::DrawRectsF:
+        painter->drawRects(d->rectFs.constData() + command.offset, command.count);
+        break;
+    case QPaintBufferCommand::DrawLines:
+        painter->drawLines(d->lines.constData() + command.offset, command.count);
+        break;
+    case QPaintBufferCommand::DrawLinesF:
+        painter->drawLines(d->lineFs.constData() + command.offset, command.count);
+        break;
+    case QPaintBufferCommand::DrawPoints:
+        painter->drawPoints(d->points.constData() + command.offset, command.count);
+        break;
+    case QPaintBufferCommand::DrawPointsF:
+        painter->drawPoints(d->pointFs.constData() + command.offset, command.count);
+        break;
+    case QPaintBufferCommand::DrawPolygon:
+        qt_replayPolygon(painter, d->points.constData() + command.offset, command.count, command.extra);
+        break;
+    case QPaintBufferCommand::DrawPolygonF:
+        qt_replayPolygon(painter, d->pointFs.constData() + command.offset, command.count, command.extra);
+        break;
+    case QPaintBufferCommand::DrawEllipse:
+        painter->drawEllipse(d->rects.at(command.offset));
+        break;
+    case QPaintBufferCommand::DrawEllipseF:
+        painter->drawEllipse(d->rectFs.at(command.offset));
+        break;
+    case QPaintBufferCommand::DrawPath:
+        painter->drawPath(d->paths.at(command.offset));
+        break;
+    case QPaintBufferCommand::DrawPixmap:
+    case QPaintBufferCommand::DrawTiledPixmap:
+        qt_replayPixmap(painter, d, command);
+        break;
+    case QPaintBufferCommand::DrawImage:
+        painter->drawImage(d->rectFs.at(command.offset), d->images.at(command.extra),
+                           d->rectFs.at(command.offset + 1), Qt::ImageConversionFlags(command.count));
+        break;
+    case QPaintBufferCommand::DrawText:
+        replayer->drawText(d, d->texts.at(command.offset));
+        break;
+    }
+}
+
+static inline bool qt_intersectsAny(const QPaintBufferBounds &bounds,
+                                    const QPaintBufferBounds *exposed, int exposedCount)
+{
+    for (int i = 0; i < exposedCount; ++i) {
+        if (bounds.intersects(exposed[i]))
+            return true;
+    }
+    return false;
+}
+
+/*
+    Replays the commands touching the \a exposed rectangles, or all of them
+    if \a exposedCount is 0. Whole blocks of commands are skipped before
+    testing the commands themselves, and the state is only applied for the
+    commands that are drawn.
+*/
+void QPaintBufferPrivate::play(QPainter *painter, const QRectF *exposed, int exposedCount) const
+{
+    if (!painter->isActive()) {
+        qWarning("QPaintBuffer::play: Painter not active");
+        return;
+    }
+    if (commands.isEmpty())
+        return;
+
+    QVarLengthArray<QPaintBufferBounds, 16> culling;
+    if (exposedCount > 0) {
+        // Pens and antialiasing reach out a few device pixels, whatever
+        // the scale the buffer is played at
+        const QTransform matrix = painter->combinedTransform();
+        const qreal scale = qMin(qSqrt(matrix.m11() * matrix.m11() + matrix.m12() * matrix.m12()),
+                                 qSqrt(matrix.m21() * matrix.m21() + matrix.m22() * matrix.m22()));
+        if (matrix.isAffine() && scale > 0) {
+            const qreal margin = deviceMargin / scale;
+            for (int i = 0; i < exposedCount; ++i)
+                culling.append(QPaintBufferBounds::fromRect(exposed[i].normalized()
+                                                            .adjusted(-margin, -margin, margin, margin)));
+        }
+    }
+    const QPaintBufferBounds *cullingBounds = culling.constData();
+    const int cullingCount = culling.size();
+
+    painter->save();
+    QPainterReplayer replayer(painter);
+
+    const QPaintBufferCommand *commandData = commands.constData();
+    const QPaintBufferState *stateData = states.constData();
+    const QPaintBufferState *current = 0;
+    const int commandCount = commands.size();
+    for (int block = 0; block < blockBounds.size(); ++block) {
+        if (cullingCount && !qt_intersectsAny(blockBounds.at(block), cullingBounds, cullingCount))
+            continue;
+
+        const int end = qMin(commandCount, (block + 1) * BlockSize);
+        for (int i = block * BlockSize; i < end; ++i) {
+            const QPaintBufferCommand &command = commandData[i];
+            if (cullingCount && !qt_intersectsAny(command.bounds, cullingBounds, cullingCount))
+                continue;
+            const QPaintBufferState *state = stateData + command.state;
+            if (state != current) {
+                replayer.applyState(*state, current);
+                current = state;
+            }
+            qt_replayCommand(&replayer, this, command);
+        }
+    }
+
+    painter->restore();
+}
+
+/*
+    Paint engine of QPaintBuffer. QPainter updates the state before every
+    draw call; the engine only keeps it pending and records a new state
+    when a command is drawn with one that differs from the last recorded.
+*/
+
+QPaintBufferEngine::QPaintBufferEngine()
+    : QPaintEngine(*(new QPaintBufferEnginePrivate), AllFeatures)
+{
+}
+
+QPaintBufferEngine::~QPaintBufferEngine()
+{
+}
+
+bool QPaintBufferEngine::begin(QPaintDevice *pdev)
+{
+    Q_D(QPaintBufferEngine);
+    d->buffer = QPaintBufferPrivate::get(static_cast<QPaintBuffer *>(pdev));
+    d->buffer->clear();
+    d->buffer->thread = QThread::currentThread();
+    d->state = QPaintBufferState();
+    d->serial = 0;
+    d->stateDirty = true;
+    d->clipDirty = false;
+    setActive(true);
+    return true;
+}
+
+bool QPaintBufferEngine::end()
+{
+    Q_D(QPaintBufferEngine);
+    d->pixmapIndexes.clear();
+    d->imageIndexes.clear();
+    d->buffer = 0;
+    setActive(false);
+    return true;
+}
+
+void QPaintBufferEngine::updateState(const QPaintEngineState &state)
+{
+    Q_D(QPaintBufferEngine);
+    const QPaintEngine::DirtyFlags flags = state.state();
+    QPaintBufferState &s = d->state;
+
+    if ((flags & DirtyPen) && state.pen() != s.pen) {
+        s.pen = state.pen();
+        d->changed(QPaintBufferState::PenGroup);
+    }
+    if ((flags & DirtyBrush) && state.brush() != s.brush) {
+        s.brush = state.brush();
+        d->changed(QPaintBufferState::BrushGroup);
+    }
+    if ((flags & DirtyBrushOrigin) && state.brushOrigin() != s.brushOrigin) {
+        s.brushOrigin = state.brushOrigin();
+        d->changed(QPaintBufferState::BrushGroup);
+    }
+    if ((flags & DirtyBackground) && state.backgroundBrush() != s.background) {
+        s.background = state.backgroundBrush();
+        d->changed(QPaintBufferState::BackgroundGroup);
+    }
+    if ((flags & DirtyBackgroundMode) && state.backgroundMode() != s.backgroundMode) {
+        s.backgroundMode = state.backgroundMode();
+        d->changed(QPaintBufferState::BackgroundGroup);
+    }
+    if ((flags & DirtyTransform) && state.transform() != s.matrix) {
+        s.matrix = state.transform();
+        d->changed(QPaintBufferState::TransformGroup);
+    }
+    if (flags & (DirtyClipEnabled | DirtyClipRegion | DirtyClipPath))
+        d->clipDirty = true;
+    if ((flags & DirtyHints) && state.renderHints() != s.renderHints) {
+        s.renderHints = state.renderHints();
+        d->changed(QPaintBufferState::HintsGroup);
+    }
+    if ((flags & DirtyCompositionMode) && state.compositionMode() != s.compositionMode) {
+        s.compositionMode = state.compositionMode();
+        d->changed(QPaintBufferState::CompositionModeGroup);
+    }
+    if ((flags & DirtyOpacity) && state.opacity() != s.opacity) {
+        s.opacity = state.opacity();
+        d->changed(QPaintBufferState::OpacityGroup);
+    }
+}
+
+// Like QPolygonF::boundingRect(), without building a polygon first
+class QPaintBufferExtent
+{
+public:
+    QPaintBufferExtent() : minX(qInf()), minY(qInf()), maxX(-qInf()), maxY(-qInf()) {}
+
+    void add(const QPointF &point)
+    {
+        minX = qMin(minX, point.x());
+        minY = qMin(minY, point.y());
+        maxX = qMax(maxX, point.x());
+        maxY = qMax(maxY, point.y());
+    }
+    void add(const QRectF &rect)
+    {
+        add(rect.topLeft());
+        add(rect.bottomRight());
+    }
+    void add(const QLineF &line)
+    {
+        add(line.p1());
+        add(line.p2());
+    }
+    void add(const QPoint &point) { add(QPointF(point)); }
+    void add(const QRect &rect) { add(QRectF(rect)); }
+    void add(const QLine &line) { add(QLineF(line)); }
+
+    QRectF rect() const
+    {
+        if (minX > maxX || minY > maxY)
+            return QRectF();
+        return QRectF(QPointF(minX, minY), QPointF(maxX, maxY));
+    }
+
+private:
+    qreal minX;
+    qreal minY;
+    qreal maxX;
+    qreal maxY;
+};
+
+// The integer and floating point overloads are recorded separately, since
+// the raster engine does not rasterize them in quite the same way.
+
+template <typename Item>
+static void qt_recordItems(QPaintBufferEnginePrivate *d, QPaintBufferCommand::Type type,
+                           QVector<Item> &storage, const Item *items, int itemCount,
+                           bool stroked, int extra = 0)
+{
+    QPaintBufferExtent extent;
+    for (int i = 0; i < itemCount; ++i)
+        extent.add(items[i]);
+    const int offset = storage.size();
+    storage.resize(offset + itemCount);
+    std::copy(items, items + itemCount, storage.begin() + offset);
+    d->record(type, extent.rect(), stroked, offset, itemCount, extra);
+}
+
+void QPaintBufferEngine::drawRects(const QRect *rects, int rectCount)
+{
+    Q_D(QPaintBufferEngine);
+    qt_recordItems(d, QPaintBufferCommand::DrawRects, d->buffer->rects, rects, rectCount, true);
+}
+
+void QPaintBufferEngine::drawRects(const QRectF *rects, int rectCount)
+{
+    Q_D(QPaintBufferEngine);
+    qt_recordItems(d, QPaintBufferCommand::DrawRectsF, d->buffer->rectFs, rects, rectCount, true);
+}
+
+void QPaintBufferEngine::drawLines(const QLine *lines, int lineCount)
+{
+    Q_D(QPaintBufferEngine);
+    qt_recordItems(d, QPaintBufferCommand::DrawLines, d->buffer->lines, lines, lineCount, true);
+}
+
+void QPaintBufferEngine::drawLines(const QLineF *lines, int lineCount)
+{
+    Q_D(QPaintBufferEngine);
+    qt_recordItems(d, QPaintBufferCommand::DrawLinesF, d->buffer->lineFs, lines, lineCount, true);
+}
+
+void QPaintBufferEngine::drawEllipse(const QRect &rect)
+{
+    Q_D(QPaintBufferEngine);
+    qt_recordItems(d, QPaintBufferCommand::DrawEllipse, d->buffer->rects, &rect, 1, true);
+}
+
+void QPaintBufferEngine::drawEllipse(const QRectF &rect)
+{
+    Q_D(QPaintBufferEngine);
+    qt_recordItems(d, QPaintBufferCommand::DrawEllipseF, d->buffer->rectFs, &rect, 1, true);
+}
+
+void QPaintBufferEngine::drawPath(const QPainterPath &path)
+{
+    Q_D(QPaintBufferEngine);
+    const int offset = d->buffer->paths.size();
+    d->buffer->paths.append(path);
+    d->record(QPaintBufferCommand::DrawPath, path.controlPointRect(), true, offset, 1);
+}
+
+void QPaintBufferEngine::drawPoints(const QPoint *points, int pointCount)
+{
+    Q_D(QPaintBufferEngine);
+    qt_recordItems(d, QPaintBufferCommand::DrawPoints, d->buffer->points, points, pointCount, true);
+}
+
+void QPaintBufferEngine::drawPoints(const QPointF *points, int pointCount)
+{
+    Q_D(QPaintBufferEngine);
+    qt_recordItems(d, QPaintBufferCommand::DrawPointsF, d->buffer->pointFs, points, pointCount, true);
+}
+
+void QPaintBufferEngine::drawPolygon(const QPoint *points, int pointCount, PolygonDrawMode mode)
+{
+    Q_D(QPaintBufferEngine);
+    qt_recordItems(d, QPaintBufferCommand::DrawPolygon, d->buffer->points, points, pointCount,
+                   true, mode);
+}
+
+void QPaintBufferEngine::drawPolygon(const QPointF *points, int pointCount, PolygonDrawMode mode)
+{
+    Q_D(QPaintBufferEngine);
+    qt_recordItems(d, QPaintBufferCommand::DrawPolygonF, d->buffer->pointFs, points, pointCount,
+                   true, mode);
+}
+
+void QPaintBufferEngine::drawPixmap(const QRectF &r, const QPixmap &pm, const QRectF &sr)
+{
+    Q_D(QPaintBufferEngine);
+    const int offset = d->buffer->rectFs.size();
+    d->buffer->rectFs << r << sr;
+    d->record(QPaintBufferCommand::DrawPixmap, r, false, offset, 2, d->pixmapIndex(pm));
+}
+
+void QPaintBufferEngine::drawTiledPixmap(const QRectF &r, const QPixmap &pixmap, const QPointF &s)
+{
+    Q_D(QPaintBufferEngine);
+    const int offset = d->buffer->rectFs.size();
+    d->buffer->rectFs << r;
+    const int pointOffset = d->buffer->pointFs.size();
+    d->buffer->pointFs << s;
+    d->record(QPaintBufferCommand::DrawTiledPixmap, r, false, offset, pointOffset, d->pixmapIndex(pixmap));
+}
+
+void QPaintBufferEngine::drawImage(const QRectF &r, const QImage &image, const QRectF &sr,
+                                   Qt::ImageConversionFlags flags)
+{
+    Q_D(QPaintBufferEngine);
+    const int offset = d->buffer->rectFs.size();
+    d->buffer->rectFs << r << sr;
+    d->record(QPaintBufferCommand::DrawImage, r, false, offset, int(flags), d->imageIndex(image));
+}
+
+void QPaintBufferEngine::drawTextItem(const QPointF &p, const QTextItem &ti)
+{
+    Q_D(QPaintBufferEngine);
+    const QTextItemInt &si = static_cast<const QTextItemInt &>(ti);
+    if (si.chars == 0) {
+        QPaintEngine::drawTextItem(p, ti); // Draw as path
+        return;
+    }
+
+    // Decorations are drawn by QPainter, see QPicturePaintEngine::drawTextItem()
+    QPaintBufferText text;
+    text.position = p;
+    text.text = ti.text();
+    text.font = ti.font();
+    text.font.setUnderline(false);
+    text.font.setStrikeOut(false);
+    text.font.setOverline(false);
+    text.justificationWidth = si.justified ? si.width.toReal() : 0;
+
+#ifndef QT_NO_RAWFONT
+    // QPainter hands out one item per font engine of a multi engine
+    if (si.fontEngine && si.fontEngine->type() != QFontEngine::Multi) {
+        QVarLengthArray<QFixedPoint> positions;
+        QVarLengthArray<glyph_t> glyphs;
+        si.fontEngine->getGlyphPositions(si.glyphs, QTransform::fromTranslate(p.x(), p.y()), si.flags,
+                                         glyphs, positions);
+        text.setFontEngine(si.fontEngine);
+        text.glyphOffset = d->buffer->glyphs.size();
+        text.glyphCount = glyphs.size();
+        d->buffer->glyphs.resize(text.glyphOffset + text.glyphCount);
+        std::copy(glyphs.constBegin(), glyphs.constEnd(), d->buffer->glyphs.begin() + text.glyphOffset);
+        d->buffer->glyphPositions.resize(text.glyphOffset + text.glyphCount);
+        std::copy(positions.constBegin(), positions.constEnd(),
+                  d->buffer->glyphPositions.begin() + text.glyphOffset);
+    }
+#endif
+
+    const qreal ascent = si.ascent.toReal();
+    const qreal height = (si.ascent + si.descent).toReal();
+    const qreal width = qMax(si.width.toReal(), text.justificationWidth);
+    // Leave room for italic overhang and glyphs exceeding the font metrics
+    const QRectF bounds = QRectF(p.x(), p.y() - ascent, width, height).adjusted(-height, -height, height, height);
+
+    const int offset = d->buffer->texts.size();
+    d->buffer->texts.append(text);
+    d->record(QPaintBufferCommand::DrawText, bounds, false, offset, 1);
+}
+
+void QPaintBufferEnginePrivate::changed(QPaintBufferState::Group group)
+{
+    state.serials[group] = ++serial;
+    stateDirty = true;
+}
+
+static QPaintBufferBounds qt_clipBounds(const QPaintBufferState &state)
+{
+    if (!state.clipEnabled)
+        return QPaintBufferBounds::unbounded();
+
+    QPaintBufferBounds bounds = QPaintBufferBounds::unbounded();
+    for (const QPainterClipInfo &info : state.clipInfo) {
+        if (info.operation == Qt::NoClip)
+            continue;
+        QRectF rect;
+        switch (info.clipType) {
+        case QPainterClipInfo::RegionClip:
+            rect = QRectF(info.region.boundingRect());
+            break;
+        case QPainterClipInfo::PathClip:
+            rect = info.path.controlPointRect();
+            break;
+        case QPainterClipInfo::RectClip:
+            rect = QRectF(info.rect);
+            break;
+        case QPainterClipInfo::RectFClip:
+            rect = info.rectf;
+            break;
+        }
+        if (!info.matrix.isAffine())
+            continue;
+        const QPaintBufferBounds clip = QPaintBufferBounds::fromRect(info.matrix.mapRect(rect));
+        bounds.left = qMax(bounds.left, clip.left);
+        bounds.top = qMax(bounds.top, clip.top);
+        bounds.right = qMin(bounds.right, clip.right);
+        bounds.bottom = qMin(bounds.bottom, clip.bottom);
+    }
+    return bounds;
+}
+
+/*
+    Records the pending state if it differs from the last recorded one.
+    Groups that were changed and changed back keep their old serial, so
+    they are not applied again when replaying.
+*/
+void QPaintBufferEnginePrivate::flushState()
+{
+    if (clipDirty) {
+        // QPainter keeps the full clip history of its state, replaying it
+        // keeps every operation and transform intact
+        Q_Q(QPaintBufferEngine);
+        const QPainterState *s = QPainterPrivate::get(q->painter())->state;
+        state.clipEnabled = s->clipEnabled;
+        state.clipInfo = s->clipInfo;
+        state.clipBounds = qt_clipBounds(state);
+        changed(QPaintBufferState::ClipGroup);
+        clipDirty = false;
+    }
+
+    if (!stateDirty)
+        return;
+    stateDirty = false;
+
+    if (!buffer->states.isEmpty()) {
+        const QPaintBufferState &last = buffer->states.constLast();
+        uint *serials = state.serials;
+        const uint *lastSerials = last.serials;
+        if (serials[QPaintBufferState::PenGroup] != lastSerials[QPaintBufferState::PenGroup]
+            && state.pen == last.pen) {
+            serials[QPaintBufferState::PenGroup] = lastSerials[QPaintBufferState::PenGroup];
+        }
+        if (serials[QPaintBufferState::BrushGroup] != lastSerials[QPaintBufferState::BrushGroup]
+            && state.brush == last.brush && state.brushOrigin == last.brushOrigin) {
+            serials[QPaintBufferState::BrushGroup] = lastSerials[QPaintBufferState::BrushGroup];
+        }
+        if (serials[QPaintBufferState::BackgroundGroup] != lastSerials[QPaintBufferState::BackgroundGroup]
+            && state.background == last.background && state.backgroundMode == last.backgroundMode) {
+            serials[QPaintBufferState::BackgroundGroup] = lastSerials[QPaintBufferState::BackgroundGroup];
+        }
+        if (serials[QPaintBufferState::TransformGroup] != lastSerials[QPaintBufferState::TransformGroup]
+            && state.matrix == last.matrix) {
+            serials[QPaintBufferState::TransformGroup] = lastSerials[QPaintBufferState::TransformGroup];
+        }
+        if (serials[QPaintBufferState::HintsGroup] != lastSerials[QPaintBufferState::HintsGroup]
+            && state.renderHints == last.renderHints) {
+            serials[QPaintBufferState::HintsGroup] = lastSerials[QPaintBufferState::HintsGroup];
+        }
+        if (serials[QPaintBufferState::CompositionModeGroup] != lastSerials[QPaintBufferState::CompositionModeGroup]
+            && state.compositionMode == last.compositionMode) {
+            serials[QPaintBufferState::CompositionModeGroup] = lastSerials[QPaintBufferState::CompositionModeGroup];
+        }
+        if (serials[QPaintBufferState::OpacityGroup] != lastSerials[QPaintBufferState::OpacityGroup]
+            && state.opacity == last.opacity) {
+            serials[QPaintBufferState::OpacityGroup] = lastSerials[QPaintBufferState::OpacityGroup];
+        }
+        if (std::equal(serials, serials + QPaintBufferState::GroupCount, lastSerials))
+            return;
+    }
+
+    buffer->states.append(state);
+}
+
+/*
+    Returns the bounds of \a rect drawn with the current state in buffer
+    coordinates, including the pen if \a stroked is true. Cosmetic pens
+    scale with the device the buffer is played on and only widen the
+    device margin of the buffer.
+*/
+QPaintBufferBounds QPaintBufferEnginePrivate::commandBounds(const QRectF &rect, bool stroked)
+{
+    if (!state.matrix.isAffine())
+        return QPaintBufferBounds::unbounded();
+
+    qreal logicalMargin = 0;
+    if (stroked && state.pen.style() != Qt::NoPen) {
+        const qreal halfWidth = qMax<qreal>(state.pen.widthF(), 1) / 2;
+        // Miter joins may reach out further than square caps
+        qreal extent = halfWidth * M_SQRT2;
+        if (state.pen.joinStyle() == Qt::MiterJoin || state.pen.joinStyle() == Qt::SvgMiterJoin)
+            extent = qMax(extent, halfWidth * state.pen.miterLimit());
+        if (state.pen.isCosmetic())
+            buffer->deviceMargin = qMax(buffer->deviceMargin, 2 + extent);
+        else
+            logicalMargin = extent;
+    }
+
+    QPaintBufferBounds bounds = QPaintBufferBounds::fromRect(
+        state.matrix.mapRect(rect.adjusted(-logicalMargin, -logicalMargin, logicalMargin, logicalMargin)));
+
+    // Commands next to the clip may still bleed into it, so only the
+    // overlapping part is narrowed down
+    if (state.clipEnabled && bounds.intersects(state.clipBounds)) {
+        bounds.left = qMax(bounds.left, state.clipBounds.left);
+        bounds.top = qMax(bounds.top, state.clipBounds.top);
+        bounds.right = qMin(bounds.right, state.clipBounds.right);
+        bounds.bottom = qMin(bounds.bottom, state.clipBounds.bottom);
+    }
+    return bounds;
+}
+
+void QPaintBufferEnginePrivate::record(QPaintBufferCommand::Type type, const QRectF &rect, bool stroked,
+                                       int offset, int count, int extra)
+{
+    flushState();
+
+    QPaintBufferCommand command;
+    command.type = type;
+    command.state = buffer->states.size() - 1;
+    command.offset = offset;
+    command.count = count;
+    command.extra = extra;
+    command.bounds = commandBounds(rect, stroked);
+    buffer->addCommand(command);
+}
+
+int QPaintBufferEnginePrivate::pixmapIndex(const QPixmap &pixmap)
+{
+    // Icons and sprites are drawn many times, keep one copy of them
+    const qint64 key = pixmap.cacheKey();
+    const auto it = pixmapIndexes.constFind(key);
+    if (it != pixmapIndexes.constEnd())
+        return it.value();
+    const int index = buffer->pixmaps.size();
+    buffer->pixmaps.append(pixmap);
+    pixmapIndexes.insert(key, index);
+    return index;
+}
+
+int QPaintBufferEnginePrivate::imageIndex(const QImage &image)
+{
+    const qint64 key = image.cacheKey();
+    const auto it = imageIndexes.constFind(key);
+    if (it != imageIndexes.constEnd())
+        return it.value();
+    const int index = buffer->images.size();
+    buffer->images.append(image);
+    imageIndexes.insert(key, index);
+    return index;
+}
+
+QT_END_NAMESPACE
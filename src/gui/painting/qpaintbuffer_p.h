@@ -0,0 +1,299 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtGui module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QPAINTBUFFER_P_H
+#define QPAINTBUFFER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include "qpaintbuffer.h"
+#include <QtGui/qfont.h>
+#include <QtGui/qimage.h>
+#include <QtGui/qpaintengine.h>
+#include <QtGui/qpainter.h>
+#include <QtGui/qpainterpath.h>
+#include <QtGui/qpixmap.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qline.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qvector.h>
+#include <private/qfixed_p.h>
+#include <private/qpaintengine_p.h>
+#include <private/qpainter_p.h>
+
+QT_BEGIN_NAMESPACE
+
+class QFontEngine;
+class QPaintBufferEngine;
+class QThread;
+
+// Bounds are kept in single precision, a box with left > right is empty
+struct QPaintBufferBounds
+{
+    float left;
+    float top;
+    float right;
+    float bottom;
+
+    static QPaintBufferBounds empty();
+    static QPaintBufferBounds unbounded();
+    static QPaintBufferBounds fromRect(const QRectF &rect);
+
+    bool isEmpty() const { return left > right || top > bottom; }
+    bool intersects(const QPaintBufferBounds &other) const
+    {
+        return left <= other.right && other.left <= right
+            && top <= other.bottom && other.top <= bottom;
+    }
+    void unite(const QPaintBufferBounds &other)
+    {
+        left = qMin(left, other.left);
+        top = qMin(top, other.top);
+        right = qMax(right, other.right);
+        bottom = qMax(bottom, other.bottom);
+    }
+};
+Q_DECLARE_TYPEINFO(QPaintBufferBounds, Q_PRIMITIVE_TYPE);
+
+// A recorded draw call. The geometry lives in the typed vector of
+// QPaintBufferPrivate that belongs to the command type, starting at offset.
+struct QPaintBufferCommand
+{
+    enum Type {
+        DrawRects,          // rects
+        DrawRectsF,         // rectFs
+        DrawLines,          // lines
+        DrawLinesF,         // lineFs
+        DrawPoints,         // points
+        DrawPointsF,        // pointFs
+        DrawPolygon,        // points, extra is the PolygonDrawMode
+        DrawPolygonF,       // pointFs, extra is the PolygonDrawMode
+        DrawEllipse,        // rects
+        DrawEllipseF,       // rectFs
+        DrawPath,           // paths
+        DrawPixmap,         // target and source in rectFs, extra indexes pixmaps
+        DrawTiledPixmap,    // target in rectFs, count indexes the offset in pointFs,
+                            // extra indexes pixmaps
+        DrawImage,          // target and source in rectFs, extra indexes images,
+                            // count holds the conversion flags
+        DrawText            // texts
+    };
+
+    Type type;
+    int state;
+    int offset;
+    int count;
+    int extra;
+    QPaintBufferBounds bounds;
+};
+Q_DECLARE_TYPEINFO(QPaintBufferCommand, Q_PRIMITIVE_TYPE);
+
+// The painter state a range of commands is drawn with. Every group has a
+// serial that changes with its value, so replaying only compares integers.
+struct QPaintBufferState
+{
+    enum Group {
+        PenGroup,
+        BrushGroup,
+        BackgroundGroup,
+        TransformGroup,
+        ClipGroup,
+        HintsGroup,
+        CompositionModeGroup,
+        OpacityGroup,
+        GroupCount
+    };
+
+    QPaintBufferState();
+
+    QPen pen;
+    QBrush brush;
+    QPointF brushOrigin;
+    QBrush background;
+    Qt::BGMode backgroundMode;
+    QTransform matrix;
+    bool clipEnabled;
+    QVector<QPainterClipInfo> clipInfo;
+    QPaintBufferBounds clipBounds;
+    QPainter::RenderHints renderHints;
+    QPainter::CompositionMode compositionMode;
+    qreal opacity;
+
+    uint serials[GroupCount];
+};
+
+// Text is kept both as shaped glyphs, which are only valid on the thread
+// owning the font engine, and as a string for replaying on other threads.
+struct QPaintBufferText
+{
+    QPaintBufferText();
+    QPaintBufferText(const QPaintBufferText &other);
+    ~QPaintBufferText();
+    QPaintBufferText &operator=(const QPaintBufferText &other);
+
+    void setFontEngine(QFontEngine *engine);
+
+    QFontEngine *fontEngine;
+    int glyphOffset;
+    int glyphCount;
+
+    QPointF position;
+    QString text;
+    QFont font;
+    qreal justificationWidth;
+};
+
+class QPaintBufferPrivate : public QSharedData
+{
+public:
+    // Commands are culled in blocks before they are tested one by one
+    enum { BlockSize = 64 };
+
+    QPaintBufferPrivate();
+    QPaintBufferPrivate(const QPaintBufferPrivate &other);
+    ~QPaintBufferPrivate();
+
+    static QPaintBufferPrivate *get(QPaintBuffer *buffer) { return buffer->d_ptr.data(); }
+    static const QPaintBufferPrivate *get(const QPaintBuffer *buffer) { return buffer->d_ptr.data(); }
+
+    void clear();
+    void addCommand(const QPaintBufferCommand &command);
+
+    void play(QPainter *painter, const QRectF *exposed, int exposedCount) const;
+
+    QVector<QPaintBufferCommand> commands;
+    QVector<QPaintBufferBounds> blockBounds;
+    QVector<QPaintBufferState> states;
+
+    QVector<QRect> rects;
+    QVector<QRectF> rectFs;
+    QVector<QLine> lines;
+    QVector<QLineF> lineFs;
+    QVector<QPoint> points;
+    QVector<QPointF> pointFs;
+    QVector<QPainterPath> paths;
+    QVector<QPixmap> pixmaps;
+    QVector<QImage> images;
+    QVector<QPaintBufferText> texts;
+    QVector<quint32> glyphs;
+    QVector<QFixedPoint> glyphPositions;
+
+    QPaintBufferBounds bounds;
+    // Device pixels the commands may reach beyond their bounds at any scale
+    qreal deviceMargin;
+    QThread *thread;
+
+    QScopedPointer<QPaintBufferEngine> engine;
+};
+
+class QPaintBufferEnginePrivate;
+
+class QPaintBufferEngine : public QPaintEngine
+{
+    Q_DECLARE_PRIVATE(QPaintBufferEngine)
+public:
+    QPaintBufferEngine();
+    ~QPaintBufferEngine();
+
+    bool begin(QPaintDevice *pdev) Q_DECL_OVERRIDE;
+    bool end() Q_DECL_OVERRIDE;
+
+    void updateState(const QPaintEngineState &state) Q_DECL_OVERRIDE;
+
+    void drawRects(const QRect *rects, int rectCount) Q_DECL_OVERRIDE;
+    void drawRects(const QRectF *rects, int rectCount) Q_DECL_OVERRIDE;
+    void drawLines(const QLine *lines, int lineCount) Q_DECL_OVERRIDE;
+    void drawLines(const QLineF *lines, int lineCount) Q_DECL_OVERRIDE;
+    void drawEllipse(const QRect &rect) Q_DECL_OVERRIDE;
+    void drawEllipse(const QRectF &rect) Q_DECL_OVERRIDE;
+    void drawPath(const QPainterPath &path) Q_DECL_OVERRIDE;
+    void drawPoints(const QPoint *points, int pointCount) Q_DECL_OVERRIDE;
+    void drawPoints(const QPointF *points, int pointCount) Q_DECL_OVERRIDE;
+    void drawPolygon(const QPoint *points, int pointCount, PolygonDrawMode mode) Q_DECL_OVERRIDE;
+    void drawPolygon(const QPointF *points, int pointCount, PolygonDrawMode mode) Q_DECL_OVERRIDE;
+
+    void drawPixmap(const QRectF &r, const QPixmap &pm, const QRectF &sr) Q_DECL_OVERRIDE;
+    void drawTiledPixmap(const QRectF &r, const QPixmap &pixmap, const QPointF &s) Q_DECL_OVERRIDE;
+    void drawImage(const QRectF &r, const QImage &image, const QRectF &sr,
+                   Qt::ImageConversionFlags flags = Qt::AutoColor) Q_DECL_OVERRIDE;
+    void drawTextItem(const QPointF &p, const QTextItem &ti) Q_DECL_OVERRIDE;
+
+    Type type() const Q_DECL_OVERRIDE { return PaintBuffer; }
+
+private:
+    Q_DISABLE_COPY(QPaintBufferEngine)
+};
+
+class QPaintBufferEnginePrivate : public QPaintEnginePrivate
+{
+    Q_DECLARE_PUBLIC(QPaintBufferEngine)
+public:
+    QPaintBufferEnginePrivate() : buffer(0), serial(0), stateDirty(true), clipDirty(false) {}
+
+    QPaintBufferBounds commandBounds(const QRectF &rect, bool stroked);
+    void record(QPaintBufferCommand::Type type, const QRectF &rect, bool stroked,
+                int offset, int count, int extra = 0);
+    void changed(QPaintBufferState::Group group);
+    void flushState();
+    int pixmapIndex(const QPixmap &pixmap);
+    int imageIndex(const QImage &image);
+
+    QPaintBufferPrivate *buffer;
+    QPaintBufferState state;
+    uint serial;
+    bool stateDirty;
+    bool clipDirty;
+    QHash<qint64, int> pixmapIndexes;
+    QHash<qint64, int> imageIndexes;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPAINTBUFFER_P_H
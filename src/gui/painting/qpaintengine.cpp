@@ -386,7 +386,7 @@ void QPaintEngine::drawPolygon(const QPoint *points, int pointCount, PolygonDraw
     \value User First user type ID
     \value MaxUser Last user type ID
     \value OpenGL2
-    \value PaintBuffer
+    \value PaintBuffer QPaintBuffer recording engine
     \value Blitter
     \value Direct2D Windows only, Direct2D based engine
 */
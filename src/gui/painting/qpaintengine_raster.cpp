@@ -39,6 +39,8 @@
 
 #include <QtCore/qglobal.h>
 #include <QtCore/qmutex.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qthreadstorage.h>
 
 #define QT_FT_BEGIN_HEADER
 #define QT_FT_END_HEADER
@@ -569,6 +571,19 @@ QSize QRasterPaintEngine::size() const
     return QSize(d->rasterBuffer->width(), d->rasterBuffer->height());
 }
 
+/*!
+    \internal
+
+    Makes wide lines cover the same pixels regardless of the clip, at a
+    small cost for lines that are mostly clipped away. QTiledPaintEngine
+    needs this for the tiles to match painting the whole image at once.
+*/
+void QRasterPaintEngine::setClipIndependentLines(bool enabled)
+{
+    Q_D(QRasterPaintEngine);
+    d->rasterizer->setClipIndependentLines(enabled);
+}
+
 /*!
     \internal
 */
@@ -1069,6 +1084,7 @@ void QRasterPaintEnginePrivate::systemStateChanged()
 #endif
 
     exDeviceRect = deviceRect;
+    rasterizer->setDeviceRect(deviceRectUnclipped);
 
     Q_Q(QRasterPaintEngine);
     if (q->state()) {
@@ -3152,6 +3168,235 @@ void QRasterPaintEngine::drawPoints(const QPoint *points, int pointCount)
     stroker.drawPoints(points, pointCount);
 }
 
+extern "C" {
+    int q_gray_rendered_spans(QT_FT_Raster raster);
+}
+
+static inline uchar *alignAddress(uchar *address, quintptr alignmentMask)
+{
+    return (uchar *)(((quintptr)address + alignmentMask) & ~alignmentMask);
+}
+
+/*
+    Renders \a outline antialiased with the gray raster, calling \a callback
+    with the spans inside \a clipRect. The raster is recreated with a larger
+    pool when the outline is too complex for the current one.
+*/
+static void qt_rasterizeGray(QT_FT_Raster *grayRaster, QT_FT_Outline *outline,
+                             ProcessSpans callback, void *userData, const QRect &clipRect)
+{
+    // Initial size for raster pool is MINIMUM_POOL_SIZE so as to
+    // minimize memory reallocations. However if initial size for
+    // raster pool is changed for lower value, reallocations will
+    // occur normally.
+    int rasterPoolSize = MINIMUM_POOL_SIZE;
+    uchar rasterPoolOnStack[MINIMUM_POOL_SIZE + 0xf];
+    uchar *rasterPoolBase = alignAddress(rasterPoolOnStack, 0xf);
+    uchar *rasterPoolOnHeap = 0;
+
+    qt_ft_grays_raster.raster_reset(*grayRaster, rasterPoolBase, rasterPoolSize);
+
+    void *data = userData;
+
+    QT_FT_BBox clip_box = { clipRect.x(),
+                            clipRect.y(),
+                            clipRect.x() + clipRect.width(),
+                            clipRect.y() + clipRect.height() };
+
+    QT_FT_Raster_Params rasterParams;
+    rasterParams.target = 0;
+    rasterParams.source = outline;
+    rasterParams.flags = QT_FT_RASTER_FLAG_CLIP;
+    rasterParams.gray_spans = 0;
+    rasterParams.black_spans = 0;
+    rasterParams.bit_test = 0;
+    rasterParams.bit_set = 0;
+    rasterParams.user = data;
+    rasterParams.clip_box = clip_box;
+
+    bool done = false;
+    int error;
+
+    int rendered_spans = 0;
+
+    while (!done) {
+
+        rasterParams.flags |= (QT_FT_RASTER_FLAG_AA | QT_FT_RASTER_FLAG_DIRECT);
+        rasterParams.gray_spans = callback;
+        rasterParams.skip_spans = rendered_spans;
+        error = qt_ft_grays_raster.raster_render(*grayRaster, &rasterParams);
+
+        // Out of memory, reallocate some more and try again...
+        if (error == -6) { // ErrRaster_OutOfMemory from qgrayraster.c
+            rasterPoolSize *= 2;
+            if (rasterPoolSize > 1024 * 1024) {
+                qWarning("QPainter: Rasterization of primitive failed");
+                break;
+            }
+
+            rendered_spans += q_gray_rendered_spans(*grayRaster);
+
+            free(rasterPoolOnHeap);
+            rasterPoolOnHeap = (uchar *)malloc(rasterPoolSize + 0xf);
+
+            Q_CHECK_PTR(rasterPoolOnHeap); // note: we just freed the old rasterPoolBase. I hope it's not fatal.
+
+            rasterPoolBase = alignAddress(rasterPoolOnHeap, 0xf);
+
+            qt_ft_grays_raster.raster_done(*grayRaster);
+            qt_ft_grays_raster.raster_new(grayRaster);
+            qt_ft_grays_raster.raster_reset(*grayRaster, rasterPoolBase, rasterPoolSize);
+        } else {
+            done = true;
+        }
+    }
+
+    free(rasterPoolOnHeap);
+}
+
+/*
+    Large batches of lines, polylines and paths are rendered in horizontal
+    bands of the device, one task per band. Every band renders all the
+    primitives that touch it in their original order, but only produces spans
+    for its own scanlines. The blend functions only write to the scanlines of
+    the spans they are given, so the bands never share pixels and the result
+    is the same as rendering the primitives one after the other.
+*/
+static int qt_rasterParallelThreshold()
+{
+    static const int threshold = qEnvironmentVariableIsSet("QT_RASTER_PARALLEL_THRESHOLD")
+            ? qEnvironmentVariableIntValue("QT_RASTER_PARALLEL_THRESHOLD")
+            : 4096;
+    return threshold;
+}
+
+class QRasterBands
+{
+public:
+    QRasterBands(const QRect &rect, int count)
+        : m_rect(rect),
+          m_bandHeight((rect.height() + count - 1) / count),
+          m_items(count)
+    {
+    }
+
+    int count() const { return m_items.size(); }
+    const QVector<int> &items(int band) const { return m_items.at(band); }
+
+    QRect band(int band) const
+    {
+        const int top = m_rect.top() + band * m_bandHeight;
+        return QRect(m_rect.left(), top, m_rect.width(), qMin(m_bandHeight, m_rect.bottom() + 1 - top));
+    }
+
+    // Adds an item covering the device scanlines top to bottom. Antialiasing,
+    // caps and rounding may reach a little further, so the range is widened.
+    void addItem(int item, qreal top, qreal bottom)
+    {
+        const qreal minY = m_rect.top();
+        const qreal maxY = m_rect.bottom();
+        top = qBound(minY, top - 2, maxY + 1);
+        bottom = qBound(minY - 1, bottom + 2, maxY);
+        if (!(top <= bottom))
+            return;
+        const int first = (int(top) - m_rect.top()) / m_bandHeight;
+        const int last = qMin((int(bottom) - m_rect.top()) / m_bandHeight, count() - 1);
+        for (int band = first; band <= last; ++band)
+            m_items[band].append(item);
+    }
+
+private:
+    QRect m_rect;
+    int m_bandHeight;
+    QVector<QVector<int> > m_items;
+};
+
+struct QRasterBandFilter
+{
+    ProcessSpans blend;
+    void *data;
+    int top;
+    int bottom;
+};
+
+static void qt_span_fill_band(int count, const QSpan *spans, void *userData)
+{
+    const QRasterBandFilter *filter = reinterpret_cast<const QRasterBandFilter *>(userData);
+    const QSpan *end = spans + count;
+    while (spans < end) {
+        while (spans < end && (spans->y < filter->top || spans->y > filter->bottom))
+            ++spans;
+        const QSpan *first = spans;
+        while (spans < end && spans->y >= filter->top && spans->y <= filter->bottom)
+            ++spans;
+        if (spans > first)
+            filter->blend(spans - first, first, filter->data);
+    }
+}
+
+/*
+    Returns the number of bands \a itemCount primitives filled with \a data
+    should be rendered in, or 0 if they should be rendered serially.
+*/
+int QRasterPaintEnginePrivate::rasterBandCount(const QSpanData *data, int itemCount) const
+{
+#ifndef QT_NO_THREAD
+    const int threshold = qt_rasterParallelThreshold();
+    if (threshold <= 0 || itemCount < threshold)
+        return 0;
+
+    // Complex clips set up their scanlines lazily while blending.
+    const QClipData *c = clip();
+    if (c && !c->hasRectClip)
+        return 0;
+
+    // qt_gradient_quint16() temporarily changes the span data.
+    if (data->type >= QSpanData::LinearGradient && data->type <= QSpanData::ConicalGradient
+        && rasterBuffer->format == QImage::Format_RGB16)
+        return 0;
+
+    const int threads = QThreadPool::globalInstance()->maxThreadCount();
+    if (threads < 2)
+        return 0;
+
+    // Several bands per thread balance primitives that are not spread evenly.
+    const int bandCount = qMin(threads * 4, deviceRect.height() / 16);
+    return bandCount < 2 ? 0 : bandCount;
+#else
+    Q_UNUSED(data)
+    Q_UNUSED(itemCount)
+    return 0;
+#endif
+}
+
+template <typename Line>
+static void qt_drawCosmeticLines(QRasterPaintEnginePrivate *d, QRasterPaintEngineState *s,
+                                 const Line *lines, int lineCount)
+{
+    const int bandCount = d->rasterBandCount(&s->penData, lineCount);
+    if (!bandCount) {
+        QCosmeticStroker stroker(s, d->deviceRect, d->deviceRectUnclipped);
+        stroker.setLegacyRoundingEnabled(s->flags.legacy_rounding);
+        stroker.drawLines(lines, lineCount);
+        return;
+    }
+
+    QRasterBands bands(d->deviceRect, bandCount);
+    for (int i = 0; i < lineCount; ++i) {
+        const qreal y1 = s->matrix.map(QPointF(lines[i].p1())).y();
+        const qreal y2 = s->matrix.map(QPointF(lines[i].p2())).y();
+        bands.addItem(i, qMin(y1, y2), qMax(y1, y2));
+    }
+
+    qt_imageProcessTasks(bands.count(), QThreadPool::globalInstance(), [&](int band) {
+        QCosmeticStroker stroker(s, bands.band(band), d->deviceRectUnclipped);
+        stroker.setLegacyRoundingEnabled(s->flags.legacy_rounding);
+        for (int i : bands.items(band))
+            stroker.addLine(lines[i].p1(), lines[i].p2());
+        stroker.flush();
+    });
+}
+
 /*!
     \reimp
 */
@@ -3168,12 +3413,7 @@ void QRasterPaintEngine::drawLines(const QLine *lines, int lineCount)
         return;
 
     if (s->flags.fast_pen) {
-        QCosmeticStroker stroker(s, d->deviceRect, d->deviceRectUnclipped);
-        stroker.setLegacyRoundingEnabled(s->flags.legacy_rounding);
-        for (int i=0; i<lineCount; ++i) {
-            const QLine &l = lines[i];
-            stroker.drawLine(l.p1(), l.p2());
-        }
+        qt_drawCosmeticLines(d, s, lines, lineCount);
     } else {
         QPaintEngineEx::drawLines(lines, lineCount);
     }
@@ -3240,17 +3480,133 @@ void QRasterPaintEngine::drawLines(const QLineF *lines, int lineCount)
     if (!s->penData.blend)
         return;
     if (s->flags.fast_pen) {
-        QCosmeticStroker stroker(s, d->deviceRect, d->deviceRectUnclipped);
-        stroker.setLegacyRoundingEnabled(s->flags.legacy_rounding);
-        for (int i=0; i<lineCount; ++i) {
-            QLineF line = lines[i];
-            stroker.drawLine(line.p1(), line.p2());
-        }
+        qt_drawCosmeticLines(d, s, lines, lineCount);
     } else {
         QPaintEngineEx::drawLines(lines, lineCount);
     }
 }
 
+/*!
+    \internal
+
+    Draws the \a polylineCount polylines in \a polylines with the current
+    pen. Large batches drawn with a cosmetic pen are rasterized in parallel.
+*/
+void QRasterPaintEngine::drawPolylines(const QPolygonF *polylines, int polylineCount)
+{
+    Q_D(QRasterPaintEngine);
+    QRasterPaintEngineState *s = state();
+
+    ensurePen();
+    if (!s->penData.blend)
+        return;
+
+    const int bandCount = s->flags.fast_pen ? d->rasterBandCount(&s->penData, polylineCount) : 0;
+    if (!bandCount) {
+        for (int i = 0; i < polylineCount; ++i)
+            drawPolygon(polylines[i].constData(), polylines[i].size(), PolylineMode);
+        return;
+    }
+
+    QRasterBands bands(d->deviceRect, bandCount);
+    for (int i = 0; i < polylineCount; ++i) {
+        const QRectF bounds = s->matrix.mapRect(polylines[i].boundingRect());
+        bands.addItem(i, bounds.top(), bounds.bottom());
+    }
+
+    const uint flags = QVectorPath::polygonFlags(PolylineMode);
+    qt_imageProcessTasks(bands.count(), QThreadPool::globalInstance(), [&](int band) {
+        QCosmeticStroker stroker(s, bands.band(band), d->deviceRectUnclipped);
+        stroker.setLegacyRoundingEnabled(s->flags.legacy_rounding);
+        for (int i : bands.items(band)) {
+            const QPolygonF &polyline = polylines[i];
+            stroker.drawPath(QVectorPath(reinterpret_cast<const qreal *>(polyline.constData()),
+                                         polyline.size(), 0, flags));
+        }
+    });
+}
+
+/*!
+    \internal
+
+    Fills the \a pathCount paths in \a paths with the current brush, like
+    fill() does for paths without shape hints. Large batches are rasterized
+    in parallel.
+*/
+void QRasterPaintEngine::fillPaths(const QPainterPath *paths, int pathCount)
+{
+    Q_D(QRasterPaintEngine);
+    QRasterPaintEngineState *s = state();
+
+    ensureBrush();
+    QSpanData *fillData = &s->brushData;
+    if (!fillData->blend)
+        return;
+
+    ensureOutlineMapper();
+
+    const int bandCount = d->rasterBandCount(fillData, pathCount);
+    QRasterBands bands(d->deviceRect, qMax(bandCount, 1));
+    QVector<QRect> deviceRects(pathCount);
+    for (int i = 0; i < pathCount; ++i) {
+        if (paths[i].isEmpty())
+            continue;
+        const QRectF bounds = s->matrix.mapRect(paths[i].controlPointRect());
+        deviceRects[i] = bounds.toRect();
+        // Skip paths that by conservative estimates are completely outside the paint device.
+        if (deviceRects.at(i).intersects(d->deviceRect))
+            bands.addItem(i, bounds.top(), bounds.bottom());
+    }
+
+    // Same choice as initializeRasterizer()
+    QRect clipRect = d->deviceRect;
+    ProcessSpans rasterizerBlend = fillData->unclipped_blend;
+    if (const QClipData *c = d->clip()) {
+        clipRect &= QRect(QPoint(c->xmin, c->ymin), QSize(c->xmax - c->xmin, c->ymax - c->ymin));
+        rasterizerBlend = fillData->blend;
+    }
+
+    QThreadPool *threadPool = bandCount ? QThreadPool::globalInstance() : Q_NULLPTR;
+    qt_imageProcessTasks(bands.count(), threadPool, [&](int band) {
+        const QRect bandRect = bands.band(band);
+
+        QRasterizer rasterizer;
+        rasterizer.setAntialiased(s->flags.antialiased);
+        rasterizer.setLegacyRoundingEnabled(s->flags.legacy_rounding);
+        rasterizer.setDeviceRect(d->deviceRectUnclipped);
+        rasterizer.setClipRect(clipRect & bandRect);
+        rasterizer.initialize(rasterizerBlend, fillData);
+
+        QOutlineMapper outlineMapper;
+        outlineMapper.setMatrix(s->matrix);
+        outlineMapper.m_clip_rect = d->outlineMapper->m_clip_rect;
+
+        QT_FT_Raster grayRaster = 0;
+
+        for (int i : bands.items(band)) {
+            QT_FT_Outline *outline = outlineMapper.convertPath(paths[i]);
+            if (!outline)
+                continue;
+
+            if (!s->flags.antialiased) {
+                rasterizer.rasterize(outline, outline->flags == QT_FT_OUTLINE_NONE
+                                              ? Qt::WindingFill : Qt::OddEvenFill);
+                continue;
+            }
+
+            if (!grayRaster && qt_ft_grays_raster.raster_new(&grayRaster))
+                continue;
+            // The coverage the gray raster computes next to the clip box
+            // depends on it, so clip to the device and drop the other bands.
+            QRasterBandFilter filter = { d->getBrushFunc(deviceRects.at(i), fillData), fillData,
+                                         bandRect.top(), bandRect.bottom() };
+            qt_rasterizeGray(&grayRaster, outline, qt_span_fill_band, &filter, d->deviceRect);
+        }
+
+        if (grayRaster)
+            qt_ft_grays_raster.raster_done(grayRaster);
+    });
+}
 
 /*!
     \reimp
@@ -3532,15 +3888,6 @@ void QRasterPaintEnginePrivate::rasterize(QT_FT_Outline *outline,
     rasterize(outline, callback, (void *)spanData, rasterBuffer);
 }
 
-extern "C" {
-    int q_gray_rendered_spans(QT_FT_Raster raster);
-}
-
-static inline uchar *alignAddress(uchar *address, quintptr alignmentMask)
-{
-    return (uchar *)(((quintptr)address + alignmentMask) & ~alignmentMask);
-}
-
 void QRasterPaintEnginePrivate::rasterize(QT_FT_Outline *outline,
                                           ProcessSpans callback,
                                           void *userData, QRasterBuffer *)
@@ -3565,73 +3912,7 @@ void QRasterPaintEnginePrivate::rasterize(QT_FT_Outline *outline,
         return;
     }
 
-    // Initial size for raster pool is MINIMUM_POOL_SIZE so as to
-    // minimize memory reallocations. However if initial size for
-    // raster pool is changed for lower value, reallocations will
-    // occur normally.
-    int rasterPoolSize = MINIMUM_POOL_SIZE;
-    uchar rasterPoolOnStack[MINIMUM_POOL_SIZE + 0xf];
-    uchar *rasterPoolBase = alignAddress(rasterPoolOnStack, 0xf);
-    uchar *rasterPoolOnHeap = 0;
-
-    qt_ft_grays_raster.raster_reset(*grayRaster.data(), rasterPoolBase, rasterPoolSize);
-
-    void *data = userData;
-
-    QT_FT_BBox clip_box = { deviceRect.x(),
-                            deviceRect.y(),
-                            deviceRect.x() + deviceRect.width(),
-                            deviceRect.y() + deviceRect.height() };
-
-    QT_FT_Raster_Params rasterParams;
-    rasterParams.target = 0;
-    rasterParams.source = outline;
-    rasterParams.flags = QT_FT_RASTER_FLAG_CLIP;
-    rasterParams.gray_spans = 0;
-    rasterParams.black_spans = 0;
-    rasterParams.bit_test = 0;
-    rasterParams.bit_set = 0;
-    rasterParams.user = data;
-    rasterParams.clip_box = clip_box;
-
-    bool done = false;
-    int error;
-
-    int rendered_spans = 0;
-
-    while (!done) {
-
-        rasterParams.flags |= (QT_FT_RASTER_FLAG_AA | QT_FT_RASTER_FLAG_DIRECT);
-        rasterParams.gray_spans = callback;
-        rasterParams.skip_spans = rendered_spans;
-        error = qt_ft_grays_raster.raster_render(*grayRaster.data(), &rasterParams);
-
-        // Out of memory, reallocate some more and try again...
-        if (error == -6) { // ErrRaster_OutOfMemory from qgrayraster.c
-            rasterPoolSize *= 2;
-            if (rasterPoolSize > 1024 * 1024) {
-                qWarning("QPainter: Rasterization of primitive failed");
-                break;
-            }
-
-            rendered_spans += q_gray_rendered_spans(*grayRaster.data());
-
-            free(rasterPoolOnHeap);
-            rasterPoolOnHeap = (uchar *)malloc(rasterPoolSize + 0xf);
-
-            Q_CHECK_PTR(rasterPoolOnHeap); // note: we just freed the old rasterPoolBase. I hope it's not fatal.
-
-            rasterPoolBase = alignAddress(rasterPoolOnHeap, 0xf);
-
-            qt_ft_grays_raster.raster_done(*grayRaster.data());
-            qt_ft_grays_raster.raster_new(grayRaster.data());
-            qt_ft_grays_raster.raster_reset(*grayRaster.data(), rasterPoolBase, rasterPoolSize);
-        } else {
-            done = true;
-        }
-    }
-
-    free(rasterPoolOnHeap);
+    qt_rasterizeGray(grayRaster.data(), outline, callback, userData, deviceRect);
 }
 
 void QRasterPaintEnginePrivate::recalculateFastImages()
@@ -4180,68 +4461,120 @@ void QRasterBuffer::flushToARGBImage(QImage *target) const
 }
 
 
+/*
+    Process-wide cache of gradient color tables.
+
+    Entries are keyed on the complete list of stops and the interpolation
+    mode. Opacity is normally applied when blending (see QGradientData's
+    const_alpha) and therefore is not part of the table, so the same table
+    is shared by every painter, thread and opacity level that uses the
+    gradient. Only composition modes for which scaling the coverage is not
+    equivalent to scaling the source need their own opacity-baked tables.
+
+    Lookups first go to a small per-thread table, which makes repeated
+    lookups of hot gradients lock-free; the shared table behind it is
+    protected by a mutex and evicts the least recently used entry.
+*/
 class QGradientCache
 {
 public:
     struct CacheInfo : QSpanData::Pinnable
     {
-        inline CacheInfo(QGradientStops s, int op, QGradient::InterpolationMode mode) :
-            stops(qMove(s)), opacity(op), interpolationMode(mode) {}
+        inline CacheInfo(QGradientStops s, int op, QGradient::InterpolationMode mode, uint h) :
+            stops(qMove(s)), opacity(op), interpolationMode(mode), hash(h) {}
         QRgba64 buffer64[GRADIENT_STOPTABLE_SIZE];
         QRgb buffer32[GRADIENT_STOPTABLE_SIZE];
         QGradientStops stops;
         int opacity;
         QGradient::InterpolationMode interpolationMode;
-    };
-
-    typedef QMultiHash<quint64, QSharedPointer<const CacheInfo>> QGradientColorTableHash;
-
-    inline QSharedPointer<const CacheInfo> getBuffer(const QGradient &gradient, int opacity) {
-        quint64 hash_val = 0;
-
-        const QGradientStops stops = gradient.stops();
-        for (int i = 0; i < stops.size() && i <= 2; i++)
-            hash_val += stops[i].second.rgba64();
+        uint hash;
 
-        QMutexLocker lock(&mutex);
-        QGradientColorTableHash::const_iterator it = cache.constFind(hash_val);
+        inline bool matches(const QGradientStops &s, int op, QGradient::InterpolationMode mode) const
+        { return opacity == op && interpolationMode == mode && stops == s; }
+    };
 
-        if (it == cache.constEnd())
-            return addCacheElement(hash_val, gradient, opacity);
-        else {
-            do {
-                const auto &cache_info = it.value();
-                if (cache_info->stops == stops && cache_info->opacity == opacity && cache_info->interpolationMode == gradient.interpolationMode())
-                    return cache_info;
-                ++it;
-            } while (it != cache.constEnd() && it.key() == hash_val);
-            // an exact match for these stops and opacity was not found, create new cache
-            return addCacheElement(hash_val, gradient, opacity);
-        }
-    }
+    QSharedPointer<const CacheInfo> getBuffer(const QGradient &gradient, int opacity);
 
     inline int paletteSize() const { return GRADIENT_STOPTABLE_SIZE; }
 protected:
-    inline int maxCacheSize() const { return 60; }
+    enum { ThreadCacheSize = 8 };
+    struct ThreadCache {
+        QSharedPointer<const CacheInfo> entries[ThreadCacheSize];
+    };
+    struct CacheSlot {
+        QSharedPointer<const CacheInfo> info;
+        quint64 lastUsed;
+    };
+    typedef QMultiHash<uint, CacheSlot> QGradientColorTableHash;
+
+    inline int maxCacheSize() const { return 128; }
+    static uint hashGradient(const QGradientStops &stops, int opacity, QGradient::InterpolationMode mode);
     inline void generateGradientColorTable(const QGradient& g,
                                            QRgba64 *colorTable,
                                            int size, int opacity) const;
-    QSharedPointer<const CacheInfo> addCacheElement(quint64 hash_val, const QGradient &gradient, int opacity) {
-        if (cache.size() == maxCacheSize()) {
-            // may remove more than 1, but OK
-            cache.erase(cache.begin() + (qrand() % maxCacheSize()));
-        }
-        auto cache_entry = QSharedPointer<CacheInfo>::create(gradient.stops(), opacity, gradient.interpolationMode());
-        generateGradientColorTable(gradient, cache_entry->buffer64, paletteSize(), opacity);
-        for (int i = 0; i < GRADIENT_STOPTABLE_SIZE; ++i)
-            cache_entry->buffer32[i] = cache_entry->buffer64[i].toArgb32();
-        return cache.insert(hash_val, cache_entry).value();
-    }
+    QSharedPointer<const CacheInfo> addCacheElement(uint hash_val, const QGradient &gradient, int opacity);
 
     QGradientColorTableHash cache;
+    quint64 useCounter = 0;
     QMutex mutex;
+    QThreadStorage<ThreadCache> threadCache;
 };
 
+uint QGradientCache::hashGradient(const QGradientStops &stops, int opacity, QGradient::InterpolationMode mode)
+{
+    QtPrivate::QHashCombine hash;
+    uint h = hash(hash(0, opacity), int(mode));
+    for (const QGradientStop &stop : stops) {
+        h = hash(h, stop.first);
+        h = hash(h, quint64(stop.second.rgba64()));
+    }
+    return h;
+}
+
+QSharedPointer<const QGradientCache::CacheInfo> QGradientCache::getBuffer(const QGradient &gradient, int opacity)
+{
+    const QGradientStops stops = gradient.stops();
+    const QGradient::InterpolationMode mode = gradient.interpolationMode();
+    const uint hash_val = hashGradient(stops, opacity, mode);
+
+    QSharedPointer<const CacheInfo> &local = threadCache.localData().entries[hash_val % ThreadCacheSize];
+    if (local && local->hash == hash_val && local->matches(stops, opacity, mode))
+        return local;
+
+    QMutexLocker lock(&mutex);
+    for (auto it = cache.find(hash_val); it != cache.end() && it.key() == hash_val; ++it) {
+        if (it->info->matches(stops, opacity, mode)) {
+            it->lastUsed = ++useCounter;
+            local = it->info;
+            return local;
+        }
+    }
+    // an exact match for these stops and opacity was not found, create new cache
+    local = addCacheElement(hash_val, gradient, opacity);
+    return local;
+}
+
+QSharedPointer<const QGradientCache::CacheInfo> QGradientCache::addCacheElement(uint hash_val, const QGradient &gradient, int opacity)
+{
+    if (cache.size() >= maxCacheSize()) {
+        // Tables still referenced by a span data or a thread cache stay
+        // alive through their shared pointer.
+        auto oldest = cache.begin();
+        for (auto it = cache.begin(), end = cache.end(); it != end; ++it) {
+            if (it->lastUsed < oldest->lastUsed)
+                oldest = it;
+        }
+        cache.erase(oldest);
+    }
+    auto cache_entry = QSharedPointer<CacheInfo>::create(gradient.stops(), opacity, gradient.interpolationMode(), hash_val);
+    generateGradientColorTable(gradient, cache_entry->buffer64, paletteSize(), opacity);
+    for (int i = 0; i < GRADIENT_STOPTABLE_SIZE; ++i)
+        cache_entry->buffer32[i] = cache_entry->buffer64[i].toArgb32();
+    CacheSlot slot = { cache_entry, ++useCounter };
+    cache.insert(hash_val, slot);
+    return cache_entry;
+}
+
 void QGradientCache::generateGradientColorTable(const QGradient& gradient, QRgba64 *colorTable, int size, int opacity) const
 {
     const QGradientStops stops = gradient.stops();
@@ -4375,20 +4708,21 @@ void QGradientCache::generateGradientColorTable(const QGradient& gradient, QRgba
         }
 
         qreal diff = stops[current_stop+1].first - stops[current_stop].first;
-        qreal c = (diff == 0) ? qreal(0) : 256 / diff;
+        qreal c = (diff == 0) ? qreal(0) : 65535 / diff;
         t = (dpos - stops[current_stop].first) * c;
         t_delta = incr * c;
 
         while (true) {
             Q_ASSERT(current_stop < stopCount);
 
-            int dist = qRound(t);
-            int idist = 256 - dist;
+            // 16-bit weights keep the 64-bit table exact for RGBA64 targets
+            int dist = qBound(0, qRound(t), 65535);
+            int idist = 65535 - dist;
 
             if (colorInterpolation)
-                colorTable[pos] = interpolate256(current_color, idist, next_color, dist);
+                colorTable[pos] = interpolate65535(current_color, idist, next_color, dist);
             else
-                colorTable[pos] = qPremultiply(interpolate256(current_color, idist, next_color, dist));
+                colorTable[pos] = qPremultiply(interpolate65535(current_color, idist, next_color, dist));
 
             ++pos;
             dpos += incr;
@@ -4417,7 +4751,7 @@ void QGradientCache::generateGradientColorTable(const QGradient& gradient, QRgba
                 }
 
                 qreal diff = stops[current_stop+1].first - stops[current_stop].first;
-                qreal c = (diff == 0) ? qreal(0) : 256 / diff;
+                qreal c = (diff == 0) ? qreal(0) : 65535 / diff;
                 t = (dpos - stops[current_stop].first) * c;
                 t_delta = incr * c;
             }
@@ -4437,6 +4771,19 @@ void QGradientCache::generateGradientColorTable(const QGradient& gradient, QRgba
 
 Q_GLOBAL_STATIC(QGradientCache, qt_gradient_cache)
 
+void QSpanData::setupGradientTables(const QGradient &g, int alpha, QPainter::CompositionMode compositionMode)
+{
+    // For SourceOver, scaling the coverage by the opacity gives the same
+    // result as scaling the source, so the opacity-less table can be shared.
+    const bool blendOpacity = compositionMode == QPainter::CompositionMode_SourceOver;
+    gradient.const_alpha = blendOpacity ? alpha : 256;
+
+    auto cacheInfo = qt_gradient_cache()->getBuffer(g, blendOpacity ? 256 : alpha);
+    gradient.colorTable32 = cacheInfo->buffer32;
+    gradient.colorTable64 = cacheInfo->buffer64;
+    cachedGradient = std::move(cacheInfo);
+}
+
 
 void QSpanData::init(QRasterBuffer *rb, const QRasterPaintEngine *pe)
 {
@@ -4470,11 +4817,7 @@ void QSpanData::setup(const QBrush &brush, int alpha, QPainter::CompositionMode
             type = LinearGradient;
             const QLinearGradient *g = static_cast<const QLinearGradient *>(brush.gradient());
             gradient.alphaColor = !brush.isOpaque() || alpha != 256;
-
-            auto cacheInfo = qt_gradient_cache()->getBuffer(*g, alpha);
-            gradient.colorTable32 = cacheInfo->buffer32;
-            gradient.colorTable64 = cacheInfo->buffer64;
-            cachedGradient = std::move(cacheInfo);
+            setupGradientTables(*g, alpha, compositionMode);
 
             gradient.spread = g->spread();
 
@@ -4492,11 +4835,7 @@ void QSpanData::setup(const QBrush &brush, int alpha, QPainter::CompositionMode
             type = RadialGradient;
             const QRadialGradient *g = static_cast<const QRadialGradient *>(brush.gradient());
             gradient.alphaColor = !brush.isOpaque() || alpha != 256;
-
-            auto cacheInfo = qt_gradient_cache()->getBuffer(*g, alpha);
-            gradient.colorTable32 = cacheInfo->buffer32;
-            gradient.colorTable64 = cacheInfo->buffer64;
-            cachedGradient = std::move(cacheInfo);
+            setupGradientTables(*g, alpha, compositionMode);
 
             gradient.spread = g->spread();
 
@@ -4518,11 +4857,7 @@ void QSpanData::setup(const QBrush &brush, int alpha, QPainter::CompositionMode
             type = ConicalGradient;
             const QConicalGradient *g = static_cast<const QConicalGradient *>(brush.gradient());
             gradient.alphaColor = !brush.isOpaque() || alpha != 256;
-
-            auto cacheInfo = qt_gradient_cache()->getBuffer(*g, alpha);
-            gradient.colorTable32 = cacheInfo->buffer32;
-            gradient.colorTable64 = cacheInfo->buffer64;
-            cachedGradient = std::move(cacheInfo);
+            setupGradientTables(*g, alpha, compositionMode);
 
             gradient.spread = QGradient::RepeatSpread;
 
@@ -189,6 +189,9 @@ public:
     void drawPoints(const QPointF *points, int pointCount) Q_DECL_OVERRIDE;
     void drawPoints(const QPoint *points, int pointCount) Q_DECL_OVERRIDE;
 
+    void drawPolylines(const QPolygonF *polylines, int polylineCount);
+    void fillPaths(const QPainterPath *paths, int pathCount);
+
     void stroke(const QVectorPath &path, const QPen &pen) Q_DECL_OVERRIDE;
     void fill(const QVectorPath &path, const QBrush &brush) Q_DECL_OVERRIDE;
 
@@ -212,6 +215,8 @@ public:
 
     QSize size() const;
 
+    void setClipIndependentLines(bool enabled);
+
 #ifndef QT_NO_DEBUG
     void saveBuffer(const QString &s) const;
 #endif
@@ -310,6 +315,7 @@ public:
     inline const QClipData *clip() const;
 
     void initializeRasterizer(QSpanData *data);
+    int rasterBandCount(const QSpanData *data, int itemCount) const;
 
     void recalculateFastImages();
     bool canUseFastImageBlending(QPainter::CompositionMode mode, const QImage &image) const;
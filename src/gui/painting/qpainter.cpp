@@ -155,6 +155,7 @@ static bool qt_painter_thread_test(int devType, int engineType, const char *what
     case QInternal::Image:
     case QInternal::Printer:
     case QInternal::Picture:
+    case QInternal::PaintBuffer:
         // can be drawn onto these devices safely from any thread
         break;
     default:
@@ -198,9 +198,11 @@ class QRasterizerPrivate
 public:
     bool antialiased;
     bool legacyRounding;
+    bool clipIndependentLines;
     ProcessSpans blend;
     void *data;
     QRect clipRect;
+    QRect deviceRect;
 
     QScanConverter scanConverter;
 };
@@ -644,6 +646,7 @@ QRasterizer::QRasterizer()
     : d(new QRasterizerPrivate)
 {
     d->legacyRounding = false;
+    d->clipIndependentLines = false;
 }
 
 QRasterizer::~QRasterizer()
@@ -667,11 +670,24 @@ void QRasterizer::setClipRect(const QRect &clipRect)
     d->clipRect = clipRect;
 }
 
+void QRasterizer::setDeviceRect(const QRect &deviceRect)
+{
+    d->deviceRect = deviceRect;
+}
+
 void QRasterizer::setLegacyRoundingEnabled(bool legacyRoundingEnabled)
 {
     d->legacyRounding = legacyRoundingEnabled;
 }
 
+// When enabled, rasterizeLine() computes the line geometry against the device
+// rect rather than the clip rect, so that a line covers the same pixels however
+// it is clipped. Used by QTiledPaintEngine, which clips every tile differently.
+void QRasterizer::setClipIndependentLines(bool enabled)
+{
+    d->clipIndependentLines = enabled;
+}
+
 static Q16Dot16 intersectPixelFP(int x, Q16Dot16 top, Q16Dot16 bottom, Q16Dot16 leftIntersectX, Q16Dot16 rightIntersectX, Q16Dot16 slope, Q16Dot16 invSlope)
 {
     Q16Dot16 leftX = IntToQ16Dot16(x);
@@ -769,8 +785,12 @@ void QRasterizer::rasterizeLine(const QPointF &a, const QPointF &b, qreal width,
         pb += (0.5f * width) * delta;
     }
 
+    // With clip independent lines, clipping against the device keeps the end
+    // points independent of the clip rect, the spans are clipped to it anyway
+    const QRect &lineRect = d->clipIndependentLines ? d->deviceRect : d->clipRect;
+
     QPointF offs = QPointF(qAbs(b.y() - a.y()), qAbs(b.x() - a.x())) * width * 0.5;
-    const QRectF clip(d->clipRect.topLeft() - offs, d->clipRect.bottomRight() + QPoint(1, 1) + offs);
+    const QRectF clip(lineRect.topLeft() - offs, lineRect.bottomRight() + QPoint(1, 1) + offs);
 
     if (!clip.contains(pa) || !clip.contains(pb)) {
         qreal t1 = 0;
@@ -957,7 +977,10 @@ void QRasterizer::rasterizeLine(const QPointF &a, const QPointF &b, qreal width,
         left = snapTo26Dot6Grid(left);
         right = snapTo26Dot6Grid(right);
 
-        const qreal topBound = qBound(qreal(d->clipRect.top()), top.y(), qreal(d->clipRect.bottom()));
+        // With clip independent lines, start at the device rather than the
+        // clip, so that the rows get the same coverage however the line is
+        // clipped; the rows above the clip are skipped below
+        const qreal topBound = qBound(qreal(lineRect.top()), top.y(), qreal(d->clipRect.bottom()));
         const qreal bottomBound = qBound(qreal(d->clipRect.top()), bottom.y(), qreal(d->clipRect.bottom()));
 
         const QPointF topLeftEdge = left - top;
@@ -988,6 +1011,7 @@ void QRasterizer::rasterizeLine(const QPointF &a, const QPointF &b, qreal width,
             const Q16Dot16 iLeftFP = IntToQ16Dot16(int(left.y()));
             const Q16Dot16 iRightFP = IntToQ16Dot16(int(right.y()));
             const Q16Dot16 iBottomFP = IntToQ16Dot16(int(bottomBound));
+            const Q16Dot16 clipTopFP = IntToQ16Dot16(d->clipRect.top());
 
             Q16Dot16 leftIntersectAf = qSafeFloatToQ16Dot16(top.x() + (int(topBound) - top.y()) * topLeftSlope);
             Q16Dot16 rightIntersectAf = qSafeFloatToQ16Dot16(top.x() + (int(topBound) - top.y()) * topRightSlope);
@@ -1086,6 +1110,12 @@ void QRasterizer::rasterizeLine(const QPointF &a, const QPointF &b, qreal width,
                 if (rightMin < leftMin)
                     rightMin = leftMin;
 
+                if (yFP < clipTopFP) {
+                    leftMax = leftMin - 1;
+                    rightMin = leftMin;
+                    rightMax = leftMin - 1;
+                }
+
                 Q16Dot16 rowHeight = rowBottom - rowTop;
 
                 int x = leftMin;
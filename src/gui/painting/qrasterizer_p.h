@@ -72,7 +72,9 @@ public:
 
     void setAntialiased(bool antialiased);
     void setClipRect(const QRect &clipRect);
+    void setDeviceRect(const QRect &deviceRect);
     void setLegacyRoundingEnabled(bool legacyRoundingEnabled);
+    void setClipIndependentLines(bool enabled);
 
     void initialize(ProcessSpans blend, void *data);
 
@@ -0,0 +1,724 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtGui module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qtiledpaintdevice.h"
+#include "qtiledpaintdevice_p.h"
+
+#include <qfontmetrics.h>
+#include <qimage.h>
+#include <qmath.h>
+#include <qpainter.h>
+#include <qpainterpath.h>
+#include <qpixmap.h>
+#include <qthreadpool.h>
+
+#include <private/qfont_p.h>
+#include <private/qimage_p.h>
+#include <private/qpaintengine_raster_p.h>
+#include <private/qpainter_p.h>
+#include <private/qtextengine_p.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+extern void qt_format_text(const QFont &fnt, const QRectF &_r,
+                           int tf, const QTextOption *opt, const QString& str, QRectF *brect,
+                           int tabstops, int *, int tabarraylen,
+                           QPainter *painter);
+
+/*!
+    \class QTiledPaintDevice
+    \inmodule QtGui
+    \since 5.10
+
+    \brief The QTiledPaintDevice class paints on a QImage using several
+    threads.
+
+    \ingroup painting
+
+    A QPainter working on a QTiledPaintDevice does not rasterize anything
+    while it is active. The paint commands are recorded, similar to how
+    QPicture records them, and are rendered into the image when the painter
+    ends. The image is divided into tiles of tileSize(), and every tile is
+    rendered by its own QPainter, replaying only the commands whose bounds
+    touch the tile. The tiles are processed concurrently on threadPool().
+
+    This gives close to linear speedups when painting large images, for
+    instance when rendering reports or print previews offscreen:
+
+    \snippet code/src_gui_painting_qtiledpaintdevice.cpp 0
+
+    The result only depends on the tile size, not on the number of threads.
+    Gradients and transformed textures are computed per span, so pixels
+    next to tile boundaries may be rounded slightly differently than when
+    painting the image directly.
+
+    Text is laid out again for every tile it touches, and the contents of
+    the image are only updated by QPainter::end(). The image must stay
+    alive and must not be painted on by other painters while a painter is
+    active on the device.
+
+    \sa QImage, QPicture, QThreadPool
+*/
+
+QTiledPaintDevicePrivate::QTiledPaintDevicePrivate(QImage *image)
+    : image(image),
+      tileSize(256, 256),
+#ifndef QT_NO_THREAD
+      threadPool(QThreadPool::globalInstance()),
+#else
+      threadPool(0),
+#endif
+      engine(0)
+{
+}
+
+QTiledPaintDevicePrivate::~QTiledPaintDevicePrivate()
+{
+    delete engine;
+}
+
+/*!
+    Constructs a tiled paint device that paints on \a image.
+*/
+QTiledPaintDevice::QTiledPaintDevice(QImage *image)
+    : d_ptr(new QTiledPaintDevicePrivate(image))
+{
+}
+
+/*!
+    Destroys the paint device.
+*/
+QTiledPaintDevice::~QTiledPaintDevice()
+{
+    if (paintingActive())
+        qWarning("QTiledPaintDevice: Destroying device while painting is active");
+}
+
+/*!
+    Returns the image this device paints on.
+*/
+QImage *QTiledPaintDevice::image() const
+{
+    Q_D(const QTiledPaintDevice);
+    return d->image;
+}
+
+/*!
+    Sets the size of the tiles the image is divided into to \a size.
+    Smaller tiles balance the work better between the threads, but commands
+    spanning several tiles are replayed once for each of them.
+
+    Images with a depth of less than 8 bits per pixel are always divided
+    into tiles spanning their whole width.
+
+    The tile size is read when painting begins. The default tile size is
+    256 by 256 pixels.
+*/
+void QTiledPaintDevice::setTileSize(const QSize &size)
+{
+    Q_D(QTiledPaintDevice);
+    if (size.isEmpty()) {
+        qWarning("QTiledPaintDevice::setTileSize: Invalid tile size %dx%d", size.width(), size.height());
+        return;
+    }
+    d->tileSize = size;
+}
+
+/*!
+    Returns the size of the tiles the image is divided into.
+*/
+QSize QTiledPaintDevice::tileSize() const
+{
+    Q_D(const QTiledPaintDevice);
+    return d->tileSize;
+}
+
+/*!
+    Sets the thread pool that renders the tiles to \a pool. Passing a null
+    pool renders all tiles on the thread that ends the painter.
+
+    Threads are only taken from the pool if they are available right away,
+    the thread ending the painter always takes part in rendering.
+
+    By default, QThreadPool::globalInstance() is used.
+*/
+void QTiledPaintDevice::setThreadPool(QThreadPool *pool)
+{
+    Q_D(QTiledPaintDevice);
+    d->threadPool = pool;
+}
+
+/*!
+    Returns the thread pool that renders the tiles.
+*/
+QThreadPool *QTiledPaintDevice::threadPool() const
+{
+    Q_D(const QTiledPaintDevice);
+    return d->threadPool;
+}
+
+/*!
+    \reimp
+*/
+QPaintEngine *QTiledPaintDevice::paintEngine() const
+{
+    Q_D(const QTiledPaintDevice);
+    if (!d->engine)
+        const_cast<QTiledPaintDevicePrivate *>(d)->engine = new QTiledPaintEngine;
+    return d->engine;
+}
+
+/*!
+    \reimp
+*/
+int QTiledPaintDevice::metric(PaintDeviceMetric metric) const
+{
+    Q_D(const QTiledPaintDevice);
+    if (d->image)
+        return qt_paint_device_metric(d->image, metric);
+
+    switch (metric) {
+    case PdmDevicePixelRatio:
+        return 1;
+    case PdmDevicePixelRatioScaled:
+        return 1 * QPaintDevice::devicePixelRatioFScale();
+    default:
+        return 0;
+    }
+}
+
+// Paths cache their vector path, so every tile needs its own copy
+static QPainterPath qt_detachedPath(const QPainterPath &path)
+{
+    QPainterPath copy = path;
+    if (copy.elementCount() > 0) {
+        const QPainterPath::Element e = copy.elementAt(0);
+        copy.setElementPositionAt(0, e.x, e.y);
+    }
+    return copy;
+}
+
+/*
+    Paint engine of QTiledPaintDevice. Everything QPainter passes in is kept
+    in the command list, together with the device rectangle it can touch.
+    The objects captured by the commands are shared by all tile threads,
+    so anything that caches data lazily is either primed while recording or
+    detached by the replay.
+*/
+
+QTiledPaintEngine::QTiledPaintEngine()
+    : QPaintEngine(*(new QTiledPaintEnginePrivate), AllFeatures)
+{
+}
+
+QTiledPaintEngine::~QTiledPaintEngine()
+{
+}
+
+bool QTiledPaintEngine::begin(QPaintDevice *pdev)
+{
+    Q_D(QTiledPaintEngine);
+    d->device = static_cast<QTiledPaintDevice *>(pdev);
+    QImage *image = d->device->image();
+    if (!image || image->isNull()) {
+        qWarning("QTiledPaintEngine::begin: Cannot paint on a null image");
+        return false;
+    }
+    d->commands.clear();
+    std::fill(d->latestState, d->latestState + QTiledPaintCommand::StateTypeCount, -1);
+
+    d->tileSize = d->device->tileSize();
+    // Neighbouring tiles must not share bytes
+    if (image->depth() < 8)
+        d->tileSize.setWidth(image->width());
+    d->columns = (image->width() + d->tileSize.width() - 1) / d->tileSize.width();
+    d->rows = (image->height() + d->tileSize.height() - 1) / d->tileSize.height();
+    d->bins.clear();
+    d->bins.resize(d->columns * d->rows);
+
+    d->pen = QPen();
+    d->matrix = QTransform();
+    d->clipDirty = false;
+    setActive(true);
+    return true;
+}
+
+bool QTiledPaintEngine::end()
+{
+    Q_D(QTiledPaintEngine);
+    d->flush();
+    d->commands.clear();
+    d->commands.squeeze();
+    d->bins.clear();
+    d->bins.squeeze();
+    setActive(false);
+    return true;
+}
+
+void QTiledPaintEngine::updateState(const QPaintEngineState &state)
+{
+    Q_D(QTiledPaintEngine);
+    const QPaintEngine::DirtyFlags flags = state.state();
+
+    if (flags & DirtyPen) {
+        QPen pen = state.pen();
+        // Prime the lazily created data the raster engine reads
+        pen.dashPattern();
+        if (pen.brush().style() == Qt::TexturePattern)
+            pen.brush().textureImage();
+        d->pen = pen;
+        d->recordState(QTiledPaintCommand::Pen, [pen](QPainter *p, const QRect &) { p->setPen(pen); });
+    }
+    if (flags & DirtyBrush) {
+        QBrush brush = state.brush();
+        if (brush.style() == Qt::TexturePattern)
+            brush.textureImage();
+        d->recordState(QTiledPaintCommand::Brush, [brush](QPainter *p, const QRect &) { p->setBrush(brush); });
+    }
+    if (flags & DirtyBrushOrigin) {
+        const QPointF origin = state.brushOrigin();
+        d->recordState(QTiledPaintCommand::BrushOrigin, [origin](QPainter *p, const QRect &) { p->setBrushOrigin(origin); });
+    }
+    if (flags & DirtyBackground) {
+        const Qt::BGMode mode = state.backgroundMode();
+        const QBrush background = state.backgroundBrush();
+        d->recordState(QTiledPaintCommand::Background, [mode, background](QPainter *p, const QRect &) {
+            p->setBackgroundMode(mode);
+            p->setBackground(background);
+        });
+    }
+    if (flags & DirtyTransform) {
+        const QTransform matrix = state.transform();
+        d->matrix = matrix;
+        d->recordState(QTiledPaintCommand::Transform, [matrix](QPainter *p, const QRect &) { p->setTransform(matrix); });
+    }
+    if (flags & (DirtyClipEnabled | DirtyClipRegion | DirtyClipPath))
+        d->clipDirty = true;
+    if (flags & DirtyHints) {
+        const QPainter::RenderHints hints = state.renderHints();
+        d->recordState(QTiledPaintCommand::Hints, [hints](QPainter *p, const QRect &) {
+            p->setRenderHints(~hints, false);
+            p->setRenderHints(hints, true);
+        });
+    }
+    if (flags & DirtyCompositionMode) {
+        const QPainter::CompositionMode mode = state.compositionMode();
+        d->recordState(QTiledPaintCommand::CompositionMode, [mode](QPainter *p, const QRect &) { p->setCompositionMode(mode); });
+    }
+    if (flags & DirtyOpacity) {
+        const qreal opacity = state.opacity();
+        d->recordState(QTiledPaintCommand::Opacity, [opacity](QPainter *p, const QRect &) { p->setOpacity(opacity); });
+    }
+}
+
+// The integer and floating point overloads are recorded separately, since
+// the raster engine does not rasterize them in quite the same way.
+
+template <typename Rect>
+static void qt_recordRects(QTiledPaintEnginePrivate *d, const Rect *rects, int rectCount)
+{
+    QVector<Rect> recorded(rectCount);
+    std::copy(rects, rects + rectCount, recorded.begin());
+    QPolygonF corners;
+    corners.reserve(2 * rectCount);
+    for (const Rect &rect : recorded)
+        corners << QRectF(rect).topLeft() << QRectF(rect).bottomRight();
+    d->recordDraw(d->deviceBounds(corners.boundingRect(), true), [recorded](QPainter *p, const QRect &) {
+        p->drawRects(recorded);
+    });
+}
+
+template <typename Line>
+static void qt_recordLines(QTiledPaintEnginePrivate *d, const Line *lines, int lineCount)
+{
+    QVector<Line> recorded(lineCount);
+    std::copy(lines, lines + lineCount, recorded.begin());
+    QPolygonF ends;
+    ends.reserve(2 * lineCount);
+    for (const Line &line : recorded)
+        ends << QLineF(line).p1() << QLineF(line).p2();
+    d->recordDraw(d->deviceBounds(ends.boundingRect(), true), [recorded](QPainter *p, const QRect &) {
+        p->drawLines(recorded);
+    });
+}
+
+template <typename Polygon, typename Point>
+static void qt_recordPoints(QTiledPaintEnginePrivate *d, const Point *points, int pointCount)
+{
+    Polygon recorded(pointCount);
+    std::copy(points, points + pointCount, recorded.begin());
+    d->recordDraw(d->deviceBounds(QRectF(recorded.boundingRect()), true), [recorded](QPainter *p, const QRect &) {
+        p->drawPoints(recorded);
+    });
+}
+
+template <typename Polygon, typename Point>
+static void qt_recordPolygon(QTiledPaintEnginePrivate *d, const Point *points, int pointCount,
+                             QPaintEngine::PolygonDrawMode mode)
+{
+    Polygon recorded(pointCount);
+    std::copy(points, points + pointCount, recorded.begin());
+    d->recordDraw(d->deviceBounds(QRectF(recorded.boundingRect()), true), [recorded, mode](QPainter *p, const QRect &) {
+        switch (mode) {
+        case QPaintEngine::PolylineMode:
+            p->drawPolyline(recorded);
+            break;
+        case QPaintEngine::ConvexMode:
+            p->drawConvexPolygon(recorded);
+            break;
+        case QPaintEngine::WindingMode:
+            p->drawPolygon(recorded, Qt::WindingFill);
+            break;
+        default:
+            p->drawPolygon(recorded, Qt::OddEvenFill);
+            break;
+        }
+    });
+}
+
+template <typename Rect>
+static void qt_recordEllipse(QTiledPaintEnginePrivate *d, const Rect &rect)
+{
+    d->recordDraw(d->deviceBounds(QRectF(rect).normalized(), true), [rect](QPainter *p, const QRect &) {
+        p->drawEllipse(rect);
+    });
+}
+
+void QTiledPaintEngine::drawRects(const QRect *rects, int rectCount)
+{
+    qt_recordRects(d_func(), rects, rectCount);
+}
+
+void QTiledPaintEngine::drawRects(const QRectF *rects, int rectCount)
+{
+    qt_recordRects(d_func(), rects, rectCount);
+}
+
+void QTiledPaintEngine::drawLines(const QLine *lines, int lineCount)
+{
+    qt_recordLines(d_func(), lines, lineCount);
+}
+
+void QTiledPaintEngine::drawLines(const QLineF *lines, int lineCount)
+{
+    qt_recordLines(d_func(), lines, lineCount);
+}
+
+void QTiledPaintEngine::drawEllipse(const QRect &rect)
+{
+    qt_recordEllipse(d_func(), rect);
+}
+
+void QTiledPaintEngine::drawEllipse(const QRectF &rect)
+{
+    qt_recordEllipse(d_func(), rect);
+}
+
+void QTiledPaintEngine::drawPath(const QPainterPath &path)
+{
+    Q_D(QTiledPaintEngine);
+    d->recordDraw(d->deviceBounds(path.controlPointRect(), true), [path](QPainter *p, const QRect &) {
+        p->drawPath(qt_detachedPath(path));
+    });
+}
+
+void QTiledPaintEngine::drawPoints(const QPoint *points, int pointCount)
+{
+    qt_recordPoints<QPolygon>(d_func(), points, pointCount);
+}
+
+void QTiledPaintEngine::drawPoints(const QPointF *points, int pointCount)
+{
+    qt_recordPoints<QPolygonF>(d_func(), points, pointCount);
+}
+
+void QTiledPaintEngine::drawPolygon(const QPoint *points, int pointCount, PolygonDrawMode mode)
+{
+    qt_recordPolygon<QPolygon>(d_func(), points, pointCount, mode);
+}
+
+void QTiledPaintEngine::drawPolygon(const QPointF *points, int pointCount, PolygonDrawMode mode)
+{
+    qt_recordPolygon<QPolygonF>(d_func(), points, pointCount, mode);
+}
+
+void QTiledPaintEngine::drawPixmap(const QRectF &r, const QPixmap &pm, const QRectF &sr)
+{
+    Q_D(QTiledPaintEngine);
+    d->recordDraw(d->deviceBounds(r.normalized(), false), [r, pm, sr](QPainter *p, const QRect &) {
+        // QPainter already filled the opaque background of bitmaps
+        const Qt::BGMode mode = p->backgroundMode();
+        if (mode == Qt::OpaqueMode && pm.isQBitmap())
+            p->setBackgroundMode(Qt::TransparentMode);
+        p->drawPixmap(r, pm, sr);
+        p->setBackgroundMode(mode);
+    });
+}
+
+void QTiledPaintEngine::drawTiledPixmap(const QRectF &r, const QPixmap &pixmap, const QPointF &s)
+{
+    Q_D(QTiledPaintEngine);
+    d->recordDraw(d->deviceBounds(r.normalized(), false), [r, pixmap, s](QPainter *p, const QRect &) {
+        const Qt::BGMode mode = p->backgroundMode();
+        if (mode == Qt::OpaqueMode && pixmap.isQBitmap())
+            p->setBackgroundMode(Qt::TransparentMode);
+        p->drawTiledPixmap(r, pixmap, s);
+        p->setBackgroundMode(mode);
+    });
+}
+
+void QTiledPaintEngine::drawImage(const QRectF &r, const QImage &image, const QRectF &sr,
+                                  Qt::ImageConversionFlags flags)
+{
+    Q_D(QTiledPaintEngine);
+    d->recordDraw(d->deviceBounds(r.normalized(), false), [r, image, sr, flags](QPainter *p, const QRect &) {
+        p->drawImage(r, image, sr, flags);
+    });
+}
+
+void QTiledPaintEngine::drawTextItem(const QPointF &p, const QTextItem &ti)
+{
+    Q_D(QTiledPaintEngine);
+    const QTextItemInt &si = static_cast<const QTextItemInt &>(ti);
+    if (si.chars == 0) {
+        QPaintEngine::drawTextItem(p, ti); // Draw as path
+        return;
+    }
+
+    // Decorations are drawn by QPainter, see QPicturePaintEngine::drawTextItem()
+    QFont font = ti.font();
+    font.setUnderline(false);
+    font.setStrikeOut(false);
+    font.setOverline(false);
+
+    const QString text = ti.text();
+    const qreal justificationWidth = si.justified ? si.width.toReal() : 0;
+
+    const QFontMetricsF fm(font, d->device);
+    const qreal width = qMax(fm.width(text), justificationWidth);
+    QRectF bounds = fm.boundingRect(text) | QRectF(0, -fm.ascent(), width, fm.height());
+    // Leave room for italic overhang and glyphs exceeding the font metrics
+    const qreal margin = fm.height();
+    bounds.adjust(-margin, -margin, margin, margin);
+
+    d->recordDraw(d->deviceBounds(bounds.translated(p), false),
+                  [p, text, font, justificationWidth](QPainter *painter, const QRect &) {
+        // Looking up the font engine writes to the QFontPrivate, so every
+        // tile needs its own. The engine data is shared; engineForScript()
+        // replaces it if it comes from another thread's font cache.
+        QFont fnt = font;
+        QFontPrivate::detachButKeepEngineData(&fnt);
+
+        int flags = Qt::TextSingleLine | Qt::TextDontClip | Qt::TextForceLeftToRight;
+        QSizeF size(1, 1);
+        if (justificationWidth > 0) {
+            size.setWidth(justificationWidth);
+            flags |= Qt::TextJustificationForced;
+            flags |= Qt::AlignJustify;
+        }
+
+        QFontMetricsF fm(fnt);
+        QPointF pt(p.x(), p.y() - fm.ascent());
+        qt_format_text(fnt, QRectF(pt, size), flags, /*opt*/0,
+                       text, /*brect=*/0, /*tabstops=*/0, /*...*/0, /*tabarraylen=*/0, painter);
+    });
+}
+
+/*
+    Returns the device rectangle that painting \a rect with the current
+    transformation can touch, including the pen if \a stroked is true.
+    Commands that cannot be bounded cover the whole device.
+*/
+QRect QTiledPaintEnginePrivate::deviceBounds(const QRectF &rect, bool stroked) const
+{
+    const QRect deviceRect(0, 0, device->width(), device->height());
+    if (!matrix.isAffine())
+        return deviceRect;
+
+    qreal logicalMargin = 0;
+    qreal deviceMargin = 2; // antialiasing and rounding
+    if (stroked && pen.style() != Qt::NoPen) {
+        const qreal halfWidth = qMax<qreal>(pen.widthF(), 1) / 2;
+        // Miter joins may reach out further than square caps
+        qreal extent = halfWidth * M_SQRT2;
+        if (pen.joinStyle() == Qt::MiterJoin || pen.joinStyle() == Qt::SvgMiterJoin)
+            extent = qMax(extent, halfWidth * pen.miterLimit());
+        if (pen.isCosmetic())
+            deviceMargin += extent;
+        else
+            logicalMargin = extent;
+    }
+
+    const QRectF mapped = matrix.mapRect(rect.adjusted(-logicalMargin, -logicalMargin,
+                                                       logicalMargin, logicalMargin));
+    return mapped.adjusted(-deviceMargin, -deviceMargin, deviceMargin, deviceMargin)
+            .toAlignedRect() & deviceRect;
+}
+
+void QTiledPaintEnginePrivate::recordState(QTiledPaintCommand::Type type,
+                                           const std::function<void(QPainter *, const QRect &)> &replay)
+{
+    QTiledPaintCommand command = { type, QRect(), replay, {} };
+    latestState[type] = commands.size();
+    commands.append(command);
+}
+
+void QTiledPaintEnginePrivate::recordDraw(const QRect &bounds,
+                                          const std::function<void(QPainter *, const QRect &)> &replay)
+{
+    if (bounds.isEmpty())
+        return;
+
+    if (clipDirty) {
+        // QPainter keeps the full clip history of its state, replaying it on
+        // top of the tile clip keeps every operation and transform intact.
+        Q_Q(QTiledPaintEngine);
+        const QPainterState *s = QPainterPrivate::get(q->painter())->state;
+        const bool enabled = s->clipEnabled;
+        const QVector<QPainterClipInfo> clipInfo = s->clipInfo;
+        const QTransform redirection = s->redirectionMatrix;
+        recordState(QTiledPaintCommand::Clip,
+            [enabled, clipInfo, redirection](QPainter *p, const QRect &tile) {
+                const QTransform matrix = p->transform();
+                p->resetTransform();
+                p->setClipRect(tile);
+                if (enabled) {
+                    for (const QPainterClipInfo &info : clipInfo) {
+                        if (info.operation == Qt::NoClip)
+                            continue;
+                        p->setTransform(info.matrix * redirection);
+                        switch (info.clipType) {
+                        case QPainterClipInfo::RegionClip:
+                            p->setClipRegion(info.region, Qt::IntersectClip);
+                            break;
+                        case QPainterClipInfo::PathClip:
+                            p->setClipPath(qt_detachedPath(info.path), Qt::IntersectClip);
+                            break;
+                        case QPainterClipInfo::RectClip:
+                            p->setClipRect(info.rect, Qt::IntersectClip);
+                            break;
+                        case QPainterClipInfo::RectFClip:
+                            p->setClipRect(info.rectf, Qt::IntersectClip);
+                            break;
+                        }
+                    }
+                }
+                p->setTransform(matrix);
+            });
+        clipDirty = false;
+    }
+
+    QTiledPaintCommand command = { QTiledPaintCommand::Draw, bounds, replay, {} };
+    std::copy(latestState, latestState + QTiledPaintCommand::StateTypeCount, command.latestState);
+    const int index = commands.size();
+    commands.append(command);
+
+    const int lastColumn = bounds.right() / tileSize.width();
+    const int lastRow = bounds.bottom() / tileSize.height();
+    for (int row = bounds.top() / tileSize.height(); row <= lastRow; ++row) {
+        for (int column = bounds.left() / tileSize.width(); column <= lastColumn; ++column)
+            bins[row * columns + column].append(index);
+    }
+}
+
+/*
+    Replays the draw commands in the bin of tile \a index on \a painter,
+    each after the state commands that changed since the previous one.
+    Clips are expensive to set up, so they are only applied before a draw
+    command that needs them.
+*/
+void QTiledPaintEnginePrivate::replayTile(QPainter *painter, int index, const QRect &tile) const
+{
+    painter->setClipRect(tile);
+
+    int applied[QTiledPaintCommand::StateTypeCount];
+    std::fill(applied, applied + QTiledPaintCommand::StateTypeCount, -1);
+    for (int drawIndex : bins.at(index)) {
+        const QTiledPaintCommand &command = commands.at(drawIndex);
+        for (int type = 0; type < QTiledPaintCommand::StateTypeCount; ++type) {
+            const int state = command.latestState[type];
+            if (state != applied[type]) {
+                commands.at(state).replay(painter, tile);
+                applied[type] = state;
+            }
+        }
+        command.replay(painter, tile);
+    }
+}
+
+void QTiledPaintEnginePrivate::flush()
+{
+    QImage *image = device->image();
+    const bool hasDrawCommands = std::any_of(bins.cbegin(), bins.cend(),
+                                             [](const QVector<int> &bin) { return !bin.isEmpty(); });
+    if (!hasDrawCommands)
+        return;
+
+    // Detach here, the tiles all paint on the same data
+    uchar *bits = image->bits();
+    const int width = image->width();
+    const int height = image->height();
+    const int bytesPerLine = image->bytesPerLine();
+    const QImage::Format format = image->format();
+
+    qt_imageProcessTasks(columns * rows, device->threadPool(), [&](int index) {
+        if (bins.at(index).isEmpty())
+            return;
+        const QRect tile = QRect(QPoint((index % columns) * tileSize.width(),
+                                        (index / columns) * tileSize.height()),
+                                 tileSize) & image->rect();
+
+        QImage target(bits, width, height, bytesPerLine, format);
+        if (image->colorCount() > 0)
+            target.setColorTable(image->colorTable());
+        target.setDotsPerMeterX(image->dotsPerMeterX());
+        target.setDotsPerMeterY(image->dotsPerMeterY());
+        target.setDevicePixelRatio(image->devicePixelRatio());
+
+        QPainter painter(&target);
+        if (painter.paintEngine()->type() == QPaintEngine::Raster)
+            static_cast<QRasterPaintEngine *>(painter.paintEngine())->setClipIndependentLines(true);
+        replayTile(&painter, index, tile);
+    });
+}
+
+QT_END_NAMESPACE
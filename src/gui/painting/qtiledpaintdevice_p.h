@@ -0,0 +1,159 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtGui module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QTILEDPAINTDEVICE_P_H
+#define QTILEDPAINTDEVICE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include "qtiledpaintdevice.h"
+#include <QtGui/qpaintengine.h>
+#include <QtCore/qvector.h>
+#include <private/qpaintengine_p.h>
+
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+
+class QTiledPaintEngine;
+
+// A recorded paint engine call. Each state type sets painter properties
+// independently of the others, so a tile only replays the latest command
+// of each type before each draw command whose device bounds touch it.
+struct QTiledPaintCommand
+{
+    enum Type { Pen, Brush, BrushOrigin, Background, Transform, Hints,
+                CompositionMode, Opacity, Clip, Draw };
+    enum { StateTypeCount = Draw };
+
+    Type type;
+    QRect bounds;
+    std::function<void(QPainter *, const QRect &)> replay;
+    int latestState[StateTypeCount]; // draw commands only, -1 if not set yet
+};
+
+class QTiledPaintDevicePrivate
+{
+public:
+    QTiledPaintDevicePrivate(QImage *image);
+    ~QTiledPaintDevicePrivate();
+
+    QImage *image;
+    QSize tileSize;
+    QThreadPool *threadPool;
+    QTiledPaintEngine *engine;
+};
+
+class QTiledPaintEnginePrivate;
+
+class QTiledPaintEngine : public QPaintEngine
+{
+    Q_DECLARE_PRIVATE(QTiledPaintEngine)
+public:
+    QTiledPaintEngine();
+    ~QTiledPaintEngine();
+
+    bool begin(QPaintDevice *pdev) Q_DECL_OVERRIDE;
+    bool end() Q_DECL_OVERRIDE;
+
+    void updateState(const QPaintEngineState &state) Q_DECL_OVERRIDE;
+
+    void drawRects(const QRect *rects, int rectCount) Q_DECL_OVERRIDE;
+    void drawRects(const QRectF *rects, int rectCount) Q_DECL_OVERRIDE;
+    void drawLines(const QLine *lines, int lineCount) Q_DECL_OVERRIDE;
+    void drawLines(const QLineF *lines, int lineCount) Q_DECL_OVERRIDE;
+    void drawEllipse(const QRect &rect) Q_DECL_OVERRIDE;
+    void drawEllipse(const QRectF &rect) Q_DECL_OVERRIDE;
+    void drawPath(const QPainterPath &path) Q_DECL_OVERRIDE;
+    void drawPoints(const QPoint *points, int pointCount) Q_DECL_OVERRIDE;
+    void drawPoints(const QPointF *points, int pointCount) Q_DECL_OVERRIDE;
+    void drawPolygon(const QPoint *points, int pointCount, PolygonDrawMode mode) Q_DECL_OVERRIDE;
+    void drawPolygon(const QPointF *points, int pointCount, PolygonDrawMode mode) Q_DECL_OVERRIDE;
+
+    void drawPixmap(const QRectF &r, const QPixmap &pm, const QRectF &sr) Q_DECL_OVERRIDE;
+    void drawTiledPixmap(const QRectF &r, const QPixmap &pixmap, const QPointF &s) Q_DECL_OVERRIDE;
+    void drawImage(const QRectF &r, const QImage &image, const QRectF &sr,
+                   Qt::ImageConversionFlags flags = Qt::AutoColor) Q_DECL_OVERRIDE;
+    void drawTextItem(const QPointF &p, const QTextItem &ti) Q_DECL_OVERRIDE;
+
+    Type type() const Q_DECL_OVERRIDE { return User; }
+
+private:
+    Q_DISABLE_COPY(QTiledPaintEngine)
+};
+
+class QTiledPaintEnginePrivate : public QPaintEnginePrivate
+{
+    Q_DECLARE_PUBLIC(QTiledPaintEngine)
+public:
+    QTiledPaintEnginePrivate() : device(0), columns(0), rows(0), clipDirty(false) {}
+
+    QRect deviceBounds(const QRectF &rect, bool stroked) const;
+    void recordState(QTiledPaintCommand::Type type,
+                     const std::function<void(QPainter *, const QRect &)> &replay);
+    void recordDraw(const QRect &bounds, const std::function<void(QPainter *, const QRect &)> &replay);
+    void replayTile(QPainter *painter, int index, const QRect &tile) const;
+    void flush();
+
+    QTiledPaintDevice *device;
+    QVector<QTiledPaintCommand> commands;
+    int latestState[QTiledPaintCommand::StateTypeCount];
+    QVector<QVector<int> > bins; // indices of the draw commands touching each tile
+    QSize tileSize;
+    int columns;
+    int rows;
+    QPen pen;
+    QTransform matrix;
+    bool clipDirty;
+};
+
+QT_END_NAMESPACE
+
+#endif // QTILEDPAINTDEVICE_P_H
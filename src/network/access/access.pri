@@ -4,6 +4,7 @@ HEADERS += \
     access/qhttpnetworkheader_p.h \
     access/qhttpnetworkrequest_p.h \
     access/qhttpnetworkreply_p.h \
+    access/qdecompresshelper_p.h \
     access/qhttpnetworkconnection_p.h \
     access/qhttpnetworkconnectionchannel_p.h \
     access/qabstractprotocolhandler_p.h \
@@ -29,6 +30,8 @@ HEADERS += \
     access/qnetworkreplydataimpl_p.h \
     access/qnetworkreplyhttpimpl_p.h \
     access/qnetworkreplyfileimpl_p.h \
+    access/qnetworktransferstatistics.h \
+    access/qnetworktransferstatistics_p.h \
     access/qabstractnetworkcache_p.h \
     access/qabstractnetworkcache.h \
     access/qhttpthreaddelegate_p.h \
@@ -43,6 +46,7 @@ SOURCES += \
     access/qhttpnetworkheader.cpp \
     access/qhttpnetworkrequest.cpp \
     access/qhttpnetworkreply.cpp \
+    access/qdecompresshelper.cpp \
     access/qhttpnetworkconnection.cpp \
     access/qhttpnetworkconnectionchannel.cpp \
     access/qabstractprotocolhandler.cpp \
@@ -63,6 +67,7 @@ SOURCES += \
     access/qnetworkreplydataimpl.cpp \
     access/qnetworkreplyhttpimpl.cpp \
     access/qnetworkreplyfileimpl.cpp \
+    access/qnetworktransferstatistics.cpp \
     access/qabstractnetworkcache.cpp \
     access/qhttpthreaddelegate.cpp \
     access/qhttpmultipart.cpp \
@@ -92,4 +97,6 @@ qtConfig(networkdiskcache) {
 mac: LIBS_PRIVATE += -framework Security
 
 include($$PWD/../../3rdparty/zlib_dependency.pri)
+qtConfig(brotli): QMAKE_USE_PRIVATE += brotli
+qtConfig(zstd): QMAKE_USE_PRIVATE += zstd
 include($$PWD/http2/http2.pri)
@@ -102,10 +102,19 @@ void BitOStream::write(quint32 src)
 void BitOStream::write(const QByteArray &src, bool compressed)
 {
     quint32 byteLen = src.size();
-    if (compressed && byteLen) {
+    compressed = compressed && byteLen;
+    if (compressed) {
         const auto bitLen = huffman_encoded_bit_length(src);
         Q_ASSERT(bitLen && std::numeric_limits<quint32>::max() >= (bitLen + 7) / 8);
-        byteLen = (bitLen + 7) / 8;
+        // Huffman codes for some octets are up to 30 bits long, binary
+        // data or tokens can grow; send those as is.
+        if ((bitLen + 7) / 8 < byteLen)
+            byteLen = (bitLen + 7) / 8;
+        else
+            compressed = false;
+    }
+
+    if (compressed) {
         writeBits(uchar(1), 1); // bit set - compressed
     } else {
         writeBits(uchar(0), 1); // no compression.
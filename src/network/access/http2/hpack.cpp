@@ -145,6 +145,31 @@ bool is_request_pseudo_header(const QByteArray &name)
            name == ":authority" || name == ":path";
 }
 
+bool is_sensitive_field(const HeaderField &field)
+{
+    // HPACK, 7.1.3: credentials and short cookies are easy to recover
+    // by probing the compression context; intermediaries must not
+    // index them either.
+    // QByteArrayLiteral: sizes are compared first, this is called
+    // for every header field we send.
+    if (field.name == QByteArrayLiteral("authorization")
+        || field.name == QByteArrayLiteral("proxy-authorization")) {
+        return true;
+    }
+    return field.value.size() < 20 && field.name == QByteArrayLiteral("cookie");
+}
+
+bool is_volatile_field(const QByteArray &name)
+{
+    // Values that (almost) never repeat, indexing them only evicts
+    // entries that would be reused.
+    return name == QByteArrayLiteral("content-length")
+           || name == QByteArrayLiteral("if-modified-since")
+           || name == QByteArrayLiteral("if-none-match")
+           || name == QByteArrayLiteral("if-range")
+           || name == QByteArrayLiteral("range");
+}
+
 } // unnamed namespace
 
 Encoder::Encoder(quint32 size, bool compress)
@@ -291,23 +316,41 @@ bool Encoder::encodeRequestPseudoHeaders(BitOStream &outputStream,
     return true;
 }
 
-bool Encoder::encodeHeaderField(BitOStream &outputStream, const HeaderField &field)
+BitPattern Encoder::literalFieldType(const HeaderField &field) const
 {
-    // TODO: at the moment we never use LiteralNo/Never Indexing ...
+    if (is_volatile_field(field.name))
+        return LiteralNoIndexing;
 
+    // An entry taking most of the table would evict (nearly) everything
+    // else; one larger than the table would even clear it.
+    const auto entrySize = entry_size(field);
+    if (!entrySize.first || entrySize.second > lookupTable.dynamicDataCapacity() / 4 * 3)
+        return LiteralNoIndexing;
+
+    return LiteralIncrementalIndexing;
+}
+
+bool Encoder::encodeHeaderField(BitOStream &outputStream, const HeaderField &field)
+{
     // Here we try:
     // 1. indexed
-    // 2. literal indexed with indexed name/literal value
-    // 3. literal indexed with literal name/literal value
-    if (const auto index = lookupTable.indexOf(field.name, field.value))
-        return encodeIndexedField(outputStream, index);
+    // 2. literal with indexed name/literal value
+    // 3. literal with literal name/literal value
+    // where literals are added to the dynamic table, unless
+    // they are sensitive or literalFieldType() decides otherwise.
+    BitPattern fieldType = LiteralNeverIndexing;
+    if (!is_sensitive_field(field)) {
+        if (const auto index = lookupTable.indexOf(field.name, field.value))
+            return encodeIndexedField(outputStream, index);
+        fieldType = literalFieldType(field);
+    }
 
     if (const auto index = lookupTable.indexOf(field.name)) {
-        return encodeLiteralField(outputStream, LiteralIncrementalIndexing,
+        return encodeLiteralField(outputStream, fieldType,
                                   index, field.value, compressStrings);
     }
 
-    return encodeLiteralField(outputStream, LiteralIncrementalIndexing,
+    return encodeLiteralField(outputStream, fieldType,
                               field.name, field.value, compressStrings);
 }
 
@@ -97,9 +97,11 @@ private:
 
     bool encodeIndexedField(BitOStream &outputStream, quint32 index) const;
 
+    struct BitPattern literalFieldType(const HeaderField &field) const;
+
 
     bool encodeLiteralField(BitOStream &outputStream,
-                            const struct BitPattern &fieldType,
+                            const BitPattern &fieldType,
                             quint32 nameIndex,
                             const QByteArray &value,
                             bool withCompression);
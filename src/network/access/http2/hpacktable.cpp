@@ -316,6 +316,11 @@ quint32 FieldLookupTable::dynamicDataSize() const
     return dataSize;
 }
 
+quint32 FieldLookupTable::dynamicDataCapacity() const
+{
+    return tableCapacity;
+}
+
 void FieldLookupTable::clearDynamicTable()
 {
     searchIndex.clear();
@@ -352,30 +352,6 @@ const CodeEntry staticHuffmanCodeTable[]
     {256, 0xfffffffcul, 30}   // EOS 11111111|11111111|11111111|111111
 };
 
-void write_huffman_code(BitOStream &outputStream, const CodeEntry &code)
-{
-    // Append octet by octet.
-    auto bitLength = code.bitLength;
-    const auto hc = code.huffmanCode >> (32 - bitLength);
-
-    if (bitLength > 24) {
-        outputStream.writeBits(uchar(hc >> 24), bitLength - 24);
-        bitLength = 24;
-    }
-
-    if (bitLength > 16) {
-        outputStream.writeBits(uchar(hc >> 16), bitLength - 16);
-        bitLength = 16;
-    }
-
-    if (bitLength > 8) {
-        outputStream.writeBits(uchar(hc >> 8), bitLength - 8);
-        bitLength = 8;
-    }
-
-    outputStream.writeBits(uchar(hc), bitLength);
-}
-
 }
 
 // That's from HPACK's specs - we deal with octets.
@@ -385,15 +361,30 @@ quint64 huffman_encoded_bit_length(const QByteArray &inputData)
 {
     quint64 bitLength = 0;
     for (int i = 0, e = inputData.size(); i < e; ++i)
-        bitLength += staticHuffmanCodeTable[int(inputData[i])].bitLength;
+        bitLength += staticHuffmanCodeTable[uchar(inputData[i])].bitLength;
 
     return bitLength;
 }
 
 void huffman_encode_string(const QByteArray &inputData, BitOStream &outputStream)
 {
-    for (int i = 0, e = inputData.size(); i < e; ++i)
-        write_huffman_code(outputStream, staticHuffmanCodeTable[int(inputData[i])]);
+    // Codes are collected in an accumulator and appended octet by octet.
+    // At most 7 bits are pending before a code (<= 30 bits) is added,
+    // so 64 bits are more than enough.
+    quint64 bits = 0;
+    quint32 pending = 0;
+    for (int i = 0, e = inputData.size(); i < e; ++i) {
+        const CodeEntry &code = staticHuffmanCodeTable[uchar(inputData[i])];
+        bits = (bits << code.bitLength) | (code.huffmanCode >> (32 - code.bitLength));
+        pending += code.bitLength;
+        while (pending >= 8) {
+            pending -= 8;
+            outputStream.writeBits(uchar(bits >> pending), 8);
+        }
+    }
+
+    if (pending)
+        outputStream.writeBits(uchar(bits), pending);
 
     // Pad bits ...
     if (outputStream.bitLength() % 8)
@@ -492,6 +483,46 @@ HuffmanDecoder::HuffmanDecoder()
 
 bool HuffmanDecoder::decodeStream(BitIStream &inputStream, QByteArray &outputBuffer)
 {
+    // No code is shorter than minCodeLength bits, so this is the maximum
+    // number of octets we can decode; we write them directly and cut the
+    // buffer to what was actually decoded.
+    const quint64 bitsLeft = inputStream.bitLength() - inputStream.streamOffset();
+    const int oldSize = outputBuffer.size();
+    outputBuffer.resize(oldSize + int(bitsLeft / minCodeLength));
+
+    char *dst = outputBuffer.data() + oldSize;
+    const bool result = decodeSymbols(inputStream, dst);
+    outputBuffer.truncate(int(dst - outputBuffer.constData()));
+
+    return result;
+}
+
+bool HuffmanDecoder::decodeSymbols(BitIStream &inputStream, char *&dst)
+{
+    // Fast path: peek 64 bits at once and decode symbols as long as there
+    // is a full 32-bit chunk left in the window (codes are at most 30 bits).
+    while (true) {
+        quint64 window = 0;
+        if (inputStream.peekBits(inputStream.streamOffset(), 64, &window) < 64)
+            break;
+
+        quint32 used = 0;
+        while (used <= 32) {
+            const PrefixTableEntry entry = decodeChunk(quint32(window << used >> 32));
+            if (!entry.bitLength || entry.byteValue == 256) {
+                //EOS (256) == compression error (HPACK).
+                inputStream.skipBits(used);
+                return false;
+            }
+
+            *dst++ = char(entry.byteValue);
+            used += entry.bitLength;
+        }
+
+        inputStream.skipBits(used);
+    }
+
+    // The tail (less than 64 bits), symbol by symbol:
     while (true) {
         quint32 chunk = 0;
         const quint32 readBits = inputStream.peekBits(inputStream.streamOffset(), 32, &chunk);
@@ -503,20 +534,7 @@ bool HuffmanDecoder::decodeStream(BitIStream &inputStream, QByteArray &outputBuf
             return padding_is_valid(chunk, readBits);
         }
 
-        quint32 tableIndex = 0;
-        const PrefixTable *table = &prefixTables[tableIndex];
-        quint32 entryIndex = chunk >> (32 - table->indexLength);
-        PrefixTableEntry entry = tableEntry(*table, entryIndex);
-
-        while (true) {
-            if (entry.nextTable == tableIndex)
-                break;
-
-            tableIndex = entry.nextTable;
-            table = &prefixTables[tableIndex];
-            entryIndex = chunk << table->prefixLength >> (32 - table->indexLength);
-            entry = tableEntry(*table, entryIndex);
-        }
+        const PrefixTableEntry entry = decodeChunk(chunk);
 
         if (entry.bitLength > readBits) {
             inputStream.skipBits(readBits);
@@ -529,13 +547,32 @@ bool HuffmanDecoder::decodeStream(BitIStream &inputStream, QByteArray &outputBuf
             return false;
         }
 
-        outputBuffer.append(entry.byteValue);
+        *dst++ = char(entry.byteValue);
         inputStream.skipBits(entry.bitLength);
     }
 
     return false;
 }
 
+PrefixTableEntry HuffmanDecoder::decodeChunk(quint32 chunk) const
+{
+    // Look up the code in the most significant bits of 'chunk',
+    // following the prefix tables until we find a terminal entry.
+    quint32 tableIndex = 0;
+    const PrefixTable *table = &prefixTables[tableIndex];
+    quint32 entryIndex = chunk >> (32 - table->indexLength);
+    PrefixTableEntry entry = tableEntry(*table, entryIndex);
+
+    while (entry.nextTable != tableIndex) {
+        tableIndex = entry.nextTable;
+        table = &prefixTables[tableIndex];
+        entryIndex = chunk << table->prefixLength >> (32 - table->indexLength);
+        entry = tableEntry(*table, entryIndex);
+    }
+
+    return entry;
+}
+
 quint32 HuffmanDecoder::addTable(quint32 prefix, quint32 index)
 {
     PrefixTable newTable{prefix, index};
@@ -547,7 +584,7 @@ quint32 HuffmanDecoder::addTable(quint32 prefix, quint32 index)
     return quint32(prefixTables.size() - 1);
 }
 
-PrefixTableEntry HuffmanDecoder::tableEntry(const PrefixTable &table, quint32 index)
+PrefixTableEntry HuffmanDecoder::tableEntry(const PrefixTable &table, quint32 index) const
 {
     Q_ASSERT(index < table.size());
     return tableData[table.offset + index];
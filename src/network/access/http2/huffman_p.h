@@ -163,8 +163,10 @@ public:
     bool decodeStream(BitIStream &inputStream, QByteArray &outputBuffer);
 
 private:
+    bool decodeSymbols(BitIStream &inputStream, char *&dst);
+    PrefixTableEntry decodeChunk(quint32 chunk) const;
     quint32 addTable(quint32 prefixLength, quint32 indexLength);
-    PrefixTableEntry tableEntry(const PrefixTable &table, quint32 index);
+    PrefixTableEntry tableEntry(const PrefixTable &table, quint32 index) const;
     void setTableEntry(const PrefixTable &table, quint32 index, const PrefixTableEntry &entry);
 
     std::vector<PrefixTable> prefixTables;
@@ -0,0 +1,401 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qdecompresshelper_p.h"
+
+#ifndef QT_NO_COMPRESS
+
+#include <QtCore/private/qbytedata_p.h>
+#include <QtCore/qcoreapplication.h>
+
+#include <zlib.h>
+
+#if QT_CONFIG(brotli)
+#include <brotli/decode.h>
+#endif
+
+#if QT_CONFIG(zstd)
+#include <zstd.h>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+// Output is produced in chunks of a few times the input size, within these
+// bounds, so small inputs don't allocate much and large ones don't end up
+// in many small buffers.
+const int MinOutputChunk = 4 * 1024;
+const int MaxOutputChunk = 256 * 1024;
+
+int outputChunkSize(qint64 inputSize)
+{
+    return int(qBound<qint64>(MinOutputChunk, inputSize * 4, MaxOutputChunk));
+}
+}
+
+QDecompressHelper::QDecompressHelper()
+    : contentEncoding(None),
+      finished(false),
+      triedRawDeflate(false),
+      producedOutput(false),
+      zlibStream(Q_NULLPTR)
+#if QT_CONFIG(brotli)
+      , brotliState(Q_NULLPTR)
+#endif
+#if QT_CONFIG(zstd)
+      , zstdStream(Q_NULLPTR)
+#endif
+{
+}
+
+QDecompressHelper::~QDecompressHelper()
+{
+    clear();
+}
+
+/*!
+    \internal
+
+    Returns the content coding named \a name, or None if it is not one we
+    can decode. Names are compared case-insensitively.
+*/
+QDecompressHelper::ContentEncoding QDecompressHelper::encodingFromName(const QByteArray &name)
+{
+    const QByteArray encoding = name.trimmed();
+    if (qstricmp(encoding.constData(), "gzip") == 0 || qstricmp(encoding.constData(), "x-gzip") == 0)
+        return GZip;
+    if (qstricmp(encoding.constData(), "deflate") == 0)
+        return Deflate;
+#if QT_CONFIG(brotli)
+    if (qstricmp(encoding.constData(), "br") == 0)
+        return Brotli;
+#endif
+#if QT_CONFIG(zstd)
+    if (qstricmp(encoding.constData(), "zstd") == 0)
+        return Zstandard;
+#endif
+    return None;
+}
+
+bool QDecompressHelper::isSupportedEncoding(const QByteArray &name)
+{
+    return encodingFromName(name) != None;
+}
+
+/*!
+    \internal
+
+    Returns the value for the Accept-Encoding header listing every content
+    coding this build can decode.
+*/
+QByteArray QDecompressHelper::acceptedEncodings()
+{
+    static const QByteArray value = QByteArrayLiteral("gzip, deflate")
+#if QT_CONFIG(brotli)
+            + QByteArrayLiteral(", br")
+#endif
+#if QT_CONFIG(zstd)
+            + QByteArrayLiteral(", zstd")
+#endif
+            ;
+    return value;
+}
+
+bool QDecompressHelper::setEncoding(const QByteArray &contentEncoding)
+{
+    return setEncoding(encodingFromName(contentEncoding));
+}
+
+/*!
+    \internal
+
+    Prepares the decoder for a stream in \a encoding. Returns \c false if
+    the encoding is not supported or the decoder could not be set up.
+*/
+bool QDecompressHelper::setEncoding(ContentEncoding encoding)
+{
+    clear();
+    switch (encoding) {
+    case None:
+        return false;
+    case Deflate:
+    case GZip:
+        // "windowBits can also be greater than 15 for optional gzip decoding.
+        // Add 32 to windowBits to enable zlib and gzip decoding with automatic header detection"
+        // http://www.zlib.net/manual.html
+        if (!initZlib(MAX_WBITS + 32))
+            return false;
+        break;
+    case Brotli:
+#if QT_CONFIG(brotli)
+        brotliState = BrotliDecoderCreateInstance(Q_NULLPTR, Q_NULLPTR, Q_NULLPTR);
+        if (!brotliState)
+            return false;
+        break;
+#else
+        return false;
+#endif
+    case Zstandard:
+#if QT_CONFIG(zstd)
+        zstdStream = ZSTD_createDStream();
+        if (!zstdStream || ZSTD_isError(ZSTD_initDStream(zstdStream))) {
+            clear();
+            return false;
+        }
+        break;
+#else
+        return false;
+#endif
+    }
+    contentEncoding = encoding;
+    return true;
+}
+
+void QDecompressHelper::clear()
+{
+    if (zlibStream) {
+        inflateEnd(zlibStream);
+        delete zlibStream;
+        zlibStream = Q_NULLPTR;
+    }
+#if QT_CONFIG(brotli)
+    if (brotliState) {
+        BrotliDecoderDestroyInstance(brotliState);
+        brotliState = Q_NULLPTR;
+    }
+#endif
+#if QT_CONFIG(zstd)
+    if (zstdStream) {
+        ZSTD_freeDStream(zstdStream);
+        zstdStream = Q_NULLPTR;
+    }
+#endif
+    contentEncoding = None;
+    finished = false;
+    triedRawDeflate = false;
+    producedOutput = false;
+    errorStr.clear();
+    zlibInputSeen.clear();
+}
+
+/*!
+    \internal
+
+    Decodes \a size bytes at \a data and appends the result to \a out.
+    Returns the number of bytes appended, or -1 if the input is not valid
+    for the encoding. Input following the end of the encoded stream is
+    ignored, except for Zstandard where it may hold further frames.
+*/
+qint64 QDecompressHelper::decompress(const char *data, qint64 size, QByteDataBuffer *out)
+{
+    if ((finished && contentEncoding != Zstandard) || size <= 0)
+        return 0;
+
+    switch (contentEncoding) {
+    case None:
+        break;
+    case Deflate:
+    case GZip:
+        return decompressZlib(data, size, out);
+    case Brotli:
+#if QT_CONFIG(brotli)
+        return decompressBrotli(data, size, out);
+#else
+        break;
+#endif
+    case Zstandard:
+#if QT_CONFIG(zstd)
+        return decompressZstandard(data, size, out);
+#else
+        break;
+#endif
+    }
+    errorStr = QCoreApplication::translate("QHttp", "Data is not compressed");
+    return -1;
+}
+
+bool QDecompressHelper::initZlib(int windowBits)
+{
+    if (!zlibStream)
+        zlibStream = new z_stream;
+    zlibStream->zalloc = Z_NULL;
+    zlibStream->zfree = Z_NULL;
+    zlibStream->opaque = Z_NULL;
+    zlibStream->avail_in = 0;
+    zlibStream->next_in = Z_NULL;
+    if (inflateInit2(zlibStream, windowBits) != Z_OK) {
+        delete zlibStream;
+        zlibStream = Q_NULLPTR;
+        return false;
+    }
+    return true;
+}
+
+qint64 QDecompressHelper::decompressZlib(const char *data, qint64 size, QByteDataBuffer *out)
+{
+    qint64 total = 0;
+    zlibStream->avail_in = uInt(size);
+    zlibStream->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+
+    // Until we know the data is in the zlib or gzip format, remember what
+    // we fed to zlib so the raw deflate retry below can start over with it.
+    const bool mayRetry = !triedRawDeflate && !producedOutput;
+    if (mayRetry)
+        zlibInputSeen.append(data, int(size));
+
+    do {
+        QByteArray chunk(outputChunkSize(zlibStream->avail_in), Qt::Uninitialized);
+        zlibStream->avail_out = uInt(chunk.size());
+        zlibStream->next_out = reinterpret_cast<Bytef *>(chunk.data());
+
+        int ret = inflate(zlibStream, Z_NO_FLUSH);
+        // Some servers send raw deflate data for "deflate" instead of the
+        // zlib format. If the very first bytes don't parse, try that.
+        if (ret == Z_DATA_ERROR && mayRetry && !triedRawDeflate) {
+            triedRawDeflate = true;
+            inflateEnd(zlibStream);
+            if (!initZlib(-MAX_WBITS))
+                return -1;
+            zlibStream->avail_in = uInt(zlibInputSeen.size());
+            zlibStream->next_in = reinterpret_cast<Bytef *>(zlibInputSeen.data());
+            continue;
+        }
+        // In the context of HTTP compression Z_NEED_DICT is also an error.
+        if (ret < 0 || ret == Z_NEED_DICT) {
+            errorStr = QCoreApplication::translate("QHttp", "Error decompressing data (%1)")
+                    .arg(QString::fromLatin1(zlibStream->msg ? zlibStream->msg : "zlib"));
+            return -1;
+        }
+
+        const int produced = chunk.size() - int(zlibStream->avail_out);
+        if (produced > 0) {
+            chunk.resize(produced);
+            out->append(chunk);
+            total += produced;
+            producedOutput = true;
+        }
+        if (ret == Z_STREAM_END) {
+            finished = true;
+            break;
+        }
+        // keep going while there is input left or the output was full
+    } while (zlibStream->avail_in > 0 || zlibStream->avail_out == 0);
+
+    if (triedRawDeflate || producedOutput)
+        zlibInputSeen.clear();
+    return total;
+}
+
+#if QT_CONFIG(brotli)
+qint64 QDecompressHelper::decompressBrotli(const char *data, qint64 size, QByteDataBuffer *out)
+{
+    qint64 total = 0;
+    size_t availableIn = size_t(size);
+    const uint8_t *nextIn = reinterpret_cast<const uint8_t *>(data);
+
+    BrotliDecoderResult result;
+    do {
+        QByteArray chunk(outputChunkSize(qint64(availableIn)), Qt::Uninitialized);
+        size_t availableOut = size_t(chunk.size());
+        uint8_t *nextOut = reinterpret_cast<uint8_t *>(chunk.data());
+
+        result = BrotliDecoderDecompressStream(brotliState, &availableIn, &nextIn,
+                                               &availableOut, &nextOut, Q_NULLPTR);
+        if (result == BROTLI_DECODER_RESULT_ERROR) {
+            errorStr = QCoreApplication::translate("QHttp", "Error decompressing data (%1)")
+                    .arg(QString::fromLatin1(BrotliDecoderErrorString(
+                                                 BrotliDecoderGetErrorCode(brotliState))));
+            return -1;
+        }
+
+        const int produced = chunk.size() - int(availableOut);
+        if (produced > 0) {
+            chunk.resize(produced);
+            out->append(chunk);
+            total += produced;
+        }
+        if (result == BROTLI_DECODER_RESULT_SUCCESS) {
+            finished = true;
+            break;
+        }
+    } while (result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT || availableIn > 0);
+
+    return total;
+}
+#endif // QT_CONFIG(brotli)
+
+#if QT_CONFIG(zstd)
+qint64 QDecompressHelper::decompressZstandard(const char *data, qint64 size, QByteDataBuffer *out)
+{
+    qint64 total = 0;
+    ZSTD_inBuffer input = { data, size_t(size), 0 };
+    finished = false;
+
+    bool outputFull;
+    do {
+        QByteArray chunk(outputChunkSize(qint64(input.size - input.pos)), Qt::Uninitialized);
+        ZSTD_outBuffer output = { chunk.data(), size_t(chunk.size()), 0 };
+
+        const size_t ret = ZSTD_decompressStream(zstdStream, &output, &input);
+        if (ZSTD_isError(ret)) {
+            errorStr = QCoreApplication::translate("QHttp", "Error decompressing data (%1)")
+                    .arg(QString::fromLatin1(ZSTD_getErrorName(ret)));
+            return -1;
+        }
+
+        if (output.pos > 0) {
+            chunk.resize(int(output.pos));
+            out->append(chunk);
+            total += qint64(output.pos);
+        }
+        outputFull = output.pos == output.size;
+        // A zero return means a frame was completely decoded and flushed;
+        // further frames may follow in the same response.
+        finished = ret == 0;
+        if (finished && input.pos == input.size && !outputFull)
+            break;
+    } while (input.pos < input.size || outputFull);
+
+    return total;
+}
+#endif // QT_CONFIG(zstd)
+
+QT_END_NAMESPACE
+
+#endif // QT_NO_COMPRESS
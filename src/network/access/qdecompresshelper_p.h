@@ -0,0 +1,135 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QDECOMPRESSHELPER_P_H
+#define QDECOMPRESSHELPER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNetwork/private/qtnetworkglobal_p.h>
+#include <QtCore/qbytearray.h>
+
+#ifndef QT_NO_COMPRESS
+
+struct z_stream_s;
+#if QT_CONFIG(brotli)
+struct BrotliDecoderStateStruct;
+#endif
+#if QT_CONFIG(zstd)
+struct ZSTD_DCtx_s;
+#endif
+
+QT_BEGIN_NAMESPACE
+
+class QByteDataBuffer;
+
+// Streaming decoder for the HTTP content codings we advertise in
+// Accept-Encoding. Decoded data is appended to the caller's buffer in
+// chunks sized after the input, without intermediate copies.
+class Q_AUTOTEST_EXPORT QDecompressHelper
+{
+public:
+    enum ContentEncoding {
+        None,
+        Deflate,
+        GZip,
+        Brotli,
+        Zstandard
+    };
+
+    QDecompressHelper();
+    ~QDecompressHelper();
+
+    bool setEncoding(const QByteArray &contentEncoding);
+    bool setEncoding(ContentEncoding encoding);
+    ContentEncoding encoding() const { return contentEncoding; }
+    bool isValid() const { return contentEncoding != None; }
+    bool isFinished() const { return finished; }
+
+    qint64 decompress(const char *data, qint64 size, QByteDataBuffer *out);
+    void clear();
+
+    QString errorString() const { return errorStr; }
+
+    static ContentEncoding encodingFromName(const QByteArray &name);
+    static bool isSupportedEncoding(const QByteArray &name);
+    static QByteArray acceptedEncodings();
+
+private:
+    qint64 decompressZlib(const char *data, qint64 size, QByteDataBuffer *out);
+#if QT_CONFIG(brotli)
+    qint64 decompressBrotli(const char *data, qint64 size, QByteDataBuffer *out);
+#endif
+#if QT_CONFIG(zstd)
+    qint64 decompressZstandard(const char *data, qint64 size, QByteDataBuffer *out);
+#endif
+    bool initZlib(int windowBits);
+
+    ContentEncoding contentEncoding;
+    bool finished;
+    bool triedRawDeflate;
+    bool producedOutput;
+    QString errorStr;
+    QByteArray zlibInputSeen; // input consumed before the first output, for the raw deflate retry
+
+    z_stream_s *zlibStream;
+#if QT_CONFIG(brotli)
+    BrotliDecoderStateStruct *brotliState;
+#endif
+#if QT_CONFIG(zstd)
+    ZSTD_DCtx_s *zstdStream;
+#endif
+
+    Q_DISABLE_COPY(QDecompressHelper)
+};
+
+QT_END_NAMESPACE
+
+#endif // QT_NO_COMPRESS
+
+#endif // QDECOMPRESSHELPER_P_H
@@ -161,8 +161,6 @@ bool sum_will_overflow(qint32 windowSize, qint32 delta)
 using namespace Http2;
 
 const std::deque<quint32>::size_type QHttp2ProtocolHandler::maxRecycledStreams = 10000;
-const qint32 QHttp2ProtocolHandler::sessionMaxRecvWindowSize;
-const qint32 QHttp2ProtocolHandler::streamInitialRecvWindowSize;
 const quint32 QHttp2ProtocolHandler::maxAcceptableTableSize;
 
 QHttp2ProtocolHandler::QHttp2ProtocolHandler(QHttpNetworkConnectionChannel *channel)
@@ -171,6 +169,13 @@ QHttp2ProtocolHandler::QHttp2ProtocolHandler(QHttpNetworkConnectionChannel *chan
       encoder(HPack::FieldLookupTable::DefaultSize, true)
 {
     continuedFrames.reserve(20);
+
+    const auto connectionPrivate = m_connection->d_func();
+    maxLocalConcurrentStreams = connectionPrivate->http2MaxConcurrentStreams;
+    sessionMaxRecvWindowSize = connectionPrivate->http2SessionWindowSize;
+    sessionRecvWindowSize = sessionMaxRecvWindowSize;
+    streamInitialRecvWindowSize = connectionPrivate->http2StreamWindowSize;
+
     bool ok = false;
     const int env = qEnvironmentVariableIntValue("QT_HTTP2_ENABLE_PUSH_PROMISE", &ok);
     pushPromiseEnabled = ok && env;
@@ -306,7 +311,15 @@ bool QHttp2ProtocolHandler::sendRequest()
         initReplyFromPushPromise(message, key);
     }
 
-    const auto streamsToUse = std::min<quint32>(maxConcurrentStreams - activeStreams.size(),
+    const quint32 streamLimit = std::min(maxConcurrentStreams, maxLocalConcurrentStreams);
+    const quint32 activeCount = quint32(activeStreams.size());
+    if (activeCount >= streamLimit) {
+        // The peer could have lowered its limit below what we have in flight.
+        m_channel->state = QHttpNetworkConnectionChannel::IdleState;
+        return true;
+    }
+
+    const auto streamsToUse = std::min<quint32>(streamLimit - activeCount,
                                                 requests.size());
     auto it = requests.begin();
     for (quint32 i = 0; i < streamsToUse; ++i) {
@@ -320,6 +333,10 @@ bool QHttp2ProtocolHandler::sendRequest()
         it = requests.erase(it);
 
         Stream &newStream = activeStreams[newStreamID];
+        QNetworkTransferStatisticsPrivate &statistics = newStream.reply()->d_func()->statistics;
+        statistics.http2StreamId = int(newStreamID);
+        m_channel->recordConnectionStatistics(newStream.reply());
+
         if (!sendHEADERS(newStream)) {
             finishStreamWithError(newStream, QNetworkReply::UnknownNetworkError,
                                   QLatin1String("failed to send HEADERS frame(s)"));
@@ -362,6 +379,10 @@ bool QHttp2ProtocolHandler::sendClientPreface()
     frameWriter.append(quint32(Http2::maxFrameSize));
     frameWriter.append(Settings::ENABLE_PUSH_ID);
     frameWriter.append(quint32(pushPromiseEnabled));
+    if (streamInitialRecvWindowSize != Http2::defaultSessionWindowSize) {
+        frameWriter.append(Settings::INITIAL_WINDOW_SIZE_ID);
+        frameWriter.append(quint32(streamInitialRecvWindowSize));
+    }
 
     if (!frameWriter.write(*m_socket))
         return false;
@@ -421,7 +442,14 @@ bool QHttp2ProtocolHandler::sendHEADERS(Stream &stream)
     if (!encoder.encodeRequest(outputStream, headers))
         return false;
 
-    return frameWriter.writeHEADERS(*m_socket, maxFrameSize);
+    if (!frameWriter.writeHEADERS(*m_socket, maxFrameSize))
+        return false;
+
+    QNetworkTransferStatisticsPrivate &statistics = stream.reply()->d_func()->statistics;
+    statistics.bytesSent += frameWriter.outboundFrame().buffer.size();
+    if (!stream.data())
+        statistics.record(QNetworkTransferStatistics::RequestSent);
+    return true;
 }
 
 bool QHttp2ProtocolHandler::sendDATA(Stream &stream)
@@ -461,6 +489,7 @@ bool QHttp2ProtocolHandler::sendDATA(Stream &stream)
         stream.sendWindow -= bytesWritten;
         sessionSendWindowSize -= bytesWritten;
         replyPrivate->totallyUploadedData += bytesWritten;
+        replyPrivate->statistics.bytesSent += frameHeaderSize + bytesWritten;
         emit reply->dataSendProgress(replyPrivate->totallyUploadedData,
                                      request.contentLength());
         slot = std::min(sessionSendWindowSize, stream.sendWindow);
@@ -470,6 +499,8 @@ bool QHttp2ProtocolHandler::sendDATA(Stream &stream)
         frameWriter.start(FrameType::DATA, FrameFlag::END_STREAM, stream.streamID);
         frameWriter.setPayloadSize(0);
         frameWriter.write(*m_socket);
+        replyPrivate->statistics.bytesSent += frameHeaderSize;
+        replyPrivate->statistics.record(QNetworkTransferStatistics::RequestSent);
         stream.state = Stream::halfClosedLocal;
         stream.data()->disconnect(this);
         removeFromSuspended(stream.streamID);
@@ -927,6 +958,12 @@ void QHttp2ProtocolHandler::handleContinuedHEADERS()
     case FrameType::HEADERS:
         if (activeStreams.contains(streamID)) {
             Stream &stream = activeStreams[streamID];
+            if (auto httpReply = stream.reply()) {
+                QNetworkTransferStatisticsPrivate &statistics = httpReply->d_func()->statistics;
+                statistics.record(QNetworkTransferStatistics::ResponseStarted);
+                for (const Frame &frame : continuedFrames)
+                    statistics.bytesReceived += frameHeaderSize + frame.payloadSize();
+            }
             updateStream(stream, decoder.decodedHeader());
             // No DATA frames.
             if (continuedFrames[0].flags() & FrameFlag::END_STREAM) {
@@ -1097,21 +1134,22 @@ void QHttp2ProtocolHandler::updateStream(Stream &stream, const Frame &frame,
         return;
     }
 
+    httpReply->d_func()->statistics.bytesReceived += frameHeaderSize + frame.payloadSize();
+
     if (const auto length = frame.dataSize()) {
         const char *data = reinterpret_cast<const char *>(frame.dataBegin());
         auto &httpRequest = stream.request();
         auto replyPrivate = httpReply->d_func();
 
-        replyPrivate->compressedData.append(data, length);
         replyPrivate->totalProgress += length;
 
-        const QByteArray wrapped(data, length);
         if (httpRequest.d->autoDecompress && replyPrivate->isCompressed()) {
-            QByteDataBuffer inDataBuffer;
-            inDataBuffer.append(wrapped);
-            replyPrivate->uncompressBodyData(&inDataBuffer, &replyPrivate->responseData);
+            replyPrivate->uncompressBodyData(data, length, &replyPrivate->responseData);
         } else {
-            replyPrivate->responseData.append(wrapped);
+            // The payload belongs to the frame, which the next one replaces,
+            // so it has to be copied once. responseData then shares that
+            // QByteArray without copying it again.
+            replyPrivate->responseData.append(QByteArray(data, length));
         }
 
         if (replyPrivate->shouldEmitSignals()) {
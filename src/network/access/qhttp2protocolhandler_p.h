@@ -175,14 +175,18 @@ private:
     // Peer's max number of streams ...
     quint32 maxConcurrentStreams = Http2::maxConcurrentStreams;
 
-    // Control flow:
-    static const qint32 sessionMaxRecvWindowSize = Http2::defaultSessionWindowSize * 10;
+    // Our own limit, taken from the connection (the effective
+    // limit is the smaller of the two):
+    quint32 maxLocalConcurrentStreams = Http2::maxConcurrentStreams;
+
+    // Control flow (our receive windows are taken from the connection):
+    qint32 sessionMaxRecvWindowSize = Http2::defaultSessionWindowSize * 10;
     // Signed integer, it can become negative (it's still a valid window size):
     qint32 sessionRecvWindowSize = sessionMaxRecvWindowSize;
 
-    // We do not negotiate this window size
+    // Advertised via SETTINGS if it differs from the default.
     // We have to send WINDOW_UPDATE frames to our peer also.
-    static const qint32 streamInitialRecvWindowSize = Http2::defaultSessionWindowSize;
+    qint32 streamInitialRecvWindowSize = Http2::defaultSessionWindowSize;
 
     // Updated by SETTINGS and WINDOW_UPDATE.
     qint32 sessionSendWindowSize = Http2::defaultSessionWindowSize;
@@ -45,6 +45,7 @@
 #include <private/qobject_p.h>
 #include <private/qauthenticator_p.h>
 #include "private/qhostinfo_p.h"
+#include "private/http2protocol_p.h"
 #include <qnetworkproxy.h>
 #include <qauthenticator.h>
 #include <qcoreapplication.h>
@@ -88,11 +89,17 @@ QHttpNetworkConnectionPrivate::QHttpNetworkConnectionPrivate(const QString &host
 #endif
                         ? 1 : defaultHttpChannelCount)
   , channelCount(defaultHttpChannelCount)
+  , hostLookupStarted(0)
+  , hostLookupFinished(0)
 #ifndef QT_NO_NETWORKPROXY
   , networkProxy(QNetworkProxy::NoProxy)
 #endif
   , preConnectRequests(0)
   , connectionType(type)
+  , http2MaxConcurrentStreams(Http2::maxConcurrentStreams)
+  , http2SessionWindowSize(Http2::defaultSessionWindowSize * 10)
+  , http2StreamWindowSize(Http2::defaultSessionWindowSize)
+  , pipelineLength(defaultPipelineLength)
 {
     // We allocate all 6 channels even if it's SPDY or HTTP/2 enabled
     // connection: in case the protocol negotiation via NPN/ALPN fails,
@@ -106,13 +113,26 @@ QHttpNetworkConnectionPrivate::QHttpNetworkConnectionPrivate(quint16 connectionC
                                                              QHttpNetworkConnection::ConnectionType type)
 : state(RunningState), networkLayerState(Unknown),
   hostName(hostName), port(port), encrypt(encrypt), delayIpv4(true),
-  activeChannelCount(connectionCount), channelCount(connectionCount)
+  activeChannelCount(type == QHttpNetworkConnection::ConnectionTypeHTTP2
+#ifndef QT_NO_SSL
+                     || type == QHttpNetworkConnection::ConnectionTypeSPDY
+#endif
+                     ? 1 : connectionCount),
+  channelCount(connectionCount)
+  , hostLookupStarted(0)
+  , hostLookupFinished(0)
 #ifndef QT_NO_NETWORKPROXY
   , networkProxy(QNetworkProxy::NoProxy)
 #endif
   , preConnectRequests(0)
   , connectionType(type)
+  , http2MaxConcurrentStreams(Http2::maxConcurrentStreams)
+  , http2SessionWindowSize(Http2::defaultSessionWindowSize * 10)
+  , http2StreamWindowSize(Http2::defaultSessionWindowSize)
+  , pipelineLength(defaultPipelineLength)
 {
+    // As above, all channels stay available for an HTTP/1.1 fallback.
+    Q_ASSERT(channelCount >= activeChannelCount);
     channels = new QHttpNetworkConnectionChannel[channelCount];
 }
 
@@ -298,14 +318,15 @@ void QHttpNetworkConnectionPrivate::prepareRequest(HttpMessagePair &messagePair)
 #endif
 
     // If the request had a accept-encoding set, we better not mess
-    // with it. If it was not set, we announce that we understand gzip
+    // with it. If it was not set, we announce the encodings we can
+    // decompress (gzip and deflate, plus brotli and zstd when available)
     // and remember this fact in request.d->autoDecompress so that
     // we can later decompress the HTTP reply if it has such an
     // encoding.
     value = request.headerField("accept-encoding");
     if (value.isEmpty()) {
 #ifndef QT_NO_COMPRESS
-        request.setHeaderField("Accept-Encoding", "gzip, deflate");
+        request.setHeaderField("Accept-Encoding", QDecompressHelper::acceptedEncodings());
         request.d->autoDecompress = true;
 #else
         // if zlib is not available set this to false always
@@ -619,6 +640,7 @@ QHttpNetworkReply* QHttpNetworkConnectionPrivate::queueRequest(const QHttpNetwor
 
     // The reply component of the pair is created initially.
     QHttpNetworkReply *reply = new QHttpNetworkReply(request.url());
+    reply->d_func()->statistics.record(QNetworkTransferStatistics::RequestQueued);
     reply->setRequest(request);
     reply->d_func()->connection = q;
     reply->d_func()->connectionChannel = &channels[0]; // will have the correct one set later
@@ -739,7 +761,8 @@ void QHttpNetworkConnectionPrivate::fillPipeline(QAbstractSocket *socket)
     if (channels[i].reply == 0)
         return;
 
-    if (! (defaultPipelineLength - channels[i].alreadyPipelinedRequests.length() >= defaultRePipelineLength)) {
+    if (! (pipelineLength - channels[i].alreadyPipelinedRequests.length()
+           >= qMin(pipelineLength, defaultRePipelineLength))) {
         return;
     }
 
@@ -783,7 +806,7 @@ void QHttpNetworkConnectionPrivate::fillPipeline(QAbstractSocket *socket)
         lengthBefore = channels[i].alreadyPipelinedRequests.length();
         fillPipeline(highPriorityQueue, channels[i]);
 
-        if (channels[i].alreadyPipelinedRequests.length() >= defaultPipelineLength) {
+        if (channels[i].alreadyPipelinedRequests.length() >= pipelineLength) {
             channels[i].pipelineFlush();
             return;
         }
@@ -796,7 +819,7 @@ void QHttpNetworkConnectionPrivate::fillPipeline(QAbstractSocket *socket)
         lengthBefore = channels[i].alreadyPipelinedRequests.length();
         fillPipeline(lowPriorityQueue, channels[i]);
 
-        if (channels[i].alreadyPipelinedRequests.length() >= defaultPipelineLength) {
+        if (channels[i].alreadyPipelinedRequests.length() >= pipelineLength) {
             channels[i].pipelineFlush();
             return;
         }
@@ -1152,6 +1175,8 @@ void QHttpNetworkConnectionPrivate::startHostInfoLookup()
             return;
         }
     } else {
+        hostLookupStarted = QNetworkTransferStatisticsPrivate::now();
+        hostLookupFinished = 0;
         int hostLookupId;
         bool immediateResultValid = false;
         QHostInfo hostInfo = qt_qhostinfo_lookup(lookupHost,
@@ -1174,6 +1199,8 @@ void QHttpNetworkConnectionPrivate::_q_hostLookupFinished(const QHostInfo &info)
     if (networkLayerState == IPv4 || networkLayerState == IPv6 || networkLayerState == IPv4or6)
         return;
 
+    hostLookupFinished = QNetworkTransferStatisticsPrivate::now();
+
     const auto addresses = info.addresses();
     for (const QHostAddress &address : addresses) {
         const QAbstractSocket::NetworkLayerProtocol protocol = address.protocol();
@@ -1404,6 +1431,23 @@ void QHttpNetworkConnection::setConnectionType(ConnectionType type)
     d->connectionType = type;
 }
 
+// Must be called before the first request is sent; the values are
+// advertised in the SETTINGS frame that follows the client preface.
+void QHttpNetworkConnection::setHttp2Parameters(quint32 maxConcurrentStreams,
+                                                qint32 sessionWindowSize, qint32 streamWindowSize)
+{
+    Q_D(QHttpNetworkConnection);
+    d->http2MaxConcurrentStreams = maxConcurrentStreams;
+    d->http2SessionWindowSize = sessionWindowSize;
+    d->http2StreamWindowSize = streamWindowSize;
+}
+
+void QHttpNetworkConnection::setPipelineLength(int length)
+{
+    Q_D(QHttpNetworkConnection);
+    d->pipelineLength = length;
+}
+
 // SSL support below
 #ifndef QT_NO_SSL
 void QHttpNetworkConnection::setSslConfiguration(const QSslConfiguration &config)
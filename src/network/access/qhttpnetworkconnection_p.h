@@ -138,6 +138,10 @@ public:
     ConnectionType connectionType();
     void setConnectionType(ConnectionType type);
 
+    void setHttp2Parameters(quint32 maxConcurrentStreams, qint32 sessionWindowSize,
+                            qint32 streamWindowSize);
+    void setPipelineLength(int length);
+
 #ifndef QT_NO_SSL
     void setSslConfiguration(const QSslConfiguration &config);
     void ignoreSslErrors(int channel = -1);
@@ -249,6 +253,10 @@ public:
     const int channelCount;
     QTimer delayedConnectionTimer;
     QHttpNetworkConnectionChannel *channels; // parallel connections to the server
+
+    // When startHostInfoLookup() ran, for the transfer statistics
+    qint64 hostLookupStarted;
+    qint64 hostLookupFinished;
     bool shouldEmitChannelError(QAbstractSocket *socket);
 
     qint64 uncompressedBytesAvailable(const QHttpNetworkReply &reply) const;
@@ -272,6 +280,15 @@ public:
 
     QHttpNetworkConnection::ConnectionType connectionType;
 
+    // Our limit on concurrent streams and the receive windows
+    // we advertise, used if HTTP/2 is negotiated.
+    quint32 http2MaxConcurrentStreams;
+    qint32 http2SessionWindowSize;
+    qint32 http2StreamWindowSize;
+
+    // How many requests are pipelined behind the one in flight, if allowed.
+    int pipelineLength;
+
 #ifndef QT_NO_SSL
     QSharedPointer<QSslContext> sslContext;
 #endif
@@ -128,6 +128,9 @@ void QHttpNetworkConnectionChannel::init()
     QObject::connect(socket, SIGNAL(connected()),
                      this, SLOT(_q_connected()),
                      Qt::DirectConnection);
+    QObject::connect(socket, SIGNAL(hostFound()),
+                     this, SLOT(_q_hostFound()),
+                     Qt::DirectConnection);
     QObject::connect(socket, SIGNAL(readyRead()),
                      this, SLOT(_q_readyRead()),
                      Qt::DirectConnection);
@@ -308,6 +311,8 @@ bool QHttpNetworkConnectionChannel::ensureConnection()
         // connect to the host if not already connected.
         state = QHttpNetworkConnectionChannel::ConnectingState;
         pendingEncrypt = ssl;
+        connectionTimings = QNetworkConnectionTimings();
+        connectionTimings.started = QNetworkTransferStatisticsPrivate::now();
 
         // reset state
         pipeliningSupported = PipeliningSupportUnknown;
@@ -679,13 +684,17 @@ void QHttpNetworkConnectionChannel::pipelineInto(HttpMessagePair &pair)
     reply->d_func()->connectionChannel = this;
     reply->d_func()->autoDecompress = request.d->autoDecompress;
     reply->d_func()->pipeliningUsed = true;
+    recordConnectionStatistics(reply);
 
 #ifndef QT_NO_NETWORKPROXY
-    pipeline.append(QHttpNetworkRequestPrivate::header(request,
-                                                           (connection->d_func()->networkProxy.type() != QNetworkProxy::NoProxy)));
+    const QByteArray header = QHttpNetworkRequestPrivate::header(request,
+            (connection->d_func()->networkProxy.type() != QNetworkProxy::NoProxy));
 #else
-    pipeline.append(QHttpNetworkRequestPrivate::header(request, false));
+    const QByteArray header = QHttpNetworkRequestPrivate::header(request, false);
 #endif
+    pipeline.append(header);
+    reply->d_func()->statistics.bytesSent += header.size();
+    reply->d_func()->statistics.record(QNetworkTransferStatistics::RequestSent);
 
     alreadyPipelinedRequests.append(pair);
 
@@ -787,8 +796,24 @@ void QHttpNetworkConnectionChannel::_q_disconnected()
 }
 
 
+void QHttpNetworkConnectionChannel::_q_hostFound()
+{
+    if (!connectionTimings.hostFound)
+        connectionTimings.hostFound = QNetworkTransferStatisticsPrivate::now();
+}
+
+void QHttpNetworkConnectionChannel::recordConnectionStatistics(QHttpNetworkReply *reply)
+{
+    const QHttpNetworkConnectionPrivate *connectionPrivate = connection->d_func();
+    reply->d_func()->statistics.setConnectionTimings(connectionTimings,
+                                                     connectionPrivate->hostLookupStarted,
+                                                     connectionPrivate->hostLookupFinished);
+}
+
 void QHttpNetworkConnectionChannel::_q_connected()
 {
+    connectionTimings.connected = QNetworkTransferStatisticsPrivate::now();
+
     // For the Happy Eyeballs we need to check if this is the first channel to connect.
     if (connection->d_func()->networkLayerState == QHttpNetworkConnectionPrivate::HostLookupPending || connection->d_func()->networkLayerState == QHttpNetworkConnectionPrivate::IPv4or6) {
         if (connection->d_func()->delayedConnectionTimer.isActive())
@@ -1066,6 +1091,8 @@ void QHttpNetworkConnectionChannel::emitFinishedWithError(QNetworkReply::Network
 #ifndef QT_NO_SSL
 void QHttpNetworkConnectionChannel::_q_encrypted()
 {
+    connectionTimings.encrypted = QNetworkTransferStatisticsPrivate::now();
+
     QSslSocket *sslSocket = qobject_cast<QSslSocket *>(socket);
     Q_ASSERT(sslSocket);
 
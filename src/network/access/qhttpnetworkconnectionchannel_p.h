@@ -158,6 +158,11 @@ public:
 
     QAbstractSocket::NetworkLayerProtocol networkLayerPreference;
 
+    // How the current connection was established, and attaching that to the
+    // statistics of the requests sent over it
+    QNetworkConnectionTimings connectionTimings;
+    void recordConnectionStatistics(QHttpNetworkReply *reply);
+
     void setConnection(QHttpNetworkConnection *c);
     QPointer<QHttpNetworkConnection> connection;
 
@@ -194,6 +199,7 @@ public:
     void _q_readyRead(); // pending data to read
     void _q_disconnected(); // disconnected from host
     void _q_connected(); // start sending request
+    void _q_hostFound(); // for the connection timings
     void _q_error(QAbstractSocket::SocketError); // error from socket
 #ifndef QT_NO_NETWORKPROXY
     void _q_proxyAuthenticationRequired(const QNetworkProxy &proxy, QAuthenticator *auth); // from transparent proxy
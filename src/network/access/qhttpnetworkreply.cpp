@@ -48,10 +48,6 @@
 #    include <QtNetwork/qsslconfiguration.h>
 #endif
 
-#ifndef QT_NO_COMPRESS
-#include <zlib.h>
-#endif
-
 QT_BEGIN_NAMESPACE
 
 QHttpNetworkReply::QHttpNetworkReply(const QUrl &url, QObject *parent)
@@ -65,11 +61,6 @@ QHttpNetworkReply::~QHttpNetworkReply()
     if (d->connection) {
         d->connection->d_func()->removeReply(this);
     }
-
-#ifndef QT_NO_COMPRESS
-    if (d->autoDecompress && d->isCompressed() && d->inflateStrm)
-        inflateEnd(d->inflateStrm);
-#endif
 }
 
 QUrl QHttpNetworkReply::url() const
@@ -294,6 +285,11 @@ bool QHttpNetworkReply::isSpdyUsed() const
     return d_func()->spdyUsed;
 }
 
+QNetworkTransferStatisticsPrivate &QHttpNetworkReply::transferStatistics()
+{
+    return d_func()->statistics;
+}
+
 void QHttpNetworkReply::setSpdyWasUsed(bool spdy)
 {
     d_func()->spdyUsed = spdy;
@@ -336,10 +332,6 @@ QHttpNetworkReplyPrivate::QHttpNetworkReplyPrivate(const QUrl &newUrl)
       autoDecompress(false), responseData(), requestIsPrepared(false)
       ,pipeliningUsed(false), spdyUsed(false), downstreamLimited(false)
       ,userProvidedDownloadBuffer(0)
-#ifndef QT_NO_COMPRESS
-      ,inflateStrm(0)
-#endif
-
 {
     QString scheme = newUrl.scheme();
     if (scheme == QLatin1String("preconnect-http")
@@ -350,10 +342,6 @@ QHttpNetworkReplyPrivate::QHttpNetworkReplyPrivate(const QUrl &newUrl)
 
 QHttpNetworkReplyPrivate::~QHttpNetworkReplyPrivate()
 {
-#ifndef QT_NO_COMPRESS
-      if (inflateStrm)
-          delete inflateStrm;
-#endif
 }
 
 void QHttpNetworkReplyPrivate::clearHttpLayerInformation()
@@ -368,8 +356,7 @@ void QHttpNetworkReplyPrivate::clearHttpLayerInformation()
     lastChunkRead = false;
     connectionCloseEnabled = true;
 #ifndef QT_NO_COMPRESS
-    if (autoDecompress && inflateStrm)
-        inflateEnd(inflateStrm);
+    decompressHelper.clear();
 #endif
     fields.clear();
 }
@@ -391,8 +378,12 @@ qint64 QHttpNetworkReplyPrivate::bytesAvailable() const
 
 bool QHttpNetworkReplyPrivate::isCompressed()
 {
+#ifndef QT_NO_COMPRESS
+    return QDecompressHelper::isSupportedEncoding(headerField("content-encoding"));
+#else
     QByteArray encoding = headerField("content-encoding");
     return qstricmp(encoding.constData(), "gzip") == 0 || qstricmp(encoding.constData(), "deflate") == 0;
+#endif
 }
 
 void QHttpNetworkReplyPrivate::removeAutoDecompressHeader()
@@ -596,11 +587,7 @@ qint64 QHttpNetworkReplyPrivate::readHeader(QAbstractSocket *socket)
 
 #ifndef QT_NO_COMPRESS
         if (autoDecompress && isCompressed()) {
-            // allocate inflate state
-            if (!inflateStrm)
-                inflateStrm = new z_stream;
-            int ret = initializeInflateStream();
-            if (ret != Z_OK)
+            if (!decompressHelper.setEncoding(headerField("content-encoding")))
                 return -1;
         }
 #endif
@@ -707,8 +694,9 @@ qint64 QHttpNetworkReplyPrivate::readBody(QAbstractSocket *socket, QByteDataBuff
     qint64 bytes = 0;
 
 #ifndef QT_NO_COMPRESS
-    // for gzip we'll allocate a temporary one that we then decompress
-    QByteDataBuffer *tempOutDataBuffer = (autoDecompress ? new QByteDataBuffer : out);
+    // for compressed data we read into a temporary buffer that we then decompress
+    QByteDataBuffer compressedBuffer;
+    QByteDataBuffer *tempOutDataBuffer = (autoDecompress ? &compressedBuffer : out);
 #else
     QByteDataBuffer *tempOutDataBuffer = out;
 #endif
@@ -730,10 +718,11 @@ qint64 QHttpNetworkReplyPrivate::readBody(QAbstractSocket *socket, QByteDataBuff
 #ifndef QT_NO_COMPRESS
     // This is true if there is compressed encoding and we're supposed to use it.
     if (autoDecompress) {
-        qint64 uncompressRet = uncompressBodyData(tempOutDataBuffer, out);
-        delete tempOutDataBuffer;
-        if (uncompressRet < 0)
-            return -1;
+        for (int i = 0; i < compressedBuffer.bufferCount(); ++i) {
+            const QByteArray &chunk = compressedBuffer[i];
+            if (uncompressBodyData(chunk.constData(), chunk.size(), out) < 0)
+                return -1;
+        }
     }
 #endif
 
@@ -742,77 +731,14 @@ qint64 QHttpNetworkReplyPrivate::readBody(QAbstractSocket *socket, QByteDataBuff
 }
 
 #ifndef QT_NO_COMPRESS
-int QHttpNetworkReplyPrivate::initializeInflateStream()
-{
-    Q_ASSERT(inflateStrm);
-
-    inflateStrm->zalloc = Z_NULL;
-    inflateStrm->zfree = Z_NULL;
-    inflateStrm->opaque = Z_NULL;
-    inflateStrm->avail_in = 0;
-    inflateStrm->next_in = Z_NULL;
-    // "windowBits can also be greater than 15 for optional gzip decoding.
-    // Add 32 to windowBits to enable zlib and gzip decoding with automatic header detection"
-    // http://www.zlib.net/manual.html
-    int ret = inflateInit2(inflateStrm, MAX_WBITS+32);
-    Q_ASSERT(ret == Z_OK);
-    return ret;
-}
-
-qint64 QHttpNetworkReplyPrivate::uncompressBodyData(QByteDataBuffer *in, QByteDataBuffer *out)
+qint64 QHttpNetworkReplyPrivate::uncompressBodyData(const char *data, qint64 size, QByteDataBuffer *out)
 {
-    if (!inflateStrm) { // happens when called from the SPDY protocol handler
-        inflateStrm = new z_stream;
-        initializeInflateStream();
-    }
-
-    if (!inflateStrm)
+    // the HTTP/2 and SPDY protocol handlers don't go through readHeader()
+    if (!decompressHelper.isValid()
+            && !decompressHelper.setEncoding(headerField("content-encoding"))) {
         return -1;
-
-    bool triedRawDeflate = false;
-    for (int i = 0; i < in->bufferCount(); i++) {
-        QByteArray &bIn = (*in)[i];
-
-        inflateStrm->avail_in = bIn.size();
-        inflateStrm->next_in = reinterpret_cast<Bytef*>(bIn.data());
-
-        do {
-            QByteArray bOut;
-            // make a wild guess about the uncompressed size.
-            bOut.reserve(inflateStrm->avail_in * 3 + 512);
-            inflateStrm->avail_out = bOut.capacity();
-            inflateStrm->next_out = reinterpret_cast<Bytef*>(bOut.data());
-
-            int ret = inflate(inflateStrm, Z_NO_FLUSH);
-            //All negative return codes are errors, in the context of HTTP compression, Z_NEED_DICT is also an error.
-            // in the case where we get Z_DATA_ERROR this could be because we received raw deflate compressed data.
-            if (ret == Z_DATA_ERROR && !triedRawDeflate) {
-                inflateEnd(inflateStrm);
-                triedRawDeflate = true;
-                inflateStrm->zalloc = Z_NULL;
-                inflateStrm->zfree = Z_NULL;
-                inflateStrm->opaque = Z_NULL;
-                inflateStrm->avail_in = 0;
-                inflateStrm->next_in = Z_NULL;
-                int ret = inflateInit2(inflateStrm, -MAX_WBITS);
-                if (ret != Z_OK) {
-                    return -1;
-                } else {
-                    inflateStrm->avail_in = bIn.size();
-                    inflateStrm->next_in = reinterpret_cast<Bytef*>(bIn.data());
-                    continue;
-                }
-            } else if (ret < 0 || ret == Z_NEED_DICT) {
-                return -1;
-            }
-            bOut.resize(bOut.capacity() - inflateStrm->avail_out);
-            out->append(bOut);
-            if (ret == Z_STREAM_END)
-                return out->byteAmount();
-        } while (inflateStrm->avail_in > 0);
     }
-
-    return out->byteAmount();
+    return decompressHelper.decompress(data, size, out);
 }
 #endif
 
@@ -987,7 +913,6 @@ bool QHttpNetworkReplyPrivate::expectContent()
 
 void QHttpNetworkReplyPrivate::eraseData()
 {
-    compressedData.clear();
     responseData.clear();
 }
 
@@ -57,9 +57,6 @@
 
 #include <qplatformdefs.h>
 
-#ifndef QT_NO_COMPRESS
-struct z_stream_s;
-#endif
 
 #include <QtNetwork/qtcpsocket.h>
 // it's safe to include these even if SSL support is not enabled
@@ -76,6 +73,8 @@ struct z_stream_s;
 #include <private/qauthenticator_p.h>
 #include <private/qringbuffer_p.h>
 #include <private/qbytedata_p.h>
+#include <private/qdecompresshelper_p.h>
+#include <private/qnetworktransferstatistics_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -141,6 +140,8 @@ public:
     void setSpdyWasUsed(bool spdy);
     qint64 removedContentLength() const;
 
+    QNetworkTransferStatisticsPrivate &transferStatistics();
+
     bool isRedirecting() const;
 
     QHttpNetworkConnection* connection();
@@ -263,7 +264,6 @@ public:
     bool autoDecompress;
 
     QByteDataBuffer responseData; // uncompressed body
-    QByteArray compressedData; // compressed body (temporary)
     bool requestIsPrepared;
 
     bool pipeliningUsed;
@@ -273,10 +273,12 @@ public:
     char* userProvidedDownloadBuffer;
     QUrl redirectUrl;
 
+    // Not reset by clear(), a resent request keeps its statistics
+    QNetworkTransferStatisticsPrivate statistics;
+
 #ifndef QT_NO_COMPRESS
-    z_stream_s *inflateStrm;
-    int initializeInflateStream();
-    qint64 uncompressBodyData(QByteDataBuffer *in, QByteDataBuffer *out);
+    QDecompressHelper decompressHelper;
+    qint64 uncompressBodyData(const char *data, qint64 size, QByteDataBuffer *out);
 #endif
 };
 
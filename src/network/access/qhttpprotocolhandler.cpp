@@ -109,6 +109,10 @@ void QHttpProtocolHandler::_q_receiveReply()
                 return;
             }
             bytes += statusBytes;
+            if (statusBytes > 0) {
+                m_reply->d_func()->statistics.record(QNetworkTransferStatistics::ResponseStarted);
+                m_reply->d_func()->statistics.bytesReceived += statusBytes;
+            }
             m_channel->lastStatus = m_reply->d_func()->statusCode;
             break;
         }
@@ -121,6 +125,7 @@ void QHttpProtocolHandler::_q_receiveReply()
                 return;
             }
             bytes += headerBytes;
+            replyPrivate->statistics.bytesReceived += headerBytes;
             // If headers were parsed successfully now it is the ReadingDataState
             if (replyPrivate->state == QHttpNetworkReplyPrivate::ReadingDataState) {
                 if (replyPrivate->isCompressed() && replyPrivate->autoDecompress) {
@@ -170,6 +175,7 @@ void QHttpProtocolHandler::_q_receiveReply()
                qint64 haveRead = replyPrivate->readBodyVeryFast(m_socket, replyPrivate->userProvidedDownloadBuffer + replyPrivate->totalProgress);
                if (haveRead > 0) {
                    bytes += haveRead;
+                   replyPrivate->statistics.bytesReceived += haveRead;
                    replyPrivate->totalProgress += haveRead;
                    // the user will get notified of it via progress signal
                    emit m_reply->dataReadProgress(replyPrivate->totalProgress, replyPrivate->bodyLength);
@@ -185,6 +191,7 @@ void QHttpProtocolHandler::_q_receiveReply()
                  // we can therefore save on memory copying
                 qint64 haveRead = replyPrivate->readBodyFast(m_socket, &replyPrivate->responseData);
                 bytes += haveRead;
+                replyPrivate->statistics.bytesReceived += qMax<qint64>(haveRead, 0);
                 replyPrivate->totalProgress += haveRead;
                 if (replyPrivate->shouldEmitSignals()) {
                     emit m_reply->readyRead();
@@ -198,6 +205,7 @@ void QHttpProtocolHandler::_q_receiveReply()
                 qint64 haveRead = replyPrivate->readBody(m_socket, &replyPrivate->responseData);
                 if (haveRead > 0) {
                     bytes += haveRead;
+                    replyPrivate->statistics.bytesReceived += haveRead;
                     replyPrivate->totalProgress += haveRead;
                     if (replyPrivate->shouldEmitSignals()) {
                         emit m_reply->readyRead();
@@ -293,6 +301,7 @@ bool QHttpProtocolHandler::sendRequest()
         replyPrivate->connectionChannel = m_channel;
         replyPrivate->autoDecompress = m_channel->request.d->autoDecompress;
         replyPrivate->pipeliningUsed = false;
+        m_channel->recordConnectionStatistics(m_reply);
 
         // if the url contains authentication parameters, use the new ones
         // both channels will use the new authentication parameters
@@ -321,6 +330,7 @@ bool QHttpProtocolHandler::sendRequest()
         QByteArray header = QHttpNetworkRequestPrivate::header(m_channel->request, false);
 #endif
         m_socket->write(header);
+        replyPrivate->statistics.bytesSent += header.size();
         // flushing is dangerous (QSslSocket calls transmit which might read or error)
 //        m_socket->flush();
         QNonContiguousByteDevice* uploadByteDevice = m_channel->request.uploadByteDevice();
@@ -393,6 +403,7 @@ bool QHttpProtocolHandler::sendRequest()
                     return false;
                 } else {
                     m_channel->written += currentWriteSize;
+                    m_reply->d_func()->statistics.bytesSent += currentWriteSize;
                     uploadByteDevice->advanceReadPointer(currentWriteSize);
 
                     emit m_reply->dataSendProgress(m_channel->written, m_channel->bytesTotal);
@@ -411,6 +422,7 @@ bool QHttpProtocolHandler::sendRequest()
 
     case QHttpNetworkConnectionChannel::WaitingState:
     {
+        m_reply->d_func()->statistics.record(QNetworkTransferStatistics::RequestSent);
         QNonContiguousByteDevice* uploadByteDevice = m_channel->request.uploadByteDevice();
         if (uploadByteDevice) {
             QObject::disconnect(uploadByteDevice, SIGNAL(readyRead()), m_channel, SLOT(_q_uploadDataReadyRead()));
@@ -48,6 +48,7 @@
 #include "private/qhttpnetworkreply_p.h"
 #include "private/qnetworkaccesscache_p.h"
 #include "private/qnoncontiguousbytedevice_p.h"
+#include "private/http2protocol_p.h"
 
 #ifndef QT_NO_HTTP
 
@@ -178,15 +179,18 @@ class QNetworkAccessCachedHttpConnection: public QHttpNetworkConnection,
     // Q_OBJECT
 public:
 #ifdef QT_NO_BEARERMANAGEMENT
-    QNetworkAccessCachedHttpConnection(const QString &hostName, quint16 port, bool encrypt,
+    QNetworkAccessCachedHttpConnection(quint16 channelCount, const QString &hostName, quint16 port,
+                                       bool encrypt,
                                        QHttpNetworkConnection::ConnectionType connectionType)
-        : QHttpNetworkConnection(hostName, port, encrypt, connectionType)
+        : QHttpNetworkConnection(channelCount, hostName, port, encrypt, /*parent=*/0,
+                                 connectionType)
 #else
-    QNetworkAccessCachedHttpConnection(const QString &hostName, quint16 port, bool encrypt,
+    QNetworkAccessCachedHttpConnection(quint16 channelCount, const QString &hostName, quint16 port,
+                                       bool encrypt,
                                        QHttpNetworkConnection::ConnectionType connectionType,
                                        QSharedPointer<QNetworkSession> networkSession)
-        : QHttpNetworkConnection(hostName, port, encrypt, connectionType, /*parent=*/0,
-                                 qMove(networkSession))
+        : QHttpNetworkConnection(channelCount, hostName, port, encrypt, /*parent=*/0,
+                                 qMove(networkSession), connectionType)
 #endif
     {
         setExpires(true);
@@ -206,6 +210,12 @@ public:
 QThreadStorage<QNetworkAccessCache *> QHttpThreadDelegate::connections;
 
 
+void QHttpThreadDelegate::releaseIdleConnections(const QByteArray &scope)
+{
+    if (connections.hasLocalData())
+        connections.localData()->removeIdleEntries(scope);
+}
+
 QHttpThreadDelegate::~QHttpThreadDelegate()
 {
     // It could be that the main thread has asked us to shut down, so we need to delete the HTTP reply
@@ -216,7 +226,7 @@ QHttpThreadDelegate::~QHttpThreadDelegate()
     // Get the object cache that stores our QHttpNetworkConnection objects
     // and release the entry for this QHttpNetworkConnection
     if (connections.hasLocalData() && !cacheKey.isEmpty()) {
-        connections.localData()->releaseEntry(cacheKey);
+        connections.localData()->releaseEntry(cacheKey, connectionIdleTimeout);
     }
 }
 
@@ -230,6 +240,16 @@ QHttpThreadDelegate::QHttpThreadDelegate(QObject *parent) :
     , pendingDownloadData()
     , pendingDownloadProgress()
     , synchronous(false)
+    , maxConnectionsPerHost(QHttpNetworkConnectionPrivate::defaultHttpChannelCount)
+    , connectionIdleTimeout(QNetworkAccessCache::DefaultExpiryTimeout)
+    , http2MaxConcurrentStreams(Http2::maxConcurrentStreams)
+    , http2SessionWindowSize(Http2::defaultSessionWindowSize * 10)
+    , http2StreamWindowSize(Http2::defaultSessionWindowSize)
+    , pipelineLength(QHttpNetworkConnectionPrivate::defaultPipelineLength)
+    , downloadSink(0)
+    , downloadSinkBytesWritten(0)
+    , requestStartTime(0)
+    , requestStartMSecsSinceEpoch(0)
     , incomingStatusCode(0)
     , isPipeliningUsed(false)
     , isSpdyUsed(false)
@@ -260,7 +280,7 @@ void QHttpThreadDelegate::startRequestSynchronously()
     QMetaObject::invokeMethod(this, "startRequest", Qt::QueuedConnection);
     synchronousRequestLoop.exec();
 
-    connections.localData()->releaseEntry(cacheKey);
+    connections.localData()->releaseEntry(cacheKey, connectionIdleTimeout);
     connections.setLocalData(0);
 
 #ifdef QHTTPTHREADDELEGATE_DEBUG
@@ -313,7 +333,7 @@ void QHttpThreadDelegate::startRequest()
     else
 #endif
         cacheKey = makeCacheKey(urlCopy, 0);
-
+    cacheKey.prepend(connectionCacheScope);
 
     // the http object is actually a QHttpNetworkConnection
     httpConnection = static_cast<QNetworkAccessCachedHttpConnection *>(connections.localData()->requestEntryNow(cacheKey));
@@ -321,13 +341,18 @@ void QHttpThreadDelegate::startRequest()
         // no entry in cache; create an object
         // the http object is actually a QHttpNetworkConnection
 #ifdef QT_NO_BEARERMANAGEMENT
-        httpConnection = new QNetworkAccessCachedHttpConnection(urlCopy.host(), urlCopy.port(), ssl,
+        httpConnection = new QNetworkAccessCachedHttpConnection(maxConnectionsPerHost,
+                                                                urlCopy.host(), urlCopy.port(), ssl,
                                                                 connectionType);
 #else
-        httpConnection = new QNetworkAccessCachedHttpConnection(urlCopy.host(), urlCopy.port(), ssl,
+        httpConnection = new QNetworkAccessCachedHttpConnection(maxConnectionsPerHost,
+                                                                urlCopy.host(), urlCopy.port(), ssl,
                                                                 connectionType,
                                                                 networkSession);
 #endif
+        httpConnection->setHttp2Parameters(http2MaxConcurrentStreams, http2SessionWindowSize,
+                                           http2StreamWindowSize);
+        httpConnection->setPipelineLength(pipelineLength);
 #ifndef QT_NO_SSL
         // Set the QSslConfiguration from this QNetworkRequest.
         if (ssl && incomingSslConfiguration != QSslConfiguration::defaultConfiguration()) {
@@ -358,6 +383,8 @@ void QHttpThreadDelegate::startRequest()
     // Send the request to the connection
     httpReply = httpConnection->sendRequest(httpRequest);
     httpReply->setParent(this);
+    httpReply->transferStatistics().recordRequestStarted(requestStartTime,
+                                                        requestStartMSecsSinceEpoch);
 
     // Connect the reply signals that we need to handle and then forward
     if (synchronous) {
@@ -455,6 +482,11 @@ void QHttpThreadDelegate::readyReadSlot()
     if (!downloadBuffer.isNull())
         return;
 
+    if (downloadSink) {
+        writeToDownloadSink();
+        return;
+    }
+
     if (readBufferMaxSize) {
         if (bytesEmitted < readBufferMaxSize) {
             qint64 sizeEmitted = 0;
@@ -483,6 +515,51 @@ void QHttpThreadDelegate::readyReadSlot()
     }
 }
 
+// Called when the request finished, successfully or not
+void QHttpThreadDelegate::reportTransferStatistics()
+{
+    QNetworkTransferStatisticsPrivate &statistics = httpReply->transferStatistics();
+    statistics.record(QNetworkTransferStatistics::ResponseFinished);
+    statistics.valid = true;
+    if (QNetworkTrace::isEnabled())
+        QNetworkTrace::write(httpRequest.url(), httpReply->statusCode(), statistics);
+
+    incomingTransferStatistics = statistics.toPublic();
+    if (!synchronous)
+        emit transferStatistics(incomingTransferStatistics);
+}
+
+// Writes the available body data to the download sink and reports the
+// progress to the user thread. Returns false if writing failed, in which case
+// the request has been finished with an error.
+bool QHttpThreadDelegate::writeToDownloadSink()
+{
+    // The body of a redirect response that we follow is not part of the result
+    const bool discard = httpRequest.isFollowRedirects() && httpReply->isRedirecting();
+
+    const qint64 previouslyWritten = downloadSinkBytesWritten;
+    while (httpReply->readAnyAvailable()) {
+        const QByteArray block = httpReply->readAny();
+        if (discard)
+            continue;
+        if (downloadSink->write(block) != block.size()) {
+            const QString msg = QLatin1String(QT_TRANSLATE_NOOP("QNetworkReply",
+                                                                "Error writing downloaded data: %1"));
+            httpReply->abort();
+            finishedWithErrorSlot(QNetworkReply::UnknownContentError,
+                                  msg.arg(downloadSink->errorString()));
+            return false;
+        }
+        downloadSinkBytesWritten += block.size();
+    }
+
+    if (downloadSinkBytesWritten != previouslyWritten) {
+        pendingDownloadProgress->fetchAndAddRelease(1);
+        emit downloadProgress(downloadSinkBytesWritten, httpReply->contentLength());
+    }
+    return true;
+}
+
 void QHttpThreadDelegate::finishedSlot()
 {
     if (!httpReply)
@@ -493,9 +570,14 @@ void QHttpThreadDelegate::finishedSlot()
 #endif
 
     // If there is still some data left emit that now
-    while (httpReply->readAnyAvailable()) {
-        pendingDownloadData->fetchAndAddRelease(1);
-        emit downloadData(httpReply->readAny());
+    if (downloadSink) {
+        if (!writeToDownloadSink())
+            return;
+    } else {
+        while (httpReply->readAnyAvailable()) {
+            pendingDownloadData->fetchAndAddRelease(1);
+            emit downloadData(httpReply->readAny());
+        }
     }
 
 #ifndef QT_NO_SSL
@@ -514,6 +596,7 @@ void QHttpThreadDelegate::finishedSlot()
     if (httpRequest.isFollowRedirects() && httpReply->isRedirecting())
         emit redirected(httpReply->redirectUrl(), httpReply->statusCode(), httpReply->request().redirectCount() - 1);
 
+    reportTransferStatistics();
     emit downloadFinished();
 
     QMetaObject::invokeMethod(httpReply, "deleteLater", Qt::QueuedConnection);
@@ -538,6 +621,7 @@ void QHttpThreadDelegate::synchronousFinishedSlot()
     }
 
     synchronousDownloadData = httpReply->readAll();
+    reportTransferStatistics();
 
     QMetaObject::invokeMethod(httpReply, "deleteLater", Qt::QueuedConnection);
     QMetaObject::invokeMethod(synchronousRequestLoop, "quit", Qt::QueuedConnection);
@@ -557,6 +641,7 @@ void QHttpThreadDelegate::finishedWithErrorSlot(QNetworkReply::NetworkError erro
     if (ssl)
         emit sslConfigurationChanged(httpReply->sslConfiguration());
 #endif
+    reportTransferStatistics();
     emit error(errorCode,detail);
     emit downloadFinished();
 
@@ -579,6 +664,7 @@ void QHttpThreadDelegate::synchronousFinishedWithErrorSlot(QNetworkReply::Networ
     incomingErrorDetail = detail;
 
     synchronousDownloadData = httpReply->readAll();
+    reportTransferStatistics();
 
     QMetaObject::invokeMethod(httpReply, "deleteLater", Qt::QueuedConnection);
     QMetaObject::invokeMethod(synchronousRequestLoop, "quit", Qt::QueuedConnection);
@@ -66,6 +66,7 @@
 #include "qsslconfiguration.h"
 #include "private/qnoncontiguousbytedevice_p.h"
 #include "qnetworkaccessauthenticationmanager_p.h"
+#include "qnetworktransferstatistics.h"
 
 #ifndef QT_NO_HTTP
 
@@ -103,6 +104,23 @@ public:
 #endif
     QSharedPointer<QNetworkAccessAuthenticationManager> authenticationManager;
     bool synchronous;
+    // Connection pool policy, from QNetworkAccessManager
+    quint16 maxConnectionsPerHost;
+    int connectionIdleTimeout;
+    quint32 http2MaxConcurrentStreams;
+    qint32 http2SessionWindowSize;
+    qint32 http2StreamWindowSize;
+    int pipelineLength;
+    // Prepended to the connection cache key, so that managers sharing a
+    // network thread don't share connections
+    QByteArray connectionCacheScope;
+    // If set, body data is written here in this thread instead of being
+    // emitted through downloadData()
+    QIODevice *downloadSink;
+    qint64 downloadSinkBytesWritten;
+    // When QNetworkAccessManager started the request, for the statistics
+    qint64 requestStartTime;
+    qint64 requestStartMSecsSinceEpoch;
 
     // outgoing, Retrieved in the synchronous HTTP case
     QByteArray synchronousDownloadData;
@@ -115,6 +133,7 @@ public:
     qint64 removedContentLength;
     QNetworkReply::NetworkError incomingErrorCode;
     QString incomingErrorDetail;
+    QNetworkTransferStatistics incomingTransferStatistics;
 #ifndef QT_NO_BEARERMANAGEMENT
     QSharedPointer<QNetworkSession> networkSession;
 #endif
@@ -148,6 +167,7 @@ signals:
     void error(QNetworkReply::NetworkError, const QString &);
     void downloadFinished();
     void redirected(const QUrl &url, int httpStatus, int maxRedirectsRemainig);
+    void transferStatistics(const QNetworkTransferStatistics &statistics);
 
 public slots:
     // This are called via QueuedConnection from user thread
@@ -180,7 +200,15 @@ protected slots:
     void synchronousProxyAuthenticationRequiredSlot(const QNetworkProxy &, QAuthenticator *);
 #endif
 
+public:
+    // Called in a network thread; disposes of the idle connections whose
+    // cache key starts with scope
+    static void releaseIdleConnections(const QByteArray &scope);
+
 protected:
+    bool writeToDownloadSink();
+    void reportTransferStatistics();
+
     // Cache for all the QHttpNetworkConnection objects.
     // This is per thread.
     static QThreadStorage<QNetworkAccessCache *> connections;
@@ -47,10 +47,6 @@
 
 QT_BEGIN_NAMESPACE
 
-enum ExpiryTimeEnum {
-    ExpiryTime = 120
-};
-
 namespace {
     struct Receiver
     {
@@ -70,9 +66,11 @@ struct QNetworkAccessCache::Node
     CacheableObject *object;
 
     int useCount;
+    int expiryTimeout;
 
     Node()
-        : older(0), newer(0), object(0), useCount(0)
+        : older(0), newer(0), object(0), useCount(0),
+          expiryTimeout(QNetworkAccessCache::DefaultExpiryTimeout)
     { }
 };
 
@@ -133,8 +131,40 @@ void QNetworkAccessCache::clear()
 }
 
 /*!
-    Appends the entry given by \a key to the end of the linked list.
-    (i.e., makes it the newest entry)
+    Disposes of all entries whose key starts with \a keyPrefix and that are
+    not in use. Entries in use are left alone; they expire as usual once they
+    are released.
+ */
+void QNetworkAccessCache::removeIdleEntries(const QByteArray &keyPrefix)
+{
+    QList<CacheableObject *> removed;
+    bool timerNeedsUpdate = false;
+    NodeHash::Iterator it = hash.begin();
+    while (it != hash.end()) {
+        if (it->useCount || !it.key().startsWith(keyPrefix)) {
+            ++it;
+            continue;
+        }
+
+        if (unlinkEntry(it.key()))
+            timerNeedsUpdate = true;
+        it->object->key.clear();
+        removed.append(it->object);
+        it = hash.erase(it);
+    }
+
+    if (timerNeedsUpdate)
+        updateTimer();
+
+    // dispose only after the hash is consistent again
+    for (CacheableObject *object : qAsConst(removed))
+        object->dispose();
+}
+
+/*!
+    Inserts the entry given by \a key into the linked list, which is
+    ordered by expiry time. Entries usually share their expiry timeout, so
+    this normally appends the entry (i.e., makes it the newest entry).
  */
 void QNetworkAccessCache::linkEntry(const QByteArray &key)
 {
@@ -147,18 +177,24 @@ void QNetworkAccessCache::linkEntry(const QByteArray &key)
     Q_ASSERT(node->older == 0 && node->newer == 0);
     Q_ASSERT(node->useCount == 0);
 
-    if (newest) {
-        Q_ASSERT(newest->newer == 0);
-        newest->newer = node;
-        node->older = newest;
-    }
-    if (!oldest) {
-        // there are no entries, so this is the oldest one too
-        oldest = node;
-    }
+    node->timestamp = QDateTime::currentDateTimeUtc().addMSecs(node->expiryTimeout);
+
+    // skip the entries that expire after this one
+    Node *older = newest;
+    while (older && node->timestamp < older->timestamp)
+        older = older->older;
 
-    node->timestamp = QDateTime::currentDateTimeUtc().addSecs(ExpiryTime);
-    newest = node;
+    Node *newer = older ? older->newer : oldest;
+    node->older = older;
+    node->newer = newer;
+    if (older)
+        older->newer = node;
+    else
+        oldest = node;
+    if (newer)
+        newer->older = node;
+    else
+        newest = node;
 }
 
 /*!
@@ -196,15 +232,16 @@ void QNetworkAccessCache::updateTimer()
     if (!oldest)
         return;
 
-    int interval = QDateTime::currentDateTimeUtc().secsTo(oldest->timestamp);
+    qint64 interval = QDateTime::currentDateTimeUtc().msecsTo(oldest->timestamp);
     if (interval <= 0) {
         interval = 0;
-    } else {
-        // round up the interval
-        interval = (interval + 15) & ~16;
+    } else if (oldest->expiryTimeout >= 16000) {
+        // round up the interval, so that entries released close to each
+        // other expire together
+        interval = (interval + 15999) / 16000 * 16000;
     }
 
-    timer.start(interval * 1000, this);
+    timer.start(int(interval), this);
 }
 
 bool QNetworkAccessCache::emitEntryReady(Node *node, QObject *target, const char *member)
@@ -318,7 +355,16 @@ QNetworkAccessCache::CacheableObject *QNetworkAccessCache::requestEntryNow(const
     return it->object;
 }
 
-void QNetworkAccessCache::releaseEntry(const QByteArray &key)
+/*!
+    Releases the entry given by \a key. Once it is no longer in use, it
+    stays in the cache for \a expiryTimeout milliseconds before it expires,
+    if it expires at all. The default is two minutes.
+
+    The timeout is passed with the entry because the cache can be shared by
+    users with different timeouts, such as the QNetworkAccessManagers
+    sharing a network thread.
+ */
+void QNetworkAccessCache::releaseEntry(const QByteArray &key, int expiryTimeout)
 {
     NodeHash::Iterator it = hash.find(key);
     if (it == hash.end()) {
@@ -329,6 +375,7 @@ void QNetworkAccessCache::releaseEntry(const QByteArray &key)
 
     Node *node = &it.value();
     Q_ASSERT(node->useCount > 0);
+    node->expiryTimeout = qMax(0, expiryTimeout);
 
     // are there other objects waiting?
     if (!node->receiverQueue.isEmpty()) {
@@ -90,16 +90,19 @@ public:
         void setShareable(bool enable);
     };
 
+    enum { DefaultExpiryTimeout = 120 * 1000 };
+
     QNetworkAccessCache();
     ~QNetworkAccessCache();
 
     void clear();
+    void removeIdleEntries(const QByteArray &keyPrefix);
 
     void addEntry(const QByteArray &key, CacheableObject *entry);
     bool hasEntry(const QByteArray &key) const;
     bool requestEntry(const QByteArray &key, QObject *target, const char *member);
     CacheableObject *requestEntryNow(const QByteArray &key);
-    void releaseEntry(const QByteArray &key);
+    void releaseEntry(const QByteArray &key, int expiryTimeout = DefaultExpiryTimeout);
     void removeEntry(const QByteArray &key);
 
 signals:
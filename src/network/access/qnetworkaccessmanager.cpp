@@ -70,8 +70,14 @@
 #include "qhttpmultipart_p.h"
 
 #include "qnetworkreplyhttpimpl_p.h"
+#ifndef QT_NO_HTTP
+#include "qhttpthreaddelegate_p.h"
+#endif
 
 #include "qthread.h"
+#include "QtCore/qcoreapplication.h"
+#include "QtCore/qmutex.h"
+#include "QtCore/qtimer.h"
 
 #include <QHostInfo>
 
@@ -92,6 +98,103 @@ Q_GLOBAL_STATIC(QNetworkAccessFtpBackendFactory, ftpBackend)
 Q_GLOBAL_STATIC(QNetworkAccessDebugPipeBackendFactory, debugpipeBackend)
 #endif
 
+// The network threads shared by all QNetworkAccessManager objects, see
+// QNetworkAccessManager::setNetworkThreadCount(). The threads are started on
+// demand and run until the application exits.
+class QNetworkAccessThreadPool
+{
+public:
+    ~QNetworkAccessThreadPool() { shutdown(); }
+
+    void setThreadCount(int count)
+    {
+        QMutexLocker locker(&mutex);
+        threadCount = count;
+    }
+
+    int count() const
+    {
+        QMutexLocker locker(&mutex);
+        return threadCount;
+    }
+
+    QThread *threadForUrl(const QUrl &url);
+    void releaseIdleConnections(const QByteArray &scope);
+    void shutdown();
+
+private:
+    mutable QMutex mutex;
+    int threadCount = 0;
+    bool postRoutineAdded = false;
+    QVector<QThread *> threads;
+    // one object living in each thread, to queue calls to that thread
+    QVector<QObject *> contexts;
+};
+Q_GLOBAL_STATIC(QNetworkAccessThreadPool, networkThreadPool)
+
+static void networkThreadPool_cleanup()
+{
+    if (networkThreadPool.exists())
+        networkThreadPool->shutdown();
+}
+
+QThread *QNetworkAccessThreadPool::threadForUrl(const QUrl &url)
+{
+    QMutexLocker locker(&mutex);
+    if (threadCount <= 0)
+        return Q_NULLPTR;
+
+    // Requests to the same origin always go to the same thread, so that they
+    // can reuse the connections kept in that thread's connection cache.
+    const uint hash = qHash(url.scheme()) ^ qHash(url.host().toLower()) ^ uint(url.port());
+    const int index = int(hash % uint(threadCount));
+
+    while (threads.size() <= index) {
+        QThread *thread = new QThread;
+        thread->setObjectName(QStringLiteral("QNetworkAccessManager thread %1").arg(threads.size()));
+        thread->start();
+        QObject *context = new QObject;
+        context->moveToThread(thread);
+        QObject::connect(thread, SIGNAL(finished()), context, SLOT(deleteLater()));
+        threads.append(thread);
+        contexts.append(context);
+    }
+
+    if (!postRoutineAdded) {
+        qAddPostRoutine(networkThreadPool_cleanup);
+        postRoutineAdded = true;
+    }
+    return threads.at(index);
+}
+
+void QNetworkAccessThreadPool::releaseIdleConnections(const QByteArray &scope)
+{
+#ifndef QT_NO_HTTP
+    QMutexLocker locker(&mutex);
+    for (QObject *context : qAsConst(contexts))
+        QTimer::singleShot(0, context, [scope]() { QHttpThreadDelegate::releaseIdleConnections(scope); });
+#else
+    Q_UNUSED(scope);
+#endif
+}
+
+void QNetworkAccessThreadPool::shutdown()
+{
+    QMutexLocker locker(&mutex);
+    for (QThread *thread : qAsConst(threads))
+        thread->quit();
+    for (QThread *thread : qAsConst(threads)) {
+        thread->wait(5000);
+        if (thread->isFinished())
+            delete thread;
+        else
+            QObject::connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
+    }
+    threads.clear();
+    contexts.clear();
+    postRoutineAdded = false;
+}
+
 #if defined(Q_OS_MACX)
 bool getProxyAuth(const QString& proxyHostname, const QString &scheme, QString& username, QString& password)
 {
@@ -474,6 +577,7 @@ QNetworkAccessManager::QNetworkAccessManager(QObject *parent)
 #endif
     qRegisterMetaType<QNetworkReply::NetworkError>();
     qRegisterMetaType<QSharedPointer<char> >();
+    qRegisterMetaType<QNetworkTransferStatistics>();
 
 #ifndef QT_NO_BEARERMANAGEMENT
     Q_D(QNetworkAccessManager);
@@ -1113,6 +1217,10 @@ QSharedPointer<QNetworkSession> QNetworkAccessManagerPrivate::getNetworkSession(
 
     \note This function has no possibility to report errors.
 
+    Each call opens at most one additional connection to the host, so calling
+    this function several times prewarms up to maximumConnectionsPerHost()
+    connections that later requests can use without waiting for a handshake.
+
     \sa connectToHost(), get(), post(), put(), deleteResource()
 */
 void QNetworkAccessManager::connectToHostEncrypted(const QString &hostName, quint16 port,
@@ -1145,6 +1253,10 @@ void QNetworkAccessManager::connectToHostEncrypted(const QString &hostName, quin
 
     \note This function has no possibility to report errors.
 
+    Each call opens at most one additional connection to the host, so calling
+    this function several times prewarms up to maximumConnectionsPerHost()
+    connections.
+
     \sa connectToHostEncrypted(), get(), post(), put(), deleteResource()
 */
 void QNetworkAccessManager::connectToHost(const QString &hostName, quint16 port)
@@ -1196,6 +1308,243 @@ QNetworkRequest::RedirectPolicy QNetworkAccessManager::redirectPolicy() const
     return d->redirectPolicy;
 }
 
+/*!
+    \since 5.10
+
+    Sets the maximum number of HTTP/1.1 connections opened in parallel to a
+    single host to \a count. The default is 6. Values smaller than 1 are
+    treated as 1.
+
+    HTTP/2 and SPDY multiplex requests over one connection regardless of
+    this setting; the remaining connections are only used if the server
+    falls back to HTTP/1.1.
+
+    The setting applies to connections to hosts that the manager has no
+    open connection to yet.
+
+    \sa maximumConnectionsPerHost(), setConnectionIdleTimeout(), connectToHost()
+*/
+void QNetworkAccessManager::setMaximumConnectionsPerHost(int count)
+{
+    Q_D(QNetworkAccessManager);
+    d->maxConnectionsPerHost = qBound(1, count, int(std::numeric_limits<quint16>::max()));
+}
+
+/*!
+    \since 5.10
+
+    Returns the maximum number of parallel connections to a single host.
+
+    \sa setMaximumConnectionsPerHost()
+*/
+int QNetworkAccessManager::maximumConnectionsPerHost() const
+{
+    Q_D(const QNetworkAccessManager);
+    return d->maxConnectionsPerHost;
+}
+
+/*!
+    \since 5.10
+
+    Sets the time, in milliseconds, that an unused keep-alive connection is
+    kept open before it is closed to \a msecs. The default is 120000 (two
+    minutes). A value of 0 closes connections as soon as they become idle.
+
+    \sa connectionIdleTimeout(), setMaximumConnectionsPerHost()
+*/
+void QNetworkAccessManager::setConnectionIdleTimeout(int msecs)
+{
+    Q_D(QNetworkAccessManager);
+    d->connectionIdleTimeout = qMax(0, msecs);
+}
+
+/*!
+    \since 5.10
+
+    Returns the time, in milliseconds, that an idle connection is kept open.
+
+    \sa setConnectionIdleTimeout()
+*/
+int QNetworkAccessManager::connectionIdleTimeout() const
+{
+    Q_D(const QNetworkAccessManager);
+    return d->connectionIdleTimeout;
+}
+
+/*!
+    \since 5.10
+
+    Sets the number of requests that may be pipelined on an HTTP/1.1
+    connection behind the request currently in flight to \a length. The
+    default is 3. Values smaller than 1 are treated as 1.
+
+    Only requests that set QNetworkRequest::HttpPipeliningAllowedAttribute
+    are pipelined, and only once the server has been seen to support
+    persistent connections.
+
+    The setting applies to connections to hosts that the manager has no
+    open connection to yet.
+
+    \sa httpPipelineLength(), setMaximumConnectionsPerHost()
+*/
+void QNetworkAccessManager::setHttpPipelineLength(int length)
+{
+    Q_D(QNetworkAccessManager);
+    d->httpPipelineLength = qMax(1, length);
+}
+
+/*!
+    \since 5.10
+
+    Returns the number of requests that may be pipelined behind the one in
+    flight on an HTTP/1.1 connection.
+
+    \sa setHttpPipelineLength()
+*/
+int QNetworkAccessManager::httpPipelineLength() const
+{
+    Q_D(const QNetworkAccessManager);
+    return d->httpPipelineLength;
+}
+
+/*!
+    \since 5.10
+
+    Sets the maximum number of requests that are sent in parallel over one
+    HTTP/2 connection to \a count. The default is 100. If the server
+    announces a smaller limit, the server's limit is used. Values smaller
+    than 1 are treated as 1.
+
+    The setting applies to HTTP/2 connections opened after this call.
+
+    \sa http2MaximumConcurrentStreams(), setHttp2SessionReceiveWindowSize(),
+    QNetworkRequest::HTTP2AllowedAttribute
+*/
+void QNetworkAccessManager::setHttp2MaximumConcurrentStreams(int count)
+{
+    Q_D(QNetworkAccessManager);
+    d->http2MaxConcurrentStreams = qMax(1, count);
+}
+
+/*!
+    \since 5.10
+
+    Returns the maximum number of parallel requests per HTTP/2 connection.
+
+    \sa setHttp2MaximumConcurrentStreams()
+*/
+int QNetworkAccessManager::http2MaximumConcurrentStreams() const
+{
+    Q_D(const QNetworkAccessManager);
+    return d->http2MaxConcurrentStreams;
+}
+
+/*!
+    \since 5.10
+
+    Sets the connection-level receive window of HTTP/2 connections to
+    \a size bytes. This is the amount of response data the server can send,
+    summed over all streams, before it has to wait for the client to process
+    it. The default is 655350 bytes. The value is bounded to the range
+    allowed by RFC 7540, with the protocol default of 65535 as minimum.
+
+    Larger windows improve throughput on links with a high bandwidth-delay
+    product at the cost of memory.
+
+    The setting applies to HTTP/2 connections opened after this call.
+
+    \sa http2SessionReceiveWindowSize(), setHttp2StreamReceiveWindowSize()
+*/
+void QNetworkAccessManager::setHttp2SessionReceiveWindowSize(int size)
+{
+    Q_D(QNetworkAccessManager);
+    d->http2SessionWindowSize = qMax(int(Http2::defaultSessionWindowSize), size);
+}
+
+/*!
+    \since 5.10
+
+    Returns the connection-level HTTP/2 receive window size.
+
+    \sa setHttp2SessionReceiveWindowSize()
+*/
+int QNetworkAccessManager::http2SessionReceiveWindowSize() const
+{
+    Q_D(const QNetworkAccessManager);
+    return d->http2SessionWindowSize;
+}
+
+/*!
+    \since 5.10
+
+    Sets the receive window of each HTTP/2 stream to \a size bytes; this is
+    announced to the server with the initial SETTINGS frame. The default is
+    65535 bytes. Values smaller than 1 are treated as 1.
+
+    The setting applies to HTTP/2 connections opened after this call.
+
+    \sa http2StreamReceiveWindowSize(), setHttp2SessionReceiveWindowSize()
+*/
+void QNetworkAccessManager::setHttp2StreamReceiveWindowSize(int size)
+{
+    Q_D(QNetworkAccessManager);
+    d->http2StreamWindowSize = qMax(1, size);
+}
+
+/*!
+    \since 5.10
+
+    Returns the HTTP/2 per-stream receive window size.
+
+    \sa setHttp2StreamReceiveWindowSize()
+*/
+int QNetworkAccessManager::http2StreamReceiveWindowSize() const
+{
+    Q_D(const QNetworkAccessManager);
+    return d->http2StreamWindowSize;
+}
+
+/*!
+    \since 5.10
+
+    Sets the number of network threads shared by all QNetworkAccessManager
+    objects in the application to \a count.
+
+    By default, \a count is 0 and each QNetworkAccessManager processes its
+    HTTP requests in a thread of its own. With a larger count, requests are
+    distributed over a common pool of up to \a count threads instead. All
+    requests to the same scheme, host and port are handled by the same
+    thread, so that they can reuse its open connections. Connections are
+    never shared between different QNetworkAccessManager objects.
+
+    The threads are started when they are first needed and keep running
+    until the application exits. Changing the count affects requests sent
+    after the call; requests already in progress are not moved.
+
+    This function is thread-safe.
+
+    \sa networkThreadCount(), QNetworkRequest::DownloadSinkAttribute
+*/
+void QNetworkAccessManager::setNetworkThreadCount(int count)
+{
+    networkThreadPool()->setThreadCount(qMax(0, count));
+}
+
+/*!
+    \since 5.10
+
+    Returns the number of network threads shared by all
+    QNetworkAccessManager objects, or 0 if each manager uses its own thread.
+
+    This function is thread-safe.
+
+    \sa setNetworkThreadCount()
+*/
+int QNetworkAccessManager::networkThreadCount()
+{
+    return networkThreadPool()->count();
+}
+
 /*!
     \since 4.7
 
@@ -1725,15 +2074,29 @@ void QNetworkAccessManagerPrivate::clearConnectionCache(QNetworkAccessManager *m
 {
     manager->d_func()->objectCache.clear();
     manager->d_func()->destroyThread();
+    if (networkThreadPool.exists())
+        networkThreadPool->releaseIdleConnections(manager->d_func()->connectionCacheScope);
 }
 
 QNetworkAccessManagerPrivate::~QNetworkAccessManagerPrivate()
 {
     destroyThread();
+    if (networkThreadPool.exists())
+        networkThreadPool->releaseIdleConnections(connectionCacheScope);
 }
 
-QThread * QNetworkAccessManagerPrivate::createThread()
+QByteArray QNetworkAccessManagerPrivate::nextConnectionCacheScope()
 {
+    static QBasicAtomicInt counter = Q_BASIC_ATOMIC_INITIALIZER(0);
+    return QByteArray::number(counter.fetchAndAddRelaxed(1)) + ' ';
+}
+
+QThread * QNetworkAccessManagerPrivate::createThread(const QUrl &url)
+{
+    QNetworkAccessThreadPool *pool = networkThreadPool();
+    if (QThread *shared = pool ? pool->threadForUrl(url) : Q_NULLPTR)
+        return shared;
+
     if (!thread) {
         thread = new QThread;
         thread->setObjectName(QStringLiteral("QNetworkAccessManager thread"));
@@ -158,6 +158,23 @@ public:
     void setRedirectPolicy(QNetworkRequest::RedirectPolicy policy);
     QNetworkRequest::RedirectPolicy redirectPolicy() const;
 
+    void setMaximumConnectionsPerHost(int count);
+    int maximumConnectionsPerHost() const;
+    void setConnectionIdleTimeout(int msecs);
+    int connectionIdleTimeout() const;
+    void setHttpPipelineLength(int length);
+    int httpPipelineLength() const;
+
+    void setHttp2MaximumConcurrentStreams(int count);
+    int http2MaximumConcurrentStreams() const;
+    void setHttp2SessionReceiveWindowSize(int size);
+    int http2SessionReceiveWindowSize() const;
+    void setHttp2StreamReceiveWindowSize(int size);
+    int http2StreamReceiveWindowSize() const;
+
+    static void setNetworkThreadCount(int count);
+    static int networkThreadCount();
+
 Q_SIGNALS:
 #ifndef QT_NO_NETWORKPROXY
     void proxyAuthenticationRequired(const QNetworkProxy &proxy, QAuthenticator *authenticator);
@@ -61,6 +61,7 @@
 #include "QtNetwork/qnetworkproxy.h"
 #include "QtNetwork/qnetworksession.h"
 #include "qnetworkaccessauthenticationmanager_p.h"
+#include "private/http2protocol_p.h"
 #ifndef QT_NO_BEARERMANAGEMENT
 #include "QtNetwork/qnetworkconfigmanager.h"
 #endif
@@ -111,7 +112,7 @@ public:
     }
     ~QNetworkAccessManagerPrivate();
 
-    QThread * createThread();
+    QThread * createThread(const QUrl &url = QUrl());
     void destroyThread();
 
     void _q_replyFinished();
@@ -213,6 +214,19 @@ public:
     QHstsCache stsCache;
     bool stsEnabled = false;
 
+    // Connection pool and HTTP/2 policy for new connections:
+    int maxConnectionsPerHost = 6;
+    int connectionIdleTimeout = QNetworkAccessCache::DefaultExpiryTimeout;
+    int httpPipelineLength = 3;
+    int http2MaxConcurrentStreams = Http2::maxConcurrentStreams;
+    int http2SessionWindowSize = Http2::defaultSessionWindowSize * 10;
+    int http2StreamWindowSize = Http2::defaultSessionWindowSize;
+
+    // Distinguishes this manager's connections in the caches of the shared
+    // network threads
+    static QByteArray nextConnectionCacheScope();
+    QByteArray connectionCacheScope = nextConnectionCacheScope();
+
 #ifndef QT_NO_BEARERMANAGEMENT
     Q_AUTOTEST_EXPORT static const QWeakPointer<const QNetworkSession> getNetworkSession(const QNetworkAccessManager *manager);
 #endif
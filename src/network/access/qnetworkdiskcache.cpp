@@ -49,14 +49,27 @@
 #include <qdatastream.h>
 #include <qdatetime.h>
 #include <qdiriterator.h>
+#include <qmutex.h>
+#include <qrunnable.h>
+#include <qsavefile.h>
+#include <qset.h>
+#include <qthreadpool.h>
 #include <qurl.h>
 #include <qcryptographichash.h>
+#include <qwaitcondition.h>
 #include <qdebug.h>
 
+#include <algorithm>
+
 #define CACHE_POSTFIX QLatin1String(".d")
 #define PREPARED_SLASH QLatin1String("prepared/")
 #define CACHE_VERSION 8
 #define DATA_DIR QLatin1String("data")
+#define INDEX_FILE QLatin1String("index")
+#define NUM_SUBDIRECTORIES 256
+
+// Expiring more files than this hands them to a worker thread
+#define MAX_INLINE_REMOVALS 64
 
 #define MAX_COMPRESSION_SIZE (1024 * 1024 * 3)
 
@@ -74,6 +87,14 @@ QT_BEGIN_NAMESPACE
     are compressed using qCompress.  Data is written to disk only in insert()
     and updateMetaData().
 
+    The files are spread over 256 subdirectories. The size and last access
+    time of every file is kept in an index, which is saved in the cache
+    directory when the cache is destroyed and read back on a worker thread
+    when the cache directory is set. If the index is missing, for instance
+    after a crash, it is rebuilt by scanning the cache directory on that
+    thread. Expiring the cache therefore does not need to look at the files
+    on disk.
+
     Currently you cannot share the same cache files with more than
     one disk cache.
 
@@ -113,6 +134,7 @@ QNetworkDiskCache::~QNetworkDiskCache()
 {
     Q_D(QNetworkDiskCache);
     qDeleteAll(d->inserting);
+    d->saveIndex();
 }
 
 /*!
@@ -142,6 +164,11 @@ void QNetworkDiskCache::setCacheDirectory(const QString &cacheDir)
     Q_D(QNetworkDiskCache);
     if (cacheDir.isEmpty())
         return;
+    d->saveIndex();
+    d->index.clear();
+    d->indexSize = 0;
+    d->indexLoaded = false;
+    d->currentCacheSize = -1;
     d->cacheDirectory = cacheDir;
     QDir dir(d->cacheDirectory);
     d->cacheDirectory = dir.absolutePath();
@@ -150,6 +177,7 @@ void QNetworkDiskCache::setCacheDirectory(const QString &cacheDir)
 
     d->dataDirectory = d->cacheDirectory + DATA_DIR + QString::number(CACHE_VERSION) + QLatin1Char('/');
     d->prepareLayout();
+    d->startIndexLoad();
 }
 
 /*!
@@ -252,15 +280,296 @@ void QNetworkDiskCachePrivate::prepareLayout()
     QDir helper;
     helper.mkpath(cacheDirectory + PREPARED_SLASH);
 
-    //Create directory and subdirectories 0-F
+    // Remove temporary files left behind by interrupted insertions; they
+    // are not part of the index, so expire() won't find them.
+    const QStringList nameFilters(QLatin1Char('*') + CACHE_POSTFIX);
+    QDirIterator prepared(cacheDirectory + PREPARED_SLASH, nameFilters, QDir::Files);
+    while (prepared.hasNext()) {
+        const QString path = prepared.next();
+        bool inUse = false;
+        for (QCacheItem *item : qAsConst(inserting)) {
+            if (item && item->file && item->file->fileName() == path) {
+                inUse = true;
+                break;
+            }
+        }
+        if (!inUse)
+            QFile::remove(path);
+    }
+
+    //Create directory and subdirectories 00-FF
     helper.mkpath(dataDirectory);
-    for (uint i = 0; i < 16 ; i++) {
-        QString str = QString::number(i, 16);
+    for (uint i = 0; i < NUM_SUBDIRECTORIES; i++) {
+        QString str = QString::number(i, 16).rightJustified(2, QLatin1Char('0'));
         QString subdir = dataDirectory + str;
         helper.mkdir(subdir);
     }
 }
 
+struct QCacheIndexLoad
+{
+    QCacheIndexLoad() : done(false) {}
+
+    QMutex mutex;
+    QWaitCondition finished;
+    bool done;
+    QCacheIndex entries;
+};
+
+struct QCacheFileRemoval
+{
+    QCacheFileRemoval() : running(false) {}
+
+    QMutex mutex;
+    QWaitCondition currentRemoved;
+    QSet<QString> pending;
+    QString current; // being removed by the worker, without the mutex held
+    bool running;
+};
+
+enum
+{
+    IndexMagic = 0x51444349, // "QDCI"
+    IndexVersion = 1
+};
+
+static bool readIndex(const QString &fileName, QCacheIndex *entries)
+{
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_6);
+    quint32 magic;
+    qint32 version;
+    quint32 count;
+    in >> magic >> version >> count;
+    if (in.status() != QDataStream::Ok || magic != IndexMagic || version != IndexVersion)
+        return false;
+
+    entries->reserve(count);
+    for (quint32 i = 0; i < count; ++i) {
+        QString key;
+        QCacheIndexEntry entry;
+        in >> key >> entry.size >> entry.lastAccess;
+        if (in.status() != QDataStream::Ok) {
+            entries->clear();
+            return false;
+        }
+        entries->insert(key, entry);
+    }
+    // The index describes the directory only until the cache changes it.
+    // Remove it now, so that a new one is built if we don't get to save it.
+    file.remove();
+    return true;
+}
+
+static void scanDirectory(const QString &dataDirectory, QCacheIndex *entries)
+{
+    QDir::Filters filters = QDir::AllDirs | QDir:: Files | QDir::NoDotAndDotDot;
+    QDirIterator it(dataDirectory, filters, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QString path = it.next();
+        QFileInfo info = it.fileInfo();
+        if (info.isFile() && info.fileName().endsWith(CACHE_POSTFIX)) {
+            QCacheIndexEntry entry;
+            entry.size = info.size();
+            entry.lastAccess = info.lastModified().toMSecsSinceEpoch();
+            entries->insert(path.mid(dataDirectory.size()), entry);
+        }
+    }
+}
+
+class QCacheIndexLoadTask : public QRunnable
+{
+public:
+    QCacheIndexLoadTask(const QSharedPointer<QCacheIndexLoad> &load, const QString &dataDirectory)
+        : load(load), dataDirectory(dataDirectory)
+    {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        QCacheIndex entries;
+        if (!readIndex(dataDirectory + INDEX_FILE, &entries))
+            scanDirectory(dataDirectory, &entries);
+
+        QMutexLocker locker(&load->mutex);
+        load->entries.swap(entries);
+        load->done = true;
+        load->finished.wakeAll();
+    }
+
+private:
+    QSharedPointer<QCacheIndexLoad> load;
+    QString dataDirectory;
+};
+
+class QCacheFileRemovalTask : public QRunnable
+{
+public:
+    explicit QCacheFileRemovalTask(const QSharedPointer<QCacheFileRemoval> &removal)
+        : removal(removal)
+    {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        QMutexLocker locker(&removal->mutex);
+        while (!removal->pending.isEmpty()) {
+            QSet<QString>::iterator it = removal->pending.begin();
+            const QString fileName = *it;
+            removal->pending.erase(it);
+            // Don't block the cache while the file system works; it treats
+            // the current file as still being removed until we are done.
+            removal->current = fileName;
+            locker.unlock();
+            QFile::remove(fileName);
+            locker.relock();
+            removal->current.clear();
+            removal->currentRemoved.wakeAll();
+        }
+        removal->running = false;
+    }
+
+private:
+    QSharedPointer<QCacheFileRemoval> removal;
+};
+
+/*!
+    Returns the key of \a fileName in the index, or an empty string if the
+    file is not part of the data directory.
+ */
+QString QNetworkDiskCachePrivate::indexKey(const QString &fileName) const
+{
+    if (dataDirectory.isEmpty() || !fileName.startsWith(dataDirectory))
+        return QString();
+    return fileName.mid(dataDirectory.size());
+}
+
+/*!
+    Starts reading the index of the data directory on a worker thread.
+ */
+void QNetworkDiskCachePrivate::startIndexLoad()
+{
+    indexLoad = QSharedPointer<QCacheIndexLoad>::create();
+    QThreadPool::globalInstance()->start(new QCacheIndexLoadTask(indexLoad, dataDirectory));
+}
+
+/*!
+    Waits for the index to be loaded, if it isn't already.
+ */
+void QNetworkDiskCachePrivate::ensureIndex()
+{
+    if (indexLoaded || dataDirectory.isEmpty())
+        return;
+    if (!indexLoad)
+        startIndexLoad();
+
+    {
+        QMutexLocker locker(&indexLoad->mutex);
+        while (!indexLoad->done)
+            indexLoad->finished.wait(&indexLoad->mutex);
+        index.swap(indexLoad->entries);
+    }
+    indexLoad.clear();
+    indexLoaded = true;
+
+    indexSize = 0;
+    for (QCacheIndex::const_iterator it = index.cbegin(), end = index.cend(); it != end; ++it) {
+        indexSize += it->size;
+        lastAccessStamp = qMax(lastAccessStamp, it->lastAccess);
+    }
+    currentCacheSize = indexSize;
+}
+
+/*!
+    Writes the index to the data directory.
+ */
+void QNetworkDiskCachePrivate::saveIndex()
+{
+    if (dataDirectory.isEmpty())
+        return;
+    // A load still in progress has already removed the file.
+    if (indexLoad)
+        ensureIndex();
+    // Without entries, scanning the directory next time is just as fast
+    if (!indexLoaded || index.isEmpty())
+        return;
+
+    QSaveFile file(dataDirectory + INDEX_FILE);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "QNetworkDiskCache: couldn't write the cache index" << file.fileName();
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_6);
+    out << quint32(IndexMagic) << qint32(IndexVersion) << quint32(index.size());
+    for (QCacheIndex::const_iterator it = index.cbegin(), end = index.cend(); it != end; ++it)
+        out << it.key() << it->size << it->lastAccess;
+    file.commit();
+}
+
+/*!
+    Returns a timestamp for an access to a cache file. Timestamps are
+    strictly increasing, so files used within the same millisecond still
+    expire in the order they were used.
+ */
+qint64 QNetworkDiskCachePrivate::nextAccessStamp()
+{
+    lastAccessStamp = qMax(QDateTime::currentMSecsSinceEpoch(), lastAccessStamp + 1);
+    return lastAccessStamp;
+}
+
+/*!
+    Records that \a fileName was used. Accesses made while the index is
+    still being loaded are not recorded.
+ */
+void QNetworkDiskCachePrivate::touch(const QString &fileName)
+{
+    if (!indexLoaded)
+        return;
+    QCacheIndex::iterator it = index.find(indexKey(fileName));
+    if (it != index.end())
+        it->lastAccess = nextAccessStamp();
+}
+
+/*!
+    Removes \a files from the disk. Small batches are removed right away,
+    larger ones are handed to a worker thread so that expiring a big cache
+    doesn't block the caller.
+ */
+void QNetworkDiskCachePrivate::removeFiles(const QStringList &files)
+{
+    if (files.size() <= MAX_INLINE_REMOVALS) {
+        for (const QString &file : files)
+            QFile::remove(file);
+        return;
+    }
+
+    if (!removal)
+        removal = QSharedPointer<QCacheFileRemoval>::create();
+    QMutexLocker locker(&removal->mutex);
+    for (const QString &file : files)
+        removal->pending.insert(file);
+    if (!removal->running) {
+        removal->running = true;
+        QThreadPool::globalInstance()->start(new QCacheFileRemovalTask(removal));
+    }
+}
+
+/*!
+    Returns \c true if \a fileName was expired but the worker thread has not
+    removed it yet.
+ */
+bool QNetworkDiskCachePrivate::isBeingRemoved(const QString &fileName) const
+{
+    if (!removal)
+        return false;
+    QMutexLocker locker(&removal->mutex);
+    return removal->pending.contains(fileName) || removal->current == fileName;
+}
+
 
 void QNetworkDiskCachePrivate::storeItem(QCacheItem *cacheItem)
 {
@@ -270,8 +579,9 @@ void QNetworkDiskCachePrivate::storeItem(QCacheItem *cacheItem)
     QString fileName = cacheFileName(cacheItem->metaData.url());
     Q_ASSERT(!fileName.isEmpty());
 
+    ensureIndex();
     if (QFile::exists(fileName)) {
-        if (!QFile::remove(fileName)) {
+        if (!removeFile(fileName)) {
             qWarning() << "QNetworkDiskCache: couldn't remove the cache file " << fileName;
             return;
         }
@@ -294,10 +604,16 @@ void QNetworkDiskCachePrivate::storeItem(QCacheItem *cacheItem)
         && cacheItem->file->error() == QFile::NoError) {
         cacheItem->file->setAutoRemove(false);
         // ### use atomic rename rather then remove & rename
-        if (cacheItem->file->rename(fileName))
-            currentCacheSize += cacheItem->file->size();
-        else
+        if (cacheItem->file->rename(fileName)) {
+            QCacheIndexEntry entry;
+            entry.size = cacheItem->file->size();
+            entry.lastAccess = nextAccessStamp();
+            index.insert(indexKey(fileName), entry);
+            indexSize += entry.size;
+            currentCacheSize += entry.size;
+        } else {
             cacheItem->file->setAutoRemove(true);
+        }
     }
     if (cacheItem->metaData.url() == lastItem.metaData.url())
         lastItem.reset();
@@ -338,16 +654,29 @@ bool QNetworkDiskCachePrivate::removeFile(const QString &file)
 #endif
     if (file.isEmpty())
         return false;
-    QFileInfo info(file);
-    QString fileName = info.fileName();
-    if (!fileName.endsWith(CACHE_POSTFIX))
+    if (!file.endsWith(CACHE_POSTFIX))
         return false;
-    qint64 size = info.size();
-    if (QFile::remove(file)) {
-        currentCacheSize -= size;
-        return true;
+
+    const QString key = indexKey(file);
+    if (!key.isEmpty()) {
+        ensureIndex();
+        QCacheIndex::iterator it = index.find(key);
+        if (it != index.end()) {
+            indexSize -= it->size;
+            currentCacheSize -= it->size;
+            index.erase(it);
+        }
     }
-    return false;
+    if (removal) {
+        // don't let the worker thread remove it again later, and wait if
+        // it is removing it right now, so that it can't remove a file that
+        // is stored under the same name afterwards
+        QMutexLocker locker(&removal->mutex);
+        removal->pending.remove(file);
+        while (removal->current == file)
+            removal->currentRemoved.wait(&removal->mutex);
+    }
+    return QFile::remove(file);
 }
 
 /*!
@@ -361,7 +690,10 @@ QNetworkCacheMetaData QNetworkDiskCache::metaData(const QUrl &url)
     Q_D(QNetworkDiskCache);
     if (d->lastItem.metaData.url() == url)
         return d->lastItem.metaData;
-    return fileMetaData(d->cacheFileName(url));
+    const QString fileName = d->cacheFileName(url);
+    if (d->isBeingRemoved(fileName))
+        return QNetworkCacheMetaData();
+    return fileMetaData(fileName);
 }
 
 /*!
@@ -402,9 +734,13 @@ QIODevice *QNetworkDiskCache::data(const QUrl &url)
         buffer.reset(new QBuffer);
         buffer->setData(d->lastItem.data.data());
     } else {
-        QScopedPointer<QFile> file(new QFile(d->cacheFileName(url)));
+        const QString fileName = d->cacheFileName(url);
+        if (d->isBeingRemoved(fileName))
+            return 0;
+        QScopedPointer<QFile> file(new QFile(fileName));
         if (!file->open(QFile::ReadOnly | QIODevice::Unbuffered))
             return 0;
+        d->touch(fileName);
 
         if (!d->lastItem.read(file.data(), true)) {
             file->close();
@@ -501,8 +837,11 @@ void QNetworkDiskCache::setMaximumCacheSize(qint64 size)
 
     When the current size of the cache is greater than the maximumCacheSize()
     older cache files are removed until the total size is less then 90% of
-    maximumCacheSize() starting with the oldest ones first using the file
-    creation date to determine how old a cache file is.
+    maximumCacheSize() starting with the least recently used ones first.
+    The sizes and access times are taken from the cache's index rather than
+    from the files themselves, so only the removed files are touched on disk.
+    When many files have to go, they are removed on a worker thread after
+    this function has returned.
 
     Subclasses can reimplement this function to change the order that cache
     files are removed taking into account information in the application
@@ -527,51 +866,38 @@ qint64 QNetworkDiskCache::expire()
     // close file handle to prevent "in use" error when QFile::remove() is called
     d->lastItem.reset();
 
-    QDir::Filters filters = QDir::AllDirs | QDir:: Files | QDir::NoDotAndDotDot;
-    QDirIterator it(cacheDirectory(), filters, QDirIterator::Subdirectories);
-
-    QMultiMap<QDateTime, QString> cacheItems;
-    qint64 totalSize = 0;
-    while (it.hasNext()) {
-        QString path = it.next();
-        QFileInfo info = it.fileInfo();
-        QString fileName = info.fileName();
-        if (fileName.endsWith(CACHE_POSTFIX)) {
-            cacheItems.insert(info.created(), path);
-            totalSize += info.size();
-        }
+    d->ensureIndex();
+    qint64 totalSize = d->indexSize;
+    const qint64 goal = (maximumCacheSize() * 9) / 10;
+    if (totalSize < goal) {
+        d->currentCacheSize = totalSize;
+        return totalSize;
     }
 
-    int removedFiles = 0;
-    qint64 goal = (maximumCacheSize() * 9) / 10;
-    QMultiMap<QDateTime, QString>::const_iterator i = cacheItems.constBegin();
-    while (i != cacheItems.constEnd()) {
+    typedef QPair<qint64, QString> AccessEntry;
+    QVector<AccessEntry> cacheItems;
+    cacheItems.reserve(d->index.size());
+    for (QCacheIndex::const_iterator it = d->index.cbegin(), end = d->index.cend(); it != end; ++it)
+        cacheItems.append(qMakePair(it->lastAccess, it.key()));
+    std::sort(cacheItems.begin(), cacheItems.end());
+
+    QStringList removedFiles;
+    for (const AccessEntry &item : qAsConst(cacheItems)) {
         if (totalSize < goal)
             break;
-        QString name = i.value();
-        QFile file(name);
-
-        if (name.contains(PREPARED_SLASH)) {
-            for (QCacheItem *item : qAsConst(d->inserting)) {
-                if (item && item->file && item->file->fileName() == name) {
-                    delete item->file;
-                    item->file = 0;
-                    break;
-                }
-            }
-        }
-
-        qint64 size = file.size();
-        file.remove();
-        totalSize -= size;
-        ++removedFiles;
-        ++i;
+        QCacheIndex::iterator it = d->index.find(item.second);
+        totalSize -= it->size;
+        d->index.erase(it);
+        removedFiles.append(d->dataDirectory + item.second);
     }
+    d->indexSize = totalSize;
+    d->removeFiles(removedFiles);
+
 #if defined(QNETWORKDISKCACHE_DEBUG)
-    if (removedFiles > 0) {
+    if (!removedFiles.isEmpty()) {
         qDebug() << "QNetworkDiskCache::expire()"
-                << "Removed:" << removedFiles
-                << "Kept:" << cacheItems.count() - removedFiles;
+                << "Removed:" << removedFiles.count()
+                << "Kept:" << d->index.count();
     }
 #endif
     return totalSize;
@@ -603,12 +929,14 @@ QString QNetworkDiskCachePrivate::uniqueFileName(const QUrl &url)
 
     QCryptographicHash hash(QCryptographicHash::Sha1);
     hash.addData(cleanUrl.toEncoded());
+    const QByteArray digest = hash.result();
     // convert sha1 to base36 form and return first 8 bytes for use as string
-    const QByteArray id = QByteArray::number(*(qlonglong*)hash.result().constData(), 36).left(8);
-    // generates <one-char subdir>/<8-char filname.d>
-    uint code = (uint)id.at(id.length()-1) % 16;
-    QString pathFragment = QString::number(code, 16) + QLatin1Char('/')
-                             + QLatin1String(id) + CACHE_POSTFIX;
+    const QByteArray id = QByteArray::number(*(qlonglong*)digest.constData(), 36).left(8);
+    // generates <two-char subdir>/<8-char filname.d>, the subdirectory
+    // taken from a part of the hash the name does not depend on
+    uint code = uchar(digest.at(digest.size() - 1)) % NUM_SUBDIRECTORIES;
+    QString pathFragment = QString::number(code, 16).rightJustified(2, QLatin1Char('0'))
+                             + QLatin1Char('/') + QLatin1String(id) + CACHE_POSTFIX;
 
     return pathFragment;
 }
@@ -56,6 +56,7 @@
 
 #include <qbuffer.h>
 #include <qhash.h>
+#include <qsharedpointer.h>
 #include <qtemporaryfile.h>
 
 QT_REQUIRE_CONFIG(networkdiskcache);
@@ -94,6 +95,18 @@ public:
     bool canCompress() const;
 };
 
+struct QCacheIndexEntry
+{
+    qint64 size;
+    qint64 lastAccess; // msecs since epoch
+};
+Q_DECLARE_TYPEINFO(QCacheIndexEntry, Q_PRIMITIVE_TYPE);
+
+typedef QHash<QString, QCacheIndexEntry> QCacheIndex;
+
+struct QCacheIndexLoad;
+struct QCacheFileRemoval;
+
 class QNetworkDiskCachePrivate : public QAbstractNetworkCachePrivate
 {
 public:
@@ -101,6 +114,9 @@ public:
         : QAbstractNetworkCachePrivate()
         , maximumCacheSize(1024 * 1024 * 50)
         , currentCacheSize(-1)
+        , indexSize(0)
+        , lastAccessStamp(0)
+        , indexLoaded(false)
         {}
 
     static QString uniqueFileName(const QUrl &url);
@@ -111,12 +127,31 @@ public:
     void prepareLayout();
     static quint32 crc32(const char *data, uint len);
 
+    QString indexKey(const QString &fileName) const;
+    void startIndexLoad();
+    void ensureIndex();
+    void saveIndex();
+    void touch(const QString &fileName);
+    qint64 nextAccessStamp();
+    void removeFiles(const QStringList &files);
+    bool isBeingRemoved(const QString &fileName) const;
+
     mutable QCacheItem lastItem;
     QString cacheDirectory;
     QString dataDirectory;
     qint64 maximumCacheSize;
     qint64 currentCacheSize;
 
+    // Size and last access of every file in dataDirectory, so that expiring
+    // does not have to stat the whole cache. It is read from the index file
+    // (or rebuilt by scanning the directory) on a worker thread.
+    QCacheIndex index;
+    qint64 indexSize;
+    qint64 lastAccessStamp;
+    bool indexLoaded;
+    QSharedPointer<QCacheIndexLoad> indexLoad;
+    QSharedPointer<QCacheFileRemoval> removal;
+
     QHash<QIODevice*, QCacheItem*> inserting;
     Q_DECLARE_PUBLIC(QNetworkDiskCache)
 };
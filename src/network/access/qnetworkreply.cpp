@@ -685,6 +685,24 @@ QVariant QNetworkReply::attribute(QNetworkRequest::Attribute code) const
     return d_func()->attributes.value(code);
 }
 
+/*!
+    \since 5.10
+
+    Returns the timings and byte counts of the transfer that produced
+    this reply. The statistics become available just before finished()
+    is emitted; until then, and for protocols that do not collect them,
+    an invalid QNetworkTransferStatistics object is returned.
+
+    If the request was redirected, the statistics describe the last
+    request in the redirect chain.
+
+    \sa QNetworkTransferStatistics::isValid()
+*/
+QNetworkTransferStatistics QNetworkReply::transferStatistics() const
+{
+    return d_func()->transferStatistics;
+}
+
 #ifndef QT_NO_SSL
 /*!
     Returns the SSL configuration and state associated with this
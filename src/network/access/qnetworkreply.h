@@ -47,6 +47,7 @@
 
 #include <QtNetwork/QNetworkRequest>
 #include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkTransferStatistics>
 
 QT_BEGIN_NAMESPACE
 
@@ -143,6 +144,8 @@ public:
     // attributes
     QVariant attribute(QNetworkRequest::Attribute code) const;
 
+    QNetworkTransferStatistics transferStatistics() const;
+
 #ifndef QT_NO_SSL
     QSslConfiguration sslConfiguration() const;
     void setSslConfiguration(const QSslConfiguration &configuration);
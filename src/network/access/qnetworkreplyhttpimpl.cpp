@@ -52,6 +52,7 @@
 #include "QtCore/qelapsedtimer.h"
 #include "QtNetwork/qsslconfiguration.h"
 #include "qhttpthreaddelegate_p.h"
+#include "qnetworktransferstatistics_p.h"
 #include "qhsts_p.h"
 #include "qthread.h"
 #include "QtCore/qcoreapplication.h"
@@ -624,9 +625,9 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
         QObject::connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
         thread->start();
     } else {
-        // We use the manager-global thread.
-        // At some point we could switch to having multiple threads if it makes sense.
-        thread = managerPrivate->createThread();
+        // We use the manager-global thread, or one of the shared network
+        // threads if QNetworkAccessManager::setNetworkThreadCount() was used.
+        thread = managerPrivate->createThread(newHttpRequest.url());
     }
 
     QUrl url = newHttpRequest.url();
@@ -807,6 +808,16 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
     // from HTTP thread to user thread in some cases.
     delegate->authenticationManager = managerPrivate->authenticationManager;
 
+    delegate->maxConnectionsPerHost = quint16(managerPrivate->maxConnectionsPerHost);
+    delegate->connectionIdleTimeout = managerPrivate->connectionIdleTimeout;
+    delegate->http2MaxConcurrentStreams = quint32(managerPrivate->http2MaxConcurrentStreams);
+    delegate->http2SessionWindowSize = managerPrivate->http2SessionWindowSize;
+    delegate->http2StreamWindowSize = managerPrivate->http2StreamWindowSize;
+    delegate->pipelineLength = managerPrivate->httpPipelineLength;
+    delegate->connectionCacheScope = managerPrivate->connectionCacheScope;
+    delegate->requestStartTime = QNetworkTransferStatisticsPrivate::now();
+    delegate->requestStartMSecsSinceEpoch = QDateTime::currentMSecsSinceEpoch();
+
     if (!synchronous) {
         // Tell our zerocopy policy to the delegate
         QVariant downloadBufferMaximumSizeAttribute = newHttpRequest.attribute(QNetworkRequest::MaximumDownloadBufferSizeAttribute);
@@ -819,6 +830,13 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
             delegate->downloadBufferMaximumSize = 128*1024;
         }
 
+        // The data goes straight to the sink instead of through us
+        QIODevice *downloadSink = qobject_cast<QIODevice *>(
+                    newHttpRequest.attribute(QNetworkRequest::DownloadSinkAttribute).value<QObject *>());
+        if (downloadSink) {
+            delegate->downloadSink = downloadSink;
+            delegate->downloadBufferMaximumSize = 0;
+        }
 
         // These atomic integers are used for signal compression
         delegate->pendingDownloadData = pendingDownloadDataEmissions;
@@ -839,15 +857,24 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
                                               int, QString, bool,
                                               QSharedPointer<char>, qint64, qint64, bool)),
                 Qt::QueuedConnection);
-        QObject::connect(delegate, SIGNAL(downloadProgress(qint64,qint64)),
-                q, SLOT(replyDownloadProgressSlot(qint64,qint64)),
-                Qt::QueuedConnection);
+        if (downloadSink) {
+            QObject::connect(delegate, SIGNAL(downloadProgress(qint64,qint64)),
+                    q, SLOT(replyDownloadSinkProgress(qint64,qint64)),
+                    Qt::QueuedConnection);
+        } else {
+            QObject::connect(delegate, SIGNAL(downloadProgress(qint64,qint64)),
+                    q, SLOT(replyDownloadProgressSlot(qint64,qint64)),
+                    Qt::QueuedConnection);
+        }
         QObject::connect(delegate, SIGNAL(error(QNetworkReply::NetworkError,QString)),
                 q, SLOT(httpError(QNetworkReply::NetworkError,QString)),
                 Qt::QueuedConnection);
         QObject::connect(delegate, SIGNAL(redirected(QUrl,int,int)),
                 q, SLOT(onRedirected(QUrl,int,int)),
                 Qt::QueuedConnection);
+        QObject::connect(delegate, SIGNAL(transferStatistics(QNetworkTransferStatistics)),
+                q, SLOT(replyTransferStatistics(QNetworkTransferStatistics)),
+                Qt::QueuedConnection);
 
         QObject::connect(q, SIGNAL(redirectAllowed()), q, SLOT(followRedirect()),
                          Qt::QueuedConnection);
@@ -937,6 +964,7 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
     // Send an signal to the delegate so it starts working in the other thread
     if (synchronous) {
         emit q->startHttpRequestSynchronously(); // This one is BlockingQueuedConnection, so it will return when all work is done
+        transferStatistics = delegate->incomingTransferStatistics;
 
         if (delegate->incomingErrorCode != QNetworkReply::NoError) {
             replyDownloadMetaData
@@ -1365,6 +1393,38 @@ void QNetworkReplyHttpImplPrivate::replyDownloadMetaData(const QList<QPair<QByte
     _q_metaDataChanged();
 }
 
+void QNetworkReplyHttpImplPrivate::replyTransferStatistics(const QNetworkTransferStatistics &statistics)
+{
+    transferStatistics = statistics;
+}
+
+// Used instead of replyDownloadData() when the data is written to a
+// QNetworkRequest::DownloadSinkAttribute device in the HTTP thread
+void QNetworkReplyHttpImplPrivate::replyDownloadSinkProgress(qint64 bytesReceived, qint64 bytesTotal)
+{
+    Q_Q(QNetworkReplyHttpImpl);
+    Q_UNUSED(bytesTotal);
+
+    if (!q->isOpen())
+        return;
+
+    int pendingSignals = (int)pendingDownloadProgressEmissions->fetchAndAddAcquire(-1) - 1;
+    if (pendingSignals > 0)
+        return;
+
+    if (isHttpRedirectResponse())
+        return;
+
+    bytesDownloaded = bytesReceived;
+
+    QVariant totalSize = cookedHeaders.value(QNetworkRequest::ContentLengthHeader);
+    if (downloadProgressSignalChoke.elapsed() >= progressSignalInterval) {
+        downloadProgressSignalChoke.restart();
+        emit q->downloadProgress(bytesDownloaded,
+                                 totalSize.isNull() ? Q_INT64_C(-1) : totalSize.toLongLong());
+    }
+}
+
 void QNetworkReplyHttpImplPrivate::replyDownloadProgressSlot(qint64 bytesReceived,  qint64 bytesTotal)
 {
     Q_Q(QNetworkReplyHttpImpl);
@@ -116,6 +116,8 @@ public:
                                                         int, QString, bool, QSharedPointer<char>,
                                                         qint64, qint64, bool))
     Q_PRIVATE_SLOT(d_func(), void replyDownloadProgressSlot(qint64,qint64))
+    Q_PRIVATE_SLOT(d_func(), void replyDownloadSinkProgress(qint64,qint64))
+    Q_PRIVATE_SLOT(d_func(), void replyTransferStatistics(QNetworkTransferStatistics))
     Q_PRIVATE_SLOT(d_func(), void httpAuthenticationRequired(const QHttpNetworkRequest &, QAuthenticator *))
     Q_PRIVATE_SLOT(d_func(), void httpError(QNetworkReply::NetworkError, const QString &))
 #ifndef QT_NO_SSL
@@ -289,6 +291,8 @@ public:
     void replyDownloadMetaData(const QList<QPair<QByteArray,QByteArray> > &, int, const QString &,
                                bool, QSharedPointer<char>, qint64, qint64, bool);
     void replyDownloadProgressSlot(qint64,qint64);
+    void replyDownloadSinkProgress(qint64,qint64);
+    void replyTransferStatistics(const QNetworkTransferStatistics &statistics);
     void httpAuthenticationRequired(const QHttpNetworkRequest &request, QAuthenticator *auth);
     void httpError(QNetworkReply::NetworkError error, const QString &errorString);
 #ifndef QT_NO_SSL
@@ -298,6 +298,21 @@ QT_BEGIN_NAMESPACE
         This attribute obsoletes FollowRedirectsAttribute.
         (This value was introduced in 5.9.)
 
+    \value DownloadSinkAttribute
+        Requests only, type: QMetaType::QObjectStar (default: null)
+        If set to a QIODevice, the body of an asynchronous HTTP reply is
+        written to that device directly in the network thread, without
+        passing through the event loop of the thread the reply lives in.
+        The reply itself then has no data to read; it only emits
+        downloadProgress() and finished(). The device must be open for
+        writing, must stay valid until the reply has finished, and must not
+        be used by any other thread in the meantime. If writing fails, the
+        request is aborted with QNetworkReply::UnknownContentError.
+        Such replies are not stored in the network cache, and a reply that
+        is served from the cache delivers its data through the reply as
+        usual.
+        (This value was introduced in 5.10.)
+
     \value User
         Special type. Additional information can be passed in
         QVariants with types ranging from User to UserMax. The default
@@ -0,0 +1,360 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qnetworktransferstatistics.h"
+#include "qnetworktransferstatistics_p.h"
+
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qdeadlinetimer.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qurl.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_LOGGING_CATEGORY(lcNetworkTrace, "qt.network.trace", QtWarningMsg)
+
+/*!
+    \class QNetworkTransferStatistics
+    \brief The QNetworkTransferStatistics class holds the timings and byte
+    counts of a network request.
+    \since 5.10
+
+    \reentrant
+    \ingroup network
+    \inmodule QtNetwork
+
+    QNetworkReply::transferStatistics() returns an object of this class once
+    an HTTP or HTTPS reply has finished. The timings are taken inside the
+    network stack, in the thread that does the network I/O, so they include
+    the time that a request spends waiting for a free connection and for
+    the network thread, which cannot be observed from the reply's signals.
+
+    Each Event is recorded the first time it happens. elapsed() returns the
+    time from RequestStarted to an event, and duration() the time between
+    two events. Both return nanoseconds, or -1 if one of the events did not
+    happen.
+
+    The connection events (ConnectionStarted, HostFound, Connected and
+    Encrypted) are only recorded for requests that had to wait for a new
+    connection to be established. If the request was sent over a connection
+    that was already open, isConnectionReused() returns \c true instead.
+
+    When the reply followed redirects, the statistics describe the last
+    request.
+
+    \section1 Tracing
+
+    If the \c{qt.network.trace} logging category is enabled for debug
+    messages, the statistics of every finished HTTP request are exported.
+    By default they are logged as text. If the \c QT_NETWORK_TRACE_FILE
+    environment variable names a file, compact binary records are appended
+    to that file instead, for analysis by other tools. The file starts with
+    the 4 bytes \c{QNTR}, a one byte format version (currently 1), the
+    number of events per record as one byte, and two reserved bytes. It is
+    followed by one record per request. All numbers are little-endian:
+
+    \table
+    \header \li Type \li Content
+    \row \li quint32 \li Size of the remainder of the record in bytes
+    \row \li qint64 \li Start of the request, in milliseconds since the epoch (UTC)
+    \row \li qint32 \li For each Event, in enum order: elapsed() in microseconds, or -1
+    \row \li qint64 \li bytesSent()
+    \row \li qint64 \li bytesReceived()
+    \row \li qint32 \li http2StreamId()
+    \row \li quint16 \li The HTTP status code, or 0
+    \row \li quint8 \li Flags: bit 0 is set if isConnectionReused()
+    \row \li quint16 \li Length of the URL that follows
+    \row \li char[] \li The URL, encoded, without user info, query and fragment
+    \endtable
+
+    \sa QNetworkReply::transferStatistics()
+*/
+
+/*!
+    \enum QNetworkTransferStatistics::Event
+
+    \value RequestStarted       QNetworkAccessManager started processing the
+                                request. The other events are measured from
+                                this point.
+    \value RequestQueued        The request was queued for a connection to the
+                                server, in the network thread.
+    \value ConnectionStarted    Establishing a new connection started.
+    \value HostFound            The host name lookup for the new connection
+                                finished.
+    \value Connected            The TCP connection was established.
+    \value Encrypted            The TLS handshake finished. Only recorded for
+                                encrypted connections.
+    \value RequestSent          The request, including any upload data, was
+                                written to the connection.
+    \value ResponseStarted      The first byte of the response arrived.
+    \value ResponseFinished     The response was completely received, or the
+                                request failed.
+*/
+
+qint64 QNetworkTransferStatisticsPrivate::now()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+void QNetworkTransferStatisticsPrivate::setConnectionTimings(const QNetworkConnectionTimings &timings,
+                                                             qint64 lookupStarted,
+                                                             qint64 lookupFinished)
+{
+    // Already done for an earlier attempt of the same request
+    if (connectionReused || hasRecorded(QNetworkTransferStatistics::Connected))
+        return;
+
+    const qint64 queued = timestamps[QNetworkTransferStatistics::RequestQueued];
+    if (timings.establishedAt() < queued) {
+        connectionReused = true;
+        return;
+    }
+
+    // The connection looks the host name up before its first channel
+    // connects; that lookup belongs to the requests that waited for it.
+    if (lookupStarted && lookupStarted >= queued) {
+        record(QNetworkTransferStatistics::ConnectionStarted, lookupStarted);
+        record(QNetworkTransferStatistics::HostFound, lookupFinished);
+    } else {
+        record(QNetworkTransferStatistics::ConnectionStarted, timings.started);
+        record(QNetworkTransferStatistics::HostFound, timings.hostFound);
+    }
+    record(QNetworkTransferStatistics::Connected, timings.connected);
+    record(QNetworkTransferStatistics::Encrypted, timings.encrypted);
+}
+
+/*!
+    Constructs an invalid QNetworkTransferStatistics object.
+*/
+QNetworkTransferStatistics::QNetworkTransferStatistics()
+    : d(new QNetworkTransferStatisticsPrivate)
+{
+}
+
+/*!
+    \internal
+*/
+QNetworkTransferStatistics::QNetworkTransferStatistics(QNetworkTransferStatisticsPrivate *dd)
+    : d(dd)
+{
+}
+
+/*!
+    Constructs a copy of \a other.
+*/
+QNetworkTransferStatistics::QNetworkTransferStatistics(const QNetworkTransferStatistics &other)
+    : d(other.d)
+{
+}
+
+/*!
+    Copies \a other into this object.
+*/
+QNetworkTransferStatistics &QNetworkTransferStatistics::operator=(const QNetworkTransferStatistics &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+    \fn QNetworkTransferStatistics &QNetworkTransferStatistics::operator=(QNetworkTransferStatistics &&other)
+
+    Move-assigns \a other to this object.
+*/
+
+/*!
+    \fn void QNetworkTransferStatistics::swap(QNetworkTransferStatistics &other)
+
+    Swaps this object with \a other. This operation is very fast and never
+    fails.
+*/
+
+/*!
+    Destroys the object.
+*/
+QNetworkTransferStatistics::~QNetworkTransferStatistics()
+{
+}
+
+/*!
+    Returns \c true if the object holds the statistics of a request.
+*/
+bool QNetworkTransferStatistics::isValid() const
+{
+    return d->valid;
+}
+
+/*!
+    Returns the time in nanoseconds from RequestStarted until \a event, or
+    -1 if the event was not recorded.
+
+    \sa duration()
+*/
+qint64 QNetworkTransferStatistics::elapsed(Event event) const
+{
+    return duration(RequestStarted, event);
+}
+
+/*!
+    Returns the time in nanoseconds from event \a from until event \a to, or
+    -1 if either event was not recorded.
+
+    For example, \c{duration(ConnectionStarted, HostFound)} is the time that
+    the host name lookup took, and \c{duration(RequestSent, ResponseStarted)}
+    the time the server needed to start its response.
+*/
+qint64 QNetworkTransferStatistics::duration(Event from, Event to) const
+{
+    if (!d->timestamps[from] || !d->timestamps[to])
+        return -1;
+    return d->timestamps[to] - d->timestamps[from];
+}
+
+/*!
+    Returns the number of bytes written to the connection for this request,
+    including the request headers. For HTTP/2 this includes the frame
+    headers of the request's stream, but not data shared by all streams of
+    the connection.
+*/
+qint64 QNetworkTransferStatistics::bytesSent() const
+{
+    return d->bytesSent;
+}
+
+/*!
+    Returns the number of bytes of the response that were read from the
+    connection, including the headers and before the body is decompressed.
+    For HTTP/2 this includes the frame headers of the request's stream.
+*/
+qint64 QNetworkTransferStatistics::bytesReceived() const
+{
+    return d->bytesReceived;
+}
+
+/*!
+    Returns \c true if the request was sent over a connection that was open
+    already, in which case no connection events were recorded.
+*/
+bool QNetworkTransferStatistics::isConnectionReused() const
+{
+    return d->connectionReused;
+}
+
+/*!
+    Returns the HTTP/2 stream identifier used for the request, or -1 if the
+    request did not use HTTP/2.
+*/
+int QNetworkTransferStatistics::http2StreamId() const
+{
+    return d->http2StreamId;
+}
+
+namespace {
+class QNetworkTraceFile
+{
+public:
+    QNetworkTraceFile()
+        : file(QFile::decodeName(qgetenv("QT_NETWORK_TRACE_FILE")))
+    {
+        if (file.fileName().isEmpty())
+            return;
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            qCWarning(lcNetworkTrace, "Cannot open trace file %s: %s",
+                      qPrintable(file.fileName()), qPrintable(file.errorString()));
+            return;
+        }
+        if (file.size() == 0) {
+            const char header[8] = { 'Q', 'N', 'T', 'R', 1,
+                                     QNetworkTransferStatisticsPrivate::EventCount, 0, 0 };
+            file.write(header, sizeof header);
+        }
+    }
+
+    QMutex mutex;
+    QFile file;
+};
+}
+
+Q_GLOBAL_STATIC(QNetworkTraceFile, traceFile)
+
+void QNetworkTrace::write(const QUrl &url, int statusCode, const QNetworkTransferStatisticsPrivate &d)
+{
+    const QByteArray encodedUrl = url.toEncoded(QUrl::RemoveUserInfo | QUrl::RemoveQuery
+                                                | QUrl::RemoveFragment).left(0xffff);
+    qint32 elapsed[QNetworkTransferStatisticsPrivate::EventCount];
+    const qint64 start = d.timestamps[QNetworkTransferStatistics::RequestStarted];
+    for (int i = 0; i < QNetworkTransferStatisticsPrivate::EventCount; ++i) {
+        elapsed[i] = !start || !d.timestamps[i]
+                ? -1 : qint32(qMin<qint64>((d.timestamps[i] - start) / 1000,
+                                           std::numeric_limits<qint32>::max()));
+    }
+
+    QNetworkTraceFile *trace = traceFile();
+    if (!trace || !trace->file.isOpen()) {
+        QByteArray timings;
+        for (qint32 usecs : elapsed)
+            timings += usecs < 0 ? QByteArray(" -") : ' ' + QByteArray::number(usecs);
+        qCDebug(lcNetworkTrace, "%s status=%d sent=%lld received=%lld reused=%d stream=%d usecs:%s",
+                encodedUrl.constData(), statusCode, d.bytesSent, d.bytesReceived,
+                int(d.connectionReused), d.http2StreamId, timings.constData());
+        return;
+    }
+
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out << quint32(0) << qint64(d.startedAtMSecsSinceEpoch);
+    for (qint32 usecs : elapsed)
+        out << usecs;
+    out << qint64(d.bytesSent) << qint64(d.bytesReceived) << qint32(d.http2StreamId)
+        << quint16(statusCode) << quint8(d.connectionReused ? 1 : 0)
+        << quint16(encodedUrl.size());
+    out.writeRawData(encodedUrl.constData(), encodedUrl.size());
+    out.device()->seek(0);
+    out << quint32(record.size() - sizeof(quint32));
+
+    QMutexLocker locker(&trace->mutex);
+    trace->file.write(record);
+    trace->file.flush();
+}
+
+QT_END_NAMESPACE
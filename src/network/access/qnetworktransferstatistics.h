@@ -0,0 +1,99 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QNETWORKTRANSFERSTATISTICS_H
+#define QNETWORKTRANSFERSTATISTICS_H
+
+#include <QtNetwork/qtnetworkglobal.h>
+
+#include <QtCore/qshareddata.h>
+#include <QtCore/qmetatype.h>
+
+QT_BEGIN_NAMESPACE
+
+class QNetworkTransferStatisticsPrivate;
+class Q_NETWORK_EXPORT QNetworkTransferStatistics
+{
+public:
+    enum Event {
+        RequestStarted,
+        RequestQueued,
+        ConnectionStarted,
+        HostFound,
+        Connected,
+        Encrypted,
+        RequestSent,
+        ResponseStarted,
+        ResponseFinished
+    };
+
+    QNetworkTransferStatistics();
+    QNetworkTransferStatistics(const QNetworkTransferStatistics &other);
+    QNetworkTransferStatistics &operator=(const QNetworkTransferStatistics &other);
+#ifdef Q_COMPILER_RVALUE_REFS
+    QNetworkTransferStatistics &operator=(QNetworkTransferStatistics &&other) Q_DECL_NOTHROW { swap(other); return *this; }
+#endif
+    ~QNetworkTransferStatistics();
+
+    void swap(QNetworkTransferStatistics &other) Q_DECL_NOTHROW { qSwap(d, other.d); }
+
+    bool isValid() const;
+
+    qint64 elapsed(Event event) const;
+    qint64 duration(Event from, Event to) const;
+
+    qint64 bytesSent() const;
+    qint64 bytesReceived() const;
+    bool isConnectionReused() const;
+    int http2StreamId() const;
+
+private:
+    friend class QNetworkTransferStatisticsPrivate;
+    explicit QNetworkTransferStatistics(QNetworkTransferStatisticsPrivate *dd);
+
+    QSharedDataPointer<QNetworkTransferStatisticsPrivate> d;
+};
+
+Q_DECLARE_SHARED(QNetworkTransferStatistics)
+
+QT_END_NAMESPACE
+
+Q_DECLARE_METATYPE(QNetworkTransferStatistics)
+
+#endif // QNETWORKTRANSFERSTATISTICS_H
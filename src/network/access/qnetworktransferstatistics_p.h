@@ -0,0 +1,125 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QNETWORKTRANSFERSTATISTICS_P_H
+#define QNETWORKTRANSFERSTATISTICS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the Network Access API.  This header file may change from
+// version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNetwork/private/qtnetworkglobal_p.h>
+#include "qnetworktransferstatistics.h"
+#include <QtCore/qloggingcategory.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(lcNetworkTrace)
+
+class QUrl;
+
+// When a connection (channel) went through the steps of being established,
+// in QNetworkTransferStatisticsPrivate::now() time. 0 means "did not happen".
+struct QNetworkConnectionTimings
+{
+    qint64 started = 0;
+    qint64 hostFound = 0;
+    qint64 connected = 0;
+    qint64 encrypted = 0;
+
+    qint64 establishedAt() const { return encrypted ? encrypted : connected; }
+};
+
+class QNetworkTransferStatisticsPrivate : public QSharedData
+{
+public:
+    enum { EventCount = QNetworkTransferStatistics::ResponseFinished + 1 };
+
+    // Monotonic clock in nanoseconds, shared by all threads
+    static qint64 now();
+
+    // Only the first occurrence of an event is kept, so that resent requests
+    // and repeated signals don't move it.
+    void record(QNetworkTransferStatistics::Event event, qint64 when = now())
+    {
+        if (!timestamps[event])
+            timestamps[event] = when;
+    }
+    bool hasRecorded(QNetworkTransferStatistics::Event event) const { return timestamps[event] != 0; }
+
+    void recordRequestStarted(qint64 when, qint64 msecsSinceEpoch)
+    {
+        timestamps[QNetworkTransferStatistics::RequestStarted] = when;
+        startedAtMSecsSinceEpoch = msecsSinceEpoch;
+    }
+
+    void setConnectionTimings(const QNetworkConnectionTimings &timings, qint64 lookupStarted,
+                              qint64 lookupFinished);
+
+    QNetworkTransferStatistics toPublic() const
+    { return QNetworkTransferStatistics(new QNetworkTransferStatisticsPrivate(*this)); }
+
+    qint64 timestamps[EventCount] = {};
+    qint64 startedAtMSecsSinceEpoch = 0;
+    qint64 bytesSent = 0;
+    qint64 bytesReceived = 0;
+    int http2StreamId = -1;
+    bool connectionReused = false;
+    bool valid = false;
+};
+
+// Exports the statistics of finished requests when the qt.network.trace
+// logging category is enabled for debug output.
+class QNetworkTrace
+{
+public:
+    static bool isEnabled() { return lcNetworkTrace().isDebugEnabled(); }
+    static void write(const QUrl &url, int statusCode, const QNetworkTransferStatisticsPrivate &statistics);
+};
+
+QT_END_NAMESPACE
+
+#endif // QNETWORKTRANSFERSTATISTICS_P_H
@@ -1227,15 +1227,10 @@ void QSpdyProtocolHandler::handleDataFrame(const QByteArray &frameHeaders)
         replyPrivate->currentlyReceivedDataInWindow = 0;
     }
 
-    httpReply->d_func()->compressedData.append(data);
-
-
     replyPrivate->totalProgress += length;
 
     if (httpRequest.d->autoDecompress && httpReply->d_func()->isCompressed()) {
-        QByteDataBuffer inDataBuffer; // ### should we introduce one in the http reply?
-        inDataBuffer.append(data);
-        qint64 compressedCount = httpReply->d_func()->uncompressBodyData(&inDataBuffer,
+        qint64 compressedCount = httpReply->d_func()->uncompressBodyData(data.constData(), data.size(),
                                                                          &replyPrivate->responseData);
         Q_ASSERT(compressedCount >= 0);
         Q_UNUSED(compressedCount); // silence -Wunused-variable
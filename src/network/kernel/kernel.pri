@@ -13,6 +13,7 @@ HEADERS += kernel/qtnetworkglobal.h \
            kernel/qhostaddress_p.h \
            kernel/qhostinfo.h \
            kernel/qhostinfo_p.h \
+           kernel/qhostinfodnsresolver_p.h \
            kernel/qnetworkdatagram.h \
            kernel/qnetworkdatagram_p.h \
            kernel/qnetworkinterface.h \
@@ -23,6 +24,7 @@ SOURCES += kernel/qauthenticator.cpp \
            kernel/qdnslookup.cpp \
            kernel/qhostaddress.cpp \
            kernel/qhostinfo.cpp \
+           kernel/qhostinfodnsresolver.cpp \
            kernel/qnetworkdatagram.cpp \
            kernel/qnetworkinterface.cpp \
            kernel/qnetworkproxy.cpp
@@ -39,6 +39,7 @@
 
 #include "qhostinfo.h"
 #include "qhostinfo_p.h"
+#include "qhostinfodnsresolver_p.h"
 
 #include "QtCore/qscopedpointer.h"
 #include <qabstracteventdispatcher.h>
@@ -178,7 +179,16 @@ void emit_results_ready(const QHostInfo &hostInfo, const QObject *receiver,
     but also changes the order of signal emissions when using lookupHost()
     compared to previous versions of Qt.
     \note Since Qt 4.6.3 QHostInfo is using a small internal 60 second DNS cache
-    for performance improvements.
+    for performance improvements. Since Qt 5.10 the cache honors shorter DNS
+    record lifetimes when they are known, and also remembers for a few
+    seconds that a host name does not exist.
+
+    \note Since Qt 5.10, setting the \c QT_HOSTINFO_NAMESERVER environment
+    variable to an address (optionally followed by a colon and a port)
+    makes QHostInfo send DNS queries to that server directly instead of
+    using the system resolver, for all names except address literals,
+    \c localhost and names without a dot. This does not consult the hosts
+    file or search domains.
 
     \sa QAbstractSocket, {http://www.rfc-editor.org/rfc/rfc3492.txt}{RFC 3492}
 */
@@ -368,9 +378,10 @@ QHostInfo QHostInfo::fromName(const QString &name)
     qDebug("QHostInfo::fromName(\"%s\")",name.toLatin1().constData());
 #endif
 
-    QHostInfo hostInfo = QHostInfoAgent::fromName(name);
     QAbstractHostInfoLookupManager* manager = theHostInfoLookupManager();
-    manager->cache.put(name, hostInfo);
+    int ttl = -1;
+    QHostInfo hostInfo = manager->resolve(name, &ttl);
+    manager->cache.put(name, hostInfo, ttl);
     return hostInfo;
 }
 
@@ -673,32 +684,7 @@ void QHostInfoRunnable::run()
         hostInfo = QHostInfoAgent::fromName(toBeLookedUp);
     }
 
-    // check aborted again
-    if (manager->wasAborted(id)) {
-        manager->lookupFinished(this);
-        return;
-    }
-
-    // signal emission
-    hostInfo.setLookupId(id);
-    resultEmitter.emitResultsReady(hostInfo);
-
-    // now also iterate through the postponed ones
-    {
-        QMutexLocker locker(&manager->mutex);
-        const auto partitionBegin = std::stable_partition(manager->postponedLookups.rbegin(), manager->postponedLookups.rend(),
-                                                          ToBeLookedUpEquals(toBeLookedUp)).base();
-        const auto partitionEnd = manager->postponedLookups.end();
-        for (auto it = partitionBegin; it != partitionEnd; ++it) {
-            QHostInfoRunnable* postponed = *it;
-            // we can now emit
-            hostInfo.setLookupId(postponed->id);
-            postponed->resultEmitter.emitResultsReady(hostInfo);
-            delete postponed;
-        }
-        manager->postponedLookups.erase(partitionBegin, partitionEnd);
-    }
-
+    manager->emitResults(this, hostInfo);
     manager->lookupFinished(this);
 
     // thread goes back to QThreadPool
@@ -714,6 +700,8 @@ QHostInfoLookupManager::QHostInfoLookupManager() : mutex(QMutex::Recursive), was
 QHostInfoLookupManager::~QHostInfoLookupManager()
 {
     wasDeleted = true;
+    resolverThread.quit();
+    resolverThread.wait();
 
     // don't qDeleteAll currentLookups, the QThreadPool has ownership
     clear();
@@ -781,7 +769,7 @@ void QHostInfoLookupManager::work()
         auto it = scheduledLookups.begin();
         while (readyToStartCount--) {
             // runnable now running in new thread, track this in currentLookups
-            threadPool.start(*it);
+            startLookup(*it);
             currentLookups.push_back(std::move(*it));
             ++it;
         }
@@ -789,6 +777,69 @@ void QHostInfoLookupManager::work()
     }
 }
 
+// called from work(); hands the lookup to the thread pool, or to a
+// QHostInfoDnsResolver when a nameserver is configured
+void QHostInfoLookupManager::startLookup(QHostInfoRunnable *r)
+{
+    QHostAddress nameserver;
+    quint16 port;
+    if (!nameserverFor(r->toBeLookedUp, &nameserver, &port)) {
+        threadPool.start(r);
+        return;
+    }
+
+    // The resolver only waits for its socket and timer, so all of them
+    // share one thread with an event loop instead of blocking a pool thread
+    // each. The socket is created by lookup(), in that thread.
+    if (!resolverThread.isRunning()) {
+        resolverThread.setObjectName(QStringLiteral("QHostInfo resolver"));
+        resolverThread.start();
+    }
+    QHostInfoDnsResolver *resolver = new QHostInfoDnsResolver;
+    resolver->setNameserver(nameserver, port);
+    resolver->moveToThread(&resolverThread);
+    connect(&resolverThread, SIGNAL(finished()), resolver, SLOT(deleteLater()));
+    connect(resolver, &QHostInfoDnsResolver::finished, resolver, [this, r, resolver]() {
+        dnsLookupFinished(r, resolver);
+    });
+    QMetaObject::invokeMethod(resolver, "lookup", Qt::QueuedConnection,
+                              Q_ARG(QString, r->toBeLookedUp));
+}
+
+// called in the resolver thread when a lookup started by startLookup() is done
+void QHostInfoLookupManager::dnsLookupFinished(QHostInfoRunnable *r, QHostInfoDnsResolver *resolver)
+{
+    resolver->deleteLater();
+    if (wasDeleted)
+        return;
+
+    if (resolver->isTruncated()) {
+        // too many addresses for a UDP response, ask the system resolver
+        QMutexLocker locker(&mutex);
+        threadPool.start(r);
+        return;
+    }
+
+    const QHostInfo hostInfo = resolver->result();
+    if (cache.isEnabled())
+        cache.put(r->toBeLookedUp, hostInfo, resolver->ttl());
+    emitResults(r, hostInfo);
+
+    // The runnable never went to the thread pool, so nobody else deletes it.
+    QMutexLocker locker(&mutex);
+    currentLookups.removeOne(r);
+    abortedLookups.removeAll(r->id);
+    delete r;
+    work();
+}
+
+void QHostInfoLookupManager::waitForThreadPoolDone()
+{
+    threadPool.waitForDone();
+    resolverThread.quit();
+    resolverThread.wait();
+}
+
 // called by QHostInfo
 void QHostInfoLookupManager::scheduleLookup(QHostInfoRunnable *r)
 {
@@ -838,6 +889,32 @@ bool QHostInfoLookupManager::wasAborted(int id)
     return abortedLookups.contains(id);
 }
 
+// Reports \a hostInfo to the receiver of \a r and of the lookups that were
+// postponed because they were for the same name, unless \a r was aborted.
+void QHostInfoLookupManager::emitResults(QHostInfoRunnable *r, QHostInfo hostInfo)
+{
+    if (wasAborted(r->id))
+        return;
+
+    // signal emission
+    hostInfo.setLookupId(r->id);
+    r->resultEmitter.emitResultsReady(hostInfo);
+
+    // now also iterate through the postponed ones
+    QMutexLocker locker(&mutex);
+    const auto partitionBegin = std::stable_partition(postponedLookups.rbegin(), postponedLookups.rend(),
+                                                      ToBeLookedUpEquals(r->toBeLookedUp)).base();
+    const auto partitionEnd = postponedLookups.end();
+    for (auto it = partitionBegin; it != partitionEnd; ++it) {
+        QHostInfoRunnable* postponed = *it;
+        // we can now emit
+        hostInfo.setLookupId(postponed->id);
+        postponed->resultEmitter.emitResultsReady(hostInfo);
+        delete postponed;
+    }
+    postponedLookups.erase(partitionBegin, partitionEnd);
+}
+
 // called from QHostInfoRunnable
 void QHostInfoLookupManager::lookupFinished(QHostInfoRunnable *r)
 {
@@ -897,11 +974,19 @@ void qt_qhostinfo_cache_inject(const QString &hostname, const QHostInfo &resolut
 
     manager->cache.put(hostname, resolution);
 }
+
+void qt_qhostinfo_set_nameserver(const QHostAddress &address, quint16 port)
+{
+    QAbstractHostInfoLookupManager* manager = theHostInfoLookupManager();
+    if (manager)
+        manager->setNameserver(address, port);
+}
 #endif
 
-// cache for 60 seconds
+// cache for 60 seconds, or less if the DNS records say so
+// cache names that don't exist for 10 seconds
 // cache 128 items
-QHostInfoCache::QHostInfoCache() : max_age(60), enabled(true), cache(128)
+QHostInfoCache::QHostInfoCache() : max_age(60), negative_max_age(10), enabled(true), cache(128)
 {
 #ifdef QT_QHOSTINFO_CACHE_DISABLED_BY_DEFAULT
     enabled = false;
@@ -927,7 +1012,7 @@ QHostInfo QHostInfoCache::get(const QString &name, bool *valid)
 
     *valid = false;
     if (QHostInfoCacheElement *element = cache.object(name)) {
-        if (element->age.elapsed() < max_age*1000)
+        if (element->age.elapsed() < element->lifetime)
             *valid = true;
         return element->info;
 
@@ -939,14 +1024,28 @@ QHostInfo QHostInfoCache::get(const QString &name, bool *valid)
     return QHostInfo();
 }
 
-void QHostInfoCache::put(const QString &name, const QHostInfo &info)
+// \a ttl is the lifetime of the DNS records behind \a info in seconds,
+// or -1 if unknown. It never extends the cache's own maximum age.
+void QHostInfoCache::put(const QString &name, const QHostInfo &info, int ttl)
 {
-    // if the lookup failed, don't cache
-    if (info.error() != QHostInfo::NoError)
+    // Remember that a name doesn't exist, so that repeated attempts don't
+    // each wait for the DNS server. Other failures may be temporary
+    // (no network, server timeouts) and are not cached.
+    int lifetime;
+    if (info.error() == QHostInfo::NoError)
+        lifetime = max_age;
+    else if (info.error() == QHostInfo::HostNotFound)
+        lifetime = negative_max_age;
+    else
+        return;
+    if (ttl >= 0)
+        lifetime = qMin(lifetime, ttl);
+    if (lifetime == 0)
         return;
 
     QHostInfoCacheElement* element = new QHostInfoCacheElement();
     element->info = info;
+    element->lifetime = lifetime * qint64(1000);
     element->age = QElapsedTimer();
     element->age.start();
 
@@ -960,9 +1059,56 @@ void QHostInfoCache::clear()
     cache.clear();
 }
 
+QAbstractHostInfoLookupManager::QAbstractHostInfoLookupManager()
+    : nameserverPort(53)
+{
+    const QByteArray server = qgetenv("QT_HOSTINFO_NAMESERVER");
+    if (!server.isEmpty() && !nameserverAddress.setAddress(QString::fromLatin1(server))) {
+        // address:port or [IPv6 address]:port
+        const QUrl url(QLatin1String("dns://") + QString::fromLatin1(server));
+        if (nameserverAddress.setAddress(url.host()))
+            nameserverPort = quint16(url.port(53));
+        else
+            qWarning("QHostInfo: ignoring invalid QT_HOSTINFO_NAMESERVER \"%s\"", server.constData());
+    }
+}
+
 QAbstractHostInfoLookupManager* QAbstractHostInfoLookupManager::globalInstance()
 {
     return theHostInfoLookupManager();
 }
 
+// Looks up \a name with the configured nameserver if there is one, and with
+// the system resolver otherwise. \a ttl receives the number of seconds the
+// result may be cached for, or -1 if that is not known.
+QHostInfo QAbstractHostInfoLookupManager::resolve(const QString &name, int *ttl)
+{
+    *ttl = -1;
+    QHostAddress server;
+    quint16 port;
+    if (nameserverFor(name, &server, &port))
+        return QHostInfoDnsResolver::fromName(name, server, port, ttl);
+    return QHostInfoAgent::fromName(name);
+}
+
+// Returns \c true and sets \a address and \a port to the configured
+// nameserver if \a name should be resolved with QHostInfoDnsResolver.
+bool QAbstractHostInfoLookupManager::nameserverFor(const QString &name, QHostAddress *address,
+                                                   quint16 *port)
+{
+    {
+        QMutexLocker locker(&nameserverMutex);
+        *address = nameserverAddress;
+        *port = nameserverPort;
+    }
+    return !address->isNull() && QHostInfoDnsResolver::canResolve(name);
+}
+
+void QAbstractHostInfoLookupManager::setNameserver(const QHostAddress &address, quint16 port)
+{
+    QMutexLocker locker(&nameserverMutex);
+    nameserverAddress = address;
+    nameserverPort = port;
+}
+
 QT_END_NAMESPACE
@@ -56,6 +56,7 @@
 #include "private/qcoreapplication_p.h"
 #include "private/qmetaobject_p.h"
 #include "QtNetwork/qhostinfo.h"
+#include "QtNetwork/qhostaddress.h"
 #include "QtCore/qmutex.h"
 #include "QtCore/qwaitcondition.h"
 #include "QtCore/qobject.h"
@@ -74,6 +75,7 @@
 
 QT_BEGIN_NAMESPACE
 
+class QHostInfoDnsResolver;
 
 class QHostInfoResult : public QObject
 {
@@ -163,15 +165,17 @@ QHostInfo Q_NETWORK_EXPORT qt_qhostinfo_lookup(const QString &name, QObject *rec
 void Q_AUTOTEST_EXPORT qt_qhostinfo_clear_cache();
 void Q_AUTOTEST_EXPORT qt_qhostinfo_enable_cache(bool e);
 void Q_AUTOTEST_EXPORT qt_qhostinfo_cache_inject(const QString &hostname, const QHostInfo &resolution);
+void Q_AUTOTEST_EXPORT qt_qhostinfo_set_nameserver(const QHostAddress &address, quint16 port);
 
 class QHostInfoCache
 {
 public:
     QHostInfoCache();
     const int max_age; // seconds
+    const int negative_max_age; // seconds, for names that don't exist
 
     QHostInfo get(const QString &name, bool *valid);
-    void put(const QString &name, const QHostInfo &info);
+    void put(const QString &name, const QHostInfo &info, int ttl = -1);
     void clear();
 
     bool isEnabled();
@@ -181,6 +185,7 @@ private:
     struct QHostInfoCacheElement {
         QHostInfo info;
         QElapsedTimer age;
+        qint64 lifetime; // milliseconds
     };
     QCache<QString,QHostInfoCacheElement> cache;
     QMutex mutex;
@@ -210,11 +215,21 @@ public:
     ~QAbstractHostInfoLookupManager() {}
     virtual void clear() = 0;
 
+    QHostInfo resolve(const QString &name, int *ttl);
+    void setNameserver(const QHostAddress &address, quint16 port);
+
     QHostInfoCache cache;
 
 protected:
-     QAbstractHostInfoLookupManager() {}
+     QAbstractHostInfoLookupManager();
      static QAbstractHostInfoLookupManager* globalInstance();
+     bool nameserverFor(const QString &name, QHostAddress *address, quint16 *port);
+
+private:
+     // when set, names are resolved with QHostInfoDnsResolver instead of getaddrinfo()
+     QHostAddress nameserverAddress;
+     quint16 nameserverPort;
+     QMutex nameserverMutex;
 
 };
 
@@ -235,6 +250,7 @@ public:
     // called from QHostInfoRunnable
     void lookupFinished(QHostInfoRunnable *r);
     bool wasAborted(int id);
+    void emitResults(QHostInfoRunnable *r, QHostInfo hostInfo);
 
     friend class QHostInfoRunnable;
 protected:
@@ -245,13 +261,18 @@ protected:
     QList<int> abortedLookups; // ids of aborted lookups
 
     QThreadPool threadPool;
+    QThread resolverThread; // runs the QHostInfoDnsResolver lookups
 
     QMutex mutex;
 
     bool wasDeleted;
 
+private:
+    void startLookup(QHostInfoRunnable *r);
+    void dnsLookupFinished(QHostInfoRunnable *r, QHostInfoDnsResolver *resolver);
+
 private slots:
-    void waitForThreadPoolDone() { threadPool.waitForDone(); }
+    void waitForThreadPoolDone();
 };
 
 QT_END_NAMESPACE
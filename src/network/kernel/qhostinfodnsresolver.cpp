@@ -0,0 +1,502 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qhostinfodnsresolver_p.h"
+#include "qhostinfo_p.h"
+
+#include <QtNetwork/qudpsocket.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qtimer.h>
+#include <QtCore/qurl.h>
+
+#include <random>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+enum {
+    HeaderSize = 12,
+    DefaultTimeout = 2000, // milliseconds per attempt
+    DefaultAttempts = 3,
+    MaxPacketSize = 512,   // UDP without EDNS0
+    MaxPointerJumps = 64,
+
+    FlagResponse = 0x8000,
+    FlagTruncated = 0x0200,
+    FlagRecursionDesired = 0x0100,
+    RcodeMask = 0x000f,
+
+    RcodeNoError = 0,
+    RcodeNameError = 3,  // NXDOMAIN
+
+    ClassIN = 1
+};
+
+// Query IDs are the only thing that keeps an off-path attacker from
+// injecting answers, so don't make them predictable.
+quint16 randomQueryId()
+{
+    static QBasicMutex mutex;
+    static std::mt19937 generator{std::random_device{}()};
+    QMutexLocker locker(&mutex);
+    return quint16(generator());
+}
+
+// Reads the (possibly compressed) domain name at \a offset into \a name and
+// sets \a next to the offset just past it. Returns false on malformed input.
+bool readName(const uchar *data, int size, int offset, QByteArray *name, int *next)
+{
+    int jumps = 0;
+    int end = -1;
+    name->clear();
+    for (;;) {
+        if (offset >= size)
+            return false;
+        const uchar length = data[offset];
+        if ((length & 0xc0) == 0xc0) {
+            if (offset + 1 >= size || ++jumps > MaxPointerJumps)
+                return false;
+            if (end < 0)
+                end = offset + 2;
+            offset = ((length & 0x3f) << 8) | data[offset + 1];
+            continue;
+        }
+        if (length & 0xc0)
+            return false; // extended label types are not used
+        if (length == 0) {
+            *next = end < 0 ? offset + 1 : end;
+            return true;
+        }
+        if (offset + 1 + length > size)
+            return false;
+        if (!name->isEmpty())
+            name->append('.');
+        name->append(reinterpret_cast<const char *>(data + offset + 1), length);
+        offset += 1 + length;
+    }
+}
+
+int clampTtl(quint32 ttl)
+{
+    // RFC 2181: values with the top bit set are to be treated as zero
+    return ttl > 0x7fffffffU ? 0 : int(ttl);
+}
+}
+
+QHostInfoDnsResolver::QHostInfoDnsResolver(QObject *parent)
+    : QObject(parent),
+      port(53),
+      timeout(DefaultTimeout),
+      attempts(DefaultAttempts),
+      attempt(0),
+      socket(Q_NULLPTR),
+      retransmitTimer(Q_NULLPTR),
+      finishedFlag(false),
+      truncated(false),
+      resultTtl(-1)
+{
+}
+
+QHostInfoDnsResolver::~QHostInfoDnsResolver()
+{
+}
+
+void QHostInfoDnsResolver::setNameserver(const QHostAddress &address, quint16 port)
+{
+    nameserverAddress = address;
+    this->port = port;
+}
+
+/*!
+    \internal
+
+    Returns \c true if \a hostName should be resolved with plain DNS queries.
+    Address literals, localhost and single-label names (which depend on
+    search domains or the hosts file) are left to the system resolver.
+*/
+bool QHostInfoDnsResolver::canResolve(const QString &hostName)
+{
+    if (hostName.isEmpty() || QHostAddress().setAddress(hostName))
+        return false;
+    QString name = hostName.toLower();
+    if (name.endsWith(QLatin1Char('.')))
+        name.chop(1);
+    if (!name.contains(QLatin1Char('.')))
+        return false;
+    return name != QLatin1String("localhost")
+            && !name.endsWith(QLatin1String(".localhost"))
+            && !name.endsWith(QLatin1String(".local"));
+}
+
+QByteArray QHostInfoDnsResolver::buildQuery(quint16 id, const QByteArray &aceName, RecordType type)
+{
+    QByteArray packet(HeaderSize, Qt::Uninitialized);
+    uchar *header = reinterpret_cast<uchar *>(packet.data());
+    qToBigEndian<quint16>(id, header);
+    qToBigEndian<quint16>(FlagRecursionDesired, header + 2);
+    qToBigEndian<quint16>(1, header + 4); // QDCOUNT
+    qToBigEndian<quint16>(0, header + 6);
+    qToBigEndian<quint16>(0, header + 8);
+    qToBigEndian<quint16>(0, header + 10);
+
+    const QList<QByteArray> labels = aceName.split('.');
+    for (const QByteArray &label : labels) {
+        if (label.isEmpty())
+            continue; // trailing dot
+        if (label.size() > 63)
+            return QByteArray();
+        packet.append(char(label.size()));
+        packet.append(label);
+    }
+    packet.append('\0');
+    if (packet.size() - HeaderSize > 255)
+        return QByteArray();
+
+    uchar question[4];
+    qToBigEndian<quint16>(quint16(type), question);
+    qToBigEndian<quint16>(ClassIN, question + 2);
+    packet.append(reinterpret_cast<const char *>(question), sizeof question);
+    return packet;
+}
+
+/*!
+    \internal
+
+    Parses the DNS response in \a packet. Returns \c false if the packet is
+    malformed or is not the response to query \a id; in that case it should
+    be ignored.
+*/
+bool QHostInfoDnsResolver::parseResponse(const QByteArray &packet, quint16 id, Response *response)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(packet.constData());
+    const int size = packet.size();
+    if (size < HeaderSize)
+        return false;
+
+    const quint16 flags = qFromBigEndian<quint16>(data + 2);
+    if (qFromBigEndian<quint16>(data) != id || !(flags & FlagResponse))
+        return false;
+
+    response->rcode = flags & RcodeMask;
+    response->truncated = flags & FlagTruncated;
+    const int questionCount = qFromBigEndian<quint16>(data + 4);
+    const int answerCount = qFromBigEndian<quint16>(data + 6);
+    const int authorityCount = qFromBigEndian<quint16>(data + 8);
+    if (questionCount != 1)
+        return false;
+
+    int offset = HeaderSize;
+    if (!readName(data, size, offset, &response->questionName, &offset) || offset + 4 > size)
+        return false;
+    offset += 4;
+
+    QByteArray name;
+    for (int i = 0; i < answerCount + authorityCount; ++i) {
+        if (!readName(data, size, offset, &name, &offset) || offset + 10 > size)
+            return false;
+        const quint16 type = qFromBigEndian<quint16>(data + offset);
+        const quint16 rrClass = qFromBigEndian<quint16>(data + offset + 2);
+        const int ttl = clampTtl(qFromBigEndian<quint32>(data + offset + 4));
+        const int length = qFromBigEndian<quint16>(data + offset + 8);
+        offset += 10;
+        if (offset + length > size)
+            return false;
+
+        if (rrClass == ClassIN && i < answerCount) {
+            // CNAME records are followed by the records of their target;
+            // we only need the addresses at the end of the chain.
+            if (type == A && length == 4) {
+                response->addresses.append(QHostAddress(qFromBigEndian<quint32>(data + offset)));
+            } else if (type == AAAA && length == 16) {
+                response->addresses.append(QHostAddress(data + offset));
+            } else {
+                offset += length;
+                continue;
+            }
+            response->ttl = response->ttl < 0 ? ttl : qMin(response->ttl, ttl);
+        } else if (rrClass == ClassIN && type == SOA) {
+            // RFC 2308: a negative answer may be cached for the smaller of
+            // the SOA record's TTL and its MINIMUM field.
+            QByteArray ignored;
+            int soa = offset;
+            if (!readName(data, size, soa, &ignored, &soa)
+                    || !readName(data, size, soa, &ignored, &soa)
+                    || soa + 20 > offset + length) {
+                return false;
+            }
+            const int minimum = clampTtl(qFromBigEndian<quint32>(data + soa + 16));
+            response->negativeTtl = qMin(ttl, minimum);
+        }
+        offset += length;
+    }
+    return true;
+}
+
+/*!
+    \internal
+
+    Starts looking up \a hostName. Returns \c false if the lookup could not
+    be started; result() then holds the error.
+*/
+bool QHostInfoDnsResolver::lookup(const QString &name)
+{
+    abort();
+    hostName = name;
+    info = QHostInfo();
+    info.setHostName(name);
+    finishedFlag = false;
+    truncated = false;
+    resultTtl = -1;
+    attempt = 0;
+
+    aceName = QUrl::toAce(name);
+    if (aceName.endsWith('.'))
+        aceName.chop(1);
+    const QByteArray queryA = buildQuery(0, aceName, A);
+    if (aceName.isEmpty() || queryA.isEmpty()) {
+        setFinished(QHostInfo::HostNotFound,
+                    QCoreApplication::translate("QHostInfoAgent", "Invalid hostname"), 0);
+        return false;
+    }
+    if (nameserverAddress.isNull()) {
+        setFinished(QHostInfo::UnknownError,
+                    QCoreApplication::translate("QHostInfoAgent", "No nameserver"), 0);
+        return false;
+    }
+
+    if (!socket) {
+        socket = new QUdpSocket(this);
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readDatagrams()));
+        retransmitTimer = new QTimer(this);
+        retransmitTimer->setSingleShot(true);
+        connect(retransmitTimer, SIGNAL(timeout()), this, SLOT(retransmit()));
+    }
+
+    // AAAA first: the result lists IPv6 addresses before IPv4 ones, like
+    // getaddrinfo() does with the default RFC 6724 policy.
+    queries[0] = Query();
+    queries[0].type = AAAA;
+    queries[1] = Query();
+    queries[1].type = A;
+    queries[0].id = randomQueryId();
+    do {
+        queries[1].id = randomQueryId();
+    } while (queries[1].id == queries[0].id);
+
+    for (const Query &query : queries)
+        sendQuery(query);
+    return true;
+}
+
+void QHostInfoDnsResolver::sendQuery(const Query &query)
+{
+    socket->writeDatagram(buildQuery(query.id, aceName, query.type), nameserverAddress, port);
+    sinceLastSend.start();
+    retransmitTimer->start(timeout);
+}
+
+void QHostInfoDnsResolver::abort()
+{
+    if (retransmitTimer)
+        retransmitTimer->stop();
+    if (socket)
+        socket->close();
+    finishedFlag = true;
+}
+
+/*!
+    \internal
+
+    Runs the lookup to completion without an event loop. Returns \c true if
+    the lookup finished within \a msecs milliseconds (-1 waits forever).
+*/
+bool QHostInfoDnsResolver::waitForFinished(int msecs)
+{
+    QElapsedTimer stopWatch;
+    stopWatch.start();
+    while (!finishedFlag) {
+        int wait = qMax(0, timeout - int(sinceLastSend.elapsed()));
+        if (msecs >= 0)
+            wait = qMin(wait, qMax(0, msecs - int(stopWatch.elapsed())));
+        if (socket->waitForReadyRead(wait))
+            readDatagrams();
+        else if (sinceLastSend.elapsed() >= timeout)
+            retransmit();
+        if (msecs >= 0 && !finishedFlag && stopWatch.elapsed() >= msecs)
+            return false;
+    }
+    return true;
+}
+
+void QHostInfoDnsResolver::readDatagrams()
+{
+    while (socket->state() == QAbstractSocket::BoundState && socket->hasPendingDatagrams()) {
+        QByteArray packet(MaxPacketSize, Qt::Uninitialized);
+        QHostAddress sender;
+        quint16 senderPort = 0;
+        const qint64 size = socket->readDatagram(packet.data(), packet.size(), &sender, &senderPort);
+        if (size < 0 || finishedFlag)
+            continue;
+        if (senderPort != port || !sender.isEqual(nameserverAddress))
+            continue; // not from the server we asked
+        packet.resize(int(size));
+        processDatagram(packet);
+    }
+}
+
+void QHostInfoDnsResolver::processDatagram(const QByteArray &packet)
+{
+    if (packet.size() < HeaderSize)
+        return;
+    const quint16 id = qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(packet.constData()));
+    for (Query &query : queries) {
+        if (query.done || query.id != id)
+            continue;
+        Response response;
+        if (!parseResponse(packet, id, &response)
+                || qstricmp(response.questionName.constData(), aceName.constData()) != 0) {
+            return;
+        }
+        query.done = true;
+        query.response = response;
+        if (response.truncated) {
+            // We don't do DNS over TCP; let the caller fall back to the
+            // system resolver.
+            truncated = true;
+            setFinished(QHostInfo::UnknownError,
+                        QCoreApplication::translate("QHostInfoAgent", "Response truncated"), 0);
+            return;
+        }
+        if (queries[0].done && queries[1].done)
+            finish();
+        return;
+    }
+}
+
+void QHostInfoDnsResolver::retransmit()
+{
+    if (finishedFlag)
+        return;
+    if (++attempt >= attempts) {
+        setFinished(QHostInfo::UnknownError,
+                    QCoreApplication::translate("QHostInfoAgent", "Timeout while resolving host name"), 0);
+        return;
+    }
+    for (const Query &query : queries) {
+        if (!query.done)
+            sendQuery(query);
+    }
+}
+
+void QHostInfoDnsResolver::finish()
+{
+    QList<QHostAddress> addresses;
+    int ttl = -1;
+    bool negative = true;
+    for (const Query &query : queries) {
+        const Response &response = query.response;
+        addresses += response.addresses;
+        // The result is only as fresh as its shortest-lived part, which
+        // includes a NODATA answer for the other address family.
+        int partTtl = response.addresses.isEmpty() ? response.negativeTtl : response.ttl;
+        if (response.rcode != RcodeNoError && response.rcode != RcodeNameError) {
+            negative = false;
+            partTtl = 0; // server failure: don't cache what we got
+        }
+        if (partTtl >= 0)
+            ttl = ttl < 0 ? partTtl : qMin(ttl, partTtl);
+    }
+
+    if (!addresses.isEmpty()) {
+        info.setAddresses(addresses);
+        setFinished(QHostInfo::NoError, QString(), ttl);
+    } else if (negative) {
+        setFinished(QHostInfo::HostNotFound,
+                    QCoreApplication::translate("QHostInfoAgent", "Host not found"), ttl);
+    } else {
+        setFinished(QHostInfo::UnknownError,
+                    QCoreApplication::translate("QHostInfoAgent", "Server failure"), 0);
+    }
+}
+
+void QHostInfoDnsResolver::setFinished(QHostInfo::HostInfoError error, const QString &errorString,
+                                       int ttl)
+{
+    if (retransmitTimer)
+        retransmitTimer->stop();
+    if (socket)
+        socket->close();
+    if (error != QHostInfo::NoError) {
+        info.setError(error);
+        info.setErrorString(errorString);
+    }
+    resultTtl = ttl;
+    finishedFlag = true;
+    emit finished();
+}
+
+/*!
+    \internal
+
+    Blocking lookup of \a hostName at \a nameserver. If \a ttl is not null,
+    it is set to the number of seconds the result may be cached for, or -1
+    if the server did not say. Responses too large for UDP are resolved
+    with the system resolver instead.
+*/
+QHostInfo QHostInfoDnsResolver::fromName(const QString &hostName, const QHostAddress &nameserver,
+                                         quint16 port, int *ttl)
+{
+    QHostInfoDnsResolver resolver;
+    resolver.setNameserver(nameserver, port);
+    if (resolver.lookup(hostName))
+        resolver.waitForFinished();
+    if (resolver.isTruncated()) {
+        // too many addresses for a UDP response
+        if (ttl)
+            *ttl = -1;
+        return QHostInfoAgent::fromName(hostName);
+    }
+    if (ttl)
+        *ttl = resolver.ttl();
+    return resolver.result();
+}
+
+QT_END_NAMESPACE
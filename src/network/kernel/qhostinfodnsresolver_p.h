@@ -0,0 +1,170 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QHOSTINFODNSRESOLVER_P_H
+#define QHOSTINFODNSRESOLVER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNetwork/private/qtnetworkglobal_p.h>
+#include <QtNetwork/qhostaddress.h>
+#include <QtNetwork/qhostinfo.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qelapsedtimer.h>
+
+QT_BEGIN_NAMESPACE
+
+class QUdpSocket;
+class QTimer;
+
+// Resolves host names by sending A and AAAA queries straight to a
+// nameserver over UDP, instead of calling getaddrinfo(). Unlike the system
+// resolver this reports the TTL of the answer, including the negative TTL
+// of NXDOMAIN and NODATA responses (RFC 2308), so the results can be cached
+// for as long as the zone allows.
+//
+// The lookup is driven by the socket's readyRead() and a retransmission
+// timer. QHostInfo::lookupHost() runs its resolvers in the lookup manager's
+// resolver thread; waitForFinished() drives the same state machine without
+// an event loop for QHostInfo::fromName().
+class Q_AUTOTEST_EXPORT QHostInfoDnsResolver : public QObject
+{
+    Q_OBJECT
+public:
+    enum RecordType {
+        A = 1,
+        CNAME = 5,
+        SOA = 6,
+        AAAA = 28
+    };
+
+    struct Response
+    {
+        Response() : rcode(0), truncated(false), ttl(-1), negativeTtl(-1) {}
+
+        QByteArray questionName;
+        int rcode;
+        bool truncated;
+        QList<QHostAddress> addresses;
+        int ttl;         // smallest TTL of the address records, -1 if none
+        int negativeTtl; // from the SOA record in the authority section, -1 if none
+    };
+
+    explicit QHostInfoDnsResolver(QObject *parent = Q_NULLPTR);
+    ~QHostInfoDnsResolver();
+
+    void setNameserver(const QHostAddress &address, quint16 port = 53);
+    QHostAddress nameserver() const { return nameserverAddress; }
+    quint16 nameserverPort() const { return port; }
+
+    void setTimeout(int msecs) { timeout = msecs; }
+    void setAttempts(int count) { attempts = count; }
+
+    Q_INVOKABLE bool lookup(const QString &hostName);
+    bool isFinished() const { return finishedFlag; }
+    bool waitForFinished(int msecs = -1);
+    void abort();
+
+    QHostInfo result() const { return info; }
+    int ttl() const { return resultTtl; }
+    bool isTruncated() const { return truncated; }
+
+    static QHostInfo fromName(const QString &hostName, const QHostAddress &nameserver,
+                              quint16 port, int *ttl);
+    static bool canResolve(const QString &hostName);
+
+    static QByteArray buildQuery(quint16 id, const QByteArray &aceName, RecordType type);
+    static bool parseResponse(const QByteArray &packet, quint16 id, Response *response);
+
+Q_SIGNALS:
+    void finished();
+
+private Q_SLOTS:
+    void readDatagrams();
+    void retransmit();
+
+private:
+    struct Query
+    {
+        Query() : id(0), type(A), done(false) {}
+
+        quint16 id;
+        RecordType type;
+        bool done;
+        Response response;
+    };
+
+    void sendQuery(const Query &query);
+    void processDatagram(const QByteArray &packet);
+    void finish();
+    void setFinished(QHostInfo::HostInfoError error, const QString &errorString, int ttl);
+
+    QHostAddress nameserverAddress;
+    quint16 port;
+    int timeout;
+    int attempts;
+    int attempt;
+
+    QUdpSocket *socket;
+    QTimer *retransmitTimer;
+    QElapsedTimer sinceLastSend;
+
+    QString hostName;
+    QByteArray aceName;
+    Query queries[2];
+    bool finishedFlag;
+    bool truncated;
+    QHostInfo info;
+    int resultTtl;
+
+    Q_DISABLE_COPY(QHostInfoDnsResolver)
+};
+
+QT_END_NAMESPACE
+
+#endif // QHOSTINFODNSRESOLVER_P_H
@@ -984,6 +984,38 @@ void QAbstractSocketPrivate::startConnectingByName(const QString &host)
 
 #endif
 
+/*! \internal
+
+    Reorders \a addresses so that IPv6 and IPv4 addresses alternate,
+    starting with the family of the first address and otherwise keeping the
+    resolver's order (RFC 8305, section 4). If one address family is broken
+    on this host, the next connection attempt then uses the other one
+    instead of going through all addresses of the broken family first.
+*/
+QList<QHostAddress> QAbstractSocketPrivate::interleaveAddressFamilies(const QList<QHostAddress> &addresses)
+{
+    if (addresses.size() < 3)
+        return addresses;
+
+    QList<QHostAddress> first;
+    QList<QHostAddress> second;
+    const QAbstractSocket::NetworkLayerProtocol firstProtocol = addresses.first().protocol();
+    for (const QHostAddress &address : addresses)
+        (address.protocol() == firstProtocol ? first : second).append(address);
+    if (second.isEmpty())
+        return addresses;
+
+    QList<QHostAddress> result;
+    result.reserve(addresses.size());
+    for (int i = 0; i < first.size() || i < second.size(); ++i) {
+        if (i < first.size())
+            result.append(first.at(i));
+        if (i < second.size())
+            result.append(second.at(i));
+    }
+    return result;
+}
+
 /*! \internal
 
     Slot connected to QHostInfo::lookupHost() in connectToHost(). This
@@ -1005,7 +1037,7 @@ void QAbstractSocketPrivate::_q_startConnecting(const QHostInfo &hostInfo)
     // Only add the addresses for the preferred network layer.
     // Or all if preferred network layer is not set.
     if (preferredNetworkLayerProtocol == QAbstractSocket::UnknownNetworkLayerProtocol || preferredNetworkLayerProtocol == QAbstractSocket::AnyIPProtocol) {
-        addresses = hostInfo.addresses();
+        addresses = interleaveAddressFamilies(hostInfo.addresses());
     } else {
         const auto candidates = hostInfo.addresses();
         for (const QHostAddress &address : candidates) {
@@ -90,6 +90,8 @@ public:
     bool canWriteNotification();
     void canCloseNotification();
 
+    Q_AUTOTEST_EXPORT static QList<QHostAddress> interleaveAddressFamilies(const QList<QHostAddress> &addresses);
+
     // slots
     void _q_connectToNextAddress();
     void _q_startConnecting(const QHostInfo &hostInfo);
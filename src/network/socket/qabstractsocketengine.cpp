@@ -273,4 +273,46 @@ int QAbstractSocketEngine::outboundStreamCount() const
     return d_func()->outboundStreamCount;
 }
 
+/*
+    Reads up to \a maxCount datagrams into the buffers of \a maxSize bytes
+    in \a data, storing the size of each datagram in \a sizes and its
+    header in \a headers. Returns the number of datagrams read, or the
+    result of the failing readDatagram() call if none could be read.
+
+    This implementation calls readDatagram() once per datagram; engines
+    that can receive several datagrams in one system call reimplement it.
+*/
+int QAbstractSocketEngine::readDatagrams(char * const *data, qint64 maxSize, int maxCount, qint64 *sizes,
+                                         QIpPacketHeader *headers, PacketHeaderOptions options)
+{
+    int count = 0;
+    while (count < maxCount && (count == 0 || hasPendingDatagrams())) {
+        qint64 readBytes = readDatagram(data[count], maxSize, &headers[count], options);
+        if (readBytes < 0)
+            return count ? count : int(readBytes);
+        sizes[count++] = readBytes;
+    }
+    return count;
+}
+
+/*
+    Writes the \a count datagrams in \a data, of \a sizes bytes each,
+    to the destinations in \a headers. Returns the number of datagrams
+    written, or the result of the failing writeDatagram() call if none
+    could be written.
+
+    This implementation calls writeDatagram() once per datagram; engines
+    that can send several datagrams in one system call reimplement it.
+*/
+int QAbstractSocketEngine::writeDatagrams(const char * const *data, const qint64 *sizes,
+                                          const QIpPacketHeader *headers, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        qint64 sent = writeDatagram(data[i], sizes[i], headers[i]);
+        if (sent < 0)
+            return i ? i : int(sent);
+    }
+    return count;
+}
+
 QT_END_NAMESPACE
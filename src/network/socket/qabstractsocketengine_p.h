@@ -105,7 +105,8 @@ public:
         TypeOfServiceOption,
         ReceivePacketInformation,
         ReceiveHopLimit,
-        MaxStreamsSocketOption
+        MaxStreamsSocketOption,
+        PortReusable
     };
 
     enum PacketHeaderOption {
@@ -157,6 +158,10 @@ public:
     virtual qint64 readDatagram(char *data, qint64 maxlen, QIpPacketHeader *header = 0,
                                 PacketHeaderOptions = WantNone) = 0;
     virtual qint64 writeDatagram(const char *data, qint64 len, const QIpPacketHeader &header) = 0;
+    virtual int readDatagrams(char * const *data, qint64 maxSize, int maxCount, qint64 *sizes,
+                              QIpPacketHeader *headers, PacketHeaderOptions options = WantNone);
+    virtual int writeDatagrams(const char * const *data, const qint64 *sizes,
+                               const QIpPacketHeader *headers, int count);
     virtual qint64 bytesToWrite() const = 0;
 
     virtual int option(SocketOption option) const = 0;
@@ -902,6 +902,45 @@ qint64 QNativeSocketEngine::writeDatagram(const char *data, qint64 size, const Q
     return d->nativeSendDatagram(data, size, header);
 }
 
+#if QT_CONFIG(sendmmsg)
+/*!
+    Reads up to \a maxCount datagrams with a single system call. Each
+    datagram is stored in its own buffer of \a maxSize bytes in \a data,
+    and its size and header in \a sizes and \a headers. Datagrams larger
+    than \a maxSize are truncated.
+
+    Returns the number of datagrams read, or -1 if an error occurred.
+*/
+int QNativeSocketEngine::readDatagrams(char * const *data, qint64 maxSize, int maxCount, qint64 *sizes,
+                                       QIpPacketHeader *headers, PacketHeaderOptions options)
+{
+    Q_D(QNativeSocketEngine);
+    Q_CHECK_VALID_SOCKETLAYER(QNativeSocketEngine::readDatagrams(), -1);
+    Q_CHECK_STATES(QNativeSocketEngine::readDatagrams(), QAbstractSocket::BoundState,
+                   QAbstractSocket::ConnectedState, -1);
+
+    return d->nativeReceiveDatagrams(data, maxSize, maxCount, sizes, headers, options);
+}
+
+/*!
+    Writes the \a count datagrams in \a data, of \a sizes bytes each, to
+    the destinations in \a headers with a single system call.
+
+    Returns the number of datagrams written, which may be less than \a
+    count if the socket's send buffer filled up, or -1 if an error occurred.
+*/
+int QNativeSocketEngine::writeDatagrams(const char * const *data, const qint64 *sizes,
+                                        const QIpPacketHeader *headers, int count)
+{
+    Q_D(QNativeSocketEngine);
+    Q_CHECK_VALID_SOCKETLAYER(QNativeSocketEngine::writeDatagrams(), -1);
+    Q_CHECK_STATES(QNativeSocketEngine::writeDatagrams(), QAbstractSocket::BoundState,
+                   QAbstractSocket::ConnectedState, -1);
+
+    return d->nativeSendDatagrams(data, sizes, headers, count);
+}
+#endif // QT_CONFIG(sendmmsg)
+
 /*!
     Writes a block of \a size bytes from \a data to the socket.
     Returns the number of bytes written, or -1 if an error occurred.
@@ -164,6 +164,12 @@ public:
     qint64 readDatagram(char *data, qint64 maxlen, QIpPacketHeader * = 0,
                         PacketHeaderOptions = WantNone) Q_DECL_OVERRIDE;
     qint64 writeDatagram(const char *data, qint64 len, const QIpPacketHeader &) Q_DECL_OVERRIDE;
+#if QT_CONFIG(sendmmsg)
+    int readDatagrams(char * const *data, qint64 maxSize, int maxCount, qint64 *sizes,
+                      QIpPacketHeader *headers, PacketHeaderOptions options = WantNone) Q_DECL_OVERRIDE;
+    int writeDatagrams(const char * const *data, const qint64 *sizes,
+                       const QIpPacketHeader *headers, int count) Q_DECL_OVERRIDE;
+#endif
     qint64 bytesToWrite() const Q_DECL_OVERRIDE;
 
     qint64 receiveBufferSize() const;
@@ -275,6 +281,12 @@ public:
     qint64 nativeReceiveDatagram(char *data, qint64 maxLength, QIpPacketHeader *header,
                                  QAbstractSocketEngine::PacketHeaderOptions options);
     qint64 nativeSendDatagram(const char *data, qint64 length, const QIpPacketHeader &header);
+#if QT_CONFIG(sendmmsg)
+    int nativeReceiveDatagrams(char * const *data, qint64 maxSize, int maxCount, qint64 *sizes,
+                               QIpPacketHeader *headers, QAbstractSocketEngine::PacketHeaderOptions options);
+    int nativeSendDatagrams(const char * const *data, const qint64 *sizes,
+                            const QIpPacketHeader *headers, int count);
+#endif
     qint64 nativeRead(char *data, qint64 maxLength);
     qint64 nativeWrite(const char *data, qint64 length);
     int nativeSelect(int timeout, bool selectForRead) const;
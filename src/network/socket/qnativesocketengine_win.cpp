@@ -216,6 +216,7 @@ static void convertToLevelAndOption(QNativeSocketEngine::SocketOption opt,
     case QNativeSocketEngine::NonBlockingSocketOption:      // WSAIoctl
     case QNativeSocketEngine::TypeOfServiceOption:          // not supported
     case QNativeSocketEngine::MaxStreamsSocketOption:
+    case QNativeSocketEngine::PortReusable:                 // no SO_REUSEPORT
         Q_UNREACHABLE();
 
     case QNativeSocketEngine::ReceiveBufferSocketOption:
@@ -457,6 +458,7 @@ int QNativeSocketEnginePrivate::option(QNativeSocketEngine::SocketOption opt) co
     }
     case QNativeSocketEngine::TypeOfServiceOption:
     case QNativeSocketEngine::MaxStreamsSocketOption:
+    case QNativeSocketEngine::PortReusable:
         return -1;
 
     default:
@@ -508,6 +510,7 @@ bool QNativeSocketEnginePrivate::setOption(QNativeSocketEngine::SocketOption opt
         }
     case QNativeSocketEngine::TypeOfServiceOption:
     case QNativeSocketEngine::MaxStreamsSocketOption:
+    case QNativeSocketEngine::PortReusable:
         return false;
 
     default:
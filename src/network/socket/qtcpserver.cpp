@@ -124,6 +124,9 @@ QTcpServerPrivate::QTcpServerPrivate()
  , socketEngine(0)
  , serverSocketError(QAbstractSocket::UnknownSocketError)
  , maxConnections(30)
+ , portSharing(false)
+ , acceptedCount(0)
+ , acceptBatches(0)
 {
 }
 
@@ -195,6 +198,9 @@ void QTcpServerPrivate::configureCreatedSocket()
 void QTcpServerPrivate::readNotification()
 {
     Q_Q(QTcpServer);
+    // Drain the listen queue: one readiness event may stand for several
+    // connections, and with port sharing every shard only sees its own.
+    bool batchCounted = false;
     for (;;) {
         if (pendingConnections.count() >= maxConnections) {
 #if defined (QTCPSERVER_DEBUG)
@@ -218,6 +224,11 @@ void QTcpServerPrivate::readNotification()
 #if defined (QTCPSERVER_DEBUG)
         qDebug("QTcpServerPrivate::_q_processIncomingConnection() accepted socket %i", descriptor);
 #endif
+        ++acceptedCount;
+        if (!batchCounted) {
+            ++acceptBatches;
+            batchCounted = true;
+        }
         q->incomingConnection(descriptor);
 
         QPointer<QTcpServer> that = q;
@@ -329,6 +340,12 @@ bool QTcpServer::listen(const QHostAddress &address, quint16 port)
 
     d->configureCreatedSocket();
 
+    if (d->portSharing && !d->socketEngine->setOption(QAbstractSocketEngine::PortReusable, 1)) {
+        d->serverSocketError = QAbstractSocket::UnsupportedSocketOperationError;
+        d->serverSocketErrorString = tr("Port sharing is not supported");
+        return false;
+    }
+
     if (!d->socketEngine->bind(addr, port)) {
         d->serverSocketError = d->socketEngine->error();
         d->serverSocketErrorString = d->socketEngine->errorString();
@@ -657,6 +674,71 @@ int QTcpServer::maxPendingConnections() const
     return d_func()->maxConnections;
 }
 
+/*!
+    \since 5.10
+
+    If \a enabled is true, the next call to listen() allows other servers
+    to bind to the same address and port, provided they enable port sharing
+    as well. This is implemented with the \c SO_REUSEPORT socket option; on
+    platforms that do not support it, listen() fails with
+    QAbstractSocket::UnsupportedSocketOperationError.
+
+    Running one server with port sharing enabled in each of several threads
+    lets the operating system distribute incoming connections between them,
+    so that accepting and handling connections scales across cores. Each
+    server only sees the connections the system assigns to it.
+
+    The setting has no effect on a server that is already listening. The
+    default is false.
+
+    \sa isPortSharingEnabled(), listen()
+*/
+void QTcpServer::setPortSharingEnabled(bool enabled)
+{
+    d_func()->portSharing = enabled;
+}
+
+/*!
+    \since 5.10
+
+    Returns \c true if port sharing is enabled; otherwise returns \c false.
+
+    \sa setPortSharingEnabled()
+*/
+bool QTcpServer::isPortSharingEnabled() const
+{
+    return d_func()->portSharing;
+}
+
+/*!
+    \since 5.10
+
+    Returns the number of connections this server has accepted since it was
+    created.
+
+    \sa acceptBatchCount()
+*/
+quint64 QTcpServer::acceptedConnectionCount() const
+{
+    return d_func()->acceptedCount;
+}
+
+/*!
+    \since 5.10
+
+    Returns the number of notifications of incoming connections that led to
+    at least one accepted connection. Every notification accepts all
+    connections that are queued at that point, so acceptedConnectionCount()
+    divided by this value is the average number of connections accepted per
+    notification.
+
+    \sa acceptedConnectionCount()
+*/
+quint64 QTcpServer::acceptBatchCount() const
+{
+    return d_func()->acceptBatches;
+}
+
 /*!
     Returns an error code for the last error that occurred.
 
@@ -69,6 +69,12 @@ public:
     void setMaxPendingConnections(int numConnections);
     int maxPendingConnections() const;
 
+    void setPortSharingEnabled(bool enabled);
+    bool isPortSharingEnabled() const;
+
+    quint64 acceptedConnectionCount() const;
+    quint64 acceptBatchCount() const;
+
     quint16 serverPort() const;
     QHostAddress serverAddress() const;
 
@@ -83,6 +83,10 @@ public:
     QString serverSocketErrorString;
 
     int maxConnections;
+    bool portSharing;
+
+    quint64 acceptedCount;
+    quint64 acceptBatches;
 
 #ifndef QT_NO_NETWORKPROXY
     QNetworkProxy proxy;
@@ -102,6 +102,8 @@
 #include "qnetworkdatagram.h"
 #include "qnetworkinterface.h"
 #include "qabstractsocket_p.h"
+#include "qvarlengtharray.h"
+#include "private/qbytearray_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -125,6 +127,11 @@ public:
 
     inline bool ensureInitialized(const QHostAddress &remoteAddress)
     { return doEnsureInitialized(QHostAddress(), 0, remoteAddress); }
+
+    // reused by receiveDatagrams() and writeDatagrams()
+    QByteArray batchBuffer;
+    QVector<qint64> batchSizes;
+    QVector<QIpPacketHeader> batchHeaders;
 };
 
 bool QUdpSocketPrivate::doEnsureInitialized(const QHostAddress &bindAddress, quint16 bindPort,
@@ -463,6 +470,141 @@ QNetworkDatagram QUdpSocket::receiveDatagram(qint64 maxSize)
     return result;
 }
 
+/*!
+    \since 5.10
+
+    Receives up to \a maxCount datagrams that are already queued on the
+    socket, each no larger than \a maxSize bytes, and returns them in the
+    order they were received. Returns an empty vector if no datagram is
+    pending or an error occurred.
+
+    Where the platform supports it, all datagrams are received with a
+    single system call (\c recvmmsg on Linux), into a buffer that the socket
+    keeps for subsequent calls. Only the bytes actually received are copied
+    into the returned datagrams. This makes this function considerably
+    cheaper than calling receiveDatagram() repeatedly when datagrams
+    arrive at a high rate.
+
+    If a datagram is larger than \a maxSize, the rest of it is lost. If \a
+    maxSize is -1 (the default), datagrams of up to 65536 bytes are received
+    in full; passing the largest size the application expects keeps the
+    buffer the socket keeps small.
+
+    \sa receiveDatagram(), writeDatagrams(), hasPendingDatagrams()
+*/
+QVector<QNetworkDatagram> QUdpSocket::receiveDatagrams(int maxCount, qint64 maxSize)
+{
+    Q_D(QUdpSocket);
+
+#if defined QUDPSOCKET_DEBUG
+    qDebug("QUdpSocket::receiveDatagrams(%d, %lld)", maxCount, maxSize);
+#endif
+    QT_CHECK_BOUND("QUdpSocket::receiveDatagrams()", QVector<QNetworkDatagram>());
+
+    QVector<QNetworkDatagram> result;
+    if (maxSize < 0)
+        maxSize = 65536;
+    if (maxSize > 0)
+        maxCount = qMin<qint64>(maxCount, MaxByteArraySize / maxSize);
+    if (maxCount <= 0)
+        return result;
+
+    // The datagrams are received into slots of the buffer kept from the
+    // previous calls, which only grows when more or larger slots are needed
+    const qint64 bufferSize = maxCount * maxSize;
+    if (d->batchBuffer.size() < bufferSize)
+        d->batchBuffer.resize(int(bufferSize));
+    QVarLengthArray<char *, 64> bufferData(maxCount);
+    for (int i = 0; i < maxCount; ++i)
+        bufferData[i] = d->batchBuffer.data() + i * maxSize;
+    d->batchSizes.resize(maxCount);
+    d->batchHeaders.resize(maxCount);
+    for (int i = 0; i < maxCount; ++i)
+        d->batchHeaders[i].clear();
+
+    int count = d->socketEngine->readDatagrams(bufferData.constData(), maxSize, maxCount,
+                                               d->batchSizes.data(), d->batchHeaders.data(),
+                                               QAbstractSocketEngine::WantAll);
+    d->hasPendingData = false;
+    d->socketEngine->setReadNotificationEnabled(true);
+    if (count == -1)
+        d->setErrorAndEmit(d->socketEngine->error(), d->socketEngine->errorString());
+    if (count <= 0)
+        return result;
+
+    result.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const QByteArray data(bufferData[i], int(qMin(d->batchSizes.at(i), maxSize)));
+        result.append(QNetworkDatagram(*new QNetworkDatagramPrivate(data, d->batchHeaders.at(i))));
+    }
+    return result;
+}
+
+/*!
+    \since 5.10
+
+    Sends \a datagrams to the destinations they carry, like calling
+    writeDatagram() for each of them, but with a single system call where
+    the platform supports it (\c sendmmsg on Linux).
+
+    Returns the number of datagrams sent, which may be less than the number
+    given if the socket's send buffer filled up, or -1 if an error
+    occurred before any datagram was sent. The bytesWritten() signal is
+    emitted once, for all datagrams that were sent.
+
+    \sa writeDatagram(), receiveDatagrams()
+*/
+int QUdpSocket::writeDatagrams(const QVector<QNetworkDatagram> &datagrams)
+{
+    Q_D(QUdpSocket);
+#if defined QUDPSOCKET_DEBUG
+    qDebug("QUdpSocket::writeDatagrams(%d datagrams)", datagrams.size());
+#endif
+    if (datagrams.isEmpty())
+        return 0;
+    // The batch may mix IPv4 and IPv6 destinations; make sure the socket
+    // can reach every kind of address in it.
+    uint checkedProtocols = 0;
+    for (const QNetworkDatagram &datagram : datagrams) {
+        const QHostAddress destination = datagram.destinationAddress();
+        const uint protocol = 1u << (destination.protocol() + 1);
+        if (checkedProtocols & protocol)
+            continue;
+        checkedProtocols |= protocol;
+        if (!d->doEnsureInitialized(QHostAddress::Any, 0, destination))
+            return -1;
+    }
+    if (state() == UnconnectedState)
+        bind();
+
+    const int count = datagrams.size();
+    QVarLengthArray<const char *, 64> data(count);
+    d->batchSizes.resize(count);
+    d->batchHeaders.resize(count);
+    for (int i = 0; i < count; ++i) {
+        const QNetworkDatagramPrivate *dd = datagrams.at(i).d;
+        data[i] = dd->data.constData();
+        d->batchSizes[i] = dd->data.size();
+        d->batchHeaders[i] = dd->header;
+    }
+
+    int sent = d->socketEngine->writeDatagrams(data.constData(), d->batchSizes.constData(),
+                                               d->batchHeaders.constData(), count);
+    d->cachedSocketDescriptor = d->socketEngine->socketDescriptor();
+
+    if (sent > 0) {
+        qint64 bytes = 0;
+        for (int i = 0; i < sent; ++i)
+            bytes += d->batchSizes.at(i);
+        emit bytesWritten(bytes);
+    } else if (sent == -2) {
+        sent = 0;
+    } else {
+        d->setErrorAndEmit(d->socketEngine->error(), d->socketEngine->errorString());
+    }
+    return sent;
+}
+
 /*!
     Receives a datagram no larger than \a maxSize bytes and stores
     it in \a data. The sender's host address and port is stored in
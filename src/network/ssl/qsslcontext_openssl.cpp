@@ -42,6 +42,7 @@
 
 #include <QtNetwork/qsslsocket.h>
 #include <QtNetwork/qssldiffiehellmanparameters.h>
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qmutex.h>
 
 #include "private/qssl_p.h"
@@ -57,6 +58,38 @@ QT_BEGIN_NAMESPACE
 extern int q_X509Callback(int ok, X509_STORE_CTX *ctx);
 extern QString getErrorsFromOpenSsl();
 
+#ifdef SSL_CTRL_SET_TLSEXT_TICKET_KEYS
+namespace {
+// Every server socket gets its own SSL_CTX, and by default OpenSSL creates a
+// random ticket key per context, so a ticket issued by one socket could not
+// be decrypted by the next. All server contexts share one key set instead,
+// which is replaced periodically to limit the exposure of a leaked key.
+struct SessionTicketKeys
+{
+    enum { KeySize = 48, RotationInterval = 12 * 60 * 60 * 1000 };
+
+    QMutex mutex;
+    QByteArray keys;
+    QElapsedTimer age;
+
+    QByteArray current()
+    {
+        QMutexLocker locker(&mutex);
+        if (keys.isEmpty() || age.hasExpired(RotationInterval)) {
+            QByteArray fresh(KeySize, Qt::Uninitialized);
+            if (q_RAND_bytes(reinterpret_cast<unsigned char *>(fresh.data()), KeySize) != 1)
+                return QByteArray(); // let OpenSSL use its per-context key
+            keys = fresh;
+            age.start();
+        }
+        return keys;
+    }
+};
+}
+
+Q_GLOBAL_STATIC(SessionTicketKeys, sessionTicketKeys)
+#endif // SSL_CTRL_SET_TLSEXT_TICKET_KEYS
+
 QSslContext::QSslContext()
     : ctx(0),
     pkey(0),
@@ -180,6 +213,18 @@ init_context:
     long options = QSslSocketBackendPrivate::setupOpenSslOptions(configuration.protocol(), configuration.d->sslOptions);
     q_SSL_CTX_set_options(sslContext->ctx, options);
 
+#ifdef SSL_CTRL_SET_TLSEXT_TICKET_KEYS
+    if (mode == QSslSocket::SslServerMode
+        && !(configuration.d->sslOptions & QSsl::SslOptionDisableSessionTickets)) {
+        QByteArray ticketKeys = sessionTicketKeys()->current();
+        if (!ticketKeys.isEmpty()
+            && !q_SSL_CTX_ctrl(sslContext->ctx, SSL_CTRL_SET_TLSEXT_TICKET_KEYS,
+                               ticketKeys.size(), ticketKeys.data())) {
+            qCWarning(lcSsl, "could not set the shared session ticket keys");
+        }
+    }
+#endif
+
 #if OPENSSL_VERSION_NUMBER >= 0x10000000L
     // Tell OpenSSL to release memory early
     // http://www.openssl.org/docs/ssl/SSL_CTX_set_mode.html
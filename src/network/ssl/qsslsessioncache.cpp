@@ -0,0 +1,294 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qsslsessioncache_p.h"
+
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_GLOBAL_STATIC(QSslSessionCache, globalSessionCache)
+
+namespace {
+// Used when the server did not announce a ticket lifetime; matches the
+// default session timeout of an OpenSSL server.
+const int DefaultSessionLifetime = 300;
+
+const quint32 FileMagic = 0x51535343; // "QSSC"
+const quint32 FileVersion = 1;
+}
+
+QSslSessionCache::QSslSessionCache()
+    : newest(nullptr),
+      oldest(nullptr),
+      maxEntries(DefaultCapacity),
+      dirty(false)
+{
+}
+
+QSslSessionCache::~QSslSessionCache()
+{
+    QMutexLocker locker(&mutex);
+    save();
+}
+
+QSslSessionCache *QSslSessionCache::instance()
+{
+    return globalSessionCache();
+}
+
+/*!
+    \internal
+
+    Returns the DER-encoded session stored under \a key, or an empty byte
+    array if there is none or it has expired.
+*/
+QByteArray QSslSessionCache::session(const QByteArray &key)
+{
+    QMutexLocker locker(&mutex);
+    const auto it = entries.find(key);
+    if (it == entries.end())
+        return QByteArray();
+    Entry *entry = &it.value();
+    if (entry->expiresAt <= QDateTime::currentMSecsSinceEpoch()) {
+        removeEntry(entry);
+        dirty = true;
+        return QByteArray();
+    }
+    unlink(entry);
+    link(entry);
+    return entry->session;
+}
+
+/*!
+    \internal
+
+    Stores the DER-encoded \a session under \a key. \a lifetimeHint is the
+    ticket lifetime announced by the server in seconds; if it is not positive
+    a conservative default is used.
+*/
+void QSslSessionCache::insert(const QByteArray &key, const QByteArray &session, int lifetimeHint)
+{
+    if (key.isEmpty() || session.isEmpty())
+        return;
+
+    const qint64 expiresAt = QDateTime::currentMSecsSinceEpoch()
+            + qint64(lifetimeHint > 0 ? lifetimeHint : DefaultSessionLifetime) * 1000;
+
+    QMutexLocker locker(&mutex);
+    store(key, session, expiresAt);
+    dirty = true;
+}
+
+void QSslSessionCache::remove(const QByteArray &key)
+{
+    QMutexLocker locker(&mutex);
+    const auto it = entries.find(key);
+    if (it != entries.end()) {
+        removeEntry(&it.value());
+        dirty = true;
+    }
+}
+
+void QSslSessionCache::clear()
+{
+    QMutexLocker locker(&mutex);
+    entries.clear();
+    newest = oldest = nullptr;
+    dirty = true;
+    save();
+}
+
+void QSslSessionCache::setCapacity(int capacity)
+{
+    QMutexLocker locker(&mutex);
+    maxEntries = qMax(0, capacity);
+    trim();
+}
+
+int QSslSessionCache::capacity() const
+{
+    QMutexLocker locker(&mutex);
+    return maxEntries;
+}
+
+/*!
+    \internal
+
+    Makes the cache persistent in \a fileName. Sessions already stored in the
+    file are merged into the cache; pending changes are flushed to the
+    previous file first. An empty \a fileName disables persistence.
+*/
+void QSslSessionCache::setFileName(const QString &fileName)
+{
+    QMutexLocker locker(&mutex);
+    if (file == fileName)
+        return;
+    save();
+    file = fileName;
+    load();
+}
+
+QString QSslSessionCache::fileName() const
+{
+    QMutexLocker locker(&mutex);
+    return file;
+}
+
+// The helpers below must be called with the mutex locked.
+
+// Stores the session as the most recently used entry and evicts the least
+// recently used ones beyond the capacity.
+void QSslSessionCache::store(const QByteArray &key, const QByteArray &session, qint64 expiresAt)
+{
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        it = entries.insert(key, Entry());
+        it->key = key;
+    } else {
+        unlink(&it.value());
+    }
+    it->session = session;
+    it->expiresAt = expiresAt;
+    link(&it.value());
+    trim();
+}
+
+void QSslSessionCache::removeEntry(Entry *entry)
+{
+    unlink(entry);
+    entries.remove(QByteArray(entry->key));
+}
+
+// QHash nodes don't move when the table grows, so the list can point into it.
+void QSslSessionCache::link(Entry *entry)
+{
+    entry->older = newest;
+    entry->newer = nullptr;
+    if (newest)
+        newest->newer = entry;
+    else
+        oldest = entry;
+    newest = entry;
+}
+
+void QSslSessionCache::unlink(Entry *entry)
+{
+    if (entry->older)
+        entry->older->newer = entry->newer;
+    else
+        oldest = entry->newer;
+    if (entry->newer)
+        entry->newer->older = entry->older;
+    else
+        newest = entry->older;
+}
+
+void QSslSessionCache::trim()
+{
+    while (entries.size() > maxEntries)
+        removeEntry(oldest);
+}
+
+void QSslSessionCache::load()
+{
+    if (file.isEmpty())
+        return;
+
+    QFile f(file);
+    if (!f.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream stream(&f);
+    stream.setVersion(QDataStream::Qt_5_6);
+    quint32 magic, version;
+    stream >> magic >> version;
+    if (magic != FileMagic || version != FileVersion)
+        return;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint32 count;
+    stream >> count;
+    for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QByteArray key, session;
+        qint64 expiresAt;
+        stream >> key >> session >> expiresAt;
+        if (stream.status() != QDataStream::Ok)
+            break;
+        if (expiresAt > now && !key.isEmpty() && !session.isEmpty() && !entries.contains(key))
+            store(key, session, expiresAt);
+    }
+}
+
+void QSslSessionCache::save()
+{
+    if (!dirty || file.isEmpty())
+        return;
+
+    QSaveFile f(file);
+    if (!f.open(QIODevice::WriteOnly))
+        return;
+    // The file contains session master secrets.
+    f.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+
+    // Written from the least to the most recently used, so that load()
+    // restores the order.
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QVector<const Entry *> live;
+    live.reserve(entries.size());
+    for (const Entry *entry = oldest; entry; entry = entry->newer) {
+        if (entry->expiresAt > now)
+            live.append(entry);
+    }
+
+    QDataStream stream(&f);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << FileMagic << FileVersion << qint32(live.size());
+    for (const Entry *entry : qAsConst(live))
+        stream << entry->key << entry->session << entry->expiresAt;
+
+    if (stream.status() == QDataStream::Ok && f.commit())
+        dirty = false;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,120 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtNetwork module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSSLSESSIONCACHE_P_H
+#define QSSLSESSIONCACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNetwork/private/qtnetworkglobal_p.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qstring.h>
+
+QT_BEGIN_NAMESPACE
+
+// Process-wide cache of client TLS sessions, keyed by peer and by the parts
+// of the configuration that must match for a session to be resumable.
+// Sessions are stored in their DER encoding so they can outlive the SSL
+// context that negotiated them and be written to disk.
+class Q_AUTOTEST_EXPORT QSslSessionCache
+{
+public:
+    enum { DefaultCapacity = 256 };
+
+    QSslSessionCache();
+    ~QSslSessionCache();
+
+    static QSslSessionCache *instance();
+
+    QByteArray session(const QByteArray &key);
+    void insert(const QByteArray &key, const QByteArray &session, int lifetimeHint);
+    void remove(const QByteArray &key);
+    void clear();
+
+    void setCapacity(int capacity);
+    int capacity() const;
+
+    void setFileName(const QString &fileName);
+    QString fileName() const;
+
+private:
+    // Entries are kept in a list ordered by last use, like in QCache; unlike
+    // QCache this lets save() walk them without touching the order.
+    struct Entry
+    {
+        QByteArray key;
+        QByteArray session;
+        qint64 expiresAt; // msecs since epoch
+        Entry *older;
+        Entry *newer;
+    };
+
+    void store(const QByteArray &key, const QByteArray &session, qint64 expiresAt);
+    void removeEntry(Entry *entry);
+    void link(Entry *entry);
+    void unlink(Entry *entry);
+    void trim();
+    void load();
+    void save();
+
+    mutable QMutex mutex;
+    QHash<QByteArray, Entry> entries;
+    Entry *newest;
+    Entry *oldest;
+    int maxEntries;
+    QString file;
+    bool dirty;
+
+    Q_DISABLE_COPY(QSslSessionCache)
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSLSESSIONCACHE_P_H
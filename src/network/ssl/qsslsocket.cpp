@@ -322,6 +322,7 @@
 #include "qsslsocket_mac_p.h"
 #endif
 #include "qsslconfiguration_p.h"
+#include "qsslsessioncache_p.h"
 
 #include <QtCore/qdebug.h>
 #include <QtCore/qdir.h>
@@ -584,6 +585,23 @@ bool QSslSocket::isEncrypted() const
     return d->connectionEncrypted;
 }
 
+/*!
+    \since 5.10
+
+    Returns \c true if the socket is encrypted and the handshake resumed a
+    previous TLS session, for example one kept in the client session cache,
+    instead of performing the full key exchange; otherwise returns \c false.
+
+    \note Resumed sessions are currently only reported by the OpenSSL backend.
+
+    \sa isEncrypted(), setSessionCacheCapacity()
+*/
+bool QSslSocket::isSessionResumed() const
+{
+    Q_D(const QSslSocket);
+    return d->connectionEncrypted && d->configuration.peerSessionShared;
+}
+
 /*!
     Returns the socket's SSL protocol. By default, \l QSsl::SecureProtocols is used.
 
@@ -1790,6 +1808,95 @@ QString QSslSocket::sslLibraryBuildVersionString()
     return QSslSocketPrivate::sslLibraryBuildVersionString();
 }
 
+/*!
+    \since 5.10
+
+    Sets the maximum number of TLS sessions kept in the process-wide client
+    session cache to \a maxSessions. Setting it to 0 disables the cache.
+
+    When a client socket completes a handshake, its session is stored in
+    this cache under the peer's host name and port, together with the
+    settings that affect whether the session may be reused (protocol, peer
+    verification mode, local certificate and CA certificates). A later
+    connection to the same peer with matching settings offers the cached
+    session to the server, which lets the server skip the full key exchange.
+    This works across QSslSocket instances, including those created by
+    QNetworkAccessManager, without any configuration. Sockets that set
+    QSsl::SslOptionDisableSessionSharing, or whose configuration already
+    carries a session (see QSslConfiguration::setSessionTicket()), do not
+    use the cache. When the cache is full, the least recently used session
+    is discarded.
+
+    The default capacity is 256 sessions.
+
+    \note The cache is currently only used by the OpenSSL backend.
+
+    \sa sessionCacheCapacity(), setSessionCacheFile(), clearSessionCache()
+*/
+void QSslSocket::setSessionCacheCapacity(int maxSessions)
+{
+    QSslSessionCache::instance()->setCapacity(maxSessions);
+}
+
+/*!
+    \since 5.10
+
+    Returns the maximum number of sessions kept in the client session cache.
+
+    \sa setSessionCacheCapacity()
+*/
+int QSslSocket::sessionCacheCapacity()
+{
+    return QSslSessionCache::instance()->capacity();
+}
+
+/*!
+    \since 5.10
+
+    Makes the client session cache persistent in \a fileName, so sessions can
+    be resumed after the application restarts. Sessions found in the file
+    are loaded immediately; the cache is written back when the file name
+    changes, when clearSessionCache() is called and when the application
+    exits. Expired sessions are not written. An empty \a fileName, the
+    default, disables persistence.
+
+    The file contains the secrets needed to resume the stored sessions, so
+    it is created readable and writable only by its owner. It should be kept
+    in a location that is private to the user.
+
+    \sa sessionCacheFile(), setSessionCacheCapacity()
+*/
+void QSslSocket::setSessionCacheFile(const QString &fileName)
+{
+    QSslSessionCache::instance()->setFileName(fileName);
+}
+
+/*!
+    \since 5.10
+
+    Returns the file the client session cache is persisted in, or an empty
+    string if persistence is disabled.
+
+    \sa setSessionCacheFile()
+*/
+QString QSslSocket::sessionCacheFile()
+{
+    return QSslSessionCache::instance()->fileName();
+}
+
+/*!
+    \since 5.10
+
+    Removes all sessions from the client session cache and from its file, if
+    one was set. Subsequent connections perform full handshakes.
+
+    \sa setSessionCacheCapacity(), setSessionCacheFile()
+*/
+void QSslSocket::clearSessionCache()
+{
+    QSslSessionCache::instance()->clear();
+}
+
 /*!
     Starts a delayed SSL handshake for a client connection. This
     function can be called when the socket is in the \l ConnectedState
@@ -2075,6 +2182,7 @@ void QSslSocketPrivate::init()
     writeBuffer.clear();
     configuration.peerCertificate.clear();
     configuration.peerCertificateChain.clear();
+    configuration.peerSessionShared = false;
 }
 
 /*!
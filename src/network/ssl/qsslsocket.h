@@ -98,6 +98,7 @@ public:
 
     SslMode mode() const;
     bool isEncrypted() const;
+    bool isSessionResumed() const;
 
     QSsl::SslProtocol protocol() const;
     void setProtocol(QSsl::SslProtocol protocol);
@@ -193,6 +194,12 @@ public:
     static long sslLibraryBuildVersionNumber();
     static QString sslLibraryBuildVersionString();
 
+    static void setSessionCacheCapacity(int maxSessions);
+    static int sessionCacheCapacity();
+    static void setSessionCacheFile(const QString &fileName);
+    static QString sessionCacheFile();
+    static void clearSessionCache();
+
     void ignoreSslErrors(const QList<QSslError> &errors);
 
 public Q_SLOTS:
@@ -66,7 +66,9 @@
 #include "qsslellipticcurve.h"
 #include "qsslpresharedkeyauthenticator.h"
 #include "qsslpresharedkeyauthenticator_p.h"
+#include "qsslsessioncache_p.h"
 
+#include <QtCore/qcryptographichash.h>
 #include <QtCore/qdatetime.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qdir.h>
@@ -368,6 +370,64 @@ long QSslSocketBackendPrivate::setupOpenSslOptions(QSsl::SslProtocol protocol, Q
     return options;
 }
 
+/*!
+    \internal
+
+    Returns the key under which this client socket's session is stored in
+    the process-wide session cache, or an empty byte array if the session
+    should not be cached. Besides the peer, the key covers every setting
+    that decides whether a resumed session would be acceptable.
+*/
+QByteArray QSslSocketBackendPrivate::clientSessionCacheKey() const
+{
+    Q_Q(const QSslSocket);
+
+    QString peer = verificationPeerName.isEmpty() ? q->peerName() : verificationPeerName;
+    if (peer.isEmpty())
+        peer = hostName;
+    if (peer.isEmpty() || !q->peerPort())
+        return QByteArray();
+
+    QByteArray key = peer.toLower().toUtf8();
+    key += ':';
+    key += QByteArray::number(q->peerPort());
+    key += '/';
+    key += QByteArray::number(int(configuration.protocol));
+    key += '/';
+    key += QByteArray::number(int(configuration.peerVerifyMode));
+    key += '/';
+    if (!configuration.localCertificateChain.isEmpty())
+        key += configuration.localCertificateChain.first().digest(QCryptographicHash::Sha1).toHex();
+    key += '/';
+    if (configuration.caCertificates != QSslConfiguration::defaultConfiguration().caCertificates()) {
+        QCryptographicHash caHash(QCryptographicHash::Sha1);
+        for (const QSslCertificate &certificate : configuration.caCertificates)
+            caHash.addData(certificate.digest(QCryptographicHash::Sha1));
+        key += caHash.result().toHex();
+    }
+    return key;
+}
+
+void QSslSocketBackendPrivate::storeSessionInCache()
+{
+    if (sessionCacheKey.isEmpty())
+        return;
+
+    SSL_SESSION *current = q_SSL_get_session(ssl);
+    if (!current)
+        return;
+
+    const int size = q_i2d_SSL_SESSION(current, 0);
+    if (size <= 0)
+        return;
+
+    QByteArray der(size, Qt::Uninitialized);
+    unsigned char *data = reinterpret_cast<unsigned char *>(der.data());
+    if (q_i2d_SSL_SESSION(current, &data) != size)
+        return;
+    QSslSessionCache::instance()->insert(sessionCacheKey, der, int(q_SSL_SESSION_get_ticket_lifetime_hint(current)));
+}
+
 bool QSslSocketBackendPrivate::initSslContext()
 {
     Q_Q(QSslSocket);
@@ -416,6 +476,27 @@ bool QSslSocketBackendPrivate::initSslContext()
         }
     }
 
+    // Offer a session from the process-wide cache, unless the configuration
+    // or a shared context already provided one.
+    sessionCacheKey.clear();
+    if (mode == QSslSocket::SslClientMode
+        && !(configuration.sslOptions & QSsl::SslOptionDisableSessionSharing)) {
+        sessionCacheKey = clientSessionCacheKey();
+        if (!sessionCacheKey.isEmpty() && !q_SSL_get_session(ssl)) {
+            const QByteArray der = QSslSessionCache::instance()->session(sessionCacheKey);
+            if (!der.isEmpty()) {
+                const unsigned char *data = reinterpret_cast<const unsigned char *>(der.constData());
+                if (SSL_SESSION *cached = q_d2i_SSL_SESSION(0, &data, der.size())) {
+                    if (!q_SSL_set_session(ssl, cached))
+                        qCWarning(lcSsl, "could not set the cached SSL session");
+                    q_SSL_SESSION_free(cached);
+                } else {
+                    QSslSessionCache::instance()->remove(sessionCacheKey);
+                }
+            }
+        }
+    }
+
     // Clear the session.
     errorList.clear();
 
@@ -1581,6 +1662,8 @@ void QSslSocketBackendPrivate::continueHandshake()
     }
 #endif
 
+    storeSessionInCache();
+
     // Cache this SSL session inside the QSslContext
     if (!(configuration.sslOptions & QSsl::SslOptionDisableSessionSharing)) {
         if (!sslContextPointer->cacheSession(ssl)) {
@@ -126,6 +126,7 @@ public:
     BIO *readBio;
     BIO *writeBio;
     SSL_SESSION *session;
+    QByteArray sessionCacheKey; // key into QSslSessionCache, client mode only
     QVector<QSslErrorEntry> errorList;
 #if OPENSSL_VERSION_NUMBER >= 0x10001000L
     static int s_indexForSSLExtraData; // index used in SSL_get_ex_data to get the matching QSslSocketBackendPrivate
@@ -143,6 +144,8 @@ public:
     void continueHandshake() Q_DECL_OVERRIDE;
     bool checkSslErrors();
     void storePeerCertificates();
+    QByteArray clientSessionCacheKey() const;
+    void storeSessionInCache();
     unsigned int tlsPskClientCallback(const char *hint, char *identity, unsigned int max_identity_len, unsigned char *psk, unsigned int max_psk_len);
     unsigned int tlsPskServerCallback(const char *identity, unsigned char *psk, unsigned int max_psk_len);
 #ifdef Q_OS_WIN
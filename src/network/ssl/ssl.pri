@@ -15,6 +15,7 @@ qtConfig(ssl) {
                ssl/qsslerror.h \
                ssl/qsslkey.h \
                ssl/qsslkey_p.h \
+               ssl/qsslsessioncache_p.h \
                ssl/qsslsocket.h \
                ssl/qsslsocket_p.h \
                ssl/qsslpresharedkeyauthenticator.h \
@@ -30,6 +31,7 @@ qtConfig(ssl) {
                ssl/qsslellipticcurve.cpp \
                ssl/qsslkey_p.cpp \
                ssl/qsslerror.cpp \
+               ssl/qsslsessioncache.cpp \
                ssl/qsslsocket.cpp \
                ssl/qsslpresharedkeyauthenticator.cpp \
                ssl/qsslcertificateextension.cpp
@@ -74,6 +74,12 @@ extern "C" {
 #endif
 }
 
+// libjpeg-turbo can skip rows and crop columns while decoding, which
+// makes reading a clip region considerably cheaper than a full decode.
+#if defined(LIBJPEG_TURBO_VERSION_NUMBER) && LIBJPEG_TURBO_VERSION_NUMBER >= 1005000
+#  define QT_JPEG_PARTIAL_DECODING
+#endif
+
 QT_BEGIN_NAMESPACE
 QT_WARNING_DISABLE_GCC("-Wclobbered")
 
@@ -305,31 +311,25 @@ static bool read_jpeg_image(QImage *outImage,
                 info->scale_num   = qBound(1, qCeil(8/f), 8);
                 info->scale_denom = 8;
             } else {
-                info->scale_denom = qMin(clipRect.width() / scaledSize.width(),
-                                         clipRect.height() / scaledSize.height());
-
-                // Only scale by powers of two when clipping so we can
-                // keep the exact pixel boundaries
-                if (info->scale_denom < 2)
-                    info->scale_denom = 1;
-                else if (info->scale_denom < 4)
-                    info->scale_denom = 2;
-                else if (info->scale_denom < 8)
-                    info->scale_denom = 4;
-                else
-                    info->scale_denom = 8;
-                info->scale_num = 1;
-
-                // Correct the scale factor so that we clip accurately.
-                // It is recommended that the clip rectangle be aligned
-                // on an 8-pixel boundary for best performance.
-                while (info->scale_denom > 1 &&
-                       ((clipRect.x() % info->scale_denom) != 0 ||
-                        (clipRect.y() % info->scale_denom) != 0 ||
-                        (clipRect.width() % info->scale_denom) != 0 ||
-                        (clipRect.height() % info->scale_denom) != 0)) {
-                    info->scale_denom /= 2;
+                // Use the smallest M/8 scale factor that still produces at
+                // least the requested size from the clip rectangle.
+                const double f = qMax(double(scaledSize.width()) / clipRect.width(),
+                                      double(scaledSize.height()) / clipRect.height());
+                int scaleNum = qBound(1, qCeil(8 * f), 8);
+
+                // Correct the scale factor so that we clip accurately:
+                // the clip rectangle must map onto whole pixels of the
+                // scaled image. It is recommended that the clip rectangle
+                // be aligned on an 8-pixel boundary for best performance.
+                while (scaleNum < 8 &&
+                       (((clipRect.x() * scaleNum) % 8) != 0 ||
+                        ((clipRect.y() * scaleNum) % 8) != 0 ||
+                        ((clipRect.width() * scaleNum) % 8) != 0 ||
+                        ((clipRect.height() * scaleNum) % 8) != 0)) {
+                    ++scaleNum;
                 }
+                info->scale_num   = scaleNum;
+                info->scale_denom = 8;
             }
         }
 
@@ -337,6 +337,7 @@ static bool read_jpeg_image(QImage *outImage,
         if( quality < HIGH_QUALITY_THRESHOLD ) {
             info->dct_method = JDCT_IFAST;
             info->do_fancy_upsampling = FALSE;
+            info->do_block_smoothing = FALSE;
         }
 
         (void) jpeg_calc_output_dimensions(info);
@@ -346,15 +347,20 @@ static bool read_jpeg_image(QImage *outImage,
         QRect clip;
         if (clipRect.isEmpty()) {
             clip = imageRect;
-        } else if (info->scale_denom == info->scale_num) {
+        } else if (info->output_width == info->image_width && info->output_height == info->image_height) {
             clip = clipRect.intersected(imageRect);
         } else {
-            // The scale factor was corrected above to ensure that
-            // we don't miss pixels when we scale the clip rectangle.
-            clip = QRect(clipRect.x() / int(info->scale_denom),
-                         clipRect.y() / int(info->scale_denom),
-                         clipRect.width() / int(info->scale_denom),
-                         clipRect.height() / int(info->scale_denom));
+            // The scale factor was corrected above to ensure that we don't
+            // miss pixels when we scale the clip rectangle. Map it through
+            // the dimensions libjpeg actually chose, since older versions
+            // only support some of the M/8 scale factors.
+            const qint64 width = info->image_width;
+            const qint64 height = info->image_height;
+            const int left = int(clipRect.left() * qint64(info->output_width) / width);
+            const int top = int(clipRect.top() * qint64(info->output_height) / height);
+            const int right = int((clipRect.right() + 1) * qint64(info->output_width) / width);
+            const int bottom = int((clipRect.bottom() + 1) * qint64(info->output_height) / height);
+            clip = QRect(left, top, right - left, bottom - top);
             clip = clip.intersected(imageRect);
         }
 
@@ -378,6 +384,23 @@ static bool read_jpeg_image(QImage *outImage,
 
             (void) jpeg_start_decompress(info);
 
+            // Offset of the clip region within the decoded rows.
+            int clipX = clip.x();
+#ifdef QT_JPEG_PARTIAL_DECODING
+            // Only decode the columns and rows covered by the clip region.
+            // libjpeg widens the cropped columns to iMCU boundaries on the
+            // left; a margin on the right keeps upsampling of the last
+            // columns identical to a full decode.
+            if (clip.width() < int(info->output_width)) {
+                JDIMENSION cropX = clip.x();
+                JDIMENSION cropWidth = qMin(clip.right() + 1 + 32, int(info->output_width)) - clip.x();
+                jpeg_crop_scanline(info, &cropX, &cropWidth);
+                clipX = clip.x() - int(cropX);
+            }
+            if (clip.y() > 0)
+                (void) jpeg_skip_scanlines(info, clip.y());
+#endif
+
             while (info->output_scanline < info->output_height) {
                 int y = int(info->output_scanline) - clip.y();
                 if (y >= clip.height())
@@ -389,12 +412,12 @@ static bool read_jpeg_image(QImage *outImage,
                     continue;   // Haven't reached the starting line yet.
 
                 if (info->output_components == 3) {
-                    uchar *in = rows[0] + clip.x() * 3;
+                    uchar *in = rows[0] + clipX * 3;
                     QRgb *out = (QRgb*)outImage->scanLine(y);
                     converter(out, in, clip.width());
                 } else if (info->out_color_space == JCS_CMYK) {
                     // Convert CMYK->RGB.
-                    uchar *in = rows[0] + clip.x() * 4;
+                    uchar *in = rows[0] + clipX * 4;
                     QRgb *out = (QRgb*)outImage->scanLine(y);
                     for (int i = 0; i < clip.width(); ++i) {
                         int k = in[3];
@@ -405,7 +428,7 @@ static bool read_jpeg_image(QImage *outImage,
                 } else if (info->output_components == 1) {
                     // Grayscale.
                     memcpy(outImage->scanLine(y),
-                           rows[0] + clip.x(), clip.width());
+                           rows[0] + clipX, clip.width());
                 }
             }
         } else {
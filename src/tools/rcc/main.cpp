@@ -127,6 +127,9 @@ int runRcc(int argc, char *argv[])
     QCommandLineOption rootOption(QStringLiteral("root"), QStringLiteral("Prefix resource access path with root path."), QStringLiteral("path"));
     parser.addOption(rootOption);
 
+    QCommandLineOption compressionAlgoOption(QStringLiteral("compress-algo"), QStringLiteral("Compress input files using algorithm <algo> (zlib, zstd or none)."), QStringLiteral("algo"));
+    parser.addOption(compressionAlgoOption);
+
     QCommandLineOption compressOption(QStringLiteral("compress"), QStringLiteral("Compress input files by <level>."), QStringLiteral("level"));
     parser.addOption(compressOption);
 
@@ -171,7 +174,7 @@ int runRcc(int argc, char *argv[])
         formatVersion = parser.value(formatVersionOption).toUInt(&ok);
         if (!ok) {
             errorMsg = QLatin1String("Invalid format version specified");
-        } else if (formatVersion != 1 && formatVersion != 2) {
+        } else if (formatVersion < 1 || formatVersion > 3) {
             errorMsg = QLatin1String("Unsupported format version specified");
         }
     }
@@ -185,6 +188,10 @@ int runRcc(int argc, char *argv[])
                 || library.resourceRoot().at(0) != QLatin1Char('/'))
             errorMsg = QLatin1String("Root must start with a /");
     }
+    if (parser.isSet(compressionAlgoOption)) {
+        const QString algo = parser.value(compressionAlgoOption);
+        library.setCompressionAlgorithm(RCCResourceLibrary::parseCompressionAlgorithm(QStringRef(&algo), &errorMsg));
+    }
     if (parser.isSet(compressOption))
         library.setCompressLevel(parser.value(compressOption).toInt());
     if (parser.isSet(nocompressOption))
@@ -41,6 +41,10 @@
 
 #include <algorithm>
 
+#if QT_CONFIG(zstd)
+#  include <zstd.h>
+#endif
+
 // Note: A copy of this file is used in Qt Designer (qttools/src/designer/src/lib/shared/rcc.cpp)
 
 QT_BEGIN_NAMESPACE
@@ -48,6 +52,7 @@ QT_BEGIN_NAMESPACE
 enum {
     CONSTANT_USENAMESPACE = 1,
     CONSTANT_COMPRESSLEVEL_DEFAULT = -1,
+    CONSTANT_ZSTDCOMPRESSLEVEL_DEFAULT = 14,
     CONSTANT_COMPRESSTHRESHOLD_DEFAULT = 70
 };
 
@@ -89,14 +94,17 @@ public:
     enum Flags
     {
         NoFlags = 0x00,
+        // must match qresource.cpp
         Compressed = 0x01,
-        Directory = 0x02
+        Directory = 0x02,
+        CompressedZstd = 0x04
     };
 
     RCCFileInfo(const QString &name = QString(), const QFileInfo &fileInfo = QFileInfo(),
                 QLocale::Language language = QLocale::C,
                 QLocale::Country country = QLocale::AnyCountry,
                 uint flags = NoFlags,
+                RCCResourceLibrary::CompressionAlgorithm compressAlgo = RCCResourceLibrary::ZlibCompression,
                 int compressLevel = CONSTANT_COMPRESSLEVEL_DEFAULT,
                 int compressThreshold = CONSTANT_COMPRESSTHRESHOLD_DEFAULT);
     ~RCCFileInfo();
@@ -115,6 +123,7 @@ public:
     QFileInfo m_fileInfo;
     RCCFileInfo *m_parent;
     QHash<QString, RCCFileInfo*> m_children;
+    RCCResourceLibrary::CompressionAlgorithm m_compressAlgo;
     int m_compressLevel;
     int m_compressThreshold;
 
@@ -125,7 +134,7 @@ public:
 
 RCCFileInfo::RCCFileInfo(const QString &name, const QFileInfo &fileInfo,
     QLocale::Language language, QLocale::Country country, uint flags,
-    int compressLevel, int compressThreshold)
+    RCCResourceLibrary::CompressionAlgorithm compressAlgo, int compressLevel, int compressThreshold)
 {
     m_name = name;
     m_fileInfo = fileInfo;
@@ -136,6 +145,7 @@ RCCFileInfo::RCCFileInfo(const QString &name, const QFileInfo &fileInfo,
     m_nameOffset = 0;
     m_dataOffset = 0;
     m_childOffset = 0;
+    m_compressAlgo = compressAlgo;
     m_compressLevel = compressLevel;
     m_compressThreshold = compressThreshold;
 }
@@ -232,19 +242,49 @@ qint64 RCCFileInfo::writeDataBlob(RCCResourceLibrary &lib, qint64 offset,
     }
     QByteArray data = file.readAll();
 
-#ifndef QT_NO_COMPRESS
     // Check if compression is useful for this file
     if (m_compressLevel != 0 && data.size() != 0) {
-        QByteArray compressed =
-            qCompress(reinterpret_cast<uchar *>(data.data()), data.size(), m_compressLevel);
+        QByteArray compressed;
+        int flag = NoFlags;
+        switch (m_compressAlgo) {
+        case RCCResourceLibrary::NoCompression:
+            break;
+        case RCCResourceLibrary::ZlibCompression:
+#ifndef QT_NO_COMPRESS
+            compressed = qCompress(reinterpret_cast<uchar *>(data.data()), data.size(),
+                                   m_compressLevel);
+            flag = Compressed;
+#endif
+            break;
+        case RCCResourceLibrary::ZstdCompression:
+#if QT_CONFIG(zstd)
+        {
+            const int level = m_compressLevel < 0 ? int(CONSTANT_ZSTDCOMPRESSLEVEL_DEFAULT)
+                                                  : qMin(m_compressLevel, ZSTD_maxCLevel());
+            compressed.resize(int(ZSTD_compressBound(data.size())));
+            const size_t size = ZSTD_compress(compressed.data(), compressed.size(),
+                                              data.constData(), data.size(), level);
+            if (ZSTD_isError(size)) {
+                compressed.clear();
+            } else {
+                compressed.truncate(int(size));
+                flag = CompressedZstd;
+                // Zstandard compressed payloads need a newer QResource to be read
+                lib.m_formatVersion = qMax<quint8>(lib.m_formatVersion, 3);
+            }
+        }
+#endif
+            break;
+        }
 
-        int compressRatio = int(100.0 * (data.size() - compressed.size()) / data.size());
-        if (compressRatio >= m_compressThreshold) {
-            data = compressed;
-            m_flags |= Compressed;
+        if (flag != NoFlags) {
+            int compressRatio = int(100.0 * (data.size() - compressed.size()) / data.size());
+            if (compressRatio >= m_compressThreshold) {
+                data = compressed;
+                m_flags |= flag;
+            }
         }
     }
-#endif // QT_NO_COMPRESS
 
     // some info
     if (text || pass1) {
@@ -339,7 +379,8 @@ RCCResourceLibrary::Strings::Strings() :
    ATTRIBUTE_PREFIX(QLatin1String("prefix")),
    ATTRIBUTE_ALIAS(QLatin1String("alias")),
    ATTRIBUTE_THRESHOLD(QLatin1String("threshold")),
-   ATTRIBUTE_COMPRESS(QLatin1String("compress"))
+   ATTRIBUTE_COMPRESS(QLatin1String("compress")),
+   ATTRIBUTE_COMPRESSALGO(QLatin1String("compression-algorithm"))
 {
 }
 
@@ -347,6 +388,7 @@ RCCResourceLibrary::RCCResourceLibrary(quint8 formatVersion)
   : m_root(0),
     m_format(C_Code),
     m_verbose(false),
+    m_compressionAlgo(ZlibCompression),
     m_compressLevel(CONSTANT_COMPRESSLEVEL_DEFAULT),
     m_compressThreshold(CONSTANT_COMPRESSTHRESHOLD_DEFAULT),
     m_treeOffset(0),
@@ -365,6 +407,26 @@ RCCResourceLibrary::~RCCResourceLibrary()
     delete m_root;
 }
 
+RCCResourceLibrary::CompressionAlgorithm
+RCCResourceLibrary::parseCompressionAlgorithm(QStringRef value, QString *errorMsg)
+{
+    if (value == QLatin1String("zlib"))
+        return ZlibCompression;
+    if (value == QLatin1String("none"))
+        return NoCompression;
+    if (value == QLatin1String("zstd")) {
+#if QT_CONFIG(zstd)
+        return ZstdCompression;
+#else
+        *errorMsg = QLatin1String("Zstandard support not compiled in");
+        return ZlibCompression;
+#endif
+    }
+
+    *errorMsg = QString::fromLatin1("Unknown compression algorithm '%1'").arg(value.toString());
+    return ZlibCompression;
+}
+
 enum RCCXmlTag {
     RccTag,
     ResourceTag,
@@ -387,6 +449,7 @@ bool RCCResourceLibrary::interpretResourceFile(QIODevice *inputDevice,
     QLocale::Language language = QLocale::c().language();
     QLocale::Country country = QLocale::c().country();
     QString alias;
+    CompressionAlgorithm compressAlgo = m_compressionAlgo;
     int compressLevel = m_compressLevel;
     int compressThreshold = m_compressThreshold;
 
@@ -440,6 +503,14 @@ bool RCCResourceLibrary::interpretResourceFile(QIODevice *inputDevice,
                     if (attributes.hasAttribute(m_strings.ATTRIBUTE_ALIAS))
                         alias = attributes.value(m_strings.ATTRIBUTE_ALIAS).toString();
 
+                    compressAlgo = m_compressionAlgo;
+                    if (attributes.hasAttribute(m_strings.ATTRIBUTE_COMPRESSALGO)) {
+                        QString errorString;
+                        compressAlgo = parseCompressionAlgorithm(attributes.value(m_strings.ATTRIBUTE_COMPRESSALGO), &errorString);
+                        if (!errorString.isEmpty())
+                            reader.raiseError(errorString);
+                    }
+
                     compressLevel = m_compressLevel;
                     if (attributes.hasAttribute(m_strings.ATTRIBUTE_COMPRESS))
                         compressLevel = attributes.value(m_strings.ATTRIBUTE_COMPRESS).toString().toInt();
@@ -517,6 +588,7 @@ bool RCCResourceLibrary::interpretResourceFile(QIODevice *inputDevice,
                                             language,
                                             country,
                                             RCCFileInfo::NoFlags,
+                                            compressAlgo,
                                             compressLevel,
                                             compressThreshold)
                                 );
@@ -546,6 +618,7 @@ bool RCCResourceLibrary::interpretResourceFile(QIODevice *inputDevice,
                                                     language,
                                                     country,
                                                     child.isDir() ? RCCFileInfo::Directory : RCCFileInfo::NoFlags,
+                                                    compressAlgo,
                                                     compressLevel,
                                                     compressThreshold)
                                         );
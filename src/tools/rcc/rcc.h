@@ -77,6 +77,11 @@ public:
     void setOutputName(const QString &name) { m_outputName = name; }
     QString outputName() const { return m_outputName; }
 
+    enum CompressionAlgorithm { ZlibCompression, ZstdCompression, NoCompression };
+    static CompressionAlgorithm parseCompressionAlgorithm(QStringRef algo, QString *errorMsg);
+    void setCompressionAlgorithm(CompressionAlgorithm algo) { m_compressionAlgo = algo; }
+    CompressionAlgorithm compressionAlgorithm() const { return m_compressionAlgo; }
+
     void setCompressLevel(int c) { m_compressLevel = c; }
     int compressLevel() const { return m_compressLevel; }
 
@@ -104,6 +109,7 @@ private:
         const QString ATTRIBUTE_ALIAS;
         const QString ATTRIBUTE_THRESHOLD;
         const QString ATTRIBUTE_COMPRESS;
+        const QString ATTRIBUTE_COMPRESSALGO;
     };
     friend class RCCFileInfo;
     void reset();
@@ -133,6 +139,7 @@ private:
     QString m_outputName;
     Format m_format;
     bool m_verbose;
+    CompressionAlgorithm m_compressionAlgo;
     int m_compressLevel;
     int m_compressThreshold;
     int m_treeOffset;
@@ -4,6 +4,12 @@ CONFIG += force_bootstrap
 DEFINES += QT_RCC QT_NO_CAST_FROM_ASCII QT_NO_FOREACH
 
 include(rcc.pri)
+
+qtConfig(zstd) {
+    QMAKE_USE_PRIVATE += zstd
+    DEFINES += QT_FEATURE_zstd=1
+}
+
 SOURCES += main.cpp
 
 load(qt_tool)
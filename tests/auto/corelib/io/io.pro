@@ -22,6 +22,7 @@ SUBDIRS=\
     qnodebug \
     qprocess \
     qprocess-noapplication \
+    qprocesspool \
     qprocessenvironment \
     qresourceengine \
     qsettings \
@@ -70,7 +71,8 @@ win32:!qtConfig(private_tests): SUBDIRS -= \
 
 !qtConfig(process): SUBDIRS -= \
     qprocess \
-    qprocess-noapplication
+    qprocess-noapplication \
+    qprocesspool
 
 winrt: SUBDIRS -= \
     qstorageinfo \
@@ -75,6 +75,9 @@ private slots:
 
     void watchUnicodeCharacters();
 
+    void addPathRecursively();
+    void batchedSignals();
+
 private:
     QString m_tempDirPattern;
 #endif // QT_NO_FILESYSTEMWATCHER
@@ -773,6 +776,86 @@ void tst_QFileSystemWatcher::watchUnicodeCharacters()
     QVERIFY(testDir.mkdir("creme"));
     QTRY_COMPARE(changedSpy.count(), 1);
 }
+
+void tst_QFileSystemWatcher::addPathRecursively()
+{
+    QTemporaryDir temporaryDirectory(m_tempDirPattern);
+    QVERIFY2(temporaryDirectory.isValid(), qPrintable(temporaryDirectory.errorString()));
+
+    QDir testDir(temporaryDirectory.path());
+    QVERIFY(testDir.mkpath("a/b/c"));
+    QVERIFY(testDir.mkpath("d"));
+
+    QFileSystemWatcher watcher;
+    QVERIFY(watcher.addPathRecursively(testDir.path()));
+    QStringList expected;
+    expected << testDir.path() << testDir.filePath("a") << testDir.filePath("a/b")
+             << testDir.filePath("a/b/c") << testDir.filePath("d");
+    expected.sort();
+    QStringList watched = watcher.directories();
+    watched.sort();
+    QCOMPARE(watched, expected);
+
+    // directories created in the tree later on are picked up as well
+    QSignalSpy changedSpy(&watcher, &QFileSystemWatcher::directoryChanged);
+    QVERIFY(testDir.mkpath("a/b/c/new/deeper"));
+    QTRY_VERIFY(watcher.directories().contains(testDir.filePath("a/b/c/new/deeper")));
+    QVERIFY(watcher.directories().contains(testDir.filePath("a/b/c/new")));
+
+    changedSpy.clear();
+    QFile file(testDir.filePath("a/b/c/new/deeper/file.txt"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.close();
+    QTRY_VERIFY(changedSpy.count() > 0);
+    QCOMPARE(changedSpy.last().at(0).toString(), testDir.filePath("a/b/c/new/deeper"));
+
+    // removing the root stops watching the whole tree
+    QVERIFY(watcher.removePath(testDir.path()));
+    QVERIFY(watcher.directories().isEmpty());
+}
+
+void tst_QFileSystemWatcher::batchedSignals()
+{
+    QTemporaryDir temporaryDirectory(m_tempDirPattern);
+    QVERIFY2(temporaryDirectory.isValid(), qPrintable(temporaryDirectory.errorString()));
+
+    QDir testDir(temporaryDirectory.path());
+    QVERIFY(testDir.mkdir("one"));
+    QVERIFY(testDir.mkdir("two"));
+
+    QFileSystemWatcher watcher;
+    watcher.setDebounceInterval(500);
+    QCOMPARE(watcher.debounceInterval(), 500);
+    QVERIFY(watcher.addPath(testDir.filePath("one")));
+    QVERIFY(watcher.addPath(testDir.filePath("two")));
+
+    QSignalSpy batchSpy(&watcher, &QFileSystemWatcher::directoriesChanged);
+    QVERIFY(batchSpy.isValid());
+
+    for (int i = 0; i < 10; ++i) {
+        QFile one(testDir.filePath(QString::fromLatin1("one/file%1").arg(i)));
+        QVERIFY(one.open(QIODevice::WriteOnly));
+        QFile two(testDir.filePath(QString::fromLatin1("two/file%1").arg(i)));
+        QVERIFY(two.open(QIODevice::WriteOnly));
+    }
+
+    const auto reportedPaths = [&batchSpy]() {
+        QSet<QString> reported;
+        for (const QList<QVariant> &batch : qAsConst(batchSpy))
+            reported += batch.at(0).toStringList().toSet();
+        return reported;
+    };
+    QTRY_COMPARE(reportedPaths().size(), 2);
+    QVERIFY(reportedPaths().contains(testDir.filePath("one")));
+    QVERIFY(reportedPaths().contains(testDir.filePath("two")));
+
+    // twenty changes, but every path is reported at most once per batch
+    QVERIFY(batchSpy.count() < 20);
+    for (const QList<QVariant> &batch : qAsConst(batchSpy)) {
+        const QStringList paths = batch.at(0).toStringList();
+        QCOMPARE(paths.toSet().size(), paths.size());
+    }
+}
 #endif // QT_NO_FILESYSTEMWATCHER
 
 QTEST_MAIN(tst_QFileSystemWatcher)
@@ -0,0 +1,6 @@
+TEMPLATE = subdirs
+
+SUBDIRS = testFramedEcho
+
+test.depends += $$SUBDIRS
+SUBDIRS += test
@@ -0,0 +1,61 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Reads length-prefixed request frames from stdin and answers each one
+// with the same payload. "crash" aborts, "exit" terminates silently.
+
+static bool readFully(char *data, size_t size)
+{
+    return fread(data, 1, size, stdin) == size;
+}
+
+int main()
+{
+    unsigned char header[4];
+    while (readFully(reinterpret_cast<char *>(header), sizeof(header))) {
+        const size_t size = (size_t(header[0]) << 24) | (size_t(header[1]) << 16)
+                | (size_t(header[2]) << 8) | size_t(header[3]);
+        char *payload = static_cast<char *>(malloc(size + 1));
+        if (!payload || !readFully(payload, size))
+            return 1;
+        payload[size] = '\0';
+        if (strcmp(payload, "crash") == 0)
+            abort();
+        if (strcmp(payload, "exit") == 0)
+            return 0;
+        fwrite(header, 1, sizeof(header), stdout);
+        fwrite(payload, 1, size, stdout);
+        fflush(stdout);
+        free(payload);
+    }
+    return 0;
+}
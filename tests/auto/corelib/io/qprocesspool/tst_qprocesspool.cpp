@@ -0,0 +1,287 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtCore/QProcessPool>
+#include <QtCore/QDir>
+#include <QtCore/QHash>
+
+class tst_QProcessPool : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void initTestCase();
+
+private slots:
+    void getSetCheck();
+    void submitAndReply();
+    void concurrencyLimit();
+    void pipelining();
+    void prestart();
+    void idleSignal();
+    void crashingWorker();
+    void exitingWorker();
+    void missingProgram();
+    void shutdown();
+    void shutdownFromSlot();
+
+private:
+    void setupPool(QProcessPool &pool);
+};
+
+typedef QHash<qint64, QByteArray> Replies;
+
+void tst_QProcessPool::initTestCase()
+{
+    // QSignalSpy needs it before QProcess gets to register it
+    qRegisterMetaType<QProcess::ProcessError>();
+
+    // chdir to our testdata path and execute helper apps relative to that.
+    QString testdata_dir = QFileInfo(QFINDTESTDATA("testFramedEcho")).absolutePath();
+    QVERIFY2(QDir::setCurrent(testdata_dir), qPrintable("Could not chdir to " + testdata_dir));
+}
+
+void tst_QProcessPool::setupPool(QProcessPool &pool)
+{
+    pool.setProgram(QStringLiteral("testFramedEcho/testFramedEcho"));
+}
+
+void tst_QProcessPool::getSetCheck()
+{
+    QProcessPool pool;
+    QVERIFY(pool.maxWorkerCount() >= 1);
+    QCOMPARE(pool.pipelineDepth(), 1);
+    QCOMPARE(pool.workerCount(), 0);
+    QCOMPARE(pool.activeRequestCount(), 0);
+    QCOMPARE(pool.pendingRequestCount(), 0);
+
+    pool.setMaxWorkerCount(3);
+    QCOMPARE(pool.maxWorkerCount(), 3);
+    pool.setMaxWorkerCount(0);
+    QCOMPARE(pool.maxWorkerCount(), 1);
+    pool.setPipelineDepth(4);
+    QCOMPARE(pool.pipelineDepth(), 4);
+    pool.setPipelineDepth(-1);
+    QCOMPARE(pool.pipelineDepth(), 1);
+
+    pool.setProgram(QStringLiteral("foo"));
+    QCOMPARE(pool.program(), QStringLiteral("foo"));
+    pool.setArguments(QStringList() << QStringLiteral("bar"));
+    QCOMPARE(pool.arguments(), QStringList() << QStringLiteral("bar"));
+    pool.setWorkingDirectory(QStringLiteral("/"));
+    QCOMPARE(pool.workingDirectory(), QStringLiteral("/"));
+
+    QProcessPool unset;
+    QTest::ignoreMessage(QtWarningMsg, "QProcessPool::submit: No program set");
+    QCOMPARE(unset.submit("x"), qint64(-1));
+}
+
+void tst_QProcessPool::submitAndReply()
+{
+    QProcessPool pool;
+    setupPool(pool);
+    pool.setMaxWorkerCount(4);
+
+    Replies replies;
+    connect(&pool, &QProcessPool::replyReady, [&replies](qint64 id, const QByteArray &reply) {
+        replies.insert(id, reply);
+    });
+    QSignalSpy failedSpy(&pool, &QProcessPool::requestFailed);
+
+    Replies expected;
+    for (int i = 0; i < 100; ++i) {
+        const QByteArray payload = "request " + QByteArray::number(i) + QByteArray(i, 'x');
+        expected.insert(pool.submit(payload), payload);
+    }
+    expected.insert(pool.submit(QByteArray()), QByteArray());
+
+    QVERIFY(pool.waitForDone(30000));
+    QCOMPARE(failedSpy.count(), 0);
+    QCOMPARE(replies, expected);
+    QCOMPARE(pool.activeRequestCount(), 0);
+    QCOMPARE(pool.pendingRequestCount(), 0);
+}
+
+void tst_QProcessPool::concurrencyLimit()
+{
+    QProcessPool pool;
+    setupPool(pool);
+    pool.setMaxWorkerCount(2);
+
+    int maxWorkers = 0;
+    connect(&pool, &QProcessPool::replyReady, [&pool, &maxWorkers]() {
+        maxWorkers = qMax(maxWorkers, pool.workerCount());
+    });
+    for (int i = 0; i < 20; ++i)
+        pool.submit(QByteArray::number(i));
+    QCOMPARE(pool.workerCount(), 2);
+    QCOMPARE(pool.activeRequestCount(), 2);
+    QCOMPARE(pool.pendingRequestCount(), 18);
+
+    QVERIFY(pool.waitForDone(30000));
+    QCOMPARE(maxWorkers, 2);
+    QCOMPARE(pool.workerCount(), 2);
+}
+
+void tst_QProcessPool::pipelining()
+{
+    QProcessPool pool;
+    setupPool(pool);
+    pool.setMaxWorkerCount(1);
+    pool.setPipelineDepth(4);
+
+    QSignalSpy replySpy(&pool, &QProcessPool::replyReady);
+    for (int i = 0; i < 10; ++i)
+        pool.submit(QByteArray::number(i));
+    QCOMPARE(pool.workerCount(), 1);
+    QCOMPARE(pool.activeRequestCount(), 4);
+    QCOMPARE(pool.pendingRequestCount(), 6);
+
+    QVERIFY(pool.waitForDone(30000));
+    QCOMPARE(replySpy.count(), 10);
+    // a single worker answers in submission order
+    for (int i = 0; i < 10; ++i) {
+        QCOMPARE(replySpy.at(i).at(0).toLongLong(), qint64(i));
+        QCOMPARE(replySpy.at(i).at(1).toByteArray(), QByteArray::number(i));
+    }
+}
+
+void tst_QProcessPool::prestart()
+{
+    QProcessPool pool;
+    setupPool(pool);
+    pool.setMaxWorkerCount(3);
+    pool.prestart(2);
+    QCOMPARE(pool.workerCount(), 2);
+    pool.prestart();
+    QCOMPARE(pool.workerCount(), 3);
+
+    pool.submit("hello");
+    QCOMPARE(pool.workerCount(), 3);
+    QVERIFY(pool.waitForDone(30000));
+}
+
+void tst_QProcessPool::idleSignal()
+{
+    QProcessPool pool;
+    setupPool(pool);
+    QSignalSpy replySpy(&pool, &QProcessPool::replyReady);
+    QSignalSpy idleSpy(&pool, &QProcessPool::idle);
+
+    for (int i = 0; i < 5; ++i)
+        pool.submit(QByteArray::number(i));
+    QTRY_COMPARE(idleSpy.count(), 1);
+    QCOMPARE(replySpy.count(), 5);
+}
+
+void tst_QProcessPool::crashingWorker()
+{
+    QProcessPool pool;
+    setupPool(pool);
+    pool.setMaxWorkerCount(1);
+    QSignalSpy replySpy(&pool, &QProcessPool::replyReady);
+    QSignalSpy failedSpy(&pool, &QProcessPool::requestFailed);
+
+    const qint64 crash = pool.submit("crash");
+    pool.submit("after");
+    QVERIFY(pool.waitForDone(30000));
+
+    QCOMPARE(failedSpy.count(), 1);
+    QCOMPARE(failedSpy.at(0).at(0).toLongLong(), crash);
+    QCOMPARE(qvariant_cast<QProcess::ProcessError>(failedSpy.at(0).at(1)), QProcess::Crashed);
+    QCOMPARE(replySpy.count(), 1);
+    QCOMPARE(replySpy.at(0).at(1).toByteArray(), QByteArray("after"));
+}
+
+void tst_QProcessPool::exitingWorker()
+{
+    QProcessPool pool;
+    setupPool(pool);
+    pool.setMaxWorkerCount(1);
+    QSignalSpy failedSpy(&pool, &QProcessPool::requestFailed);
+
+    pool.submit("exit");
+    QVERIFY(pool.waitForDone(30000));
+    QCOMPARE(failedSpy.count(), 1);
+    QCOMPARE(qvariant_cast<QProcess::ProcessError>(failedSpy.at(0).at(1)), QProcess::UnknownError);
+    QCOMPARE(pool.workerCount(), 0);
+}
+
+void tst_QProcessPool::missingProgram()
+{
+    QProcessPool pool;
+    pool.setProgram(QStringLiteral("this-file-does-not-exist"));
+    QSignalSpy failedSpy(&pool, &QProcessPool::requestFailed);
+
+    for (int i = 0; i < 3; ++i)
+        pool.submit(QByteArray::number(i));
+    QTRY_COMPARE(failedSpy.count(), 3);
+    for (const QList<QVariant> &args : qAsConst(failedSpy))
+        QCOMPARE(qvariant_cast<QProcess::ProcessError>(args.at(1)), QProcess::FailedToStart);
+    QCOMPARE(pool.activeRequestCount(), 0);
+    QCOMPARE(pool.pendingRequestCount(), 0);
+}
+
+void tst_QProcessPool::shutdown()
+{
+    QProcessPool pool;
+    setupPool(pool);
+    pool.setMaxWorkerCount(1);
+    QSignalSpy failedSpy(&pool, &QProcessPool::requestFailed);
+
+    for (int i = 0; i < 4; ++i)
+        pool.submit(QByteArray::number(i));
+    pool.shutdown();
+    QCOMPARE(failedSpy.count(), 4);
+    QCOMPARE(qvariant_cast<QProcess::ProcessError>(failedSpy.at(0).at(1)), QProcess::Timedout);
+    QCOMPARE(pool.workerCount(), 0);
+    QCOMPARE(pool.activeRequestCount(), 0);
+}
+
+void tst_QProcessPool::shutdownFromSlot()
+{
+    QProcessPool pool;
+    setupPool(pool);
+    pool.setMaxWorkerCount(2);
+    pool.setPipelineDepth(2);
+    QSignalSpy replySpy(&pool, &QProcessPool::replyReady);
+    QSignalSpy failedSpy(&pool, &QProcessPool::requestFailed);
+    connect(&pool, &QProcessPool::replyReady, &pool, [&pool]() { pool.shutdown(); });
+
+    for (int i = 0; i < 6; ++i)
+        pool.submit(QByteArray::number(i));
+    QVERIFY(pool.waitForDone(30000));
+    QVERIFY(replySpy.count() >= 1);
+    QCOMPARE(replySpy.count() + failedSpy.count(), 6);
+    QCOMPARE(pool.workerCount(), 0);
+    QCOMPARE(pool.activeRequestCount(), 0);
+}
+
+QTEST_MAIN(tst_QProcessPool)
+#include "tst_qprocesspool.moc"
@@ -1,9 +1,10 @@
 CONFIG += testcase
 TARGET = tst_qresourceengine
 
-QT = core testlib
+QT = core-private testlib
 SOURCES = tst_qresourceengine.cpp
 RESOURCES += testqrc/test.qrc
+qtConfig(zstd): RESOURCES += testqrc/zstd.qrc
 
 qtPrepareTool(QMAKE_RCC, rcc, _DEP)
 runtime_resource.target = runtime_resource.rcc
@@ -29,6 +29,7 @@
 
 #include <QtTest/QtTest>
 #include <QtCore/QCoreApplication>
+#include <QtCore/private/qglobal_p.h>
 
 class tst_QResourceEngine: public QObject
 {
@@ -56,6 +57,7 @@ private slots:
     void doubleSlashInRoot();
     void setLocale();
     void lastModified();
+    void zstdCompressed();
 
 private:
     const QString m_runtimeResourceRcc;
@@ -477,6 +479,7 @@ void tst_QResourceEngine::setLocale()
     QResource resource;
     resource.setFileName("aliasdir/aliasdir.txt");
     QVERIFY(!resource.isCompressed());
+    QCOMPARE(resource.compressionAlgorithm(), QResource::NoCompression);
 
     // change the default locale and make sure it doesn't affect the resource
     QLocale::setDefault(QLocale("de_CH"));
@@ -485,6 +488,7 @@ void tst_QResourceEngine::setLocale()
     // then explicitly set the locale on qresource
     resource.setLocale(QLocale("de_CH"));
     QVERIFY(resource.isCompressed());
+    QCOMPARE(resource.compressionAlgorithm(), QResource::ZlibCompression);
 
     // the reset the default locale back
     QLocale::setDefault(QLocale::system());
@@ -504,7 +508,31 @@ void tst_QResourceEngine::lastModified()
     }
 }
 
+void tst_QResourceEngine::zstdCompressed()
+{
+#if QT_CONFIG(zstd)
+    QFile original(QFINDTESTDATA("testqrc/aliasdir/compressme.txt"));
+    QVERIFY(original.open(QIODevice::ReadOnly));
+    const QByteArray expected = original.readAll();
+
+    QResource resource(":/zstd/compressme.txt");
+    QVERIFY(resource.isValid());
+    QVERIFY(resource.isCompressed());
+    QCOMPARE(resource.compressionAlgorithm(), QResource::ZstdCompression);
+    QVERIFY(resource.size() < expected.size());
+
+    QFile file(":/zstd/compressme.txt");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.size(), qint64(expected.size()));
+    QCOMPARE(file.readAll(), expected);
+
+    QVERIFY(file.seek(expected.size() / 2));
+    QCOMPARE(file.read(64), expected.mid(expected.size() / 2, 64));
+#else
+    QSKIP("Zstandard support is not enabled");
+#endif
+}
+
 QTEST_MAIN(tst_QResourceEngine)
 
 #include "tst_qresourceengine.moc"
-
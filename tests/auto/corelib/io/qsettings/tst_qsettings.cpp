@@ -147,6 +147,9 @@ private slots:
     void setPath();
     void setDefaultFormat();
     void dontCreateNeedlessPaths();
+#if !defined(QT_QSETTINGS_ALWAYS_CASE_SENSITIVE_AND_FORGET_ORIGINAL_KEY_ORDER)
+    void preserveUnmodifiedIniSections();
+#endif
 #if !defined(Q_OS_WIN) && !defined(QT_QSETTINGS_ALWAYS_CASE_SENSITIVE_AND_FORGET_ORIGINAL_KEY_ORDER)
     void dontReorderIniKeysNeedlessly();
 #endif
@@ -3401,6 +3404,45 @@ void tst_QSettings::dontCreateNeedlessPaths()
     QVERIFY(!fileInfo.dir().exists());
 }
 
+#if !defined(QT_QSETTINGS_ALWAYS_CASE_SENSITIVE_AND_FORGET_ORIGINAL_KEY_ORDER)
+void tst_QSettings::preserveUnmodifiedIniSections()
+{
+    // Sections that were not touched are written back as they were read.
+    const QByteArray untouched = "; keep this comment\nfoo = bar\nlist = a, b\n";
+
+    QTemporaryFile outFile;
+    QVERIFY2(outFile.open(), qPrintable(outFile.errorString()));
+    outFile.write("[First]\n" + untouched + "\n[Second]\nkey=1\n\n\n[Third]\n; only a comment\n");
+    const QString outFileName = outFile.fileName();
+    outFile.close();
+
+    for (int i = 0; i < 3; ++i) {
+        QSettings settings(outFileName, QSettings::IniFormat);
+        QCOMPARE(settings.value("First/foo").toString(), QString("bar"));
+        settings.setValue("Second/key", i + 2);
+        settings.setValue("Second/other", "x");
+        settings.sync();
+        QCOMPARE(settings.status(), QSettings::NoError);
+    }
+
+    QFile file(outFileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray contents = file.readAll();
+    QVERIFY2(contents.startsWith("[First]"), contents.constData());
+    QVERIFY2(contents.contains(untouched), contents.constData());
+    QVERIFY2(!contents.contains("\n\n\n"), contents.constData());
+    QVERIFY2(!contents.contains("[Third]"), contents.constData());
+    QVERIFY(contents.indexOf("[First]") < contents.indexOf("[Second]"));
+
+    QSettings settings(outFileName, QSettings::IniFormat);
+    QCOMPARE(settings.value("First/foo").toString(), QString("bar"));
+    QCOMPARE(settings.value("First/list").toStringList(), QStringList() << "a" << "b");
+    QCOMPARE(settings.value("Second/key").toInt(), 4);
+    QCOMPARE(settings.value("Second/other").toString(), QString("x"));
+    QCOMPARE(settings.childGroups(), QStringList() << "First" << "Second");
+}
+#endif
+
 #if !defined(Q_OS_WIN) && !defined(QT_QSETTINGS_ALWAYS_CASE_SENSITIVE_AND_FORGET_ORIGINAL_KEY_ORDER)
 // This Qt build does not preserve ordering, as a code size optimization.
 void tst_QSettings::dontReorderIniKeysNeedlessly()
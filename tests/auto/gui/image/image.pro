@@ -5,6 +5,7 @@ SUBDIRS=\
    qpixmap \
    qpixmapcache \
    qimage \
+   qimagecache \
    qimageiohandler \
    qimagewriter \
    qmovie \
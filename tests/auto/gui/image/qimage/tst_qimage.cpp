@@ -214,6 +214,9 @@ private slots:
 
     void complexTransform8bit();
 
+    void threadCountIndependence_data();
+    void threadCountIndependence();
+
 #ifdef Q_OS_DARWIN
     void toCGImage_data();
     void toCGImage();
@@ -3393,6 +3396,75 @@ void tst_QImage::complexTransform8bit()
     QCOMPARE(img2.colorCount(), 0);
 }
 
+void tst_QImage::threadCountIndependence_data()
+{
+    QTest::addColumn<QByteArray>("operation");
+
+    QTest::newRow("scaled-up") << QByteArray("scaled-up");
+    QTest::newRow("scaled-down") << QByteArray("scaled-down");
+    QTest::newRow("premultiply") << QByteArray("premultiply");
+    QTest::newRow("rgb888-to-rgb32") << QByteArray("rgb888-to-rgb32");
+    QTest::newRow("generic-dithered") << QByteArray("generic-dithered");
+    QTest::newRow("generic-inplace") << QByteArray("generic-inplace");
+    QTest::newRow("mirrored-horizontal") << QByteArray("mirrored-horizontal");
+    QTest::newRow("mirrored-vertical") << QByteArray("mirrored-vertical");
+    QTest::newRow("mirrored-both-inplace") << QByteArray("mirrored-both-inplace");
+    QTest::newRow("mirrored-mono") << QByteArray("mirrored-mono");
+    QTest::newRow("rotated-smooth") << QByteArray("rotated-smooth");
+}
+
+static QImage applyImageOperation(const QByteArray &operation, const QImage &image)
+{
+    if (operation == "scaled-up")
+        return image.scaled(1500, 1100, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    if (operation == "scaled-down")
+        return image.scaled(700, 500, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    if (operation == "premultiply")
+        return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    if (operation == "rgb888-to-rgb32")
+        return image.convertToFormat(QImage::Format_RGB888).convertToFormat(QImage::Format_RGB32);
+    if (operation == "generic-dithered")
+        return image.convertToFormat(QImage::Format_RGB444, Qt::OrderedDither);
+    if (operation == "generic-inplace")
+        return image.convertToFormat(QImage::Format_RGBA8888).convertToFormat(QImage::Format_ARGB32);
+    if (operation == "mirrored-horizontal")
+        return image.mirrored(true, false);
+    if (operation == "mirrored-vertical")
+        return image.mirrored(false, true);
+    if (operation == "mirrored-both-inplace")
+        return QImage(image).mirrored(true, true);
+    if (operation == "mirrored-mono")
+        return image.convertToFormat(QImage::Format_Mono).mirrored(true, false);
+    if (operation == "rotated-smooth")
+        return image.transformed(QTransform().rotate(30), Qt::SmoothTransformation);
+    return QImage();
+}
+
+void tst_QImage::threadCountIndependence()
+{
+    QFETCH(QByteArray, operation);
+
+    // Large enough to be processed in segments on several threads
+    QImage image(1203, 901, QImage::Format_ARGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x)
+            line[x] = qRgba(x, y, x ^ y, (x * y) & 0xff);
+    }
+
+    QThreadPool *threadPool = QThreadPool::globalInstance();
+    const int maxThreadCount = threadPool->maxThreadCount();
+    threadPool->setMaxThreadCount(1);
+    const QImage expected = applyImageOperation(operation, image);
+    QVERIFY(!expected.isNull());
+
+    for (int threadCount : { 2, 3, 8 }) {
+        threadPool->setMaxThreadCount(threadCount);
+        QCOMPARE(applyImageOperation(operation, image), expected);
+    }
+    threadPool->setMaxThreadCount(maxThreadCount);
+}
+
 #ifdef Q_OS_DARWIN
 
 void tst_QImage::toCGImage_data()
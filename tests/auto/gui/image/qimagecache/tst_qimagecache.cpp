@@ -0,0 +1,334 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <qimagecache.h>
+#include <qsharedmemory.h>
+#include <private/qimagecache_p.h>
+
+class tst_QImageCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanupTestCase();
+
+    void insertAndFind();
+    void cacheLimit();
+    void remove();
+    void threads();
+    void sharedCache();
+    void sharedCacheLimit();
+    void corruptSharedImage();
+};
+
+static QImage testImage(int size, QRgb color)
+{
+    QImage image(size, size, QImage::Format_ARGB32);
+    image.fill(color);
+    return image;
+}
+
+static QString testSharedCacheKey()
+{
+    return QStringLiteral("tst_qimagecache-%1-%2").arg(QCoreApplication::applicationPid())
+                                                  .arg(QLatin1String(QTest::currentTestFunction()));
+}
+
+void tst_QImageCache::init()
+{
+    QImageCache::setSharedCacheKey(QString());
+    QImageCache::setSharedCacheLimit(51200);
+    QImageCache::setCacheLimit(10240);
+    QImageCache::clear();
+    QImageCache::resetStatistics();
+}
+
+void tst_QImageCache::cleanupTestCase()
+{
+    QImageCache::setSharedCacheKey(QString());
+    QImageCache::clear();
+}
+
+void tst_QImageCache::insertAndFind()
+{
+    const QImage image = testImage(16, 0xff102030);
+    QVERIFY(QImageCache::insert(QStringLiteral("a"), image));
+    QVERIFY(!QImageCache::insert(QStringLiteral("null"), QImage()));
+
+    QImage found;
+    QVERIFY(QImageCache::find(QStringLiteral("a"), &found));
+    QCOMPARE(found, image);
+    QVERIFY(!QImageCache::find(QStringLiteral("b"), &found));
+    QCOMPARE(found, image);
+
+    // Replacing an entry
+    const QImage other = testImage(16, 0xff405060);
+    QVERIFY(QImageCache::insert(QStringLiteral("a"), other));
+    QVERIFY(QImageCache::find(QStringLiteral("a"), &found));
+    QCOMPARE(found, other);
+
+    const QImageCache::Statistics statistics = QImageCache::statistics();
+    QCOMPARE(statistics.hits, qint64(2));
+    QCOMPARE(statistics.sharedHits, qint64(0));
+    QCOMPARE(statistics.misses, qint64(1));
+    QCOMPARE(statistics.insertions, qint64(2));
+    QCOMPARE(statistics.evictions, qint64(0));
+    QCOMPARE(statistics.totalCost, other.byteCount());
+
+    QImageCache::resetStatistics();
+    QCOMPARE(QImageCache::statistics().hits, qint64(0));
+}
+
+void tst_QImageCache::cacheLimit()
+{
+    QCOMPARE(QImageCache::cacheLimit(), 10240);
+
+    // 64x64 ARGB32 images take 16 KB each
+    QImageCache::setCacheLimit(64);
+    for (int i = 0; i < 6; ++i)
+        QVERIFY(QImageCache::insert(QString::number(i), testImage(64, 0xff000000 | i)));
+
+    QImageCache::Statistics statistics = QImageCache::statistics();
+    QCOMPARE(statistics.evictions, qint64(2));
+    QVERIFY(statistics.totalCost <= 64 * 1024);
+    QVERIFY(!QImageCache::find(QStringLiteral("0"), 0));
+    QVERIFY(!QImageCache::find(QStringLiteral("1"), 0));
+
+    // Least recently used images go first
+    QVERIFY(QImageCache::find(QStringLiteral("2"), 0));
+    QVERIFY(QImageCache::insert(QStringLiteral("6"), testImage(64, 0xffffffff)));
+    QVERIFY(QImageCache::find(QStringLiteral("2"), 0));
+    QVERIFY(!QImageCache::find(QStringLiteral("3"), 0));
+
+    // Images larger than the limit are not cached
+    QVERIFY(!QImageCache::insert(QStringLiteral("large"), testImage(256, 0xffffffff)));
+
+    QImageCache::setCacheLimit(32);
+    statistics = QImageCache::statistics();
+    QCOMPARE(statistics.evictions, qint64(5));
+    QCOMPARE(statistics.totalCost, 32 * 1024);
+}
+
+void tst_QImageCache::remove()
+{
+    QVERIFY(QImageCache::insert(QStringLiteral("a"), testImage(8, 0xffff0000)));
+    QVERIFY(QImageCache::insert(QStringLiteral("b"), testImage(8, 0xff00ff00)));
+
+    QImageCache::remove(QStringLiteral("a"));
+    QVERIFY(!QImageCache::find(QStringLiteral("a"), 0));
+    QVERIFY(QImageCache::find(QStringLiteral("b"), 0));
+
+    QImageCache::clear();
+    QVERIFY(!QImageCache::find(QStringLiteral("b"), 0));
+    QCOMPARE(QImageCache::statistics().totalCost, 0);
+}
+
+class CacheUser : public QThread
+{
+public:
+    explicit CacheUser(int id) : id(id), failures(0) { }
+
+    void run() override
+    {
+        for (int i = 0; i < 200; ++i) {
+            const QString key = QString::number(i % 20);
+            QImage image;
+            if (QImageCache::find(key, &image)) {
+                if (image.pixel(0, 0) != testImage(4, 0xff000000 | (i % 20)).pixel(0, 0))
+                    ++failures;
+            } else {
+                QImageCache::insert(key, testImage(4, 0xff000000 | (i % 20)));
+            }
+        }
+    }
+
+    int id;
+    int failures;
+};
+
+void tst_QImageCache::threads()
+{
+    QVector<CacheUser *> users;
+    for (int i = 0; i < 4; ++i)
+        users.append(new CacheUser(i));
+    for (CacheUser *user : qAsConst(users))
+        user->start();
+    for (CacheUser *user : qAsConst(users)) {
+        QVERIFY(user->wait());
+        QCOMPARE(user->failures, 0);
+    }
+    qDeleteAll(users);
+
+    const QImageCache::Statistics statistics = QImageCache::statistics();
+    QCOMPARE(statistics.hits + statistics.misses, qint64(4 * 200));
+    QCOMPARE(statistics.insertions, statistics.misses);
+}
+
+void tst_QImageCache::sharedCache()
+{
+#ifdef QT_NO_SHAREDMEMORY
+    QSKIP("This test requires shared memory support");
+#else
+    const QString sharedKey = testSharedCacheKey();
+    QImageCache::setSharedCacheKey(sharedKey);
+    QCOMPARE(QImageCache::sharedCacheKey(), sharedKey);
+
+    QImage image(40, 30, QImage::Format_Indexed8);
+    image.setColorTable(QVector<QRgb>() << 0xff000000 << 0x80ff0000 << 0xff00ff00);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x)
+            image.setPixel(x, y, (x + y) % 3);
+    }
+    image.setDevicePixelRatio(2);
+    image.setDotsPerMeterX(1000);
+    QVERIFY(QImageCache::insert(QStringLiteral("shared"), image));
+
+    QSharedMemory probe(sharedKey);
+    if (!probe.attach(QSharedMemory::ReadOnly))
+        QSKIP("Shared memory is not available");
+    probe.detach();
+    QVERIFY(QImageCache::statistics().sharedCost > image.byteCount());
+
+    // Evict the image from the cache of this process, it is still published
+    QImageCache::setCacheLimit(0);
+    QImageCache::setCacheLimit(10240);
+    QImage found;
+    QVERIFY(QImageCache::find(QStringLiteral("shared"), &found));
+    QCOMPARE(found, image);
+    QCOMPARE(found.colorTable(), image.colorTable());
+    QCOMPARE(found.devicePixelRatio(), qreal(2));
+    QCOMPARE(found.dotsPerMeterX(), 1000);
+
+    QImageCache::Statistics statistics = QImageCache::statistics();
+    QCOMPARE(statistics.sharedHits, qint64(1));
+    QCOMPARE(statistics.hits, qint64(0));
+
+    // The copy fetched from the shared tier now lives in the local cache
+    QVERIFY(QImageCache::find(QStringLiteral("shared"), 0));
+    QCOMPARE(QImageCache::statistics().hits, qint64(1));
+
+    // Removing an image unpublishes it
+    QImageCache::remove(QStringLiteral("shared"));
+    QVERIFY(!QImageCache::find(QStringLiteral("shared"), 0));
+    statistics = QImageCache::statistics();
+    QCOMPARE(statistics.misses, qint64(1));
+    QCOMPARE(statistics.sharedCost, 0);
+#endif
+}
+
+void tst_QImageCache::sharedCacheLimit()
+{
+#ifdef QT_NO_SHAREDMEMORY
+    QSKIP("This test requires shared memory support");
+#else
+    // The limit applies when the shared memory is created
+    QImageCache::setSharedCacheLimit(96);
+    QImageCache::setSharedCacheKey(testSharedCacheKey());
+    // Find the images in the shared memory only
+    QImageCache::setCacheLimit(0);
+
+    // 64x64 ARGB32 images take a little more than 16 KB each in the shared
+    // memory, so five of them fit
+    for (int i = 0; i < 8; ++i)
+        QImageCache::insert(QString::number(i), testImage(64, 0xff000000 | i));
+    if (QImageCache::statistics().sharedCost == 0)
+        QSKIP("Shared memory is not available");
+
+    // The oldest images were overwritten
+    for (int i = 0; i < 3; ++i)
+        QVERIFY(!QImageCache::find(QString::number(i), 0));
+    for (int i = 3; i < 8; ++i) {
+        QImage found;
+        QVERIFY(QImageCache::find(QString::number(i), &found));
+        QCOMPARE(found, testImage(64, 0xff000000 | i));
+    }
+
+    const QImageCache::Statistics statistics = QImageCache::statistics();
+    QCOMPARE(statistics.sharedHits, qint64(5));
+    QVERIFY(statistics.sharedCost > 5 * 64 * 64 * 4);
+    QVERIFY(statistics.sharedCost <= 96 * 1024);
+#endif
+}
+
+void tst_QImageCache::corruptSharedImage()
+{
+#ifdef QT_NO_SHAREDMEMORY
+    QSKIP("This test requires shared memory support");
+#else
+    const QString sharedKey = testSharedCacheKey();
+    QImageCache::setSharedCacheKey(sharedKey);
+    QImageCache::setCacheLimit(0);
+
+    QImage image(4, 4, QImage::Format_Indexed8);
+    image.setColorTable(QVector<QRgb>() << 0xff000000 << 0xffffffff);
+    image.fill(1);
+    QImageCache::insert(QStringLiteral("indexed"), image);
+
+    QSharedMemory arena(sharedKey);
+    if (!arena.attach())
+        QSKIP("Shared memory is not available");
+    QVERIFY(QImageCache::find(QStringLiteral("indexed"), 0));
+
+    // Look the image up the way another process would
+    QVERIFY(arena.lock());
+    char *data = static_cast<char *>(arena.data());
+    const QImageCacheArenaHeader *header = reinterpret_cast<QImageCacheArenaHeader *>(data);
+    const QImageCacheIndexEntry *index =
+            reinterpret_cast<QImageCacheIndexEntry *>(data + sizeof(QImageCacheArenaHeader));
+    QImageCacheImageHeader *imageHeader = 0;
+    for (int i = 0; i < header->indexSize; ++i) {
+        if (index[i].sequence)
+            imageHeader = reinterpret_cast<QImageCacheImageHeader *>(data + header->dataOffset + index[i].offset);
+    }
+    arena.unlock();
+    QVERIFY(imageHeader);
+    QCOMPARE(imageHeader->colorCount, 2);
+
+    // A color count from another process is not trusted
+    const qint32 colorCounts[] = { -1, -65536, 257, std::numeric_limits<qint32>::max() };
+    for (qint32 colorCount : colorCounts) {
+        QVERIFY(arena.lock());
+        imageHeader->colorCount = colorCount;
+        arena.unlock();
+        QVERIFY(!QImageCache::find(QStringLiteral("indexed"), 0));
+    }
+
+    QVERIFY(arena.lock());
+    imageHeader->colorCount = 2;
+    arena.unlock();
+    QImage found;
+    QVERIFY(QImageCache::find(QStringLiteral("indexed"), &found));
+    QCOMPARE(found, image);
+#endif
+}
+
+QTEST_GUILESS_MAIN(tst_QImageCache)
+#include "tst_qimagecache.moc"
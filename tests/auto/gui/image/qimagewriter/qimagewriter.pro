@@ -1,6 +1,6 @@
 CONFIG += testcase
 TARGET = tst_qimagewriter
-QT += testlib
+QT += testlib gui-private
 SOURCES += tst_qimagewriter.cpp
 MOC_DIR=tmp
 android:!android-embedded: RESOURCES += qimagewriter.qrc
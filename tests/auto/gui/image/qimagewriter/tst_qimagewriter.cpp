@@ -38,6 +38,9 @@
 #include <QPainter>
 #include <QSet>
 #include <QTemporaryDir>
+#include <QThreadPool>
+
+#include <private/qpnghandler_p.h>
 
 #ifdef Q_OS_UNIX // for geteuid()
 # include <sys/types.h>
@@ -50,6 +53,7 @@ typedef QMap<QString, QString> QStringMap;
 typedef QVector<int> QIntList;
 Q_DECLARE_METATYPE(QImageWriter::ImageWriterError)
 Q_DECLARE_METATYPE(QImage::Format)
+Q_DECLARE_METATYPE(QPngStreamWriter::FilterMode)
 
 class tst_QImageWriter : public QObject
 {
@@ -77,6 +81,11 @@ private slots:
     void saveWithNoFormat();
 
     void saveToTemporaryFile();
+
+    void writeLargePng_data();
+    void writeLargePng();
+    void pngStreamWriter_data();
+    void pngStreamWriter();
 private:
     QTemporaryDir m_temporaryDir;
     QString prefix;
@@ -529,5 +538,118 @@ void tst_QImageWriter::saveToTemporaryFile()
     }
 }
 
+static QImage largeTestImage(QImage::Format format)
+{
+    // Large enough to be split into several compressed segments
+    QImage image(1200, 900, QImage::Format_ARGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x)
+            line[x] = qRgba(x * 7 + y, x ^ y, y * 3, (x / 16 + y / 16) * 8);
+    }
+    if (format == QImage::Format_Indexed8)
+        return image.convertToFormat(QImage::Format_RGB32).convertToFormat(format, Qt::ThresholdDither);
+    return image.convertToFormat(format);
+}
+
+void tst_QImageWriter::writeLargePng_data()
+{
+    QTest::addColumn<QImage::Format>("format");
+    QTest::addColumn<int>("quality");
+
+    QTest::newRow("RGB32") << QImage::Format_RGB32 << -1;
+    QTest::newRow("ARGB32") << QImage::Format_ARGB32 << -1;
+    QTest::newRow("ARGB32_Premultiplied") << QImage::Format_ARGB32_Premultiplied << -1;
+    QTest::newRow("RGB888") << QImage::Format_RGB888 << -1;
+    QTest::newRow("RGB16") << QImage::Format_RGB16 << -1;
+    QTest::newRow("Grayscale8") << QImage::Format_Grayscale8 << -1;
+    QTest::newRow("Indexed8") << QImage::Format_Indexed8 << -1;
+    QTest::newRow("ARGB32, uncompressed") << QImage::Format_ARGB32 << 100;
+    QTest::newRow("ARGB32, best compression") << QImage::Format_ARGB32 << 0;
+}
+
+void tst_QImageWriter::writeLargePng()
+{
+    QFETCH(QImage::Format, format);
+    QFETCH(int, quality);
+
+    const QImage image = largeTestImage(format);
+    const int maxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+    QThreadPool::globalInstance()->setMaxThreadCount(4);
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QImageWriter writer(&buffer, "png");
+    writer.setQuality(quality);
+    const bool written = writer.write(image);
+    QThreadPool::globalInstance()->setMaxThreadCount(maxThreadCount);
+    QVERIFY2(written, qPrintable(writer.errorString()));
+
+    QImage read;
+    QVERIFY(read.loadFromData(data, "png"));
+    QCOMPARE(read.size(), image.size());
+    QCOMPARE(read, image.convertToFormat(read.format()));
+}
+
+void tst_QImageWriter::pngStreamWriter_data()
+{
+    QTest::addColumn<QImage::Format>("format");
+    QTest::addColumn<QPngStreamWriter::FilterMode>("filterMode");
+    QTest::addColumn<bool>("useThreadPool");
+
+    QTest::newRow("ARGB32, adaptive") << QImage::Format_ARGB32 << QPngStreamWriter::FilterAdaptive << true;
+    QTest::newRow("ARGB32, adaptive, serial") << QImage::Format_ARGB32 << QPngStreamWriter::FilterAdaptive << false;
+    QTest::newRow("RGB32, none") << QImage::Format_RGB32 << QPngStreamWriter::FilterNone << true;
+    QTest::newRow("RGB32, sub") << QImage::Format_RGB32 << QPngStreamWriter::FilterSub << true;
+    QTest::newRow("RGB888, up") << QImage::Format_RGB888 << QPngStreamWriter::FilterUp << true;
+    QTest::newRow("ARGB32_Premultiplied, average") << QImage::Format_ARGB32_Premultiplied << QPngStreamWriter::FilterAverage << true;
+    QTest::newRow("Grayscale8, paeth") << QImage::Format_Grayscale8 << QPngStreamWriter::FilterPaeth << true;
+    QTest::newRow("Indexed8, none") << QImage::Format_Indexed8 << QPngStreamWriter::FilterNone << true;
+}
+
+void tst_QImageWriter::pngStreamWriter()
+{
+    QFETCH(QImage::Format, format);
+    QFETCH(QPngStreamWriter::FilterMode, filterMode);
+    QFETCH(bool, useThreadPool);
+
+    const QImage image = largeTestImage(format);
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(4);
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QPngStreamWriter writer(&buffer);
+    writer.setFilterMode(filterMode);
+    writer.setThreadPool(useThreadPool ? &threadPool : 0);
+    QVERIFY(writer.begin(image.size(), image.format(), image.colorTable()));
+
+    // Rows arrive in uneven slices
+    const int sliceHeight = 37;
+    for (int y = 0; y < image.height(); y += sliceHeight) {
+        const QImage rows = image.copy(0, y, image.width(), qMin(sliceHeight, image.height() - y));
+        QVERIFY(writer.writeRows(rows));
+        QCOMPARE(writer.rowsWritten(), y + rows.height());
+    }
+    QVERIFY(!writer.writeRows(image.copy(0, 0, image.width(), 1)));
+    QVERIFY(writer.end());
+
+    QImage read;
+    QVERIFY(read.loadFromData(data, "png"));
+    QCOMPARE(read.size(), image.size());
+    QCOMPARE(read, image.convertToFormat(read.format()));
+
+    // An incomplete image is reported
+    buffer.close();
+    data.clear();
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QVERIFY(writer.begin(image.size(), image.format(), image.colorTable()));
+    QVERIFY(writer.writeRows(image.copy(0, 0, image.width(), 10)));
+    QTest::ignoreMessage(QtWarningMsg, "QPngStreamWriter::end: Only 10 of 900 rows were written");
+    QVERIFY(!writer.end());
+}
+
 QTEST_MAIN(tst_QImageWriter)
 #include "tst_qimagewriter.moc"
@@ -3,6 +3,7 @@ SUBDIRS=\
    qpainterpath \
    qpainterpathstroker \
    qcolor \
+   qcolortransform \
    qbrush \
    qregion \
    qpagelayout \
@@ -15,8 +16,14 @@ SUBDIRS=\
    qtransform \
    qwmatrix \
    qpolygon \
+   qtiledpaintdevice \
+   qpaintbuffer \
+   qcompositionfunctions \
 
 !qtConfig(private_tests): SUBDIRS -= \
+    qcolortransform \
+    qcompositionfunctions \
+    qpaintbuffer \
     qpathclipper \
 
 
@@ -0,0 +1,4 @@
+CONFIG += testcase
+TARGET = tst_qcolortransform
+QT += gui-private testlib
+SOURCES += tst_qcolortransform.cpp
@@ -0,0 +1,293 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <private/qcolortransform_p.h>
+
+class tst_QColorTransform : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void transferFunctions_data();
+    void transferFunctions();
+    void sRgbMatrix();
+    void identity();
+    void knownColors_data();
+    void knownColors();
+    void roundTrip_data();
+    void roundTrip();
+    void extendedRange();
+    void images_data();
+    void images();
+    void scaleLinearLight();
+};
+
+typedef QColorSpaceDefinition::NamedColorSpace NamedColorSpace;
+Q_DECLARE_METATYPE(QColorSpaceDefinition::NamedColorSpace)
+Q_DECLARE_METATYPE(QImage::Format)
+Q_DECLARE_METATYPE(QColorTransferFunction)
+
+static QColorSpaceDefinition named(NamedColorSpace colorSpace)
+{
+    return QColorSpaceDefinition::fromNamedColorSpace(colorSpace);
+}
+
+static bool fuzzyCompareColor(QRgb c1, QRgb c2, int tolerance)
+{
+    return qAbs(qRed(c1) - qRed(c2)) <= tolerance
+        && qAbs(qGreen(c1) - qGreen(c2)) <= tolerance
+        && qAbs(qBlue(c1) - qBlue(c2)) <= tolerance
+        && qAlpha(c1) == qAlpha(c2);
+}
+
+void tst_QColorTransform::transferFunctions_data()
+{
+    QTest::addColumn<QColorTransferFunction>("function");
+
+    QTest::newRow("linear") << QColorTransferFunction();
+    QTest::newRow("gamma 2.2") << QColorTransferFunction::fromGamma(2.2f);
+    QTest::newRow("sRGB") << QColorTransferFunction::fromSRgb();
+    QTest::newRow("ProPhoto") << QColorTransferFunction::fromProPhotoRgb();
+    QTest::newRow("BT.2020") << QColorTransferFunction::fromBt2020();
+}
+
+void tst_QColorTransform::transferFunctions()
+{
+    QFETCH(QColorTransferFunction, function);
+
+    QCOMPARE(function.apply(0.0f), 0.0f);
+    QVERIFY(qAbs(function.apply(1.0f) - 1.0f) < 1e-3f);
+    for (int i = 0; i <= 100; ++i) {
+        const float x = i / 100.0f;
+        QVERIFY(qAbs(function.applyInverse(function.apply(x)) - x) < 1e-4f);
+        QVERIFY(qAbs(function.apply(-x) + function.apply(x)) < 1e-6f);
+        if (i > 0)
+            QVERIFY(function.apply(x) > function.apply(x - 0.01f));
+    }
+}
+
+void tst_QColorTransform::sRgbMatrix()
+{
+    // The D50 adapted sRGB matrix of ICC profiles
+    const QColorMatrix m = named(QColorSpaceDefinition::SRgb).toXyz;
+    QVERIFY(qAbs(m.r.x - 0.4361f) < 1e-3f);
+    QVERIFY(qAbs(m.g.x - 0.3851f) < 1e-3f);
+    QVERIFY(qAbs(m.b.x - 0.1431f) < 1e-3f);
+    QVERIFY(qAbs(m.r.y - 0.2225f) < 1e-3f);
+    QVERIFY(qAbs(m.g.y - 0.7169f) < 1e-3f);
+    QVERIFY(qAbs(m.b.y - 0.0606f) < 1e-3f);
+    QVERIFY(qAbs(m.r.z - 0.0139f) < 1e-3f);
+    QVERIFY(qAbs(m.g.z - 0.0971f) < 1e-3f);
+    QVERIFY(qAbs(m.b.z - 0.7142f) < 1e-3f);
+
+    QVERIFY((m * m.inverted()).isIdentity());
+}
+
+void tst_QColorTransform::identity()
+{
+    const QColorTransform transform(named(QColorSpaceDefinition::DisplayP3),
+                                    named(QColorSpaceDefinition::DisplayP3));
+    QVERIFY(transform.isIdentity());
+    QVERIFY(QColorTransform().isIdentity());
+    QVERIFY(!QColorTransform(named(QColorSpaceDefinition::SRgb),
+                             named(QColorSpaceDefinition::SRgbLinear)).isIdentity());
+
+    QRgb colors[] = { 0xff000000, 0x80123456, 0xffffffff };
+    QRgb result[3];
+    transform.apply(result, colors, 3);
+    QCOMPARE(result[0], colors[0]);
+    QCOMPARE(result[1], colors[1]);
+    QCOMPARE(result[2], colors[2]);
+}
+
+void tst_QColorTransform::knownColors_data()
+{
+    QTest::addColumn<NamedColorSpace>("source");
+    QTest::addColumn<NamedColorSpace>("destination");
+    QTest::addColumn<uint>("color");
+    QTest::addColumn<uint>("expected");
+
+    QTest::newRow("sRGB red in Display P3") << QColorSpaceDefinition::SRgb << QColorSpaceDefinition::DisplayP3
+                                            << 0xffff0000u << 0xffea3323u;
+    QTest::newRow("sRGB green in Display P3") << QColorSpaceDefinition::SRgb << QColorSpaceDefinition::DisplayP3
+                                              << 0xff00ff00u << 0xff75fb4cu;
+    QTest::newRow("sRGB gray in linear sRGB") << QColorSpaceDefinition::SRgb << QColorSpaceDefinition::SRgbLinear
+                                              << 0xff808080u << 0xff373737u;
+    QTest::newRow("sRGB white in ProPhoto") << QColorSpaceDefinition::SRgb << QColorSpaceDefinition::ProPhotoRgb
+                                            << 0x80ffffffu << 0x80ffffffu;
+    QTest::newRow("sRGB black in BT.2020") << QColorSpaceDefinition::SRgb << QColorSpaceDefinition::Bt2020
+                                           << 0xff000000u << 0xff000000u;
+    QTest::newRow("sRGB red in Adobe RGB") << QColorSpaceDefinition::SRgb << QColorSpaceDefinition::AdobeRgb
+                                           << 0xffff0000u << 0xffdb0000u;
+}
+
+void tst_QColorTransform::knownColors()
+{
+    QFETCH(NamedColorSpace, source);
+    QFETCH(NamedColorSpace, destination);
+    QFETCH(uint, color);
+    QFETCH(uint, expected);
+
+    const QColorTransform transform(named(source), named(destination));
+    QRgb result;
+    const QRgb input = color;
+    transform.apply(&result, &input, 1);
+    QVERIFY2(fuzzyCompareColor(result, expected, 1), qPrintable(QString::number(result, 16)));
+}
+
+void tst_QColorTransform::roundTrip_data()
+{
+    QTest::addColumn<NamedColorSpace>("wideGamut");
+
+    QTest::newRow("Display P3") << QColorSpaceDefinition::DisplayP3;
+    QTest::newRow("Adobe RGB") << QColorSpaceDefinition::AdobeRgb;
+    QTest::newRow("ProPhoto") << QColorSpaceDefinition::ProPhotoRgb;
+    QTest::newRow("BT.2020") << QColorSpaceDefinition::Bt2020;
+}
+
+void tst_QColorTransform::roundTrip()
+{
+    QFETCH(NamedColorSpace, wideGamut);
+
+    // sRGB fits in all of them, so no color is clipped on the way
+    const QColorTransform forward(named(QColorSpaceDefinition::SRgb), named(wideGamut));
+    const QColorTransform backward(named(wideGamut), named(QColorSpaceDefinition::SRgb));
+
+    QVector<QRgba64> colors;
+    for (int r = 0; r < 256; r += 15) {
+        for (int g = 0; g < 256; g += 15) {
+            for (int b = 0; b < 256; b += 15)
+                colors.append(QRgba64::fromRgba(r, g, b, 255));
+        }
+    }
+    QVector<QRgba64> result(colors.size());
+    forward.apply(result.data(), colors.constData(), colors.size());
+    backward.apply(result.data(), result.constData(), result.size());
+    for (int i = 0; i < colors.size(); ++i)
+        QVERIFY(fuzzyCompareColor(result.at(i).toArgb32(), colors.at(i).toArgb32(), 1));
+}
+
+void tst_QColorTransform::extendedRange()
+{
+    const QColorTransform transform(named(QColorSpaceDefinition::DisplayP3),
+                                    named(QColorSpaceDefinition::SRgb));
+    const float red[] = { 1.0f, 0.0f, 0.0f, 0.5f };
+    float result[4];
+    transform.apply(result, red, 1);
+    QVERIFY(qAbs(result[0] - 1.093f) < 2e-3f);
+    QVERIFY(qAbs(result[1] + 0.227f) < 2e-3f);
+    QVERIFY(qAbs(result[2] + 0.150f) < 2e-3f);
+    QCOMPARE(result[3], 0.5f);
+
+    // Integer formats clip
+    QRgb clipped;
+    const QRgb input = 0xffff0000;
+    transform.apply(&clipped, &input, 1);
+    QCOMPARE(clipped, 0xffff0000u);
+}
+
+void tst_QColorTransform::images_data()
+{
+    QTest::addColumn<QImage::Format>("format");
+
+    QTest::newRow("RGB32") << QImage::Format_RGB32;
+    QTest::newRow("ARGB32") << QImage::Format_ARGB32;
+    QTest::newRow("ARGB32_Premultiplied") << QImage::Format_ARGB32_Premultiplied;
+    QTest::newRow("RGB888") << QImage::Format_RGB888;
+    QTest::newRow("Indexed8") << QImage::Format_Indexed8;
+    QTest::newRow("A2RGB30_Premultiplied") << QImage::Format_A2RGB30_Premultiplied;
+    QTest::newRow("BGR30") << QImage::Format_BGR30;
+}
+
+void tst_QColorTransform::images()
+{
+    QFETCH(QImage::Format, format);
+
+    QImage image(300, 200, QImage::Format_ARGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x)
+            image.setPixel(x, y, qRgba(x, y, (x * y) & 0xff, format == QImage::Format_ARGB32 ? 0x80 : 0xff));
+    }
+    image = image.convertToFormat(format);
+
+    const QColorTransform transform(named(QColorSpaceDefinition::SRgb),
+                                    named(QColorSpaceDefinition::DisplayP3));
+    const QImage result = transform.apply(image);
+    QCOMPARE(result.format(), format);
+    QCOMPARE(result.size(), image.size());
+
+    // The image is converted like single colors
+    for (int y = 0; y < image.height(); y += 7) {
+        for (int x = 0; x < image.width(); x += 7) {
+            const QRgb input = image.pixel(x, y);
+            QRgb expected;
+            transform.apply(&expected, &input, 1);
+            QVERIFY2(fuzzyCompareColor(result.pixel(x, y), expected, 2),
+                     qPrintable(QString::fromLatin1("%1,%2: %3 != %4").arg(x).arg(y)
+                                .arg(result.pixel(x, y), 0, 16).arg(expected, 0, 16)));
+        }
+    }
+}
+
+void tst_QColorTransform::scaleLinearLight()
+{
+    QImage image(2, 2, QImage::Format_RGB32);
+    image.setPixel(0, 0, 0xff000000);
+    image.setPixel(1, 0, 0xffffffff);
+    image.setPixel(0, 1, 0xffffffff);
+    image.setPixel(1, 1, 0xff000000);
+
+    // Half the light of white, not the middle of the encoded values
+    QImage scaled = qt_scaleImageLinearLight(image, QSize(1, 1));
+    QCOMPARE(scaled.size(), QSize(1, 1));
+    QCOMPARE(scaled.format(), QImage::Format_RGB32);
+    QVERIFY(fuzzyCompareColor(scaled.pixel(0, 0), 0xffbcbcbc, 1));
+
+    // Transparent pixels do not bleed their color
+    QImage transparent(2, 1, QImage::Format_ARGB32);
+    transparent.setPixel(0, 0, 0x00ff0000);
+    transparent.setPixel(1, 0, 0xff0000ff);
+    scaled = qt_scaleImageLinearLight(transparent, QSize(1, 1));
+    QCOMPARE(scaled.format(), QImage::Format_ARGB32_Premultiplied);
+    QVERIFY(fuzzyCompareColor(scaled.pixel(0, 0), 0x80000080, 1));
+
+    // Enlarging interpolates, uniform images stay uniform
+    QImage uniform(13, 7, QImage::Format_RGB32);
+    uniform.fill(0xff336699);
+    scaled = qt_scaleImageLinearLight(uniform, QSize(40, 5));
+    QCOMPARE(scaled.size(), QSize(40, 5));
+    for (int y = 0; y < scaled.height(); ++y) {
+        for (int x = 0; x < scaled.width(); ++x)
+            QVERIFY(fuzzyCompareColor(scaled.pixel(x, y), 0xff336699, 1));
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_QColorTransform)
+#include "tst_qcolortransform.moc"
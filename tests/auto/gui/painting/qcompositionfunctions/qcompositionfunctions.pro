@@ -0,0 +1,6 @@
+CONFIG += testcase
+TARGET = tst_qcompositionfunctions
+SOURCES  += tst_qcompositionfunctions.cpp
+QT += gui-private testlib
+
+requires(qtConfig(private_tests))
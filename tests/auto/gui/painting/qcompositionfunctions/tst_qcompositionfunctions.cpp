@@ -0,0 +1,397 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+
+#include <QtTest/QtTest>
+
+#include <private/qdrawhelper_p.h>
+#include <private/qsimd_p.h>
+
+#ifdef QT_BUILD_INTERNAL
+#define HAVE_COMPOSITION_FUNCTIONS
+
+QT_BEGIN_NAMESPACE
+// qcompositionfunctions.cpp
+Q_GUI_EXPORT void QT_FASTCALL comp_func_SourceOver(uint *dest, const uint *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_solid_SourceOver(uint *dest, int length, uint color, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_Source(uint *dest, const uint *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_Plus(uint *dest, const uint *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_solid_Plus(uint *dest, int length, uint color, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_Multiply(uint *dest, const uint *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_solid_Multiply(uint *dest, int length, uint color, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_SourceOver_rgb64(QRgba64 *dest, const QRgba64 *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_solid_SourceOver_rgb64(QRgba64 *dest, int length, QRgba64 color, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_Source_rgb64(QRgba64 *dest, const QRgba64 *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_Plus_rgb64(QRgba64 *dest, const QRgba64 *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_solid_Plus_rgb64(QRgba64 *dest, int length, QRgba64 color, uint const_alpha);
+
+#ifdef QT_COMPILER_SUPPORTS_AVX2
+#define HAVE_AVX2_FUNCTIONS
+// qdrawhelper_avx2.cpp
+Q_GUI_EXPORT void QT_FASTCALL comp_func_SourceOver_avx2(uint *dest, const uint *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_solid_SourceOver_avx2(uint *dest, int length, uint color, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_Source_avx2(uint *dest, const uint *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_Plus_avx2(uint *dest, const uint *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_solid_Plus_avx2(uint *dest, int length, uint color, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_Multiply_avx2(uint *dest, const uint *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_solid_Multiply_avx2(uint *dest, int length, uint color, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_SourceOver_rgb64_avx2(QRgba64 *dest, const QRgba64 *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_solid_SourceOver_rgb64_avx2(QRgba64 *dest, int length, QRgba64 color, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_Source_rgb64_avx2(QRgba64 *dest, const QRgba64 *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_Plus_rgb64_avx2(QRgba64 *dest, const QRgba64 *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_solid_Plus_rgb64_avx2(QRgba64 *dest, int length, QRgba64 color, uint const_alpha);
+#endif
+
+#if defined(QT_COMPILER_SUPPORTS_AVX512F) && defined(QT_COMPILER_SUPPORTS_AVX512BW)
+#define HAVE_AVX512_FUNCTIONS
+// qdrawhelper_avx512.cpp
+Q_GUI_EXPORT void QT_FASTCALL comp_func_SourceOver_avx512(uint *dest, const uint *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_solid_SourceOver_avx512(uint *dest, int length, uint color, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_Source_avx512(uint *dest, const uint *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_Plus_avx512(uint *dest, const uint *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_solid_Plus_avx512(uint *dest, int length, uint color, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_Multiply_avx512(uint *dest, const uint *src, int length, uint const_alpha);
+Q_GUI_EXPORT void QT_FASTCALL comp_func_solid_Multiply_avx512(uint *dest, int length, uint color, uint const_alpha);
+#endif
+QT_END_NAMESPACE
+#endif
+
+Q_DECLARE_METATYPE(CompositionFunction)
+Q_DECLARE_METATYPE(CompositionFunctionSolid)
+Q_DECLARE_METATYPE(CompositionFunction64)
+Q_DECLARE_METATYPE(CompositionFunctionSolid64)
+
+// Compares the SIMD composition functions the CPU supports with the
+// generic ones. They have to produce exactly the same pixels.
+class tst_QCompositionFunctions : public QObject
+{
+Q_OBJECT
+
+private slots:
+    void rgb32_data();
+    void rgb32();
+    void rgb32Solid_data();
+    void rgb32Solid();
+    void rgb64_data();
+    void rgb64();
+    void rgb64Solid_data();
+    void rgb64Solid();
+};
+
+#ifdef HAVE_COMPOSITION_FUNCTIONS
+// Room for the longest span at the largest offset, the rest of the buffer
+// must be left alone.
+static const int BufferSize = 128;
+static const int MaxOffset = 3;
+static const int lengths[] = { 0, 1, 2, 3, 7, 8, 15, 16, 17, 31, 32, 33, 47, 63, 64, 65, 100 };
+static const uint constAlphas[] = { 0, 1, 127, 128, 254, 255 };
+
+#ifdef HAVE_AVX512_FUNCTIONS
+static bool cpuHasAvx512()
+{
+    // The same features qInitDrawhelperFunctions() checks for
+    return qCpuHasFeature(AVX512F) && qCpuHasFeature(AVX512CD) && qCpuHasFeature(AVX512BW)
+            && qCpuHasFeature(AVX512DQ) && qCpuHasFeature(AVX512VL);
+}
+#endif
+
+// Alpha values with runs of fully transparent and fully opaque pixels, so
+// that the shortcuts for those are taken as well.
+static int alphaAt(int i, int max)
+{
+    switch ((i / 20) % 3) {
+    case 0:
+        return qrand() % (max + 1);
+    case 1:
+        return max;
+    default:
+        return i % 2 ? 0 : max;
+    }
+}
+
+static QVector<uint> premultipliedPixels(uint seed)
+{
+    qsrand(seed);
+    QVector<uint> pixels(BufferSize);
+    for (int i = 0; i < BufferSize; ++i) {
+        const int alpha = alphaAt(i, 255);
+        pixels[i] = qRgba(qrand() % (alpha + 1), qrand() % (alpha + 1), qrand() % (alpha + 1), alpha);
+    }
+    return pixels;
+}
+
+static QVector<QRgba64> premultipliedPixels64(uint seed)
+{
+    qsrand(seed);
+    QVector<QRgba64> pixels(BufferSize);
+    for (int i = 0; i < BufferSize; ++i) {
+        const int alpha = alphaAt(i, 65535);
+        pixels[i] = qRgba64(qrand() % (alpha + 1), qrand() % (alpha + 1), qrand() % (alpha + 1), alpha);
+    }
+    return pixels;
+}
+
+static QByteArray spanDescription(int length, int offset, uint constAlpha)
+{
+    return "length " + QByteArray::number(length) + ", offset " + QByteArray::number(offset)
+            + ", const_alpha " + QByteArray::number(constAlpha);
+}
+#endif
+
+void tst_QCompositionFunctions::rgb32_data()
+{
+#ifndef HAVE_COMPOSITION_FUNCTIONS
+    QSKIP("This build does not export the composition functions");
+#else
+    QTest::addColumn<CompositionFunction>("generic");
+    QTest::addColumn<CompositionFunction>("simd");
+
+    bool hasRows = false;
+#ifdef HAVE_AVX2_FUNCTIONS
+    if (qCpuHasFeature(AVX2)) {
+        QTest::newRow("SourceOver, AVX2") << CompositionFunction(comp_func_SourceOver)
+                                          << CompositionFunction(comp_func_SourceOver_avx2);
+        QTest::newRow("Source, AVX2") << CompositionFunction(comp_func_Source)
+                                      << CompositionFunction(comp_func_Source_avx2);
+        QTest::newRow("Plus, AVX2") << CompositionFunction(comp_func_Plus)
+                                    << CompositionFunction(comp_func_Plus_avx2);
+        QTest::newRow("Multiply, AVX2") << CompositionFunction(comp_func_Multiply)
+                                        << CompositionFunction(comp_func_Multiply_avx2);
+        hasRows = true;
+    }
+#endif
+#ifdef HAVE_AVX512_FUNCTIONS
+    if (cpuHasAvx512()) {
+        QTest::newRow("SourceOver, AVX-512") << CompositionFunction(comp_func_SourceOver)
+                                             << CompositionFunction(comp_func_SourceOver_avx512);
+        QTest::newRow("Source, AVX-512") << CompositionFunction(comp_func_Source)
+                                         << CompositionFunction(comp_func_Source_avx512);
+        QTest::newRow("Plus, AVX-512") << CompositionFunction(comp_func_Plus)
+                                       << CompositionFunction(comp_func_Plus_avx512);
+        QTest::newRow("Multiply, AVX-512") << CompositionFunction(comp_func_Multiply)
+                                           << CompositionFunction(comp_func_Multiply_avx512);
+        hasRows = true;
+    }
+#endif
+    if (!hasRows)
+        QSKIP("This CPU or build has no SIMD composition functions to test");
+#endif
+}
+
+void tst_QCompositionFunctions::rgb32()
+{
+#ifdef HAVE_COMPOSITION_FUNCTIONS
+    QFETCH(CompositionFunction, generic);
+    QFETCH(CompositionFunction, simd);
+
+    const QVector<uint> src = premultipliedPixels(1);
+    const QVector<uint> dst = premultipliedPixels(2);
+
+    for (uint constAlpha : constAlphas) {
+        for (int length : lengths) {
+            for (int offset = 0; offset <= MaxOffset; ++offset) {
+                // Misalign source and destination differently
+                QVector<uint> expected = dst;
+                QVector<uint> actual = dst;
+                generic(expected.data() + offset, src.constData() + MaxOffset - offset, length, constAlpha);
+                simd(actual.data() + offset, src.constData() + MaxOffset - offset, length, constAlpha);
+                QVERIFY2(actual == expected, spanDescription(length, offset, constAlpha).constData());
+            }
+        }
+    }
+#endif
+}
+
+void tst_QCompositionFunctions::rgb32Solid_data()
+{
+#ifndef HAVE_COMPOSITION_FUNCTIONS
+    QSKIP("This build does not export the composition functions");
+#else
+    QTest::addColumn<CompositionFunctionSolid>("generic");
+    QTest::addColumn<CompositionFunctionSolid>("simd");
+
+    bool hasRows = false;
+#ifdef HAVE_AVX2_FUNCTIONS
+    if (qCpuHasFeature(AVX2)) {
+        QTest::newRow("SourceOver, AVX2") << CompositionFunctionSolid(comp_func_solid_SourceOver)
+                                          << CompositionFunctionSolid(comp_func_solid_SourceOver_avx2);
+        QTest::newRow("Plus, AVX2") << CompositionFunctionSolid(comp_func_solid_Plus)
+                                    << CompositionFunctionSolid(comp_func_solid_Plus_avx2);
+        QTest::newRow("Multiply, AVX2") << CompositionFunctionSolid(comp_func_solid_Multiply)
+                                        << CompositionFunctionSolid(comp_func_solid_Multiply_avx2);
+        hasRows = true;
+    }
+#endif
+#ifdef HAVE_AVX512_FUNCTIONS
+    if (cpuHasAvx512()) {
+        QTest::newRow("SourceOver, AVX-512") << CompositionFunctionSolid(comp_func_solid_SourceOver)
+                                             << CompositionFunctionSolid(comp_func_solid_SourceOver_avx512);
+        QTest::newRow("Plus, AVX-512") << CompositionFunctionSolid(comp_func_solid_Plus)
+                                       << CompositionFunctionSolid(comp_func_solid_Plus_avx512);
+        QTest::newRow("Multiply, AVX-512") << CompositionFunctionSolid(comp_func_solid_Multiply)
+                                           << CompositionFunctionSolid(comp_func_solid_Multiply_avx512);
+        hasRows = true;
+    }
+#endif
+    if (!hasRows)
+        QSKIP("This CPU or build has no SIMD composition functions to test");
+#endif
+}
+
+void tst_QCompositionFunctions::rgb32Solid()
+{
+#ifdef HAVE_COMPOSITION_FUNCTIONS
+    QFETCH(CompositionFunctionSolid, generic);
+    QFETCH(CompositionFunctionSolid, simd);
+
+    const QVector<uint> dst = premultipliedPixels(3);
+    const uint colors[] = { 0x00000000, 0xff000000, 0xffffffff, 0x80402010, 0x7f7f7f7f, 0x01010000 };
+
+    for (uint color : colors) {
+        for (uint constAlpha : constAlphas) {
+            for (int length : lengths) {
+                for (int offset = 0; offset <= MaxOffset; ++offset) {
+                    QVector<uint> expected = dst;
+                    QVector<uint> actual = dst;
+                    generic(expected.data() + offset, length, color, constAlpha);
+                    simd(actual.data() + offset, length, color, constAlpha);
+                    QVERIFY2(actual == expected,
+                             (spanDescription(length, offset, constAlpha)
+                              + ", color 0x" + QByteArray::number(color, 16)).constData());
+                }
+            }
+        }
+    }
+#endif
+}
+
+void tst_QCompositionFunctions::rgb64_data()
+{
+#ifndef HAVE_COMPOSITION_FUNCTIONS
+    QSKIP("This build does not export the composition functions");
+#else
+    QTest::addColumn<CompositionFunction64>("generic");
+    QTest::addColumn<CompositionFunction64>("simd");
+
+    bool hasRows = false;
+#ifdef HAVE_AVX2_FUNCTIONS
+    if (qCpuHasFeature(AVX2)) {
+        QTest::newRow("SourceOver, AVX2") << CompositionFunction64(comp_func_SourceOver_rgb64)
+                                          << CompositionFunction64(comp_func_SourceOver_rgb64_avx2);
+        QTest::newRow("Source, AVX2") << CompositionFunction64(comp_func_Source_rgb64)
+                                      << CompositionFunction64(comp_func_Source_rgb64_avx2);
+        QTest::newRow("Plus, AVX2") << CompositionFunction64(comp_func_Plus_rgb64)
+                                    << CompositionFunction64(comp_func_Plus_rgb64_avx2);
+        hasRows = true;
+    }
+#endif
+    if (!hasRows)
+        QSKIP("This CPU or build has no SIMD composition functions to test");
+#endif
+}
+
+void tst_QCompositionFunctions::rgb64()
+{
+#ifdef HAVE_COMPOSITION_FUNCTIONS
+    QFETCH(CompositionFunction64, generic);
+    QFETCH(CompositionFunction64, simd);
+
+    const QVector<QRgba64> src = premultipliedPixels64(4);
+    const QVector<QRgba64> dst = premultipliedPixels64(5);
+
+    for (uint constAlpha : constAlphas) {
+        for (int length : lengths) {
+            for (int offset = 0; offset <= MaxOffset; ++offset) {
+                QVector<QRgba64> expected = dst;
+                QVector<QRgba64> actual = dst;
+                generic(expected.data() + offset, src.constData() + MaxOffset - offset, length, constAlpha);
+                simd(actual.data() + offset, src.constData() + MaxOffset - offset, length, constAlpha);
+                QVERIFY2(actual == expected, spanDescription(length, offset, constAlpha).constData());
+            }
+        }
+    }
+#endif
+}
+
+void tst_QCompositionFunctions::rgb64Solid_data()
+{
+#ifndef HAVE_COMPOSITION_FUNCTIONS
+    QSKIP("This build does not export the composition functions");
+#else
+    QTest::addColumn<CompositionFunctionSolid64>("generic");
+    QTest::addColumn<CompositionFunctionSolid64>("simd");
+
+    bool hasRows = false;
+#ifdef HAVE_AVX2_FUNCTIONS
+    if (qCpuHasFeature(AVX2)) {
+        QTest::newRow("SourceOver, AVX2") << CompositionFunctionSolid64(comp_func_solid_SourceOver_rgb64)
+                                          << CompositionFunctionSolid64(comp_func_solid_SourceOver_rgb64_avx2);
+        QTest::newRow("Plus, AVX2") << CompositionFunctionSolid64(comp_func_solid_Plus_rgb64)
+                                    << CompositionFunctionSolid64(comp_func_solid_Plus_rgb64_avx2);
+        hasRows = true;
+    }
+#endif
+    if (!hasRows)
+        QSKIP("This CPU or build has no SIMD composition functions to test");
+#endif
+}
+
+void tst_QCompositionFunctions::rgb64Solid()
+{
+#ifdef HAVE_COMPOSITION_FUNCTIONS
+    QFETCH(CompositionFunctionSolid64, generic);
+    QFETCH(CompositionFunctionSolid64, simd);
+
+    const QVector<QRgba64> dst = premultipliedPixels64(6);
+    const QRgba64 colors[] = {
+        qRgba64(0, 0, 0, 0), qRgba64(0, 0, 0, 65535), qRgba64(65535, 65535, 65535, 65535),
+        qRgba64(32768, 16384, 8192, 32768), qRgba64(32767, 32767, 32767, 32767), qRgba64(257, 257, 0, 257)
+    };
+
+    for (QRgba64 color : colors) {
+        for (uint constAlpha : constAlphas) {
+            for (int length : lengths) {
+                for (int offset = 0; offset <= MaxOffset; ++offset) {
+                    QVector<QRgba64> expected = dst;
+                    QVector<QRgba64> actual = dst;
+                    generic(expected.data() + offset, length, color, constAlpha);
+                    simd(actual.data() + offset, length, color, constAlpha);
+                    QVERIFY2(actual == expected,
+                             (spanDescription(length, offset, constAlpha)
+                              + ", color 0x" + QByteArray::number(quint64(color), 16)).constData());
+                }
+            }
+        }
+    }
+#endif
+}
+
+QTEST_MAIN(tst_QCompositionFunctions)
+
+#include "tst_qcompositionfunctions.moc"
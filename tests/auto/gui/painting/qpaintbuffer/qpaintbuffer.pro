@@ -0,0 +1,4 @@
+CONFIG += testcase
+TARGET = tst_qpaintbuffer
+QT += gui-private testlib
+SOURCES += tst_qpaintbuffer.cpp
@@ -0,0 +1,576 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <qbitmap.h>
+#include <qimage.h>
+#include <qpaintbuffer.h>
+#include <qpainter.h>
+#include <qpainterpath.h>
+#include <qpixmap.h>
+#include <qthread.h>
+
+#include <private/qpaintbuffer_p.h>
+
+typedef void (*PaintFunction)(QPainter *painter);
+Q_DECLARE_METATYPE(PaintFunction)
+
+class tst_QPaintBuffer : public QObject
+{
+Q_OBJECT
+
+private slots:
+    void empty();
+    void boundingRect();
+    void implicitSharing();
+
+    void sameAsDirect_data();
+    void sameAsDirect();
+    void transformedPainter_data();
+    void transformedPainter();
+
+    void culling();
+    void cullingRegion();
+    void cullingCosmeticPen();
+    void mergedStates();
+
+    void text();
+};
+
+void tst_QPaintBuffer::empty()
+{
+    QPaintBuffer buffer;
+    QVERIFY(buffer.isEmpty());
+    QCOMPARE(buffer.boundingRect(), QRectF());
+    QCOMPARE(buffer.devType(), int(QInternal::PaintBuffer));
+
+    QImage image(10, 10, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    buffer.play(&painter);
+    buffer.play(&painter, QRectF(0, 0, 10, 10));
+    painter.end();
+    QCOMPARE(image.pixel(5, 5), qRgb(255, 255, 255));
+}
+
+void tst_QPaintBuffer::boundingRect()
+{
+    QPaintBuffer buffer;
+    {
+        QPainter painter(&buffer);
+        QCOMPARE(painter.paintEngine()->type(), QPaintEngine::PaintBuffer);
+        painter.fillRect(10, 20, 30, 40, Qt::red);
+        painter.translate(100, 100);
+        painter.setPen(QPen(Qt::black, 10));
+        painter.drawLine(0, 0, 50, 0);
+    }
+
+    QVERIFY(!buffer.isEmpty());
+    const QRectF bounds = buffer.boundingRect();
+    QVERIFY(bounds.contains(QRectF(10, 20, 30, 40)));
+    QVERIFY(bounds.contains(QRectF(95, 95, 60, 10)));
+    QVERIFY(bounds.left() > 0);
+    QVERIFY(bounds.top() > 10);
+    QVERIFY(bounds.right() < 170);
+    QVERIFY(bounds.bottom() < 120);
+    QCOMPARE(buffer.width(), bounds.toAlignedRect().width());
+    QCOMPARE(buffer.height(), bounds.toAlignedRect().height());
+}
+
+void tst_QPaintBuffer::implicitSharing()
+{
+    QPaintBuffer buffer;
+    {
+        QPainter painter(&buffer);
+        painter.fillRect(0, 0, 10, 10, Qt::red);
+    }
+
+    QPaintBuffer copy = buffer;
+    QCOMPARE(QPaintBufferPrivate::get(&copy), QPaintBufferPrivate::get(&buffer));
+
+    // Painting starts over on a detached buffer
+    {
+        QPainter painter(&copy);
+        painter.fillRect(0, 0, 10, 10, Qt::blue);
+        painter.fillRect(20, 0, 10, 10, Qt::blue);
+    }
+    QVERIFY(QPaintBufferPrivate::get(&copy) != QPaintBufferPrivate::get(&buffer));
+    QCOMPARE(QPaintBufferPrivate::get(&buffer)->commands.size(), 1);
+    QCOMPARE(QPaintBufferPrivate::get(&copy)->commands.size(), 2);
+
+    copy.clear();
+    QVERIFY(copy.isEmpty());
+    QVERIFY(!buffer.isEmpty());
+
+    QPaintBuffer moved;
+    moved = std::move(buffer);
+    QVERIFY(!moved.isEmpty());
+}
+
+static void paintShapes(QPainter *p)
+{
+    p->fillRect(10, 10, 300, 200, Qt::red);
+    p->setPen(QPen(Qt::blue, 7, Qt::DashLine, Qt::SquareCap, Qt::MiterJoin));
+    p->drawLine(0, 0, 400, 300);
+    p->drawRect(QRectF(50.5, 60.25, 200, 150));
+    p->setPen(QPen(Qt::green, 0));
+    p->drawPoints(QPolygon() << QPoint(5, 5) << QPoint(399, 299) << QPoint(200, 150));
+    p->setBrush(QColor(0, 0, 255, 128));
+    p->drawEllipse(QPointF(200, 150), 120, 90);
+    p->drawEllipse(QRect(20, 200, 60, 40));
+    p->drawPolyline(QPolygon() << QPoint(10, 290) << QPoint(390, 10) << QPoint(390, 290));
+    p->drawPolygon(QPolygonF() << QPointF(300, 20) << QPointF(380, 60) << QPointF(320, 120), Qt::WindingFill);
+}
+
+static void paintAntialiased(QPainter *p)
+{
+    p->setRenderHint(QPainter::Antialiasing);
+    p->setBrush(QColor(0, 128, 255, 200));
+    p->setPen(QPen(Qt::black, 3.5));
+    QPainterPath path;
+    path.moveTo(20, 280);
+    path.cubicTo(100, -100, 300, 400, 380, 20);
+    path.lineTo(380, 280);
+    path.closeSubpath();
+    path.addEllipse(QRectF(150, 100, 100, 80));
+    p->drawPath(path);
+    p->setOpacity(0.5);
+    p->drawConvexPolygon(QPolygonF() << QPointF(0.5, 0.5) << QPointF(399.5, 150) << QPointF(0.5, 299.5));
+    p->drawLines(QVector<QLineF>() << QLineF(10.5, 20.25, 390, 280) << QLineF(390, 20, 10, 280));
+}
+
+static void paintGradient(QPainter *p)
+{
+    QLinearGradient gradient(0, 0, 400, 300);
+    gradient.setColorAt(0, Qt::yellow);
+    gradient.setColorAt(1, QColor(0, 128, 255, 200));
+    p->fillRect(0, 0, 400, 300, gradient);
+    QRadialGradient radial(200, 150, 150);
+    radial.setColorAt(0, Qt::transparent);
+    radial.setColorAt(1, Qt::darkRed);
+    p->setRenderHint(QPainter::Antialiasing);
+    p->setBrush(radial);
+    p->drawEllipse(QPointF(200, 150), 150, 120);
+}
+
+static void paintImages(QPainter *p)
+{
+    QImage image(40, 30, QImage::Format_ARGB32_Premultiplied);
+    image.fill(QColor(255, 0, 0, 128));
+    QPixmap pixmap(16, 16);
+    pixmap.fill(Qt::darkGreen);
+
+    p->drawImage(QPointF(10, 10), image);
+    p->setRenderHint(QPainter::SmoothPixmapTransform);
+    p->save();
+    p->translate(200, 150);
+    p->rotate(30);
+    p->drawImage(QRectF(-50, -40, 100, 80), image);
+    p->restore();
+    for (int i = 0; i < 10; ++i)
+        p->drawPixmap(20 * i, 250, pixmap);
+    p->drawTiledPixmap(QRectF(300, 10, 90, 70), pixmap, QPointF(3, 5));
+
+    QBitmap bitmap(20, 20);
+    bitmap.fill(Qt::color0);
+    {
+        QPainter bitmapPainter(&bitmap);
+        bitmapPainter.drawLine(0, 0, 19, 19);
+    }
+    p->setPen(Qt::blue);
+    p->setBackground(Qt::yellow);
+    p->setBackgroundMode(Qt::OpaqueMode);
+    p->drawPixmap(360, 250, bitmap);
+}
+
+static void paintTransformed(QPainter *p)
+{
+    p->translate(200, 150);
+    p->rotate(30);
+    p->scale(1.5, 0.75);
+    p->setBrush(QBrush(Qt::darkGreen, Qt::DiagCrossPattern));
+    p->drawRect(-100, -80, 200, 160);
+    p->setTransform(QTransform(1, 0, 0.0005, 0.8, 0, 0.0002, 0, 0, 1), true);
+    p->setBrush(QColor(255, 0, 255, 100));
+    p->drawRect(-80, -60, 160, 120);
+}
+
+static void paintClipped(QPainter *p)
+{
+    p->setClipRect(40, 30, 300, 200);
+    p->fillRect(0, 0, 400, 300, Qt::cyan);
+
+    p->save();
+    QPainterPath path;
+    path.addEllipse(QRectF(100, 50, 250, 220));
+    p->rotate(10);
+    p->setClipPath(path, Qt::IntersectClip);
+    p->fillRect(0, 0, 400, 300, Qt::magenta);
+    p->restore();
+
+    p->setPen(QPen(Qt::black, 4));
+    p->drawLine(0, 150, 400, 150);
+
+    p->setClipRegion(QRegion(0, 0, 150, 150) + QRegion(250, 150, 150, 150), Qt::ReplaceClip);
+    p->fillRect(0, 0, 400, 300, QColor(0, 0, 0, 100));
+
+    p->setClipping(false);
+    p->drawLine(0, 0, 400, 300);
+}
+
+static void paintNestedClips(QPainter *p)
+{
+    p->fillRect(0, 0, 400, 300, Qt::yellow);
+    p->save();
+    p->setClipRect(QRectF(20.5, 20.5, 250, 200), Qt::IntersectClip);
+    p->fillRect(0, 0, 400, 300, Qt::green);
+    p->save();
+    p->rotate(20);
+    p->setClipRegion(QRegion(100, 0, 200, 100, QRegion::Ellipse), Qt::IntersectClip);
+    p->fillRect(0, 0, 400, 300, Qt::blue);
+    p->restore();
+    p->fillRect(200, 150, 100, 100, Qt::red);
+    p->restore();
+    p->fillRect(250, 200, 100, 100, Qt::black);
+}
+
+static void paintCompositionModes(QPainter *p)
+{
+    p->fillRect(0, 0, 400, 300, QColor(255, 255, 0, 200));
+    p->setCompositionMode(QPainter::CompositionMode_Source);
+    p->fillRect(100, 50, 200, 200, Qt::transparent);
+    p->setCompositionMode(QPainter::CompositionMode_Multiply);
+    p->fillRect(50, 100, 300, 100, QColor(0, 128, 255));
+    p->setCompositionMode(QPainter::CompositionMode_Clear);
+    p->drawEllipse(150, 100, 100, 100);
+}
+
+static QImage whiteImage()
+{
+    QImage image(400, 300, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    return image;
+}
+
+static QPaintBuffer record(PaintFunction paint)
+{
+    QPaintBuffer buffer;
+    QPainter painter(&buffer);
+    paint(&painter);
+    return buffer;
+}
+
+void tst_QPaintBuffer::sameAsDirect_data()
+{
+    QTest::addColumn<PaintFunction>("paint");
+
+    QTest::newRow("shapes") << PaintFunction(paintShapes);
+    QTest::newRow("antialiased") << PaintFunction(paintAntialiased);
+    QTest::newRow("gradient") << PaintFunction(paintGradient);
+    QTest::newRow("images") << PaintFunction(paintImages);
+    QTest::newRow("transformed") << PaintFunction(paintTransformed);
+    QTest::newRow("clipped") << PaintFunction(paintClipped);
+    QTest::newRow("nestedClips") << PaintFunction(paintNestedClips);
+    QTest::newRow("compositionModes") << PaintFunction(paintCompositionModes);
+}
+
+void tst_QPaintBuffer::sameAsDirect()
+{
+    QFETCH(PaintFunction, paint);
+
+    QImage expected = whiteImage();
+    {
+        QPainter painter(&expected);
+        paint(&painter);
+    }
+
+    const QPaintBuffer buffer = record(paint);
+    QImage actual = whiteImage();
+    {
+        QPainter painter(&actual);
+        buffer.play(&painter);
+        // The state of the painter is left alone
+        QCOMPARE(painter.pen(), QPen());
+        QCOMPARE(painter.transform(), QTransform());
+        QVERIFY(!painter.hasClipping());
+    }
+    QCOMPARE(actual, expected);
+
+    // Playing twice applies the whole state again
+    QImage twice = whiteImage();
+    QImage twiceExpected = whiteImage();
+    {
+        QPainter painter(&twice);
+        buffer.play(&painter);
+        buffer.play(&painter);
+        QPainter expectedPainter(&twiceExpected);
+        paint(&expectedPainter);
+        expectedPainter.end();
+        expectedPainter.begin(&twiceExpected);
+        paint(&expectedPainter);
+    }
+    QCOMPARE(twice, twiceExpected);
+}
+
+void tst_QPaintBuffer::transformedPainter_data()
+{
+    QTest::addColumn<PaintFunction>("paint");
+
+    QTest::newRow("shapes") << PaintFunction(paintShapes);
+    QTest::newRow("antialiased") << PaintFunction(paintAntialiased);
+    QTest::newRow("images") << PaintFunction(paintImages);
+    QTest::newRow("nestedClips") << PaintFunction(paintNestedClips);
+}
+
+void tst_QPaintBuffer::transformedPainter()
+{
+    QFETCH(PaintFunction, paint);
+
+    // The buffer is played in the coordinate system and clip of the painter
+    const auto setUp = [](QPainter *painter) {
+        painter->setClipRect(30, 20, 300, 250);
+        painter->translate(40, 10);
+        painter->scale(0.75, 0.5);
+    };
+
+    QImage expected = whiteImage();
+    {
+        QPainter painter(&expected);
+        setUp(&painter);
+        paint(&painter);
+    }
+
+    const QPaintBuffer buffer = record(paint);
+    QImage actual = whiteImage();
+    {
+        QPainter painter(&actual);
+        setUp(&painter);
+        buffer.play(&painter);
+    }
+    QCOMPARE(actual, expected);
+}
+
+static void paintGrid(QPainter *p)
+{
+    for (int y = 0; y < 300; y += 10) {
+        for (int x = 0; x < 400; x += 10)
+            p->fillRect(x + 1, y + 1, 8, 8, QColor(x * 255 / 400, y * 255 / 300, 128));
+    }
+}
+
+void tst_QPaintBuffer::culling()
+{
+    const QPaintBuffer buffer = record(paintGrid);
+    const QRect exposed(95, 95, 50, 30);
+
+    QImage expected = whiteImage();
+    {
+        QPainter painter(&expected);
+        painter.setClipRect(exposed);
+        buffer.play(&painter);
+    }
+
+    QImage culled = whiteImage();
+    {
+        QPainter painter(&culled);
+        buffer.play(&painter, QRectF(exposed));
+    }
+    QCOMPARE(culled.copy(exposed), expected.copy(exposed));
+    // Far away commands are skipped
+    QCOMPARE(culled.pixel(5, 5), qRgb(255, 255, 255));
+    QCOMPARE(culled.pixel(395, 295), qRgb(255, 255, 255));
+
+    // The exposed rectangle is given in logical coordinates
+    QImage scaled = whiteImage();
+    {
+        QPainter painter(&scaled);
+        painter.translate(100, 0);
+        painter.scale(0.5, 0.5);
+        buffer.play(&painter, QRectF(exposed));
+    }
+    QVERIFY(scaled.pixel(100 + 125 / 2, 115 / 2) != qRgb(255, 255, 255));
+    QCOMPARE(scaled.pixel(100 + 300 / 2, 250 / 2), qRgb(255, 255, 255));
+}
+
+void tst_QPaintBuffer::cullingRegion()
+{
+    const QPaintBuffer buffer = record(paintGrid);
+    const QRegion exposed = QRegion(20, 20, 40, 40) + QRegion(300, 200, 30, 60);
+
+    QImage expected = whiteImage();
+    {
+        QPainter painter(&expected);
+        painter.setClipRegion(exposed);
+        buffer.play(&painter);
+    }
+
+    QImage actual = whiteImage();
+    {
+        QPainter painter(&actual);
+        painter.setClipRegion(exposed);
+        buffer.play(&painter, exposed);
+    }
+    QCOMPARE(actual, expected);
+
+    QImage culled = whiteImage();
+    {
+        QPainter painter(&culled);
+        buffer.play(&painter, exposed);
+    }
+    QCOMPARE(culled.pixel(200, 150), qRgb(255, 255, 255));
+    QCOMPARE(culled.pixel(35, 35), expected.pixel(35, 35));
+    QCOMPARE(culled.pixel(315, 245), expected.pixel(315, 245));
+
+    QImage nothing = whiteImage();
+    {
+        QPainter painter(&nothing);
+        buffer.play(&painter, QRegion());
+    }
+    QCOMPARE(nothing, whiteImage());
+}
+
+void tst_QPaintBuffer::cullingCosmeticPen()
+{
+    // Cosmetic pens keep their width when the buffer is scaled down, so they
+    // reach further into the exposed area than their logical bounds
+    QPaintBuffer buffer;
+    {
+        QPainter painter(&buffer);
+        QPen pen(Qt::black, 6);
+        pen.setCosmetic(true);
+        painter.setPen(pen);
+        painter.drawLine(0, 100, 400, 100);
+    }
+
+    QImage image = whiteImage();
+    {
+        QPainter painter(&image);
+        painter.scale(0.25, 0.25);
+        buffer.play(&painter, QRectF(0, 104, 400, 4));
+    }
+    QVERIFY(image.pixel(50, 26) != qRgb(255, 255, 255));
+}
+
+void tst_QPaintBuffer::mergedStates()
+{
+    QPaintBuffer buffer;
+    {
+        QPainter painter(&buffer);
+        painter.setPen(Qt::red);
+        painter.setPen(Qt::blue);
+        painter.setBrush(Qt::green);
+        painter.drawRect(0, 0, 10, 10);
+
+        // Changed and changed back before the next command
+        painter.setPen(Qt::red);
+        painter.setPen(Qt::blue);
+        painter.save();
+        painter.translate(10, 10);
+        painter.restore();
+        painter.drawRect(10, 0, 10, 10);
+
+        painter.setOpacity(0.5);
+        painter.drawRect(20, 0, 10, 10);
+        painter.drawRect(30, 0, 10, 10);
+    }
+
+    const QPaintBufferPrivate *d = QPaintBufferPrivate::get(&buffer);
+    QCOMPARE(d->commands.size(), 4);
+    QCOMPARE(d->states.size(), 2);
+    QCOMPARE(d->commands.at(0).state, 0);
+    QCOMPARE(d->commands.at(1).state, 0);
+    QCOMPARE(d->commands.at(2).state, 1);
+    QCOMPARE(d->commands.at(3).state, 1);
+
+    const QPaintBufferState &first = d->states.at(0);
+    const QPaintBufferState &second = d->states.at(1);
+    QCOMPARE(first.pen.color(), QColor(Qt::blue));
+    QCOMPARE(second.opacity, 0.5);
+    QCOMPARE(second.serials[QPaintBufferState::PenGroup], first.serials[QPaintBufferState::PenGroup]);
+    QCOMPARE(second.serials[QPaintBufferState::TransformGroup], first.serials[QPaintBufferState::TransformGroup]);
+    QVERIFY(second.serials[QPaintBufferState::OpacityGroup] != first.serials[QPaintBufferState::OpacityGroup]);
+}
+
+static void paintText(QPainter *p)
+{
+    QFont font;
+    font.setPixelSize(20);
+    font.setUnderline(true);
+    p->setFont(font);
+    p->setPen(Qt::darkBlue);
+    p->drawText(20, 40, QStringLiteral("Display lists"));
+    p->rotate(10);
+    p->drawText(QRectF(40, 60, 300, 100), Qt::AlignCenter | Qt::TextWordWrap,
+                QStringLiteral("replayed without laying out the text again"));
+}
+
+class PlayThread : public QThread
+{
+public:
+    PlayThread(const QPaintBuffer &buffer, QImage *image) : buffer(buffer), image(image) {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        QPainter painter(image);
+        buffer.play(&painter);
+    }
+
+    QPaintBuffer buffer;
+    QImage *image;
+};
+
+void tst_QPaintBuffer::text()
+{
+    QImage expected = whiteImage();
+    {
+        QPainter painter(&expected);
+        paintText(&painter);
+    }
+    if (expected == whiteImage())
+        QSKIP("No fonts available");
+
+    const QPaintBuffer buffer = record(paintText);
+    QImage actual = whiteImage();
+    {
+        QPainter painter(&actual);
+        buffer.play(&painter);
+    }
+    QCOMPARE(actual, expected);
+
+    // Other threads lay out the text again
+    QImage threaded = whiteImage();
+    PlayThread thread(buffer, &threaded);
+    thread.start();
+    QVERIFY(thread.wait());
+    QCOMPARE(threaded, expected);
+}
+
+QTEST_MAIN(tst_QPaintBuffer)
+#include "tst_qpaintbuffer.moc"
@@ -38,6 +38,7 @@
 #include <qbitmap.h>
 #include <qimage.h>
 #include <qthread.h>
+#include <qthreadpool.h>
 #include <limits.h>
 #include <math.h>
 #include <qpaintengine.h>
@@ -47,6 +48,7 @@
 #include <qpixmap.h>
 
 #include <private/qdrawhelper_p.h>
+#include <private/qpaintengine_raster_p.h>
 #include <qpainter.h>
 
 #ifndef QT_NO_WIDGETS
@@ -195,6 +197,9 @@ private slots:
     void linearGradientRgb30();
     void radialGradientRgb30_data();
     void radialGradientRgb30();
+    void multiStopGradientRgb30();
+    void gradientOpacity_data();
+    void gradientOpacity();
 
     void fpe_pixmapTransform();
     void fpe_zeroLengthLines();
@@ -269,6 +274,11 @@ private slots:
     void drawPointScaled();
 
     void QTBUG14614_gradientCacheRaceCondition();
+    void parallelCosmeticLines_data();
+    void parallelCosmeticLines();
+    void parallelPolylines();
+    void parallelFillPaths_data();
+    void parallelFillPaths();
     void drawTextOpacity();
 
     void QTBUG17053_zeroDashPattern();
@@ -4010,6 +4020,122 @@ void tst_QPainter::radialGradientRgb30()
     }
 }
 
+void tst_QPainter::multiStopGradientRgb30()
+{
+    QLinearGradient gradient(0, 0, 1000, 1);
+    gradient.setColorAt(0.0, Qt::white);
+    gradient.setColorAt(0.5, QColor(Qt::white).darker(200));
+    gradient.setColorAt(1.0, Qt::black);
+
+    QImage image(1000, 1, QImage::Format_RGB30);
+    QPainter painter(&image);
+    painter.fillRect(image.rect(), gradient);
+    painter.end();
+
+    int distinct = 1;
+    for (int i = 1; i < 1000; ++i) {
+        QColor p1 = image.pixelColor(i - 1, 0);
+        QColor p2 = image.pixelColor(i, 0);
+        QVERIFY(qGray(p1.rgb()) >= qGray(p2.rgb()));
+        if (p1 != p2)
+            ++distinct;
+    }
+    // The color table has 1024 entries, so every one of them should map
+    // to its own 10-bit value.
+    QVERIFY2(distinct > 900, QByteArray::number(distinct));
+}
+
+void tst_QPainter::gradientOpacity_data()
+{
+    QTest::addColumn<QImage::Format>("format");
+    QTest::addColumn<int>("type");
+
+    const QImage::Format formats[] = {
+        QImage::Format_ARGB32_Premultiplied, QImage::Format_RGB32,
+        QImage::Format_RGB16, QImage::Format_RGB30
+    };
+    const char *types[] = { "vertical", "horizontal", "radial" };
+    for (QImage::Format format : formats) {
+        for (int type = 0; type < 3; ++type) {
+            QTest::newRow(QByteArray::number(int(format)) + ' ' + types[type])
+                << format << type;
+        }
+    }
+}
+
+void tst_QPainter::gradientOpacity()
+{
+    QFETCH(QImage::Format, format);
+    QFETCH(int, type);
+
+    const qreal opacity = 0.4;
+    QGradientStops stops;
+    stops << qMakePair(qreal(0.0), QColor(Qt::blue));
+    stops << qMakePair(qreal(0.3), QColor(255, 0, 0, 128));
+    stops << qMakePair(qreal(0.6), QColor(Qt::green));
+    stops << qMakePair(qreal(1.0), QColor(Qt::black));
+
+    // The same gradient with the opacity folded into the stop colors
+    QGradientStops bakedStops;
+    for (const QGradientStop &stop : qAsConst(stops)) {
+        QColor color = stop.second;
+        color.setAlphaF(color.alphaF() * opacity);
+        bakedStops << qMakePair(stop.first, color);
+    }
+
+    QImage a(64, 64, format);
+    QImage b(64, 64, format);
+    a.fill(Qt::white);
+    b.fill(Qt::white);
+
+    QGradient *gradient = 0;
+    QGradient *bakedGradient = 0;
+    switch (type) {
+    case 0:
+        gradient = new QLinearGradient(0, 0, 0, 64);
+        bakedGradient = new QLinearGradient(0, 0, 0, 64);
+        break;
+    case 1:
+        gradient = new QLinearGradient(0, 0, 64, 0);
+        bakedGradient = new QLinearGradient(0, 0, 64, 0);
+        break;
+    default:
+        gradient = new QRadialGradient(32, 32, 32);
+        bakedGradient = new QRadialGradient(32, 32, 32);
+        break;
+    }
+    gradient->setStops(stops);
+    bakedGradient->setStops(bakedStops);
+
+    QPainter pa(&a);
+    pa.setOpacity(opacity);
+    pa.fillRect(a.rect(), *gradient);
+    pa.end();
+
+    QPainter pb(&b);
+    pb.fillRect(b.rect(), *bakedGradient);
+    pb.end();
+
+    delete gradient;
+    delete bakedGradient;
+
+    // Opacity is applied to 8-bit coverage at blend time instead of to the
+    // 16-bit stop colors, allow for the difference in rounding; for RGB16 that
+    // is one step of the 5-bit channels.
+    const int tolerance = format == QImage::Format_RGB16 ? 9 : 3;
+    for (int y = 0; y < a.height(); ++y) {
+        for (int x = 0; x < a.width(); ++x) {
+            const QRgb pa = a.pixel(x, y);
+            const QRgb pb = b.pixel(x, y);
+            QVERIFY2(qAbs(qRed(pa) - qRed(pb)) <= tolerance
+                     && qAbs(qGreen(pa) - qGreen(pb)) <= tolerance
+                     && qAbs(qBlue(pa) - qBlue(pb)) <= tolerance,
+                     qPrintable(QString::fromLatin1("(%1, %2): %3 != %4").arg(x).arg(y)
+                                .arg(pa, 8, 16).arg(pb, 8, 16)));
+        }
+    }
+}
+
 void tst_QPainter::drawPolygon()
 {
     QImage img(128, 128, QImage::Format_ARGB32_Premultiplied);
@@ -4623,6 +4749,174 @@ void tst_QPainter::QTBUG14614_gradientCacheRaceCondition()
         producers[i].wait();
 }
 
+class MaxThreadCountChanger
+{
+public:
+    explicit MaxThreadCountChanger(int count)
+        : m_oldCount(QThreadPool::globalInstance()->maxThreadCount())
+    { QThreadPool::globalInstance()->setMaxThreadCount(count); }
+    ~MaxThreadCountChanger() { QThreadPool::globalInstance()->setMaxThreadCount(m_oldCount); }
+private:
+    int m_oldCount;
+};
+
+static QVector<QLineF> randomLines(int count, const QSizeF &size)
+{
+    QVector<QLineF> lines;
+    lines.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const QPointF p1(qrand() % int(size.width() * 10) / 10., qrand() % int(size.height() * 10) / 10.);
+        const QPointF p2 = p1 + QPointF(qrand() % 600 / 10. - 30, qrand() % 600 / 10. - 30);
+        lines << QLineF(p1, p2);
+    }
+    return lines;
+}
+
+void tst_QPainter::parallelCosmeticLines_data()
+{
+    QTest::addColumn<QImage::Format>("format");
+    QTest::addColumn<bool>("antialiased");
+    QTest::addColumn<bool>("dashed");
+    QTest::addColumn<bool>("clipped");
+
+    QTest::newRow("argb32pm aliased") << QImage::Format_ARGB32_Premultiplied << false << false << false;
+    QTest::newRow("argb32pm antialiased") << QImage::Format_ARGB32_Premultiplied << true << false << false;
+    QTest::newRow("argb32pm dashed") << QImage::Format_ARGB32_Premultiplied << true << true << false;
+    QTest::newRow("argb32pm clipped") << QImage::Format_ARGB32_Premultiplied << true << false << true;
+    QTest::newRow("rgb16 antialiased") << QImage::Format_RGB16 << true << false << false;
+    QTest::newRow("rgb888 antialiased") << QImage::Format_RGB888 << true << false << false;
+    QTest::newRow("rgb888 clipped") << QImage::Format_RGB888 << false << true << true;
+}
+
+void tst_QPainter::parallelCosmeticLines()
+{
+    QFETCH(QImage::Format, format);
+    QFETCH(bool, antialiased);
+    QFETCH(bool, dashed);
+    QFETCH(bool, clipped);
+
+    MaxThreadCountChanger threadCount(4);
+
+    qsrand(1);
+    const QVector<QLineF> lines = randomLines(20000, QSizeF(400, 300));
+
+    QImage batched(400, 300, format);
+    QImage serial(400, 300, format);
+    batched.fill(Qt::white);
+    serial.fill(Qt::white);
+
+    QPen pen(QColor(0, 0, 255, 100), 0);
+    if (dashed)
+        pen.setStyle(Qt::DashDotLine);
+
+    for (QImage *image : { &batched, &serial }) {
+        QPainter p(image);
+        p.setRenderHint(QPainter::Antialiasing, antialiased);
+        p.setPen(pen);
+        p.translate(5.5, -3);
+        if (clipped)
+            p.setClipRect(37, 41, 300, 199);
+        if (image == &batched) {
+            p.drawLines(lines);
+        } else {
+            // small batches are drawn one line after the other
+            for (int i = 0; i < lines.size(); i += 100)
+                p.drawLines(lines.constData() + i, qMin(100, lines.size() - i));
+        }
+    }
+
+    QCOMPARE(batched, serial);
+}
+
+void tst_QPainter::parallelPolylines()
+{
+    MaxThreadCountChanger threadCount(4);
+
+    qsrand(2);
+    QVector<QPolygonF> polylines;
+    for (int i = 0; i < 5000; ++i) {
+        QPolygonF polyline;
+        QPointF p(qrand() % 400, qrand() % 300);
+        for (int j = 0; j < 5; ++j) {
+            polyline << p;
+            p += QPointF(qrand() % 40 - 20, qrand() % 40 - 20);
+        }
+        polylines << polyline;
+    }
+
+    QImage batched(400, 300, QImage::Format_ARGB32_Premultiplied);
+    QImage serial(400, 300, QImage::Format_ARGB32_Premultiplied);
+    batched.fill(Qt::white);
+    serial.fill(Qt::white);
+
+    QPainter p(&batched);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setPen(QPen(QColor(255, 0, 0, 128), 0));
+    static_cast<QRasterPaintEngine *>(p.paintEngine())->drawPolylines(polylines.constData(), polylines.size());
+    p.end();
+
+    p.begin(&serial);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setPen(QPen(QColor(255, 0, 0, 128), 0));
+    for (const QPolygonF &polyline : qAsConst(polylines))
+        p.drawPolyline(polyline);
+    p.end();
+
+    QCOMPARE(batched, serial);
+}
+
+void tst_QPainter::parallelFillPaths_data()
+{
+    QTest::addColumn<bool>("antialiased");
+
+    QTest::newRow("aliased") << false;
+    QTest::newRow("antialiased") << true;
+}
+
+void tst_QPainter::parallelFillPaths()
+{
+    QFETCH(bool, antialiased);
+
+    MaxThreadCountChanger threadCount(4);
+
+    qsrand(3);
+    QVector<QPainterPath> paths;
+    for (int i = 0; i < 5000; ++i) {
+        QPainterPath path;
+        const QPointF center(qrand() % 400, qrand() % 300);
+        if (i % 2)
+            path.addEllipse(center, qrand() % 20 + 1, qrand() % 20 + 1);
+        else
+            path.addPolygon(QPolygonF() << center << center + QPointF(qrand() % 30, 5)
+                                        << center + QPointF(-5, qrand() % 30));
+        paths << path;
+    }
+
+    QImage batched(400, 300, QImage::Format_ARGB32_Premultiplied);
+    QImage serial(400, 300, QImage::Format_ARGB32_Premultiplied);
+    batched.fill(Qt::white);
+    serial.fill(Qt::white);
+
+    QPainter p(&batched);
+    p.setRenderHint(QPainter::Antialiasing, antialiased);
+    p.setPen(Qt::NoPen);
+    p.setBrush(QColor(0, 128, 0, 100));
+    p.rotate(3);
+    static_cast<QRasterPaintEngine *>(p.paintEngine())->fillPaths(paths.constData(), paths.size());
+    p.end();
+
+    p.begin(&serial);
+    p.setRenderHint(QPainter::Antialiasing, antialiased);
+    p.setPen(Qt::NoPen);
+    p.setBrush(QColor(0, 128, 0, 100));
+    p.rotate(3);
+    for (const QPainterPath &path : qAsConst(paths))
+        p.drawPath(path);
+    p.end();
+
+    QCOMPARE(batched, serial);
+}
+
 void tst_QPainter::drawTextOpacity()
 {
     QImage image(32, 32, QImage::Format_RGB32);
@@ -0,0 +1,4 @@
+CONFIG += testcase
+TARGET = tst_qtiledpaintdevice
+SOURCES  += tst_qtiledpaintdevice.cpp
+QT += testlib
@@ -0,0 +1,327 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <qimage.h>
+#include <qpainter.h>
+#include <qpainterpath.h>
+#include <qthreadpool.h>
+#include <qtiledpaintdevice.h>
+
+typedef void (*PaintFunction)(QPainter *painter);
+Q_DECLARE_METATYPE(PaintFunction)
+
+class tst_QTiledPaintDevice : public QObject
+{
+Q_OBJECT
+
+private slots:
+    void defaults();
+    void nullImage();
+
+    void sameAsDirect_data();
+    void sameAsDirect();
+    void threadCountIndependence_data();
+    void threadCountIndependence();
+
+    void monoImage();
+};
+
+void tst_QTiledPaintDevice::defaults()
+{
+    QImage image(100, 100, QImage::Format_ARGB32_Premultiplied);
+    image.setDotsPerMeterX(5000);
+    image.setDotsPerMeterY(2000);
+    QTiledPaintDevice device(&image);
+
+    QCOMPARE(device.image(), &image);
+    QCOMPARE(device.width(), image.width());
+    QCOMPARE(device.height(), image.height());
+    QCOMPARE(device.depth(), image.depth());
+    QCOMPARE(device.logicalDpiX(), image.logicalDpiX());
+    QCOMPARE(device.logicalDpiY(), image.logicalDpiY());
+    QCOMPARE(device.tileSize(), QSize(256, 256));
+    QCOMPARE(device.threadPool(), QThreadPool::globalInstance());
+
+    device.setTileSize(QSize(32, 64));
+    QCOMPARE(device.tileSize(), QSize(32, 64));
+    QTest::ignoreMessage(QtWarningMsg, "QTiledPaintDevice::setTileSize: Invalid tile size 0x10");
+    device.setTileSize(QSize(0, 10));
+    QCOMPARE(device.tileSize(), QSize(32, 64));
+
+    device.setThreadPool(0);
+    QVERIFY(!device.threadPool());
+}
+
+void tst_QTiledPaintDevice::nullImage()
+{
+    QImage image;
+    QTiledPaintDevice device(&image);
+    QTest::ignoreMessage(QtWarningMsg, "QTiledPaintEngine::begin: Cannot paint on a null image");
+    QTest::ignoreMessage(QtWarningMsg, "QPainter::begin(): Returned false");
+    QPainter painter;
+    QVERIFY(!painter.begin(&device));
+}
+
+static void paintShapes(QPainter *p)
+{
+    p->fillRect(10, 10, 300, 200, Qt::red);
+    p->setPen(QPen(Qt::blue, 7, Qt::DashLine, Qt::SquareCap, Qt::MiterJoin));
+    p->drawLine(0, 0, 400, 300);
+    p->drawRect(QRectF(50.5, 60.25, 200, 150));
+    p->setPen(QPen(Qt::green, 0));
+    p->drawPoints(QPolygon() << QPoint(5, 5) << QPoint(399, 299) << QPoint(200, 150));
+    p->setBrush(QColor(0, 0, 255, 128));
+    p->drawEllipse(QPointF(200, 150), 120, 90);
+    p->drawPolyline(QPolygon() << QPoint(10, 290) << QPoint(390, 10) << QPoint(390, 290));
+}
+
+static void paintAntialiased(QPainter *p)
+{
+    p->setRenderHint(QPainter::Antialiasing);
+    p->setBrush(QColor(0, 128, 255, 200));
+    p->setPen(QPen(Qt::black, 3.5));
+    QPainterPath path;
+    path.moveTo(20, 280);
+    path.cubicTo(100, -100, 300, 400, 380, 20);
+    path.lineTo(380, 280);
+    path.closeSubpath();
+    path.addEllipse(QRectF(150, 100, 100, 80));
+    p->drawPath(path);
+    p->setOpacity(0.5);
+    p->drawConvexPolygon(QPolygonF() << QPointF(0.5, 0.5) << QPointF(399.5, 150) << QPointF(0.5, 299.5));
+}
+
+static void paintGradient(QPainter *p)
+{
+    QLinearGradient gradient(0, 0, 400, 300);
+    gradient.setColorAt(0, Qt::yellow);
+    gradient.setColorAt(1, QColor(0, 128, 255, 200));
+    p->fillRect(0, 0, 400, 300, gradient);
+    QRadialGradient radial(200, 150, 150);
+    radial.setColorAt(0, Qt::transparent);
+    radial.setColorAt(1, Qt::darkRed);
+    p->setRenderHint(QPainter::Antialiasing);
+    p->setBrush(radial);
+    p->drawEllipse(QPointF(200, 150), 150, 120);
+}
+
+static void paintTransformed(QPainter *p)
+{
+    p->translate(200, 150);
+    p->rotate(30);
+    p->scale(1.5, 0.75);
+    p->setBrush(QBrush(Qt::darkGreen, Qt::DiagCrossPattern));
+    p->drawRect(-100, -80, 200, 160);
+
+    QImage source(40, 30, QImage::Format_ARGB32_Premultiplied);
+    source.fill(QColor(255, 0, 0, 128));
+    p->setRenderHint(QPainter::SmoothPixmapTransform);
+    p->drawImage(QRectF(-50, -40, 100, 80), source);
+}
+
+static void paintClipped(QPainter *p)
+{
+    p->setClipRect(40, 30, 300, 200);
+    p->fillRect(0, 0, 400, 300, Qt::cyan);
+
+    p->save();
+    QPainterPath path;
+    path.addEllipse(QRectF(100, 50, 250, 220));
+    p->rotate(10);
+    p->setClipPath(path, Qt::IntersectClip);
+    p->fillRect(0, 0, 400, 300, Qt::magenta);
+    p->restore();
+
+    p->setPen(QPen(Qt::black, 4));
+    p->drawLine(0, 150, 400, 150);
+
+    p->setClipRegion(QRegion(0, 0, 150, 150) + QRegion(250, 150, 150, 150), Qt::ReplaceClip);
+    p->fillRect(0, 0, 400, 300, QColor(0, 0, 0, 100));
+
+    p->setClipping(false);
+    p->drawLine(0, 0, 400, 300);
+}
+
+static void paintCompositionModes(QPainter *p)
+{
+    p->fillRect(0, 0, 400, 300, QColor(255, 255, 0, 200));
+    p->setCompositionMode(QPainter::CompositionMode_Source);
+    p->fillRect(100, 50, 200, 200, Qt::transparent);
+    p->setCompositionMode(QPainter::CompositionMode_Multiply);
+    p->fillRect(50, 100, 300, 100, QColor(0, 128, 255));
+    p->setCompositionMode(QPainter::CompositionMode_Clear);
+    p->drawEllipse(150, 100, 100, 100);
+}
+
+// Small shapes in different tiles, with state changes in between that
+// only some tiles draw with
+static void paintStateChanges(QPainter *p)
+{
+    for (int i = 0; i < 24; ++i) {
+        const QRect rect((i * 97) % 380, (i * 61) % 280, 20, 20);
+        switch (i % 4) {
+        case 0:
+            p->setBrush(QColor::fromHsv(i * 15, 255, 255));
+            break;
+        case 1:
+            p->setPen(QPen(QColor::fromHsv(i * 15, 255, 128), i % 5));
+            break;
+        case 2:
+            p->setOpacity(0.25 + (i % 3) * 0.25);
+            break;
+        case 3:
+            p->setClipRect(rect.adjusted(5, 5, 0, 0), (i / 4) % 2 ? Qt::ReplaceClip : Qt::NoClip);
+            break;
+        }
+        p->drawRect(rect);
+    }
+}
+
+struct Scene
+{
+    const char *name;
+    PaintFunction paint;
+};
+
+static void addScenes(const Scene *scenes, int count)
+{
+    QTest::addColumn<PaintFunction>("paint");
+    QTest::addColumn<QSize>("tileSize");
+    QTest::addColumn<int>("threadCount");
+
+    for (int i = 0; i < count; ++i) {
+        const Scene &scene = scenes[i];
+        QTest::newRow(QByteArray(scene.name).append(", serial").constData())
+            << scene.paint << QSize(64, 64) << 0;
+        QTest::newRow(QByteArray(scene.name).append(", odd tiles").constData())
+            << scene.paint << QSize(33, 17) << 3;
+        QTest::newRow(QByteArray(scene.name).append(", threads").constData())
+            << scene.paint << QSize(100, 100) << 4;
+    }
+}
+
+static QImage paintTiled(PaintFunction paint, const QSize &tileSize, int threadCount)
+{
+    QImage image(400, 300, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(qMax(threadCount, 1));
+    QTiledPaintDevice device(&image);
+    device.setTileSize(tileSize);
+    device.setThreadPool(threadCount ? &threadPool : 0);
+
+    QPainter painter(&device);
+    paint(&painter);
+    // Nothing is painted before the painter ends
+    if (image.pixel(200, 150) != qRgb(255, 255, 255))
+        return QImage();
+    painter.end();
+    return image;
+}
+
+void tst_QTiledPaintDevice::sameAsDirect_data()
+{
+    const Scene scenes[] = {
+        { "shapes", paintShapes },
+        { "antialiased", paintAntialiased },
+        { "clipped", paintClipped },
+        { "compositionModes", paintCompositionModes },
+        { "stateChanges", paintStateChanges }
+    };
+    addScenes(scenes, sizeof(scenes) / sizeof(scenes[0]));
+}
+
+void tst_QTiledPaintDevice::sameAsDirect()
+{
+    QFETCH(PaintFunction, paint);
+    QFETCH(QSize, tileSize);
+    QFETCH(int, threadCount);
+
+    QImage expected(400, 300, QImage::Format_ARGB32_Premultiplied);
+    expected.fill(Qt::white);
+    {
+        QPainter painter(&expected);
+        paint(&painter);
+    }
+
+    QCOMPARE(paintTiled(paint, tileSize, threadCount), expected);
+}
+
+void tst_QTiledPaintDevice::threadCountIndependence_data()
+{
+    // Gradients and transformed textures are fetched per span, so tile
+    // boundaries may round a few pixels differently than painting directly
+    const Scene scenes[] = {
+        { "shapes", paintShapes },
+        { "gradient", paintGradient },
+        { "transformed", paintTransformed },
+        { "clipped", paintClipped }
+    };
+    addScenes(scenes, sizeof(scenes) / sizeof(scenes[0]));
+}
+
+void tst_QTiledPaintDevice::threadCountIndependence()
+{
+    QFETCH(PaintFunction, paint);
+    QFETCH(QSize, tileSize);
+    QFETCH(int, threadCount);
+
+    const QImage expected = paintTiled(paint, tileSize, 0);
+    QVERIFY(!expected.isNull());
+    QCOMPARE(paintTiled(paint, tileSize, threadCount), expected);
+}
+
+void tst_QTiledPaintDevice::monoImage()
+{
+    QImage expected(203, 150, QImage::Format_Mono);
+    expected.fill(0);
+    QImage actual = expected.copy();
+
+    {
+        QPainter painter(&expected);
+        painter.setPen(QPen(Qt::color1, 3));
+        painter.drawEllipse(10, 10, 180, 130);
+    }
+
+    QTiledPaintDevice device(&actual);
+    device.setTileSize(QSize(10, 10));
+    {
+        QPainter painter(&device);
+        painter.setPen(QPen(Qt::color1, 3));
+        painter.drawEllipse(10, 10, 180, 130);
+    }
+
+    QCOMPARE(actual, expected);
+}
+
+QTEST_GUILESS_MAIN(tst_QTiledPaintDevice)
+#include "tst_qtiledpaintdevice.moc"
@@ -14,7 +14,8 @@ SUBDIRS=\
    qabstractnetworkcache \
    hpack \
    http2 \
-   hsts
+   hsts \
+   qdecompresshelper
 
 !qtConfig(private_tests): SUBDIRS -= \
           qhttpnetworkconnection \
@@ -22,4 +23,5 @@ SUBDIRS=\
           qftp \
           hpack \
           http2 \
-          hsts
+          hsts \
+          qdecompresshelper
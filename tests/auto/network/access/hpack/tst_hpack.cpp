@@ -71,6 +71,9 @@ private Q_SLOTS:
     void hpackDecodeResponse_data();
     void hpackDecodeResponse();
 
+    void hpackIndexingPolicy();
+    void huffmanBinaryData();
+
     // TODO: more-more-more tests needed!
 
 private:
@@ -847,6 +850,84 @@ void tst_Hpack::hpackDecodeResponse()
     }
 }
 
+void tst_Hpack::hpackIndexingPolicy()
+{
+    // Credentials, short cookies and per-request values must not
+    // end up in the dynamic table, other fields should.
+    const HttpHeader header = {{":method", "GET"},
+                               {":scheme", "https"},
+                               {":path", "/api/items"},
+                               {"authorization", "Basic dXNlcjpwYXNz"},
+                               {"cookie", "id=42"},
+                               {"content-length", "1024"},
+                               {"user-agent", "Mozilla/5.0"}};
+
+    Encoder encoder(4096, true);
+    Decoder decoder(4096);
+    std::vector<uchar> buffer;
+    for (int i = 0; i < 2; ++i) {
+        BitOStream outputStream(buffer);
+        QVERIFY(encoder.encodeRequest(outputStream, header));
+        BitIStream inputStream(outputStream.begin(), outputStream.end());
+        QVERIFY(decoder.decodeHeaderFields(inputStream));
+        QVERIFY(decoder.decodedHeader() == header);
+        if (!i) {
+            // Only ':path' and 'user-agent' were added:
+            const quint32 expectedSize = entry_size(header[2]).second
+                                         + entry_size(header[6]).second;
+            QCOMPARE(encoder.dynamicTableSize(), expectedSize);
+            QCOMPARE(decoder.dynamicTableSize(), expectedSize);
+        } else {
+            // ... and are indexed the second time:
+            QCOMPARE(encoder.dynamicTableSize(), decoder.dynamicTableSize());
+        }
+        buffer.clear();
+    }
+
+    // The first byte of a never indexed field is 0001xxxx.
+    const HttpHeader sensitive = {{":method", "GET"},
+                                  {":scheme", "https"},
+                                  {":path", "/"},
+                                  {"proxy-authorization", "secret"}};
+    BitOStream outputStream(buffer);
+    QVERIFY(encoder.encodeRequest(outputStream, sensitive));
+    // :method, :scheme and :path are in the static table (1 byte each):
+    QVERIFY(outputStream.byteLength() > 3);
+    QCOMPARE(int(buffer[3] & 0xf0), 0x10);
+}
+
+void tst_Hpack::huffmanBinaryData()
+{
+    // Octets >= 128 have long codes; such strings must still round-trip
+    // and must not be sent Huffman-encoded when that makes them larger.
+    QByteArray data;
+    for (int i = 0; i < 256; ++i)
+        data.append(char(i));
+
+    std::vector<uchar> buffer;
+    BitOStream outputStream(buffer);
+    outputStream.write(data, true);
+    QVERIFY(!(buffer[0] & 0x80));
+    QVERIFY(outputStream.byteLength() < quint64(data.size()) + 4);
+
+    BitIStream inputStream(outputStream.begin(), outputStream.end());
+    QByteArray decoded;
+    QVERIFY(inputStream.read(&decoded));
+    QCOMPARE(decoded, data);
+
+    // A long, compressible string crosses the 64-bit decoding window
+    // several times:
+    const QByteArray text = QByteArray("text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8").repeated(4);
+    buffer.clear();
+    BitOStream textStream(buffer);
+    textStream.write(text, true);
+    QVERIFY(buffer[0] & 0x80);
+    BitIStream textInput(textStream.begin(), textStream.end());
+    QByteArray decodedText;
+    QVERIFY(textInput.read(&decodedText));
+    QCOMPARE(decodedText, text);
+}
+
 QTEST_MAIN(tst_Hpack)
 
 #include "tst_hpack.moc"
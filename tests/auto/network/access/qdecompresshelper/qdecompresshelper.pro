@@ -0,0 +1,6 @@
+QT += core core-private network network-private testlib
+CONFIG += testcase parallel_test c++11
+TEMPLATE = app
+TARGET = tst_qdecompresshelper
+
+SOURCES += tst_qdecompresshelper.cpp
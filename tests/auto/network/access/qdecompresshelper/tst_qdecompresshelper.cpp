@@ -0,0 +1,209 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtCore/private/qbytedata_p.h>
+#include <QtNetwork/private/qdecompresshelper_p.h>
+
+QT_USE_NAMESPACE
+
+class tst_QDecompressHelper : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void encodingFromName_data();
+    void encodingFromName();
+    void acceptedEncodings();
+
+    void decompress_data();
+    void decompress();
+    void decompressInChunks_data();
+    void decompressInChunks();
+    void largeDeflate();
+    void invalidData();
+    void trailingData();
+};
+
+static const char expected[] = "Hello, World! Hello, World! Hello, World!\n";
+
+static QByteArray decompressAll(QDecompressHelper &helper, const QByteArray &input, int chunkSize)
+{
+    QByteDataBuffer out;
+    for (int i = 0; i < input.size(); i += chunkSize) {
+        const int size = qMin(chunkSize, input.size() - i);
+        if (helper.decompress(input.constData() + i, size, &out) < 0)
+            return QByteArray();
+    }
+    return out.readAll();
+}
+
+void tst_QDecompressHelper::encodingFromName_data()
+{
+    QTest::addColumn<QByteArray>("name");
+    QTest::addColumn<int>("encoding");
+
+    QTest::newRow("gzip") << QByteArray("gzip") << int(QDecompressHelper::GZip);
+    QTest::newRow("x-gzip") << QByteArray("x-gzip") << int(QDecompressHelper::GZip);
+    QTest::newRow("GZip") << QByteArray("GZip") << int(QDecompressHelper::GZip);
+    QTest::newRow("deflate") << QByteArray(" deflate ") << int(QDecompressHelper::Deflate);
+    QTest::newRow("identity") << QByteArray("identity") << int(QDecompressHelper::None);
+    QTest::newRow("empty") << QByteArray() << int(QDecompressHelper::None);
+#if QT_CONFIG(brotli)
+    QTest::newRow("br") << QByteArray("br") << int(QDecompressHelper::Brotli);
+#else
+    QTest::newRow("br") << QByteArray("br") << int(QDecompressHelper::None);
+#endif
+#if QT_CONFIG(zstd)
+    QTest::newRow("zstd") << QByteArray("zstd") << int(QDecompressHelper::Zstandard);
+#else
+    QTest::newRow("zstd") << QByteArray("zstd") << int(QDecompressHelper::None);
+#endif
+}
+
+void tst_QDecompressHelper::encodingFromName()
+{
+    QFETCH(QByteArray, name);
+    QFETCH(int, encoding);
+
+    QCOMPARE(int(QDecompressHelper::encodingFromName(name)), encoding);
+    QCOMPARE(QDecompressHelper::isSupportedEncoding(name), encoding != QDecompressHelper::None);
+}
+
+void tst_QDecompressHelper::acceptedEncodings()
+{
+    const QList<QByteArray> encodings = QDecompressHelper::acceptedEncodings().split(',');
+    QVERIFY(encodings.size() >= 2);
+    for (const QByteArray &encoding : encodings)
+        QVERIFY2(QDecompressHelper::isSupportedEncoding(encoding), encoding.constData());
+}
+
+void tst_QDecompressHelper::decompress_data()
+{
+    QTest::addColumn<QByteArray>("encoding");
+    QTest::addColumn<QByteArray>("data");
+
+    QTest::newRow("gzip") << QByteArray("gzip") << QByteArray::fromHex(
+        "1f8b0800000000000203f348cdc9c9d75108cf2fca495154f0c0cde302006a0b73a02a000000");
+    QTest::newRow("deflate") << QByteArray("deflate") << QByteArray::fromHex(
+        "789cf348cdc9c9d75108cf2fca495154f0c0cde302002aeb0d86");
+    // some servers send raw deflate data without the zlib wrapper
+    QTest::newRow("raw-deflate") << QByteArray("deflate") << QByteArray::fromHex(
+        "f348cdc9c9d75108cf2fca495154f0c0cde30200");
+#if QT_CONFIG(brotli)
+    QTest::newRow("br") << QByteArray("br") << QByteArray::fromHex(
+        "1b2900f89d09762c64121c25b8a12f4114909ae5aaec4db1c9750819db9b5284a978203d0d9f10");
+#endif
+#if QT_CONFIG(zstd)
+    QTest::newRow("zstd") << QByteArray("zstd") << QByteArray::fromHex(
+        "28b52ffd242aad00007848656c6c6f2c20576f726c6421200a0100114e258d0b2e7a");
+#endif
+}
+
+void tst_QDecompressHelper::decompress()
+{
+    QFETCH(QByteArray, encoding);
+    QFETCH(QByteArray, data);
+
+    QDecompressHelper helper;
+    QVERIFY(helper.setEncoding(encoding));
+    QVERIFY(helper.isValid());
+    QCOMPARE(decompressAll(helper, data, data.size()), QByteArray(expected));
+    QVERIFY(helper.isFinished());
+
+    // the helper can be reused after clear()
+    helper.clear();
+    QVERIFY(!helper.isValid());
+    QVERIFY(helper.setEncoding(encoding));
+    QCOMPARE(decompressAll(helper, data, data.size()), QByteArray(expected));
+}
+
+void tst_QDecompressHelper::decompressInChunks_data()
+{
+    decompress_data();
+}
+
+void tst_QDecompressHelper::decompressInChunks()
+{
+    QFETCH(QByteArray, encoding);
+    QFETCH(QByteArray, data);
+
+    for (int chunkSize = 1; chunkSize < 8; ++chunkSize) {
+        QDecompressHelper helper;
+        QVERIFY(helper.setEncoding(encoding));
+        QCOMPARE(decompressAll(helper, data, chunkSize), QByteArray(expected));
+        QVERIFY(helper.isFinished());
+    }
+}
+
+void tst_QDecompressHelper::largeDeflate()
+{
+    // larger than a single output chunk, and compressing very well, so the
+    // helper has to loop on full output buffers
+    QByteArray original;
+    for (int i = 0; i < 100000; ++i)
+        original += QByteArray::number(i % 1000) + ' ';
+    const QByteArray compressed = qCompress(original).mid(4); // strip qCompress' size prefix
+
+    QDecompressHelper helper;
+    QVERIFY(helper.setEncoding(QDecompressHelper::Deflate));
+    QCOMPARE(decompressAll(helper, compressed, compressed.size()), original);
+    QVERIFY(helper.setEncoding(QDecompressHelper::Deflate));
+    QCOMPARE(decompressAll(helper, compressed, 1000), original);
+}
+
+void tst_QDecompressHelper::invalidData()
+{
+    QDecompressHelper helper;
+    QVERIFY(helper.setEncoding(QByteArray("gzip")));
+    QByteDataBuffer out;
+    const QByteArray garbage(64, '\xff');
+    QCOMPARE(helper.decompress(garbage.constData(), garbage.size(), &out), qint64(-1));
+    QVERIFY(!helper.errorString().isEmpty());
+
+    QVERIFY(!helper.setEncoding(QByteArray("identity")));
+    QVERIFY(!helper.isValid());
+    QCOMPARE(helper.decompress(garbage.constData(), garbage.size(), &out), qint64(-1));
+}
+
+void tst_QDecompressHelper::trailingData()
+{
+    QByteArray data = QByteArray::fromHex(
+        "1f8b0800000000000203f348cdc9c9d75108cf2fca495154f0c0cde302006a0b73a02a000000");
+    data += "trailing garbage";
+
+    QDecompressHelper helper;
+    QVERIFY(helper.setEncoding(QDecompressHelper::GZip));
+    QCOMPARE(decompressAll(helper, data, data.size()), QByteArray(expected));
+    QVERIFY(helper.isFinished());
+}
+
+QTEST_MAIN(tst_QDecompressHelper)
+
+#include "tst_qdecompresshelper.moc"
@@ -30,11 +30,16 @@
 
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
 #ifndef QT_NO_BEARERMANAGEMENT
 #include <QtNetwork/QNetworkConfigurationManager>
 #endif
 
+#include <QtCore/QBuffer>
 #include <QtCore/QDebug>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QTemporaryDir>
 
 #ifndef QT_NO_BEARERMANAGEMENT
 Q_DECLARE_METATYPE(QNetworkAccessManager::NetworkAccessibility)
@@ -50,6 +55,85 @@ public:
 private slots:
     void networkAccessible();
     void alwaysCacheRequest();
+    void connectionPolicy();
+    void maximumConnectionsPerHost_data();
+    void maximumConnectionsPerHost();
+    void httpPipelineLength_data();
+    void httpPipelineLength();
+    void networkThreadPool();
+    void connectionIdleTimeoutPerManager();
+    void downloadSink_data();
+    void downloadSink();
+    void transferStatistics();
+};
+
+// Answers every HTTP request with the same body, keeping connections alive
+class KeepAliveHttpServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    explicit KeepAliveHttpServer(const QByteArray &body)
+        : body(body)
+    {
+        connect(this, &QTcpServer::newConnection, this, &KeepAliveHttpServer::acceptConnections);
+        listen(QHostAddress::LocalHost);
+    }
+
+    QUrl url(const QString &path = QStringLiteral("/")) const
+    {
+        return QUrl(QStringLiteral("http://127.0.0.1:%1%2").arg(serverPort()).arg(path));
+    }
+
+    int connectionCount = 0;
+    int disconnectionCount = 0;
+    int requestCount = 0;
+    // Requests after this many are held back until answerHeldRequest()
+    int maxReplies = -1;
+
+    void answerHeldRequest()
+    {
+        if (QTcpSocket *socket = heldRequests.takeFirst())
+            answer(socket);
+    }
+
+private slots:
+    void acceptConnections()
+    {
+        while (QTcpSocket *socket = nextPendingConnection()) {
+            ++connectionCount;
+            connect(socket, &QTcpSocket::readyRead, this, &KeepAliveHttpServer::readRequests);
+            connect(socket, &QTcpSocket::disconnected, this, [this] { ++disconnectionCount; });
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        }
+    }
+
+    void readRequests()
+    {
+        QTcpSocket *socket = static_cast<QTcpSocket *>(sender());
+        QByteArray &buffer = pending[socket];
+        buffer += socket->readAll();
+        int end;
+        while ((end = buffer.indexOf("\r\n\r\n")) != -1) {
+            buffer.remove(0, end + 4);
+            ++requestCount;
+            if (maxReplies >= 0 && requestCount > maxReplies)
+                heldRequests << socket;
+            else
+                answer(socket);
+        }
+    }
+
+private:
+    void answer(QTcpSocket *socket)
+    {
+        socket->write("HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\n"
+                      "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n");
+        socket->write(body);
+    }
+
+    QByteArray body;
+    QList<QPointer<QTcpSocket> > heldRequests;
+    QHash<QTcpSocket *, QByteArray> pending;
 };
 
 tst_QNetworkAccessManager::tst_QNetworkAccessManager()
@@ -129,5 +213,308 @@ void tst_QNetworkAccessManager::alwaysCacheRequest()
     delete reply;
 }
 
+void tst_QNetworkAccessManager::connectionPolicy()
+{
+    QNetworkAccessManager manager;
+
+    QCOMPARE(manager.maximumConnectionsPerHost(), 6);
+    QCOMPARE(manager.connectionIdleTimeout(), 120000);
+    QCOMPARE(manager.http2MaximumConcurrentStreams(), 100);
+    QCOMPARE(manager.http2SessionReceiveWindowSize(), 655350);
+    QCOMPARE(manager.http2StreamReceiveWindowSize(), 65535);
+
+    manager.setMaximumConnectionsPerHost(12);
+    QCOMPARE(manager.maximumConnectionsPerHost(), 12);
+    manager.setMaximumConnectionsPerHost(0);
+    QCOMPARE(manager.maximumConnectionsPerHost(), 1);
+
+    manager.setConnectionIdleTimeout(5000);
+    QCOMPARE(manager.connectionIdleTimeout(), 5000);
+    manager.setConnectionIdleTimeout(-1);
+    QCOMPARE(manager.connectionIdleTimeout(), 0);
+
+    QCOMPARE(manager.httpPipelineLength(), 3);
+    manager.setHttpPipelineLength(8);
+    QCOMPARE(manager.httpPipelineLength(), 8);
+    manager.setHttpPipelineLength(0);
+    QCOMPARE(manager.httpPipelineLength(), 1);
+
+    manager.setHttp2MaximumConcurrentStreams(16);
+    QCOMPARE(manager.http2MaximumConcurrentStreams(), 16);
+    manager.setHttp2MaximumConcurrentStreams(0);
+    QCOMPARE(manager.http2MaximumConcurrentStreams(), 1);
+
+    manager.setHttp2SessionReceiveWindowSize(16 * 1024 * 1024);
+    QCOMPARE(manager.http2SessionReceiveWindowSize(), 16 * 1024 * 1024);
+    // The session window cannot shrink below the protocol default:
+    manager.setHttp2SessionReceiveWindowSize(1024);
+    QCOMPARE(manager.http2SessionReceiveWindowSize(), 65535);
+
+    manager.setHttp2StreamReceiveWindowSize(1024 * 1024);
+    QCOMPARE(manager.http2StreamReceiveWindowSize(), 1024 * 1024);
+}
+
+void tst_QNetworkAccessManager::maximumConnectionsPerHost_data()
+{
+    QTest::addColumn<int>("maximum");
+
+    QTest::newRow("default") << 0;
+    QTest::newRow("1") << 1;
+    QTest::newRow("2") << 2;
+    QTest::newRow("8") << 8;
+}
+
+void tst_QNetworkAccessManager::maximumConnectionsPerHost()
+{
+    QFETCH(int, maximum);
+
+    KeepAliveHttpServer server("x");
+    QVERIFY(server.isListening());
+    // Keep every request outstanding, so that each one wants a connection
+    server.maxReplies = 0;
+
+    QNetworkAccessManager manager;
+    if (maximum)
+        manager.setMaximumConnectionsPerHost(maximum);
+    const int expected = manager.maximumConnectionsPerHost();
+
+    QList<QNetworkReply *> replies;
+    for (int i = 0; i < 2 * expected + 2; ++i)
+        replies << manager.get(QNetworkRequest(server.url(QStringLiteral("/%1").arg(i))));
+
+    QTRY_COMPARE(server.requestCount, expected);
+    QTest::qWait(200);
+    QCOMPARE(server.connectionCount, expected);
+    QCOMPARE(server.requestCount, expected);
+    qDeleteAll(replies);
+}
+
+void tst_QNetworkAccessManager::httpPipelineLength_data()
+{
+    QTest::addColumn<int>("length");
+
+    QTest::newRow("default") << 0;
+    QTest::newRow("1") << 1;
+    QTest::newRow("6") << 6;
+}
+
+void tst_QNetworkAccessManager::httpPipelineLength()
+{
+    QFETCH(int, length);
+
+    KeepAliveHttpServer server("x");
+    QVERIFY(server.isListening());
+    server.maxReplies = 0;
+
+    QNetworkAccessManager manager;
+    manager.setMaximumConnectionsPerHost(1);
+    if (length)
+        manager.setHttpPipelineLength(length);
+    const int expected = manager.httpPipelineLength();
+
+    QList<QNetworkReply *> replies;
+    for (int i = 0; i < 2 * expected + 4; ++i) {
+        QNetworkRequest request(server.url(QStringLiteral("/%1").arg(i)));
+        request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+        replies << manager.get(request);
+    }
+
+    // Answering the first request, once all of them are queued, tells the
+    // client that the server keeps the connection alive; pipelining starts
+    // with the second request.
+    QTRY_COMPARE(server.requestCount, 1);
+    QTest::qWait(200);
+    server.answerHeldRequest();
+
+    // The answered request, the one in flight and the pipelined ones
+    QTRY_COMPARE(server.requestCount, 2 + expected);
+    QTest::qWait(200);
+    QCOMPARE(server.requestCount, 2 + expected);
+    QCOMPARE(server.connectionCount, 1);
+    qDeleteAll(replies);
+}
+
+void tst_QNetworkAccessManager::networkThreadPool()
+{
+    QCOMPARE(QNetworkAccessManager::networkThreadCount(), 0);
+    QNetworkAccessManager::setNetworkThreadCount(2);
+    QCOMPARE(QNetworkAccessManager::networkThreadCount(), 2);
+
+    const QByteArray body(100 * 1024, 'x');
+    KeepAliveHttpServer server(body);
+    QVERIFY(server.isListening());
+
+    QNetworkAccessManager manager;
+    manager.setMaximumConnectionsPerHost(1);
+    QNetworkAccessManager otherManager;
+    const int requestCount = 10;
+    QList<QNetworkReply *> replies;
+    for (int i = 0; i < requestCount; ++i) {
+        QNetworkAccessManager &m = i % 2 ? otherManager : manager;
+        replies << m.get(QNetworkRequest(server.url(QStringLiteral("/%1").arg(i))));
+    }
+
+    for (QNetworkReply *reply : qAsConst(replies)) {
+        QTRY_VERIFY(reply->isFinished());
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        QCOMPARE(reply->readAll(), body);
+        delete reply;
+    }
+    QCOMPARE(server.requestCount, requestCount);
+    // All requests of one manager reuse the same connection, but the
+    // managers do not share connections with each other.
+    QVERIFY(server.connectionCount >= 2);
+    QVERIFY(server.connectionCount <= 1 + otherManager.maximumConnectionsPerHost());
+
+    QNetworkAccessManager::setNetworkThreadCount(-1);
+    QCOMPARE(QNetworkAccessManager::networkThreadCount(), 0);
+}
+
+void tst_QNetworkAccessManager::connectionIdleTimeoutPerManager()
+{
+    // Both managers use the connection cache of the one network thread
+    QNetworkAccessManager::setNetworkThreadCount(1);
+
+    KeepAliveHttpServer server("x");
+    QVERIFY(server.isListening());
+
+    QNetworkAccessManager keeping;
+    keeping.setConnectionIdleTimeout(60000);
+    QNetworkAccessManager closing;
+    closing.setConnectionIdleTimeout(0);
+
+    // The request of the manager that keeps its connection finishes after
+    // the other one started
+    server.maxReplies = 0;
+    QScopedPointer<QNetworkReply> kept(keeping.get(QNetworkRequest(server.url())));
+    QTRY_COMPARE(server.requestCount, 1);
+    QScopedPointer<QNetworkReply> closed(closing.get(QNetworkRequest(server.url())));
+    QTRY_COMPARE(server.requestCount, 2);
+    server.answerHeldRequest();
+    server.answerHeldRequest();
+    QTRY_VERIFY(kept->isFinished() && closed->isFinished());
+    QCOMPARE(kept->error(), QNetworkReply::NoError);
+    QCOMPARE(closed->error(), QNetworkReply::NoError);
+    QCOMPARE(server.connectionCount, 2);
+
+    // Only the connection of the manager without idle timeout is closed
+    QTRY_COMPARE(server.disconnectionCount, 1);
+    QTest::qWait(200);
+    QCOMPARE(server.disconnectionCount, 1);
+
+    QNetworkAccessManager::setNetworkThreadCount(-1);
+}
+
+void tst_QNetworkAccessManager::downloadSink_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::newRow("manager-thread") << 0;
+    QTest::newRow("shared-threads") << 3;
+}
+
+void tst_QNetworkAccessManager::downloadSink()
+{
+    QFETCH(int, threadCount);
+    QNetworkAccessManager::setNetworkThreadCount(threadCount);
+
+    QByteArray body;
+    for (int i = 0; i < 50000; ++i)
+        body += QByteArray::number(i) + ' ';
+    KeepAliveHttpServer server(body);
+    QVERIFY(server.isListening());
+
+    QBuffer sink;
+    QVERIFY(sink.open(QIODevice::WriteOnly));
+
+    QNetworkAccessManager manager;
+    QNetworkRequest request(server.url());
+    request.setAttribute(QNetworkRequest::DownloadSinkAttribute,
+                         QVariant::fromValue<QObject *>(&sink));
+    QScopedPointer<QNetworkReply> reply(manager.get(request));
+    QSignalSpy readyReadSpy(reply.data(), SIGNAL(readyRead()));
+    QSignalSpy progressSpy(reply.data(), SIGNAL(downloadProgress(qint64,qint64)));
+
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QCOMPARE(sink.data(), body);
+    QCOMPARE(reply->bytesAvailable(), qint64(0));
+    QCOMPARE(readyReadSpy.count(), 0);
+    QVERIFY(!progressSpy.isEmpty());
+    QCOMPARE(progressSpy.last().at(0).toLongLong(), qint64(body.size()));
+
+    // A sink that cannot be written to aborts the download
+    QBuffer readOnlySink;
+    QVERIFY(readOnlySink.open(QIODevice::ReadOnly));
+    request.setAttribute(QNetworkRequest::DownloadSinkAttribute,
+                         QVariant::fromValue<QObject *>(&readOnlySink));
+    QTest::ignoreMessage(QtWarningMsg, "QIODevice::write (QBuffer): ReadOnly device");
+    reply.reset(manager.get(request));
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->error(), QNetworkReply::UnknownContentError);
+
+    QNetworkAccessManager::setNetworkThreadCount(0);
+}
+
+void tst_QNetworkAccessManager::transferStatistics()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString traceFileName = tempDir.filePath(QStringLiteral("trace.bin"));
+    qputenv("QT_NETWORK_TRACE_FILE", QFile::encodeName(traceFileName));
+    QLoggingCategory::setFilterRules(QStringLiteral("qt.network.trace.debug=true"));
+
+    const QByteArray body(10 * 1024, 'x');
+    KeepAliveHttpServer server(body);
+    QVERIFY(server.isListening());
+
+    QNetworkAccessManager manager;
+    QScopedPointer<QNetworkReply> reply(manager.get(QNetworkRequest(server.url())));
+    QVERIFY(!reply->transferStatistics().isValid());
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+
+    QNetworkTransferStatistics statistics = reply->transferStatistics();
+    QVERIFY(statistics.isValid());
+    QVERIFY(!statistics.isConnectionReused());
+    QCOMPARE(statistics.http2StreamId(), -1);
+    QVERIFY(statistics.bytesSent() > 0);
+    QVERIFY(statistics.bytesReceived() > body.size());
+    QCOMPARE(statistics.elapsed(QNetworkTransferStatistics::RequestStarted), qint64(0));
+    // Plain HTTP does not encrypt
+    QCOMPARE(statistics.elapsed(QNetworkTransferStatistics::Encrypted), qint64(-1));
+    const QNetworkTransferStatistics::Event events[] = {
+        QNetworkTransferStatistics::RequestStarted,
+        QNetworkTransferStatistics::RequestQueued,
+        QNetworkTransferStatistics::ConnectionStarted,
+        QNetworkTransferStatistics::HostFound,
+        QNetworkTransferStatistics::Connected,
+        QNetworkTransferStatistics::RequestSent,
+        QNetworkTransferStatistics::ResponseStarted,
+        QNetworkTransferStatistics::ResponseFinished
+    };
+    for (size_t i = 1; i < sizeof events / sizeof *events; ++i)
+        QVERIFY(statistics.duration(events[i - 1], events[i]) >= 0);
+
+    // The second request reuses the idle connection
+    reply.reset(manager.get(QNetworkRequest(server.url())));
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(server.connectionCount, 1);
+    statistics = reply->transferStatistics();
+    QVERIFY(statistics.isValid());
+    QVERIFY(statistics.isConnectionReused());
+    QVERIFY(statistics.duration(QNetworkTransferStatistics::RequestStarted,
+                                QNetworkTransferStatistics::ResponseFinished) >= 0);
+
+    // Both transfers were written to the trace file
+    QLoggingCategory::setFilterRules(QString());
+    QFile traceFile(traceFileName);
+    QVERIFY(traceFile.open(QIODevice::ReadOnly));
+    const QByteArray trace = traceFile.readAll();
+    QVERIFY(trace.startsWith("QNTR"));
+    QCOMPARE(trace.count(server.url().toEncoded()), 2);
+}
+
 QTEST_MAIN(tst_QNetworkAccessManager)
 #include "tst_qnetworkaccessmanager.moc"
@@ -62,7 +62,10 @@
 #endif
 
 #include <qhostinfo.h>
+#include <QUdpSocket>
+#include <QNetworkDatagram>
 #include "private/qhostinfo_p.h"
+#include "private/qhostinfodnsresolver_p.h"
 
 #if !defined(QT_NO_GETADDRINFO)
 #  include <sys/types.h>
@@ -112,6 +115,13 @@ private slots:
 
     void cache();
 
+    void dnsResolver_data();
+    void dnsResolver();
+    void dnsResolverRetransmit();
+    void dnsResolverLookupHost();
+    void dnsResolverCacheTtl();
+    void dnsResolverNegativeCache();
+
     void abortHostLookup();
 protected slots:
     void resultsReady(const QHostInfo &);
@@ -624,6 +634,285 @@ void tst_QHostInfo::cache()
     QCOMPARE(lookupsDoneCounter, 2);
 }
 
+// Minimal DNS server on localhost that answers every query with the
+// configured records. It runs in its own thread so that blocking lookups
+// can be tested too.
+class DnsStubServer : public QThread
+{
+public:
+    DnsStubServer() : rcode(0), ttl(300), soaTtl(-1), soaMinimum(0), port(0) {}
+    ~DnsStubServer()
+    {
+        stop.store(1);
+        wait();
+    }
+
+    void start()
+    {
+        QThread::start();
+        ready.acquire();
+    }
+
+    void addRecord(QHostInfoDnsResolver::RecordType type, const QHostAddress &address)
+    {
+        QByteArray data;
+        if (type == QHostInfoDnsResolver::A) {
+            data.resize(4);
+            qToBigEndian(address.toIPv4Address(), reinterpret_cast<uchar *>(data.data()));
+        } else {
+            const Q_IPV6ADDR ip6 = address.toIPv6Address();
+            data = QByteArray(reinterpret_cast<const char *>(&ip6), 16);
+        }
+        records.append(qMakePair(quint16(type), data));
+    }
+
+    int rcode;
+    quint32 ttl;
+    int soaTtl; // no SOA record in the authority section if negative
+    quint32 soaMinimum;
+    QList<QPair<quint16, QByteArray> > records;
+    QAtomicInt queries;
+    QAtomicInt dropQueries; // number of queries to leave unanswered
+    quint16 port;
+
+protected:
+    void run() Q_DECL_OVERRIDE
+    {
+        QUdpSocket socket;
+        socket.bind(QHostAddress(QHostAddress::LocalHost));
+        port = socket.localPort();
+        ready.release();
+        while (!stop.load()) {
+            if (!socket.waitForReadyRead(20))
+                continue;
+            while (socket.hasPendingDatagrams()) {
+                const QNetworkDatagram datagram = socket.receiveDatagram();
+                queries.ref();
+                if (dropQueries.fetchAndAddRelaxed(-1) > 0)
+                    continue;
+                socket.writeDatagram(datagram.makeReply(reply(datagram.data())));
+            }
+        }
+    }
+
+private:
+    static QByteArray be16(quint16 value)
+    {
+        QByteArray result(2, Qt::Uninitialized);
+        qToBigEndian(value, reinterpret_cast<uchar *>(result.data()));
+        return result;
+    }
+    static QByteArray be32(quint32 value)
+    {
+        QByteArray result(4, Qt::Uninitialized);
+        qToBigEndian(value, reinterpret_cast<uchar *>(result.data()));
+        return result;
+    }
+
+    QByteArray reply(const QByteArray &query) const
+    {
+        int end = 12;
+        while (end < query.size() && query.at(end))
+            end += uchar(query.at(end)) + 1;
+        end += 5;
+        const quint16 type = qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(query.constData()) + end - 4);
+
+        QByteArray answers;
+        int answerCount = 0;
+        for (const auto &record : records) {
+            if (record.first != type)
+                continue;
+            // the owner name is a pointer to the question
+            answers += QByteArray("\xc0\x0c", 2) + be16(type) + be16(1) + be32(ttl)
+                    + be16(quint16(record.second.size())) + record.second;
+            ++answerCount;
+        }
+        QByteArray authority;
+        if (answerCount == 0 && soaTtl >= 0) {
+            const QByteArray soa = QByteArray("\x02" "ns" "\xc0\x0c" "\x05" "admin" "\xc0\x0c", 13)
+                    + be32(1) + be32(3600) + be32(600) + be32(86400) + be32(soaMinimum);
+            authority = QByteArray("\xc0\x0c", 2) + be16(QHostInfoDnsResolver::SOA) + be16(1)
+                    + be32(quint32(soaTtl)) + be16(quint16(soa.size())) + soa;
+        }
+
+        QByteArray result = query.left(end);
+        result[2] = char(0x81); // response, recursion desired
+        result[3] = char(0x80 | rcode); // recursion available
+        result.replace(6, 2, be16(quint16(answerCount)));
+        result.replace(8, 2, be16(authority.isEmpty() ? 0 : 1));
+        return result + answers + authority;
+    }
+
+    QSemaphore ready;
+    QAtomicInt stop;
+};
+
+void tst_QHostInfo::dnsResolver_data()
+{
+    QTest::addColumn<bool>("blocking");
+    QTest::newRow("async") << false;
+    QTest::newRow("blocking") << true;
+}
+
+void tst_QHostInfo::dnsResolver()
+{
+    QFETCH(bool, blocking);
+
+    DnsStubServer server;
+    server.ttl = 42;
+    server.addRecord(QHostInfoDnsResolver::A, QHostAddress("192.0.2.1"));
+    server.addRecord(QHostInfoDnsResolver::A, QHostAddress("192.0.2.2"));
+    server.addRecord(QHostInfoDnsResolver::AAAA, QHostAddress("2001:db8::1"));
+    server.start();
+
+    QHostInfoDnsResolver resolver;
+    resolver.setNameserver(QHostAddress::LocalHost, server.port);
+    QSignalSpy spy(&resolver, SIGNAL(finished()));
+    QVERIFY(resolver.lookup("www.example.com"));
+    if (blocking)
+        QVERIFY(resolver.waitForFinished(5000));
+    else
+        QTRY_VERIFY(resolver.isFinished());
+    QCOMPARE(spy.count(), 1);
+
+    const QHostInfo info = resolver.result();
+    QCOMPARE(info.error(), QHostInfo::NoError);
+    QCOMPARE(info.hostName(), QString("www.example.com"));
+    const QList<QHostAddress> expected = QList<QHostAddress>()
+            << QHostAddress("2001:db8::1") << QHostAddress("192.0.2.1") << QHostAddress("192.0.2.2");
+    QCOMPARE(info.addresses(), expected);
+    QCOMPARE(resolver.ttl(), 42);
+
+    // names the system resolver has to handle
+    QVERIFY(!QHostInfoDnsResolver::canResolve("localhost"));
+    QVERIFY(!QHostInfoDnsResolver::canResolve("intranet"));
+    QVERIFY(!QHostInfoDnsResolver::canResolve("192.0.2.1"));
+    QVERIFY(QHostInfoDnsResolver::canResolve("www.example.com"));
+}
+
+void tst_QHostInfo::dnsResolverRetransmit()
+{
+    DnsStubServer server;
+    server.addRecord(QHostInfoDnsResolver::A, QHostAddress("192.0.2.1"));
+    server.dropQueries.store(2); // both the A and the AAAA query
+    server.start();
+
+    QHostInfoDnsResolver resolver;
+    resolver.setNameserver(QHostAddress::LocalHost, server.port);
+    resolver.setTimeout(100);
+    QVERIFY(resolver.lookup("www.example.com"));
+    QVERIFY(resolver.waitForFinished(5000));
+    QCOMPARE(resolver.result().error(), QHostInfo::NoError);
+    QCOMPARE(resolver.result().addresses(), QList<QHostAddress>() << QHostAddress("192.0.2.1"));
+    QCOMPARE(server.queries.load(), 4);
+
+    // no answer at all
+    server.dropQueries.store(100);
+    resolver.setAttempts(2);
+    QVERIFY(resolver.lookup("www.example.com"));
+    QVERIFY(resolver.waitForFinished(5000));
+    QCOMPARE(resolver.result().error(), QHostInfo::UnknownError);
+    QCOMPARE(resolver.ttl(), 0);
+}
+
+void tst_QHostInfo::dnsResolverLookupHost()
+{
+    DnsStubServer server;
+    server.addRecord(QHostInfoDnsResolver::A, QHostAddress("192.0.2.1"));
+    server.start();
+    qt_qhostinfo_set_nameserver(QHostAddress::LocalHost, server.port);
+
+    // lookups of the same name share one pair of queries
+    lookupsDoneCounter = 0;
+    for (int i = 0; i < 3; ++i)
+        QHostInfo::lookupHost("www.example.com", this, SLOT(resultsReady(QHostInfo)));
+    QTRY_COMPARE(lookupsDoneCounter, 3);
+    QCOMPARE(lookupResults.error(), QHostInfo::NoError);
+    QCOMPARE(lookupResults.addresses(), QList<QHostAddress>() << QHostAddress("192.0.2.1"));
+    QCOMPARE(server.queries.load(), 2);
+
+    qt_qhostinfo_set_nameserver(QHostAddress(), 0);
+}
+
+void tst_QHostInfo::dnsResolverCacheTtl()
+{
+    QFETCH_GLOBAL(bool, cache);
+    if (!cache)
+        return; // test makes only sense when cache enabled
+
+    DnsStubServer server;
+    server.ttl = 1;
+    server.addRecord(QHostInfoDnsResolver::A, QHostAddress("192.0.2.1"));
+    server.start();
+    qt_qhostinfo_set_nameserver(QHostAddress::LocalHost, server.port);
+
+    QHostInfo info = QHostInfo::fromName("www.example.com");
+    QCOMPARE(info.addresses(), QList<QHostAddress>() << QHostAddress("192.0.2.1"));
+    QCOMPARE(server.queries.load(), 2);
+
+    bool valid = false;
+    int id = -1;
+    info = qt_qhostinfo_lookup("www.example.com", this, SLOT(resultsReady(QHostInfo)), &valid, &id);
+    QVERIFY(valid);
+
+    // the record expires after a second, well before the cache's own limit
+    QTest::qSleep(1100);
+    lookupDone = false;
+    info = qt_qhostinfo_lookup("www.example.com", this, SLOT(resultsReady(QHostInfo)), &valid, &id);
+    QVERIFY(!valid);
+    QTestEventLoop::instance().enterLoop(5);
+    QVERIFY(!QTestEventLoop::instance().timeout());
+    QVERIFY(lookupDone);
+    QCOMPARE(lookupResults.error(), QHostInfo::NoError);
+    QCOMPARE(server.queries.load(), 4);
+
+    qt_qhostinfo_set_nameserver(QHostAddress(), 0);
+}
+
+void tst_QHostInfo::dnsResolverNegativeCache()
+{
+    QFETCH_GLOBAL(bool, cache);
+
+    DnsStubServer server;
+    server.rcode = 3; // NXDOMAIN
+    server.soaTtl = 3600;
+    server.soaMinimum = 30;
+    server.start();
+
+    QHostInfoDnsResolver resolver;
+    resolver.setNameserver(QHostAddress::LocalHost, server.port);
+    QVERIFY(resolver.lookup("nonexistent.example.com"));
+    QVERIFY(resolver.waitForFinished(5000));
+    QCOMPARE(resolver.result().error(), QHostInfo::HostNotFound);
+    QCOMPARE(resolver.ttl(), 30);
+
+    qt_qhostinfo_set_nameserver(QHostAddress::LocalHost, server.port);
+    server.queries.store(0);
+    QCOMPARE(QHostInfo::fromName("nonexistent.example.com").error(), QHostInfo::HostNotFound);
+    QCOMPARE(server.queries.load(), 2);
+
+    // with the cache, the second lookup is answered without asking the server
+    bool valid = false;
+    int id = -1;
+    lookupDone = false;
+    QHostInfo info = qt_qhostinfo_lookup("nonexistent.example.com", this,
+                                         SLOT(resultsReady(QHostInfo)), &valid, &id);
+    if (cache) {
+        QVERIFY(valid);
+        QCOMPARE(info.error(), QHostInfo::HostNotFound);
+        QCOMPARE(server.queries.load(), 2);
+    } else {
+        QVERIFY(!valid);
+        QTestEventLoop::instance().enterLoop(5);
+        QVERIFY(!QTestEventLoop::instance().timeout());
+        QVERIFY(lookupDone);
+        QCOMPARE(lookupResults.error(), QHostInfo::HostNotFound);
+        QCOMPARE(server.queries.load(), 4);
+    }
+
+    qt_qhostinfo_set_nameserver(QHostAddress(), 0);
+}
+
 void tst_QHostInfo::resultsReady(const QHostInfo &hi)
 {
     lookupDone = true;
@@ -5,6 +5,7 @@
 CONFIG += testcase
 TARGET = tst_qabstractsocket
 QT = core network testlib
+qtConfig(private_tests): QT += network-private
 
 SOURCES += tst_qabstractsocket.cpp
 
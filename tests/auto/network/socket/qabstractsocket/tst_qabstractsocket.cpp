@@ -33,6 +33,10 @@
 #include <qdebug.h>
 #include <qabstractsocket.h>
 
+#ifdef QT_BUILD_INTERNAL
+#include <private/qabstractsocket_p.h>
+#endif
+
 class tst_QAbstractSocket : public QObject
 {
 Q_OBJECT
@@ -43,6 +47,10 @@ public:
 
 private slots:
     void getSetCheck();
+#ifdef QT_BUILD_INTERNAL
+    void interleaveAddressFamilies_data();
+    void interleaveAddressFamilies();
+#endif
 };
 
 tst_QAbstractSocket::tst_QAbstractSocket()
@@ -89,5 +97,55 @@ void tst_QAbstractSocket::getSetCheck()
     QCOMPARE(quint16(0xffff), obj1.peerPort());
 }
 
+#ifdef QT_BUILD_INTERNAL
+static QList<QHostAddress> addressList(const QString &addresses)
+{
+    QList<QHostAddress> result;
+    const QStringList parts = addresses.split(QLatin1Char(' '), QString::SkipEmptyParts);
+    for (const QString &address : parts)
+        result << QHostAddress(address);
+    return result;
+}
+
+void tst_QAbstractSocket::interleaveAddressFamilies_data()
+{
+    QTest::addColumn<QString>("resolved");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("empty") << QString() << QString();
+    QTest::newRow("one") << "::1" << "::1";
+    QTest::newRow("ipv4-only") << "10.0.0.1 10.0.0.2 10.0.0.3" << "10.0.0.1 10.0.0.2 10.0.0.3";
+    QTest::newRow("ipv6-only") << "2001:db8::1 2001:db8::2 2001:db8::3"
+                               << "2001:db8::1 2001:db8::2 2001:db8::3";
+    // two addresses are left alone, whatever their order
+    QTest::newRow("two-same-family") << "2001:db8::1 2001:db8::2" << "2001:db8::1 2001:db8::2";
+    QTest::newRow("two-mixed") << "10.0.0.1 2001:db8::1" << "10.0.0.1 2001:db8::1";
+    QTest::newRow("ipv6-first")
+            << "2001:db8::1 2001:db8::2 2001:db8::3 10.0.0.1 10.0.0.2"
+            << "2001:db8::1 10.0.0.1 2001:db8::2 10.0.0.2 2001:db8::3";
+    QTest::newRow("ipv4-first")
+            << "10.0.0.1 10.0.0.2 10.0.0.3 2001:db8::1"
+            << "10.0.0.1 2001:db8::1 10.0.0.2 10.0.0.3";
+    QTest::newRow("already-interleaved")
+            << "2001:db8::1 10.0.0.1 2001:db8::2 10.0.0.2"
+            << "2001:db8::1 10.0.0.1 2001:db8::2 10.0.0.2";
+    QTest::newRow("more-of-second-family")
+            << "2001:db8::1 10.0.0.1 10.0.0.2 10.0.0.3"
+            << "2001:db8::1 10.0.0.1 10.0.0.2 10.0.0.3";
+    QTest::newRow("second-family-first-in-middle")
+            << "2001:db8::1 2001:db8::2 10.0.0.1 2001:db8::3 10.0.0.2 10.0.0.3"
+            << "2001:db8::1 10.0.0.1 2001:db8::2 10.0.0.2 2001:db8::3 10.0.0.3";
+}
+
+void tst_QAbstractSocket::interleaveAddressFamilies()
+{
+    QFETCH(QString, resolved);
+    QFETCH(QString, expected);
+
+    QCOMPARE(QAbstractSocketPrivate::interleaveAddressFamilies(addressList(resolved)),
+             addressList(expected));
+}
+#endif
+
 QTEST_MAIN(tst_QAbstractSocket)
 #include "tst_qabstractsocket.moc"
@@ -95,6 +95,7 @@ private slots:
 #endif
     void listenWhileListening();
     void addressReusable();
+    void portSharing();
     void setNewSocketDescriptorBlocking();
 #ifndef QT_NO_NETWORKPROXY
     void invalidProxy_data();
@@ -632,6 +633,49 @@ void tst_QTcpServer::addressReusable()
 #endif
 }
 
+void tst_QTcpServer::portSharing()
+{
+    QFETCH_GLOBAL(bool, setProxy);
+    if (setProxy)
+        QSKIP("Port sharing is not supported through proxies");
+
+    QTcpServer first;
+    first.setPortSharingEnabled(true);
+    QVERIFY(first.isPortSharingEnabled());
+    if (!first.listen(QHostAddress::LocalHost)) {
+        QCOMPARE(first.serverError(), QAbstractSocket::UnsupportedSocketOperationError);
+        QSKIP("SO_REUSEPORT is not supported on this platform");
+    }
+
+    // a server that does not opt in must still be refused
+    QTcpServer intruder;
+    QVERIFY(!intruder.listen(QHostAddress::LocalHost, first.serverPort()));
+    QCOMPARE(intruder.serverError(), QAbstractSocket::AddressInUseError);
+
+    QTcpServer second;
+    second.setPortSharingEnabled(true);
+    QVERIFY2(second.listen(QHostAddress::LocalHost, first.serverPort()),
+             qPrintable(second.errorString()));
+    QCOMPARE(second.serverPort(), first.serverPort());
+
+    const int connectionCount = 10;
+    QList<QTcpSocket *> clients;
+    for (int i = 0; i < connectionCount; ++i) {
+        QTcpSocket *client = new QTcpSocket(this);
+        client->connectToHost(QHostAddress::LocalHost, first.serverPort());
+        QVERIFY(client->waitForConnected(5000));
+        clients << client;
+    }
+
+    QTRY_COMPARE(first.acceptedConnectionCount() + second.acceptedConnectionCount(),
+                 quint64(connectionCount));
+    QVERIFY(first.acceptBatchCount() + second.acceptBatchCount() > 0);
+    // only notifications that accepted something count as a batch
+    QVERIFY(first.acceptBatchCount() <= first.acceptedConnectionCount());
+    QVERIFY(second.acceptBatchCount() <= second.acceptedConnectionCount());
+    qDeleteAll(clients);
+}
+
 void tst_QTcpServer::setNewSocketDescriptorBlocking()
 {
     QFETCH_GLOBAL(bool, setProxy);
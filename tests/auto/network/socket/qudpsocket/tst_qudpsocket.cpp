@@ -123,6 +123,8 @@ private slots:
     void readyReadForEmptyDatagram();
     void asyncReadDatagram();
     void writeInHostLookupState();
+    void batchedDatagrams();
+    void batchedDatagramsMixedProtocols();
 
 protected slots:
     void empty_readyReadSlot();
@@ -1958,5 +1960,94 @@ void tst_QUdpSocket::writeInHostLookupState()
     QVERIFY(!socket.putChar('0'));
 }
 
+void tst_QUdpSocket::batchedDatagrams()
+{
+    QFETCH_GLOBAL(bool, setProxy);
+    if (setProxy)
+        return;
+
+    QUdpSocket sender, receiver;
+#ifdef FORCE_SESSION
+    sender.setProperty("_q_networksession", QVariant::fromValue(networkSession));
+    receiver.setProperty("_q_networksession", QVariant::fromValue(networkSession));
+#endif
+
+    QVERIFY(receiver.bind(QHostAddress(QHostAddress::AnyIPv4), 0));
+    const QHostAddress destination = makeNonAny(receiver.localAddress());
+    const quint16 port = receiver.localPort();
+
+    QVector<QNetworkDatagram> datagrams;
+    for (int i = 0; i < 10; ++i)
+        datagrams.append(QNetworkDatagram(QByteArray(i + 1, char('a' + i)), destination, port));
+    QSignalSpy bytesWrittenSpy(&sender, SIGNAL(bytesWritten(qint64)));
+    QCOMPARE(sender.writeDatagrams(datagrams), datagrams.size());
+    QCOMPARE(bytesWrittenSpy.count(), 1);
+    QCOMPARE(bytesWrittenSpy.at(0).at(0).toLongLong(), qint64(55));
+
+    QVector<QNetworkDatagram> received;
+    while (received.size() < datagrams.size()) {
+        if (!receiver.hasPendingDatagrams())
+            QVERIFY(receiver.waitForReadyRead(5000));
+        // a small maxSize truncates, so ask for one byte more than we sent
+        received += receiver.receiveDatagrams(4, 11);
+    }
+    QCOMPARE(received.size(), datagrams.size());
+    for (int i = 0; i < received.size(); ++i) {
+        QCOMPARE(received.at(i).data(), datagrams.at(i).data());
+        QCOMPARE(received.at(i).senderPort(), int(sender.localPort()));
+        QCOMPARE(received.at(i).destinationPort(), int(port));
+    }
+
+    QVERIFY(!receiver.hasPendingDatagrams());
+    QVERIFY(receiver.receiveDatagrams(4).isEmpty());
+}
+
+void tst_QUdpSocket::batchedDatagramsMixedProtocols()
+{
+    QFETCH_GLOBAL(bool, setProxy);
+    if (setProxy)
+        return;
+    if (m_skipUnsupportedIPv6Tests)
+        QSKIP("IPv6 is not functional on this platform");
+
+    QUdpSocket sender, receiver4, receiver6;
+#ifdef FORCE_SESSION
+    sender.setProperty("_q_networksession", QVariant::fromValue(networkSession));
+    receiver4.setProperty("_q_networksession", QVariant::fromValue(networkSession));
+    receiver6.setProperty("_q_networksession", QVariant::fromValue(networkSession));
+#endif
+
+    QVERIFY(receiver4.bind(QHostAddress(QHostAddress::LocalHost), 0));
+    if (!receiver6.bind(QHostAddress(QHostAddress::LocalHostIPv6), 0))
+        QSKIP("No IPv6 loopback interface available");
+
+    // the first datagram is IPv4, so the sender must not end up unable
+    // to reach the IPv6 receiver
+    QVector<QNetworkDatagram> datagrams;
+    for (int i = 0; i < 6; ++i) {
+        QUdpSocket &receiver = (i % 2) ? receiver6 : receiver4;
+        datagrams.append(QNetworkDatagram(QByteArray(i + 1, char('a' + i)),
+                                          receiver.localAddress(), receiver.localPort()));
+    }
+    QCOMPARE(sender.writeDatagrams(datagrams), datagrams.size());
+
+    for (int r = 0; r < 2; ++r) {
+        QUdpSocket &receiver = r ? receiver6 : receiver4;
+        QVector<QNetworkDatagram> received;
+        while (received.size() < datagrams.size() / 2) {
+            if (!receiver.hasPendingDatagrams())
+                QVERIFY(receiver.waitForReadyRead(5000));
+            received += receiver.receiveDatagrams(8);
+        }
+        QCOMPARE(received.size(), datagrams.size() / 2);
+        for (int i = 0; i < received.size(); ++i) {
+            const QByteArray expected = datagrams.at(2 * i + r).data();
+            QCOMPARE(received.at(i).data(), expected);
+            // the receive buffer must not be kept at maxSize for every datagram
+            QCOMPARE(received.at(i).data().capacity(), expected.size());
+        }
+    }
+}
+
 QTEST_MAIN(tst_QUdpSocket)
 #include "tst_qudpsocket.moc"
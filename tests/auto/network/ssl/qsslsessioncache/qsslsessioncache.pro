@@ -0,0 +1,6 @@
+CONFIG += testcase
+
+SOURCES += tst_qsslsessioncache.cpp
+QT = core network-private testlib
+
+TARGET = tst_qsslsessioncache
@@ -0,0 +1,196 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+#include <QtCore/QTemporaryDir>
+#include "private/qsslsessioncache_p.h"
+
+class tst_QSslSessionCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void insertAndLookup();
+    void leastRecentlyUsedEviction();
+    void expiry();
+    void fileRoundTrip();
+    void saveKeepsOrder();
+};
+
+void tst_QSslSessionCache::insertAndLookup()
+{
+    QSslSessionCache cache;
+    QCOMPARE(cache.capacity(), int(QSslSessionCache::DefaultCapacity));
+    QVERIFY(cache.session("a").isEmpty());
+
+    cache.insert("a", "session-a", 60);
+    QCOMPARE(cache.session("a"), QByteArray("session-a"));
+    cache.insert("a", "session-a2", 60);
+    QCOMPARE(cache.session("a"), QByteArray("session-a2"));
+
+    // empty keys and sessions are not stored
+    cache.insert(QByteArray(), "session", 60);
+    QVERIFY(cache.session(QByteArray()).isEmpty());
+    cache.insert("b", QByteArray(), 60);
+    QVERIFY(cache.session("b").isEmpty());
+
+    cache.remove("a");
+    QVERIFY(cache.session("a").isEmpty());
+    cache.insert("a", "session-a", 60);
+    cache.clear();
+    QVERIFY(cache.session("a").isEmpty());
+}
+
+void tst_QSslSessionCache::leastRecentlyUsedEviction()
+{
+    QSslSessionCache cache;
+    cache.setCapacity(2);
+    QCOMPARE(cache.capacity(), 2);
+
+    cache.insert("a", "session-a", 60);
+    cache.insert("b", "session-b", 60);
+    // looking up "a" makes "b" the least recently used
+    QCOMPARE(cache.session("a"), QByteArray("session-a"));
+    cache.insert("c", "session-c", 60);
+    QVERIFY(cache.session("b").isEmpty());
+    QCOMPARE(cache.session("a"), QByteArray("session-a"));
+    QCOMPARE(cache.session("c"), QByteArray("session-c"));
+
+    // replacing a session also counts as a use
+    cache.insert("a", "session-a2", 60);
+    cache.insert("d", "session-d", 60);
+    QVERIFY(cache.session("c").isEmpty());
+    QCOMPARE(cache.session("a"), QByteArray("session-a2"));
+
+    // shrinking drops the least recently used sessions
+    cache.setCapacity(1);
+    QVERIFY(cache.session("d").isEmpty());
+    QCOMPARE(cache.session("a"), QByteArray("session-a2"));
+
+    cache.setCapacity(0);
+    QVERIFY(cache.session("a").isEmpty());
+    cache.insert("a", "session-a", 60);
+    QVERIFY(cache.session("a").isEmpty());
+}
+
+void tst_QSslSessionCache::expiry()
+{
+    QSslSessionCache cache;
+    cache.insert("short", "session-short", 1);
+    cache.insert("long", "session-long", 60);
+    // no lifetime hint falls back to the default lifetime
+    cache.insert("default", "session-default", 0);
+    QCOMPARE(cache.session("short"), QByteArray("session-short"));
+
+    QTRY_VERIFY_WITH_TIMEOUT(cache.session("short").isEmpty(), 3000);
+    QCOMPARE(cache.session("long"), QByteArray("session-long"));
+    QCOMPARE(cache.session("default"), QByteArray("session-default"));
+}
+
+void tst_QSslSessionCache::fileRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("sessions"));
+
+    {
+        QSslSessionCache cache;
+        cache.setFileName(fileName);
+        QCOMPARE(cache.fileName(), fileName);
+        cache.insert("a", "session-a", 60);
+        cache.insert("b", "session-b", 60);
+        cache.insert("short", "session-short", 1);
+        // "a" becomes the most recently used
+        QCOMPARE(cache.session("a"), QByteArray("session-a"));
+        QTRY_VERIFY_WITH_TIMEOUT(cache.session("short").isEmpty(), 3000);
+        // destruction writes the file
+    }
+    QFile file(fileName);
+    QVERIFY(file.exists());
+    QCOMPARE(file.permissions() & (QFile::ReadGroup | QFile::ReadOther), QFile::Permissions());
+
+    {
+        QSslSessionCache cache;
+        cache.setFileName(fileName);
+        QCOMPARE(cache.session("a"), QByteArray("session-a"));
+        QCOMPARE(cache.session("b"), QByteArray("session-b"));
+        QVERIFY(cache.session("short").isEmpty());
+    }
+
+    {
+        // the order of use is restored, so that only the most recently
+        // used session survives a smaller capacity
+        QSslSessionCache cache;
+        cache.setCapacity(1);
+        cache.setFileName(fileName);
+        QCOMPARE(cache.session("a"), QByteArray("session-a"));
+        QVERIFY(cache.session("b").isEmpty());
+    }
+
+    {
+        // sessions in memory win over the ones in the file
+        QSslSessionCache cache;
+        cache.insert("a", "session-a2", 60);
+        cache.setFileName(fileName);
+        QCOMPARE(cache.session("a"), QByteArray("session-a2"));
+        cache.setFileName(QString());
+    }
+
+    // a damaged file is ignored
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("garbage");
+    file.close();
+    QSslSessionCache cache;
+    cache.setFileName(fileName);
+    QVERIFY(cache.session("a").isEmpty());
+}
+
+void tst_QSslSessionCache::saveKeepsOrder()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QSslSessionCache cache;
+    cache.setCapacity(3);
+    cache.setFileName(dir.filePath(QStringLiteral("sessions")));
+    const QByteArray keys[] = { "a", "b", "c" };
+    for (const QByteArray &key : keys)
+        cache.insert(key, "session-" + key, 60);
+
+    // switching files saves the sessions; that must not count as a use
+    cache.setFileName(QString());
+    cache.insert("d", "session-d", 60);
+    QVERIFY(cache.session("a").isEmpty());
+    QCOMPARE(cache.session("b"), QByteArray("session-b"));
+    QCOMPARE(cache.session("c"), QByteArray("session-c"));
+    QCOMPARE(cache.session("d"), QByteArray("session-d"));
+}
+
+QTEST_MAIN(tst_QSslSessionCache)
+#include "tst_qsslsessioncache.moc"
@@ -24,6 +24,7 @@ winrt: SUBDIRS -= \
 qtConfig(ssl) {
     qtConfig(private_tests) {
         SUBDIRS += qasn1element \
-                   qssldiffiehellmanparameters
+                   qssldiffiehellmanparameters \
+                   qsslsessioncache
     }
 }
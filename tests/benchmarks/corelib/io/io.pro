@@ -5,6 +5,7 @@ SUBDIRS = \
         qfile \
         qfileinfo \
         qiodevice \
+        qsettings \
         qtemporaryfile \
         qtextstream
 
@@ -0,0 +1,114 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include <QFile>
+#include <QSettings>
+#include <QString>
+#include <QTemporaryDir>
+#include <qtest.h>
+
+class tst_qsettings : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void sync_data();
+    void sync();
+    void readValue_data() { sync_data(); }
+    void readValue();
+
+private:
+    QString createIniFile(int sections);
+
+    QTemporaryDir dir;
+};
+
+void tst_qsettings::initTestCase()
+{
+    QVERIFY(dir.isValid());
+}
+
+// Every section holds 20 keys of about 40 bytes each.
+QString tst_qsettings::createIniFile(int sections)
+{
+    const QString fileName = dir.path() + QLatin1String("/settings")
+            + QString::number(sections) + QLatin1String(".ini");
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return QString();
+    for (int i = 0; i < sections; ++i) {
+        QByteArray block = "[Section" + QByteArray::number(i) + "]\n";
+        for (int j = 0; j < 20; ++j) {
+            block += "key" + QByteArray::number(j) + "=some value of moderate length "
+                    + QByteArray::number(j) + '\n';
+        }
+        block += '\n';
+        file.write(block);
+    }
+    return fileName;
+}
+
+void tst_qsettings::sync_data()
+{
+    QTest::addColumn<int>("sections");
+    QTest::newRow("100 sections") << 100;
+    QTest::newRow("1000 sections") << 1000;
+    QTest::newRow("10000 sections") << 10000;
+}
+
+// Latency of writing back a small change to a large file
+void tst_qsettings::sync()
+{
+    QFETCH(int, sections);
+    const QString fileName = createIniFile(sections);
+    QVERIFY(!fileName.isEmpty());
+
+    QSettings settings(fileName, QSettings::IniFormat);
+    QCOMPARE(settings.value("Section0/key0").toString(), QString("some value of moderate length 0"));
+    int i = 0;
+    QBENCHMARK {
+        settings.setValue("Section1/key1", ++i);
+        settings.sync();
+    }
+    QCOMPARE(settings.status(), QSettings::NoError);
+}
+
+void tst_qsettings::readValue()
+{
+    QFETCH(int, sections);
+    const QString fileName = createIniFile(sections);
+    QVERIFY(!fileName.isEmpty());
+
+    QBENCHMARK {
+        QSettings settings(fileName, QSettings::IniFormat);
+        settings.value("Section1/key1");
+    }
+}
+
+QTEST_MAIN(tst_qsettings)
+
+#include "main.moc"
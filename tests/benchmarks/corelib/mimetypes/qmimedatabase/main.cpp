@@ -35,6 +35,8 @@ class tst_QMimeDatabase: public QObject
 
 private slots:
     void inheritsPerformance();
+    void mimeTypeForFileNamePerformance();
+    void mimeTypeForDataPerformance();
 };
 
 void tst_QMimeDatabase::inheritsPerformance()
@@ -70,5 +72,37 @@ void tst_QMimeDatabase::inheritsPerformance()
     // parsing XML, and then keeps being around 4.5 MB for all the in-memory hashes.
 }
 
+void tst_QMimeDatabase::mimeTypeForFileNamePerformance()
+{
+    // A mix of fast patterns, multi-dot suffixes, literals and misses,
+    // like the names found when listing a source tree.
+    const QStringList fileNames = QStringList()
+            << QStringLiteral("main.cpp") << QStringLiteral("image.PNG")
+            << QStringLiteral("archive.tar.bz2") << QStringLiteral("Makefile")
+            << QStringLiteral("README") << QStringLiteral("core")
+            << QStringLiteral("notes.txt~") << QStringLiteral("data.unknownext")
+            << QStringLiteral("qmimedatabase.h") << QStringLiteral("CMakeLists.txt");
+    QMimeDatabase db;
+    QBENCHMARK {
+        for (const QString &fileName : fileNames)
+            db.mimeTypeForFile(fileName, QMimeDatabase::MatchExtension);
+    }
+}
+
+void tst_QMimeDatabase::mimeTypeForDataPerformance()
+{
+    // Unknown binary data has to be checked against every magic rule.
+    QByteArray data(1024, Qt::Uninitialized);
+    for (int i = 0; i < data.size(); ++i)
+        data[i] = char(i * 7 + 3);
+    const QByteArray png = QByteArray("\x89PNG\r\n\x1a\n", 8) + data;
+    QMimeDatabase db;
+    QCOMPARE(db.mimeTypeForData(png).name(), QStringLiteral("image/png"));
+    QBENCHMARK {
+        db.mimeTypeForData(data);
+        db.mimeTypeForData(png);
+    }
+}
+
 QTEST_MAIN(tst_QMimeDatabase)
 #include "main.moc"
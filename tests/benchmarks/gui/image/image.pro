@@ -4,6 +4,7 @@ SUBDIRS = \
         qimageconversion \
         qimagereader \
         qimagescale \
+        qimagetransform \
         qpixmap \
         qpixmapcache
 
@@ -28,6 +28,7 @@
 
 #include <qtest.h>
 #include <QImage>
+#include <QThreadPool>
 
 Q_DECLARE_METATYPE(QImage::Format)
 
@@ -56,6 +57,9 @@ private slots:
     void convertGenericInplace_data();
     void convertGenericInplace();
 
+    void convertThreads_data();
+    void convertThreads();
+
 private:
     QImage generateImageRgb888(int width, int height);
     QImage generateImageRgb16(int width, int height);
@@ -354,6 +358,45 @@ void tst_QImageConversion::convertGenericInplace()
     }
 }
 
+void tst_QImageConversion::convertThreads_data()
+{
+    QTest::addColumn<QImage>("inputImage");
+    QTest::addColumn<QImage::Format>("outputFormat");
+    QTest::addColumn<int>("threadCount");
+
+    // A print preview sized image
+    QImage argb32 = generateImageArgb32(8000, 6000);
+    QImage rgb888 = generateImageRgb888(8000, 6000);
+
+    const int idealThreadCount = QThread::idealThreadCount();
+    for (int threadCount : { 1, 2, 4, idealThreadCount }) {
+        const QString suffix = QString::fromLatin1(", %1 threads").arg(threadCount);
+        QTest::newRow(qPrintable("argb32 -> argb32pm" + suffix))
+                << argb32 << QImage::Format_ARGB32_Premultiplied << threadCount;
+        QTest::newRow(qPrintable("argb32 -> rgb16" + suffix))
+                << argb32 << QImage::Format_RGB16 << threadCount;
+        QTest::newRow(qPrintable("rgb888 -> rgb32" + suffix))
+                << rgb888 << QImage::Format_RGB32 << threadCount;
+    }
+}
+
+void tst_QImageConversion::convertThreads()
+{
+    QFETCH(QImage, inputImage);
+    QFETCH(QImage::Format, outputFormat);
+    QFETCH(int, threadCount);
+
+    QThreadPool *threadPool = QThreadPool::globalInstance();
+    const int maxThreadCount = threadPool->maxThreadCount();
+    threadPool->setMaxThreadCount(threadCount);
+
+    QBENCHMARK {
+        QImage output = inputImage.convertToFormat(outputFormat);
+    }
+
+    threadPool->setMaxThreadCount(maxThreadCount);
+}
+
 /*
  Fill a RGB888 image with "random" pixel values.
  */
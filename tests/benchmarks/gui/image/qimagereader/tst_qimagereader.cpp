@@ -69,6 +69,11 @@ private slots:
     void setScaledClipRect_data();
     void setScaledClipRect();
 
+#if defined QTEST_HAVE_JPEG
+    void jpegThumbnail_data();
+    void jpegThumbnail();
+#endif
+
 private:
     QList< QPair<QString, QByteArray> > images; // filename, format
 };
@@ -215,5 +220,56 @@ void tst_QImageReader::setScaledClipRect()
     }
 }
 
+#if defined QTEST_HAVE_JPEG
+void tst_QImageReader::jpegThumbnail_data()
+{
+    QTest::addColumn<QSize>("scaledSize");
+    QTest::addColumn<QRect>("clipRect");
+    QTest::addColumn<int>("quality");
+
+    QTest::newRow("full decode") << QSize() << QRect() << -1;
+    QTest::newRow("thumbnail 160x120") << QSize(160, 120) << QRect() << -1;
+    QTest::newRow("thumbnail 160x120, fast") << QSize(160, 120) << QRect() << 25;
+    QTest::newRow("thumbnail 400x300") << QSize(400, 300) << QRect() << -1;
+    QTest::newRow("region 256x256") << QSize() << QRect(2048, 1536, 256, 256) << -1;
+    QTest::newRow("region 1024x768 to 160x120") << QSize(160, 120) << QRect(1024, 768, 1024, 768) << -1;
+}
+
+void tst_QImageReader::jpegThumbnail()
+{
+    QFETCH(QSize, scaledSize);
+    QFETCH(QRect, clipRect);
+    QFETCH(int, quality);
+
+    // A photo-sized image with some detail in it.
+    QImage source(3072, 2304, QImage::Format_RGB32);
+    for (int y = 0; y < source.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(source.scanLine(y));
+        for (int x = 0; x < source.width(); ++x)
+            line[x] = qRgb(x / 12, y / 9, (x ^ y) & 0xff);
+    }
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(source.save(&buffer, "jpeg", 90));
+    buffer.close();
+
+    const QSize expectedSize = scaledSize.isValid() ? scaledSize
+                             : clipRect.isValid() ? clipRect.size() : source.size();
+    QBENCHMARK {
+        buffer.open(QIODevice::ReadOnly);
+        QImageReader reader(&buffer, "jpeg");
+        if (scaledSize.isValid())
+            reader.setScaledSize(scaledSize);
+        if (clipRect.isValid())
+            reader.setClipRect(clipRect);
+        reader.setQuality(quality);
+        QImage image = reader.read();
+        buffer.close();
+        QCOMPARE(image.size(), expectedSize);
+    }
+}
+#endif
+
 QTEST_MAIN(tst_QImageReader)
 #include "tst_qimagereader.moc"
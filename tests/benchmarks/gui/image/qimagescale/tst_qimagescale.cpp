@@ -28,6 +28,7 @@
 
 #include <qtest.h>
 #include <QImage>
+#include <QThreadPool>
 
 class tst_QImageScale : public QObject
 {
@@ -39,6 +40,9 @@ private slots:
     void scaleArgb32pm_data();
     void scaleArgb32pm();
 
+    void scaleThreads_data();
+    void scaleThreads();
+
 private:
     QImage generateImageRgb32(int width, int height);
     QImage generateImageArgb32(int width, int height);
@@ -100,6 +104,41 @@ void tst_QImageScale::scaleArgb32pm()
     }
 }
 
+void tst_QImageScale::scaleThreads_data()
+{
+    QTest::addColumn<QImage>("inputImage");
+    QTest::addColumn<QSize>("outputSize");
+    QTest::addColumn<int>("threadCount");
+
+    // A print preview sized image
+    QImage image = generateImageArgb32(8000, 6000).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const int idealThreadCount = QThread::idealThreadCount();
+    for (int threadCount : { 1, 2, 4, idealThreadCount }) {
+        QTest::newRow(qPrintable(QString::fromLatin1("8000x6000 -> 2000x1500, %1 threads").arg(threadCount)))
+                << image << QSize(2000, 1500) << threadCount;
+        QTest::newRow(qPrintable(QString::fromLatin1("8000x6000 -> 10000x7500, %1 threads").arg(threadCount)))
+                << image << QSize(10000, 7500) << threadCount;
+    }
+}
+
+void tst_QImageScale::scaleThreads()
+{
+    QFETCH(QImage, inputImage);
+    QFETCH(QSize, outputSize);
+    QFETCH(int, threadCount);
+
+    QThreadPool *threadPool = QThreadPool::globalInstance();
+    const int maxThreadCount = threadPool->maxThreadCount();
+    threadPool->setMaxThreadCount(threadCount);
+
+    QBENCHMARK {
+        volatile QImage output = inputImage.scaled(outputSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        (void)output;
+    }
+
+    threadPool->setMaxThreadCount(maxThreadCount);
+}
+
 /*
  Fill a RGB32 image with "random" pixel values.
  */
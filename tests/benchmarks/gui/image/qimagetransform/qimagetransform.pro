@@ -0,0 +1,4 @@
+TEMPLATE = app
+TARGET = tst_bench_imageTransform
+QT += testlib
+SOURCES += tst_qimagetransform.cpp
@@ -0,0 +1,131 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <qtest.h>
+#include <QImage>
+#include <QThreadPool>
+#include <QTransform>
+
+class tst_QImageTransform : public QObject
+{
+    Q_OBJECT
+private slots:
+    void mirrored_data();
+    void mirrored();
+
+    void transformed_data();
+    void transformed();
+
+private:
+    QImage generateImageArgb32(int width, int height);
+};
+
+void tst_QImageTransform::mirrored_data()
+{
+    QTest::addColumn<bool>("horizontal");
+    QTest::addColumn<bool>("vertical");
+    QTest::addColumn<int>("threadCount");
+
+    const int idealThreadCount = QThread::idealThreadCount();
+    for (int threadCount : { 1, 2, 4, idealThreadCount }) {
+        const QString suffix = QString::fromLatin1(", %1 threads").arg(threadCount);
+        QTest::newRow(qPrintable("horizontal" + suffix)) << true << false << threadCount;
+        QTest::newRow(qPrintable("vertical" + suffix)) << false << true << threadCount;
+        QTest::newRow(qPrintable("both" + suffix)) << true << true << threadCount;
+    }
+}
+
+void tst_QImageTransform::mirrored()
+{
+    QFETCH(bool, horizontal);
+    QFETCH(bool, vertical);
+    QFETCH(int, threadCount);
+
+    const QImage image = generateImageArgb32(8000, 6000);
+    QThreadPool *threadPool = QThreadPool::globalInstance();
+    const int maxThreadCount = threadPool->maxThreadCount();
+    threadPool->setMaxThreadCount(threadCount);
+
+    QBENCHMARK {
+        QImage output = image.mirrored(horizontal, vertical);
+    }
+
+    threadPool->setMaxThreadCount(maxThreadCount);
+}
+
+void tst_QImageTransform::transformed_data()
+{
+    QTest::addColumn<qreal>("angle");
+    QTest::addColumn<Qt::TransformationMode>("mode");
+    QTest::addColumn<int>("threadCount");
+
+    const int idealThreadCount = QThread::idealThreadCount();
+    for (int threadCount : { 1, 2, 4, idealThreadCount }) {
+        const QString suffix = QString::fromLatin1(", %1 threads").arg(threadCount);
+        QTest::newRow(qPrintable("rotate 30, fast" + suffix))
+                << qreal(30) << Qt::FastTransformation << threadCount;
+        QTest::newRow(qPrintable("rotate 30, smooth" + suffix))
+                << qreal(30) << Qt::SmoothTransformation << threadCount;
+    }
+}
+
+void tst_QImageTransform::transformed()
+{
+    QFETCH(qreal, angle);
+    QFETCH(Qt::TransformationMode, mode);
+    QFETCH(int, threadCount);
+
+    const QImage image = generateImageArgb32(4000, 3000).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QThreadPool *threadPool = QThreadPool::globalInstance();
+    const int maxThreadCount = threadPool->maxThreadCount();
+    threadPool->setMaxThreadCount(threadCount);
+
+    QBENCHMARK {
+        QImage output = image.transformed(QTransform().rotate(angle), mode);
+    }
+
+    threadPool->setMaxThreadCount(maxThreadCount);
+}
+
+/*
+ Fill a ARGB32 image with "random" pixel values.
+ */
+QImage tst_QImageTransform::generateImageArgb32(int width, int height)
+{
+    QImage image(width, height, QImage::Format_ARGB32);
+
+    for (int y = 0; y < image.height(); ++y) {
+        QRgb *scanline = (QRgb*)image.scanLine(y);
+        for (int x = 0; x < width; ++x)
+            scanline[x] = qRgba(x, y, x ^ y, (x * y) & 0xff);
+    }
+    return image;
+}
+
+QTEST_MAIN(tst_QImageTransform)
+#include "tst_qimagetransform.moc"
@@ -1,6 +1,7 @@
 TEMPLATE = subdirs
 SUBDIRS = \
         qcolor \
+        qcompositionmodes \
         qpainter \
         qregion \
         qtransform \
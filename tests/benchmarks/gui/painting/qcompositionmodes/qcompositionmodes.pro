@@ -0,0 +1,6 @@
+TEMPLATE = app
+TARGET = tst_bench_qcompositionmodes
+QT += testlib
+CONFIG += release
+
+SOURCES += tst_qcompositionmodes.cpp
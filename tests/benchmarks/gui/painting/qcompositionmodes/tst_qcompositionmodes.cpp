@@ -0,0 +1,147 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+// This file contains benchmarks for the raster engine's composition functions.
+
+#include <qtest.h>
+#include <QImage>
+#include <QPainter>
+
+Q_DECLARE_METATYPE(QPainter::CompositionMode)
+Q_DECLARE_METATYPE(QImage::Format)
+
+class tst_QCompositionModes : public QObject
+{
+    Q_OBJECT
+private slots:
+    void drawImage_data();
+    void drawImage();
+
+    void fillRect_data();
+    void fillRect();
+
+private:
+    void createData();
+};
+
+static QImage createTestImage(const QSize &size, QImage::Format format)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < image.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            const int alpha = (x * 7 + y * 3) & 0xff;
+            line[x] = qPremultiply(qRgba(x & 0xff, y & 0xff, (x + y) & 0xff, alpha));
+        }
+    }
+    return image.convertToFormat(format);
+}
+
+void tst_QCompositionModes::createData()
+{
+    QTest::addColumn<QPainter::CompositionMode>("mode");
+    QTest::addColumn<QImage::Format>("format");
+    QTest::addColumn<qreal>("opacity");
+
+    static const struct {
+        QPainter::CompositionMode mode;
+        const char *name;
+    } modes[] = {
+        { QPainter::CompositionMode_SourceOver, "SourceOver" },
+        { QPainter::CompositionMode_Source, "Source" },
+        { QPainter::CompositionMode_Plus, "Plus" },
+        { QPainter::CompositionMode_Multiply, "Multiply" }
+    };
+    static const struct {
+        QImage::Format format;
+        const char *name;
+    } formats[] = {
+        { QImage::Format_ARGB32_Premultiplied, "ARGB32_Premultiplied" },
+        { QImage::Format_A2RGB30_Premultiplied, "A2RGB30_Premultiplied" }
+    };
+
+    for (const auto &format : formats) {
+        for (const auto &mode : modes) {
+            // The 64-bit pipeline used by A2RGB30 doesn't implement Multiply.
+            if (format.format == QImage::Format_A2RGB30_Premultiplied
+                    && mode.mode == QPainter::CompositionMode_Multiply)
+                continue;
+            QTest::newRow(QByteArray(mode.name).append(' ').append(format.name).append(" opaque"))
+                    << mode.mode << format.format << qreal(1.0);
+            QTest::newRow(QByteArray(mode.name).append(' ').append(format.name).append(" opacity"))
+                    << mode.mode << format.format << qreal(0.5);
+        }
+    }
+}
+
+void tst_QCompositionModes::drawImage_data()
+{
+    createData();
+}
+
+void tst_QCompositionModes::drawImage()
+{
+    QFETCH(QPainter::CompositionMode, mode);
+    QFETCH(QImage::Format, format);
+    QFETCH(qreal, opacity);
+
+    QImage destination = createTestImage(QSize(1024, 512), format);
+    const QImage source = createTestImage(QSize(1024, 512), QImage::Format_ARGB32_Premultiplied);
+
+    QPainter painter(&destination);
+    painter.setCompositionMode(mode);
+    painter.setOpacity(opacity);
+    QBENCHMARK {
+        painter.drawImage(0, 0, source);
+    }
+}
+
+void tst_QCompositionModes::fillRect_data()
+{
+    createData();
+}
+
+void tst_QCompositionModes::fillRect()
+{
+    QFETCH(QPainter::CompositionMode, mode);
+    QFETCH(QImage::Format, format);
+    QFETCH(qreal, opacity);
+
+    QImage destination = createTestImage(QSize(1024, 512), format);
+
+    QPainter painter(&destination);
+    painter.setCompositionMode(mode);
+    painter.setOpacity(opacity);
+    QBENCHMARK {
+        painter.fillRect(destination.rect(), QColor(120, 40, 200, 160));
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_QCompositionModes)
+
+#include "tst_qcompositionmodes.moc"
@@ -33,6 +33,8 @@
 #include <QImage>
 #include <QPaintEngine>
 #include <QTileRules>
+#include <QThread>
+#include <QThreadPool>
 #include <math.h>
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -161,6 +163,8 @@ private slots:
     void drawLine_clipped();
     void drawLine_antialiased_clipped_data();
     void drawLine_antialiased_clipped();
+    void drawManyCosmeticLines_data();
+    void drawManyCosmeticLines();
 
     void drawPixmap_data();
     void drawPixmap();
@@ -609,6 +613,52 @@ void tst_QPainter::drawLine_antialiased_clipped()
     p.end();
 }
 
+void tst_QPainter::drawManyCosmeticLines_data()
+{
+    QTest::addColumn<bool>("antialiased");
+    QTest::addColumn<int>("threadCount");
+
+    const int idealThreadCount = qMax(2, QThread::idealThreadCount());
+    QTest::newRow("aliased, 1 thread") << false << 1;
+    QTest::newRow("aliased, ideal threads") << false << idealThreadCount;
+    QTest::newRow("antialiased, 1 thread") << true << 1;
+    QTest::newRow("antialiased, ideal threads") << true << idealThreadCount;
+}
+
+void tst_QPainter::drawManyCosmeticLines()
+{
+    QFETCH(bool, antialiased);
+    QFETCH(int, threadCount);
+
+    // A map-like scene: one million short hairlines spread over the image
+    const QSize size(2048, 2048);
+    QVector<QLineF> lines;
+    lines.reserve(1000000);
+    qsrand(42);
+    for (int i = 0; i < 1000000; ++i) {
+        const QPointF p1(qrand() % (size.width() * 8) / 8., qrand() % (size.height() * 8) / 8.);
+        lines << QLineF(p1, p1 + QPointF(qrand() % 256 / 8. - 16, qrand() % 256 / 8. - 16));
+    }
+
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int oldThreadCount = pool->maxThreadCount();
+    pool->setMaxThreadCount(threadCount);
+
+    QPainter p(&image);
+    p.setRenderHint(QPainter::Antialiasing, antialiased);
+    p.setPen(QPen(QColor(0, 0, 128, 64), 0));
+
+    QBENCHMARK {
+        p.drawLines(lines);
+    }
+
+    p.end();
+    pool->setMaxThreadCount(oldThreadCount);
+}
+
 void tst_QPainter::drawPixmapImage_data_helper(bool pixmaps)
 {
     QTest::addColumn<QImage::Format>("sourceFormat");
@@ -4,3 +4,5 @@ SUBDIRS = \
         qnetworkreply \
         qnetworkreply_from_cache \
         qnetworkdiskcache
+
+qtConfig(private_tests): SUBDIRS += hpack
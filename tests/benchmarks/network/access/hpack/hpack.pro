@@ -0,0 +1,8 @@
+TEMPLATE = app
+TARGET = tst_bench_hpack
+
+QT = core network-private testlib
+
+CONFIG += release c++14
+
+SOURCES += tst_bench_hpack.cpp
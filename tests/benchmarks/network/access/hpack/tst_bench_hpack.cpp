@@ -0,0 +1,147 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtNetwork/private/bitstreams_p.h>
+#include <QtNetwork/private/hpack_p.h>
+
+#include <vector>
+
+QT_USE_NAMESPACE
+
+using namespace HPack;
+
+namespace
+{
+
+// A typical browser request, repeated for every resource on a page.
+HttpHeader browserRequest(int n)
+{
+    return {{":method", "GET"},
+            {":scheme", "https"},
+            {":authority", "www.example.com"},
+            {":path", QByteArray("/static/images/icon") + QByteArray::number(n % 16) + ".png"},
+            {"user-agent", "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko)"},
+            {"accept", "image/webp,image/apng,image/*,*/*;q=0.8"},
+            {"accept-language", "en-US,en;q=0.9"},
+            {"accept-encoding", "gzip, deflate, br"},
+            {"referer", "https://www.example.com/index.html"},
+            {"cookie", "session=3b1f0e2a9c7d4e58a6b2c1d0f9e8d7c6; theme=dark; lang=en"}};
+}
+
+const int requestCount = 100;
+
+} // unnamed namespace
+
+class tst_bench_Hpack : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void encodeRequests_data();
+    void encodeRequests();
+    void decodeRequests_data();
+    void decodeRequests();
+    void huffmanDecode();
+};
+
+void tst_bench_Hpack::encodeRequests_data()
+{
+    QTest::addColumn<bool>("compressStrings");
+    QTest::newRow("huffman") << true;
+    QTest::newRow("plain") << false;
+}
+
+void tst_bench_Hpack::encodeRequests()
+{
+    QFETCH(bool, compressStrings);
+
+    std::vector<HttpHeader> headers;
+    for (int i = 0; i < requestCount; ++i)
+        headers.push_back(browserRequest(i));
+
+    std::vector<uchar> buffer;
+    QBENCHMARK {
+        Encoder encoder(HPack::FieldLookupTable::DefaultSize, compressStrings);
+        for (const HttpHeader &header : headers) {
+            buffer.clear();
+            BitOStream outputStream(buffer);
+            encoder.encodeRequest(outputStream, header);
+        }
+    }
+}
+
+void tst_bench_Hpack::decodeRequests_data()
+{
+    encodeRequests_data();
+}
+
+void tst_bench_Hpack::decodeRequests()
+{
+    QFETCH(bool, compressStrings);
+
+    std::vector<std::vector<uchar>> blocks(requestCount);
+    Encoder encoder(HPack::FieldLookupTable::DefaultSize, compressStrings);
+    for (int i = 0; i < requestCount; ++i) {
+        BitOStream outputStream(blocks[i]);
+        QVERIFY(encoder.encodeRequest(outputStream, browserRequest(i)));
+    }
+
+    QBENCHMARK {
+        Decoder decoder(HPack::FieldLookupTable::DefaultSize);
+        for (const auto &block : blocks) {
+            BitIStream inputStream(&block[0], &block[0] + block.size());
+            if (!decoder.decodeHeaderFields(inputStream))
+                QFAIL("decoding failed");
+        }
+    }
+}
+
+void tst_bench_Hpack::huffmanDecode()
+{
+    const QByteArray value("text/html,application/xhtml+xml,application/xml;q=0.9,"
+                           "image/webp,image/apng,*/*;q=0.8,application/signed-exchange;v=b3");
+    std::vector<uchar> buffer;
+    BitOStream outputStream(buffer);
+    for (int i = 0; i < requestCount; ++i)
+        outputStream.write(value, true);
+
+    QBENCHMARK {
+        BitIStream inputStream(outputStream.begin(), outputStream.end());
+        for (int i = 0; i < requestCount; ++i) {
+            QByteArray decoded;
+            if (!inputStream.read(&decoded))
+                QFAIL("decoding failed");
+        }
+    }
+}
+
+QTEST_MAIN(tst_bench_Hpack)
+
+#include "tst_bench_hpack.moc"
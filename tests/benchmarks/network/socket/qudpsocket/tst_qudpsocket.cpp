@@ -0,0 +1,101 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <qudpsocket.h>
+#include <qnetworkdatagram.h>
+#include <qhostaddress.h>
+
+class tst_QUdpSocket : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void loopbackThroughput_data();
+    void loopbackThroughput();
+};
+
+enum { DatagramsPerBurst = 64 };
+
+void tst_QUdpSocket::loopbackThroughput_data()
+{
+    QTest::addColumn<int>("datagramSize");
+    QTest::addColumn<bool>("batched");
+
+    const int sizes[] = { 64, 512, 1400 };
+    for (int size : sizes) {
+        QTest::newRow(qPrintable(QString::fromLatin1("%1 bytes, one at a time").arg(size)))
+                << size << false;
+        QTest::newRow(qPrintable(QString::fromLatin1("%1 bytes, batched").arg(size)))
+                << size << true;
+    }
+}
+
+// Sends bursts of datagrams over the loopback interface and reads them back,
+// either with writeDatagram()/receiveDatagram() or with their batched
+// counterparts. The bursts are small enough to fit in the socket buffers, so
+// no datagram is dropped.
+void tst_QUdpSocket::loopbackThroughput()
+{
+    QFETCH(int, datagramSize);
+    QFETCH(bool, batched);
+
+    QUdpSocket receiver;
+    QVERIFY(receiver.bind(QHostAddress(QHostAddress::LocalHost), 0));
+    QUdpSocket sender;
+    QVERIFY(sender.bind(QHostAddress(QHostAddress::LocalHost), 0));
+
+    const QByteArray payload(datagramSize, 'q');
+    QVector<QNetworkDatagram> burst;
+    for (int i = 0; i < DatagramsPerBurst; ++i)
+        burst.append(QNetworkDatagram(payload, QHostAddress::LocalHost, receiver.localPort()));
+
+    QBENCHMARK {
+        if (batched) {
+            QCOMPARE(sender.writeDatagrams(burst), int(DatagramsPerBurst));
+        } else {
+            for (const QNetworkDatagram &datagram : qAsConst(burst))
+                QCOMPARE(sender.writeDatagram(datagram), qint64(datagramSize));
+        }
+
+        int received = 0;
+        while (received < DatagramsPerBurst) {
+            if (!receiver.hasPendingDatagrams())
+                QVERIFY(receiver.waitForReadyRead(5000));
+            if (batched) {
+                received += receiver.receiveDatagrams(DatagramsPerBurst - received, datagramSize).size();
+            } else {
+                QCOMPARE(receiver.receiveDatagram(datagramSize).data().size(), datagramSize);
+                ++received;
+            }
+        }
+    }
+}
+
+QTEST_MAIN(tst_QUdpSocket)
+#include "tst_qudpsocket.moc"
@@ -0,0 +1,12 @@
+TEMPLATE = app
+TARGET = tst_bench_qsslsockethandshake
+
+QT -= gui
+QT += network testlib
+
+CONFIG += release
+
+SOURCES += tst_qsslsockethandshake.cpp
+
+# Reuse the server certificate of the QSslSocket autotest.
+DEFINES += SRCDIR=\\\"$$PWD/../../../../auto/network/ssl/qsslsocket/\\\"
@@ -0,0 +1,165 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <qcoreapplication.h>
+#include <qeventloop.h>
+#include <qsslconfiguration.h>
+#include <qsslkey.h>
+#include <qsslsocket.h>
+#include <qtcpserver.h>
+
+// Accepts TLS connections on the loopback interface and closes each of them
+// as soon as the handshake is done.
+class SslServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    SslServer()
+    {
+        QFile file(SRCDIR "certs/fluke.key");
+        if (file.open(QIODevice::ReadOnly))
+            key = QSslKey(file.readAll(), QSsl::Rsa, QSsl::Pem, QSsl::PrivateKey);
+        const QList<QSslCertificate> certificates = QSslCertificate::fromPath(SRCDIR "certs/fluke.cert");
+        if (!certificates.isEmpty())
+            certificate = certificates.first();
+    }
+
+    QSslKey key;
+    QSslCertificate certificate;
+    QSsl::SslOptions options;
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) Q_DECL_OVERRIDE
+    {
+        QSslSocket *socket = new QSslSocket(this);
+        QSslConfiguration configuration = socket->sslConfiguration();
+        configuration.setPrivateKey(key);
+        configuration.setLocalCertificate(certificate);
+        configuration.setSslOption(QSsl::SslOptionDisableSessionTickets,
+                                   options.testFlag(QSsl::SslOptionDisableSessionTickets));
+        socket->setSslConfiguration(configuration);
+        connect(socket, &QSslSocket::encrypted, socket, &QSslSocket::disconnectFromHost);
+        connect(socket, &QSslSocket::disconnected, socket, &QObject::deleteLater);
+        socket->setSocketDescriptor(socketDescriptor);
+        socket->startServerEncryption();
+    }
+};
+
+class tst_QSslSocketHandshake : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void handshakes_data();
+    void handshakes();
+
+private:
+    bool handshake(quint16 port, QSsl::SslOptions options, bool *resumed);
+};
+
+void tst_QSslSocketHandshake::initTestCase()
+{
+    if (!QSslSocket::supportsSsl())
+        QSKIP("No SSL support");
+}
+
+bool tst_QSslSocketHandshake::handshake(quint16 port, QSsl::SslOptions options, bool *resumed)
+{
+    QSslSocket socket;
+    QSslConfiguration configuration = socket.sslConfiguration();
+    configuration.setPeerVerifyMode(QSslSocket::VerifyNone);
+    configuration.setSslOption(QSsl::SslOptionDisableSessionSharing,
+                               options.testFlag(QSsl::SslOptionDisableSessionSharing));
+    socket.setSslConfiguration(configuration);
+
+    QEventLoop loop;
+    connect(&socket, &QSslSocket::encrypted, &loop, &QEventLoop::quit);
+    connect(&socket, static_cast<void (QSslSocket::*)(QAbstractSocket::SocketError)>(&QSslSocket::error),
+            &loop, &QEventLoop::quit);
+    socket.connectToHostEncrypted(QStringLiteral("localhost"), port);
+    loop.exec();
+
+    const bool encrypted = socket.isEncrypted();
+    *resumed = socket.isSessionResumed();
+    socket.abort();
+    return encrypted;
+}
+
+void tst_QSslSocketHandshake::handshakes_data()
+{
+    QTest::addColumn<int>("serverOptions");
+    QTest::addColumn<int>("clientOptions");
+    QTest::addColumn<bool>("resumed");
+
+    QTest::newRow("full")
+            << int(QSsl::SslOptionDisableSessionTickets)
+            << int(QSsl::SslOptionDisableSessionSharing)
+            << false;
+    QTest::newRow("resumed-ticket")
+            << 0
+            << 0
+            << true;
+}
+
+// Measures the cost of a batch of handshakes against a local server, either
+// always performing the full key exchange or resuming the session that the
+// client-side session cache kept from the previous connection.
+void tst_QSslSocketHandshake::handshakes()
+{
+    QFETCH(int, serverOptions);
+    QFETCH(int, clientOptions);
+    QFETCH(bool, resumed);
+
+    SslServer server;
+    QVERIFY(!server.key.isNull());
+    QVERIFY(!server.certificate.isNull());
+    server.options = QSsl::SslOptions(serverOptions);
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    QSslSocket::clearSessionCache();
+    const QSsl::SslOptions options(clientOptions);
+    bool wasResumed;
+    QVERIFY(handshake(server.serverPort(), options, &wasResumed)); // prime the session cache
+    QVERIFY(!wasResumed);
+
+    // Make sure each row measures what it claims to: a fast "resumed" row
+    // that silently fell back to full handshakes would be meaningless.
+    const int count = 50;
+    QBENCHMARK {
+        for (int i = 0; i < count; ++i) {
+            QVERIFY(handshake(server.serverPort(), options, &wasResumed));
+            QCOMPARE(wasResumed, resumed);
+        }
+    }
+}
+
+QTEST_MAIN(tst_QSslSocketHandshake)
+#include "tst_qsslsockethandshake.moc"